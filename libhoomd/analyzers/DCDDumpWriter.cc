@@ -66,9 +66,16 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #ifdef ENABLE_MPI
 #include "Communicator.h"
+#include <algorithm>
+#include <sstream>
+#endif
+
+#ifdef ENABLE_OPENMP
+#include <omp.h>
 #endif
 
 #include <boost/python.hpp>
+#include <boost/bind.hpp>
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/convenience.hpp>
 using boost::filesystem::exists;
@@ -84,7 +91,7 @@ using namespace std;
 /*! \param file file to write to
     \param val integer to write
 */
-static void write_int(fstream &file, unsigned int val)
+static void write_int(ostream &file, unsigned int val)
     {
     file.write((char *)&val, sizeof(unsigned int));
     }
@@ -121,7 +128,8 @@ DCDDumpWriter::DCDDumpWriter(boost::shared_ptr<SystemDefinition> sysdef,
     : Analyzer(sysdef), m_fname(fname), m_start_timestep(0), m_period(period), m_group(group),
     m_rigid_data(sysdef->getRigidData()), m_num_frames_written(0), m_last_written_step(0), m_appending(false),
       m_unwrap_full(false), m_unwrap_rigid(false), m_angle(false),
-      m_overwrite(overwrite), m_is_initialized(false)
+      m_overwrite(overwrite), m_is_initialized(false), m_num_frames_queued(0), m_queue_depth(0),
+      m_writer_error(false)
     {
     m_exec_conf->msg->notice(5) << "Constructing DCDDumpWriter: " << fname << " " << period << " " << overwrite << endl;
     }
@@ -158,8 +166,8 @@ void DCDDumpWriter::initFileIO()
             
         m_appending = true;
         }
-       
-    m_staging_buffer = new float[m_pdata->getNGlobal()];
+
+    m_num_frames_queued = m_num_frames_written;
     m_is_initialized = true;
     }
 
@@ -167,87 +175,527 @@ DCDDumpWriter::~DCDDumpWriter()
     {
     m_exec_conf->msg->notice(5) << "Destroying DCDDumpWriter" << endl;
 
-    if (m_is_initialized)
-        delete[] m_staging_buffer;
+    // write out any frames still in the queue
+    stopWriter();
+    }
+
+/*! \param queue_depth Number of frames that may be waiting to be written, 0 to write synchronously
+
+    With a non-zero \a queue_depth, analyze() only stages the frame in memory and a background thread
+    writes it to the file. Frames already queued are written before the change takes effect.
+*/
+void DCDDumpWriter::setAsync(unsigned int queue_depth)
+    {
+    stopWriter();
+    checkWriterError();
+
+    m_queue_depth = queue_depth;
+    m_async_frames.clear();
+    m_free_frames.reset();
+    m_write_queue.reset();
+
+    if (m_queue_depth == 0)
+        return;
+
+    m_async_frames.resize(m_queue_depth);
+    m_free_frames.reset(new WorkQueue<Frame *>(m_queue_depth));
+    m_write_queue.reset(new WorkQueue<Frame *>(m_queue_depth + 1));
+    for (unsigned int i = 0; i < m_queue_depth; i++)
+        m_free_frames->push(&m_async_frames[i]);
+
+    m_writer_thread.reset(new boost::thread(boost::bind(&DCDDumpWriter::writerLoop, this)));
+    }
+
+/*! Blocks until the background writer has written every queued frame to the file. Does nothing
+    when frames are written synchronously.
+*/
+void DCDDumpWriter::flush()
+    {
+    if (m_writer_thread)
+        {
+        // all staging buffers are back in the free pool once every queued frame is written
+        std::vector<Frame *> frames;
+        for (unsigned int i = 0; i < m_queue_depth; i++)
+            frames.push_back(m_free_frames->wait_and_pop());
+        for (unsigned int i = 0; i < m_queue_depth; i++)
+            m_free_frames->push(frames[i]);
+        }
+
+    checkWriterError();
+    }
+
+/*! Queues a NULL frame to signal the end of the output and waits for the writer thread to finish.
+*/
+void DCDDumpWriter::stopWriter()
+    {
+    if (!m_writer_thread)
+        return;
+
+    m_write_queue->push(NULL);
+    m_writer_thread->join();
+    m_writer_thread.reset();
+    }
+
+void DCDDumpWriter::checkWriterError()
+    {
+    boost::mutex::scoped_lock lock(m_writer_error_mutex);
+    if (m_writer_error)
+        {
+        m_exec_conf->msg->error() << "dump.dcd: I/O error in the background writer for \"" << m_fname << "\"" << endl;
+        throw runtime_error("Error writing DCD file");
+        }
+    }
+
+/*! Writes the frames handed over by analyze() until a NULL frame is received. Staging buffers are
+    returned to the free pool after they are written. After an error, frames are discarded and the
+    error is reported on the simulation thread by checkWriterError().
+*/
+void DCDDumpWriter::writerLoop()
+    {
+    while (true)
+        {
+        Frame *frame = m_write_queue->wait_and_pop();
+        if (frame == NULL)
+            break;
+
+        bool failed;
+            {
+            boost::mutex::scoped_lock lock(m_writer_error_mutex);
+            failed = m_writer_error;
+            }
+
+        if (!failed)
+            {
+            try
+                {
+                writeFrame(*frame);
+                }
+            catch (const std::exception&)
+                {
+                boost::mutex::scoped_lock lock(m_writer_error_mutex);
+                m_writer_error = true;
+                }
+            }
+
+        m_free_frames->push(frame);
+        }
     }
 
 /*! \param timestep Current time step of the simulation
     The very first call to analyze() will result in the creation (or overwriting) of the
     file fname and the writing of the current timestep snapshot. After that, each call to analyze
     will add a new snapshot to the end of the file.
+
+    With setAsync(), the frame is only staged here and is written later by the background thread.
 */
 void DCDDumpWriter::analyze(unsigned int timestep)
     {
     if (m_prof)
         m_prof->push("Dump DCD");
-   
-    // take particle data snapshot
-    SnapshotParticleData snapshot(m_pdata->getNGlobal());
 
-    m_pdata->takeSnapshot(snapshot);
+    // report errors from frames written in the background
+    checkWriterError();
 
 #ifdef ENABLE_MPI
-    // if we are not the root processor, do not perform file I/O
-    if (m_comm && !m_exec_conf->isRoot())
+    if (m_comm)
         {
-        if (m_prof) m_prof->pop(); 
+        writeFrameCollective(timestep);
+        if (m_prof) m_prof->pop();
         return;
         }
 #endif
 
+    // pick a staging buffer, this only waits if all asynchronous buffers are still queued
+    Frame *frame = &m_frame;
+    if (m_writer_thread)
+        frame = m_free_frames->wait_and_pop();
+
+    // copy the current positions, only the root processor continues to the file I/O
+    if (!stageFrame(*frame, timestep))
+        {
+        if (m_writer_thread)
+            m_free_frames->push(frame);
+        if (m_prof) m_prof->pop();
+        return;
+        }
+
     if (! m_is_initialized)
         initFileIO();
 
-    // the file object
-    fstream file;
-    
     // initialize the file on the first frame written
-    if (m_num_frames_written == 0)
+    if (m_num_frames_queued == 0)
         {
-        // open the file and truncate it
-        file.open(m_fname.c_str(), ios::trunc | ios::out | ios::binary);
-        
-        // write the file header
         m_start_timestep = timestep;
-        write_file_header(file);
         }
     else
         {
         if (m_appending && timestep <= m_last_written_step)
             {
             m_exec_conf->msg->warning() << "dump.dcd: not writing output at timestep " << timestep << " because the file reports that it already has data up to step " << m_last_written_step << endl;
-            
+
+            if (m_writer_thread)
+                m_free_frames->push(frame);
             if (m_prof)
                 m_prof->pop();
             return;
             }
-            
-        // open the file and move the file pointer to the end
-        file.open(m_fname.c_str(), ios::ate | ios::in | ios::out | ios::binary);
-        
+
         // verify the period on subsequent frames
         if ( (timestep - m_start_timestep) % m_period != 0)
             m_exec_conf->msg->warning() << "dump.dcd: writing time step " << timestep << " which is not specified in the period of the DCD file: " << m_start_timestep << " + i * " << m_period << endl;
         }
-        
+    m_num_frames_queued++;
+
+    if (m_writer_thread)
+        m_write_queue->push(frame);
+    else
+        writeFrame(*frame);
+
+    if (m_prof)
+        m_prof->pop();
+    }
+
+/*! \param frame Staged frame to write
+    Creates the file on the first frame, appends the frame and updates the file header.
+*/
+void DCDDumpWriter::writeFrame(const Frame& frame)
+    {
+    // the file object
+    fstream file;
+
+    if (m_num_frames_written == 0)
+        {
+        // open the file and truncate it
+        file.open(m_fname.c_str(), ios::trunc | ios::out | ios::binary);
+        write_file_header(file, frame.x.size());
+        }
+    else
+        {
+        // open the file and move the file pointer to the end
+        file.open(m_fname.c_str(), ios::ate | ios::in | ios::out | ios::binary);
+        }
+
     // write the data for the current time step
-    write_frame_header(file);
-    write_frame_data(file, snapshot);
-    
+    write_frame_header(file, frame);
+    write_frame_data(file, frame);
+
     // update the header with the number of frames written
     m_num_frames_written++;
-    write_updated_header(file, timestep);
+    write_updated_header(file, frame.timestep);
     file.close();
-    
-    if (m_prof)
-        m_prof->pop();
     }
 
+/*! \param pos Position of the particle
+    \param image Image flags of the particle
+    \param body Body the particle belongs to
+    \param orientation Orientation of the particle
+    \param box Global simulation box
+    \param body_image Image flags of the rigid bodies
+    \param unwrap_full True if the particle should be unwrapped into the infinite system
+    \param unwrap_rigid True if rigid body members should be unwrapped next to their body
+    \param angle True if the orientation angle replaces the z coordinate
+    \param x x coordinates of the frame
+    \param y y coordinates of the frame
+    \param z z coordinates of the frame
+    \param group_idx Index of the particle in the group
+
+    Applies the unwrapping options and stores the coordinates of one group member.
+*/
+static inline void stage_particle(Scalar3 pos,
+                                  int3 image,
+                                  unsigned int body,
+                                  Scalar4 orientation,
+                                  const BoxDim& box,
+                                  const int3 *body_image,
+                                  bool unwrap_full,
+                                  bool unwrap_rigid,
+                                  bool angle,
+                                  std::vector<float>& x,
+                                  std::vector<float>& y,
+                                  std::vector<float>& z,
+                                  unsigned int group_idx)
+    {
+    if (unwrap_full)
+        {
+        pos = box.shift(pos, image);
+        }
+    else if (unwrap_rigid && body != NO_BODY)
+        {
+        int3 body_img = body_image[body];
+        int3 img_diff = make_int3(image.x - body_img.x,
+                                  image.y - body_img.y,
+                                  image.z - body_img.z);
+
+        pos = box.shift(pos, img_diff);
+        }
+
+    x[group_idx] = float(pos.x);
+    y[group_idx] = float(pos.y);
+    z[group_idx] = float(pos.z);
+
+    // m_angle set to True turns on a hack where the particle orientation angle is written out to the z component
+    // this only works in 2D simulations, obviously
+    if (angle)
+        {
+        Scalar s = 1;
+        if (orientation.w < 0)
+            s = -1;
+
+        z[group_idx] = acosf(orientation.x) * 2 * s;
+        }
+    }
+
+/*! \param unitcell Array of 6 values to fill out in the order used by the DCD frame header
+*/
+void DCDDumpWriter::computeUnitCell(double *unitcell)
+    {
+    BoxDim box = m_pdata->getGlobalBox();
+    // set box dimensions
+    Scalar a,b,c,alpha,beta,gamma;
+    Scalar3 va = box.getLatticeVector(0);
+    Scalar3 vb = box.getLatticeVector(1);
+    Scalar3 vc = box.getLatticeVector(2);
+    a = sqrt(dot(va,va));
+    b = sqrt(dot(vb,vb));
+    c = sqrt(dot(vc,vc));
+    alpha = dot(vb,vc)/(b*c);
+    beta = dot(va,vc)/(a*c);
+    gamma = dot(va,vb)/(a*b);
+
+    unitcell[0] = a;
+    unitcell[2] = b;
+    unitcell[5] = c;
+    // box angles are 90 degrees
+    unitcell[1] = gamma;
+    unitcell[3] = beta;
+    unitcell[4] = alpha;
+    }
+
+/*! \param frame Frame to fill out
+    \param timestep Current time step of the simulation
+    \returns true if this rank writes the frame
+
+    Computes the unit cell and copies the positions of the group members, in tag order, into \a frame.
+*/
+bool DCDDumpWriter::stageFrame(Frame& frame, unsigned int timestep)
+    {
+    frame.timestep = timestep;
+    computeUnitCell(frame.unitcell);
+
+    BoxDim box = m_pdata->getGlobalBox();
+    unsigned int nparticles = m_group->getNumMembersGlobal();
+    frame.x.resize(nparticles);
+    frame.y.resize(nparticles);
+    frame.z.resize(nparticles);
+
+    ArrayHandle<int3> body_image_handle(m_rigid_data->getBodyImage(),access_location::host,access_mode::read);
+
+    // read the particles directly in tag order
+    ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle<int3> h_image(m_pdata->getImages(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_body(m_pdata->getBodies(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_orientation(m_pdata->getOrientationArray(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_member_tags(m_group->getMemberTagArray(), access_location::host, access_mode::read);
+
+    #pragma omp parallel for schedule(static)
+    for (int group_idx = 0; group_idx < (int)nparticles; group_idx++)
+        {
+        unsigned int i = h_rtag.data[h_member_tags.data[group_idx]];
+        Scalar4 postype = h_pos.data[i];
+        stage_particle(make_scalar3(postype.x, postype.y, postype.z), h_image.data[i], h_body.data[i],
+                       h_orientation.data[i], box, body_image_handle.data, m_unwrap_full, m_unwrap_rigid, m_angle,
+                       frame.x, frame.y, frame.z, group_idx);
+        }
+
+    return true;
+    }
+
+#ifdef ENABLE_MPI
+/*! \param timestep Current time step of the simulation
+
+    All ranks open the file together. The root rank writes the file header, the frame header and the record
+    markers around the x, y and z blocks. Every rank then writes the coordinates of its local group members
+    with MPI_File_write_all() through a file view that scatters them to their group index in each block.
+
+    The group index of a member is the number of members with a smaller tag. Since the member tags are sorted,
+    it is found with a binary search in the member tag list, which every rank already holds.
+*/
+void DCDDumpWriter::writeFrameCollective(unsigned int timestep)
+    {
+    const MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
+    bool root = m_exec_conf->isRoot();
+
+    if (m_unwrap_rigid)
+        {
+        m_exec_conf->msg->error() << "dump.dcd: Unwrap of rigid bodies in DCD files is currently not supported in MPI simulations" << endl;
+        throw runtime_error("Error writing DCD file");
+        }
+
+    if (! m_is_initialized)
+        {
+        // read an existing header on the root rank only and share the result
+        if (root)
+            initFileIO();
+
+        unsigned int header_info[4] = { m_num_frames_written, m_start_timestep, m_last_written_step, m_appending };
+        MPI_Bcast(header_info, 4, MPI_UNSIGNED, 0, mpi_comm);
+        m_num_frames_written = header_info[0];
+        m_start_timestep = header_info[1];
+        m_last_written_step = header_info[2];
+        m_appending = header_info[3];
+        m_num_frames_queued = m_num_frames_written;
+        m_is_initialized = true;
+        }
+
+    if (m_num_frames_written == 0)
+        {
+        m_start_timestep = timestep;
+        }
+    else
+        {
+        if (m_appending && timestep <= m_last_written_step)
+            {
+            if (root)
+                m_exec_conf->msg->warning() << "dump.dcd: not writing output at timestep " << timestep << " because the file reports that it already has data up to step " << m_last_written_step << endl;
+            return;
+            }
+
+        // verify the period on subsequent frames
+        if (root && (timestep - m_start_timestep) % m_period != 0)
+            m_exec_conf->msg->warning() << "dump.dcd: writing time step " << timestep << " which is not specified in the period of the DCD file: " << m_start_timestep << " + i * " << m_period << endl;
+        }
+
+    // stage the local group members in group index order
+    unsigned int nparticles = m_group->getNumMembersGlobal();
+    unsigned int nlocal = m_group->getNumMembers();
+    BoxDim box = m_pdata->getGlobalBox();
+
+    m_frame.timestep = timestep;
+    computeUnitCell(m_frame.unitcell);
+    m_frame.x.resize(nlocal);
+    m_frame.y.resize(nlocal);
+    m_frame.z.resize(nlocal);
+    m_file_offsets.resize(nlocal);
+
+        {
+        ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
+        ArrayHandle<int3> h_image(m_pdata->getImages(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_body(m_pdata->getBodies(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_orientation(m_pdata->getOrientationArray(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_tag(m_pdata->getTags(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_member_idx(m_group->getIndexArray(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_member_tags(m_group->getMemberTagArray(), access_location::host, access_mode::read);
+
+        // sort the local members by tag, which is also their order in the group
+        std::vector< std::pair<unsigned int, unsigned int> > local_members(nlocal);
+        for (unsigned int j = 0; j < nlocal; j++)
+            {
+            unsigned int idx = h_member_idx.data[j];
+            local_members[j] = std::make_pair(h_tag.data[idx], idx);
+            }
+        std::sort(local_members.begin(), local_members.end());
+
+        for (unsigned int j = 0; j < nlocal; j++)
+            {
+            unsigned int tag = local_members[j].first;
+            unsigned int idx = local_members[j].second;
+            m_file_offsets[j] = std::lower_bound(h_member_tags.data, h_member_tags.data + nparticles, tag)
+                                - h_member_tags.data;
+
+            Scalar4 postype = h_pos.data[idx];
+            stage_particle(make_scalar3(postype.x, postype.y, postype.z), h_image.data[idx], h_body.data[idx],
+                           h_orientation.data[idx], box, NULL, m_unwrap_full, false, m_angle,
+                           m_frame.x, m_frame.y, m_frame.z, j);
+            }
+        }
+
+    // layout of the file: header, then per frame the frame header and three blocks of nparticles floats, each
+    // surrounded by record markers
+    bool first_frame = (m_num_frames_written == 0);
+    std::ostringstream file_header;
+    write_file_header(file_header, nparticles);
+    std::ostringstream frame_header;
+    write_frame_header(frame_header, m_frame);
+
+    MPI_Offset block_size = MPI_Offset(nparticles) * sizeof(float);
+
+    MPI_File fh;
+    int amode = first_frame ? (MPI_MODE_WRONLY | MPI_MODE_CREATE) : MPI_MODE_WRONLY;
+    if (MPI_File_open(mpi_comm, (char *)m_fname.c_str(), amode, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+        {
+        m_exec_conf->msg->error() << "dump.dcd: Unable to open \"" << m_fname << "\" for writing" << endl;
+        throw runtime_error("Error writing DCD file");
+        }
+
+    // all frames have the same size, so the offset follows from the number of frames already in the file
+    if (first_frame)
+        MPI_File_set_size(fh, 0);
+    MPI_Offset frame_size = frame_header.str().size() + 3*(block_size + 2*sizeof(unsigned int));
+    MPI_Offset frame_offset = file_header.str().size() + MPI_Offset(m_num_frames_written) * frame_size;
+
+    // the root rank writes all the metadata
+    int error = MPI_SUCCESS;
+    if (root)
+        {
+        std::string file_header_str = file_header.str();
+        std::string frame_header_str = frame_header.str();
+        unsigned int marker = nparticles * sizeof(float);
+
+        if (first_frame)
+            error |= MPI_File_write_at(fh, 0, (void *)file_header_str.data(), file_header_str.size(), MPI_BYTE, MPI_STATUS_IGNORE);
+        error |= MPI_File_write_at(fh, frame_offset, (void *)frame_header_str.data(), frame_header_str.size(), MPI_BYTE, MPI_STATUS_IGNORE);
+
+        MPI_Offset block_offset = frame_offset + frame_header_str.size();
+        for (unsigned int k = 0; k < 3; k++)
+            {
+            error |= MPI_File_write_at(fh, block_offset, &marker, 1, MPI_UNSIGNED, MPI_STATUS_IGNORE);
+            error |= MPI_File_write_at(fh, block_offset + sizeof(unsigned int) + block_size, &marker, 1, MPI_UNSIGNED, MPI_STATUS_IGNORE);
+            block_offset += block_size + 2*sizeof(unsigned int);
+            }
+
+        // update the header with the number of frames written
+        unsigned int num_frames = m_num_frames_written + 1;
+        error |= MPI_File_write_at(fh, NFILE_POS, &num_frames, 1, MPI_UNSIGNED, MPI_STATUS_IGNORE);
+        error |= MPI_File_write_at(fh, NSTEP_POS, &timestep, 1, MPI_UNSIGNED, MPI_STATUS_IGNORE);
+        }
+
+    // every rank scatters its coordinates into the x, y and z blocks
+    MPI_Datatype filetype;
+    MPI_Type_create_indexed_block(nlocal, 1, nlocal ? &m_file_offsets[0] : NULL, MPI_FLOAT, &filetype);
+    MPI_Type_commit(&filetype);
+
+    MPI_Offset block_offset = frame_offset + frame_header.str().size() + sizeof(unsigned int);
+    std::vector<float> *coords[3] = { &m_frame.x, &m_frame.y, &m_frame.z };
+    for (unsigned int k = 0; k < 3; k++)
+        {
+        MPI_File_set_view(fh, block_offset, MPI_FLOAT, filetype, (char *)"native", MPI_INFO_NULL);
+        error |= MPI_File_write_all(fh, nlocal ? &(*coords[k])[0] : NULL, nlocal, MPI_FLOAT, MPI_STATUS_IGNORE);
+        block_offset += block_size + 2*sizeof(unsigned int);
+        }
+
+    MPI_Type_free(&filetype);
+    MPI_File_close(&fh);
+
+    // check for errors on any rank
+    MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_INT, MPI_BOR, mpi_comm);
+    if (error != MPI_SUCCESS)
+        {
+        m_exec_conf->msg->error() << "dump.dcd: I/O error while writing DCD frame with MPI-IO" << endl;
+        throw runtime_error("Error writing DCD file");
+        }
+
+    m_num_frames_written++;
+    m_num_frames_queued++;
+    }
+#endif
+
 /*! \param file File to write to
+    \param nparticles Number of particles in each frame
     Writes the initial DCD header to the beginning of the file. This must be
     called on a newly created (or truncated file).
 */
-void DCDDumpWriter::write_file_header(std::fstream &file)
+void DCDDumpWriter::write_file_header(std::ostream &file, unsigned int nparticles)
     {
     // the first 4 bytes in the file must be 84
     write_int(file, 84);
@@ -295,7 +743,6 @@ void DCDDumpWriter::write_file_header(std::fstream &file)
     
     write_int(file, 164);
     write_int(file, 4);
-    unsigned int nparticles = m_group->getNumMembersGlobal();
     write_int(file, nparticles);
     write_int(file, 4);
     
@@ -308,35 +755,14 @@ void DCDDumpWriter::write_file_header(std::fstream &file)
     }
 
 /*! \param file File to write to
+    \param frame Frame to write
     Writes the header that precedes each snapshot in the file. This header
     includes information on the box size of the simulation.
 */
-void DCDDumpWriter::write_frame_header(std::fstream &file)
+void DCDDumpWriter::write_frame_header(std::ostream &file, const Frame& frame)
     {
-    double unitcell[6];
-    BoxDim box = m_pdata->getGlobalBox();
-    // set box dimensions
-    Scalar a,b,c,alpha,beta,gamma;
-    Scalar3 va = box.getLatticeVector(0);
-    Scalar3 vb = box.getLatticeVector(1);
-    Scalar3 vc = box.getLatticeVector(2);
-    a = sqrt(dot(va,va));
-    b = sqrt(dot(vb,vb));
-    c = sqrt(dot(vc,vc));
-    alpha = dot(vb,vc)/(b*c);
-    beta = dot(va,vc)/(a*c);
-    gamma = dot(va,vb)/(a*b);
-    
-    unitcell[0] = a;
-    unitcell[2] = b;
-    unitcell[5] = c;
-    // box angles are 90 degrees
-    unitcell[1] = gamma;
-    unitcell[3] = beta;
-    unitcell[4] = alpha;
-    
     write_int(file, 48);
-    file.write((char *)unitcell, 48);
+    file.write((char *)frame.unitcell, 48);
     write_int(file, 48);
     
     // check for errors
@@ -348,96 +774,26 @@ void DCDDumpWriter::write_frame_header(std::fstream &file)
     }
 
 /*! \param file File to write to
-    \param snapshot Snapshot to write
+    \param frame Frame to write
     Writes the actual particle positions for all particles at the current time step
 */
-void DCDDumpWriter::write_frame_data(std::fstream &file, const SnapshotParticleData& snapshot)
+void DCDDumpWriter::write_frame_data(std::fstream &file, const Frame& frame)
     {
-    // we need to unsort the positions and write in tag order
-    assert(m_staging_buffer);
-
-#ifdef ENABLE_MPI
-    if (m_comm && m_unwrap_rigid)
-        {
-        m_exec_conf->msg->error() << "dump.dcd: Unwrap of rigid bodies in DCD files is currently not supported in MPI simulations" << endl;
-        throw runtime_error("Error writing DCD file");
-        }
-#endif        
-  
-    ArrayHandle<int3> body_image_handle(m_rigid_data->getBodyImage(),access_location::host,access_mode::read);
-    BoxDim box = m_pdata->getGlobalBox();
-    
-    unsigned int nparticles = m_group->getNumMembersGlobal();
-
-    // Create a tmp copy of the particle data and unwrap particles
-    std::vector<Scalar3> tmp_pos(snapshot.pos);
-    for (unsigned int group_idx = 0; group_idx < nparticles; group_idx++)
-        {
-        unsigned int i = m_group->getMemberTag(group_idx);
-        
-        if (m_unwrap_full)
-            {
-            tmp_pos[i] = box.shift(tmp_pos[i], snapshot.image[i]);
-            }
-        else if (m_unwrap_rigid && snapshot.body[i] != NO_BODY)
-            {
-            int body_ix = body_image_handle.data[snapshot.body[i]].x;
-            int body_iy = body_image_handle.data[snapshot.body[i]].y;
-            int body_iz = body_image_handle.data[snapshot.body[i]].z;
-            int3 particle_img = snapshot.image[i];
-            int3 img_diff = make_int3(particle_img.x - body_ix,
-                                      particle_img.y - body_iy,
-                                      particle_img.z - body_iz);
-            
-            tmp_pos[i] = box.shift(tmp_pos[i], img_diff);
-            }
-        }
-
-    // prepare x coords for writing, looping in tag order
-    for (unsigned int group_idx = 0; group_idx < nparticles; group_idx++)
-        {
-        unsigned int i = m_group->getMemberTag(group_idx);        
-        m_staging_buffer[group_idx] = float(tmp_pos[i].x);
-        }
+    unsigned int nparticles = frame.x.size();
 
     // write x coords
     write_int(file, nparticles * sizeof(float));
-    file.write((char *)m_staging_buffer, nparticles * sizeof(float));
+    file.write((char *)&frame.x[0], nparticles * sizeof(float));
     write_int(file, nparticles * sizeof(float));
-       
-    // prepare y coords for writing
-    for (unsigned int group_idx = 0; group_idx < nparticles; group_idx++)
-        {
-        unsigned int i = m_group->getMemberTag(group_idx);
-        m_staging_buffer[group_idx] = float(tmp_pos[i].y);
-        }
 
     // write y coords
     write_int(file, nparticles * sizeof(float));
-    file.write((char *)m_staging_buffer, nparticles * sizeof(float));
+    file.write((char *)&frame.y[0], nparticles * sizeof(float));
     write_int(file, nparticles * sizeof(float));
-    
-    // prepare z coords for writing
-    for (unsigned int group_idx = 0; group_idx < nparticles; group_idx++)
-        {
-        unsigned int i = m_group->getMemberTag(group_idx);
-        m_staging_buffer[group_idx] = float(tmp_pos[i].z);
-        
-        // m_angle set to True turns on a hack where the particle orientation angle is written out to the z component
-        // this only works in 2D simulations, obviously
-        if (m_angle)
-            {
-            Scalar s = 1;
-            if (snapshot.orientation[i].w < 0)
-                s = -1;
-            
-            m_staging_buffer[group_idx] = acosf(snapshot.orientation[i].x) * 2 * s;
-            }
-        }
-    
+
     // write z coords
     write_int(file, nparticles * sizeof(float));
-    file.write((char *)m_staging_buffer, nparticles * sizeof(float));
+    file.write((char *)&frame.z[0], nparticles * sizeof(float));
     write_int(file, nparticles * sizeof(float));
     
     // check for errors
@@ -470,6 +826,8 @@ void export_DCDDumpWriter()
     .def("setUnwrapFull", &DCDDumpWriter::setUnwrapFull)
     .def("setUnwrapRigid", &DCDDumpWriter::setUnwrapRigid)
     .def("setAngleZ", &DCDDumpWriter::setAngleZ)
+    .def("setAsync", &DCDDumpWriter::setAsync)
+    .def("flush", &DCDDumpWriter::flush)
     ;
     }
 
@@ -54,10 +54,15 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define __DCDDUMPWRITER_H__
 
 #include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
 #include <fstream>
 #include "Analyzer.h"
 #include "ParticleGroup.h"
+#include "WorkQueue.h"
 
 /*! \file DCDDumpWriter.h
     \brief Declares the DCDDumpWriter class
@@ -89,6 +94,16 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     Due to a limitation in the DCD format, the time step period between calls to
     analyze() \b must be specified up front. If analyze() detects that this period is
     not being maintained, it will print a warning but continue.
+
+    analyze() copies the positions of the group members, in tag order, into a Frame staging buffer and then
+    writes the frame and updates the file header. With setAsync(), the file I/O moves to a background writer
+    thread: analyze() only stages the frame and hands it to the writer through a WorkQueue. A pool of
+    \a queue_depth staging buffers is reused, and analyze() blocks only when all of them are waiting to be
+    written. Errors in the writer thread are reported by the next call to analyze() or flush().
+
+    In MPI simulations, frames are written collectively with MPI-IO by writeFrameCollective(). Every rank writes the
+    coordinates of its local group members directly to their offsets in the file, so the particle data is never
+    gathered on a single rank. These writes always happen on the simulation thread; setAsync() has no effect.
     \ingroup analyzers
 */
 class DCDDumpWriter : public Analyzer
@@ -125,6 +140,12 @@ class DCDDumpWriter : public Analyzer
             m_angle = enable;
             }
 
+        //! Write frames in a background thread
+        void setAsync(unsigned int queue_depth);
+
+        //! Wait until all queued frames have been written
+        void flush();
+
     private:
         std::string m_fname;                //!< The file name we are writing to
         unsigned int m_start_timestep;      //!< First time step written to the file
@@ -141,20 +162,59 @@ class DCDDumpWriter : public Analyzer
         bool m_overwrite;                   //!< True if file should be overwritten
         bool m_is_initialized;              //!< True if file IO has been initialized
 
-        float *m_staging_buffer;            //!< Buffer for staging particle positions in tag order
-        
+        //! One frame of output, staged in the order it is written to the file
+        struct Frame
+            {
+            unsigned int timestep;          //!< Time step of the frame
+            double unitcell[6];             //!< Unit cell for the frame header
+            std::vector<float> x;           //!< x coordinates of the group members in tag order
+            std::vector<float> y;           //!< y coordinates of the group members in tag order
+            std::vector<float> z;           //!< z coordinates (or angles) of the group members in tag order
+            };
+
+        Frame m_frame;                      //!< Staging buffer for synchronous writes
+        unsigned int m_num_frames_queued;   //!< Count the number of frames handed to the writer
+
+        unsigned int m_queue_depth;                          //!< Number of staging buffers for asynchronous writes
+        std::vector<Frame> m_async_frames;                   //!< Staging buffers for asynchronous writes
+        boost::scoped_ptr< WorkQueue<Frame *> > m_free_frames;  //!< Staging buffers ready to be filled
+        boost::scoped_ptr< WorkQueue<Frame *> > m_write_queue;  //!< Staged frames waiting to be written
+        boost::scoped_ptr<boost::thread> m_writer_thread;    //!< Background writer thread
+        boost::mutex m_writer_error_mutex;                   //!< Protects m_writer_error
+        bool m_writer_error;                                 //!< True if the writer thread failed to write a frame
+
         // helper functions
         
         //! Initalizes the file header
-        void write_file_header(std::fstream &file);
+        void write_file_header(std::ostream &file, unsigned int nparticles);
         //! Writes the frame header
-        void write_frame_header(std::fstream &file);
+        void write_frame_header(std::ostream &file, const Frame& frame);
         //! Writes the particle positions for a frame
-        void write_frame_data(std::fstream &file, const SnapshotParticleData& snapshot);
+        void write_frame_data(std::fstream &file, const Frame& frame);
         //! Updates the file header
         void write_updated_header(std::fstream &file, unsigned int timestep);
         //! Initializes the output file for writing
         void initFileIO();
+
+        //! Compute the unit cell of the current box
+        void computeUnitCell(double *unitcell);
+        //! Copy the current positions into a staging buffer
+        bool stageFrame(Frame& frame, unsigned int timestep);
+        //! Write one staged frame to the file
+        void writeFrame(const Frame& frame);
+        //! Main loop of the background writer thread
+        void writerLoop();
+        //! Stop the background writer thread after all queued frames are written
+        void stopWriter();
+        //! Throw if the background writer failed
+        void checkWriterError();
+
+#ifdef ENABLE_MPI
+        std::vector<int> m_file_offsets;    //!< Group index of each local member, in increasing order
+
+        //! Write one frame from all ranks with MPI-IO
+        void writeFrameCollective(unsigned int timestep);
+#endif
         
     };
 
@@ -74,7 +74,10 @@ using namespace boost::python;
 #include <boost/iostreams/filter/gzip.hpp>
 #endif
 
+#include <boost/filesystem/operations.hpp>
+
 #include "HOOMDBinaryDumpWriter.h"
+#include "HOOMDBinaryFormat.h"
 #include "BondData.h"
 #include "AngleData.h"
 #include "DihedralData.h"
@@ -99,7 +102,8 @@ static void write_string(ostream &f, const string& str)
     \note .timestep.xml will be apended to the end of \a base_fname when analyze() is called.
 */
 HOOMDBinaryDumpWriter::HOOMDBinaryDumpWriter(boost::shared_ptr<SystemDefinition> sysdef, std::string base_fname)
-        : Analyzer(sysdef), m_base_fname(base_fname), m_alternating(false), m_cur_file(1), m_enable_compression(false)
+        : Analyzer(sysdef), m_base_fname(base_fname), m_alternating(false), m_cur_file(1), m_enable_compression(false),
+          m_chunked(false)
     {
     m_exec_conf->msg->notice(5) << "Constructing HOOMDBinaryDumpWriter: " << base_fname << endl;
     }
@@ -114,6 +118,12 @@ HOOMDBinaryDumpWriter::~HOOMDBinaryDumpWriter()
 */
 void HOOMDBinaryDumpWriter::writeFile(std::string fname, unsigned int timestep)
     {
+    if (m_chunked)
+        {
+        appendFrame(fname, timestep);
+        return;
+        }
+
     // check the file extension and warn the user
     string ext = fname.substr(fname.size()-3, fname.size());
     bool gz_ext = false;
@@ -226,6 +236,24 @@ void HOOMDBinaryDumpWriter::writeFile(std::string fname, unsigned int timestep)
         throw runtime_error("Error writing HOOMD dump file");
         }
     
+    writeSystemData(f);
+
+    if (!f.good())
+        {
+        m_exec_conf->msg->error() << "dump.bin: I/O error writing HOOMD dump file" << endl;
+        throw runtime_error("Error writing HOOMD dump file");
+        }
+        
+    }
+
+/*! \param f Stream to write to
+
+    Writes the integrator states, bonds, angles, dihedrals, impropers, walls and rigid bodies.
+*/
+void HOOMDBinaryDumpWriter::writeSystemData(std::ostream& f)
+    {
+    unsigned int ntypes = 0;
+
     //Output the integrator states to the binary file
     {
     shared_ptr<IntegratorData> integrator_data = m_sysdef->getIntegratorData();
@@ -420,14 +448,174 @@ void HOOMDBinaryDumpWriter::writeFile(std::string fname, unsigned int timestep)
         f.write((char*)&(body_image_handle.data[body].z), sizeof(int));
         
         }
-    }    
-                
+    }
+    }
+
+//! Helper function to add a column of per-particle data to a frame
+template<class T> static void add_column(std::vector<BinaryColumn>& columns,
+                                         const std::string& name,
+                                         const std::vector<T>& values,
+                                         bool compress)
+    {
+    BinaryColumn column;
+    column.name = name;
+    column.element_size = sizeof(T);
+    column.raw_size = values.size()*sizeof(T);
+    encode_binary_column(column, values.size() ? (const char *)&values[0] : NULL, compress);
+    columns.push_back(column);
+    }
+
+/*! \param fname File to append the frame to
+    \param timestep Current time step of the simulation
+
+    The file is created if it does not exist yet. The per-particle data is written in tag order, one column per
+    component, so that the columns compress well.
+*/
+void HOOMDBinaryDumpWriter::appendFrame(const std::string& fname, unsigned int timestep)
+    {
+    using boost::uint64_t;
+
+    // find the end of the frames already in the file
+    std::vector<BinaryFrameEntry> frames;
+    uint64_t end_of_frames = 2*sizeof(unsigned int);
+    unsigned int magic = 0x444d4f48;
+    int version = hoomd_bin_chunked_version;
+
+    fstream f;
+    if (filesystem::exists(fname) && filesystem::file_size(fname) > 0)
+        {
+        f.open(fname.c_str(), ios::in | ios::out | ios::binary);
+
+        unsigned int file_magic = 0;
+        int file_version = 0;
+        f.read((char*)&file_magic, sizeof(unsigned int));
+        f.read((char*)&file_version, sizeof(int));
+        if (!f.good() || file_magic != magic || file_version != version)
+            {
+            m_exec_conf->msg->error() << "dump.bin: " << fname << " is not a chunked binary file, cannot append to it"
+                                      << endl;
+            throw runtime_error("Error writing hoomd binary dump file");
+            }
+
+        end_of_frames = read_binary_frame_index(f, filesystem::file_size(fname), frames);
+        }
+    else
+        {
+        f.open(fname.c_str(), ios::out | ios::binary);
+        f.write((char*)&magic, sizeof(unsigned int));
+        f.write((char*)&version, sizeof(int));
+        }
+
     if (!f.good())
+        {
+        m_exec_conf->msg->error() << "dump.bin: Unable to open dump file for writing: " << fname << endl;
+        throw runtime_error("Error writing hoomd binary dump file");
+        }
+
+    // gather the particle data in tag order
+    unsigned int np = m_pdata->getN();
+    std::vector<Scalar> x(np), y(np), z(np), vx(np), vy(np), vz(np), ax(np), ay(np), az(np);
+    std::vector<Scalar> mass(np), diameter(np), charge(np);
+    std::vector<int> ix(np), iy(np), iz(np);
+    std::vector<unsigned int> body(np), type(np);
+
+        {
+        ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::read);
+        ArrayHandle<int3> h_image(m_pdata->getImages(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_body(m_pdata->getBodies(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_charge(m_pdata->getCharges(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_diameter(m_pdata->getDiameters(), access_location::host, access_mode::read);
+
+        for (unsigned int tag = 0; tag < np; tag++)
+            {
+            unsigned int idx = h_rtag.data[tag];
+            x[tag] = h_pos.data[idx].x; y[tag] = h_pos.data[idx].y; z[tag] = h_pos.data[idx].z;
+            ix[tag] = h_image.data[idx].x; iy[tag] = h_image.data[idx].y; iz[tag] = h_image.data[idx].z;
+            vx[tag] = h_vel.data[idx].x; vy[tag] = h_vel.data[idx].y; vz[tag] = h_vel.data[idx].z;
+            ax[tag] = h_accel.data[idx].x; ay[tag] = h_accel.data[idx].y; az[tag] = h_accel.data[idx].z;
+            mass[tag] = h_vel.data[idx].w;
+            diameter[tag] = h_diameter.data[idx];
+            charge[tag] = h_charge.data[idx];
+            body[tag] = h_body.data[idx];
+            type[tag] = __scalar_as_int(h_pos.data[idx].w);
+            }
+        }
+
+    std::vector<BinaryColumn> columns;
+    add_column(columns, "position_x", x, m_enable_compression);
+    add_column(columns, "position_y", y, m_enable_compression);
+    add_column(columns, "position_z", z, m_enable_compression);
+    add_column(columns, "image_x", ix, m_enable_compression);
+    add_column(columns, "image_y", iy, m_enable_compression);
+    add_column(columns, "image_z", iz, m_enable_compression);
+    add_column(columns, "velocity_x", vx, m_enable_compression);
+    add_column(columns, "velocity_y", vy, m_enable_compression);
+    add_column(columns, "velocity_z", vz, m_enable_compression);
+    add_column(columns, "acceleration_x", ax, m_enable_compression);
+    add_column(columns, "acceleration_y", ay, m_enable_compression);
+    add_column(columns, "acceleration_z", az, m_enable_compression);
+    add_column(columns, "mass", mass, m_enable_compression);
+    add_column(columns, "diameter", diameter, m_enable_compression);
+    add_column(columns, "charge", charge, m_enable_compression);
+    add_column(columns, "body", body, m_enable_compression);
+    add_column(columns, "type", type, m_enable_compression);
+
+    // everything else is serialized into a single column
+        {
+        ostringstream topology(ios::out | ios::binary);
+        unsigned int ntypes = m_pdata->getNTypes();
+        topology.write((char*)&ntypes, sizeof(unsigned int));
+        for (unsigned int i = 0; i < ntypes; i++)
+            write_string(topology, m_pdata->getNameByType(i));
+        writeSystemData(topology);
+
+        string data = topology.str();
+        std::vector<char> bytes(data.begin(), data.end());
+        add_column(columns, "topology", bytes, m_enable_compression);
+        }
+
+    Scalar3 L = m_pdata->getBox().getL();
+    double box[3] = { L.x, L.y, L.z };
+    unsigned int dimensions = m_sysdef->getNDimensions();
+    unsigned int n_columns = columns.size();
+
+    uint64_t frame_size = 4*sizeof(unsigned int) + 3*sizeof(double);
+    for (unsigned int i = 0; i < n_columns; i++)
+        frame_size += columns[i].getFileSize();
+
+    // the new frame replaces the old index
+    BinaryFrameEntry entry;
+    entry.timestep = timestep;
+    entry.offset = end_of_frames;
+    frames.push_back(entry);
+
+    f.seekp(end_of_frames, ios::beg);
+    f.write((char*)&hoomd_bin_frame_magic, sizeof(unsigned int));
+    f.write((char*)&frame_size, sizeof(uint64_t));
+    f.write((char*)&timestep, sizeof(unsigned int));
+    f.write((char*)&dimensions, sizeof(unsigned int));
+    f.write((char*)box, 3*sizeof(double));
+    f.write((char*)&np, sizeof(unsigned int));
+    f.write((char*)&n_columns, sizeof(unsigned int));
+    for (unsigned int i = 0; i < n_columns; i++)
+        write_binary_column(f, columns[i]);
+
+    write_binary_frame_index(f, frames);
+    uint64_t file_size = f.tellp();
+    f.close();
+
+    if (f.fail())
         {
         m_exec_conf->msg->error() << "dump.bin: I/O error writing HOOMD dump file" << endl;
         throw runtime_error("Error writing HOOMD dump file");
         }
-        
+
+    // drop the remains of a longer index that was overwritten
+    if (filesystem::file_size(fname) > file_size)
+        filesystem::resize_file(fname, file_size);
     }
 
 /*! \param timestep Current time step of the simulation
@@ -438,7 +626,12 @@ void HOOMDBinaryDumpWriter::analyze(unsigned int timestep)
     if (m_prof)
         m_prof->push("Dump BIN");
     
-    if (!m_alternating)
+    if (m_chunked && !m_alternating)
+        {
+        // all frames go into the same file
+        appendFrame(m_base_fname, timestep);
+        }
+    else if (!m_alternating)
         {
         ostringstream full_fname;
         string filetype = ".bin";
@@ -496,6 +689,13 @@ void HOOMDBinaryDumpWriter::enableCompression(bool enable_compression)
     #endif
     }
 
+/* \param chunked Set to true to append frames to a single file in the chunked format
+*/
+void HOOMDBinaryDumpWriter::setChunked(bool chunked)
+    {
+    m_chunked = chunked;
+    }
+
 void export_HOOMDBinaryDumpWriter()
     {
     class_<HOOMDBinaryDumpWriter, boost::shared_ptr<HOOMDBinaryDumpWriter>, bases<Analyzer>, boost::noncopyable>
@@ -503,6 +703,7 @@ void export_HOOMDBinaryDumpWriter()
     .def("writeFile", &HOOMDBinaryDumpWriter::writeFile)
     .def("setAlternatingWrites", &HOOMDBinaryDumpWriter::setAlternatingWrites)
     .def("enableCompression", &HOOMDBinaryDumpWriter::enableCompression)
+    .def("setChunked", &HOOMDBinaryDumpWriter::setChunked)
     ;
     }
 
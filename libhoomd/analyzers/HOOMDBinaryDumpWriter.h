@@ -59,6 +59,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 #include <string>
+#include <iostream>
 
 #include <boost/shared_ptr.hpp>
 
@@ -86,6 +87,10 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
     Future versions will include the ability to dump forces on each particle to the file also.
 
+    With setChunked(), every call to analyze() or writeFile() appends a frame to a single file in the chunked,
+    column-oriented format (see \ref page_chunked_bin) instead of writing a new file. Compression then applies to
+    each column separately.
+
     For information on the structure of the xml file format: see \ref page_dev_info
     Although, HOOMD's  user guide probably has a more up to date documentation on the format.
     \ingroup analyzers
@@ -107,6 +112,8 @@ class HOOMDBinaryDumpWriter : public Analyzer
         void setAlternatingWrites(const std::string& fname1, const std::string& fname2);
         //! Enable or disable gzip compression of the binary output files
         void enableCompression(bool enable_compression);
+        //! Enable or disable writing frames to a single file in the chunked format
+        void setChunked(bool chunked);
     private:
         std::string m_base_fname;   //!< String used to store the file name of the XML file
         std::string m_fname1;       //!< File name for the first file to write to in alternating mode
@@ -114,6 +121,12 @@ class HOOMDBinaryDumpWriter : public Analyzer
         bool m_alternating;         //!< True if we are to write to m_fname1 and m_fname in an alternating fasion
         unsigned int m_cur_file;    //!< Current index of the file we are writing to (1 or 2)
         bool m_enable_compression;  //!< True if gzip compression should be enabled
+        bool m_chunked;             //!< True if frames are appended to a file in the chunked format
+
+        //! Appends a frame to a file in the chunked format
+        void appendFrame(const std::string& fname, unsigned int timestep);
+        //! Writes everything but the per-particle data
+        void writeSystemData(std::ostream& f);
         };
 
 //! Exports the HOOMDBinaryDumpWriter class to python
@@ -86,7 +86,8 @@ Logger::Logger(boost::shared_ptr<SystemDefinition> sysdef,
                const std::string& fname,
                const std::string& header_prefix,
                bool overwrite)
-    : Analyzer(sysdef), m_delimiter("\t"), m_filename(fname), m_header_prefix(header_prefix), m_appending(!overwrite), m_is_initialized(false)
+    : Analyzer(sysdef), m_delimiter("\t"), m_filename(fname), m_header_prefix(header_prefix), m_appending(!overwrite), m_is_initialized(false),
+      m_binary(false), m_batch_size(1), m_num_pending(0)
     {
     m_exec_conf->msg->notice(5) << "Constructing Logger: " << fname << " " << header_prefix << " " << overwrite << endl;
     }
@@ -99,16 +100,22 @@ void Logger::openOutputFiles()
         if (! m_exec_conf->isRoot())
             return;
 #endif
+    ios_base::openmode mode = m_binary ? ios_base::binary : ios_base::openmode(0);
+
+    // an empty binary file has no header to append to
+    if (m_binary && exists(m_filename) && file_size(m_filename) == 0)
+        m_appending = false;
+
     // open the file
     if (exists(m_filename) && m_appending)
         {
         m_exec_conf->msg->notice(3) << "analyze.log: Appending log to existing file \"" << m_filename << "\"" << endl;
-        m_file.open(m_filename.c_str(), ios_base::in | ios_base::out | ios_base::ate);
+        m_file.open(m_filename.c_str(), mode | ios_base::in | ios_base::out | ios_base::ate);
         }
     else
         {
         m_exec_conf->msg->notice(3) << "analyze.log: Creating new log in file \"" << m_filename << "\"" << endl;
-        m_file.open(m_filename.c_str(), ios_base::out);
+        m_file.open(m_filename.c_str(), mode | ios_base::out);
         m_appending = false;
         }
         
@@ -117,11 +124,93 @@ void Logger::openOutputFiles()
         m_exec_conf->msg->error() << "analyze.log: Error opening log file " << m_filename << endl;
         throw runtime_error("Error initializing Logger");
         }
+
+    // read the columns of an existing binary log, so that new rows can be checked against them
+    if (m_binary && m_appending)
+        {
+        ifstream header(m_filename.c_str(), ios_base::in | ios_base::binary);
+
+        char magic[8];
+        unsigned int version = 0, n_columns = 0;
+        header.read(magic, 8);
+        header.read((char *)&version, sizeof(unsigned int));
+        header.read((char *)&n_columns, sizeof(unsigned int));
+        if (!header.good() || string(magic, 8) != "HOOMDLOG" || version != 1)
+            {
+            m_exec_conf->msg->error() << "analyze.log: " << m_filename << " is not a binary log, cannot append to it"
+                                      << endl;
+            throw runtime_error("Error initializing Logger");
+            }
+
+        m_binary_columns.resize(n_columns);
+        for (unsigned int i = 0; i < n_columns; i++)
+            {
+            unsigned int len = 0;
+            header.read((char *)&len, sizeof(unsigned int));
+            m_binary_columns[i].resize(len);
+            if (len)
+                header.read(&m_binary_columns[i][0], len);
+            }
+
+        if (!header.good())
+            {
+            m_exec_conf->msg->error() << "analyze.log: Error reading the header of " << m_filename << endl;
+            throw runtime_error("Error initializing Logger");
+            }
+        }
+    }
+
+/*! \param quantities Logged quantities (without the timestep)
+
+    The header is written only once. If the file already has a header, the columns have to match it.
+*/
+void Logger::writeBinaryHeader(const std::vector< std::string >& quantities)
+    {
+    vector< string > columns;
+    columns.push_back("timestep");
+    columns.insert(columns.end(), quantities.begin(), quantities.end());
+
+    if (m_binary_columns.size())
+        {
+        if (columns != m_binary_columns)
+            {
+            m_exec_conf->msg->error() << "analyze.log: The quantities written to a binary log cannot change" << endl;
+            throw runtime_error("Error setting logged quantities");
+            }
+        return;
+        }
+
+    unsigned int version = 1;
+    unsigned int n_columns = columns.size();
+    m_file.write("HOOMDLOG", 8);
+    m_file.write((const char *)&version, sizeof(unsigned int));
+    m_file.write((const char *)&n_columns, sizeof(unsigned int));
+    for (unsigned int i = 0; i < n_columns; i++)
+        {
+        unsigned int len = columns[i].size();
+        m_file.write((const char *)&len, sizeof(unsigned int));
+        m_file.write(columns[i].c_str(), len);
+        }
+    m_file.flush();
+
+    m_binary_columns = columns;
     }
 
 Logger::~Logger()
     {
     m_exec_conf->msg->notice(5) << "Destroying Logger" << endl;
+
+    // write out the remaining rows, errors can no longer be reported
+    if (m_num_pending)
+        {
+        try
+            {
+            flush();
+            }
+        catch (...)
+            {
+            }
+        }
     }
 
 /*! \param compute The Compute to register
@@ -202,6 +291,17 @@ void Logger::setLoggedQuantities(const std::vector< std::string >& quantities)
 
     m_is_initialized = true;
 
+    // rows with the previous quantities go before the new header
+    flush();
+
+    if (m_binary)
+        {
+        if (quantities.size() == 0)
+            m_exec_conf->msg->warning() << "analyze.log: No quantities specified for logging" << endl;
+        writeBinaryHeader(quantities);
+        return;
+        }
+
     // only write the header if this is a new file
     if (!m_appending)
         {
@@ -241,10 +341,67 @@ void Logger::setDelimiter(const std::string& delimiter)
     m_delimiter = delimiter;
     }
 
+/*! \param binary True to write the log in the binary format
+
+    The format has to be selected before the quantities are set, because that is when the file is opened.
+*/
+void Logger::setBinary(bool binary)
+    {
+    if (m_is_initialized && binary != m_binary)
+        {
+        m_exec_conf->msg->error() << "analyze.log: Cannot change the file format after the log is opened" << endl;
+        throw runtime_error("Error setting log format");
+        }
+    m_binary = binary;
+    }
+
+/*! \param batch_size Number of rows that are collected before they are written to the file
+*/
+void Logger::setBatchSize(unsigned int batch_size)
+    {
+    if (batch_size == 0)
+        {
+        m_exec_conf->msg->error() << "analyze.log: batch_size must be at least 1" << endl;
+        throw runtime_error("Error setting log batch size");
+        }
+    m_batch_size = batch_size;
+
+    if (m_num_pending >= m_batch_size)
+        flush();
+    }
+
+/*! Writes all rows collected since the last write to the file, and flushes the file.
+*/
+void Logger::flush()
+    {
+    if (!m_file.is_open())
+        return;
+
+    if (m_binary)
+        {
+        if (m_binary_batch.size())
+            m_file.write((const char *)&m_binary_batch[0], m_binary_batch.size()*sizeof(double));
+        m_binary_batch.clear();
+        }
+    else
+        {
+        m_file << m_text_batch.str();
+        m_text_batch.str("");
+        }
+    m_file.flush();
+    m_num_pending = 0;
+
+    if (!m_file.good())
+        {
+        m_exec_conf->msg->error() << "analyze.log: I/O error while writing log file" << endl;
+        throw runtime_error("Error writting log file");
+        }
+    }
+
 /*! \param timestep Time step to write out data for
 
-    Writes a single line of output to the log file with each specified quantity separated by
-    the delimiter;
+    Adds a single row to the log with each specified quantity separated by the delimiter (or in the binary format).
+    The row is written to the file once the batch is full.
 */
 void Logger::analyze(unsigned int timestep)
     {
@@ -265,30 +422,27 @@ void Logger::analyze(unsigned int timestep)
 #endif
 
     // The timestep is always output
-    m_file << setprecision(10) << timestep;
     cached_timestep = timestep;
-    
-    // quit now if there is nothing to log
-    if (m_logged_quantities.size() == 0)
+
+    if (m_binary)
         {
-        return;
+        m_binary_batch.push_back(double(timestep));
+        for (unsigned int i = 0; i < m_logged_quantities.size(); i++)
+            m_binary_batch.push_back(double(cached_quantities[i]));
         }
-        
-    // only print the delimiter after the timestep if there are more quantities logged
-    m_file << m_delimiter;
-       
-    // write all but the last of the quantities separated by the delimiter
-    for (unsigned int i = 0; i < m_logged_quantities.size()-1; i++)
-        m_file << setprecision(10) << cached_quantities[i] << m_delimiter;
-    // write the last one with no delimiter after it
-    m_file << setprecision(10) << cached_quantities[m_logged_quantities.size()-1] << endl;
-    m_file.flush();
-    
-    if (!m_file.good())
+    else
         {
-        m_exec_conf->msg->error() << "analyze.log: I/O error while writing log file" << endl;
-        throw runtime_error("Error writting log file");
+        m_text_batch << setprecision(10) << timestep;
+
+        // write all of the quantities, each preceded by the delimiter
+        for (unsigned int i = 0; i < m_logged_quantities.size(); i++)
+            m_text_batch << m_delimiter << setprecision(10) << cached_quantities[i];
+        m_text_batch << endl;
         }
+
+    m_num_pending++;
+    if (m_num_pending >= m_batch_size)
+        flush();
         
     if (m_prof) m_prof->pop();
     }
@@ -353,6 +507,9 @@ void export_Logger()
     .def("removeAll", &Logger::removeAll)
     .def("setLoggedQuantities", &Logger::setLoggedQuantities)
     .def("setDelimiter", &Logger::setDelimiter)
+    .def("setBinary", &Logger::setBinary)
+    .def("setBatchSize", &Logger::setBatchSize)
+    .def("flush", &Logger::flush)
     .def("getCachedQuantity", &Logger::getCachedQuantity)
     ;
     }
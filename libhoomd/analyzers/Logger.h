@@ -62,6 +62,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <vector>
 #include <map>
 #include <fstream>
+#include <sstream>
 
 #include <boost/shared_ptr.hpp>
 
@@ -89,6 +90,15 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     The removeAll method can be used to clear all registered computes and updaters. hoomd_script will
     removeAll() and re-register all active computes and updaters before every run()
 
+    Rows are kept in memory and written to the file in batches of setBatchSize() rows (1 by default, which writes
+    every row immediately). flush() writes out any pending rows; hoomd_script calls it at the end of every run().
+
+    With setBinary(), the log is written in a binary format instead of delimited text. The file starts with a header:
+    the magic string \c HOOMDLOG, the format version (uint32, currently 1), the number of columns (uint32) and for
+    each column the length of its name (uint32) followed by the name. The first column is always \c timestep. The
+    header is followed by the rows, each consisting of one float64 value per column. All values are in the byte order
+    of the machine that wrote the file.
+
     \ingroup analyzers
 */
 class Logger : public Analyzer
@@ -117,6 +127,15 @@ class Logger : public Analyzer
         
         //! Sets the delimiter to use between fields
         void setDelimiter(const std::string& delimiter);
+
+        //! Selects the binary file format
+        void setBinary(bool binary);
+
+        //! Sets the number of rows that are collected before they are written to the file
+        void setBatchSize(unsigned int batch_size);
+
+        //! Write all pending rows to the file
+        void flush();
         
         //! Query the last logged value for a given quantity
         Scalar getCachedQuantity(const std::string& quantity="timestep");
@@ -161,12 +180,27 @@ class Logger : public Analyzer
         std::vector< Scalar > cached_quantities;
         //! Flag to indicate whether we have initialized the file IO
         bool m_is_initialized;
+        //! True if the log is written in the binary format
+        bool m_binary;
+        //! Number of rows collected before they are written
+        unsigned int m_batch_size;
+        //! Number of rows collected since the last write
+        unsigned int m_num_pending;
+        //! Rows in the text format that are not yet written
+        std::ostringstream m_text_batch;
+        //! Rows in the binary format that are not yet written
+        std::vector<double> m_binary_batch;
+        //! Column names in the header of the binary file (empty if there is no header yet)
+        std::vector< std::string > m_binary_columns;
 
         //! Helper function to get a value for a given quantity
         Scalar getValue(const std::string &quantity, int timestep);
 
         //! Helper function to open output files
         void openOutputFiles();
+
+        //! Helper function to write or check the header of a binary log
+        void writeBinaryHeader(const std::vector< std::string >& quantities);
     };
 
 //! exports the Logger class to python
@@ -166,6 +166,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifdef ENABLE_MPI
 #include "Communicator.h"
 #include "DomainDecomposition.h"
+#include "LoadBalancer.h"
 #include "HOOMDMPI.h"
 #ifdef ENABLE_CUDA
 #include "CommunicatorGPU.h"
@@ -62,6 +62,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <boost/bind.hpp>
 #include <boost/python.hpp>
 #include <algorithm>
+#include <string.h>
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
 using namespace boost::python;
@@ -212,14 +213,13 @@ Communicator::Communicator(boost::shared_ptr<SystemDefinition> sysdef,
             m_sendbuf(m_exec_conf),
             m_recvbuf(m_exec_conf),
             m_pos_copybuf(m_exec_conf),
-            m_charge_copybuf(m_exec_conf),
-            m_diameter_copybuf(m_exec_conf),
-            m_plan_copybuf(m_exec_conf),
-            m_tag_copybuf(m_exec_conf),
             m_r_ghost(Scalar(0.0)),
             m_r_buff(Scalar(0.0)),
             m_resize_factor(9.f/8.f),
             m_plan(m_exec_conf),
+            m_overlap(false),
+            m_ghosts_pending(false),
+            m_num_ghost_reqs(0),
             m_is_first_step(true)
     {
     // initialize array of neighbor processor ids
@@ -241,6 +241,8 @@ Communicator::Communicator(boost::shared_ptr<SystemDefinition> sysdef,
         m_copy_ghosts[dir].swap(copy_ghosts);
         m_num_copy_ghosts[dir] = 0;
         m_num_recv_ghosts[dir] = 0;
+        m_num_copy_local_ghosts[dir] = 0;
+        m_num_recv_local_ghosts[dir] = 0;
         }
 
     if (m_sysdef->getBondData()->getNumBondsGlobal())
@@ -418,6 +420,9 @@ void Communicator::communicate(unsigned int timestep)
     // Guard to prevent recursive triggering of migration
     m_is_communicating = true;
 
+    // complete a ghost update that is still in flight
+    finishUpdateGhosts(timestep);
+
    // Check if migration of particles is requested
     if (m_force_migrate || m_migrate_requests(timestep) || m_is_first_step)
         {
@@ -427,13 +432,19 @@ void Communicator::communicate(unsigned int timestep)
         // If so, migrate atoms
         migrateParticles();
 
+        // determine the optional fields to send with the ghosts
+        m_flags = m_requested_flags(timestep);
+
         // Construct ghost send lists, exchange ghost atom data
         exchangeGhosts();
         }
     else
         {
-        // just update ghost positions
-        updateGhosts(timestep);
+        // just update ghost positions, the force computation completes the update if it is overlapped
+        if (m_overlap)
+            beginUpdateGhosts(timestep);
+        else
+            updateGhosts(timestep);
         }
  
     m_is_communicating = false;
@@ -495,16 +506,24 @@ void Communicator::migrateParticles()
                neighboring processor.
              */
 
-            // Fill key vector with indices 0...N-1
-            std::vector<unsigned int> sort_keys(m_pdata->getN());
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            // particles in front of the first one that leaves stay where they are, so only the remainder is
+            // reordered (usually, no particle leaves in a given direction and nothing is reordered at all)
+            select_particle_migrate stays(box, dir, h_pos.data);
+            unsigned int first_send = 0;
+            while (first_send < m_pdata->getN() && stays(first_send))
+                first_send++;
+
+            // Fill key vector with indices first_send...N-1
+            if (sort_keys.size() < m_pdata->getN())
+                sort_keys.resize(m_pdata->getN());
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 sort_keys[i] = i;
 
             // partition the keys according to the particle positions corresponding to the indices
             std::vector<unsigned int>::iterator sort_keys_middle;
-            sort_keys_middle = std::stable_partition(sort_keys.begin(),
+            sort_keys_middle = std::stable_partition(sort_keys.begin() + first_send,
                                                  sort_keys.begin() + m_pdata->getN(),
-                                                 select_particle_migrate(box, dir, h_pos.data));
+                                                 stays);
 
             n_send_ptls = (sort_keys.begin() + m_pdata->getN()) - sort_keys_middle;
 
@@ -524,53 +543,53 @@ void Communicator::migrateParticles()
             if (int3_tmp.size() < m_pdata->getN()) 
                 int3_tmp.resize(m_pdata->getN());
 
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 scal4_tmp[i] = h_pos.data[sort_keys[i]];
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 h_pos.data[i] = scal4_tmp[i];
 
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 scal4_tmp[i] = h_vel.data[sort_keys[i]];
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 h_vel.data[i] = scal4_tmp[i];
 
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 scal3_tmp[i] = h_accel.data[sort_keys[i]];
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 h_accel.data[i] = scal3_tmp[i];
 
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 scal_tmp[i] = h_charge.data[sort_keys[i]];
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 h_charge.data[i] = scal_tmp[i];
 
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 scal_tmp[i] = h_diameter.data[sort_keys[i]];
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 h_diameter.data[i] = scal_tmp[i];
 
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 int3_tmp[i] = h_image.data[sort_keys[i]];
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 h_image.data[i] = int3_tmp[i];
 
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 scal4_tmp[i] = h_orientation.data[sort_keys[i]];
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 h_orientation.data[i] = scal4_tmp[i];
 
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 uint_tmp[i] = h_body.data[sort_keys[i]];
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 h_body.data[i] = uint_tmp[i];
 
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 uint_tmp[i] = h_tag.data[sort_keys[i]];
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 h_tag.data[i] = uint_tmp[i];
 
             // update reverse lookup tags
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
+            for (unsigned int i = first_send; i < m_pdata->getN(); i++)
                 h_rtag.data[h_tag.data[i]] = i;
             }
 
@@ -639,9 +658,12 @@ void Communicator::migrateParticles()
         // remove particles from local data that are being sent
         m_pdata->removeParticles(n_send_ptls);
 
+        // the particles and bonds are sent in a single message, which starts with the number of particles and bonds
+        const unsigned int header_size = 2*sizeof(unsigned int);
+        const unsigned int bond_offset = header_size + n_send_ptls*m_packed_size;
 
         // resize send buffer
-        m_sendbuf.resize(n_send_ptls*m_packed_size);
+        m_sendbuf.resize(bond_offset + n_send_bonds*sizeof(bond_element));
 
             {
             ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
@@ -658,6 +680,9 @@ void Communicator::migrateParticles()
 
             ArrayHandle<char> h_sendbuf(m_sendbuf, access_location::host, access_mode::overwrite);
 
+            unsigned int header[2] = { n_send_ptls, n_send_bonds };
+            memcpy(h_sendbuf.data, header, header_size);
+
             for (unsigned int i = 0;  i<  n_send_ptls; i++)
                 {
                 unsigned int idx = m_pdata->getN() + i;
@@ -678,7 +703,13 @@ void Communicator::migrateParticles()
                 assert(h_rtag.data[h_tag.data[idx]] < m_pdata->getN() + n_send_ptls);
                 h_rtag.data[h_tag.data[idx]] = NOT_LOCAL;
 
-                ( (pdata_element *) h_sendbuf.data)[i] = p;
+                memcpy(h_sendbuf.data + header_size + i*m_packed_size, &p, m_packed_size);
+                }
+
+            if (n_send_bonds)
+                {
+                ArrayHandle<bond_element> h_bond_send_buf(m_bond_send_buf, access_location::host, access_mode::read);
+                memcpy(h_sendbuf.data + bond_offset, h_bond_send_buf.data, n_send_bonds*sizeof(bond_element));
                 }
             }
         if (m_prof)
@@ -697,45 +728,42 @@ void Communicator::migrateParticles()
             m_prof->push("MPI send/recv");
 
         unsigned int n_recv_ptls;
-
-        // communicate size of the message that will contain the particle data
-        MPI_Request reqs[2];
-        MPI_Status status[2];
-
-        MPI_Isend(&n_send_ptls, sizeof(unsigned int), MPI_BYTE, send_neighbor, 0, m_mpi_comm, & reqs[0]);
-        MPI_Irecv(&n_recv_ptls, sizeof(unsigned int), MPI_BYTE, recv_neighbor, 0, m_mpi_comm, & reqs[1]);
-        MPI_Waitall(2, reqs, status);
-
-        // Resize receive buffer 
-        m_recvbuf.resize(n_recv_ptls*m_packed_size);
+        unsigned int n_recv_bonds;
 
             {
+            // send the packed particles and receive a message of unknown size from the opposite neighbor
             ArrayHandle<char> h_sendbuf(m_sendbuf, access_location::host, access_mode::read);
-            ArrayHandle<char> h_recvbuf(m_recvbuf, access_location::host, access_mode::overwrite);
-            // exchange actual particle data
-            MPI_Isend(h_sendbuf.data, n_send_ptls*m_packed_size, MPI_BYTE, send_neighbor, 1, m_mpi_comm, & reqs[0]);
-            MPI_Irecv(h_recvbuf.data, n_recv_ptls*m_packed_size, MPI_BYTE, recv_neighbor, 1, m_mpi_comm, & reqs[1]);
-            MPI_Waitall(2, reqs, status);
-            }
 
-        if (m_prof)
-            m_prof->pop();
+            MPI_Request req;
+            MPI_Status status;
+            MPI_Isend(h_sendbuf.data, m_sendbuf.size(), MPI_BYTE, send_neighbor, 0, m_mpi_comm, &req);
 
-        const BoxDim shifted_box = getShiftedBox();
+            int recv_bytes;
+            MPI_Probe(recv_neighbor, 0, m_mpi_comm, &status);
+            MPI_Get_count(&status, MPI_BYTE, &recv_bytes);
 
-            {
-            // wrap received particles across a global boundary back into global box
-            ArrayHandle<char> h_recvbuf(m_recvbuf, access_location::host, access_mode::readwrite);
-            for (unsigned int idx = 0; idx < n_recv_ptls; idx++)
+            // the receive buffer grows as needed, but it is never shrunk
+            m_recvbuf.resize(recv_bytes);
                 {
-                pdata_element& p = ((pdata_element *) h_recvbuf.data)[idx];
-                Scalar4& postype = p.pos;
-                int3& image = p.image;
-
-                shifted_box.wrap(postype, image); 
+                ArrayHandle<char> h_recvbuf(m_recvbuf, access_location::host, access_mode::overwrite);
+                MPI_Recv(h_recvbuf.data, recv_bytes, MPI_BYTE, recv_neighbor, 0, m_mpi_comm, &status);
+
+                unsigned int header[2];
+                memcpy(header, h_recvbuf.data, header_size);
+                n_recv_ptls = header[0];
+                n_recv_bonds = header[1];
+                assert((unsigned int) recv_bytes == header_size + n_recv_ptls*m_packed_size
+                                                    + n_recv_bonds*sizeof(bond_element));
                 }
+
+            MPI_Wait(&req, &status);
             }
 
+        if (m_prof)
+            m_prof->pop(0, m_sendbuf.size() + m_recvbuf.size());
+
+        const BoxDim shifted_box = getShiftedBox();
+
         // start index for atoms to be added
         unsigned int add_idx = m_pdata->getN();
 
@@ -757,7 +785,11 @@ void Communicator::migrateParticles()
             ArrayHandle<char> h_recvbuf(m_recvbuf, access_location::host, access_mode::read);
             for (unsigned int i = 0; i < n_recv_ptls; i++)
                 {
-                pdata_element& p =  ((pdata_element *) h_recvbuf.data)[i];
+                pdata_element p;
+                memcpy(&p, h_recvbuf.data + header_size + i*m_packed_size, m_packed_size);
+
+                // wrap received particles across a global boundary back into global box
+                shifted_box.wrap(p.pos, p.image);
 
                 // copy particle coordinates to domain
                 h_pos.data[add_idx] = p.pos;
@@ -781,13 +813,6 @@ void Communicator::migrateParticles()
          */
         if (bdata->getNumBondsGlobal())
             {
-            unsigned int n_recv_bonds;
-
-            // exchange size of messages
-            MPI_Isend(&n_send_bonds, sizeof(unsigned int), MPI_BYTE, send_neighbor, 0, m_mpi_comm, & reqs[0]);
-            MPI_Irecv(&n_recv_bonds, sizeof(unsigned int), MPI_BYTE, recv_neighbor, 0, m_mpi_comm, & reqs[1]);
-            MPI_Waitall(2, reqs, status);
-
             // resize recv buffer
             if (m_bond_recv_buf.getNumElements() < n_recv_bonds)
                 {
@@ -798,26 +823,14 @@ void Communicator::migrateParticles()
                 m_bond_recv_buf.resize(new_size);
                 }
 
+            if (n_recv_bonds)
                 {
-                // exchange actual particle data
-                ArrayHandle<bond_element> h_bond_send_buf(m_bond_send_buf, access_location::host, access_mode::read);
+                // extract the bonds from the end of the message
+                ArrayHandle<char> h_recvbuf(m_recvbuf, access_location::host, access_mode::read);
                 ArrayHandle<bond_element> h_bond_recv_buf(m_bond_recv_buf, access_location::host, access_mode::overwrite);
-
-                MPI_Isend(h_bond_send_buf.data,
-                          n_send_bonds*sizeof(bond_element),
-                          MPI_BYTE,
-                          send_neighbor,
-                          1,
-                          m_mpi_comm,
-                          & reqs[0]);
-                MPI_Irecv(h_bond_recv_buf.data,
-                          n_recv_bonds*sizeof(bond_element),
-                          MPI_BYTE,
-                          recv_neighbor,
-                          1,
-                          m_mpi_comm,
-                          & reqs[1]);
-                MPI_Waitall(2, reqs, status);
+                memcpy(h_bond_recv_buf.data,
+                       h_recvbuf.data + header_size + n_recv_ptls*m_packed_size,
+                       n_recv_bonds*sizeof(bond_element));
                 }
 
             // unpack data
@@ -951,29 +964,27 @@ void Communicator::exchangeGhosts()
      * Fill send buffers, exchange particles according to plans
      */
 
-    // resize buffers
-    m_plan_copybuf.resize(m_pdata->getN());
-    m_pos_copybuf.resize(m_pdata->getN());
-    m_charge_copybuf.resize(m_pdata->getN());
-    m_diameter_copybuf.resize(m_pdata->getN());
+    // every ghost is packed as position, tag, plan and the requested optional fields, the message starts with the
+    // number of ghosts that are local particles on the sending processor
+    unsigned int element_size = getGhostElementSize();
+    const unsigned int header_size = sizeof(unsigned int);
+    bool send_charge = m_flags[comm_flag::charge];
+    bool send_diameter = m_flags[comm_flag::diameter];
 
     for (unsigned int dir = 0; dir < 6; dir ++)
         {
         if (! isCommunicating(dir) ) continue;
 
         m_num_copy_ghosts[dir] = 0;
+        m_num_copy_local_ghosts[dir] = 0;
 
         // resize array of ghost particle tags
         unsigned int max_copy_ghosts = m_pdata->getN() + m_pdata->getNGhosts();
         m_copy_ghosts[dir].resize(max_copy_ghosts);
 
         // resize buffers
-        m_plan_copybuf.resize(max_copy_ghosts);
-        m_pos_copybuf.resize(max_copy_ghosts);
-        m_charge_copybuf.resize(max_copy_ghosts);
-        m_diameter_copybuf.resize(max_copy_ghosts);
+        m_sendbuf.resize(header_size + max_copy_ghosts*element_size);
 
-      
             {
             // Fill send buffer
             ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
@@ -983,10 +994,7 @@ void Communicator::exchangeGhosts()
             ArrayHandle<unsigned char>  h_plan(m_plan, access_location::host, access_mode::read);
 
             ArrayHandle<unsigned int> h_copy_ghosts(m_copy_ghosts[dir], access_location::host, access_mode::overwrite);
-            ArrayHandle<unsigned char> h_plan_copybuf(m_plan_copybuf, access_location::host, access_mode::overwrite);
-            ArrayHandle<Scalar4> h_pos_copybuf(m_pos_copybuf, access_location::host, access_mode::overwrite);
-            ArrayHandle<Scalar> h_charge_copybuf(m_charge_copybuf, access_location::host, access_mode::overwrite);
-            ArrayHandle<Scalar> h_diameter_copybuf(m_diameter_copybuf, access_location::host, access_mode::overwrite);
+            ArrayHandle<char> h_sendbuf(m_sendbuf, access_location::host, access_mode::overwrite);
 
             for (unsigned int idx = 0; idx < m_pdata->getN() + m_pdata->getNGhosts(); idx++)
                 {
@@ -994,15 +1002,32 @@ void Communicator::exchangeGhosts()
                 if (h_plan.data[idx] & (1 << dir))
                     {
                     // send with next message
-                    h_pos_copybuf.data[m_num_copy_ghosts[dir]] = h_pos.data[idx];
-                    h_charge_copybuf.data[m_num_copy_ghosts[dir]] = h_charge.data[idx];
-                    h_diameter_copybuf.data[m_num_copy_ghosts[dir]] = h_diameter.data[idx];
-                    h_plan_copybuf.data[m_num_copy_ghosts[dir]] = h_plan.data[idx];
+                    char *element = h_sendbuf.data + header_size + m_num_copy_ghosts[dir]*element_size;
+                    unsigned int plan = h_plan.data[idx];
+                    memcpy(element, &h_pos.data[idx], sizeof(Scalar4));
+                    element += sizeof(Scalar4);
+                    memcpy(element, &h_tag.data[idx], sizeof(unsigned int));
+                    element += sizeof(unsigned int);
+                    memcpy(element, &plan, sizeof(unsigned int));
+                    element += sizeof(unsigned int);
+                    if (send_charge)
+                        {
+                        memcpy(element, &h_charge.data[idx], sizeof(Scalar));
+                        element += sizeof(Scalar);
+                        }
+                    if (send_diameter)
+                        memcpy(element, &h_diameter.data[idx], sizeof(Scalar));
 
                     h_copy_ghosts.data[m_num_copy_ghosts[dir]] = h_tag.data[idx];
                     m_num_copy_ghosts[dir]++;
+
+                    // local particles come first in the copy list
+                    if (idx < m_pdata->getN())
+                        m_num_copy_local_ghosts[dir]++;
                     }
                 }
+
+            memcpy(h_sendbuf.data, &m_num_copy_local_ghosts[dir], header_size);
             }
         unsigned int send_neighbor = m_decomposition->getNeighborRank(dir);
 
@@ -1016,16 +1041,31 @@ void Communicator::exchangeGhosts()
         if (m_prof)
             m_prof->push("MPI send/recv");
 
-        // communicate size of the message that will contain the particle data
-        MPI_Request reqs[12];
-        MPI_Status status[12];
+            {
+            // send the packed ghosts and receive a message of unknown size from the opposite neighbor
+            ArrayHandle<char> h_sendbuf(m_sendbuf, access_location::host, access_mode::read);
 
-        MPI_Isend(&m_num_copy_ghosts[dir], sizeof(unsigned int), MPI_BYTE, send_neighbor, 0, m_mpi_comm, &reqs[0]); 
-        MPI_Irecv(&m_num_recv_ghosts[dir], sizeof(unsigned int), MPI_BYTE, recv_neighbor, 0, m_mpi_comm, &reqs[1]);
-        MPI_Waitall(2, reqs, status);
+            MPI_Request req;
+            MPI_Status status;
+            MPI_Isend(h_sendbuf.data, header_size + m_num_copy_ghosts[dir]*element_size, MPI_BYTE, send_neighbor, 0, m_mpi_comm, &req);
+
+            int recv_bytes;
+            MPI_Probe(recv_neighbor, 0, m_mpi_comm, &status);
+            MPI_Get_count(&status, MPI_BYTE, &recv_bytes);
+            m_num_recv_ghosts[dir] = (recv_bytes - header_size) / element_size;
+
+            m_recvbuf.resize(recv_bytes);
+                {
+                ArrayHandle<char> h_recvbuf(m_recvbuf, access_location::host, access_mode::overwrite);
+                MPI_Recv(h_recvbuf.data, recv_bytes, MPI_BYTE, recv_neighbor, 0, m_mpi_comm, &status);
+                memcpy(&m_num_recv_local_ghosts[dir], h_recvbuf.data, header_size);
+                }
+
+            MPI_Wait(&req, &status);
+            }
 
         if (m_prof)
-            m_prof->pop();
+            m_prof->pop(0, (m_num_recv_ghosts[dir]+m_num_copy_ghosts[dir])*element_size);
 
         // append ghosts at the end of particle data array
         unsigned int start_idx = m_pdata->getN() + m_pdata->getNGhosts();
@@ -1036,16 +1076,9 @@ void Communicator::exchangeGhosts()
         // resize plan array
         m_plan.resize(m_pdata->getN() + m_pdata->getNGhosts());
 
-        // exchange particle data, write directly to the particle data arrays
-        if (m_prof)
-            m_prof->push("MPI send/recv");
-
             {
-            ArrayHandle<unsigned int> h_copy_ghosts(m_copy_ghosts[dir], access_location::host, access_mode::read);
-            ArrayHandle<unsigned char> h_plan_copybuf(m_plan_copybuf, access_location::host, access_mode::read);
-            ArrayHandle<Scalar4> h_pos_copybuf(m_pos_copybuf, access_location::host, access_mode::read);
-            ArrayHandle<Scalar> h_charge_copybuf(m_charge_copybuf, access_location::host, access_mode::read);
-            ArrayHandle<Scalar> h_diameter_copybuf(m_diameter_copybuf, access_location::host, access_mode::read);
+            // unpack the ghosts directly into the particle data arrays
+            ArrayHandle<char> h_recvbuf(m_recvbuf, access_location::host, access_mode::read);
 
             ArrayHandle<unsigned char> h_plan(m_plan, access_location::host, access_mode::readwrite);
             ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
@@ -1053,27 +1086,28 @@ void Communicator::exchangeGhosts()
             ArrayHandle<Scalar> h_diameter(m_pdata->getDiameters(), access_location::host, access_mode::readwrite);
             ArrayHandle<unsigned int> h_tag(m_pdata->getTags(), access_location::host, access_mode::readwrite);
 
-            MPI_Isend(h_plan_copybuf.data, m_num_copy_ghosts[dir]*sizeof(unsigned char), MPI_BYTE, send_neighbor, 1, m_mpi_comm, &reqs[2]);
-            MPI_Irecv(h_plan.data + start_idx, m_num_recv_ghosts[dir]*sizeof(unsigned char), MPI_BYTE, recv_neighbor, 1, m_mpi_comm, &reqs[3]);
-
-            MPI_Isend(h_pos_copybuf.data, m_num_copy_ghosts[dir]*sizeof(Scalar4), MPI_BYTE, send_neighbor, 2, m_mpi_comm, &reqs[4]);
-            MPI_Irecv(h_pos.data + start_idx, m_num_recv_ghosts[dir]*sizeof(Scalar4), MPI_BYTE, recv_neighbor, 2, m_mpi_comm, &reqs[5]);
-
-            MPI_Isend(h_copy_ghosts.data, m_num_copy_ghosts[dir]*sizeof(unsigned int), MPI_BYTE, send_neighbor, 3, m_mpi_comm, &reqs[6]);
-            MPI_Irecv(h_tag.data + start_idx, m_num_recv_ghosts[dir]*sizeof(unsigned int), MPI_BYTE, recv_neighbor, 3, m_mpi_comm, &reqs[7]);
-
-            MPI_Isend(h_charge_copybuf.data, m_num_copy_ghosts[dir]*sizeof(Scalar), MPI_BYTE, send_neighbor, 4, m_mpi_comm, &reqs[8]);
-            MPI_Irecv(h_charge.data + start_idx, m_num_recv_ghosts[dir]*sizeof(Scalar), MPI_BYTE, recv_neighbor, 4, m_mpi_comm, &reqs[9]);
-
-            MPI_Isend(h_diameter_copybuf.data, m_num_copy_ghosts[dir]*sizeof(Scalar), MPI_BYTE, send_neighbor, 5, m_mpi_comm, &reqs[10]);
-            MPI_Irecv(h_diameter.data + start_idx, m_num_recv_ghosts[dir]*sizeof(Scalar), MPI_BYTE, recv_neighbor, 5, m_mpi_comm, &reqs[11]);
-            
-            MPI_Waitall(10, reqs+2, status+2);
+            for (unsigned int i = 0; i < m_num_recv_ghosts[dir]; i++)
+                {
+                const char *element = h_recvbuf.data + header_size + i*element_size;
+                unsigned int idx = start_idx + i;
+                unsigned int plan;
+                memcpy(&h_pos.data[idx], element, sizeof(Scalar4));
+                element += sizeof(Scalar4);
+                memcpy(&h_tag.data[idx], element, sizeof(unsigned int));
+                element += sizeof(unsigned int);
+                memcpy(&plan, element, sizeof(unsigned int));
+                element += sizeof(unsigned int);
+                h_plan.data[idx] = plan;
+                if (send_charge)
+                    {
+                    memcpy(&h_charge.data[idx], element, sizeof(Scalar));
+                    element += sizeof(Scalar);
+                    }
+                if (send_diameter)
+                    memcpy(&h_diameter.data[idx], element, sizeof(Scalar));
+                }
             }
 
-        if (m_prof)
-            m_prof->pop();
-
         const BoxDim shifted_box = getShiftedBox();
 
             {
@@ -1106,95 +1140,196 @@ void Communicator::exchangeGhosts()
 //! update positions of ghost particles
 void Communicator::updateGhosts(unsigned int timestep)
     {
-    // we have a current m_copy_ghosts liss which contain the indices of particles
-    // to send to neighboring processors
+    beginUpdateGhosts(timestep);
+    finishUpdateGhosts(timestep);
+    }
+
+/*! The positions of the ghosts that are local particles on this processor are sent in all six directions at once.
+    They are received directly into the particle data, so the positions of the ghost particles must not be accessed
+    until finishUpdateGhosts() has been called.
+
+    \param timestep Current time step
+*/
+void Communicator::beginUpdateGhosts(unsigned int timestep)
+    {
     if (m_prof)
         m_prof->push("copy_ghosts");
 
-    m_exec_conf->msg->notice(7) << "Communicator: update ghosts" << std::endl;
-
-    // update data in these arrays
+    m_exec_conf->msg->notice(7) << "Communicator: begin ghost update" << std::endl;
 
-    unsigned int num_tot_recv_ghosts = 0; // total number of ghosts received
+    // the copy buffer holds the positions for all directions, one after another
+    unsigned int num_tot_copy_ghosts = 0;
+    for (unsigned int dir = 0; dir < 6; dir++)
+        if (isCommunicating(dir))
+            num_tot_copy_ghosts += m_num_copy_ghosts[dir];
+    m_pos_copybuf.resize(num_tot_copy_ghosts);
 
-    for (unsigned int dir = 0; dir < 6; dir ++)
         {
-        if (! isCommunicating(dir) ) continue;
+        ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
+        ArrayHandle<Scalar4> h_pos_copybuf(m_pos_copybuf, access_location::host, access_mode::overwrite);
+        ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
+
+        m_num_ghost_reqs = 0;
+        unsigned int copy_offset = 0;
+        unsigned int recv_offset = m_pdata->getN();
 
+        for (unsigned int dir = 0; dir < 6; dir++)
             {
-            ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
-            ArrayHandle<Scalar4> h_pos_copybuf(m_pos_copybuf, access_location::host, access_mode::overwrite);
-            ArrayHandle<unsigned int> h_copy_ghosts(m_copy_ghosts[dir], access_location::host, access_mode::read);
-            ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
+            if (! isCommunicating(dir) ) continue;
 
-            // copy positions of ghost particles
-            for (unsigned int ghost_idx = 0; ghost_idx < m_num_copy_ghosts[dir]; ghost_idx++)
                 {
-                unsigned int idx = h_rtag.data[h_copy_ghosts.data[ghost_idx]];
+                ArrayHandle<unsigned int> h_copy_ghosts(m_copy_ghosts[dir], access_location::host, access_mode::read);
 
-                assert(idx < m_pdata->getN() + m_pdata->getNGhosts());
+                // copy positions of the local particles, they come first in the copy list
+                for (unsigned int ghost_idx = 0; ghost_idx < m_num_copy_local_ghosts[dir]; ghost_idx++)
+                    {
+                    unsigned int idx = h_rtag.data[h_copy_ghosts.data[ghost_idx]];
 
-                // copy position into send buffer
-                h_pos_copybuf.data[ghost_idx] = h_pos.data[idx];
+                    assert(idx < m_pdata->getN());
+
+                    h_pos_copybuf.data[copy_offset + ghost_idx] = h_pos.data[idx];
+                    }
                 }
+
+            unsigned int send_neighbor = m_decomposition->getNeighborRank(dir);
+
+            // we receive from the direction opposite to the one we send to
+            unsigned int recv_neighbor;
+            if (dir % 2 == 0)
+                recv_neighbor = m_decomposition->getNeighborRank(dir+1);
+            else
+                recv_neighbor = m_decomposition->getNeighborRank(dir-1);
+
+            if (m_num_copy_local_ghosts[dir])
+                MPI_Isend(h_pos_copybuf.data + copy_offset, m_num_copy_local_ghosts[dir]*sizeof(Scalar4), MPI_BYTE,
+                          send_neighbor, dir, m_mpi_comm, &m_ghost_reqs[m_num_ghost_reqs++]);
+            if (m_num_recv_local_ghosts[dir])
+                MPI_Irecv(h_pos.data + recv_offset, m_num_recv_local_ghosts[dir]*sizeof(Scalar4), MPI_BYTE,
+                          recv_neighbor, dir, m_mpi_comm, &m_ghost_reqs[m_num_ghost_reqs++]);
+
+            copy_offset += m_num_copy_ghosts[dir];
+            recv_offset += m_num_recv_ghosts[dir];
             }
-        unsigned int send_neighbor = m_decomposition->getNeighborRank(dir);
+        }
 
-        // we receive from the direction opposite to the one we send to
-        unsigned int recv_neighbor;
-        if (dir % 2 == 0)
-            recv_neighbor = m_decomposition->getNeighborRank(dir+1);
-        else
-            recv_neighbor = m_decomposition->getNeighborRank(dir-1);
+    m_ghosts_pending = true;
 
+    if (m_prof)
+        m_prof->pop();
+    }
 
-        unsigned int start_idx;
-        {
-        if (m_prof)
-            m_prof->push("MPI send/recv");
+/*! Waits for the positions sent in beginUpdateGhosts() and then forwards the ghosts received from one neighbor
+    to the neighbors in the subsequent directions. Does nothing if no ghost update is pending.
 
+    \param timestep Current time step
+*/
+void Communicator::finishUpdateGhosts(unsigned int timestep)
+    {
+    if (! m_ghosts_pending)
+        return;
 
-        start_idx = m_pdata->getN() + num_tot_recv_ghosts;
+    m_ghosts_pending = false;
 
-        num_tot_recv_ghosts += m_num_recv_ghosts[dir];
+    if (m_prof)
+        m_prof->push("copy_ghosts");
 
-            {
-            MPI_Request reqs[2];
-            MPI_Status status[2];
+    m_exec_conf->msg->notice(7) << "Communicator: finish ghost update" << std::endl;
 
-            ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
-            ArrayHandle<Scalar4> h_pos_copybuf(m_pos_copybuf, access_location::host, access_mode::read);
+    if (m_prof)
+        m_prof->push("MPI send/recv");
 
-            // exchange particle data, write directly to the particle data arrays
-            MPI_Isend(h_pos_copybuf.data, m_num_copy_ghosts[dir]*sizeof(Scalar4), MPI_BYTE, send_neighbor, 1, m_mpi_comm, &reqs[0]);
-            MPI_Irecv(h_pos.data + start_idx, m_num_recv_ghosts[dir]*sizeof(Scalar4), MPI_BYTE, recv_neighbor, 1, m_mpi_comm, &reqs[1]);
-            MPI_Waitall(2, reqs, status);
-            }
+    MPI_Waitall(m_num_ghost_reqs, m_ghost_reqs, MPI_STATUSES_IGNORE);
+
+    if (m_prof)
+        m_prof->pop();
 
+    const BoxDim shifted_box = getShiftedBox();
 
-        if (m_prof)
-            m_prof->pop(0, (m_num_recv_ghosts[dir]+m_num_copy_ghosts[dir])*sizeof(Scalar4));
-        }
+    unsigned int copy_offset = 0;
+    unsigned int recv_offset = m_pdata->getN();
 
-        const BoxDim shifted_box = getShiftedBox();
+    for (unsigned int dir = 0; dir < 6; dir++)
+        {
+        if (! isCommunicating(dir) ) continue;
+
+        unsigned int num_copy_forward = m_num_copy_ghosts[dir] - m_num_copy_local_ghosts[dir];
+        unsigned int num_recv_forward = m_num_recv_ghosts[dir] - m_num_recv_local_ghosts[dir];
 
+        ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
+
+        // wrap particles received across a global boundary
+        for (unsigned int idx = recv_offset; idx < recv_offset + m_num_recv_local_ghosts[dir]; idx++)
             {
-            ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
+            int3 img = make_int3(0,0,0);
+            shifted_box.wrap(h_pos.data[idx], img);
+            }
 
-            for (unsigned int idx = start_idx; idx < start_idx + m_num_recv_ghosts[dir]; idx++)
+        if (num_copy_forward || num_recv_forward)
+            {
+            ArrayHandle<Scalar4> h_pos_copybuf(m_pos_copybuf, access_location::host, access_mode::readwrite);
+            ArrayHandle<unsigned int> h_copy_ghosts(m_copy_ghosts[dir], access_location::host, access_mode::read);
+            ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::read);
+
+            // copy positions of the ghosts received in one of the previous directions
+            for (unsigned int ghost_idx = m_num_copy_local_ghosts[dir]; ghost_idx < m_num_copy_ghosts[dir]; ghost_idx++)
                 {
-                Scalar4& pos = h_pos.data[idx];
+                unsigned int idx = h_rtag.data[h_copy_ghosts.data[ghost_idx]];
 
-                // wrap particles received across a global boundary 
+                assert(idx >= m_pdata->getN() && idx < recv_offset);
+
+                h_pos_copybuf.data[copy_offset + ghost_idx] = h_pos.data[idx];
+                }
+
+            unsigned int send_neighbor = m_decomposition->getNeighborRank(dir);
+
+            // we receive from the direction opposite to the one we send to
+            unsigned int recv_neighbor;
+            if (dir % 2 == 0)
+                recv_neighbor = m_decomposition->getNeighborRank(dir+1);
+            else
+                recv_neighbor = m_decomposition->getNeighborRank(dir-1);
+
+            if (m_prof)
+                m_prof->push("MPI send/recv");
+
+            MPI_Request reqs[2];
+            unsigned int nreq = 0;
+            if (num_copy_forward)
+                MPI_Isend(h_pos_copybuf.data + copy_offset + m_num_copy_local_ghosts[dir], num_copy_forward*sizeof(Scalar4),
+                          MPI_BYTE, send_neighbor, 6+dir, m_mpi_comm, &reqs[nreq++]);
+            if (num_recv_forward)
+                MPI_Irecv(h_pos.data + recv_offset + m_num_recv_local_ghosts[dir], num_recv_forward*sizeof(Scalar4),
+                          MPI_BYTE, recv_neighbor, 6+dir, m_mpi_comm, &reqs[nreq++]);
+            MPI_Waitall(nreq, reqs, MPI_STATUSES_IGNORE);
+
+            if (m_prof)
+                m_prof->pop(0, (num_copy_forward+num_recv_forward)*sizeof(Scalar4));
+
+            for (unsigned int idx = recv_offset + m_num_recv_local_ghosts[dir]; idx < recv_offset + m_num_recv_ghosts[dir]; idx++)
+                {
                 int3 img = make_int3(0,0,0);
-                shifted_box.wrap(pos, img);
+                shifted_box.wrap(h_pos.data[idx], img);
                 }
             }
 
+        copy_offset += m_num_copy_ghosts[dir];
+        recv_offset += m_num_recv_ghosts[dir];
         } // end dir loop
 
-        if (m_prof)
-            m_prof->pop();
+    if (m_prof)
+        m_prof->pop();
+    }
+
+/*! \returns The number of bytes of one ghost particle in the exchangeGhosts() messages
+*/
+unsigned int Communicator::getGhostElementSize() const
+    {
+    unsigned int size = sizeof(Scalar4) + 2*sizeof(unsigned int);
+    if (m_flags[comm_flag::charge])
+        size += sizeof(Scalar);
+    if (m_flags[comm_flag::diameter])
+        size += sizeof(Scalar);
+    return size;
     }
 
 const BoxDim Communicator::getShiftedBox() const
@@ -1251,6 +1386,7 @@ void export_Communicator()
     class_<Communicator, boost::shared_ptr<Communicator>, boost::noncopyable>("Communicator",
            init<boost::shared_ptr<SystemDefinition>,
                 boost::shared_ptr<DomainDecomposition> >())
+    .def("setOverlap", &Communicator::setOverlap)
     ;
     }
 #endif // ENABLE_MPI
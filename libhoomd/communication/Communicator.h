@@ -72,6 +72,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <boost/shared_ptr.hpp>
 #include <boost/signals.hpp>
+#include <bitset>
 
 /*! \ingroup hoomd_lib
     @{
@@ -163,6 +164,44 @@ struct pdata_element
     unsigned int tag;  //!< global tag
     };
 
+//! List of optional fields that are exchanged with ghost particles
+/*! Ghost particles always carry their position, type and tag. The fields listed here are only sent if a
+    Compute requests them through Compute::getRequestedCommFlags().
+*/
+struct comm_flag
+    {
+    //! The enum
+    enum Enum
+        {
+        charge=0,   //!< Bit id in CommFlags for the particle charge
+        diameter,   //!< Bit id in CommFlags for the particle diameter
+        };
+    };
+
+//! Determines which optional fields are exchanged with ghost particles
+typedef std::bitset<32> CommFlags;
+
+//! Perform a bitwise or operation on the return values of several signals
+struct comm_flags_bitwise_or
+    {
+    //! This is needed by boost::signals
+    typedef CommFlags result_type;
+
+    //! Combine return values using bitwise or
+    /*! \param first First return value
+        \param last Last return value
+     */
+    template<typename InputIterator>
+    CommFlags operator()(InputIterator first, InputIterator last) const
+        {
+        CommFlags return_value(0);
+        while (first != last)
+            return_value |= *first++;
+
+        return return_value;
+        }
+    };
+
 //! Perform a logical or operation on the return values of several signals
 struct migrate_logical_or
     {
@@ -216,7 +255,9 @@ struct migrate_logical_or
  * -# <b> Third stage</b>: Update of ghost positions (updateGhosts())
  * <br> If it is not necessary to renew the list of ghost particles (i.e. when no particle in the global system has moved more than a
  * distance \f$ r_{\mathrm{buff}}/2 \f$), we use the current ghost particle list to update the ghost positions on the neighboring
- * processors.
+ * processors. The update is split into beginUpdateGhosts() and finishUpdateGhosts(). If overlapping is enabled with
+ * setOverlap(), communicate() only begins the update, and the force computation finishes it after it has computed the
+ * forces on the particles that do not interact with ghosts (see PotentialPair).
  *
  * Stages \b one and \b two are performed before every neighbor list build, stage \b three is executed in all other steps (before the calculation
  * of forces).
@@ -245,6 +286,11 @@ struct migrate_logical_or
  * In stage two and three, ghost atoms received from a neighboring processor are always included in the local
  * ghost atom lists, and they maybe replicated to more neighboring processors by the communication pattern
  * described above.
+ *
+ * In stage two, all fields of the ghost particles sent in one direction are packed into a single message. Only
+ * the position, type, tag and itinerary are always included, charges and diameters are only sent if they are
+ * requested (see CommFlags). The receiving side finds the size of the message with MPI_Probe(), so no separate
+ * message with the number of ghosts is needed.
  * \ingroup communication
  */
 class Communicator
@@ -279,6 +325,41 @@ class Communicator
             return m_migrate_requests.connect(subscriber);
             }
 
+        //! Subscribe to list of functions that determine which optional ghost fields are exchanged
+        /*! \param subscriber Function returning the CommFlags needed on the given time step
+         * \return A connection to the present class
+         */
+        boost::signals::connection addCommFlagsRequest(const boost::function<CommFlags (unsigned int timestep)>& subscriber)
+            {
+            return m_requested_flags.connect(subscriber);
+            }
+
+        //! Enable or disable overlapping the ghost update with the force computation
+        /*! \param overlap True if communicate() should leave the ghost update in flight
+         */
+        void setOverlap(bool overlap)
+            {
+            m_overlap = overlap;
+            }
+
+        //! Returns true if the ghost update is overlapped with the force computation
+        bool getOverlap() const
+            {
+            return m_overlap;
+            }
+
+        //! Returns true if beginUpdateGhosts() has been called and the update has not yet been finished
+        bool isGhostUpdatePending() const
+            {
+            return m_ghosts_pending;
+            }
+
+        //! Get the optional fields exchanged with the current ghost particles
+        const CommFlags& getFlags() const
+            {
+            return m_flags;
+            }
+
         //! Set width of ghost layer
         /*! \param ghost_width The width of the ghost layer
          */
@@ -297,6 +378,12 @@ class Communicator
             m_r_ghost = ghost_width;
             }
 
+        //! Get the width of the ghost layer
+        Scalar getGhostLayerWidth() const
+            {
+            return m_r_ghost;
+            }
+
         //! Set skin layer width
         /*! \param r_buff The width of the skin buffer
          */
@@ -337,6 +424,22 @@ class Communicator
          */
         virtual void updateGhosts(unsigned int timestep);
 
+        /*! Start updating the positions of ghost particles
+         * The positions of the ghosts that are local particles are sent in all directions without waiting
+         * for the messages to complete.
+         *
+         * \post isGhostUpdatePending() returns true until finishUpdateGhosts() is called. The positions of
+         *       the ghost particles must not be accessed in the meantime.
+         */
+        virtual void beginUpdateGhosts(unsigned int timestep);
+
+        /*! Complete the ghost update started with beginUpdateGhosts()
+         * Ghosts received in one direction that are forwarded in another one are sent in this step.
+         *
+         * \post The ghost positions on the neighboring processors are current
+         */
+        virtual void finishUpdateGhosts(unsigned int timestep);
+
         /*! This methods finds all the particles that are no longer inside the domain
          * boundaries and transfers them to neighboring processors.
          *
@@ -467,14 +570,12 @@ class Communicator
         GPUArray<bond_element> m_bond_recv_buf;//!< Buffer for bonds that are received
         GPUArray<unsigned int> m_bond_remove_mask; //!< Per-bond flag (1= remove, 0= keep)
         GPUVector<Scalar4> m_pos_copybuf;         //!< Buffer for particle positions to be copied
-        GPUVector<Scalar> m_charge_copybuf;       //!< Buffer for particle charges to be copied
-        GPUVector<Scalar> m_diameter_copybuf;     //!< Buffer for particle diameters to be copied
-        GPUVector<unsigned char> m_plan_copybuf;  //!< Buffer for particle plans
-        GPUVector<unsigned int> m_tag_copybuf;    //!< Buffer for particle tags
 
         GPUVector<unsigned int> m_copy_ghosts[6]; //!< Per-direction list of indices of particles to send as ghosts
         unsigned int m_num_copy_ghosts[6];       //!< Number of local particles that are sent to neighboring processors
         unsigned int m_num_recv_ghosts[6];       //!< Number of ghosts received per direction
+        unsigned int m_num_copy_local_ghosts[6]; //!< Number of ghosts sent per direction that are local particles
+        unsigned int m_num_recv_local_ghosts[6]; //!< Number of ghosts received per direction that are local on the sender
 
         BoxDim m_global_box;                     //!< Global simulation box
         unsigned int m_packed_size;              //!< Size of packed particle data element in bytes
@@ -487,14 +588,24 @@ class Communicator
         boost::signal<bool(unsigned int timestep), migrate_logical_or>
             m_migrate_requests; //!< List of functions that may request particle migration
 
+        boost::signal<CommFlags(unsigned int timestep), comm_flags_bitwise_or>
+            m_requested_flags;  //!< List of functions that request optional ghost fields
+        CommFlags m_flags;                       //!< Optional fields exchanged with the ghost particles
+
         RoutingTable m_routing_table;            //!< The routing table
 
+        bool m_overlap;                          //!< True if the ghost update is overlapped with the force computation
+        bool m_ghosts_pending;                   //!< True if a ghost update is in flight
+        MPI_Request m_ghost_reqs[12];            //!< Requests of the ghost update in flight
+        unsigned int m_num_ghost_reqs;           //!< Number of requests in m_ghost_reqs
+
     private:
         std::vector<Scalar4> scal4_tmp;          //!< Temporary list used to apply the sort order to the particle data
         std::vector<Scalar3> scal3_tmp;          //!< Temporary list used to apply the sort order to the particle data
         std::vector<Scalar> scal_tmp;            //!< Temporary list used to apply the sort order to the particle data
         std::vector<unsigned int> uint_tmp;      //!< Temporary list used to apply the sort order to the particle data
         std::vector<int3> int3_tmp;              //!< Temporary list used to apply the sort order to the particle data
+        std::vector<unsigned int> sort_keys;     //!< Sort order of the particles that are checked for migration
 
         bool m_is_first_step;                    //!< True if no communication has yet occured
 
@@ -503,6 +614,9 @@ class Communicator
 
         //! Helper function to intialize the routing tables
         void setupRoutingTable();
+
+        //! Helper function to compute the size of a packed ghost particle
+        unsigned int getGhostElementSize() const;
     };
 
 
@@ -100,6 +100,13 @@ class CommunicatorGPU : public Communicator
          */
         virtual void updateGhosts(unsigned int timestep);
 
+        /*! The GPU ghost update is not split, the positions are current when this method returns
+         */
+        virtual void beginUpdateGhosts(unsigned int timestep)
+            {
+            updateGhosts(timestep);
+            }
+
         //! Transfer particles between neighboring domains
         virtual void migrateParticles();
 
@@ -62,6 +62,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "HOOMDMPI.h"
 #include <boost/python.hpp>
+#include <algorithm>
 
 using namespace boost::python;
 
@@ -110,6 +111,18 @@ DomainDecomposition::DomainDecomposition(boost::shared_ptr<ExecutionConfiguratio
 
     // calculate position of this box in the domain grid
     m_grid_pos = m_index.getTriple(rank);
+
+    // start with equally sized domains
+    unsigned int n[3] = { m_nx, m_ny, m_nz };
+    for (unsigned int dim = 0; dim < 3; dim++)
+        {
+        m_cumulative_frac[dim].resize(n[dim]+1);
+        for (unsigned int i = 0; i <= n[dim]; i++)
+            m_cumulative_frac[dim][i] = Scalar(i)/Scalar(n[dim]);
+        }
+
+    m_n_uniform = 0;
+    m_n_balancers = 0;
     }
 
 //! Find a domain decomposition with given parameters
@@ -212,18 +225,20 @@ const BoxDim DomainDecomposition::calculateLocalBox(const BoxDim & global_box)
     // initialize local box with all properties of global box
     BoxDim box = global_box; 
 
-    // calculate the local box dimensions by sub-dividing the cartesian lattice
-    Scalar3 L = global_box.getL();
-    Scalar3 L_local = L / make_scalar3(m_nx, m_ny, m_nz);
+    // the boundaries of this domain in fractional coordinates
+    Scalar3 f_lo = make_scalar3(m_cumulative_frac[0][m_grid_pos.x],
+                                m_cumulative_frac[1][m_grid_pos.y],
+                                m_cumulative_frac[2][m_grid_pos.z]);
+    Scalar3 f_hi = make_scalar3(m_cumulative_frac[0][m_grid_pos.x+1],
+                                m_cumulative_frac[1][m_grid_pos.y+1],
+                                m_cumulative_frac[2][m_grid_pos.z+1]);
 
     // position of this domain in the grid
+    Scalar3 L = global_box.getL();
     Scalar3 lo_g = global_box.getLo();
     Scalar3 lo, hi;
-    lo.x = lo_g.x + (double)m_grid_pos.x * L_local.x;
-    lo.y = lo_g.y + (double)m_grid_pos.y * L_local.y;
-    lo.z = lo_g.z + (double)m_grid_pos.z * L_local.z;
-
-    hi = lo + L_local;
+    lo = lo_g + f_lo * L;
+    hi = lo_g + f_hi * L;
 
     // set periodic flags
     // we are periodic in a direction along which there is only one box
@@ -236,6 +251,126 @@ const BoxDim DomainDecomposition::calculateLocalBox(const BoxDim & global_box)
     return box;
     }
 
+/*! \param dim Axis (0 = x, 1 = y, 2 = z)
+    \param cum_frac The new boundaries of the domains along \a dim, as fractions of the global box length
+
+    The first and last entries must be 0 and 1, and the entries must be strictly increasing. Every rank has to set
+    the same fractions. The new local box takes effect on the next call to calculateLocalBox(), i.e. the next time
+    the global box is set in the ParticleData.
+*/
+void DomainDecomposition::setCumulativeFractions(unsigned int dim, const std::vector<Scalar>& cum_frac)
+    {
+    assert(dim < 3);
+    bool valid = (cum_frac.size() == m_cumulative_frac[dim].size());
+    if (valid)
+        valid = (cum_frac.front() == Scalar(0.0) && cum_frac.back() == Scalar(1.0));
+    for (unsigned int i = 1; valid && i < cum_frac.size(); i++)
+        valid = (cum_frac[i] > cum_frac[i-1]);
+
+    if (! valid)
+        {
+        m_exec_conf->msg->error() << "Invalid domain boundaries along dimension " << dim << "." << endl;
+        throw std::runtime_error("Error setting domain decomposition");
+        }
+
+    // requireUniform() and addBalancer() make sure that this never happens
+    assert(m_n_uniform == 0);
+
+    m_cumulative_frac[dim] = cum_frac;
+    }
+
+//! Returns true if all domains have the same dimensions
+bool DomainDecomposition::isUniform() const
+    {
+    for (unsigned int dim = 0; dim < 3; dim++)
+        {
+        unsigned int n = m_cumulative_frac[dim].size() - 1;
+        for (unsigned int i = 0; i <= n; i++)
+            if (fabs(m_cumulative_frac[dim][i] - Scalar(i)/Scalar(n)) > Scalar(1e-6))
+                return false;
+        }
+    return true;
+    }
+
+/*! \param name Name of the user in error messages, e.g. "charge.pppm"
+
+    Fails if a load balancer is registered, or if the domain boundaries have already been moved.
+*/
+void DomainDecomposition::requireUniform(const std::string& name)
+    {
+    if (m_n_balancers > 0)
+        {
+        m_exec_conf->msg->error() << name << ": requires equally sized domains and cannot be combined with "
+                                  << "update.balance" << endl;
+        throw std::runtime_error("Error setting domain decomposition");
+        }
+    if (! isUniform())
+        {
+        m_exec_conf->msg->error() << name << ": requires equally sized domains, but the domain boundaries have "
+                                  << "already been moved by update.balance" << endl;
+        throw std::runtime_error("Error setting domain decomposition");
+        }
+
+    m_n_uniform++;
+    }
+
+void DomainDecomposition::releaseUniform()
+    {
+    assert(m_n_uniform > 0);
+    m_n_uniform--;
+    }
+
+/*! \param name Name of the load balancer in error messages, e.g. "update.balance"
+
+    Fails if a user that requires equally sized domains is registered.
+*/
+void DomainDecomposition::addBalancer(const std::string& name)
+    {
+    if (m_n_uniform > 0)
+        {
+        m_exec_conf->msg->error() << name << ": cannot move the domain boundaries, a compute that requires "
+                                  << "equally sized domains (e.g. charge.pppm) is in use" << endl;
+        throw std::runtime_error("Error setting domain decomposition");
+        }
+
+    m_n_balancers++;
+    }
+
+void DomainDecomposition::removeBalancer()
+    {
+    assert(m_n_balancers > 0);
+    m_n_balancers--;
+    }
+
+/*! \param global_box The global simulation box
+    \param pos Position inside the global box
+    \returns Rank of the domain \a pos lies in
+
+    Positions exactly on the upper boundary of the global box are placed into the last domain.
+*/
+unsigned int DomainDecomposition::placeParticle(const BoxDim& global_box, const Scalar3& pos) const
+    {
+    Scalar3 f = global_box.makeFraction(pos,make_scalar3(0.0,0.0,0.0));
+    Scalar f_dim[3] = { f.x, f.y, f.z };
+
+    unsigned int grid_pos[3];
+    for (unsigned int dim = 0; dim < 3; dim++)
+        {
+        const std::vector<Scalar>& cum_frac = m_cumulative_frac[dim];
+
+        // the domain is the last one whose lower boundary is not above f
+        int i = int(std::upper_bound(cum_frac.begin(), cum_frac.end(), f_dim[dim]) - cum_frac.begin()) - 1;
+        int n = int(cum_frac.size()) - 1;
+        if (i < 0)
+            i = 0;
+        if (i >= n)
+            i = n - 1;
+        grid_pos[dim] = i;
+        }
+
+    return m_index(grid_pos[0], grid_pos[1], grid_pos[2]);
+    }
+
 //! Export DomainDecomposition class to python
 void export_DomainDecomposition()
     {
@@ -62,6 +62,8 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "BoxDim.h"
 #include "ExecutionConfiguration.h"
 
+#include <vector>
+
 /*! \ingroup communication
 */
 
@@ -76,6 +78,14 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *  such as to minimize surface area between domains, while utilizing all processors in the MPI communicator.
  *
  *  The initialization of the domain decomposition scheme is performed in the constructor.
+ *
+ *  The domain boundaries along every axis are stored as cumulative fractions of the global box length, which are
+ *  uniformly spaced initially. A load balancer may move the boundaries with setCumulativeFractions(), so that the
+ *  grid remains rectilinear but its cells are no longer of equal size. The processor grid itself never changes.
+ *
+ *  Computes that only work with equally sized domains register with requireUniform(), and load balancers with
+ *  addBalancer(). Whichever of the two is registered second fails, so that the combination is rejected when the
+ *  simulation is set up and not in the middle of a run.
  */
 class DomainDecomposition
     {
@@ -109,6 +119,43 @@ class DomainDecomposition
         //! Get the dimensions of the local simulation box
         const BoxDim calculateLocalBox(const BoxDim& global_box);
 
+        //! Get the position of this domain in the processor grid
+        uint3 getGridPos() const
+            {
+            return m_grid_pos;
+            }
+
+        //! Get the cumulative fractions of the domain boundaries along an axis
+        /*! \param dim Axis (0 = x, 1 = y, 2 = z)
+            \returns The n+1 boundaries of the n domains along \a dim, as fractions of the global box length
+         */
+        const std::vector<Scalar>& getCumulativeFractions(unsigned int dim) const
+            {
+            assert(dim < 3);
+            return m_cumulative_frac[dim];
+            }
+
+        //! Set the cumulative fractions of the domain boundaries along an axis
+        void setCumulativeFractions(unsigned int dim, const std::vector<Scalar>& cum_frac);
+
+        //! Returns true if all domains have the same dimensions
+        bool isUniform() const;
+
+        //! Register a user that requires equally sized domains
+        void requireUniform(const std::string& name);
+
+        //! Release a requirement registered with requireUniform()
+        void releaseUniform();
+
+        //! Register a load balancer that moves the domain boundaries
+        void addBalancer(const std::string& name);
+
+        //! Release a load balancer registered with addBalancer()
+        void removeBalancer();
+
+        //! Find the rank of the domain that contains a position
+        unsigned int placeParticle(const BoxDim& global_box, const Scalar3& pos) const;
+
     private:
         unsigned int m_nx;           //!< Number of processors along the x-axis
         unsigned int m_ny;           //!< Number of processors along the y-axis
@@ -116,6 +163,9 @@ class DomainDecomposition
 
         uint3 m_grid_pos;            //!< Position of this domain in the grid
         Index3D m_index;             //!< Index to the 3D processor grid
+        std::vector<Scalar> m_cumulative_frac[3]; //!< Domain boundaries along every axis, in fractional coordinates
+        unsigned int m_n_uniform;    //!< Number of registered users that require equally sized domains
+        unsigned int m_n_balancers;  //!< Number of registered load balancers
      
         //! Find a domain decomposition with given parameters
         bool findDecomposition(Scalar3 L, unsigned int& nx, unsigned int& ny, unsigned int& nz);
@@ -0,0 +1,287 @@
+/*
+Highly Optimized Object-oriented Many-particle Dynamics -- Blue Edition
+(HOOMD-blue) Open Source Software License Copyright 2008-2011 Ames Laboratory
+Iowa State University and The Regents of the University of Michigan All rights
+reserved.
+
+HOOMD-blue may contain modifications ("Contributions") provided, and to which
+copyright is held, by various Contributors who have granted The Regents of the
+University of Michigan the right to modify and/or distribute such Contributions.
+
+You may redistribute, use, and create derivate works of HOOMD-blue, in source
+and binary forms, provided you abide by the following conditions:
+
+* Redistributions of source code must retain the above copyright notice, this
+list of conditions, and the following disclaimer both in the code and
+prominently in any materials provided with the distribution.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions, and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+* All publications and presentations based on HOOMD-blue, including any reports
+or published results obtained, in whole or in part, with HOOMD-blue, will
+acknowledge its use according to the terms posted at the time of submission on:
+http://codeblue.umich.edu/hoomd-blue/citations.html
+
+* Any electronic documents citing HOOMD-Blue will link to the HOOMD-Blue website:
+http://codeblue.umich.edu/hoomd-blue/
+
+* Apart from the above required attributions, neither the name of the copyright
+holder nor the names of HOOMD-blue's contributors may be used to endorse or
+promote products derived from this software without specific prior written
+permission.
+
+Disclaimer
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, AND/OR ANY
+WARRANTIES THAT THIS SOFTWARE IS FREE OF INFRINGEMENT ARE DISCLAIMED.
+
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Maintainer: jglaser
+
+/*! \file LoadBalancer.cc
+    \brief Defines the LoadBalancer class
+*/
+
+#ifdef ENABLE_MPI
+
+#include "LoadBalancer.h"
+#include "Communicator.h"
+#include "HOOMDMPI.h"
+
+#include <boost/python.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace boost::python;
+using namespace std;
+
+/*! \param sysdef System definition
+    \param decomposition Domain decomposition whose boundaries are moved
+
+    By default, the boundaries are moved along all axes when the imbalance exceeds 5 percent.
+*/
+LoadBalancer::LoadBalancer(boost::shared_ptr<SystemDefinition> sysdef,
+                           boost::shared_ptr<DomainDecomposition> decomposition)
+    : Updater(sysdef), m_decomposition(decomposition), m_tolerance(Scalar(1.05)), m_max_shift(Scalar(0.5))
+    {
+    m_exec_conf->msg->notice(5) << "Constructing LoadBalancer" << endl;
+
+    assert(m_decomposition);
+    m_enable[0] = m_enable[1] = m_enable[2] = true;
+
+    // fails if a compute relies on equally sized domains
+    m_decomposition->addBalancer("update.balance");
+    }
+
+LoadBalancer::~LoadBalancer()
+    {
+    m_exec_conf->msg->notice(5) << "Destroying LoadBalancer" << endl;
+
+    m_decomposition->removeBalancer();
+    }
+
+/*! \param tolerance Largest ratio of the maximum number of particles on a rank over the mean that is accepted
+*/
+void LoadBalancer::setTolerance(Scalar tolerance)
+    {
+    if (tolerance < Scalar(1.0))
+        {
+        m_exec_conf->msg->error() << "update.balance: tolerance must be at least 1.0" << endl;
+        throw runtime_error("Error setting up LoadBalancer");
+        }
+    m_tolerance = tolerance;
+    }
+
+/*! \param max_shift Largest shift of a boundary per update, as a fraction of the width of the adjacent domain.
+    Values larger than one half could move particles past the next domain, where the migration cannot reach them.
+*/
+void LoadBalancer::setMaxShift(Scalar max_shift)
+    {
+    if (max_shift <= Scalar(0.0) || max_shift > Scalar(0.5))
+        {
+        m_exec_conf->msg->error() << "update.balance: max_shift must be in (0, 0.5]" << endl;
+        throw runtime_error("Error setting up LoadBalancer");
+        }
+    m_max_shift = max_shift;
+    }
+
+/*! \returns The largest number of particles on any rank, divided by the mean
+
+    This is a collective call.
+*/
+Scalar LoadBalancer::getImbalance()
+    {
+    unsigned int N = m_pdata->getN();
+    unsigned int max_N;
+    MPI_Allreduce(&N, &max_N, 1, MPI_UNSIGNED, MPI_MAX, m_exec_conf->getMPICommunicator());
+
+    Scalar mean_N = Scalar(m_pdata->getNGlobal()) / Scalar(m_exec_conf->getNRanks());
+    if (mean_N == Scalar(0.0))
+        return Scalar(1.0);
+    return Scalar(max_N) / mean_N;
+    }
+
+std::vector< std::string > LoadBalancer::getProvidedLogQuantities()
+    {
+    vector<string> list;
+    list.push_back("load_imbalance");
+    return list;
+    }
+
+/*! \param quantity Name of the log quantity to get
+    \param timestep Current time step of the simulation
+*/
+Scalar LoadBalancer::getLogValue(const std::string& quantity, unsigned int timestep)
+    {
+    if (quantity == "load_imbalance")
+        return getImbalance();
+
+    m_exec_conf->msg->error() << "update.balance: " << quantity << " is not a valid log quantity" << endl;
+    throw runtime_error("Error getting log value");
+    }
+
+/*! \param timestep Current time step of the simulation
+
+    The new boundaries are identical on every rank, since they are computed from globally reduced particle counts.
+*/
+void LoadBalancer::update(unsigned int timestep)
+    {
+    // nothing to balance without a communicator
+    if (! m_comm)
+        return;
+
+    if (m_prof) m_prof->push("Balance");
+
+    Scalar imbalance = getImbalance();
+    if (imbalance <= m_tolerance)
+        {
+        if (m_prof) m_prof->pop();
+        return;
+        }
+
+    m_exec_conf->msg->notice(6) << "update.balance: load imbalance " << imbalance << " at step " << timestep << endl;
+
+    // a domain has to be wider than twice the ghost layer, keep a small margin on top
+    BoxDim global_box = m_pdata->getGlobalBox();
+    Scalar3 npd = global_box.getNearestPlaneDistance();
+    Scalar min_width = Scalar(2.0)*m_comm->getGhostLayerWidth()*Scalar(1.01);
+    Scalar min_frac[3] = { min_width/npd.x, min_width/npd.y, min_width/npd.z };
+
+    bool changed = false;
+    for (unsigned int dim = 0; dim < 3; dim++)
+        {
+        if (m_enable[dim] && m_decomposition->getCumulativeFractions(dim).size() > 2)
+            changed |= balanceDimension(dim, min_frac[dim]);
+        }
+
+    if (changed)
+        {
+        // recalculate the local box and notify the subscribers
+        m_pdata->setGlobalBox(global_box);
+
+        // particles outside of the new local box are sent to their new owners on the next communication step
+        m_comm->forceMigrate();
+        }
+
+    if (m_prof) m_prof->pop();
+    }
+
+/*! \param dim Axis (0 = x, 1 = y, 2 = z) along which the boundaries are moved
+    \param min_frac Smallest allowed domain width, as a fraction of the global box
+    \returns true if the boundaries have changed
+
+    The boundaries are left unchanged if keeping every domain \a min_frac wide would move a boundary further than
+    the shift limit allows. This is a collective call.
+*/
+bool LoadBalancer::balanceDimension(unsigned int dim, Scalar min_frac)
+    {
+    const vector<Scalar>& cum_frac = m_decomposition->getCumulativeFractions(dim);
+    unsigned int n = cum_frac.size() - 1;
+
+    // cannot fit the domains
+    if (min_frac*Scalar(n) >= Scalar(1.0))
+        return false;
+
+    // sum up the particles in every slab of domains along this axis
+    uint3 grid_pos = m_decomposition->getGridPos();
+    unsigned int my_pos = (dim == 0) ? grid_pos.x : ((dim == 1) ? grid_pos.y : grid_pos.z);
+    vector<unsigned int> n_slab(n, 0);
+    n_slab[my_pos] = m_pdata->getN();
+    MPI_Allreduce(MPI_IN_PLACE, &n_slab.front(), n, MPI_UNSIGNED, MPI_SUM, m_exec_conf->getMPICommunicator());
+
+    // number of particles below every boundary
+    vector<Scalar> n_cum(n+1, Scalar(0.0));
+    for (unsigned int i = 0; i < n; i++)
+        n_cum[i+1] = n_cum[i] + Scalar(n_slab[i]);
+    Scalar n_total = n_cum[n];
+    if (n_total == Scalar(0.0))
+        return false;
+
+    vector<Scalar> new_frac(cum_frac);
+    vector<Scalar> lo(n+1), hi(n+1);
+    unsigned int j = 0;
+    for (unsigned int k = 1; k < n; k++)
+        {
+        // invert the cumulative distribution, which is linear inside every slab
+        Scalar target = n_total * Scalar(k) / Scalar(n);
+        while (j < n-1 && n_cum[j+1] < target)
+            j++;
+
+        Scalar f = cum_frac[j];
+        if (n_slab[j] > 0)
+            f += (cum_frac[j+1] - cum_frac[j]) * (target - n_cum[j]) / Scalar(n_slab[j]);
+
+        // limit the shift, so that no particle has to move further than to a neighboring domain
+        lo[k] = cum_frac[k] - m_max_shift*(cum_frac[k] - cum_frac[k-1]);
+        hi[k] = cum_frac[k] + m_max_shift*(cum_frac[k+1] - cum_frac[k]);
+        new_frac[k] = std::min(std::max(f, lo[k]), hi[k]);
+        }
+
+    // keep every domain at least min_frac wide
+    for (unsigned int k = 1; k < n; k++)
+        new_frac[k] = std::max(new_frac[k], new_frac[k-1] + min_frac);
+    for (unsigned int k = n-1; k > 0; k--)
+        new_frac[k] = std::min(new_frac[k], new_frac[k+1] - min_frac);
+
+    // widening a domain may have pushed a boundary past the shift limit, which would require particles to migrate
+    // by more than one domain: leave this dimension unchanged in that case
+    for (unsigned int k = 1; k < n; k++)
+        if (new_frac[k] < lo[k] || new_frac[k] > hi[k])
+            return false;
+
+    bool changed = false;
+    for (unsigned int k = 1; k < n; k++)
+        if (fabs(new_frac[k] - cum_frac[k]) > Scalar(1e-6))
+            changed = true;
+
+    if (changed)
+        m_decomposition->setCumulativeFractions(dim, new_frac);
+
+    return changed;
+    }
+
+void export_LoadBalancer()
+    {
+    class_<LoadBalancer, boost::shared_ptr<LoadBalancer>, bases<Updater>, boost::noncopyable>
+    ("LoadBalancer", init< boost::shared_ptr<SystemDefinition>, boost::shared_ptr<DomainDecomposition> >())
+    .def("setTolerance", &LoadBalancer::setTolerance)
+    .def("setMaxShift", &LoadBalancer::setMaxShift)
+    .def("enableDimension", &LoadBalancer::enableDimension)
+    .def("getImbalance", &LoadBalancer::getImbalance)
+    ;
+    }
+
+#endif // ENABLE_MPI
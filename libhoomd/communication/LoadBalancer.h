@@ -0,0 +1,141 @@
+/*
+Highly Optimized Object-oriented Many-particle Dynamics -- Blue Edition
+(HOOMD-blue) Open Source Software License Copyright 2008-2011 Ames Laboratory
+Iowa State University and The Regents of the University of Michigan All rights
+reserved.
+
+HOOMD-blue may contain modifications ("Contributions") provided, and to which
+copyright is held, by various Contributors who have granted The Regents of the
+University of Michigan the right to modify and/or distribute such Contributions.
+
+You may redistribute, use, and create derivate works of HOOMD-blue, in source
+and binary forms, provided you abide by the following conditions:
+
+* Redistributions of source code must retain the above copyright notice, this
+list of conditions, and the following disclaimer both in the code and
+prominently in any materials provided with the distribution.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions, and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+* All publications and presentations based on HOOMD-blue, including any reports
+or published results obtained, in whole or in part, with HOOMD-blue, will
+acknowledge its use according to the terms posted at the time of submission on:
+http://codeblue.umich.edu/hoomd-blue/citations.html
+
+* Any electronic documents citing HOOMD-Blue will link to the HOOMD-Blue website:
+http://codeblue.umich.edu/hoomd-blue/
+
+* Apart from the above required attributions, neither the name of the copyright
+holder nor the names of HOOMD-blue's contributors may be used to endorse or
+promote products derived from this software without specific prior written
+permission.
+
+Disclaimer
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, AND/OR ANY
+WARRANTIES THAT THIS SOFTWARE IS FREE OF INFRINGEMENT ARE DISCLAIMED.
+
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Maintainer: jglaser
+
+/*! \file LoadBalancer.h
+    \brief Declares the LoadBalancer class
+*/
+
+#ifdef ENABLE_MPI
+
+#ifndef __LOAD_BALANCER_H__
+#define __LOAD_BALANCER_H__
+
+#ifdef NVCC
+#error This header cannot be compiled by nvcc
+#endif
+
+#include "Updater.h"
+#include "DomainDecomposition.h"
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+//! Moves the domain boundaries to even out the number of particles per rank
+/*! The processor grid of the DomainDecomposition stays fixed, but the cuts between the domains along every axis are
+    shifted. Every update, the load imbalance (the largest number of particles on a rank over the mean) is measured.
+    If it exceeds the tolerance, the particles in every slab of domains along an axis are summed up and each cut is
+    moved to where it divides the particles evenly, assuming a uniform density inside each slab. Repeated updates
+    converge towards a balanced decomposition.
+
+    A cut moves by at most a fraction (the maximum shift, at most one half) of the width of its neighboring domains per
+    update, so that every particle ends up at most one domain away from its current owner. Domains are never made
+    narrower than twice the ghost layer width. The particles are redistributed by the regular migration step of the
+    Communicator, which is forced after the boundaries have changed.
+
+    The current load imbalance is provided as the log quantity \c load_imbalance.
+
+    \ingroup updaters
+*/
+class LoadBalancer : public Updater
+    {
+    public:
+        //! Constructor
+        LoadBalancer(boost::shared_ptr<SystemDefinition> sysdef,
+                     boost::shared_ptr<DomainDecomposition> decomposition);
+
+        //! Destructor
+        virtual ~LoadBalancer();
+
+        //! Set the load imbalance above which the boundaries are moved
+        void setTolerance(Scalar tolerance);
+
+        //! Set the largest boundary shift per update, as a fraction of the adjacent domain width
+        void setMaxShift(Scalar max_shift);
+
+        //! Enable or disable balancing along an axis
+        /*! \param dim Axis (0 = x, 1 = y, 2 = z)
+            \param enable True if the domain boundaries along \a dim may move
+        */
+        void enableDimension(unsigned int dim, bool enable)
+            {
+            assert(dim < 3);
+            m_enable[dim] = enable;
+            }
+
+        //! Measure the load imbalance and move the domain boundaries
+        virtual void update(unsigned int timestep);
+
+        //! Returns a list of log quantities this updater calculates
+        virtual std::vector< std::string > getProvidedLogQuantities();
+
+        //! Calculates the requested log value and returns it
+        virtual Scalar getLogValue(const std::string& quantity, unsigned int timestep);
+
+        //! Get the current load imbalance
+        Scalar getImbalance();
+
+    protected:
+        boost::shared_ptr<DomainDecomposition> m_decomposition; //!< The domain decomposition to balance
+        Scalar m_tolerance;           //!< Load imbalance below which the boundaries are left alone
+        Scalar m_max_shift;           //!< Largest boundary shift per update, as a fraction of the domain width
+        bool m_enable[3];             //!< True for the axes along which the boundaries may move
+
+        //! Compute new boundaries along one axis
+        bool balanceDimension(unsigned int dim, Scalar min_frac);
+    };
+
+//! Export the LoadBalancer to python
+void export_LoadBalancer();
+
+#endif // __LOAD_BALANCER_H__
+#endif // ENABLE_MPI
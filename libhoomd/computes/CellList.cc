@@ -60,6 +60,10 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "CellList.h"
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace boost;
 using namespace boost::python;
 using namespace std;
@@ -79,6 +83,8 @@ CellList::CellList(boost::shared_ptr<SystemDefinition> sysdef)
     m_particles_sorted = false;
     m_box_changed = false;
     m_multiple = 1;
+    m_multithreaded = true;
+    m_ghost_layers = 1;
 
     GPUFlags<uint3> conditions(exec_conf);
     m_conditions.swap(conditions);
@@ -123,11 +129,11 @@ uint3 CellList::computeDimensions()
     dim.x = roundDown((unsigned int)((L.x) / (m_nominal_width)), m_multiple);
     dim.y = roundDown((unsigned int)((L.y) / (m_nominal_width)), m_multiple);
 
-    // Add a ghost layer on every side where boundary conditions are non-periodic
+    // Add the ghost layers on every side where boundary conditions are non-periodic
     if (! box.getPeriodic().x)
-        dim.x += 2;
+        dim.x += 2*m_ghost_layers;
     if (! box.getPeriodic().y)
-        dim.y += 2;
+        dim.y += 2*m_ghost_layers;
 
     if (m_sysdef->getNDimensions() == 2)
         {
@@ -145,9 +151,9 @@ uint3 CellList::computeDimensions()
         {
         dim.z = roundDown((unsigned int)((L.z) / (m_nominal_width)), m_multiple);
 
-        // add ghost layer if necessary
+        // add ghost layers if necessary
         if (! box.getPeriodic().z)
-            dim.z += 2;
+            dim.z += 2*m_ghost_layers;
 
         // decrease the number of bins if it exceeds the max
         if (dim.x * dim.y * dim.z > m_max_cells)
@@ -278,15 +284,16 @@ void CellList::initializeWidth()
 
     const BoxDim& box = m_pdata->getBox();
 
-    // the number of ghost cells along every non-periodic direction is two (one on each side)
+    // the number of ghost cells along every non-periodic direction is 2*m_ghost_layers (m_ghost_layers on each side)
+    unsigned int n_ghost = 2*m_ghost_layers;
     if (m_sysdef->getNDimensions() == 2)
-        m_num_ghost_cells = make_uint3(box.getPeriodic().x ? 0 : 2,
-                                       box.getPeriodic().y ? 0 : 2,
+        m_num_ghost_cells = make_uint3(box.getPeriodic().x ? 0 : n_ghost,
+                                       box.getPeriodic().y ? 0 : n_ghost,
                                        0);
     else
-        m_num_ghost_cells = make_uint3(box.getPeriodic().x ? 0 : 2,
-                                       box.getPeriodic().y ? 0 : 2,
-                                       box.getPeriodic().z ? 0 : 2);
+        m_num_ghost_cells = make_uint3(box.getPeriodic().x ? 0 : n_ghost,
+                                       box.getPeriodic().y ? 0 : n_ghost,
+                                       box.getPeriodic().z ? 0 : n_ghost);
 
     // compute ghost layer width
     Scalar3 L = box.getNearestPlaneDistance();
@@ -437,8 +444,100 @@ void CellList::initializeCellAdj()
         m_prof->pop();
     }
 
+//! Value stored in the bin scratch array for particles that are not placed in any cell
+const unsigned int CELLLIST_NOT_BINNED = 0xffffffff;
+
+//! Find the cell a particle belongs in
+/*! \param p Position of the particle
+    \param n Index of the particle
+    \param N Number of local particles (particles with \a n >= \a N are ghosts)
+    \param box Local simulation box
+    \param ghost_width Width of the ghost layer
+    \param dim Cell list dimensions
+    \param ci Cell indexer
+    \param conditions Condition flags to update on error
+
+    \returns The cell index of particle \a n, or CELLLIST_NOT_BINNED if it is not to be placed in the cell list
+*/
+static inline unsigned int binParticle(const Scalar4& p,
+                                       unsigned int n,
+                                       unsigned int N,
+                                       const BoxDim& box,
+                                       const Scalar3& ghost_width,
+                                       const uint3& dim,
+                                       const Index3D& ci,
+                                       uint3& conditions)
+    {
+    if (isnan(p.x) || isnan(p.y) || isnan(p.z))
+        {
+        conditions.y = max(conditions.y, n+1);
+        return CELLLIST_NOT_BINNED;
+        }
+
+    // get periodic flags
+    uchar3 periodic = box.getPeriodic();
+
+    // find the bin each particle belongs in
+    Scalar3 f = box.makeFraction(make_scalar3(p.x, p.y, p.z),ghost_width);
+    int ib = (int)(f.x * dim.x);
+    int jb = (int)(f.y * dim.y);
+    int kb = (int)(f.z * dim.z);
+
+    // check if the particle is inside the unit cell + ghost layer
+    // for non-periodic directions
+    if ((!periodic.x && (f.x < Scalar(0.0) || f.x >= Scalar(1.0))) ||
+        (!periodic.y && (f.y < Scalar(0.0) || f.y >= Scalar(1.0))) ||
+        (!periodic.z && (f.z < Scalar(0.0) || f.z >= Scalar(1.0))) )
+        {
+        // if a ghost particle is out of bounds, silently ignore it
+        if (n < N)
+            conditions.z = max(conditions.z, n+1);
+        return CELLLIST_NOT_BINNED;
+        }
+
+    // need to handle the case where the particle is exactly at the box hi
+    if (ib == (int)dim.x && periodic.x)
+        ib = 0;
+    if (jb == (int)dim.y && periodic.y)
+        jb = 0;
+    if (kb == (int)dim.z && periodic.z)
+        kb = 0;
+
+    // sanity check
+    assert((ib < (int)(dim.x) && jb < (int)(dim.y) && kb < (int)(dim.z)) || n>=N);
+
+    // record its bin
+    unsigned int bin = ci(ib, jb, kb);
+
+    // local particles should be in a valid cell
+    if (bin >= ci.getNumElements())
+        {
+        if (n < N)
+            conditions.z = max(conditions.z, n+1);
+        return CELLLIST_NOT_BINNED;
+        }
+
+    return bin;
+    }
+
+/*! Dispatches to the multithreaded build when it is enabled and more than one CPU thread is in use, and to the
+    serial build otherwise.
+*/
 void CellList::computeCellList()
     {
+#ifdef ENABLE_OPENMP
+    if (m_multithreaded && exec_conf->n_cpu > 1)
+        {
+        computeCellListThreaded();
+        return;
+        }
+#endif
+
+    computeCellListSerial();
+    }
+
+void CellList::computeCellListSerial()
+    {
     if (m_prof)
         m_prof->push("compute");
     
@@ -467,60 +566,15 @@ void CellList::computeCellList()
     
     Scalar3 ghost_width = getGhostWidth();
 
-    // get periodic flags
-    uchar3 periodic = box.getPeriodic();
-
     // for each particle
-    unsigned n_tot_particles = m_pdata->getN() + m_pdata->getNGhosts();
+    unsigned int N = m_pdata->getN();
+    unsigned n_tot_particles = N + m_pdata->getNGhosts();
 
     for (unsigned int n = 0; n < n_tot_particles; n++)
         {
-        Scalar3 p = make_scalar3(h_pos.data[n].x, h_pos.data[n].y, h_pos.data[n].z);
-        if (isnan(p.x) || isnan(p.y) || isnan(p.z))
-            {
-            conditions.y = n+1;
-            continue;
-            }
-            
-
-        // find the bin each particle belongs in
-        Scalar3 f = box.makeFraction(p,ghost_width);
-        int ib = (int)(f.x * m_dim.x);
-        int jb = (int)(f.y * m_dim.y);
-        int kb = (int)(f.z * m_dim.z);
-        
-        // check if the particle is inside the unit cell + ghost layer
-        // for non-periodic directions
-        if ((!periodic.x && (f.x < Scalar(0.0) || f.x >= Scalar(1.0))) ||
-            (!periodic.y && (f.y < Scalar(0.0) || f.y >= Scalar(1.0))) ||
-            (!periodic.z && (f.z < Scalar(0.0) || f.z >= Scalar(1.0))) )
-            { 
-            // if a ghost particle is out of bounds, silently ignore it
-            if (n < m_pdata->getN())
-                conditions.z = n+1;
+        unsigned int bin = binParticle(h_pos.data[n], n, N, box, ghost_width, m_dim, ci, conditions);
+        if (bin == CELLLIST_NOT_BINNED)
             continue;
-            }
-
-        // need to handle the case where the particle is exactly at the box hi
-        if (ib == (int)m_dim.x && periodic.x)
-            ib = 0;
-        if (jb == (int)m_dim.y && periodic.y)
-            jb = 0;
-        if (kb == (int)m_dim.z && periodic.z)
-            kb = 0;
-
-        // sanity check
-        assert((ib < (int)(m_dim.x) && jb < (int)(m_dim.y) && kb < (int)(m_dim.z)) || n>=m_pdata->getN());
-        
-        // record its bin
-        unsigned int bin = ci(ib, jb, kb);
-
-        // local particles should be in a valid cell
-        if (n < m_pdata->getN() && bin >= ci.getNumElements())
-            {
-            conditions.z = n+1;
-            continue;
-            }
 
         // setup the flag value to store
         Scalar flag;
@@ -570,6 +624,161 @@ void CellList::computeCellList()
     if (m_prof)
         m_prof->pop();
     }
+
+/*! The particles are split into one contiguous range per thread and the cell list is built with a counting sort in
+    three passes:
+     -# Each thread computes the cell of each of its particles and counts the members it contributes to every cell.
+     -# For each cell, an exclusive scan over the per-thread counts converts them into write offsets and gives the
+        total cell size.
+     -# Each thread writes its particles into the cell list at its own offsets.
+
+    No locks or atomics are needed, and the particles in each cell end up in increasing index order, exactly as in
+    computeCellListSerial().
+*/
+void CellList::computeCellListThreaded()
+    {
+    if (m_prof)
+        m_prof->push("compute");
+    
+    // acquire the particle data
+    ArrayHandle< Scalar4 > h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle< Scalar4 > h_orientation(m_pdata->getOrientationArray(), access_location::host, access_mode::read);
+    ArrayHandle< Scalar > h_charge(m_pdata->getCharges(), access_location::host, access_mode::read);
+    ArrayHandle< unsigned int > h_body(m_pdata->getBodies(), access_location::host, access_mode::read);
+    ArrayHandle< Scalar > h_diameter(m_pdata->getDiameters(), access_location::host, access_mode::read);
+    const BoxDim& box = m_pdata->getBox();
+  
+    // access the cell list data arrays
+    ArrayHandle<unsigned int> h_cell_size(m_cell_size, access_location::host, access_mode::overwrite);
+    ArrayHandle<Scalar4> h_xyzf(m_xyzf, access_location::host, access_mode::overwrite);
+    ArrayHandle<Scalar4> h_cell_orientation(m_orientation, access_location::host, access_mode::overwrite);
+    ArrayHandle<unsigned int> h_cell_idx(m_idx, access_location::host, access_mode::overwrite);
+    ArrayHandle<Scalar4> h_tdb(m_tdb, access_location::host, access_mode::overwrite);
+    uint3 conditions = make_uint3(0,0,0);
+
+    // shorthand copies of the indexers
+    Index3D ci = m_cell_indexer;
+    Index2D cli = m_cell_list_indexer;
+    unsigned int n_cells = ci.getNumElements();
+    
+    Scalar3 ghost_width = getGhostWidth();
+
+    unsigned int N = m_pdata->getN();
+    unsigned int n_tot_particles = N + m_pdata->getNGhosts();
+
+    if (m_bin_scratch.size() < n_tot_particles)
+        m_bin_scratch.resize(n_tot_particles);
+
+#pragma omp parallel
+    {
+    #ifdef ENABLE_OPENMP
+    unsigned int tid = omp_get_thread_num();
+    unsigned int nthreads = omp_get_num_threads();
+    #else
+    unsigned int tid = 0;
+    unsigned int nthreads = 1;
+    #endif
+
+    #pragma omp single
+        {
+        if (m_thread_cell_count.size() < n_cells*nthreads)
+            m_thread_cell_count.resize(n_cells*nthreads);
+        }
+
+    // per thread cell counts, later converted to per thread write offsets
+    unsigned int *thread_count = &m_thread_cell_count[n_cells*tid];
+    memset(thread_count, 0, sizeof(unsigned int) * n_cells);
+
+    // contiguous range of particles handled by this thread
+    unsigned int start = (unsigned int)((unsigned long long)n_tot_particles * tid / nthreads);
+    unsigned int end = (unsigned int)((unsigned long long)n_tot_particles * (tid+1) / nthreads);
+
+    uint3 thread_conditions = make_uint3(0,0,0);
+
+    // pass 1: bin and count
+    for (unsigned int n = start; n < end; n++)
+        {
+        unsigned int bin = binParticle(h_pos.data[n], n, N, box, ghost_width, m_dim, ci, thread_conditions);
+        m_bin_scratch[n] = bin;
+        if (bin != CELLLIST_NOT_BINNED)
+            thread_count[bin]++;
+        }
+
+    #pragma omp barrier
+
+    // pass 2: exclusive scan of the counts over threads
+    #pragma omp for schedule(static)
+    for (int cell = 0; cell < (int)n_cells; cell++)
+        {
+        unsigned int size = 0;
+        for (unsigned int t = 0; t < nthreads; t++)
+            {
+            unsigned int& count = m_thread_cell_count[n_cells*t + cell];
+            unsigned int c = count;
+            count = size;
+            size += c;
+            }
+
+        h_cell_size.data[cell] = size;
+        if (size > m_Nmax)
+            thread_conditions.x = max(thread_conditions.x, size);
+        }
+
+    // pass 3: write out the cell list entries
+    for (unsigned int n = start; n < end; n++)
+        {
+        unsigned int bin = m_bin_scratch[n];
+        if (bin == CELLLIST_NOT_BINNED)
+            continue;
+
+        unsigned int offset = thread_count[bin]++;
+        if (offset >= m_Nmax)
+            continue;
+
+        // setup the flag value to store
+        Scalar flag;
+        if (m_flag_charge)
+            flag = h_charge.data[n];
+        else if (m_flag_type)
+            flag = h_pos.data[n].w;
+        else
+            flag = __int_as_scalar(n);
+
+        h_xyzf.data[cli(offset, bin)] = make_scalar4(h_pos.data[n].x, h_pos.data[n].y, h_pos.data[n].z, flag);
+        if (m_compute_tdb)
+            {
+            h_tdb.data[cli(offset, bin)] = make_scalar4(h_pos.data[n].w,
+                                                        h_diameter.data[n],
+                                                        __int_as_scalar(h_body.data[n]),
+                                                        Scalar(0.0));
+            }
+
+        if (m_compute_orientation)
+            {
+            h_cell_orientation.data[cli(offset, bin)] = h_orientation.data[n];
+            }
+
+        if (m_compute_idx)
+            {
+            h_cell_idx.data[cli(offset, bin)] = n;
+            }
+        }
+
+    // combine the condition flags of all threads
+    #pragma omp critical
+        {
+        conditions.x = max(conditions.x, thread_conditions.x);
+        conditions.y = max(conditions.y, thread_conditions.y);
+        conditions.z = max(conditions.z, thread_conditions.z);
+        }
+    } // end omp parallel
+
+    // write out conditions
+    m_conditions.resetFlags(conditions);
+
+    if (m_prof)
+        m_prof->pop();
+    }
                 
 bool CellList::checkConditions()            
     {
@@ -677,6 +886,7 @@ void export_CellList()
         .def("getDim", &CellList::getDim, return_internal_reference<>())
         .def("getNmax", &CellList::getNmax)
         .def("benchmark", &CellList::benchmark)
+        .def("setMultithreaded", &CellList::setMultithreaded)
         ;
     }
 
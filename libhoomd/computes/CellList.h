@@ -52,6 +52,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <boost/shared_ptr.hpp>
 #include <boost/signals.hpp>
+#include <vector>
 #include "GPUArray.h"
 #include "GPUFlags.h"
 
@@ -138,6 +139,14 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     Condition flags are to be set during the computeCellList() call and will be checked by compute() which will then 
     take the appropriate action. If possible, flags 1 and 2 should be set to the index of the particle causing the
     flag plus 1.
+
+    <b>Multithreaded build:</b>
+    In OpenMP builds, the cell list is computed with a parallel counting sort (see computeCellListThreaded()). Each
+    thread bins a contiguous range of particles and counts its members per cell, an exclusive scan over the threads
+    gives every thread its own write offset into each cell, and the threads then scatter their particles without any
+    synchronization. Because thread ranges are contiguous and scanned in thread order, particles within each cell are
+    stored in increasing index order, so the resulting \c cell_size and \c xyzf arrays are identical to the serial
+    build. setMultithreaded(false) selects the serial build, which is useful for benchmark() comparisons.
 */
 class CellList : public Compute
     {
@@ -228,6 +237,31 @@ class CellList : public Compute
             m_box_changed = true;
             }
         
+        //! Select the multithreaded (true) or the serial (false) cell list build
+        /*! \param multithreaded Set to false to force the serial build
+
+            The multithreaded build is only used in OpenMP builds and when more than one CPU thread is in use.
+        */
+        void setMultithreaded(bool multithreaded)
+            {
+            m_multithreaded = multithreaded;
+            }
+
+        //! Set the number of ghost cells on every side with non-periodic boundary conditions
+        /*! \param n_ghost_layers Number of ghost cells per side (at least 1)
+
+            Under domain decomposition, ghost particles are received out to r_list beyond the domain boundary. Cells
+            narrower than r_list need more than one ghost cell per side to hold them all.
+        */
+        void setGhostLayers(unsigned int n_ghost_layers)
+            {
+            if (n_ghost_layers != 0)
+                m_ghost_layers = n_ghost_layers;
+            else
+                m_ghost_layers = 1;
+            m_params_changed = true;
+            }
+
         //! Set the multiple value
         void setMultiple(unsigned int multiple)
             {
@@ -355,6 +389,8 @@ class CellList : public Compute
         bool m_particles_sorted;     //!< Set to true when the particles have been sorted
         bool m_box_changed;          //!< Set to ttrue when the box size has changed
         unsigned int m_multiple;     //!< Round cell dimensions down to a multiple of this value
+        bool m_multithreaded;        //!< true if the multithreaded cell list build should be used when available
+        unsigned int m_ghost_layers; //!< Number of ghost cells on every non-periodic side
         
         // parameters determined by initialize
         uint3 m_dim;                 //!< Current dimensions
@@ -375,6 +411,9 @@ class CellList : public Compute
         GPUFlags<uint3> m_conditions;        //!< Condition flags set during the computeCellList() call
         boost::signals::connection m_sort_connection;        //!< Connection to the ParticleData sort signal
         boost::signals::connection m_boxchange_connection;   //!< Connection to the ParticleData box size change signal
+
+        std::vector<unsigned int> m_bin_scratch;            //!< Cell index of each particle (multithreaded build)
+        std::vector<unsigned int> m_thread_cell_count;      //!< Per thread cell counts/offsets (multithreaded build)
         
         //! Computes what the dimensions should me
         uint3 computeDimensions();
@@ -394,6 +433,12 @@ class CellList : public Compute
         //! Compute the cell list
         virtual void computeCellList();
 
+        //! Compute the cell list with a parallel counting sort
+        void computeCellListThreaded();
+
+        //! Compute the cell list serially
+        void computeCellListSerial();
+
         //! Check the status of the conditions
         bool checkConditions();
 
@@ -56,6 +56,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 #include <boost/python.hpp>
+#include <boost/bind.hpp>
 using namespace boost::python;
 
 #include <iostream>
@@ -81,6 +82,28 @@ Compute::Compute(boost::shared_ptr<SystemDefinition> sysdef) : m_sysdef(sysdef),
     m_exec_conf = exec_conf;
     }
 
+Compute::~Compute()
+    {
+#ifdef ENABLE_MPI
+    m_comm_flags_connection.disconnect();
+#endif
+    }
+
+#ifdef ENABLE_MPI
+/*! \param comm The communicator
+
+    On the first call, the compute subscribes to the ghost field requests of the communicator so that the fields
+    listed by getRequestedCommFlags() are exchanged with the ghost particles.
+*/
+void Compute::setCommunicator(boost::shared_ptr<Communicator> comm)
+    {
+    if (!m_comm && comm)
+        m_comm_flags_connection = comm->addCommFlagsRequest(boost::bind(&Compute::getRequestedCommFlags, this, _1));
+
+    m_comm = comm;
+    }
+#endif
+
 /*! \param num_iters Number of iterations to average for the benchmark
     \returns Milliseconds of execution time per calculation
     Derived classes can optionally implement this method. */
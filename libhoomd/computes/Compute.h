@@ -59,6 +59,10 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "SystemDefinition.h"
 #include "Profiler.h"
 
+#ifdef ENABLE_MPI
+#include "Communicator.h"
+#endif
+
 #ifndef __COMPUTE_H__
 #define __COMPUTE_H__
 
@@ -107,7 +111,7 @@ class Compute : boost::noncopyable
     public:
         //! Constructs the compute and associates it with the ParticleData
         Compute(boost::shared_ptr<SystemDefinition> sysdef);
-        virtual ~Compute() {};
+        virtual ~Compute();
         
         //! Abstract method that performs the computation
         /*! \param timestep Current time step
@@ -175,11 +179,16 @@ class Compute : boost::noncopyable
 
 #ifdef ENABLE_MPI
         //! Set communicator this Compute is to use
-        /*! \param comm The communicator
-         */
-        virtual void setCommunicator(boost::shared_ptr<Communicator> comm)
+        virtual void setCommunicator(boost::shared_ptr<Communicator> comm);
+
+        //! Returns the optional ghost particle fields this compute needs
+        /*! \param timestep Current time step
+            Derived classes that read the charge or diameter of ghost particles override this method and set the
+            corresponding comm_flag bits. By default, no optional fields are requested.
+        */
+        virtual CommFlags getRequestedCommFlags(unsigned int timestep)
             {
-            m_comm = comm;
+            return CommFlags(0);
             }
 #endif
 
@@ -206,6 +215,10 @@ class Compute : boost::noncopyable
         bool m_force_compute;           //!< true if calculation is enforced
 
         bool m_mutex;                   //!< Mutex to protect against simultaneous updates of the same compute
+
+#ifdef ENABLE_MPI
+        boost::signals::connection m_comm_flags_connection; //!< Connection to the Communicator ghost field requests
+#endif
        
         //! The python export needs to be a friend to export shouldCompute()
         friend void export_Compute();
@@ -63,7 +63,13 @@ using namespace boost::python;
 #include "HOOMDMPI.h"
 #endif
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
 #include <iostream>
+#include <vector>
+#include <string.h>
 using namespace std;
 
 /*! \param sysdef System for which to compute thermodynamic properties
@@ -189,6 +195,11 @@ Scalar ComputeThermo::getLogValue(const std::string& quantity, unsigned int time
     }
 
 /*! Computes all thermodynamic properties of the system in one fell swoop.
+
+    All sums over the group are accumulated in a single threaded pass with compensated summation. The per-thread
+    partial sums are combined in thread order, so the result only depends on the number of threads. With domain
+    decomposition, the sums of all ranks are combined with a single MPI_Allreduce before the properties are derived
+    from them.
 */
 void ComputeThermo::computeProperties()
     {
@@ -203,111 +214,135 @@ void ComputeThermo::computeProperties()
     assert(m_pdata);
     assert(m_ndof != 0);
     
-    // access the particle data
-    ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::read);
-
-    // access the net force, pe, and virial
-    const GPUArray< Scalar4 >& net_force = m_pdata->getNetForce();
-    const GPUArray< Scalar >& net_virial = m_pdata->getNetVirial();
-    ArrayHandle<Scalar4> h_net_force(net_force, access_location::host, access_mode::read);
-    ArrayHandle<Scalar> h_net_virial(net_virial, access_location::host, access_mode::read);
+    PDataFlags flags = m_pdata->getFlags();
+    bool compute_pressure_tensor = flags[pdata_flag::pressure_tensor];
+    bool compute_pe = flags[pdata_flag::potential_energy];
+    bool compute_virial = compute_pressure_tensor || flags[pdata_flag::isotropic_virial];
 
-    // total kinetic energy 
-    double ke_total = 0.0;
+    double sums[thermo_sum::num_sums];
+    memset(sums, 0, sizeof(double)*thermo_sum::num_sums);
 
-    PDataFlags flags = m_pdata->getFlags();
+        {
+        // access the particle data
+        ArrayHandle<unsigned int> h_index_array(m_group->getIndexArray(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::read);
+
+        // access the net force, pe, and virial
+        const GPUArray< Scalar4 >& net_force = m_pdata->getNetForce();
+        const GPUArray< Scalar >& net_virial = m_pdata->getNetVirial();
+        ArrayHandle<Scalar4> h_net_force(net_force, access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_net_virial(net_virial, access_location::host, access_mode::read);
+        unsigned int virial_pitch = net_virial.getPitch();
 
-    double pressure_kinetic_xx = 0.0;
-    double pressure_kinetic_xy = 0.0;
-    double pressure_kinetic_xz = 0.0;
-    double pressure_kinetic_yy = 0.0;
-    double pressure_kinetic_yz = 0.0;
-    double pressure_kinetic_zz = 0.0;
+        // one set of partial sums per thread
+        unsigned int n_threads = 1;
+#ifdef ENABLE_OPENMP
+        n_threads = omp_get_max_threads();
+#endif
+        std::vector<double> partial_sums(n_threads*thermo_sum::num_sums, 0.0);
 
-    if (flags[pdata_flag::pressure_tensor])
+        #pragma omp parallel
         {
-        // Calculate kinetic part of pressure tensor
-        for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+        int tid = 0;
+#ifdef ENABLE_OPENMP
+        tid = omp_get_thread_num();
+#endif
+        double sum[thermo_sum::num_sums];
+        double c[thermo_sum::num_sums];
+        memset(sum, 0, sizeof(double)*thermo_sum::num_sums);
+        memset(c, 0, sizeof(double)*thermo_sum::num_sums);
+
+        #pragma omp for schedule(static)
+        for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
             {
-            unsigned int j = m_group->getMemberIndex(group_idx);
-            double mass = h_vel.data[j].w;
-            pressure_kinetic_xx += mass*(  (double)h_vel.data[j].x * (double)h_vel.data[j].x );
-            pressure_kinetic_xy += mass*(  (double)h_vel.data[j].x * (double)h_vel.data[j].y );
-            pressure_kinetic_xz += mass*(  (double)h_vel.data[j].x * (double)h_vel.data[j].z );
-            pressure_kinetic_yy += mass*(  (double)h_vel.data[j].y * (double)h_vel.data[j].y );
-            pressure_kinetic_yz += mass*(  (double)h_vel.data[j].y * (double)h_vel.data[j].z );
-            pressure_kinetic_zz += mass*(  (double)h_vel.data[j].z * (double)h_vel.data[j].z );
+            unsigned int j = h_index_array.data[group_idx];
+            thermo_add_particle(sum, c, h_vel.data[j], h_net_force.data[j].w, h_net_virial.data + j, virial_pitch,
+                                compute_pe, compute_virial, compute_pressure_tensor);
             }
-        // kinetic energy = 1/2 trace of kinetic part of pressure tensor
-        ke_total = Scalar(0.5)*(pressure_kinetic_xx + pressure_kinetic_yy + pressure_kinetic_zz);
+
+        for (unsigned int k = 0; k < thermo_sum::num_sums; k++)
+            partial_sums[tid*thermo_sum::num_sums + k] = sum[k];
         }
+
+        // combine the partial sums in thread order
+        double c[thermo_sum::num_sums];
+        memset(c, 0, sizeof(double)*thermo_sum::num_sums);
+        for (unsigned int tid = 0; tid < n_threads; tid++)
+            for (unsigned int k = 0; k < thermo_sum::num_sums; k++)
+                kahan_add(sums[k], c[k], partial_sums[tid*thermo_sum::num_sums + k]);
+        }
+
+    computeFromSums(sums);
+
+    if (m_prof) m_prof->pop();
+    }
+
+/*! \param timestep Current time step of the simulation
+    \param sums Partial sums over the local members of the group, indexed by thermo_sum
+
+    Integrators that already loop over all particles can accumulate the sums with thermo_add_particle() and hand them
+    over here, which saves the separate pass of computeProperties(). The properties are only set if they have not yet
+    been computed at \a timestep, and a later compute(timestep) returns them without another pass.
+*/
+void ComputeThermo::setSums(unsigned int timestep, double *sums)
+    {
+    if (!shouldCompute(timestep))
+        return;
+
+    if (m_group->getNumMembersGlobal() == 0)
+        return;
+
+    if (m_prof) m_prof->push("Thermo");
+    computeFromSums(sums);
+    if (m_prof) m_prof->pop();
+    }
+
+/*! \param sums Partial sums over the local members of the group, indexed by thermo_sum. They are modified.
+
+    The external virial is added, the sums of all ranks are combined and the properties are derived from them.
+*/
+void ComputeThermo::computeFromSums(double *sums)
+    {
+    PDataFlags flags = m_pdata->getFlags();
+    bool compute_pressure_tensor = flags[pdata_flag::pressure_tensor];
+
+    // the external virial is a per-rank contribution, it is summed along with the particle virials
+    sums[thermo_sum::virial_xx] += m_pdata->getExternalVirial(0);
+    sums[thermo_sum::virial_xy] += m_pdata->getExternalVirial(1);
+    sums[thermo_sum::virial_xz] += m_pdata->getExternalVirial(2);
+    sums[thermo_sum::virial_yy] += m_pdata->getExternalVirial(3);
+    sums[thermo_sum::virial_yz] += m_pdata->getExternalVirial(4);
+    sums[thermo_sum::virial_zz] += m_pdata->getExternalVirial(5);
+
+    // the isotropic virial includes the external virial, also when the pressure tensor is not computed
+    if (compute_pressure_tensor)
+        sums[thermo_sum::virial_trace] = sums[thermo_sum::virial_xx] + sums[thermo_sum::virial_yy]
+                                         + sums[thermo_sum::virial_zz];
     else
+        sums[thermo_sum::virial_trace] += m_pdata->getExternalVirial(0) + m_pdata->getExternalVirial(3)
+                                          + m_pdata->getExternalVirial(5);
+
+#ifdef ENABLE_MPI
+    if (m_pdata->getDomainDecomposition())
         {
-        // total kinetic energy
-        for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
-            {
-            unsigned int j = m_group->getMemberIndex(group_idx);
-            ke_total += (double)h_vel.data[j].w*( (double)h_vel.data[j].x * (double)h_vel.data[j].x
-                                                + (double)h_vel.data[j].y * (double)h_vel.data[j].y
-                                                + (double)h_vel.data[j].z * (double)h_vel.data[j].z);
+        if (m_prof)
+            m_prof->push("MPI Allreduce");
 
-            }
+        // all sums are reduced at once
+        MPI_Allreduce(MPI_IN_PLACE, sums, thermo_sum::num_sums, MPI_DOUBLE, MPI_SUM, m_exec_conf->getMPICommunicator());
 
-        ke_total *= Scalar(0.5);
-        }
-    
-    // total potential energy 
-    double pe_total = 0.0;
-    if (flags[pdata_flag::potential_energy])
-        {
-        for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
-            {
-            unsigned int j = m_group->getMemberIndex(group_idx);
-            pe_total += (double)h_net_force.data[j].w;
-            }
+        if (m_prof)
+            m_prof->pop();
         }
+#endif // ENABLE_MPI
 
-    double W = 0.0;
-    double virial_xx = m_pdata->getExternalVirial(0);
-    double virial_xy = m_pdata->getExternalVirial(1);
-    double virial_xz = m_pdata->getExternalVirial(2);
-    double virial_yy = m_pdata->getExternalVirial(3);
-    double virial_yz = m_pdata->getExternalVirial(4);
-    double virial_zz = m_pdata->getExternalVirial(5);
-
-    if (flags[pdata_flag::pressure_tensor])
-        {
-        // Calculate upper triangular virial tensor
-        unsigned int virial_pitch = net_virial.getPitch();
-        for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
-            {
-            unsigned int j = m_group->getMemberIndex(group_idx);
-            virial_xx += (double)h_net_virial.data[j+0*virial_pitch];
-            virial_xy += (double)h_net_virial.data[j+1*virial_pitch];
-            virial_xz += (double)h_net_virial.data[j+2*virial_pitch];
-            virial_yy += (double)h_net_virial.data[j+3*virial_pitch];
-            virial_yz += (double)h_net_virial.data[j+4*virial_pitch];
-            virial_zz += (double)h_net_virial.data[j+5*virial_pitch];
-            }
+    // total kinetic energy
+    double ke_total = 0.5*sums[thermo_sum::mv2];
 
-        if (flags[pdata_flag::isotropic_virial])
-            {
-            // isotropic virial = 1/3 trace of virial tensor
-            W = Scalar(1./3.) * (virial_xx + virial_yy + virial_zz);
-            }
-        }
-     else if (flags[pdata_flag::isotropic_virial])
-        {
-        // only sum up isotropic part of virial tensor
-        unsigned int virial_pitch = net_virial.getPitch();
-        for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
-            {
-            unsigned int j = m_group->getMemberIndex(group_idx);
-            W += Scalar(1./3.)* ((double)h_net_virial.data[j+0*virial_pitch] +
-                                 (double)h_net_virial.data[j+3*virial_pitch] +
-                                 (double)h_net_virial.data[j+5*virial_pitch] );
-            }
-        }
+    // isotropic virial = 1/3 trace of virial tensor
+    double W = 0.0;
+    if (flags[pdata_flag::isotropic_virial])
+        W = 1.0/3.0 * sums[thermo_sum::virial_trace];
 
     // compute the temperature
     Scalar temperature = Scalar(2.0) * Scalar(ke_total) / Scalar(m_ndof);
@@ -335,42 +370,25 @@ void ComputeThermo::computeProperties()
     Scalar pressure =  (2.0 * ke_total / Scalar(D) + W) / volume;
 
     // pressure tensor = (kinetic part + virial) / V
-    Scalar pressure_xx = (pressure_kinetic_xx + virial_xx) / volume;
-    Scalar pressure_xy = (pressure_kinetic_xy + virial_xy) / volume;
-    Scalar pressure_xz = (pressure_kinetic_xz + virial_xz) / volume;
-    Scalar pressure_yy = (pressure_kinetic_yy + virial_yy) / volume;
-    Scalar pressure_yz = (pressure_kinetic_yz + virial_yz) / volume;
-    Scalar pressure_zz = (pressure_kinetic_zz + virial_zz) / volume;
+    Scalar pressure_xx = (sums[thermo_sum::kinetic_xx] + sums[thermo_sum::virial_xx]) / volume;
+    Scalar pressure_xy = (sums[thermo_sum::kinetic_xy] + sums[thermo_sum::virial_xy]) / volume;
+    Scalar pressure_xz = (sums[thermo_sum::kinetic_xz] + sums[thermo_sum::virial_xz]) / volume;
+    Scalar pressure_yy = (sums[thermo_sum::kinetic_yy] + sums[thermo_sum::virial_yy]) / volume;
+    Scalar pressure_yz = (sums[thermo_sum::kinetic_yz] + sums[thermo_sum::virial_yz]) / volume;
+    Scalar pressure_zz = (sums[thermo_sum::kinetic_zz] + sums[thermo_sum::virial_zz]) / volume;
 
     // fill out the GPUArray
     ArrayHandle<Scalar> h_properties(m_properties, access_location::host, access_mode::overwrite);
     h_properties.data[thermo_index::temperature] = temperature;
     h_properties.data[thermo_index::pressure] = pressure;
     h_properties.data[thermo_index::kinetic_energy] = Scalar(ke_total);
-    h_properties.data[thermo_index::potential_energy] = Scalar(pe_total);
+    h_properties.data[thermo_index::potential_energy] = Scalar(sums[thermo_sum::pe]);
     h_properties.data[thermo_index::pressure_xx] = pressure_xx;
     h_properties.data[thermo_index::pressure_xy] = pressure_xy;
     h_properties.data[thermo_index::pressure_xz] = pressure_xz;
     h_properties.data[thermo_index::pressure_yy] = pressure_yy;
     h_properties.data[thermo_index::pressure_yz] = pressure_yz;
     h_properties.data[thermo_index::pressure_zz] = pressure_zz;
-
-#ifdef ENABLE_MPI
-    if (m_pdata->getDomainDecomposition())
-        {
-        MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
-
-        if (m_prof)
-            m_prof->push("MPI Allreduce");
-
-        MPI_Allreduce(MPI_IN_PLACE, h_properties.data, thermo_index::num_quantities, MPI_HOOMD_SCALAR, MPI_SUM, mpi_comm);
-
-        if (m_prof)
-                m_prof->pop();
-        }
-#endif // ENABLE_MPI
- 
-    if (m_prof) m_prof->pop();
     }
 
 void export_ComputeThermo()
@@ -69,6 +69,112 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef __COMPUTE_THERMO_H__
 #define __COMPUTE_THERMO_H__
 
+//! Indices of the partial sums from which ComputeThermo derives its properties
+namespace thermo_sum
+    {
+    enum Enum
+        {
+        mv2 = 0,        //!< Sum of m v^2 (twice the kinetic energy)
+        pe,             //!< Potential energy
+        virial_trace,   //!< Trace of the virial tensor, without the external virial
+        kinetic_xx,     //!< Kinetic part of the pressure tensor (m v_x v_x)
+        kinetic_xy,     //!< Kinetic part of the pressure tensor (m v_x v_y)
+        kinetic_xz,     //!< Kinetic part of the pressure tensor (m v_x v_z)
+        kinetic_yy,     //!< Kinetic part of the pressure tensor (m v_y v_y)
+        kinetic_yz,     //!< Kinetic part of the pressure tensor (m v_y v_z)
+        kinetic_zz,     //!< Kinetic part of the pressure tensor (m v_z v_z)
+        virial_xx,      //!< Virial tensor, xx component
+        virial_xy,      //!< Virial tensor, xy component
+        virial_xz,      //!< Virial tensor, xz component
+        virial_yy,      //!< Virial tensor, yy component
+        virial_yz,      //!< Virial tensor, yz component
+        virial_zz,      //!< Virial tensor, zz component
+        num_sums        //!< Number of partial sums
+        };
+    }
+
+//! Adds a value to a compensated (Kahan) sum
+/*! \param sum Running sum
+    \param c Running compensation for lost low-order bits
+    \param x Value to add
+
+    \note The compensation only works with strict floating point semantics. A compiler that may reassociate
+    (t - sum) - y simplifies it to zero and leaves a plain sum. This is the default of icc (-fp-model fast=1, the
+    icpc flags in HOOMDCFlagsSetup.cmake do not override it) and of MSVC with /fp:fast, so precise semantics are
+    requested for these compilers below. Do not build this header with -ffast-math.
+*/
+#if defined(__INTEL_COMPILER) || defined(_MSC_VER)
+#pragma float_control(precise, on, push)
+#endif
+inline void kahan_add(double& sum, double& c, double x)
+    {
+    double y = x - c;
+    double t = sum + y;
+    c = (t - sum) - y;
+    sum = t;
+    }
+#if defined(__INTEL_COMPILER) || defined(_MSC_VER)
+#pragma float_control(pop)
+#endif
+
+//! Adds the contribution of one particle to the partial sums of ComputeThermo
+/*! \param sum Partial sums, indexed by thermo_sum
+    \param c Compensations of the partial sums
+    \param vel Velocity (x,y,z) and mass (w) of the particle
+    \param pe Potential energy of the particle
+    \param virial Net virial of the particle, the six components are \a virial_pitch elements apart
+    \param virial_pitch Pitch of the net virial array
+    \param compute_pe True if the potential energy is summed
+    \param compute_virial True if the trace of the virial is summed
+    \param compute_pressure_tensor True if the kinetic and virial tensors are summed
+
+    The same accumulation is used by ComputeThermo::computeProperties() and by the integrators that sum the
+    properties along with the net force, so that both paths give the same results.
+*/
+inline void thermo_add_particle(double *sum,
+                                double *c,
+                                const Scalar4& vel,
+                                Scalar pe,
+                                const Scalar *virial,
+                                unsigned int virial_pitch,
+                                bool compute_pe,
+                                bool compute_virial,
+                                bool compute_pressure_tensor)
+    {
+    double mass = vel.w;
+    double vx = vel.x;
+    double vy = vel.y;
+    double vz = vel.z;
+
+    kahan_add(sum[thermo_sum::mv2], c[thermo_sum::mv2], mass*(vx*vx + vy*vy + vz*vz));
+
+    if (compute_pe)
+        kahan_add(sum[thermo_sum::pe], c[thermo_sum::pe], (double)pe);
+
+    if (compute_pressure_tensor)
+        {
+        kahan_add(sum[thermo_sum::kinetic_xx], c[thermo_sum::kinetic_xx], mass*vx*vx);
+        kahan_add(sum[thermo_sum::kinetic_xy], c[thermo_sum::kinetic_xy], mass*vx*vy);
+        kahan_add(sum[thermo_sum::kinetic_xz], c[thermo_sum::kinetic_xz], mass*vx*vz);
+        kahan_add(sum[thermo_sum::kinetic_yy], c[thermo_sum::kinetic_yy], mass*vy*vy);
+        kahan_add(sum[thermo_sum::kinetic_yz], c[thermo_sum::kinetic_yz], mass*vy*vz);
+        kahan_add(sum[thermo_sum::kinetic_zz], c[thermo_sum::kinetic_zz], mass*vz*vz);
+
+        kahan_add(sum[thermo_sum::virial_xx], c[thermo_sum::virial_xx], (double)virial[0*virial_pitch]);
+        kahan_add(sum[thermo_sum::virial_xy], c[thermo_sum::virial_xy], (double)virial[1*virial_pitch]);
+        kahan_add(sum[thermo_sum::virial_xz], c[thermo_sum::virial_xz], (double)virial[2*virial_pitch]);
+        kahan_add(sum[thermo_sum::virial_yy], c[thermo_sum::virial_yy], (double)virial[3*virial_pitch]);
+        kahan_add(sum[thermo_sum::virial_yz], c[thermo_sum::virial_yz], (double)virial[4*virial_pitch]);
+        kahan_add(sum[thermo_sum::virial_zz], c[thermo_sum::virial_zz], (double)virial[5*virial_pitch]);
+        }
+    else if (compute_virial)
+        {
+        // only sum up isotropic part of virial tensor
+        kahan_add(sum[thermo_sum::virial_trace], c[thermo_sum::virial_trace],
+                  (double)virial[0*virial_pitch] + (double)virial[3*virial_pitch] + (double)virial[5*virial_pitch]);
+        }
+    }
+
 //! Computes thermodynamic properties of a group of particles
 /*! ComputeThermo calculates instantaneous thermodynamic properties and provides them for the logger.
     All computed values are stored in a GPUArray so that they can be accessed on the GPU without intermediate copies.
@@ -109,6 +215,9 @@ class ComputeThermo : public Compute
         
         //! Compute the temperature
         virtual void compute(unsigned int timestep);
+
+        //! Set the properties from sums accumulated elsewhere
+        void setSums(unsigned int timestep, double *sums);
         
         //! Change the number of degrees of freedom
         void setNDOF(unsigned int ndof);
@@ -226,6 +335,9 @@ class ComputeThermo : public Compute
 
         //! Does the actual computation
         virtual void computeProperties();
+
+        //! Derives the properties from the local partial sums
+        void computeFromSums(double *sums);
     };
 
 //! Exports the ComputeThermo class to python
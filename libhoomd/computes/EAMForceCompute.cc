@@ -65,6 +65,10 @@ using namespace boost::python;
 #include "EAMForceCompute.h"
 #include <stdexcept>
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
 /*! \file EAMForceCompute.cc
     \brief Defines the EAMForceCompute class
 */
@@ -284,6 +288,43 @@ void EAMForceCompute::loadFile(char *filename, int type_of_file)
 
         }
 
+    buildTables();
+    }
+
+/*! The CPU force compute evaluates the density, pair potential and their derivatives for a pair at the same
+    distance, so the separate tables are interleaved into one EAMPairTableEntry per (typei, typej, r). The entries
+    hold the same values, with the same indexing, as the separate tables used by the GPU code.
+*/
+void EAMForceCompute::buildTables()
+    {
+    GPUArray<EAMPairTableEntry> pair_table(nr * m_ntypes * m_ntypes, m_exec_conf);
+    m_pair_table.swap(pair_table);
+    GPUArray<Scalar2> embedding_table(nrho * m_ntypes, m_exec_conf);
+    m_embedding_table.swap(embedding_table);
+
+    ArrayHandle<EAMPairTableEntry> h_pair_table(m_pair_table, access_location::host, access_mode::overwrite);
+    for (unsigned int typei = 0; typei < m_ntypes; typei++)
+        for (unsigned int typej = 0; typej < m_ntypes; typej++)
+            {
+            unsigned int shift = (typei>=typej)?(unsigned int)(0.5 * (2 * m_ntypes - typej -1)*typej + typei) * nr:(unsigned int)(0.5 * (2 * m_ntypes - typei -1)*typei + typej) * nr;
+            for (unsigned int i = 0; i < nr; i++)
+                {
+                EAMPairTableEntry& entry = h_pair_table.data[i + nr * (typei * m_ntypes + typej)];
+                entry.rho = electronDensity[i + nr * (typei * m_ntypes + typej)];
+                entry.drho = derivativeElectronDensity[i + nr * (typei * m_ntypes + typej)];
+                entry.phi = pairPotential[i + shift].x;
+                entry.dphi = pairPotential[i + shift].y;
+                entry.drho_i = derivativeElectronDensity[i + typei * nr];
+                entry.drho_j = derivativeElectronDensity[i + typej * nr];
+                entry.pad[0] = entry.pad[1] = Scalar(0.0);
+                }
+            }
+
+    ArrayHandle<Scalar2> h_embedding_table(m_embedding_table, access_location::host, access_mode::overwrite);
+    for (unsigned int type = 0; type < m_ntypes; type++)
+        for (unsigned int i = 0; i < nrho; i++)
+            h_embedding_table.data[i + type * nrho] = make_scalar2(embeddingFunction[i + type * nrho],
+                                                                   derivativeEmbeddingFunction[i + type * nrho]);
     }
 std::vector< std::string > EAMForceCompute::getProvidedLogQuantities()
     {
@@ -324,6 +365,18 @@ void EAMForceCompute::computeForces(unsigned int timestep)
     // to reduce computations at the cost of memory access complexity: set that flag now
     bool third_law = m_nlist->getStorageMode() == NeighborList::half;
 
+    // with a half neighbor list the density and force contributions are scattered to the neighbors,
+    // which needs the per thread partial arrays
+    if (m_thread_accumulation == owner_computes && third_law)
+        {
+        m_exec_conf->msg->error() << "pair.eam: owner computes accumulation requires a full neighbor list" << endl;
+        throw runtime_error("Error computing pair forces");
+        }
+
+    // the per thread partial arrays are allocated on first use, so that EAMForceComputeGPU never allocates them
+    if (third_law && !m_fdata_partial)
+        allocateThreadPartial();
+
     // access the neighbor list
     assert(m_nlist);
     ArrayHandle<unsigned int> h_n_neigh(m_nlist->getNNeighArray(), access_location::host, access_mode::read);
@@ -335,15 +388,15 @@ void EAMForceCompute::computeForces(unsigned int timestep)
     ArrayHandle<Scalar4> h_force(m_force,access_location::host, access_mode::overwrite);
     ArrayHandle<Scalar> h_virial(m_virial,access_location::host, access_mode::overwrite);
     unsigned int virial_pitch = m_virial.getPitch();
- 
+
+    // access the interleaved tables
+    ArrayHandle<EAMPairTableEntry> h_pair_table(m_pair_table, access_location::host, access_mode::read);
+    ArrayHandle<Scalar2> h_embedding_table(m_embedding_table, access_location::host, access_mode::read);
+
     // there are enough other checks on the input data: but it doesn't hurt to be safe
     assert(h_force.data);
     assert(h_virial.data);
     assert(h_pos.data);
-    
-    // Zero data for force calculation.
-    memset((void*)h_force.data,0,sizeof(Scalar4)*m_force.getNumElements());
-    memset((void*)h_virial.data,0,sizeof(Scalar)*m_virial.getNumElements());
 
     // get a local copy of the simulation box too
     const BoxDim& box = m_pdata->getBox();
@@ -354,23 +407,44 @@ void EAMForceCompute::computeForces(unsigned int timestep)
     // tally up the number of forces calculated
     int64_t n_calc = 0;
 
-
-    // for each particle
-    vector<Scalar> atomElectronDensity;
-    atomElectronDensity.resize(m_pdata->getN());
-    vector<Scalar> atomDerivativeEmbeddingFunction;
-    atomDerivativeEmbeddingFunction.resize(m_pdata->getN());
-    vector<Scalar> atomEmbeddingFunction;
-    atomEmbeddingFunction.resize(m_pdata->getN());
+    unsigned int N = m_pdata->getN();
     unsigned int ntypes = m_pdata->getNTypes();
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
+    m_atom_rho.resize(N);
+    m_atom_embedding.resize(N);
+    m_atom_derivative_embedding.resize(N);
+    if (third_law)
+        m_rho_partial.resize(m_index_thread_partial.getNumElements());
+
+#pragma omp parallel reduction(+:n_calc)
+    {
+    #ifdef ENABLE_OPENMP
+    int tid = omp_get_thread_num();
+    int nthreads = omp_get_num_threads();
+    #else
+    int tid = 0;
+    int nthreads = 1;
+    #endif
+
+    // need to start from a zero density, force and virial
+    if (third_law)
+        {
+        memset(&m_rho_partial[m_index_thread_partial(0,tid)], 0, sizeof(Scalar)*N);
+        memset(&m_fdata_partial[m_index_thread_partial(0,tid)], 0, sizeof(Scalar4)*N);
+        memset(&m_virial_partial[6*m_index_thread_partial(0,tid)], 0, 6*sizeof(Scalar)*N);
+        }
+
+    // first pass: the electron density at each particle
+#pragma omp for schedule(guided)
+    for (int i = 0; i < (int)N; i++)
         {
         // access the particle's position and type (MEM TRANSFER: 4 scalars)
         Scalar3 pi = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
         unsigned int typei = __scalar_as_int(h_pos.data[i].w);
 
         // sanity check
-        assert(typei < m_pdata->getNTypes());
+        assert(typei < ntypes);
+
+        Scalar rhoi = Scalar(0.0);
 
         // loop over all of the neighbors of this particle
         const unsigned int size = (unsigned int)h_n_neigh.data[i];
@@ -383,7 +457,7 @@ void EAMForceCompute::computeForces(unsigned int timestep)
             // access the index of this neighbor (MEM TRANSFER: 1 scalar)
             unsigned int k = h_nlist.data[nli(i, j)];
             // sanity check
-            assert(k < m_pdata->getN());
+            assert(k < N);
 
             // calculate dr (MEM TRANSFER: 3 scalars / FLOPS: 3)
             Scalar3 pk = make_scalar3(h_pos.data[k].x, h_pos.data[k].y, h_pos.data[k].z);
@@ -392,58 +466,80 @@ void EAMForceCompute::computeForces(unsigned int timestep)
             // access the type of the neighbor particle (MEM TRANSFER: 1 scalar
             unsigned int typej = __scalar_as_int(h_pos.data[k].w);
             // sanity check
-            assert(typej < m_pdata->getNTypes());
+            assert(typej < ntypes);
 
             // apply periodic boundary conditions
             dx = box.minImage(dx);
 
-            // start computing the force
             // calculate r squared (FLOPS: 5)
-            Scalar rsq = dot(dx, dx);;
-            // only compute the force if the particles are closer than the cuttoff (FLOPS: 1)
+            Scalar rsq = dot(dx, dx);
+            // only compute the density if the particles are closer than the cuttoff (FLOPS: 1)
             if (rsq < r_cut_sq)
                 {
-                 Scalar position_float = sqrt(rsq) * rdr;
-                 Scalar position = position_float;
-                 unsigned int r_index = (unsigned int)position;
-                 r_index = min(r_index,nr);
-                 position -= r_index;
-                 atomElectronDensity[i] += electronDensity[r_index + nr * (typei * ntypes + typej)] + derivativeElectronDensity[r_index + nr * (typei * ntypes + typej)] * position * dr;
-                 if(third_law)
+                Scalar position = sqrt(rsq) * rdr;
+                unsigned int r_index = (unsigned int)position;
+                r_index = min(r_index, nr - 1);
+                position -= r_index;
+
+                const EAMPairTableEntry& entry_ij = h_pair_table.data[r_index + nr * (typei * ntypes + typej)];
+                rhoi += entry_ij.rho + entry_ij.drho * position * dr;
+                if (third_law)
                     {
-                    atomElectronDensity[k] += electronDensity[r_index + nr * (typej * ntypes + typei)]
-                        + derivativeElectronDensity[r_index + nr * (typej * ntypes + typei)] * position * dr;
+                    const EAMPairTableEntry& entry_ji = h_pair_table.data[r_index + nr * (typej * ntypes + typei)];
+                    m_rho_partial[m_index_thread_partial(k,tid)] += entry_ji.rho + entry_ji.drho * position * dr;
                     }
                 }
             }
+
+        if (third_law)
+            m_rho_partial[m_index_thread_partial(i,tid)] += rhoi;
+        else
+            m_atom_rho[i] = rhoi;
         }
 
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
+    // second pass: the embedding energy and its derivative. The implicit barriers of the two loops are both needed:
+    // the partial densities must be complete before they are summed, and F'(rho) of every neighbor must be known
+    // before the force pass starts
+#pragma omp for
+    for (int i = 0; i < (int)N; i++)
         {
         unsigned int typei = __scalar_as_int(h_pos.data[i].w);
 
-        Scalar position = atomElectronDensity[i] * rdrho;
+        Scalar rhoi = Scalar(0.0);
+        if (third_law)
+            {
+            for (int thread = 0; thread < nthreads; thread++)
+                rhoi += m_rho_partial[m_index_thread_partial(i,thread)];
+            m_atom_rho[i] = rhoi;
+            }
+        else
+            rhoi = m_atom_rho[i];
+
+        Scalar position = rhoi * rdrho;
         unsigned int r_index = (unsigned int)position;
-        r_index = min(r_index,nrho);
+        r_index = min(r_index, nrho - 1);
         position -= (Scalar)r_index;
-        atomDerivativeEmbeddingFunction[i] = derivativeEmbeddingFunction[r_index + typei * nrho];
 
-        h_force.data[i].w += embeddingFunction[r_index + typei * nrho] + derivativeEmbeddingFunction[r_index + typei * nrho] * position * drho;
+        Scalar2 embedding = h_embedding_table.data[r_index + typei * nrho];
+        m_atom_derivative_embedding[i] = embedding.y;
+        m_atom_embedding[i] = embedding.x + embedding.y * position * drho;
         }
 
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
+    // third pass: the forces
+#pragma omp for schedule(guided)
+    for (int i = 0; i < (int)N; i++)
         {
         // access the particle's position and type (MEM TRANSFER: 4 scalars)
         Scalar3 pi = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
         unsigned int typei = __scalar_as_int(h_pos.data[i].w);
         // sanity check
-        assert(typei < m_pdata->getNTypes());
+        assert(typei < ntypes);
 
-        // initialize current particle force, potential energy, and virial to 0
+        // initialize current particle force and virial to 0, the potential energy starts with the embedding energy
         Scalar fxi = 0.0;
         Scalar fyi = 0.0;
         Scalar fzi = 0.0;
-        Scalar pei = 0.0;
+        Scalar pei = m_atom_embedding[i];
         Scalar viriali[6];
         for (int k = 0; k < 6; k++)
             viriali[k] = 0.0;
@@ -458,7 +554,7 @@ void EAMForceCompute::computeForces(unsigned int timestep)
             // access the index of this neighbor (MEM TRANSFER: 1 scalar)
             unsigned int k = h_nlist.data[nli(i, j)];
             // sanity check
-            assert(k < m_pdata->getN());
+            assert(k < N);
 
             // calculate dr (MEM TRANSFER: 3 scalars / FLOPS: 3)
             Scalar3 pk = make_scalar3(h_pos.data[k].x, h_pos.data[k].y, h_pos.data[k].z);
@@ -467,7 +563,7 @@ void EAMForceCompute::computeForces(unsigned int timestep)
             // access the type of the neighbor particle (MEM TRANSFER: 1 scalar
             unsigned int typej = __scalar_as_int(h_pos.data[k].w);
             // sanity check
-            assert(typej < m_pdata->getNTypes());
+            assert(typej < ntypes);
 
             // apply periodic boundary conditions
             dx = box.minImage(dx);
@@ -481,16 +577,14 @@ void EAMForceCompute::computeForces(unsigned int timestep)
             Scalar inverseR = 1.0 / r;
             Scalar position = r * rdr;
             unsigned int r_index = (unsigned int)position;
+            r_index = min(r_index, nr - 1);
             position = position - (Scalar)r_index;
-            int shift = (typei>=typej)?(int)(0.5 * (2 * ntypes - typej -1)*typej + typei) * nr:(int)(0.5 * (2 * ntypes - typei -1)*typei + typej) * nr;
-            //r_index = min(r_index,nr - 1);
-            Scalar pair_eng = (pairPotential[r_index + shift].x +
-                pairPotential[r_index + shift].y * position * dr) * inverseR;
-            Scalar derivativePhi = (pairPotential[r_index + shift].y - pair_eng) * inverseR;
-            Scalar derivativeRhoI = derivativeElectronDensity[r_index + typei * nr];
-            Scalar derivativeRhoJ = derivativeElectronDensity[r_index + typej * nr];
-            Scalar fullDerivativePhi = atomDerivativeEmbeddingFunction[i] * derivativeRhoJ +
-                atomDerivativeEmbeddingFunction[k] * derivativeRhoI + derivativePhi;
+
+            const EAMPairTableEntry& entry = h_pair_table.data[r_index + nr * (typei * ntypes + typej)];
+            Scalar pair_eng = (entry.phi + entry.dphi * position * dr) * inverseR;
+            Scalar derivativePhi = (entry.dphi - pair_eng) * inverseR;
+            Scalar fullDerivativePhi = m_atom_derivative_embedding[i] * entry.drho_j +
+                m_atom_derivative_embedding[k] * entry.drho_i + derivativePhi;
             Scalar pairForce = - fullDerivativePhi * inverseR;
             // are the virial and potential energy correctly calculated
             // with respect to double counting?
@@ -507,18 +601,55 @@ void EAMForceCompute::computeForces(unsigned int timestep)
 
             if (third_law)
                 {
-                h_force.data[k].x -= dx.x * pairForce;
-                h_force.data[k].y -= dx.y * pairForce;
-                h_force.data[k].z -= dx.z * pairForce;
+                unsigned int mem_idx = m_index_thread_partial(k,tid);
+                m_fdata_partial[mem_idx].x -= dx.x * pairForce;
+                m_fdata_partial[mem_idx].y -= dx.y * pairForce;
+                m_fdata_partial[mem_idx].z -= dx.z * pairForce;
                 }
             }
-        h_force.data[i].x += fxi;
-        h_force.data[i].y += fyi;
-        h_force.data[i].z += fzi;
-        h_force.data[i].w += pei;
+
+        // with a full neighbor list, this thread is the only one writing to particle i
+        if (!third_law)
+            {
+            h_force.data[i] = make_scalar4(fxi, fyi, fzi, pei);
+            for (int k = 0; k < 6; k++)
+                h_virial.data[k*virial_pitch+i] = viriali[k];
+            continue;
+            }
+
+        unsigned int mem_idx = m_index_thread_partial(i,tid);
+        m_fdata_partial[mem_idx].x += fxi;
+        m_fdata_partial[mem_idx].y += fyi;
+        m_fdata_partial[mem_idx].z += fzi;
+        m_fdata_partial[mem_idx].w += pei;
         for (int k = 0; k < 6; k++)
-            h_virial.data[k*virial_pitch+i] += viriali[k];
+            m_virial_partial[k+6*mem_idx] += viriali[k];
+        }
+
+    // sum up the partial forces now that every thread has finished the force pass
+    if (third_law)
+        {
+#pragma omp for
+        for (int i = 0; i < (int)N; i++)
+            {
+            Scalar4 fi = make_scalar4(0.0, 0.0, 0.0, 0.0);
+            Scalar viriali[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+            for (int thread = 0; thread < nthreads; thread++)
+                {
+                unsigned int mem_idx = m_index_thread_partial(i,thread);
+                fi.x += m_fdata_partial[mem_idx].x;
+                fi.y += m_fdata_partial[mem_idx].y;
+                fi.z += m_fdata_partial[mem_idx].z;
+                fi.w += m_fdata_partial[mem_idx].w;
+                for (int k = 0; k < 6; k++)
+                    viriali[k] += m_virial_partial[k+6*mem_idx];
+                }
+            h_force.data[i] = fi;
+            for (int k = 0; k < 6; k++)
+                h_virial.data[k*virial_pitch+i] = viriali[k];
+            }
         }
+    } // end omp parallel
 
     int64_t flops = m_pdata->getN() * 5 + n_calc * (3+5+9+1+9+6+8);
     if (third_law) flops += n_calc * 8;
@@ -67,6 +67,22 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef __EAMFORCECOMPUTE_H__
 #define __EAMFORCECOMPUTE_H__
 
+//! Tabulated EAM coefficients of one (typei, typej) pair at one grid point in r
+/*! The CPU force compute reads everything it needs for a pair at a given distance from a single entry, instead of
+    gathering from five separate tables. The entry is padded to 8 Scalars (32 or 64 bytes). On the host, GPUArray
+    memory only has the alignment of new[], so an entry may straddle two cache lines, but never more.
+*/
+struct EAMPairTableEntry
+    {
+    Scalar rho;         //!< Electron density at particle i due to a neighbor j
+    Scalar drho;        //!< Derivative of \a rho
+    Scalar phi;         //!< Pair potential Z(r)
+    Scalar dphi;        //!< Derivative of the pair potential
+    Scalar drho_i;      //!< Density derivative weighted by F'(rho) of the neighbor in the force pass
+    Scalar drho_j;      //!< Density derivative weighted by F'(rho) of particle i in the force pass
+    Scalar pad[2];      //!< Padding to 8 Scalars
+    };
+
 //! Computes Lennard-Jones forces on each particle
 /*! The total pair force is summed for each particle when compute() is called. Forces are only summed between
     neighboring particles with a separation distance less than \c r_cut. A NeighborList must be provided
@@ -79,6 +95,12 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     Forces can be computed directly by calling compute() and then retrieved with a call to acquire(), but
     a more typical usage will be to add the force compute to NVEUpdater or NVTUpdater.
 
+    On the CPU, the density, embedding and force passes are each split over the OpenMP threads. The embedding pass
+    sits between two barriers, because the force on i needs F'(rho) of all of its neighbors. With a half neighbor
+    list, the scattered density and force contributions go to the per thread partial arrays of ForceCompute and
+    are summed after each pass. With a full neighbor list every thread writes only the particles it owns. The
+    tables read from the file are interleaved into m_pair_table and m_embedding_table after loading.
+
     \ingroup computes
 */
 class EAMForceCompute : public ForceCompute
@@ -105,6 +127,12 @@ class EAMForceCompute : public ForceCompute
         //! Shifting modes that can be applied to the energy
         virtual void loadFile(char *filename, int type_of_file);
 
+        //! The CPU compute implements both thread accumulation modes
+        virtual bool supportsThreadAccumulation()
+            {
+            return true;
+            }
+
 
     protected:
         boost::shared_ptr<NeighborList> m_nlist;       //!< The neighborlist to use for the computation
@@ -129,6 +157,17 @@ class EAMForceCompute : public ForceCompute
         vector<Scalar> derivativeElectronDensity;      //!< array rho'(r)
         vector<Scalar> derivativePairPotential;        //!< array Z'(r)
         vector<Scalar> derivativeEmbeddingFunction;    //!< array F'(rho)
+
+        GPUArray<EAMPairTableEntry> m_pair_table;      //!< Interleaved pair tables, indexed by r + nr*(typei*ntypes + typej)
+        GPUArray<Scalar2> m_embedding_table;           //!< Interleaved (F, F') tables, indexed by rho + nrho*type
+
+        vector<Scalar> m_atom_rho;                     //!< Electron density at each particle
+        vector<Scalar> m_atom_embedding;               //!< Embedding energy F(rho) of each particle
+        vector<Scalar> m_atom_derivative_embedding;    //!< F'(rho) of each particle
+        vector<Scalar> m_rho_partial;                  //!< Per thread partial densities, indexed like m_fdata_partial
+
+        //! Interleave the tables read from the file into m_pair_table and m_embedding_table
+        void buildTables();
         
         //! Actually compute the forces
         virtual void computeForces(unsigned int timestep);
@@ -80,7 +80,7 @@ using namespace boost;
     \post All forces are initialized to 0
 */
 ForceCompute::ForceCompute(boost::shared_ptr<SystemDefinition> sysdef) : Compute(sysdef), m_particles_sorted(false),
-    m_index_thread_partial(0)
+    m_index_thread_partial(0), m_use_thread_partial(false), m_thread_accumulation(thread_partial)
     {
     assert(m_pdata);
     assert(m_pdata->getMaxN() > 0);
@@ -112,15 +112,78 @@ ForceCompute::ForceCompute(boost::shared_ptr<SystemDefinition> sysdef) : Compute
     }
 
 /*! \post m_fdata and virial _partial are both allocated, and m_index_thread_partial is intiialized for indexing them
+
+    Subclasses that accumulate into the partial arrays call this in their constructor. In the owner_computes mode,
+    the arrays are not allocated until the mode is switched back to thread_partial.
 */
 void ForceCompute::allocateThreadPartial()
     {
     assert(exec_conf->n_cpu >= 1);
+    m_use_thread_partial = true;
+    if (m_thread_accumulation != thread_partial)
+        return;
+
     m_index_thread_partial = Index2D(m_pdata->getMaxN(), exec_conf->n_cpu);
     //Don't use GPU arrays here, *_partial's only used on CPU
     m_fdata_partial = new Scalar4[m_index_thread_partial.getNumElements()];
     m_virial_partial = new Scalar[6*m_index_thread_partial.getNumElements()];
     m_torque_partial = new Scalar4[m_index_thread_partial.getNumElements()];
+
+    m_exec_conf->msg->notice(6) << "ForceCompute: per thread partial arrays use "
+                                << float(getThreadPartialBytes()) / float(1024*1024) << " MB" << endl;
+    }
+
+/*! \post m_fdata and virial _partial are freed
+*/
+void ForceCompute::freeThreadPartial()
+    {
+    if (m_fdata_partial)
+        {
+        delete[] m_fdata_partial;
+        m_fdata_partial = NULL;
+        delete[] m_virial_partial;
+        m_virial_partial = NULL;
+        delete[] m_torque_partial;
+        m_torque_partial=NULL;
+        }
+    m_index_thread_partial = Index2D(0);
+    }
+
+/*! \param mode Strategy to use for combining the forces computed by several CPU threads
+
+    The partial arrays are freed when switching to owner_computes and allocated again when switching back to
+    thread_partial. Subclasses that do not implement both modes (see supportsThreadAccumulation()) throw an error.
+*/
+void ForceCompute::setThreadAccumulation(threadAccumulationMode mode)
+    {
+    if (!supportsThreadAccumulation())
+        {
+        m_exec_conf->msg->error() << "This force compute does not support setting the thread accumulation mode"
+                                  << endl;
+        throw runtime_error("Error setting thread accumulation mode");
+        }
+
+    if (mode == m_thread_accumulation)
+        return;
+
+    m_thread_accumulation = mode;
+    if (!m_use_thread_partial)
+        return;
+
+    if (mode == thread_partial)
+        allocateThreadPartial();
+    else
+        freeThreadPartial();
+    }
+
+/*! \returns The number of bytes allocated for the per thread force, virial and torque partial arrays
+*/
+size_t ForceCompute::getThreadPartialBytes()
+    {
+    if (!m_fdata_partial)
+        return 0;
+
+    return size_t(m_index_thread_partial.getNumElements()) * (2*sizeof(Scalar4) + 6*sizeof(Scalar));
     }
 
 /*! \post m_force, m_virial and m_torque are resized to the current maximum particle number
@@ -146,9 +209,7 @@ void ForceCompute::reallocateThreadPartial()
     // never allocated ? do nothing.
     if (! m_fdata_partial || ! m_virial_partial || ! m_torque_partial) return;
 
-    delete[] m_fdata_partial;
-    delete[] m_virial_partial;
-    delete[] m_torque_partial;
+    freeThreadPartial();
     allocateThreadPartial();
     }
 
@@ -156,15 +217,7 @@ void ForceCompute::reallocateThreadPartial()
 */
 ForceCompute::~ForceCompute()
     {
-    if (m_fdata_partial)
-        {
-        delete[] m_fdata_partial;
-        m_fdata_partial = NULL;
-        delete[] m_virial_partial;
-        m_virial_partial = NULL;
-        delete[] m_torque_partial;
-        m_torque_partial=NULL;
-        }
+    freeThreadPartial();
     m_sort_connection.disconnect();
     m_max_particle_num_change_connection.disconnect();
     }
@@ -358,12 +411,21 @@ class ForceComputeWrap : public ForceCompute, public wrapper<ForceCompute>
 
 void export_ForceCompute()
     {
-    class_< ForceComputeWrap, boost::shared_ptr<ForceComputeWrap>, bases<Compute>, boost::noncopyable >
+    scope in_force = class_< ForceComputeWrap, boost::shared_ptr<ForceComputeWrap>, bases<Compute>, boost::noncopyable >
     ("ForceCompute", init< boost::shared_ptr<SystemDefinition> >())
     .def("getForce", &ForceCompute::getForce)
     .def("getTorque", &ForceCompute::getTorque)
     .def("getVirial", &ForceCompute::getVirial)
     .def("getEnergy", &ForceCompute::getEnergy)
+    .def("setThreadAccumulation", &ForceCompute::setThreadAccumulation)
+    .def("getThreadAccumulation", &ForceCompute::getThreadAccumulation)
+    .def("supportsThreadAccumulation", &ForceCompute::supportsThreadAccumulation)
+    .def("getThreadPartialBytes", &ForceCompute::getThreadPartialBytes)
+    ;
+
+    enum_<ForceCompute::threadAccumulationMode>("threadAccumulationMode")
+    .value("thread_partial", ForceCompute::thread_partial)
+    .value("owner_computes", ForceCompute::owner_computes)
     ;
     }
 
@@ -151,6 +151,49 @@ class ForceCompute : public Compute
             return m_external_virial[dir];
             }
 
+        //! Strategies for combining the forces computed by several CPU threads
+        /*! - \b thread_partial - every thread accumulates into its own N sized partial arrays, which are summed
+              at the end of the compute. Works with half neighbor lists (third law), but zeroes and reduces
+              N x threads elements every step.
+            - \b owner_computes - every thread writes the force, energy and virial of the particles it owns directly
+              to the output arrays. No partial arrays are allocated. Pair forces need a full neighbor list, so every
+              pair is evaluated twice.
+        */
+        enum threadAccumulationMode
+            {
+            thread_partial = 0,
+            owner_computes
+            };
+
+        //! Set the strategy for combining the forces computed by several CPU threads
+        void setThreadAccumulation(threadAccumulationMode mode);
+
+        //! Returns true if computeForces() implements both thread accumulation modes
+        virtual bool supportsThreadAccumulation()
+            {
+            return false;
+            }
+
+        //! Get the strategy for combining the forces computed by several CPU threads
+        threadAccumulationMode getThreadAccumulation()
+            {
+            return m_thread_accumulation;
+            }
+
+        //! Get the number of bytes allocated for the per thread partial arrays
+        size_t getThreadPartialBytes();
+
+#ifdef ENABLE_MPI
+        //! Returns true if computeForces() can start while a ghost update is in flight
+        /*! Such a force compute finishes the ghost update itself (Communicator::finishUpdateGhosts()) before it
+            accesses the ghost particles. All other force computes are computed after the update has completed.
+        */
+        virtual bool overlapsGhostUpdate()
+            {
+            return false;
+            }
+#endif
+
     protected:
         bool m_particles_sorted;    //!< Flag set to true when particles are resorted in memory
  
@@ -173,6 +216,9 @@ class ForceCompute : public Compute
 
         //! Re-allocates the force and virial partial data
         void reallocateThreadPartial();
+
+        //! Frees the force and virial partial data
+        void freeThreadPartial();
         
         Scalar m_deltaT;  //!< timestep size (required for some types of non-conservative forces)
                             
@@ -194,6 +240,8 @@ class ForceCompute : public Compute
         Scalar4* m_torque_partial; //!< Stores partial torque data
 
         Index2D m_index_thread_partial;         //!< Indexer to index the above 2 arrays by (particle, thread)
+        bool m_use_thread_partial;              //!< True if the subclass accumulates into the partial arrays
+        threadAccumulationMode m_thread_accumulation; //!< Strategy for combining the forces of several threads
 
         Scalar m_external_virial[6]; //!< Stores external contribution to virial
 
@@ -68,6 +68,7 @@ using namespace boost::python;
 
 #include <sstream>
 #include <fstream>
+#include <algorithm>
 
 #include <iostream>
 #include <stdexcept>
@@ -89,7 +90,8 @@ using namespace std;
 */
 NeighborList::NeighborList(boost::shared_ptr<SystemDefinition> sysdef, Scalar r_cut, Scalar r_buff)
     : Compute(sysdef), m_r_cut(r_cut), m_r_buff(r_buff), m_d_max(1.0), m_filter_body(false), m_filter_diameter(false),
-      m_storage_mode(half), m_updates(0), m_forced_updates(0), m_dangerous_updates(0),
+      m_filter_rcut_type(false), m_typpair_idx(m_pdata->getNTypes()), m_storage_mode(half), m_n_candidates(0),
+      m_n_accepted(0), m_updates(0), m_forced_updates(0), m_dangerous_updates(0),
       m_force_update(true), m_dist_check(true)
     {
     m_exec_conf->msg->notice(5) << "Constructing Neighborlist" << endl;
@@ -114,6 +116,10 @@ NeighborList::NeighborList(boost::shared_ptr<SystemDefinition> sysdef, Scalar r_
     m_every = 0;
     m_Nmax = 0;
     m_exclusions_set = false;
+#ifdef ENABLE_MPI
+    m_n_interior = 0;
+    m_interior_valid = false;
+#endif
 
  
     // initialize box length at last update
@@ -124,6 +130,15 @@ NeighborList::NeighborList(boost::shared_ptr<SystemDefinition> sysdef, Scalar r_
     GPUFlags<unsigned int> conditions(exec_conf);
     m_conditions.swap(conditions);
 
+    // every type pair starts out at the global r_cut
+    GPUArray<Scalar> r_cut_pair(m_typpair_idx.getNumElements(), exec_conf);
+    m_r_cut_pair.swap(r_cut_pair);
+        {
+        ArrayHandle<Scalar> h_r_cut_pair(m_r_cut_pair, access_location::host, access_mode::overwrite);
+        for (unsigned int i = 0; i < m_typpair_idx.getNumElements(); i++)
+            h_r_cut_pair.data[i] = m_r_cut;
+        }
+
     // allocate m_n_neigh
     GPUArray<unsigned int> n_neigh(m_pdata->getMaxN(), exec_conf);
     m_n_neigh.swap(n_neigh);
@@ -207,6 +222,12 @@ void NeighborList::compute(unsigned int timestep)
     // check if the list needs to be updated and update it
     if (needsUpdating(timestep))
         {
+#ifdef ENABLE_MPI
+        // a forced rebuild needs the current ghost positions
+        if (m_comm)
+            m_comm->finishUpdateGhosts(timestep);
+#endif
+
         // rebuild the list until there is no overflow
         bool overflowed = false;
         do
@@ -226,8 +247,17 @@ void NeighborList::compute(unsigned int timestep)
             filterNlist();
         
         setLastUpdatedPos();
+#ifdef ENABLE_MPI
+        m_interior_valid = false;
+#endif
         }
 
+#ifdef ENABLE_MPI
+    // the pair forces on the interior particles are computed while the ghost update is in flight
+    if (m_comm && m_comm->getOverlap() && !m_interior_valid)
+        buildInteriorBoundaryList();
+#endif
+
     if (m_prof) m_prof->pop();
     }
 
@@ -303,6 +333,57 @@ void NeighborList::setRCut(Scalar r_cut, Scalar r_buff)
     forceUpdate();
     }
 
+/*! \param typ1 First type index in the pair
+    \param typ2 Second type index in the pair
+    \param r_cut Cuttoff radius for neighbors of types \a typ1 and \a typ2
+
+    The per type pair cuttoff is only used when setFilterRcutType() is enabled. It never extends the list beyond the
+    global r_cut set by setRCut().
+*/
+void NeighborList::setRCutPair(unsigned int typ1, unsigned int typ2, Scalar r_cut)
+    {
+    if (typ1 >= m_pdata->getNTypes() || typ2 >= m_pdata->getNTypes())
+        {
+        m_exec_conf->msg->error() << "nlist: Trying to set r_cut for a non existant type! "
+                                  << typ1 << "," << typ2 << endl;
+        throw runtime_error("Error changing NeighborList parameters");
+        }
+
+    if (r_cut < 0.0)
+        {
+        m_exec_conf->msg->error() << "nlist: Requested cuttoff radius is less than zero" << endl;
+        throw runtime_error("Error changing NeighborList parameters");
+        }
+
+    ArrayHandle<Scalar> h_r_cut_pair(m_r_cut_pair, access_location::host, access_mode::readwrite);
+    h_r_cut_pair.data[m_typpair_idx(typ1, typ2)] = r_cut;
+    h_r_cut_pair.data[m_typpair_idx(typ2, typ1)] = r_cut;
+
+    forceUpdate();
+    }
+
+/*! \param r_list Filled out with the neighbor list radius of each type pair, indexed by m_typpair_idx
+
+    r_list is r_cut + r_buff, plus d_max - 1.0 if diameter filtering is not already taking care of it. When per type
+    pair filtering is enabled, the per type pair r_cut (capped at the global r_cut) is used in place of r_cut.
+*/
+void NeighborList::computeRListPair(std::vector<Scalar>& r_list)
+    {
+    r_list.resize(m_typpair_idx.getNumElements());
+
+    ArrayHandle<Scalar> h_r_cut_pair(m_r_cut_pair, access_location::host, access_mode::read);
+    for (unsigned int i = 0; i < m_typpair_idx.getNumElements(); i++)
+        {
+        Scalar r_cut = m_r_cut;
+        if (m_filter_rcut_type && h_r_cut_pair.data[i] < m_r_cut)
+            r_cut = h_r_cut_pair.data[i];
+
+        r_list[i] = r_cut + m_r_buff;
+        if (!m_filter_diameter)
+            r_list[i] += m_d_max - Scalar(1.0);
+        }
+    }
+
 /*! \returns an estimate of the number of neighbors per particle
     This mean-field estimate may be very bad dending on how clustered particles are.
     Derived classes can override this method to provide better estimates.
@@ -1002,11 +1083,19 @@ void NeighborList::printStats()
     m_exec_conf->msg->notice(1) << "n_neigh_min: " << n_neigh_min << " / n_neigh_max: " << n_neigh_max << " / n_neigh_avg: " << n_neigh_avg << endl;
 
     m_exec_conf->msg->notice(1) << "shortest rebuild period: " << getSmallestRebuild() << endl;
+
+    // report how many of the distance checked candidates were actually within r_list
+    if (m_n_candidates > 0)
+        {
+        m_exec_conf->msg->notice(1) << "candidates: " << m_n_candidates << " / accepted: " << m_n_accepted
+                                    << " / accepted ratio: " << double(m_n_accepted) / double(m_n_candidates) << endl;
+        }
     }
 
 void NeighborList::resetStats()
     {
     m_updates = m_forced_updates = m_dangerous_updates = 0;
+    m_n_candidates = m_n_accepted = 0;
 
     for (unsigned int i = 0; i < m_update_periods.size(); i++)
         m_update_periods[i] = 0;
@@ -1054,7 +1143,6 @@ void NeighborList::buildNlist(unsigned int timestep)
     // add d_max - 1.0, if diameter filtering is not already taking care of it
     if (!m_filter_diameter)
         rmax += m_d_max - Scalar(1.0);
-    Scalar rmaxsq = rmax*rmax;
     
     if (L.x <= rmax * 2.0 || L.y <= rmax * 2.0 || L.z <= rmax * 2.0)
         {
@@ -1066,22 +1154,44 @@ void NeighborList::buildNlist(unsigned int timestep)
     ArrayHandle<unsigned int> h_n_neigh(m_n_neigh, access_location::host, access_mode::overwrite);
     ArrayHandle<unsigned int> h_nlist(m_nlist, access_location::host, access_mode::overwrite);
 
+    // per type pair neighbor list radii
+    std::vector<Scalar> r_list;
+    computeRListPair(r_list);
+
     unsigned int conditions = 0;
 
-    // start by clearing the entire list
-    memset(h_n_neigh.data, 0, sizeof(unsigned int)*m_pdata->getN());
-    
+    unsigned int nparticles = m_pdata->getN();
+    unsigned int ntotal = m_pdata->getN() + m_pdata->getNGhosts();
+
     // now we can loop over all particles in n^2 fashion and build the list
-#pragma omp parallel for schedule(dynamic, 100)
-    for (int i = 0; i < (int)m_pdata->getN(); i++)
+    // Every thread only writes to the rows of the particles i it owns, so no synchronization is needed inside the loop.
+    // In full storage mode this means that each pair is checked twice (once from each side) instead of writing the
+    // reverse entry into the row of j.
+    int64_t n_candidates = 0;
+    int64_t n_accepted = 0;
+
+#pragma omp parallel
+    {
+    unsigned int thread_conditions = 0;
+    int64_t thread_candidates = 0;
+    int64_t thread_accepted = 0;
+
+#pragma omp for schedule(dynamic, 100)
+    for (int i = 0; i < (int)nparticles; i++)
         {
         Scalar3 pi = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
+        unsigned int typei = __scalar_as_int(h_pos.data[i].w);
         Scalar di = h_diameter.data[i];
         unsigned int bodyi = h_body.data[i];
+        unsigned int cur_n_neigh = 0;
         
-        // for each other particle with i < j, including ghost particles
-        for (unsigned int j = i + 1; j < m_pdata->getN() + m_pdata->getNGhosts(); j++)
+        // for each other particle (with i < j in half storage mode), including ghost particles
+        unsigned int jstart = (m_storage_mode == full) ? 0 : i + 1;
+        for (unsigned int j = jstart; j < ntotal; j++)
             {
+            if (j == (unsigned int)i)
+                continue;
+
             // calculate dr
             Scalar3 pj = make_scalar3(h_pos.data[j].x, h_pos.data[j].y, h_pos.data[j].z);
             Scalar3 dx = pj - pi;
@@ -1092,6 +1202,10 @@ void NeighborList::buildNlist(unsigned int timestep)
             if (m_filter_body && bodyi != NO_BODY)
                 excluded = (bodyi == h_body.data[j]);
 
+            Scalar rlist = rmax;
+            if (m_filter_rcut_type)
+                rlist = r_list[m_typpair_idx(typei, __scalar_as_int(h_pos.data[j].w))];
+
             Scalar sqshift = Scalar(0.0);
             if (m_filter_diameter)
                 {
@@ -1099,48 +1213,38 @@ void NeighborList::buildNlist(unsigned int timestep)
                 float delta = (di + h_diameter.data[j]) * Scalar(0.5) - Scalar(1.0);
                 // r^2 < (r_max + delta)^2
                 // r^2 < r_maxsq + delta^2 + 2*r_max*delta
-                sqshift = (delta + Scalar(2.0) * rmax) * delta;
+                sqshift = (delta + Scalar(2.0) * rlist) * delta;
                 }
 
-            // now compare rsq to rmaxsq and add to the list if it meets the criteria
+            // now compare rsq to rlist^2 and add to the list if it meets the criteria
             Scalar rsq = dot(dx, dx);
-            if (rsq <= (rmaxsq + sqshift) && !excluded)
+            thread_candidates++;
+            if (rsq <= (rlist*rlist + sqshift) && !excluded)
                 {
-                if (m_storage_mode == full)
-                    {
-                    #pragma omp critical
-                        {
-                        unsigned int posi = h_n_neigh.data[i];
-                        if (posi < m_Nmax)
-                            h_nlist.data[m_nlist_indexer(i, posi)] = j;
-                        else
-                            conditions = max(conditions, h_n_neigh.data[i]+1);
-                        
-                        h_n_neigh.data[i]++;
-                       
-                        unsigned int posj = h_n_neigh.data[j];
-                        if (posj < m_Nmax)
-                            h_nlist.data[m_nlist_indexer(j, posj)] = i;
-                        else
-                            conditions = max(conditions, h_n_neigh.data[j]+1);
-
-                        h_n_neigh.data[j]++;
-                        }
-                    }
+                thread_accepted++;
+                if (cur_n_neigh < m_Nmax)
+                    h_nlist.data[m_nlist_indexer(i, cur_n_neigh)] = j;
                 else
-                    {
-                    unsigned int pos = h_n_neigh.data[i];
-                    
-                    if (pos < m_Nmax)
-                        h_nlist.data[m_nlist_indexer(i, pos)] = j;
-                    else
-                        conditions = max(conditions, h_n_neigh.data[i]+1);
-                    
-                    h_n_neigh.data[i]++;
-                    }
+                    thread_conditions = max(thread_conditions, cur_n_neigh+1);
+                
+                cur_n_neigh++;
                 }
             }
+
+        h_n_neigh.data[i] = cur_n_neigh;
         }
+
+    // combine the overflow conditions and statistics of all threads
+    #pragma omp critical
+        {
+        conditions = max(conditions, thread_conditions);
+        n_candidates += thread_candidates;
+        n_accepted += thread_accepted;
+        }
+    } // end omp parallel
+
+    m_n_candidates += n_candidates;
+    m_n_accepted += n_accepted;
    
     // write out conditions
     m_conditions.resetFlags(conditions);
@@ -1309,9 +1413,11 @@ void NeighborList::setCommunicator(boost::shared_ptr<Communicator> comm)
         comm->addMigrateRequest(bind(&NeighborList::peekUpdate, this, _1));
         }
 
+    // subscribe to the ghost field requests
+    Compute::setCommunicator(comm);
+
     if (comm)
         {
-        m_comm = comm;
 
         Scalar rmax = m_r_cut + m_r_buff;
         // add d_max - 1.0 all the time - this is needed so that all interacting slj particles are communicated
@@ -1321,6 +1427,50 @@ void NeighborList::setCommunicator(boost::shared_ptr<Communicator> comm)
         }
     }
 
+/*! Interior particles have only local particles as neighbors, their forces can be computed before the ghost
+    positions are current. The interior and the boundary particles are each stored in ascending order.
+*/
+void NeighborList::buildInteriorBoundaryList()
+    {
+    if (m_prof) m_prof->push("interior");
+
+    unsigned int N = m_pdata->getN();
+    if (m_interior_boundary.getNumElements() < N)
+        {
+        GPUArray<unsigned int> interior_boundary(m_pdata->getMaxN(), exec_conf);
+        m_interior_boundary.swap(interior_boundary);
+        }
+
+    ArrayHandle<unsigned int> h_n_neigh(m_n_neigh, access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_nlist(m_nlist, access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_interior_boundary(m_interior_boundary, access_location::host, access_mode::overwrite);
+
+    // interior particles are written from the front, boundary particles from the back
+    unsigned int n_interior = 0;
+    unsigned int n_boundary = 0;
+    for (unsigned int i = 0; i < N; i++)
+        {
+        bool boundary = false;
+        for (unsigned int k = 0; k < h_n_neigh.data[i]; k++)
+            if (h_nlist.data[m_nlist_indexer(i, k)] >= N)
+                {
+                boundary = true;
+                break;
+                }
+
+        if (boundary)
+            h_interior_boundary.data[N - 1 - n_boundary++] = i;
+        else
+            h_interior_boundary.data[n_interior++] = i;
+        }
+    std::reverse(h_interior_boundary.data + n_interior, h_interior_boundary.data + N);
+
+    m_n_interior = n_interior;
+    m_interior_valid = true;
+
+    if (m_prof) m_prof->pop();
+    }
+
 //! Returns true if the particle migration criterium is fulfilled
 /*! \note The criterium for when to request particle migration is the same as the one for neighbor list
     rebuilds, which is implemented in needsUpdating().
@@ -1349,6 +1499,7 @@ void export_NeighborList()
                      .def("setRCut", &NeighborList::setRCut)
                      .def("setEvery", &NeighborList::setEvery)
                      .def("setStorageMode", &NeighborList::setStorageMode)
+                     .def("getStorageMode", &NeighborList::getStorageMode)
                      .def("addExclusion", &NeighborList::addExclusion)
                      .def("clearExclusions", &NeighborList::clearExclusions)
                      .def("countExclusions", &NeighborList::countExclusions)
@@ -1359,6 +1510,9 @@ void export_NeighborList()
                      .def("addOneFourExclusionsFromTopology", &NeighborList::addOneFourExclusionsFromTopology)
                      .def("setFilterBody", &NeighborList::setFilterBody)
                      .def("getFilterBody", &NeighborList::getFilterBody)
+                     .def("setRCutPair", &NeighborList::setRCutPair)
+                     .def("setFilterRcutType", &NeighborList::setFilterRcutType)
+                     .def("getFilterRcutType", &NeighborList::getFilterRcutType)
                      .def("setFilterDiameter", &NeighborList::setFilterDiameter)
                      .def("getFilterDiameter", &NeighborList::getFilterDiameter)
                      .def("setMaximumDiameter", &NeighborList::setMaximumDiameter)
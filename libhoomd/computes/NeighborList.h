@@ -111,6 +111,16 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
      - setFilterBody() prevents two particles of the same body from being neighbors
      - setFilterRcutType() enables individual r_cut values for each pair of particle types
      - setFilterDiameter() enables slj type diameter filtering (TODO: need to specify exactly what this does)
+
+    \b Per type pair cutoffs:
+
+    setRCutPair() sets the cutoff for a single pair of particle types. The global r_cut passed to setRCut() is the
+    maximum over all type pairs and determines the cell and ghost layer widths. When setFilterRcutType() is enabled, a
+    pair of particles of types \a a and \a b is only added to the list when it is within
+    <code>min(r_cut(a,b), r_cut) + r_buff</code> (plus the diameter shift, if any). This keeps short ranged type pairs
+    out of lists dominated by one long ranged pair. Type pairs that have never been set default to the global r_cut.
+    The GPU neighbor lists currently ignore the per type pair cutoffs and store all neighbors within the global r_cut,
+    which is always a valid superset.
     
     \b Algorithms:
 
@@ -173,6 +183,9 @@ class NeighborList : public Compute
         
         //! Change the cuttoff radius
         virtual void setRCut(Scalar r_cut, Scalar r_buff);
+
+        //! Change the cuttoff radius for a single pair of particle types
+        virtual void setRCutPair(unsigned int typ1, unsigned int typ2, Scalar r_cut);
         
         //! Change how many timesteps before checking to see if the list should be rebuilt
         /*! \param every Number of time steps to wait before beignning to check if particles have moved a sufficient distance
@@ -274,6 +287,14 @@ class NeighborList : public Compute
         virtual Scalar estimateNNeigh();
 
 #ifdef ENABLE_MPI
+        //! Returns the width of the buffer layer
+        /*! Particles migrate before any of them has moved further than half this distance from its domain
+        */
+        Scalar getRBuff()
+            {
+            return m_r_buff;
+            }
+
         //! Returns the width of the ghost layer in every spatial direction
         Scalar getRGhost()
             {
@@ -351,6 +372,19 @@ class NeighborList : public Compute
             return m_filter_diameter;
             }
         
+        //! Enable/disable per type pair r_cut filtering
+        virtual void setFilterRcutType(bool filter_rcut_type)
+            {
+            m_filter_rcut_type = filter_rcut_type;
+            forceUpdate();
+            }
+
+        //! Test if per type pair r_cut filtering is set
+        virtual bool getFilterRcutType()
+            {
+            return m_filter_rcut_type;
+            }
+
         //! Set the maximum diameter to use in computing neighbor lists
         virtual void setMaximumDiameter(Scalar d_max)
             {
@@ -396,10 +430,37 @@ class NeighborList : public Compute
          */
         virtual void setCommunicator(boost::shared_ptr<Communicator> comm);
 
+        //! Request ghost diameters when diameter filtering is enabled
+        /*! \param timestep Current time step
+        */
+        virtual CommFlags getRequestedCommFlags(unsigned int timestep)
+            {
+            CommFlags flags(0);
+            if (m_filter_diameter)
+                flags[comm_flag::diameter] = 1;
+            return flags;
+            }
+
         //! Returns true if the particle migration criterium is fulfilled
         /*! \param timestep The current timestep
          */
         bool peekUpdate(unsigned int timestep);
+
+        //! Get the local particle indices sorted into interior and boundary particles
+        /*! The first getNInterior() entries are the particles without ghost neighbors, the remaining entries are the
+            particles with at least one ghost neighbor. The list is only built if the Communicator overlaps the ghost
+            update with the force computation.
+        */
+        const GPUArray<unsigned int>& getInteriorBoundaryList()
+            {
+            return m_interior_boundary;
+            }
+
+        //! Get the number of interior particles in getInteriorBoundaryList()
+        unsigned int getNInterior()
+            {
+            return m_n_interior;
+            }
 #endif
 
     protected:
@@ -408,6 +469,9 @@ class NeighborList : public Compute
         Scalar m_d_max;             //!< The maximum diameter of any particle in the system (or greater)
         bool m_filter_body;         //!< Set to true if particles in the same body are to be filtered
         bool m_filter_diameter;     //!< Set to true if particles are to be filtered by diameter (slj style)
+        bool m_filter_rcut_type;    //!< Set to true if neighbors are to be filtered by their per type pair r_cut
+        Index2D m_typpair_idx;      //!< Indexer for the per type pair arrays
+        GPUArray<Scalar> m_r_cut_pair; //!< Cuttoff radius per type pair
         storageMode m_storage_mode; //!< The storage mode
         
         Index2D m_nlist_indexer;             //!< Indexer for accessing the neighbor list
@@ -417,6 +481,8 @@ class NeighborList : public Compute
         Scalar3 m_last_L;                    //!< Box lengths at last update
         Scalar3 m_last_L_local;              //!< Local Box lengths at last update
         unsigned int m_Nmax;                 //!< Maximum number of neighbors that can be held in m_nlist
+        int64_t m_n_candidates;              //!< Number of candidate pairs distance checked by buildNlist()
+        int64_t m_n_accepted;                //!< Number of candidate pairs found within r_list by buildNlist()
         GPUFlags<unsigned int> m_conditions; //!< Condition flags set during the buildNlist() call
         
         GPUArray<unsigned int> m_ex_list_tag;  //!< List of excluded particles referenced by tag
@@ -431,8 +497,17 @@ class NeighborList : public Compute
         boost::signals::connection m_max_particle_num_change_connection; //!< Connection to max particle number change signal
 #ifdef ENABLE_MPI
         boost::signals::connection m_migrate_request_connection; //!< Connection to trigger particle migration
+        GPUArray<unsigned int> m_interior_boundary; //!< Local particle indices, interior particles first
+        unsigned int m_n_interior;                  //!< Number of interior particles
+        bool m_interior_valid;                      //!< True if m_interior_boundary matches the current list
+
+        //! Sorts the local particles into interior and boundary particles
+        void buildInteriorBoundaryList();
 #endif
 
+        //! Compute the neighbor list radius r_list for every type pair
+        void computeRListPair(std::vector<Scalar>& r_list);
+
         //! Performs the distance check
         virtual bool distanceCheck();
         
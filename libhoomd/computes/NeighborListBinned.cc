@@ -67,7 +67,7 @@ NeighborListBinned::NeighborListBinned(boost::shared_ptr<SystemDefinition> sysde
                                        Scalar r_cut,
                                        Scalar r_buff,
                                        boost::shared_ptr<CellList> cl)
-    : NeighborList(sysdef, r_cut, r_buff), m_cl(cl)
+    : NeighborList(sysdef, r_cut, r_buff), m_cl(cl), m_cell_subdivision(1)
     {
     m_exec_conf->msg->notice(5) << "Constructing NeighborListBinned" << endl;
 
@@ -75,7 +75,7 @@ NeighborListBinned::NeighborListBinned(boost::shared_ptr<SystemDefinition> sysde
     if (!m_cl)
         m_cl = boost::shared_ptr<CellList>(new CellList(sysdef));
     
-    m_cl->setNominalWidth(r_cut + r_buff + m_d_max - Scalar(1.0));
+    updateCellWidth();
     m_cl->setRadius(1);
     m_cl->setComputeTDB(false);
     m_cl->setFlagIndex();
@@ -91,7 +91,7 @@ void NeighborListBinned::setRCut(Scalar r_cut, Scalar r_buff)
     {
     NeighborList::setRCut(r_cut, r_buff);
     
-    m_cl->setNominalWidth(r_cut + r_buff + m_d_max - Scalar(1.0));
+    updateCellWidth();
     }
 
 void NeighborListBinned::setMaximumDiameter(Scalar d_max)
@@ -99,18 +99,114 @@ void NeighborListBinned::setMaximumDiameter(Scalar d_max)
     NeighborList::setMaximumDiameter(d_max);
     
     // need to update the cell list settings appropriately
-    m_cl->setNominalWidth(m_r_cut + m_r_buff + m_d_max - Scalar(1.0));
+    updateCellWidth();
+    }
+
+/*! \param subdivision Number of cells per r_list (1, 2, 3, ...)
+
+    The cell width is set to r_list/\a subdivision and the stencils search out to \a subdivision cells in every
+    direction. Only the cells that overlap the r_list sphere are included in the stencils. The cell list keeps
+    \a subdivision ghost cells on every non-periodic side, so that all ghost particles within r_list of the domain
+    are binned.
+*/
+void NeighborListBinned::setCellSubdivision(unsigned int subdivision)
+    {
+    if (subdivision == 0)
+        {
+        m_exec_conf->msg->error() << "nlist: Cell subdivision must be at least 1" << endl;
+        throw runtime_error("Error changing NeighborListBinned parameters");
+        }
+
+    m_cell_subdivision = subdivision;
+    m_cl->setGhostLayers(subdivision);
+    updateCellWidth();
+    forceUpdate();
+    }
+
+void NeighborListBinned::updateCellWidth()
+    {
+    m_cl->setNominalWidth((m_r_cut + m_r_buff + m_d_max - Scalar(1.0)) / Scalar(m_cell_subdivision));
+    }
+
+/*! \param r_list Neighbor list radius of every type pair, as computed by computeRListPair()
+
+    A cell offset is included in the stencil of a type when the minimum distance between the home cell and the offset
+    cell is no larger than the largest r_list of any type pair involving that type, plus the largest diameter shift
+    when diameter filtering is enabled. In triclinic boxes only the distance along each axis is used, which is
+    conservative.
+*/
+void NeighborListBinned::computeStencils(const std::vector<Scalar>& r_list)
+    {
+    const BoxDim& box = m_pdata->getBox();
+    uint3 dim = m_cl->getDim();
+    uint3 n_ghost = m_cl->getNGhostCells();
+
+    // cell widths (perpendicular to the cell faces)
+    Scalar3 L = box.getNearestPlaneDistance();
+    Scalar3 w = make_scalar3(L.x / Scalar(dim.x - n_ghost.x),
+                             L.y / Scalar(dim.y - n_ghost.y),
+                             L.z / Scalar(dim.z - n_ghost.z));
+
+    bool orthorhombic = (box.getTiltFactorXY() == Scalar(0.0) &&
+                         box.getTiltFactorXZ() == Scalar(0.0) &&
+                         box.getTiltFactorYZ() == Scalar(0.0));
+
+    int r = int(m_cell_subdivision);
+    int rk = r;
+    if (m_sysdef->getNDimensions() == 2)
+        rk = 0;
+
+    unsigned int ntypes = m_pdata->getNTypes();
+    m_stencil.resize(ntypes);
+
+    for (unsigned int cur_type = 0; cur_type < ntypes; cur_type++)
+        {
+        // largest r_list of any type pair involving this type
+        Scalar r_list_max = Scalar(0.0);
+        for (unsigned int other_type = 0; other_type < ntypes; other_type++)
+            r_list_max = max(r_list_max, r_list[m_typpair_idx(cur_type, other_type)]);
+
+        // pairs of large particles are accepted out to r_list + d_max - 1 by the diameter filter
+        if (m_filter_diameter)
+            r_list_max += m_d_max - Scalar(1.0);
+
+        m_stencil[cur_type].clear();
+        for (int k = -rk; k <= rk; k++)
+            for (int j = -r; j <= r; j++)
+                for (int i = -r; i <= r; i++)
+                    {
+                    // minimum distance between the home cell and the offset cell along each axis
+                    Scalar3 d = make_scalar3(Scalar(max(abs(i)-1, 0)) * w.x,
+                                             Scalar(max(abs(j)-1, 0)) * w.y,
+                                             Scalar(max(abs(k)-1, 0)) * w.z);
+
+                    Scalar dsq;
+                    if (orthorhombic)
+                        dsq = dot(d,d);
+                    else
+                        {
+                        Scalar dmax = max(d.x, max(d.y, d.z));
+                        dsq = dmax*dmax;
+                        }
+
+                    if (dsq <= r_list_max*r_list_max)
+                        m_stencil[cur_type].push_back(make_int3(i,j,k));
+                    }
+        }
     }
 
 void NeighborListBinned::buildNlist(unsigned int timestep)
     {
     m_cl->compute(timestep);
     
-    // check that at least 3x3x3 cells are computed
+    // check that the stencil does not wrap around onto itself: at least 3x3x3 cells are needed with the default
+    // subdivision, (2n+1)^3 in general
     uint3 dim = m_cl->getDim();
-    if (dim.x < 3 || dim.y < 3 || (m_sysdef->getNDimensions() != 2 && dim.z < 3))
+    unsigned int min_dim = 2*m_cell_subdivision + 1;
+    if (dim.x < min_dim || dim.y < min_dim || (m_sysdef->getNDimensions() != 2 && dim.z < min_dim))
         {
-        m_exec_conf->msg->error() << "nlist: O(N) neighbor list doesn't work on boxes where r_cut+r_buff is greater than 1/3 any box dimension" << endl;
+        m_exec_conf->msg->error() << "nlist: O(N) neighbor list doesn't work on boxes where r_cut+r_buff is greater than "
+                                  << m_cell_subdivision << "/" << min_dim << " of any box dimension" << endl;
         throw runtime_error("Error computing neighbor list");
         }
 
@@ -132,12 +228,15 @@ void NeighborListBinned::buildNlist(unsigned int timestep)
     // add d_max - 1.0, if diameter filtering is not already taking care of it
     if (!m_filter_diameter)
         rmax += m_d_max - Scalar(1.0);
-    Scalar rmaxsq = rmax*rmax;
     
+    // per type pair neighbor list radii and the cell stencils that go with them
+    std::vector<Scalar> r_list;
+    computeRListPair(r_list);
+    computeStencils(r_list);
+
     // access the cell list data arrays
     ArrayHandle<unsigned int> h_cell_size(m_cl->getCellSizeArray(), access_location::host, access_mode::read);
     ArrayHandle<Scalar4> h_cell_xyzf(m_cl->getXYZFArray(), access_location::host, access_mode::read);
-    ArrayHandle<unsigned int> h_cell_adj(m_cl->getCellAdjArray(), access_location::host, access_mode::read);
 
     ArrayHandle<unsigned int> h_nlist(m_nlist, access_location::host, access_mode::overwrite);
     ArrayHandle<unsigned int> h_n_neigh(m_n_neigh, access_location::host, access_mode::overwrite);
@@ -147,19 +246,23 @@ void NeighborListBinned::buildNlist(unsigned int timestep)
     // access indexers
     Index3D ci = m_cl->getCellIndexer();
     Index2D cli = m_cl->getCellListIndexer();
-    Index2D cadji = m_cl->getCellAdjIndexer();
 
     // get periodic flags
     uchar3 periodic = box.getPeriodic();
 
+    // statistics on the number of candidates checked
+    int64_t n_candidates = 0;
+    int64_t n_accepted = 0;
+
     // for each local particle
     unsigned int nparticles = m_pdata->getN();
-#pragma omp parallel for schedule(dynamic, 100)
+#pragma omp parallel for schedule(dynamic, 100) reduction(+:n_candidates,n_accepted)
     for (int i = 0; i < (int)nparticles; i++)
         {
         unsigned int cur_n_neigh = 0;
         
         Scalar3 my_pos = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
+        unsigned int typei = __scalar_as_int(h_pos.data[i].w);
         unsigned int bodyi = h_body.data[i];
         Scalar di = h_diameter.data[i];
         
@@ -177,13 +280,21 @@ void NeighborListBinned::buildNlist(unsigned int timestep)
         if (kb == (int)dim.z && periodic.z)
             kb = 0;
             
-        // identify the bin
-        unsigned int my_cell = ci(ib,jb,kb);
-        
-        // loop through all neighboring bins
-        for (unsigned int cur_adj = 0; cur_adj < cadji.getW(); cur_adj++)
+        // loop through all neighboring bins in the stencil of this particle's type
+        const std::vector<int3>& stencil = m_stencil[typei];
+        for (unsigned int cur_adj = 0; cur_adj < stencil.size(); cur_adj++)
             {
-            unsigned int neigh_cell = h_cell_adj.data[cadji(cur_adj, my_cell)];
+            int ni = (ib + stencil[cur_adj].x) % int(dim.x);
+            if (ni < 0)
+                ni += dim.x;
+            int nj = (jb + stencil[cur_adj].y) % int(dim.y);
+            if (nj < 0)
+                nj += dim.y;
+            int nk = (kb + stencil[cur_adj].z) % int(dim.z);
+            if (nk < 0)
+                nk += dim.z;
+
+            unsigned int neigh_cell = ci(ni, nj, nk);
                 
             // check against all the particles in that neighboring bin to see if it is a neighbor
             unsigned int size = h_cell_size.data[neigh_cell];
@@ -203,6 +314,10 @@ void NeighborListBinned::buildNlist(unsigned int timestep)
                 if (m_filter_body && bodyi != NO_BODY)
                     excluded = excluded | (bodyi == h_body.data[cur_neigh]);
                 
+                Scalar rlist = rmax;
+                if (m_filter_rcut_type)
+                    rlist = r_list[m_typpair_idx(typei, __scalar_as_int(h_pos.data[cur_neigh].w))];
+
                 Scalar sqshift = Scalar(0.0);
                 if (m_filter_diameter)
                     {
@@ -210,13 +325,15 @@ void NeighborListBinned::buildNlist(unsigned int timestep)
                     float delta = (di + h_diameter.data[cur_neigh]) * Scalar(0.5) - Scalar(1.0);
                     // r^2 < (r_max + delta)^2
                     // r^2 < r_maxsq + delta^2 + 2*r_max*delta
-                    sqshift = (delta + Scalar(2.0) * rmax) * delta;
+                    sqshift = (delta + Scalar(2.0) * rlist) * delta;
                     }
 
                 Scalar dr_sq = dot(dx,dx);
+                n_candidates++;
                 
-                if (dr_sq <= (rmaxsq + sqshift) && !excluded)
+                if (dr_sq <= (rlist*rlist + sqshift) && !excluded)
                     {
+                    n_accepted++;
                     if (m_storage_mode == full || i < (int)cur_neigh)
                         {
                         // local neighbor
@@ -233,6 +350,9 @@ void NeighborListBinned::buildNlist(unsigned int timestep)
         
         h_n_neigh.data[i] = cur_n_neigh;
         }
+
+    m_n_candidates += n_candidates;
+    m_n_accepted += n_accepted;
    
     // write out conditions
     m_conditions.resetFlags(conditions);
@@ -245,6 +365,8 @@ void export_NeighborListBinned()
     {
     class_<NeighborListBinned, boost::shared_ptr<NeighborListBinned>, bases<NeighborList>, boost::noncopyable >
                      ("NeighborListBinned", init< boost::shared_ptr<SystemDefinition>, Scalar, Scalar, boost::shared_ptr<CellList> >())
+                     .def("setCellSubdivision", &NeighborListBinned::setCellSubdivision)
+                     .def("getCellSubdivision", &NeighborListBinned::getCellSubdivision)
                      ;
     }
 
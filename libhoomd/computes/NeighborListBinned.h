@@ -66,6 +66,17 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 //! Efficient neighbor list build on the CPU
 /*! Implements the O(N) neighbor list build on the CPU using a cell list.
+
+    Instead of the fixed cell adjacency list, each particle walks a cell stencil that depends on its type. The stencil
+    for a type lists the cell offsets that may hold particles within the largest r_list of any type pair involving
+    that type. With per type pair cutoffs (see NeighborList::setFilterRcutType()), particles of short ranged types
+    therefore skip cells that can only hold particles beyond their own cutoff, and every candidate is accepted only
+    within the r_list of its type pair.
+
+    By default, cells are r_list wide and the stencil covers the 27 neighboring cells. setCellSubdivision() makes the
+    cells r_list/n wide and searches out to n cells in every direction instead. The stencil then approximates the
+    r_list sphere much more closely and fewer candidates outside of r_list are checked, at the cost of walking more,
+    smaller cells. The candidate/accepted statistics printed by printStats() help pick the best setting.
     
     \ingroup computes
 */
@@ -87,8 +98,25 @@ class NeighborListBinned : public NeighborList
         //! Set the maximum diameter to use in computing neighbor lists
         virtual void setMaximumDiameter(Scalar d_max);
 
+        //! Set the number of cells per r_list
+        void setCellSubdivision(unsigned int subdivision);
+
+        //! Get the number of cells per r_list
+        unsigned int getCellSubdivision()
+            {
+            return m_cell_subdivision;
+            }
+
     protected:
         boost::shared_ptr<CellList> m_cl;   //!< The cell list
+        unsigned int m_cell_subdivision;    //!< Number of cells per r_list (cell width is r_list/m_cell_subdivision)
+        std::vector< std::vector<int3> > m_stencil; //!< Cell offsets to search for each particle type
+
+        //! Update the cell list width to match the current r_list and subdivision
+        void updateCellWidth();
+
+        //! Compute the cell stencil of every particle type
+        void computeStencils(const std::vector<Scalar>& r_list);
 
         //! Builds the neighbor list
         virtual void buildNlist(unsigned int timestep);
@@ -65,6 +65,14 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdexcept>
 #include <math.h>
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
+#ifdef ENABLE_MPI
+#include "HOOMDMPI.h"
+#endif
+
 using namespace boost;
 using namespace boost::python;
 using namespace std;
@@ -95,6 +103,24 @@ PPPMForceCompute::PPPMForceCompute(boost::shared_ptr<SystemDefinition> sysdef,
     assert(m_pdata);
     assert(m_nlist);
 
+    for (unsigned int d = 0; d < 3; d++)
+        {
+        fft_forward[d] = NULL;
+        fft_inverse[d] = NULL;
+        }
+
+    m_mesh_dim = make_int3(0, 0, 0);
+    m_mesh_offset = make_int3(0, 0, 0);
+    m_n_ghost = make_int3(0, 0, 0);
+    m_k_y0 = 0;
+    m_k_ny = 0;
+#ifdef ENABLE_MPI
+    m_distributed = false;
+    m_requires_uniform = false;
+    m_n_ranks = 1;
+    m_rank = 0;
+#endif
+
     m_box_changed = false;
     m_boxchange_connection = m_pdata->connectBoxChange(bind(&PPPMForceCompute::slotBoxChanged, this));
     }
@@ -103,6 +129,48 @@ PPPMForceCompute::~PPPMForceCompute()
     {
     m_exec_conf->msg->notice(5) << "Destroying PPPMForceCompute" << endl;
 
+    freeFFT();
+
+    m_boxchange_connection.disconnect();
+
+#ifdef ENABLE_MPI
+    if (m_requires_uniform)
+        m_decomposition->releaseUniform();
+#endif
+    }
+
+/*! The plans and buffers depend only on the mesh dimensions. They are allocated on the first CPU force computation
+    after setParams() and reused on every following step.
+*/
+void PPPMForceCompute::allocateFFT()
+    {
+    freeFFT();
+
+    // with a distributed mesh, each rank transforms one slab of the k-space mesh
+    unsigned int n_grid = m_Nx*m_k_ny*m_Nz;
+    fft_in = (kiss_fft_cpx *)malloc(n_grid*sizeof(kiss_fft_cpx));
+    fft_ex = (kiss_fft_cpx *)malloc(n_grid*sizeof(kiss_fft_cpx));
+    fft_ey = (kiss_fft_cpx *)malloc(n_grid*sizeof(kiss_fft_cpx));
+    fft_ez = (kiss_fft_cpx *)malloc(n_grid*sizeof(kiss_fft_cpx));
+
+    int dim[3] = {m_Nx, m_Ny, m_Nz};
+    for (unsigned int d = 0; d < 3; d++)
+        {
+        fft_forward[d] = kiss_fft_alloc(dim[d], 0, NULL, NULL);
+        fft_inverse[d] = kiss_fft_alloc(dim[d], 1, NULL, NULL);
+        }
+
+    // one scratch line per thread
+    unsigned int n_threads = 1;
+#ifdef ENABLE_OPENMP
+    n_threads = omp_get_max_threads();
+#endif
+    int max_dim = MAX(m_Nx, MAX(m_Ny, m_Nz));
+    m_fft_line.resize(n_threads*max_dim);
+    }
+
+void PPPMForceCompute::freeFFT()
+    {
     if (fft_in)
         free(fft_in);
     if (fft_ex)
@@ -111,8 +179,244 @@ PPPMForceCompute::~PPPMForceCompute()
         free(fft_ey);
     if (fft_ez)
         free(fft_ez);
+    fft_in = fft_ex = fft_ey = fft_ez = NULL;
 
-    m_boxchange_connection.disconnect();
+    for (unsigned int d = 0; d < 3; d++)
+        {
+        if (fft_forward[d])
+            kiss_fft_free(fft_forward[d]);
+        if (fft_inverse[d])
+            kiss_fft_free(fft_inverse[d]);
+        fft_forward[d] = NULL;
+        fft_inverse[d] = NULL;
+        }
+    }
+
+/*! \returns The number of ghost cells needed on each side of the local mesh
+
+    Without a domain decomposition, or along directions that are not decomposed, the mesh is periodic and needs no
+    ghost cells. Otherwise they have to cover the interpolation stencil of a particle that has moved up to half the
+    neighbor list buffer out of its domain before it migrates.
+*/
+int3 PPPMForceCompute::computeGhostWidth()
+    {
+    int3 n_ghost = make_int3(0, 0, 0);
+#ifdef ENABLE_MPI
+    boost::shared_ptr<DomainDecomposition> decomposition = m_pdata->getDomainDecomposition();
+    if (decomposition)
+        {
+        const Index3D& di = decomposition->getDomainIndexer();
+        Scalar3 npd = m_pdata->getGlobalBox().getNearestPlaneDistance();
+        Scalar drift = Scalar(0.5)*m_nlist->getRBuff();
+        int stencil = m_order/2 + 1;
+        if (di.getW() > 1)
+            n_ghost.x = stencil + (int)ceil(drift*Scalar(m_Nx)/npd.x);
+        if (di.getH() > 1)
+            n_ghost.y = stencil + (int)ceil(drift*Scalar(m_Ny)/npd.y);
+        if (di.getD() > 1)
+            n_ghost.z = stencil + (int)ceil(drift*Scalar(m_Nz)/npd.z);
+        }
+#endif
+    return n_ghost;
+    }
+
+/*! Sets up the local real space mesh (the whole mesh, or the brick of this rank with ghost cells if the mesh is
+    distributed), the local slab of the k-space mesh and the communication pattern, and allocates the real space
+    arrays.
+*/
+void PPPMForceCompute::setupMesh()
+    {
+    m_n_ghost = computeGhostWidth();
+    m_mesh_dim = make_int3(m_Nx, m_Ny, m_Nz);
+    m_mesh_offset = make_int3(0, 0, 0);
+    m_k_y0 = 0;
+    m_k_ny = m_Ny;
+
+#ifdef ENABLE_MPI
+    m_decomposition = m_pdata->getDomainDecomposition();
+    m_distributed = bool(m_decomposition);
+    if (m_distributed)
+        {
+        MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
+        int rank, size;
+        MPI_Comm_rank(mpi_comm, &rank);
+        MPI_Comm_size(mpi_comm, &size);
+        m_rank = rank;
+        m_n_ranks = size;
+
+        // the mesh bricks are fixed, so they only match equally sized domains. This fails right away if
+        // update.balance is in use, and keeps it from moving the boundaries later.
+        if (! m_requires_uniform)
+            {
+            m_decomposition->requireUniform("charge.pppm");
+            m_requires_uniform = true;
+            }
+
+        const Index3D& di = m_decomposition->getDomainIndexer();
+        if (m_Nx % m_n_ranks || m_Ny % m_n_ranks)
+            {
+            m_exec_conf->msg->error() << "charge.pppm: Nx and Ny must be multiples of the number of ranks ("
+                                      << m_n_ranks << ")" << endl;
+            throw std::runtime_error("Error initializing PPPMForceCompute");
+            }
+        if (m_Nx % di.getW() || m_Ny % di.getH() || m_Nz % di.getD())
+            {
+            m_exec_conf->msg->error() << "charge.pppm: the mesh (" << m_Nx << "," << m_Ny << "," << m_Nz
+                                      << ") cannot be divided evenly over the domain decomposition ("
+                                      << di.getW() << "," << di.getH() << "," << di.getD() << ")" << endl;
+            throw std::runtime_error("Error initializing PPPMForceCompute");
+            }
+
+        m_n_inner = make_int3(m_Nx/di.getW(), m_Ny/di.getH(), m_Nz/di.getD());
+        if (m_n_ghost.x > m_n_inner.x || m_n_ghost.y > m_n_inner.y || m_n_ghost.z > m_n_inner.z)
+            {
+            m_exec_conf->msg->error() << "charge.pppm: the local mesh is thinner than the interpolation stencil, "
+                                      << "use a finer mesh or fewer ranks" << endl;
+            throw std::runtime_error("Error initializing PPPMForceCompute");
+            }
+
+        uint3 pos = di.getTriple(m_rank);
+        m_mesh_dim = make_int3(m_n_inner.x + 2*m_n_ghost.x, m_n_inner.y + 2*m_n_ghost.y, m_n_inner.z + 2*m_n_ghost.z);
+        m_mesh_offset = make_int3(pos.x*m_n_inner.x - m_n_ghost.x,
+                                  pos.y*m_n_inner.y - m_n_ghost.y,
+                                  pos.z*m_n_inner.z - m_n_ghost.z);
+        m_k_ny = m_Ny / m_n_ranks;
+        m_k_y0 = m_rank * m_k_ny;
+
+        // every rank holds the x planes [s*n_x_slab, (s+1)*n_x_slab) of the slab decomposed mesh
+        int n_x_slab = m_Nx / m_n_ranks;
+        int brick_plane = m_n_inner.y * m_n_inner.z;
+        m_brick_counts.resize(m_n_ranks);
+        m_brick_displs.resize(m_n_ranks);
+        m_slab_counts.resize(m_n_ranks);
+        m_slab_displs.resize(m_n_ranks);
+        int brick_offset = 0, slab_offset = 0;
+        for (unsigned int r = 0; r < m_n_ranks; r++)
+            {
+            // x planes of this brick in the slab of rank r
+            int x0 = pos.x*m_n_inner.x;
+            int n_send = MIN(x0 + m_n_inner.x, (int)(r+1)*n_x_slab) - MAX(x0, (int)r*n_x_slab);
+            m_brick_counts[r] = MAX(n_send, 0) * brick_plane;
+            m_brick_displs[r] = brick_offset;
+            brick_offset += m_brick_counts[r];
+
+            // x planes of the brick of rank r in this slab
+            int rx0 = di.getTriple(r).x*m_n_inner.x;
+            int n_recv = MIN(rx0 + m_n_inner.x, (int)(m_rank+1)*n_x_slab) - MAX(rx0, (int)m_rank*n_x_slab);
+            m_slab_counts[r] = MAX(n_recv, 0) * brick_plane;
+            m_slab_displs[r] = slab_offset;
+            slab_offset += m_slab_counts[r];
+            }
+        m_brick_buf.resize(brick_offset);
+        m_slab_buf.resize(slab_offset);
+
+        unsigned int n_slab = m_Nx*m_k_ny*m_Nz;
+        m_transpose_buf.resize(n_slab);
+        m_transpose_recv.resize(n_slab);
+        }
+#endif
+
+    unsigned int n_mesh = m_mesh_dim.x*m_mesh_dim.y*m_mesh_dim.z;
+    GPUArray<cufftComplex> n_rho_real_space(n_mesh, exec_conf);
+    m_rho_real_space.swap(n_rho_real_space);
+    GPUArray<cufftComplex> n_Ex(n_mesh, exec_conf);
+    m_Ex.swap(n_Ex);
+    GPUArray<cufftComplex> n_Ey(n_mesh, exec_conf);
+    m_Ey.swap(n_Ey);
+    GPUArray<cufftComplex> n_Ez(n_mesh, exec_conf);
+    m_Ez.swap(n_Ez);
+    }
+
+/*! \param data Mesh of m_Nx*m_Ny*m_Nz points, stored with z fastest
+    \param inverse Set to true to perform the (unnormalized) inverse transform
+
+    The 3D transform is separable, so it is computed as a pass of 1D transforms along each axis in turn.
+    The result is equivalent to kiss_fftnd.
+*/
+void PPPMForceCompute::fft3d(kiss_fft_cpx *data, bool inverse)
+    {
+    int dim[3] = {m_Nx, m_Ny, m_Nz};
+    for (int d = 2; d >= 0; d--)
+        fftAxis(data, dim, d, inverse);
+    }
+
+/*! \param data Mesh of dim[0]*dim[1]*dim[2] points, stored with the last direction fastest
+    \param dim Dimensions of the mesh
+    \param axis Direction along which to transform, the length must be m_Nx, m_Ny or m_Nz for axis 0, 1 or 2
+    \param inverse Set to true to perform the (unnormalized) inverse transform
+
+    The lines along \a axis are independent and are distributed over the threads, each of which gathers its line
+    into a private scratch buffer, transforms it and scatters it back.
+*/
+void PPPMForceCompute::fftAxis(kiss_fft_cpx *data, const int *dim, int axis, bool inverse)
+    {
+    int max_dim = MAX(m_Nx, MAX(m_Ny, m_Nz));
+
+    // the number of threads may have changed since the buffers were allocated
+    unsigned int n_threads = 1;
+#ifdef ENABLE_OPENMP
+    n_threads = omp_get_max_threads();
+#endif
+    if (m_fft_line.size() < n_threads*max_dim)
+        m_fft_line.resize(n_threads*max_dim);
+
+    kiss_fft_cfg cfg = inverse ? fft_inverse[axis] : fft_forward[axis];
+    int n = dim[axis];
+    int s = 1;
+    for (int d = axis+1; d < 3; d++)
+        s *= dim[d];
+    int n_lines = dim[0]*dim[1]*dim[2] / n;
+
+    #pragma omp parallel
+    {
+    int tid = 0;
+#ifdef ENABLE_OPENMP
+    tid = omp_get_thread_num();
+#endif
+    kiss_fft_cpx *line = &m_fft_line[tid*max_dim];
+
+    #pragma omp for schedule(static)
+    for (int j = 0; j < n_lines; j++)
+        {
+        kiss_fft_cpx *first = data + (j / s) * s * n + j % s;
+        kiss_fft_stride(cfg, first, line, s);
+        for (int k = 0; k < n; k++)
+            first[k*s] = line[k];
+        }
+    }
+    }
+
+/*! Sums the charges and the squared charges of the local particles and reduces both over all ranks in a single
+    collective, so that the result is the same on every rank.
+*/
+void PPPMForceCompute::computeChargeSums()
+    {
+    ArrayHandle<Scalar> h_charge(m_pdata->getCharges(), access_location::host, access_mode::read);
+
+    m_q = 0.f;
+    m_q2 = 0.0;
+    for(int i = 0; i < (int)m_pdata->getN(); i++) {
+        m_q += h_charge.data[i];
+        m_q2 += h_charge.data[i]*h_charge.data[i];
+        }
+#ifdef ENABLE_MPI
+    if (m_pdata->getDomainDecomposition())
+        {
+        Scalar q[2] = {m_q, m_q2};
+        MPI_Allreduce(MPI_IN_PLACE, q, 2, MPI_HOOMD_SCALAR, MPI_SUM, m_exec_conf->getMPICommunicator());
+        m_q = q[0];
+        m_q2 = q[1];
+        }
+#endif
+    }
+
+/*! \returns Sum(q_i*q_i) over all particles in the system
+    charge.pppm uses it to choose kappa before setParams() is called.
+*/
+Scalar PPPMForceCompute::getQ2Sum()
+    {
+    computeChargeSums();
+    return m_q2;
     }
 
 /*! \param Nx Number of grid points in x direction
@@ -133,7 +437,6 @@ void PPPMForceCompute::setParams(int Nx, int Ny, int Nz, int order, Scalar kappa
     m_order = order;
     m_kappa = kappa;
     m_rcut = rcut;
-    first_run = 0;
 
     if(!(m_Nx == 2)&& !(m_Nx == 4)&& !(m_Nx == 8)&& !(m_Nx == 16)&& !(m_Nx == 32)&& !(m_Nx == 64)&& !(m_Nx == 128)&& !(m_Nx == 256)&& !(m_Nx == 512)&& !(m_Nx == 1024))
         {
@@ -158,39 +461,30 @@ void PPPMForceCompute::setParams(int Nx, int Ny, int Nz, int order, Scalar kappa
         throw std::runtime_error("Error initializing PPPMForceCompute");
         }
 
-    GPUArray<cufftComplex> n_rho_real_space(Nx*Ny*Nz, exec_conf);
-    m_rho_real_space.swap(n_rho_real_space);
-    GPUArray<Scalar> n_green_hat(Nx*Ny*Nz, exec_conf);
+    // lay out the real space mesh and allocate it
+    setupMesh();
+
+    // the k-space mesh, only the local slab of it if the mesh is distributed
+    unsigned int n_k = Nx*m_k_ny*Nz;
+    GPUArray<Scalar> n_green_hat(n_k, exec_conf);
     m_green_hat.swap(n_green_hat);
 
-    GPUArray<Scalar> n_vg(6*Nx*Ny*Nz, exec_conf);
+    GPUArray<Scalar> n_vg(6*n_k, exec_conf);
     m_vg.swap(n_vg);
 
 
-    GPUArray<Scalar3> n_kvec(Nx*Ny*Nz, exec_conf);
+    GPUArray<Scalar3> n_kvec(n_k, exec_conf);
     m_kvec.swap(n_kvec);
-    GPUArray<cufftComplex> n_Ex(Nx*Ny*Nz, exec_conf);
-    m_Ex.swap(n_Ex);
-    GPUArray<cufftComplex> n_Ey(Nx*Ny*Nz, exec_conf);
-    m_Ey.swap(n_Ey);
-    GPUArray<cufftComplex> n_Ez(Nx*Ny*Nz, exec_conf);
-    m_Ez.swap(n_Ez);
     GPUArray<Scalar> n_gf_b(order, exec_conf);
     m_gf_b.swap(n_gf_b);
     GPUArray<Scalar> n_rho_coeff(order*(2*order+1), exec_conf);
     m_rho_coeff.swap(n_rho_coeff);
     GPUArray<Scalar3> n_field(Nx*Ny*Nz, exec_conf);
     m_field.swap(n_field);
-    const BoxDim& box = m_pdata->getBox();
-    ArrayHandle<Scalar> h_charge(m_pdata->getCharges(), access_location::host, access_mode::read);
+    const BoxDim& box = m_pdata->getGlobalBox();
 
     // get system charge
-    m_q = 0.f;
-    m_q2 = 0.0;
-    for(int i = 0; i < (int)m_pdata->getN(); i++) {
-        m_q += h_charge.data[i];
-        m_q2 += h_charge.data[i]*h_charge.data[i];
-        }
+    computeChargeSums();
     if(fabs(m_q) > 0.0)
         m_exec_conf->msg->warning() << "charge.pppm: system in not neutral, the net charge is " << m_q << endl;
 
@@ -199,11 +493,11 @@ void PPPMForceCompute::setParams(int Nx, int Ny, int Nz, int order, Scalar kappa
     Scalar hx =  L.x/(Scalar)Nx;
     Scalar hy =  L.y/(Scalar)Ny;
     Scalar hz =  L.z/(Scalar)Nz;
-    Scalar lprx = PPPMForceCompute::rms(hx, L.x, (int)m_pdata->getN());
-    Scalar lpry = PPPMForceCompute::rms(hy, L.y, (int)m_pdata->getN());
-    Scalar lprz = PPPMForceCompute::rms(hz, L.z, (int)m_pdata->getN());
+    Scalar lprx = PPPMForceCompute::rms(hx, L.x, (int)m_pdata->getNGlobal());
+    Scalar lpry = PPPMForceCompute::rms(hy, L.y, (int)m_pdata->getNGlobal());
+    Scalar lprz = PPPMForceCompute::rms(hz, L.z, (int)m_pdata->getNGlobal());
     Scalar lpr = sqrt(lprx*lprx + lpry*lpry + lprz*lprz) / sqrt(3.0);
-    Scalar spr = 2.0*m_q2*exp(-m_kappa*m_kappa*m_rcut*m_rcut) / sqrt((int)m_pdata->getN()*m_rcut*L.x*L.y*L.z);
+    Scalar spr = 2.0*m_q2*exp(-m_kappa*m_kappa*m_rcut*m_rcut) / sqrt((int)m_pdata->getNGlobal()*m_rcut*L.x*L.y*L.z);
 
     double RMS_error = MAX(lpr,spr);
     if(RMS_error > 0.1) {
@@ -215,6 +509,9 @@ void PPPMForceCompute::setParams(int Nx, int Ny, int Nz, int order, Scalar kappa
 
     PPPMForceCompute::compute_rho_coeff();
 
+    // the mesh may have changed, the CPU FFTs are set up again on the next step
+    freeFFT();
+
     // compute k vectors, virial contribution and Green's function
     PPPMForceCompute::reset_kvec_green_hat_cpu();
 
@@ -264,26 +561,28 @@ void PPPMForceCompute::computeForces(unsigned int timestep)
 
     // start the profile for this compute
     if (m_prof) m_prof->push("PPPM force");
-    int dim[3];
-    dim[0] = m_Nx;
-    dim[1] = m_Ny;
-    dim[2] = m_Nz;
 
-    if(first_run == 0) 
+    int n_grid = m_Nx * m_Ny * m_Nz;
+
+#ifdef ENABLE_MPI
+    if (m_distributed)
         {
-        first_run = 1;
-        fft_in = (kiss_fft_cpx *)malloc(m_Nx*m_Ny*m_Nz*sizeof(kiss_fft_cpx));
-        fft_ex = (kiss_fft_cpx *)malloc(m_Nx*m_Ny*m_Nz*sizeof(kiss_fft_cpx));
-        fft_ey = (kiss_fft_cpx *)malloc(m_Nx*m_Ny*m_Nz*sizeof(kiss_fft_cpx));
-        fft_ez = (kiss_fft_cpx *)malloc(m_Nx*m_Ny*m_Nz*sizeof(kiss_fft_cpx));
-
-        fft_forward = kiss_fftnd_alloc(dim, 3, 0, NULL, NULL);
-        fft_inverse = kiss_fftnd_alloc(dim, 3, 1, NULL, NULL);
+        // setupMesh() has registered the requirement for equally sized domains, no load balancer can move them
+        assert(m_decomposition->isUniform());
+
+        // the ghost layer has to grow with the neighbor list buffer
+        int3 n_ghost = computeGhostWidth();
+        if (n_ghost.x != m_n_ghost.x || n_ghost.y != m_n_ghost.y || n_ghost.z != m_n_ghost.z)
+            setupMesh();
         }
+#endif
+
+    if (!fft_in)
+        allocateFFT();
 
     if(m_box_changed)
         {
-        const BoxDim& box = m_pdata->getBox();
+        const BoxDim& box = m_pdata->getGlobalBox();
         Scalar3 L = box.getL();
         PPPMForceCompute::reset_kvec_green_hat_cpu();
         Scalar scale = 1.0f/((Scalar)(m_Nx * m_Ny * m_Nz));
@@ -293,60 +592,75 @@ void PPPMForceCompute::computeForces(unsigned int timestep)
 
     PPPMForceCompute::assign_charges_to_grid();
 
-//FFTs go next
+#ifdef ENABLE_MPI
+    if (m_distributed)
+        {
+        reduceGhostCharges();
+        distributed_green_e();
+        fillGhostFields();
+        }
+    else
+#endif
+        {
+        //FFTs go next
     
-        { // scoping array handles
-        ArrayHandle<cufftComplex> h_rho_real_space(m_rho_real_space, access_location::host, access_mode::readwrite);
-        for(int i = 0; i < m_Nx * m_Ny * m_Nz ; i++) {
-            fft_in[i].r = (float) h_rho_real_space.data[i].x;
-            fft_in[i].i = (float)0.0;
-            }
+            { // scoping array handles
+            ArrayHandle<cufftComplex> h_rho_real_space(m_rho_real_space, access_location::host, access_mode::readwrite);
+            #pragma omp parallel for schedule(static)
+            for(int i = 0; i < n_grid; i++) {
+                fft_in[i].r = (float) h_rho_real_space.data[i].x;
+                fft_in[i].i = (float)0.0;
+                }
 
-        kiss_fftnd(fft_forward, &fft_in[0], &fft_in[0]);
+            fft3d(fft_in, false);
 
-        for(int i = 0; i < m_Nx * m_Ny * m_Nz ; i++) {
-            h_rho_real_space.data[i].x = fft_in[i].r;
-            h_rho_real_space.data[i].y = fft_in[i].i;
+            #pragma omp parallel for schedule(static)
+            for(int i = 0; i < n_grid; i++) {
+                h_rho_real_space.data[i].x = fft_in[i].r;
+                h_rho_real_space.data[i].y = fft_in[i].i;
     
+                }
             }
-        }
 
-    PPPMForceCompute::combined_green_e();
+        PPPMForceCompute::combined_green_e();
 
-//More FFTs
+        //More FFTs
 
-        { // scoping array handles
-        ArrayHandle<cufftComplex> h_Ex(m_Ex, access_location::host, access_mode::readwrite);
-        ArrayHandle<cufftComplex> h_Ey(m_Ey, access_location::host, access_mode::readwrite);
-        ArrayHandle<cufftComplex> h_Ez(m_Ez, access_location::host, access_mode::readwrite);
+            { // scoping array handles
+            ArrayHandle<cufftComplex> h_Ex(m_Ex, access_location::host, access_mode::readwrite);
+            ArrayHandle<cufftComplex> h_Ey(m_Ey, access_location::host, access_mode::readwrite);
+            ArrayHandle<cufftComplex> h_Ez(m_Ez, access_location::host, access_mode::readwrite);
 
-        for(int i = 0; i < m_Nx * m_Ny * m_Nz ; i++)
-            {
-            fft_ex[i].r = (float) h_Ex.data[i].x;
-            fft_ex[i].i = (float) h_Ex.data[i].y;
+            #pragma omp parallel for schedule(static)
+            for(int i = 0; i < n_grid; i++)
+                {
+                fft_ex[i].r = (float) h_Ex.data[i].x;
+                fft_ex[i].i = (float) h_Ex.data[i].y;
 
-            fft_ey[i].r = (float) h_Ey.data[i].x;
-            fft_ey[i].i = (float) h_Ey.data[i].y;
+                fft_ey[i].r = (float) h_Ey.data[i].x;
+                fft_ey[i].i = (float) h_Ey.data[i].y;
 
-            fft_ez[i].r = (float) h_Ez.data[i].x;
-            fft_ez[i].i = (float) h_Ez.data[i].y;
-            }
+                fft_ez[i].r = (float) h_Ez.data[i].x;
+                fft_ez[i].i = (float) h_Ez.data[i].y;
+                }
 
 
-        kiss_fftnd(fft_inverse, &fft_ex[0], &fft_ex[0]);
-        kiss_fftnd(fft_inverse, &fft_ey[0], &fft_ey[0]);
-        kiss_fftnd(fft_inverse, &fft_ez[0], &fft_ez[0]);
+            fft3d(fft_ex, true);
+            fft3d(fft_ey, true);
+            fft3d(fft_ez, true);
 
-        for(int i = 0; i < m_Nx * m_Ny * m_Nz ; i++)
-            {
-            h_Ex.data[i].x = fft_ex[i].r;
-            h_Ex.data[i].y = fft_ex[i].i;
+            #pragma omp parallel for schedule(static)
+            for(int i = 0; i < n_grid; i++)
+                {
+                h_Ex.data[i].x = fft_ex[i].r;
+                h_Ex.data[i].y = fft_ex[i].i;
 
-            h_Ey.data[i].x = fft_ey[i].r;
-            h_Ey.data[i].y = fft_ey[i].i;
+                h_Ey.data[i].x = fft_ey[i].r;
+                h_Ey.data[i].y = fft_ey[i].i;
 
-            h_Ez.data[i].x = fft_ez[i].r;
-            h_Ez.data[i].y = fft_ez[i].i;
+                h_Ez.data[i].x = fft_ez[i].r;
+                h_Ez.data[i].y = fft_ez[i].i;
+                }
             }
         }
 
@@ -474,21 +788,27 @@ void PPPMForceCompute::compute_gf_denom()
     for (l = 0; l < m_order; l++) h_gf_b.data[l] *= gaminv;
     }
 
-Scalar PPPMForceCompute::gf_denom(Scalar x, Scalar y, Scalar z)
+//! Evaluates the denominator of the Green's function from the coefficients computed by compute_gf_denom()
+inline Scalar cpu_gf_denom(const Scalar *gf_b, int order, Scalar x, Scalar y, Scalar z)
     {
     int l ;
     Scalar sx,sy,sz;
-    ArrayHandle<Scalar> h_gf_b(m_gf_b, access_location::host, access_mode::readwrite);
     sz = sy = sx = 0.0;
-    for (l = m_order-1; l >= 0; l--) {
-        sx = h_gf_b.data[l] + sx*x;
-        sy = h_gf_b.data[l] + sy*y;
-        sz = h_gf_b.data[l] + sz*z;
+    for (l = order-1; l >= 0; l--) {
+        sx = gf_b[l] + sx*x;
+        sy = gf_b[l] + sy*y;
+        sz = gf_b[l] + sz*z;
         }
     Scalar s = sx*sy*sz;
     return s*s;
     }
 
+Scalar PPPMForceCompute::gf_denom(Scalar x, Scalar y, Scalar z)
+    {
+    ArrayHandle<Scalar> h_gf_b(m_gf_b, access_location::host, access_mode::read);
+    return cpu_gf_denom(h_gf_b.data, m_order, x, y, z);
+    }
+
 
 //! GPU implementation of sinc(x)==sin(x)/x
 inline Scalar sinc(Scalar x)
@@ -515,7 +835,7 @@ inline Scalar sinc(Scalar x)
 void PPPMForceCompute::reset_kvec_green_hat_cpu()
     {
     ArrayHandle<Scalar3> h_kvec(m_kvec, access_location::host, access_mode::readwrite);
-    const BoxDim& box = m_pdata->getBox();
+    const BoxDim& box = m_pdata->getGlobalBox();
     Scalar3 L = box.getL();
 
     // compute reciprocal lattice vectors
@@ -528,34 +848,36 @@ void PPPMForceCompute::reset_kvec_green_hat_cpu()
     Scalar3 b2 = Scalar(2.0*M_PI)*make_scalar3(a3.y*a1.z-a3.z*a1.y, a3.z*a1.x-a3.x*a1.z, a3.x*a1.y-a3.y*a1.x)/V_box;
     Scalar3 b3 = Scalar(2.0*M_PI)*make_scalar3(a1.y*a2.z-a1.z*a2.y, a1.z*a2.x-a1.x*a2.z, a1.x*a2.y-a1.y*a2.x)/V_box;
 
-    // Set up the k-vectors
-    int ix, iy, iz, kper, lper, mper, k, l, m;
-    for (ix = 0; ix < m_Nx; ix++) {
+    // Set up the k-vectors of the local y planes [m_k_y0, m_k_y0 + m_k_ny)
+    #pragma omp parallel for schedule(static)
+    for (int ix = 0; ix < m_Nx; ix++) {
         Scalar3 j;
         j.x = ix > m_Nx/2 ? ix - m_Nx : ix;
-        for (iy = 0; iy < m_Ny; iy++) {
+        for (int iy_local = 0; iy_local < m_k_ny; iy_local++) {
+            int iy = m_k_y0 + iy_local;
             j.y = iy > m_Ny/2 ? iy - m_Ny : iy;
-            for (iz = 0; iz < m_Nz; iz++) {
+            for (int iz = 0; iz < m_Nz; iz++) {
                 j.z = iz > m_Nz/2 ? iz - m_Nz : iz;
-                h_kvec.data[iz + m_Nz * (iy + m_Ny * ix)] =  j.x*b1+j.y*b2+j.z*b3;
+                h_kvec.data[iz + m_Nz * (iy_local + m_k_ny * ix)] =  j.x*b1+j.y*b2+j.z*b3;
                 }
             }
         }
  
     // Set up constants for virial calculation
     ArrayHandle<Scalar> h_vg(m_vg, access_location::host, access_mode::readwrite);;
+    #pragma omp parallel for schedule(static)
     for(int x = 0; x < m_Nx; x++)
         {
-        for(int y = 0; y < m_Ny; y++)
+        for(int y = 0; y < m_k_ny; y++)
             {
             for(int z = 0; z < m_Nz; z++)
                 {
-                Scalar3 kvec = h_kvec.data[z + m_Nz * (y + m_Ny * x)];
+                Scalar3 kvec = h_kvec.data[z + m_Nz * (y + m_k_ny * x)];
                 Scalar sqk =  kvec.x*kvec.x;
                 sqk += kvec.y*kvec.y;
                 sqk += kvec.z*kvec.z;
     
-                int grid_point = z + m_Nz * (y + m_Ny * x);    
+                int grid_point = z + m_Nz * (y + m_k_ny * x);
                 if (sqk == 0.0) 
                     {
                     h_vg.data[0 + 6*grid_point] = 0.0f;
@@ -582,10 +904,6 @@ void PPPMForceCompute::reset_kvec_green_hat_cpu()
 
     // Set up the grid based Green's function
     ArrayHandle<Scalar> h_green_hat(m_green_hat, access_location::host, access_mode::readwrite);
-    Scalar snx, sny, snz, snx2, sny2, snz2;
-    Scalar argx, argy, argz, wx, wy, wz, qx, qy, qz;
-    Scalar sum1, dot1, dot2;
-    Scalar numerator, denominator, sqk;
 
     Scalar3 kH = Scalar(2.0*M_PI)*make_scalar3(Scalar(1.0)/(Scalar)m_Nx,
                                                Scalar(1.0)/(Scalar)m_Ny,
@@ -597,6 +915,7 @@ void PPPMForceCompute::reset_kvec_green_hat_cpu()
     Scalar form = 1.0;
 
     PPPMForceCompute::compute_gf_denom();
+    ArrayHandle<Scalar> h_gf_b(m_gf_b, access_location::host, access_mode::read);
 
     Scalar temp = floor(((m_kappa*xprd/(M_PI*m_Nx)) * 
                          pow(-log(EPS_HOC),0.25)));
@@ -610,15 +929,23 @@ void PPPMForceCompute::reset_kvec_green_hat_cpu()
                    pow(-log(EPS_HOC),0.25)));
     int nbz = (int)temp;
 
-    Scalar3 kvec,kn, kn1, kn2, kn3;
-    Scalar arg_gauss, gauss;
+    // each z plane of the mesh is independent
+    #pragma omp parallel for schedule(dynamic)
+    for (int m = 0; m < m_Nz; m++) {
+        Scalar snx, sny, snz, snx2, sny2, snz2;
+        Scalar argx, argy, argz, wx, wy, wz, qx, qy, qz;
+        Scalar sum1, dot1, dot2;
+        Scalar numerator, denominator, sqk;
+        Scalar3 kvec,kn, kn1, kn2, kn3;
+        Scalar arg_gauss, gauss;
+        int ix, iy, iz, kper, lper, mper, k, l, l_local;
 
-    for (m = 0; m < m_Nz; m++) {
         mper = m - m_Nz*(2*m/m_Nz);
         snz = sin(0.5*kH.z*mper);
         snz2 = snz*snz;
 
-        for (l = 0; l < m_Ny; l++) {
+        for (l_local = 0; l_local < m_k_ny; l_local++) {
+            l = m_k_y0 + l_local;
             lper = l - m_Ny*(2*l/m_Ny);
             sny = sin(0.5*kH.y*lper);
             sny2 = sny*sny;
@@ -633,7 +960,7 @@ void PPPMForceCompute::reset_kvec_green_hat_cpu()
 
                 if (sqk != 0.0) {
                     numerator = form*12.5663706/sqk;
-                    denominator = gf_denom(snx2,sny2,snz2);  
+                    denominator = cpu_gf_denom(h_gf_b.data, m_order, snx2, sny2, snz2);
 
                     sum1 = 0.0;
                     for (ix = -nbx; ix <= nbx; ix++) {
@@ -664,17 +991,25 @@ void PPPMForceCompute::reset_kvec_green_hat_cpu()
                                 }
                             }
                         }
-                    h_green_hat.data[m + m_Nz * (l + m_Ny * k)] = numerator*sum1/denominator;
-                    } else h_green_hat.data[m + m_Nz * (l + m_Ny * k)] = 0.0;
+                    h_green_hat.data[m + m_Nz * (l_local + m_k_ny * k)] = numerator*sum1/denominator;
+                    } else h_green_hat.data[m + m_Nz * (l_local + m_k_ny * k)] = 0.0;
                 }
             }
         }
     }    
 
+/*! Charges are spread in four colors to avoid write conflicts between threads. The mesh is divided into slabs in
+    x and y that are at least m_order points wide, and each particle is binned into the slab containing its
+    nearest mesh point. The stencil of a particle then reaches at most into the neighboring slabs, so slabs whose
+    x and y indices are both of the same parity never touch the same mesh point and are processed concurrently.
+    Within a slab the particles are spread in index order, which makes the result independent of the number of
+    threads.
+*/
 void PPPMForceCompute::assign_charges_to_grid()
     {
 
-    const BoxDim& box = m_pdata->getBox();
+    const BoxDim& box = m_pdata->getGlobalBox();
+    unsigned int N = m_pdata->getN();
 
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
     ArrayHandle<Scalar> h_charge(m_pdata->getCharges(), access_location::host, access_mode::read);
@@ -682,81 +1017,147 @@ void PPPMForceCompute::assign_charges_to_grid()
     ArrayHandle<Scalar> h_rho_coeff(m_rho_coeff, access_location::host, access_mode::read);
     ArrayHandle<cufftComplex> h_rho_real_space(m_rho_real_space, access_location::host, access_mode::readwrite);
 
-    memset(h_rho_real_space.data, 0, sizeof(cufftComplex)*m_Nx*m_Ny*m_Nz);
+    memset(h_rho_real_space.data, 0, sizeof(cufftComplex)*m_mesh_dim.x*m_mesh_dim.y*m_mesh_dim.z);
 
     Scalar V_cell = box.getVolume()/(Scalar)(m_Nx*m_Ny*m_Nz);
 
-    for(int i = 0; i < (int)m_pdata->getN(); i++)
+    int nlower = -(m_order-1)/2;
+    int nupper = m_order/2;
+    Scalar shift, shiftone;
+    if (m_order % 2)
         {
-        Scalar qi = h_charge.data[i];
-        Scalar3 posi;
-        posi.x = h_pos.data[i].x;
-        posi.y = h_pos.data[i].y;
-        posi.z = h_pos.data[i].z;
+        shift =0.5;
+        shiftone = 0.0;
+        }
+    else
+        {
+        shift = 0.0;
+        shiftone = 0.5;
+        }
 
-        //normalize position to gridsize:
+    // choose an even number of slabs in each direction, or a single slab if the mesh is too small
+    int n_slab_x = m_mesh_dim.x / m_order;
+    int n_slab_y = m_mesh_dim.y / m_order;
+    n_slab_x = (n_slab_x < 2) ? 1 : n_slab_x - n_slab_x % 2;
+    n_slab_y = (n_slab_y < 2) ? 1 : n_slab_y - n_slab_y % 2;
+    int slab_width_x = m_mesh_dim.x / n_slab_x;
+    int slab_width_y = m_mesh_dim.y / n_slab_y;
+    unsigned int n_slab = n_slab_x * n_slab_y;
+
+    // bin the particles by slab with a counting sort
+    if (m_assign_bin.size() < N)
+        {
+        m_assign_bin.resize(N);
+        m_assign_order.resize(N);
+        }
+    m_assign_start.assign(n_slab+1, 0);
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < (int)N; i++)
+        {
+        Scalar3 posi = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
         Scalar3 pos_frac = box.makeFraction(posi);
-        pos_frac.x *= (Scalar)m_Nx;
-        pos_frac.y *= (Scalar)m_Ny;
-        pos_frac.z *= (Scalar)m_Nz;
+        // nearest point on the local mesh
+        int nxi = (int)(pos_frac.x * (Scalar)m_Nx + shift) - m_mesh_offset.x;
+        int nyi = (int)(pos_frac.y * (Scalar)m_Ny + shift) - m_mesh_offset.y;
+        if (nxi >= m_Nx) nxi -= m_Nx;
+        if (nxi < 0) nxi += m_Nx;
+        if (nyi >= m_Ny) nyi -= m_Ny;
+        if (nyi < 0) nyi += m_Ny;
+        int sx = MIN(nxi / slab_width_x, n_slab_x - 1);
+        int sy = MIN(nyi / slab_width_y, n_slab_y - 1);
+        m_assign_bin[i] = sx + n_slab_x * sy;
+        }
 
-        Scalar shift, shiftone, x0, y0, z0, dx, dy, dz;
-        int nlower, nupper, mx, my, mz, nxi, nyi, nzi; 
-    
-        nlower = -(m_order-1)/2;
-        nupper = m_order/2;
-    
-        if (m_order % 2) 
-            {
-            shift =0.5;
-            shiftone = 0.0;
-            }
-        else 
-            {
-            shift = 0.0;
-            shiftone = 0.5;
-            }
+    for (unsigned int i = 0; i < N; i++)
+        m_assign_start[m_assign_bin[i]+1]++;
+    for (unsigned int slab = 0; slab < n_slab; slab++)
+        m_assign_start[slab+1] += m_assign_start[slab];
+    for (unsigned int i = 0; i < N; i++)
+        m_assign_order[m_assign_start[m_assign_bin[i]]++] = i;
+    // the fill advanced each start to the end of its slab, shift back
+    for (unsigned int slab = n_slab; slab > 0; slab--)
+        m_assign_start[slab] = m_assign_start[slab-1];
+    m_assign_start[0] = 0;
+
+    for (int color = 0; color < 4; color++)
+        {
+        int cx = color % 2;
+        int cy = color / 2;
+        if (cx >= n_slab_x || cy >= n_slab_y)
+            continue;
 
-        nxi = (int)(pos_frac.x + shift);
-        nyi = (int)(pos_frac.y + shift);
-        nzi = (int)(pos_frac.z + shift);
- 
-        dx = shiftone+(Scalar)nxi-pos_frac.x;
-        dy = shiftone+(Scalar)nyi-pos_frac.y;
-        dz = shiftone+(Scalar)nzi-pos_frac.z;
+        // slabs of this color
+        int n_task_x = (n_slab_x - cx + 1) / 2;
+        int n_task_y = (n_slab_y - cy + 1) / 2;
 
-        int n,m,l,k;
-        Scalar result;
-        int mult_fact = 2*m_order+1;
+        #pragma omp parallel for schedule(dynamic)
+        for (int task = 0; task < n_task_x * n_task_y; task++)
+            {
+            int sx = cx + 2 * (task % n_task_x);
+            int sy = cy + 2 * (task / n_task_x);
+            unsigned int slab = sx + n_slab_x * sy;
 
-        x0 = qi / V_cell;
-        for (n = nlower; n <= nupper; n++) {
-            mx = n+nxi;
-            if(mx >= m_Nx) mx -= m_Nx;
-            if(mx < 0)  mx += m_Nx;
-            result = 0.0f;
-            for (k = m_order-1; k >= 0; k--) {
-                result = h_rho_coeff.data[n-nlower + k*mult_fact] + result * dx;
-                }
-            y0 = x0*result;
-            for (m = nlower; m <= nupper; m++) {
-                my = m+nyi;
-                if(my >= m_Ny) my -= m_Ny;
-                if(my < 0)  my += m_Ny;
-                result = 0.0f;
-                for (k = m_order-1; k >= 0; k--) {
-                    result = h_rho_coeff.data[m-nlower + k*mult_fact] + result * dy;
-                    }
-                z0 = y0*result;
-                for (l = nlower; l <= nupper; l++) {
-                    mz = l+nzi;
-                    if(mz >= m_Nz) mz -= m_Nz;
-                    if(mz < 0)  mz += m_Nz;
+            for (unsigned int idx = m_assign_start[slab]; idx < m_assign_start[slab+1]; idx++)
+                {
+                unsigned int i = m_assign_order[idx];
+                Scalar qi = h_charge.data[i];
+                Scalar3 posi;
+                posi.x = h_pos.data[i].x;
+                posi.y = h_pos.data[i].y;
+                posi.z = h_pos.data[i].z;
+
+                //normalize position to gridsize:
+                Scalar3 pos_frac = box.makeFraction(posi);
+                pos_frac.x *= (Scalar)m_Nx;
+                pos_frac.y *= (Scalar)m_Ny;
+                pos_frac.z *= (Scalar)m_Nz;
+
+                Scalar x0, y0, z0, dx, dy, dz;
+                int mx, my, mz, nxi, nyi, nzi;
+
+                nxi = (int)(pos_frac.x + shift);
+                nyi = (int)(pos_frac.y + shift);
+                nzi = (int)(pos_frac.z + shift);
+
+                dx = shiftone+(Scalar)nxi-pos_frac.x;
+                dy = shiftone+(Scalar)nyi-pos_frac.y;
+                dz = shiftone+(Scalar)nzi-pos_frac.z;
+
+                int n,m,l,k;
+                Scalar result;
+                int mult_fact = 2*m_order+1;
+
+                x0 = qi / V_cell;
+                for (n = nlower; n <= nupper; n++) {
+                    mx = n+nxi-m_mesh_offset.x;
+                    if(mx >= m_Nx) mx -= m_Nx;
+                    if(mx < 0)  mx += m_Nx;
                     result = 0.0f;
                     for (k = m_order-1; k >= 0; k--) {
-                        result = h_rho_coeff.data[l-nlower + k*mult_fact] + result * dz;
+                        result = h_rho_coeff.data[n-nlower + k*mult_fact] + result * dx;
+                        }
+                    y0 = x0*result;
+                    for (m = nlower; m <= nupper; m++) {
+                        my = m+nyi-m_mesh_offset.y;
+                        if(my >= m_Ny) my -= m_Ny;
+                        if(my < 0)  my += m_Ny;
+                        result = 0.0f;
+                        for (k = m_order-1; k >= 0; k--) {
+                            result = h_rho_coeff.data[m-nlower + k*mult_fact] + result * dy;
+                            }
+                        z0 = y0*result;
+                        for (l = nlower; l <= nupper; l++) {
+                            mz = l+nzi-m_mesh_offset.z;
+                            if(mz >= m_Nz) mz -= m_Nz;
+                            if(mz < 0)  mz += m_Nz;
+                            result = 0.0f;
+                            for (k = m_order-1; k >= 0; k--) {
+                                result = h_rho_coeff.data[l-nlower + k*mult_fact] + result * dz;
+                                }
+                            h_rho_real_space.data[mz + m_mesh_dim.z * (my + m_mesh_dim.y * mx)].x += z0*result;
+                            }
                         }
-                    h_rho_real_space.data[mz + m_Nz * (my + m_Ny * mx)].x += z0*result;
                     }
                 }
             }
@@ -775,7 +1176,8 @@ void PPPMForceCompute::combined_green_e()
     ArrayHandle<cufftComplex> h_rho_real_space(m_rho_real_space, access_location::host, access_mode::readwrite);
 
     unsigned int NNN = m_Nx*m_Ny*m_Nz;
-    for(unsigned int i = 0; i < NNN; i++)
+    #pragma omp parallel for schedule(static)
+    for(int i = 0; i < (int)NNN; i++)
         {
 
         cufftComplex rho_local = h_rho_real_space.data[i];
@@ -796,7 +1198,7 @@ void PPPMForceCompute::combined_green_e()
 
 void PPPMForceCompute::calculate_forces()
     {
-    const BoxDim& box = m_pdata->getBox();
+    const BoxDim& box = m_pdata->getGlobalBox();
     
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
     ArrayHandle<Scalar> h_charge(m_pdata->getCharges(), access_location::host, access_mode::read);
@@ -817,6 +1219,8 @@ void PPPMForceCompute::calculate_forces()
     ArrayHandle<cufftComplex> h_Ey(m_Ey, access_location::host, access_mode::readwrite);
     ArrayHandle<cufftComplex> h_Ez(m_Ez, access_location::host, access_mode::readwrite);
 
+    // each particle only reads the mesh and writes its own force
+    #pragma omp parallel for schedule(static)
     for(int i = 0; i < (int)m_pdata->getN(); i++)
         {
         Scalar qi = h_charge.data[i];
@@ -860,7 +1264,7 @@ void PPPMForceCompute::calculate_forces()
         Scalar result;
         int mult_fact = 2*m_order+1;
         for (n = nlower; n <= nupper; n++) {
-            mx = n+nxi;
+            mx = n+nxi-m_mesh_offset.x;
             if(mx >= m_Nx) mx -= m_Nx;
             if(mx < 0)  mx += m_Nx;
             result = 0.0f;
@@ -869,7 +1273,7 @@ void PPPMForceCompute::calculate_forces()
                 }
             x0 = result;
             for (m = nlower; m <= nupper; m++) {
-                my = m+nyi;
+                my = m+nyi-m_mesh_offset.y;
                 if(my >= m_Ny) my -= m_Ny;
                 if(my < 0)  my += m_Ny;
                 result = 0.0f;
@@ -878,7 +1282,7 @@ void PPPMForceCompute::calculate_forces()
                     }
                 y0 = x0*result;
                 for (l = nlower; l <= nupper; l++) {
-                    mz = l+nzi;
+                    mz = l+nzi-m_mesh_offset.z;
                     if(mz >= m_Nz) mz -= m_Nz;
                     if(mz < 0)  mz += m_Nz;
                     result = 0.0f;
@@ -886,9 +1290,10 @@ void PPPMForceCompute::calculate_forces()
                         result = h_rho_coeff.data[l-nlower + k*mult_fact] + result * dz;
                         }
                     z0 = y0*result;
-                    Scalar local_field_x = h_Ex.data[mz + m_Nz * (my + m_Ny * mx)].x;
-                    Scalar local_field_y = h_Ey.data[mz + m_Nz * (my + m_Ny * mx)].x;
-                    Scalar local_field_z = h_Ez.data[mz + m_Nz * (my + m_Ny * mx)].x;
+                    unsigned int mesh_idx = mz + m_mesh_dim.z * (my + m_mesh_dim.y * mx);
+                    Scalar local_field_x = h_Ex.data[mesh_idx].x;
+                    Scalar local_field_y = h_Ey.data[mesh_idx].x;
+                    Scalar local_field_z = h_Ez.data[mesh_idx].x;
                     h_force.data[i].x += qi*z0*local_field_x;
                     h_force.data[i].y += qi*z0*local_field_y;
                     h_force.data[i].z += qi*z0*local_field_z;
@@ -922,7 +1327,8 @@ void PPPMForceCompute::fix_exclusions_cpu()
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
     ArrayHandle<Scalar> h_charge(m_pdata->getCharges(), access_location::host, access_mode::read);
 
-    for(unsigned int i = 0; i < group_size; i++)
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(int i = 0; i < (int)group_size; i++)
         {
         Scalar4 force = make_scalar4(0.0f, 0.0f, 0.0f, 0.0f);
         Scalar virial[6];
@@ -988,7 +1394,7 @@ void PPPMForceCompute::fix_exclusions_cpu()
 void PPPMForceCompute::fix_thermo_quantities()
     {
     // access data arrays
-    BoxDim box = m_pdata->getBox();
+    BoxDim box = m_pdata->getGlobalBox();
     Scalar3 L = box.getL();
 
     ArrayHandle<cufftComplex> d_rho_real_space(m_rho_real_space, access_location::host, access_mode::readwrite);
@@ -996,15 +1402,24 @@ void PPPMForceCompute::fix_thermo_quantities()
     ArrayHandle<Scalar> d_vg(m_vg, access_location::host, access_mode::readwrite);
     Scalar2 pppm_virial_energy = make_scalar2(0.0, 0.0);
 
-    Scalar v_xx=0.0, v_xy=0.0, v_xz=0.0, v_yy=0.0, v_yz=0.0, v_zz=0.0;
-
-
+    // accumulate in double precision so that the result is insensitive to how the sum is split over the threads
+    double v_xx=0.0, v_xy=0.0, v_xz=0.0, v_yy=0.0, v_yz=0.0, v_zz=0.0;
+    double pressure_sum = 0.0, energy_sum = 0.0;
 
     // compute the correction
-    for (int i = 0; i < m_Nx*m_Ny*m_Nz; i++)
+    #pragma omp parallel for schedule(static) reduction(+:v_xx,v_xy,v_xz,v_yy,v_yz,v_zz,pressure_sum,energy_sum)
+    for (int i = 0; i < m_Nx*m_k_ny*m_Nz; i++)
         {
-        Scalar energy = d_green_hat.data[i]*(d_rho_real_space.data[i].x*d_rho_real_space.data[i].x +
-                                             d_rho_real_space.data[i].y*d_rho_real_space.data[i].y);
+        Scalar rho2;
+#ifdef ENABLE_MPI
+        // the distributed transform leaves the charge density of the local k-space slab in fft_in
+        if (m_distributed)
+            rho2 = fft_in[i].r*fft_in[i].r + fft_in[i].i*fft_in[i].i;
+        else
+#endif
+            rho2 = d_rho_real_space.data[i].x*d_rho_real_space.data[i].x +
+                   d_rho_real_space.data[i].y*d_rho_real_space.data[i].y;
+        Scalar energy = d_green_hat.data[i]*rho2;
         Scalar pressure = energy*(d_vg.data[0+6*i] + d_vg.data[3+6*i] + d_vg.data[5+6*i]);
         v_xx += d_vg.data[0+6*i]*energy;
         v_xy += d_vg.data[1+6*i]*energy;
@@ -1012,16 +1427,40 @@ void PPPMForceCompute::fix_thermo_quantities()
         v_yy += d_vg.data[3+6*i]*energy;
         v_yz += d_vg.data[4+6*i]*energy;
         v_zz += d_vg.data[5+6*i]*energy;
-        pppm_virial_energy.x += pressure;
-        pppm_virial_energy.y += energy;
+        pressure_sum += pressure;
+        energy_sum += energy;
         }
 
+    // the correction is applied to particle 0
+    bool apply_correction = true;
+#ifdef ENABLE_MPI
+    if (m_distributed)
+        {
+        MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
+        double sums[8] = {v_xx, v_xy, v_xz, v_yy, v_yz, v_zz, pressure_sum, energy_sum};
+        MPI_Allreduce(MPI_IN_PLACE, sums, 8, MPI_DOUBLE, MPI_SUM, mpi_comm);
+        v_xx = sums[0]; v_xy = sums[1]; v_xz = sums[2];
+        v_yy = sums[3]; v_yz = sums[4]; v_zz = sums[5];
+        pressure_sum = sums[6]; energy_sum = sums[7];
+
+        // ... of the lowest rank that has any particles
+        unsigned int first_rank = m_pdata->getN() ? m_rank : m_n_ranks;
+        MPI_Allreduce(MPI_IN_PLACE, &first_rank, 1, MPI_UNSIGNED, MPI_MIN, mpi_comm);
+        apply_correction = (first_rank == m_rank);
+        }
+#endif
+    if (!apply_correction)
+        return;
+
+    pppm_virial_energy.x = pressure_sum;
+    pppm_virial_energy.y = energy_sum;
+
     pppm_virial_energy.x *= m_energy_virial_factor/ (3.0f * L.x * L.y * L.z);
     pppm_virial_energy.y *= m_energy_virial_factor;
     pppm_virial_energy.y -= m_q2 * m_kappa / 1.772453850905516027298168f;
     pppm_virial_energy.y -= 0.5*M_PI*m_q*m_q / (m_kappa*m_kappa* L.x * L.y * L.z);
 
-    // apply the correction to particle 0
+    // apply the correction
     ArrayHandle<Scalar4> h_force(m_force,access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar> h_virial(m_virial,access_location::host, access_mode::readwrite);
     h_force.data[0].w += pppm_virial_energy.y;
@@ -1037,6 +1476,277 @@ void PPPMForceCompute::fix_thermo_quantities()
     h_virial.data[5*virial_pitch+0] += v_zz*m_energy_virial_factor;
     }
 
+#ifdef ENABLE_MPI
+/*! \param dim Direction of the exchange (0, 1 or 2 for x, y or z)
+    \param reduce If true, the ghost layers are sent and added to the inner cells of the neighbors. Otherwise the
+           inner boundary layers are sent and copied into the ghost cells of the neighbors.
+    \param n_fields Number of meshes to exchange
+    \param fields The local meshes, only the real part is communicated
+
+    The layers span the whole local mesh in the other two directions, so that exchanging along x, y and z in turn
+    also takes care of the edges and corners.
+*/
+void PPPMForceCompute::exchangeGhostLayer(unsigned int dim, bool reduce, unsigned int n_fields, cufftComplex **fields)
+    {
+    int mesh[3] = {m_mesh_dim.x, m_mesh_dim.y, m_mesh_dim.z};
+    int n_inner[3] = {m_n_inner.x, m_n_inner.y, m_n_inner.z};
+    int n_ghost[3] = {m_n_ghost.x, m_n_ghost.y, m_n_ghost.z};
+    int g = n_ghost[dim];
+    if (g == 0)
+        return;
+
+    int layer[3] = {mesh[0], mesh[1], mesh[2]};
+    layer[dim] = g;
+    unsigned int layer_size = layer[0]*layer[1]*layer[2];
+    m_ghost_send_buf.resize(n_fields*layer_size);
+    m_ghost_recv_buf.resize(n_fields*layer_size);
+
+    MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
+
+    for (unsigned int side = 0; side < 2; side++)
+        {
+        // side 0 sends to the lower neighbor, side 1 to the upper neighbor
+        unsigned int send_dir = 2*dim + (side == 0 ? 1 : 0);
+        unsigned int recv_dir = 2*dim + (side == 0 ? 0 : 1);
+
+        int send_start, recv_start;
+        if (reduce)
+            {
+            // the ghost layer on this side overlaps the inner layer on the opposite side of the neighbor
+            send_start = (side == 0) ? 0 : g + n_inner[dim];
+            recv_start = (side == 0) ? n_inner[dim] : g;
+            }
+        else
+            {
+            // the inner layer on this side overlaps the ghost layer on the opposite side of the neighbor
+            send_start = (side == 0) ? g : n_inner[dim];
+            recv_start = (side == 0) ? g + n_inner[dim] : 0;
+            }
+
+        int lo[3] = {0, 0, 0};
+        lo[dim] = send_start;
+        unsigned int k = 0;
+        for (unsigned int f = 0; f < n_fields; f++)
+            for (int x = lo[0]; x < lo[0] + layer[0]; x++)
+                for (int y = lo[1]; y < lo[1] + layer[1]; y++)
+                    for (int z = lo[2]; z < lo[2] + layer[2]; z++)
+                        m_ghost_send_buf[k++] = fields[f][z + mesh[2] * (y + mesh[1] * x)].x;
+
+        MPI_Sendrecv(&m_ghost_send_buf.front(), n_fields*layer_size, MPI_FLOAT, m_decomposition->getNeighborRank(send_dir), 0,
+                     &m_ghost_recv_buf.front(), n_fields*layer_size, MPI_FLOAT, m_decomposition->getNeighborRank(recv_dir), 0,
+                     mpi_comm, MPI_STATUS_IGNORE);
+
+        lo[dim] = recv_start;
+        k = 0;
+        for (unsigned int f = 0; f < n_fields; f++)
+            for (int x = lo[0]; x < lo[0] + layer[0]; x++)
+                for (int y = lo[1]; y < lo[1] + layer[1]; y++)
+                    for (int z = lo[2]; z < lo[2] + layer[2]; z++)
+                        {
+                        cufftComplex& v = fields[f][z + mesh[2] * (y + mesh[1] * x)];
+                        if (reduce)
+                            v.x += m_ghost_recv_buf[k++];
+                        else
+                            v.x = m_ghost_recv_buf[k++];
+                        }
+        }
+    }
+
+void PPPMForceCompute::reduceGhostCharges()
+    {
+    ArrayHandle<cufftComplex> h_rho_real_space(m_rho_real_space, access_location::host, access_mode::readwrite);
+    cufftComplex *fields[1] = {h_rho_real_space.data};
+    for (unsigned int dim = 0; dim < 3; dim++)
+        exchangeGhostLayer(dim, true, 1, fields);
+    }
+
+void PPPMForceCompute::fillGhostFields()
+    {
+    ArrayHandle<cufftComplex> h_Ex(m_Ex, access_location::host, access_mode::readwrite);
+    ArrayHandle<cufftComplex> h_Ey(m_Ey, access_location::host, access_mode::readwrite);
+    ArrayHandle<cufftComplex> h_Ez(m_Ez, access_location::host, access_mode::readwrite);
+    cufftComplex *fields[3] = {h_Ex.data, h_Ey.data, h_Ez.data};
+    for (unsigned int dim = 0; dim < 3; dim++)
+        exchangeGhostLayer(dim, false, 3, fields);
+    }
+
+/*! \param brick The local real space mesh, including ghost cells
+    \param slab Output: the x planes [rank*Nx/P, (rank+1)*Nx/P) of the global mesh, stored with z fastest
+*/
+void PPPMForceCompute::brickToSlab(const cufftComplex *brick, kiss_fft_cpx *slab)
+    {
+    const Index3D& di = m_decomposition->getDomainIndexer();
+    int n_x_slab = m_Nx / m_n_ranks;
+
+    // the inner points of the brick, in order of increasing x and thus destination rank
+    unsigned int k = 0;
+    for (int x = m_n_ghost.x; x < m_n_ghost.x + m_n_inner.x; x++)
+        for (int y = m_n_ghost.y; y < m_n_ghost.y + m_n_inner.y; y++)
+            for (int z = m_n_ghost.z; z < m_n_ghost.z + m_n_inner.z; z++)
+                m_brick_buf[k++] = brick[z + m_mesh_dim.z * (y + m_mesh_dim.y * x)].x;
+
+    MPI_Alltoallv(&m_brick_buf.front(), &m_brick_counts.front(), &m_brick_displs.front(), MPI_FLOAT,
+                  &m_slab_buf.front(), &m_slab_counts.front(), &m_slab_displs.front(), MPI_FLOAT,
+                  m_exec_conf->getMPICommunicator());
+
+    for (unsigned int r = 0; r < m_n_ranks; r++)
+        {
+        if (!m_slab_counts[r])
+            continue;
+        uint3 pos = di.getTriple(r);
+        int x0 = MAX((int)(pos.x*m_n_inner.x), (int)m_rank*n_x_slab);
+        int x1 = MIN((int)(pos.x*m_n_inner.x) + m_n_inner.x, (int)(m_rank+1)*n_x_slab);
+        k = m_slab_displs[r];
+        for (int x = x0; x < x1; x++)
+            for (int y = pos.y*m_n_inner.y; y < (int)(pos.y+1)*m_n_inner.y; y++)
+                for (int z = pos.z*m_n_inner.z; z < (int)(pos.z+1)*m_n_inner.z; z++)
+                    {
+                    kiss_fft_cpx& v = slab[z + m_Nz * (y + m_Ny * (x - (int)m_rank*n_x_slab))];
+                    v.r = m_slab_buf[k++];
+                    v.i = 0.0f;
+                    }
+        }
+    }
+
+/*! \param slab The x planes [rank*Nx/P, (rank+1)*Nx/P) of the global mesh, only the real part is used
+    \param brick Output: the inner points of the local real space mesh
+*/
+void PPPMForceCompute::slabToBrick(const kiss_fft_cpx *slab, cufftComplex *brick)
+    {
+    const Index3D& di = m_decomposition->getDomainIndexer();
+    int n_x_slab = m_Nx / m_n_ranks;
+
+    for (unsigned int r = 0; r < m_n_ranks; r++)
+        {
+        if (!m_slab_counts[r])
+            continue;
+        uint3 pos = di.getTriple(r);
+        int x0 = MAX((int)(pos.x*m_n_inner.x), (int)m_rank*n_x_slab);
+        int x1 = MIN((int)(pos.x*m_n_inner.x) + m_n_inner.x, (int)(m_rank+1)*n_x_slab);
+        unsigned int k = m_slab_displs[r];
+        for (int x = x0; x < x1; x++)
+            for (int y = pos.y*m_n_inner.y; y < (int)(pos.y+1)*m_n_inner.y; y++)
+                for (int z = pos.z*m_n_inner.z; z < (int)(pos.z+1)*m_n_inner.z; z++)
+                    m_slab_buf[k++] = slab[z + m_Nz * (y + m_Ny * (x - (int)m_rank*n_x_slab))].r;
+        }
+
+    MPI_Alltoallv(&m_slab_buf.front(), &m_slab_counts.front(), &m_slab_displs.front(), MPI_FLOAT,
+                  &m_brick_buf.front(), &m_brick_counts.front(), &m_brick_displs.front(), MPI_FLOAT,
+                  m_exec_conf->getMPICommunicator());
+
+    unsigned int k = 0;
+    for (int x = m_n_ghost.x; x < m_n_ghost.x + m_n_inner.x; x++)
+        for (int y = m_n_ghost.y; y < m_n_ghost.y + m_n_inner.y; y++)
+            for (int z = m_n_ghost.z; z < m_n_ghost.z + m_n_inner.z; z++)
+                {
+                cufftComplex& v = brick[z + m_mesh_dim.z * (y + m_mesh_dim.y * x)];
+                v.x = m_brick_buf[k++];
+                v.y = 0.0f;
+                }
+    }
+
+/*! \param data The local slab, Nx*Ny*Nz/P points
+    \param x_to_y If true, transpose from slabs of x planes (index z + Nz*(y + Ny*x_local)) to slabs of y planes
+           (index z + Nz*(y_local + Ny/P*x)), otherwise transpose back
+
+    Every pair of ranks exchanges a block of Nx/P x Ny/P x Nz points, so this is a single MPI_Alltoall.
+*/
+void PPPMForceCompute::transposeSlab(kiss_fft_cpx *data, bool x_to_y)
+    {
+    int n_x_slab = m_Nx / m_n_ranks;
+    int n_y_slab = m_Ny / m_n_ranks;
+    int block = n_x_slab*n_y_slab*m_Nz;
+
+    #pragma omp parallel for schedule(static)
+    for (int s = 0; s < (int)m_n_ranks; s++)
+        for (int xl = 0; xl < n_x_slab; xl++)
+            for (int yl = 0; yl < n_y_slab; yl++)
+                {
+                kiss_fft_cpx *dest = &m_transpose_buf[s*block + m_Nz * (yl + n_y_slab * xl)];
+                const kiss_fft_cpx *src;
+                if (x_to_y)
+                    src = data + m_Nz * ((s*n_y_slab + yl) + m_Ny * xl);
+                else
+                    src = data + m_Nz * (yl + n_y_slab * (s*n_x_slab + xl));
+                memcpy(dest, src, sizeof(kiss_fft_cpx)*m_Nz);
+                }
+
+    MPI_Alltoall(&m_transpose_buf.front(), block*sizeof(kiss_fft_cpx), MPI_BYTE,
+                 &m_transpose_recv.front(), block*sizeof(kiss_fft_cpx), MPI_BYTE,
+                 m_exec_conf->getMPICommunicator());
+
+    #pragma omp parallel for schedule(static)
+    for (int r = 0; r < (int)m_n_ranks; r++)
+        for (int xl = 0; xl < n_x_slab; xl++)
+            for (int yl = 0; yl < n_y_slab; yl++)
+                {
+                const kiss_fft_cpx *src = &m_transpose_recv[r*block + m_Nz * (yl + n_y_slab * xl)];
+                kiss_fft_cpx *dest;
+                if (x_to_y)
+                    dest = data + m_Nz * (yl + n_y_slab * (r*n_x_slab + xl));
+                else
+                    dest = data + m_Nz * ((r*n_y_slab + yl) + m_Ny * xl);
+                memcpy(dest, src, sizeof(kiss_fft_cpx)*m_Nz);
+                }
+    }
+
+/*! Transforms the charge density on the distributed mesh to k-space, computes the electric field on the local
+    slab of k-space and transforms it back to the local bricks. On return, fft_in holds the transformed charge
+    density of the local slab of y planes, for use in fix_thermo_quantities().
+*/
+void PPPMForceCompute::distributed_green_e()
+    {
+    int n_x_slab = m_Nx / m_n_ranks;
+    int dim_x_slab[3] = {n_x_slab, m_Ny, m_Nz};
+    int dim_y_slab[3] = {m_Nx, m_k_ny, m_Nz};
+
+        { // scoping array handles
+        ArrayHandle<cufftComplex> h_rho_real_space(m_rho_real_space, access_location::host, access_mode::read);
+        brickToSlab(h_rho_real_space.data, fft_in);
+        }
+
+    fftAxis(fft_in, dim_x_slab, 2, false);
+    fftAxis(fft_in, dim_x_slab, 1, false);
+    transposeSlab(fft_in, true);
+    fftAxis(fft_in, dim_y_slab, 0, false);
+
+        { // scoping array handles
+        ArrayHandle<Scalar3> h_kvec(m_kvec, access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_green_hat(m_green_hat, access_location::host, access_mode::read);
+
+        Scalar NNN = Scalar(m_Nx*m_Ny*m_Nz);
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < m_Nx*m_k_ny*m_Nz; i++)
+            {
+            Scalar scale_times_green = h_green_hat.data[i] / NNN;
+            Scalar rho_r = fft_in[i].r * scale_times_green;
+            Scalar rho_i = fft_in[i].i * scale_times_green;
+            Scalar3 kvec = h_kvec.data[i];
+
+            fft_ex[i].r = kvec.x * rho_i;
+            fft_ex[i].i = -kvec.x * rho_r;
+            fft_ey[i].r = kvec.y * rho_i;
+            fft_ey[i].i = -kvec.y * rho_r;
+            fft_ez[i].r = kvec.z * rho_i;
+            fft_ez[i].i = -kvec.z * rho_r;
+            }
+        }
+
+    kiss_fft_cpx *fft_e[3] = {fft_ex, fft_ey, fft_ez};
+    GPUArray<cufftComplex> *field[3] = {&m_Ex, &m_Ey, &m_Ez};
+    for (unsigned int c = 0; c < 3; c++)
+        {
+        fftAxis(fft_e[c], dim_y_slab, 0, true);
+        transposeSlab(fft_e[c], false);
+        fftAxis(fft_e[c], dim_x_slab, 1, true);
+        fftAxis(fft_e[c], dim_x_slab, 2, true);
+
+        ArrayHandle<cufftComplex> h_field(*field[c], access_location::host, access_mode::readwrite);
+        slabToBrick(fft_e[c], h_field.data);
+        }
+    }
+#endif
+
 void export_PPPMForceCompute()
     {
     class_<PPPMForceCompute, boost::shared_ptr<PPPMForceCompute>, bases<ForceCompute>, boost::noncopyable >
@@ -1044,5 +1754,6 @@ void export_PPPMForceCompute()
          boost::shared_ptr<NeighborList>,
          boost::shared_ptr<ParticleGroup> >())
         .def("setParams", &PPPMForceCompute::setParams)
+        .def("getQ2Sum", &PPPMForceCompute::getQ2Sum)
         ;
     }
@@ -56,10 +56,14 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ForceCompute.h"
 #include "NeighborList.h"
 #include "ParticleGroup.h"
-#include "kiss_fftnd.h"
+#include "kiss_fft.h"
 
 #include <vector>
 
+#ifdef ENABLE_MPI
+#include "DomainDecomposition.h"
+#endif
+
 #ifdef ENABLE_CUDA
 #include <cufft.h>
 #endif
@@ -90,6 +94,37 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //! Computes the long ranged part of the electrostatic forces on each particle
 /*! PPPM forces are computed on every particle in the simulation.
 
+    <b>Threading</b>
+
+    On the CPU every stage of the computation is parallelized with OpenMP. Charges are assigned to the mesh
+    in four colors: particles are binned into slabs in x and y that are at least one interpolation stencil
+    wide, and slabs of the same color never write to the same mesh point, so they are spread concurrently
+    without per-thread copies of the mesh. The 3D FFT is performed as batches of 1D kiss_fft transforms along
+    each axis, with the lines of a batch distributed over the threads. The force interpolation, the
+    Green's function setup and the energy and virial sums loop over particles or mesh points in parallel.
+
+    The FFT plans and buffers depend only on the mesh dimensions. They are allocated on the first step and kept
+    until setParams() is called again; a box change (slotBoxChanged()) only triggers a rebuild of the k-vectors
+    and the Green's function.
+
+    <b>Domain decomposition</b>
+
+    In an MPI simulation with a DomainDecomposition, the mesh is distributed along with the particles. Every rank
+    owns the brick of mesh points inside its domain, and stores it together with a layer of ghost cells wide
+    enough for the interpolation stencil of any particle that has not yet migrated (m_mesh_dim, m_mesh_offset,
+    m_n_ghost). A step then proceeds as follows:
+     - local charges are spread onto the brick, and the ghost cells are added to the neighboring ranks
+       (reduceGhostCharges())
+     - the bricks are redistributed into slabs of x planes with an MPI_Alltoallv, the slabs are transformed along
+       y and z, transposed into slabs of y planes with an MPI_Alltoall and transformed along x
+     - the Green's function and the k-vectors of the local y slab give the electric field in k-space, which is
+       transformed back along the same path
+     - the ghost cells of the field are filled from the neighboring ranks (fillGhostFields()) and the forces are
+       interpolated locally.
+
+    The energy and virial are summed over the local k-space slab and then over the ranks with MPI_Allreduce.
+    The distributed mesh requires Nx and Ny to be multiples of the number of ranks, and Nx, Ny and Nz to be
+    multiples of the number of domains along the respective direction.
 */
 class PPPMForceCompute : public ForceCompute
     {
@@ -104,12 +139,28 @@ class PPPMForceCompute : public ForceCompute
         
         //! Set the parameters
         virtual void setParams(int Nx, int Ny, int Nz, int order, Scalar kappa, Scalar rcut);
+
+        //! Get the sum of the squared charges over all particles
+        Scalar getQ2Sum();
         
         //! Returns a list of log quantities this compute calculates
         virtual std::vector< std::string > getProvidedLogQuantities();
         
         //! Calculates the requested log value and returns it
         virtual Scalar getLogValue(const std::string& quantity, unsigned int timestep);
+
+#ifdef ENABLE_MPI
+        //! Request the ghost charges
+        /*! The exclusion correction pairs local particles with ghost particles and needs their charges.
+            \param timestep Current time step
+        */
+        virtual CommFlags getRequestedCommFlags(unsigned int timestep)
+            {
+            CommFlags flags(0);
+            flags[comm_flag::charge] = 1;
+            return flags;
+            }
+#endif
         
         //! Notification of a box size change
         void slotBoxChanged()
@@ -117,6 +168,9 @@ class PPPMForceCompute : public ForceCompute
             m_box_changed = true;
             }
 
+        //! Sum the charges and squared charges over all particles into m_q and m_q2
+        void computeChargeSums();
+
         //! root mean square error in force calculation
         Scalar rms(Scalar h, Scalar prd, Scalar natoms);
         //! computes coefficients for assigning charges to grid points
@@ -137,6 +191,10 @@ class PPPMForceCompute : public ForceCompute
         void fix_exclusions_cpu();
         //! fix the energy and virial thermodynamic quantities
         virtual void fix_thermo_quantities();
+        //! Perform an in-place 3D FFT on the CPU
+        void fft3d(kiss_fft_cpx *data, bool inverse);
+        //! Perform in-place 1D FFTs along one axis of a mesh
+        void fftAxis(kiss_fft_cpx *data, const int *dim, int axis, bool inverse);
 
     protected:
         GPUArray<Scalar>m_vg;                    //!< Virial coefficient
@@ -176,12 +234,74 @@ class PPPMForceCompute : public ForceCompute
         kiss_fft_cpx *fft_ex;                    //!< For FFTs on CPU E-field x component
         kiss_fft_cpx *fft_ey;                    //!< For FFTs on CPU E-field y component
         kiss_fft_cpx *fft_ez;                    //!< For FFTs on CPU E-field z component
-        kiss_fftnd_cfg fft_forward;              //!< Forward FFT on CPU
-        kiss_fftnd_cfg fft_inverse;              //!< Inverse FFT on CPU
-        int first_run;                           //!< flag for allocating arrays
+        kiss_fft_cfg fft_forward[3];             //!< Forward 1D FFTs along x, y and z on CPU
+        kiss_fft_cfg fft_inverse[3];             //!< Inverse 1D FFTs along x, y and z on CPU
+        std::vector<kiss_fft_cpx> m_fft_line;    //!< Per-thread scratch lines for the 1D FFTs
+        std::vector<unsigned int> m_assign_bin;  //!< Slab of each particle for the colored charge assignment
+        std::vector<unsigned int> m_assign_start;//!< Start of each slab in m_assign_order
+        std::vector<unsigned int> m_assign_order;//!< Particle indices sorted by slab
+        int3 m_mesh_dim;                         //!< Dimensions of the local real space mesh, including ghost cells
+        int3 m_mesh_offset;                      //!< Global index of the first point of the local mesh
+        int3 m_n_ghost;                          //!< Number of ghost cells on each side of the local mesh
+        int m_k_y0;                              //!< First y plane of the local k-space mesh
+        int m_k_ny;                              //!< Number of y planes in the local k-space mesh
+
+#ifdef ENABLE_MPI
+        bool m_distributed;                      //!< True if the mesh is distributed over a domain decomposition
+        boost::shared_ptr<DomainDecomposition> m_decomposition; //!< The domain decomposition
+        bool m_requires_uniform;                 //!< True once equally sized domains are required from m_decomposition
+        unsigned int m_n_ranks;                  //!< Number of ranks
+        unsigned int m_rank;                     //!< Rank of this processor
+        int3 m_n_inner;                          //!< Number of mesh points owned by this rank in each direction
+        std::vector<int> m_brick_counts;         //!< Number of floats sent to every rank by brickToSlab()
+        std::vector<int> m_brick_displs;         //!< Offsets of the floats sent to every rank by brickToSlab()
+        std::vector<int> m_slab_counts;          //!< Number of floats received from every rank by brickToSlab()
+        std::vector<int> m_slab_displs;          //!< Offsets of the floats received from every rank by brickToSlab()
+        std::vector<float> m_brick_buf;          //!< Packed brick data
+        std::vector<float> m_slab_buf;           //!< Packed slab data
+        std::vector<kiss_fft_cpx> m_transpose_buf; //!< Send buffer for the slab transposes
+        std::vector<kiss_fft_cpx> m_transpose_recv; //!< Receive buffer for the slab transposes
+        std::vector<float> m_ghost_send_buf;     //!< Send buffer for the ghost cells
+        std::vector<float> m_ghost_recv_buf;     //!< Receive buffer for the ghost cells
+#endif
 
         //! Actually compute the forces
         virtual void computeForces(unsigned int timestep);
+
+        //! Allocate the CPU FFT plans and buffers for the current mesh
+        void allocateFFT();
+
+        //! Free the CPU FFT plans and buffers
+        void freeFFT();
+
+        //! Compute the layout of the local mesh
+        void setupMesh();
+
+        //! Number of ghost cells needed in each direction
+        int3 computeGhostWidth();
+
+#ifdef ENABLE_MPI
+        //! Add the charges on the ghost cells to the neighboring ranks
+        void reduceGhostCharges();
+
+        //! Fill the ghost cells of the electric field from the neighboring ranks
+        void fillGhostFields();
+
+        //! Exchange one layer of the local mesh with the neighbors along a direction
+        void exchangeGhostLayer(unsigned int dim, bool reduce, unsigned int n_fields, cufftComplex **fields);
+
+        //! Redistribute the local bricks into slabs of x planes
+        void brickToSlab(const cufftComplex *brick, kiss_fft_cpx *slab);
+
+        //! Redistribute slabs of x planes back into the local bricks
+        void slabToBrick(const kiss_fft_cpx *slab, cufftComplex *brick);
+
+        //! Transpose between slabs of x planes and slabs of y planes
+        void transposeSlab(kiss_fft_cpx *data, bool x_to_y);
+
+        //! Compute the electric field on the distributed mesh
+        void distributed_green_e();
+#endif
     };
 
 
@@ -214,6 +214,14 @@ void TablePotential::computeForces(unsigned int timestep)
     // to reduce computations at the cost of memory access complexity: set that flag now
     bool third_law = m_nlist->getStorageMode() == NeighborList::half;
     
+    // in the owner computes mode, each thread writes the results for its own particles directly to the output arrays
+    bool owner = m_thread_accumulation == owner_computes;
+    if (owner && third_law)
+        {
+        m_exec_conf->msg->error() << "pair.table: owner computes accumulation requires a full neighbor list" << endl;
+        throw runtime_error("Error computing pair forces");
+        }
+    
     // access the neighbor list
     ArrayHandle<unsigned int> h_n_neigh(m_nlist->getNNeighArray(), access_location::host, access_mode::read);
     ArrayHandle<unsigned int> h_nlist(m_nlist->getNListArray(), access_location::host, access_mode::read);
@@ -254,8 +262,11 @@ void TablePotential::computeForces(unsigned int timestep)
     #endif
 
     // need to start from a zero force, energy and virial
-    memset(&m_fdata_partial[m_index_thread_partial(0,tid)] , 0, sizeof(Scalar4)*m_pdata->getN());
-    memset(&m_virial_partial[6*m_index_thread_partial(0,tid)] , 0, 6*sizeof(Scalar)*m_pdata->getN());
+    if (!owner)
+        {
+        memset(&m_fdata_partial[m_index_thread_partial(0,tid)] , 0, sizeof(Scalar4)*m_pdata->getN());
+        memset(&m_virial_partial[6*m_index_thread_partial(0,tid)] , 0, 6*sizeof(Scalar)*m_pdata->getN());
+        }
     
     // for each particle
 #pragma omp for schedule(guided)
@@ -371,6 +382,18 @@ void TablePotential::computeForces(unsigned int timestep)
             }
             
         // finally, increment the force, potential energy and virial for particle i
+        if (owner)
+            {
+            h_force.data[i] = make_scalar4(fi.x, fi.y, fi.z, pei);
+            h_virial.data[0*m_virial_pitch+i] = virialxxi;
+            h_virial.data[1*m_virial_pitch+i] = virialxyi;
+            h_virial.data[2*m_virial_pitch+i] = virialxzi;
+            h_virial.data[3*m_virial_pitch+i] = virialyyi;
+            h_virial.data[4*m_virial_pitch+i] = virialyzi;
+            h_virial.data[5*m_virial_pitch+i] = virialzzi;
+            continue;
+            }
+
         unsigned int mem_idx = m_index_thread_partial(i,tid);
         m_fdata_partial[mem_idx].x += fi.x;
         m_fdata_partial[mem_idx].y += fi.y;
@@ -384,34 +407,38 @@ void TablePotential::computeForces(unsigned int timestep)
         m_virial_partial[5+6*mem_idx] += virialzzi;
         }
     
+    // the results are complete in the owner computes mode
+    if (!owner)
+        {
 #pragma omp barrier
     
-    // now that the partial sums are complete, sum up the results in parallel
+        // now that the partial sums are complete, sum up the results in parallel
 #pragma omp for
-    for (int i = 0; i < (int)m_pdata->getN(); i++)
-        {
-        // assign result from thread 0
-        h_force.data[i].x = m_fdata_partial[i].x;
-        h_force.data[i].y = m_fdata_partial[i].y;
-        h_force.data[i].z = m_fdata_partial[i].z;
-        h_force.data[i].w = m_fdata_partial[i].w;
-        for (int j = 0; j < 6; j++)
-            h_virial.data[j*m_virial_pitch+i] = m_virial_partial[j+6*i];
-
-        #ifdef ENABLE_OPENMP
-        // add results from other threads
-        int nthreads = omp_get_num_threads();
-        for (int thread = 1; thread < nthreads; thread++)
+        for (int i = 0; i < (int)m_pdata->getN(); i++)
             {
-            unsigned int mem_idx = m_index_thread_partial(i,thread);
-            h_force.data[i].x += m_fdata_partial[mem_idx].x;
-            h_force.data[i].y += m_fdata_partial[mem_idx].y;
-            h_force.data[i].z += m_fdata_partial[mem_idx].z;
-            h_force.data[i].w += m_fdata_partial[mem_idx].w;
+            // assign result from thread 0
+            h_force.data[i].x = m_fdata_partial[i].x;
+            h_force.data[i].y = m_fdata_partial[i].y;
+            h_force.data[i].z = m_fdata_partial[i].z;
+            h_force.data[i].w = m_fdata_partial[i].w;
             for (int j = 0; j < 6; j++)
-                h_virial.data[j*m_virial_pitch+i] += m_virial_partial[j+6*mem_idx];
+                h_virial.data[j*m_virial_pitch+i] = m_virial_partial[j+6*i];
+
+            #ifdef ENABLE_OPENMP
+            // add results from other threads
+            int nthreads = omp_get_num_threads();
+            for (int thread = 1; thread < nthreads; thread++)
+                {
+                unsigned int mem_idx = m_index_thread_partial(i,thread);
+                h_force.data[i].x += m_fdata_partial[mem_idx].x;
+                h_force.data[i].y += m_fdata_partial[mem_idx].y;
+                h_force.data[i].z += m_fdata_partial[mem_idx].z;
+                h_force.data[i].w += m_fdata_partial[mem_idx].w;
+                for (int j = 0; j < 6; j++)
+                    h_virial.data[j*m_virial_pitch+i] += m_virial_partial[j+6*mem_idx];
+                }
+            #endif
             }
-        #endif
         }
     } // end omp parallel
 
@@ -127,7 +127,13 @@ class TablePotential : public ForceCompute
         
         //! Calculates the requested log value and returns it
         virtual Scalar getLogValue(const std::string& quantity, unsigned int timestep);
-        
+
+        //! The CPU compute implements both thread accumulation modes
+        virtual bool supportsThreadAccumulation()
+            {
+            return true;
+            }
+
     protected:
         boost::shared_ptr<NeighborList> m_nlist;    //!< The neighborlist to use for the computation
         unsigned int m_table_width;                 //!< Width of the tables in memory
@@ -88,6 +88,12 @@ class EAMForceComputeGPU : public EAMForceCompute
         //! Sets the block size to run at
         void setBlockSize(int block_size);
 
+        //! The GPU compute does not use the thread accumulation modes
+        virtual bool supportsThreadAccumulation()
+            {
+            return false;
+            }
+
     protected:
         EAMTexInterData eam_data;                   //!< Undocumented parameter
         EAMtex eam_tex_data;                        //!< Undocumented parameter
@@ -103,6 +103,14 @@ PPPMForceComputeGPU::~PPPMForceComputeGPU()
 */
 void PPPMForceComputeGPU::setParams(int Nx, int Ny, int Nz, int order, Scalar kappa, Scalar rcut)
     {
+#ifdef ENABLE_MPI
+    if (m_pdata->getDomainDecomposition())
+        {
+        m_exec_conf->msg->error() << "charge.pppm: the distributed mesh is only implemented on the CPU" << endl;
+        throw std::runtime_error("Error initializing PPPMForceComputeGPU");
+        }
+#endif
+
     PPPMForceCompute::setParams(Nx, Ny, Nz, order, kappa, rcut);
     cufftPlan3d(&plan, Nx, Ny, Nz, CUFFT_C2C);
 
@@ -84,7 +84,13 @@ class TablePotentialGPU : public TablePotential
         
         //! Set the block size
         void setBlockSize(int block_size);
-        
+
+        //! The GPU compute does not use the thread accumulation modes
+        virtual bool supportsThreadAccumulation()
+            {
+            return false;
+            }
+
     private:
         int m_block_size;   //!< the block size
         
@@ -57,6 +57,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "AngleData.h"
 #include "ParticleData.h"
+#include "PermuteParticleTable.h"
 
 #include <boost/python.hpp>
 using namespace boost::python;
@@ -77,6 +78,8 @@ using namespace std;
 */
 AngleData::AngleData(boost::shared_ptr<ParticleData> pdata, unsigned int n_angle_types)
         : m_angles_dirty(false),
+          m_table_permuted(false),
+          m_validate_permutation(false),
           m_pdata(pdata),
           exec_conf(m_pdata->getExecConf()),
           m_angles(exec_conf),
@@ -88,8 +91,9 @@ AngleData::AngleData(boost::shared_ptr<ParticleData> pdata, unsigned int n_angle
     m_exec_conf = m_pdata->getExecConf();
     m_exec_conf->msg->notice(5) << "Constructing AngleData" << endl;
 
-    // attach to the signal for notifications of particle sorts
-    m_sort_connection = m_pdata->connectParticleSort(bind(&AngleData::setDirty, this));
+    // attach to the signals for notifications of particle sorts
+    m_sort_connection = m_pdata->connectParticleSort(bind(&AngleData::slotParticleSort, this));
+    m_permutation_connection = m_pdata->connectParticlePermutation(bind(&AngleData::slotParticlePermutation, this, _1));
     
     // offer a default type mapping
     for (unsigned int i = 0; i < n_angle_types; i++)
@@ -111,6 +115,8 @@ AngleData::AngleData(boost::shared_ptr<ParticleData> pdata, unsigned int n_angle
 */
 AngleData::AngleData(boost::shared_ptr<ParticleData> pdata, const SnapshotAngleData& snapshot)
     : m_angles_dirty(false),
+          m_table_permuted(false),
+          m_validate_permutation(false),
       m_pdata(pdata),
       exec_conf(m_pdata->getExecConf()),
       m_angles(exec_conf),
@@ -122,8 +128,9 @@ AngleData::AngleData(boost::shared_ptr<ParticleData> pdata, const SnapshotAngleD
     m_exec_conf = m_pdata->getExecConf();
     m_exec_conf->msg->notice(5) << "Constructing AngleData" << endl;
 
-    // attach to the signal for notifications of particle sorts
-    m_sort_connection = m_pdata->connectParticleSort(bind(&AngleData::setDirty, this));
+    // attach to the signals for notifications of particle sorts
+    m_sort_connection = m_pdata->connectParticleSort(bind(&AngleData::slotParticleSort, this));
+    m_permutation_connection = m_pdata->connectParticlePermutation(bind(&AngleData::slotParticlePermutation, this, _1));
     
     // allocate memory for the GPU angle table
     allocateAngleTable(1);
@@ -136,6 +143,7 @@ AngleData::~AngleData()
     {
     m_exec_conf->msg->notice(5) << "Destroying AngleData" << endl;
     m_sort_connection.disconnect();
+    m_permutation_connection.disconnect();
     }
 
 /*! \post An angle between particles specified in \a angle is created.
@@ -326,7 +334,7 @@ const GPUArray<uint4>& AngleData::getGPUAngleList()
         {
 #ifdef ENABLE_CUDA
         // update angle table
-        if (exec_conf->isCUDAEnabled())
+        if (m_exec_conf->isCUDAEnabled())
             updateAngleTableGPU();
         else
             updateAngleTable();
@@ -482,6 +490,90 @@ void AngleData::updateAngleTable()
         }
     }
 
+/*! \param order The particle now at index i was previously at index order[i]
+
+    An up to date angle table on the host is reordered along with the particles instead of being rebuilt, see
+    BondData::slotParticlePermutation().
+*/
+void AngleData::slotParticlePermutation(const std::vector<unsigned int>& order)
+    {
+    if (m_angles_dirty || m_angles.size() == 0)
+        return;
+
+#ifdef ENABLE_CUDA
+    if (m_exec_conf->isCUDAEnabled())
+        return;
+#endif
+
+    unsigned int N = m_pdata->getN();
+        {
+        ArrayHandle<unsigned int> h_n_angles(m_n_angles, access_location::host, access_mode::readwrite);
+        ArrayHandle<uint4> h_gpu_anglelist(m_gpu_anglelist, access_location::host, access_mode::readwrite);
+
+        invert_sort_order(m_inverse_order, order, N);
+        permute_particle_counts(h_n_angles.data, m_old_n_angles, order, N);
+        permute_particle_table(h_gpu_anglelist.data,
+                               m_gpu_anglelist.getPitch(),
+                               m_old_n_angles,
+                               order,
+                               N,
+                               remap_angle_entry(sort_index_map(N > 0 ? &m_inverse_order[0] : NULL, N)),
+                               m_anglelist_scratch);
+        }
+
+    if (m_validate_permutation)
+        validatePermutedTable();
+
+    m_table_permuted = true;
+    }
+
+/*! The reordered table is copied and compared with the table that updateAngleTable() builds from the list of angles.
+    This costs as much as the rebuild that the reordering saves and is only meant for debugging, see
+    setPermutationValidation().
+*/
+void AngleData::validatePermutedTable()
+    {
+    unsigned int N = m_pdata->getN();
+    if (N == 0)
+        return;
+
+    unsigned int pitch = m_gpu_anglelist.getPitch();
+    std::vector<unsigned int> n_angles(N);
+    std::vector<uint4> anglelist(pitch*m_gpu_anglelist.getHeight());
+        {
+        ArrayHandle<unsigned int> h_n_angles(m_n_angles, access_location::host, access_mode::read);
+        ArrayHandle<uint4> h_gpu_anglelist(m_gpu_anglelist, access_location::host, access_mode::read);
+        memcpy(&n_angles[0], h_n_angles.data, sizeof(unsigned int)*N);
+        memcpy(&anglelist[0], h_gpu_anglelist.data, sizeof(uint4)*anglelist.size());
+        }
+
+    updateAngleTable();
+
+    ArrayHandle<unsigned int> h_n_angles(m_n_angles, access_location::host, access_mode::read);
+    ArrayHandle<uint4> h_gpu_anglelist(m_gpu_anglelist, access_location::host, access_mode::read);
+    unsigned int n_differ = N;
+    if (m_gpu_anglelist.getPitch() == pitch)
+        n_differ = compare_particle_tables(&n_angles[0], &anglelist[0], h_n_angles.data, h_gpu_anglelist.data,
+                                           pitch, N);
+    if (n_differ)
+        {
+        m_exec_conf->msg->error() << "The reordered angle table of " << n_differ << " particles differs from a full rebuild"
+                                  << endl << endl;
+        throw runtime_error("Error reordering angle table");
+        }
+    }
+
+/*! A sort that has already been applied to the angle table by slotParticlePermutation() leaves it valid, any other
+    reordering of the particles requires a full rebuild.
+*/
+void AngleData::slotParticleSort()
+    {
+    if (m_table_permuted)
+        m_table_permuted = false;
+    else
+        m_angles_dirty = true;
+    }
+
 /*! \param height Height for the angle table
 */
 void AngleData::allocateAngleTable(int height)
@@ -562,6 +654,7 @@ void export_AngleData()
     .def("takeSnapshot", &AngleData::takeSnapshot)
     .def("initializeFromSnapshot", &AngleData::initializeFromSnapshot)
     .def("addAngleType", &AngleData::addAngleType)
+    .def("setPermutationValidation", &AngleData::setPermutationValidation)
     ;
     
     class_<Angle>("Angle", init<unsigned int, unsigned int, unsigned int, unsigned int>())
@@ -268,9 +268,19 @@ class AngleData : boost::noncopyable
         
         //! Initialize the angle data from a snapshot
         void initializeFromSnapshot(const SnapshotAngleData& snapshot);
+
+        //! Set whether an angle table reordered along with a sort is checked against a full rebuild
+        /*! \param validate True to rebuild the table after every reordering and compare, for debugging
+        */
+        void setPermutationValidation(bool validate)
+            {
+            m_validate_permutation = validate;
+            }
         
     private:
         bool m_angles_dirty;                            //!< True if the angle list has been changed
+        bool m_table_permuted;                          //!< True if the angle table has been reordered along with a sort
+        bool m_validate_permutation;                    //!< True if a reordered angle table is checked against a rebuild
         boost::shared_ptr<ParticleData> m_pdata;        //!< Particle Data these angles belong to
         boost::shared_ptr<const ExecutionConfiguration> exec_conf;  //!< Execution configuration for CUDA context
         GPUVector<uint3> m_angles;                      //!< List of angles
@@ -281,6 +291,7 @@ class AngleData : boost::noncopyable
         std::vector<std::string> m_angle_type_mapping;  //!< Mapping between angle type indices and names
         
         boost::signals::connection m_sort_connection;   //!< Connection to the resort signal from ParticleData
+        boost::signals::connection m_permutation_connection; //!< Connection to the sort permutation signal from ParticleData
 
         boost::shared_ptr<const ExecutionConfiguration> m_exec_conf;    //!< execution configuration for working with CUDA
         
@@ -292,6 +303,19 @@ class AngleData : boost::noncopyable
             {
             m_angles_dirty = true;
             }
+
+        //! Helper function called when the particles are sorted
+        void slotParticleSort();
+
+        //! Helper function to reorder the angle table along with a particle sort
+        void slotParticlePermutation(const std::vector<unsigned int>& order);
+
+        //! Helper function to compare a reordered angle table with a full rebuild
+        void validatePermutedTable();
+
+        std::vector<unsigned int> m_inverse_order;      //!< Scratch space for the inverse sort order
+        std::vector<unsigned int> m_old_n_angles;       //!< Scratch space for the angle counts before a sort
+        std::vector<uint4> m_anglelist_scratch;         //!< Scratch space for the angle table before a sort
             
         GPUArray<uint4> m_gpu_anglelist;    //!< List of angles on the GPU
         GPUArray<unsigned int> m_n_angles;  //!< Host copy of the number of angles
@@ -57,6 +57,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "BondData.h"
 #include "ParticleData.h"
+#include "PermuteParticleTable.h"
 #include "Profiler.h"
 
 #include <boost/python.hpp>
@@ -82,7 +83,7 @@ using namespace std;
     \param n_bond_types Number of bond types in the list
 */
 BondData::BondData(boost::shared_ptr<ParticleData> pdata, unsigned int n_bond_types) 
-    : m_bonds_dirty(false),
+    : m_bonds_dirty(false), m_table_permuted(false), m_validate_permutation(false),
       m_pdata(pdata), exec_conf(m_pdata->getExecConf()),
       m_bonds(exec_conf), m_bond_type(exec_conf), m_tags(exec_conf), m_bond_rtag(exec_conf)
 #ifdef ENABLE_CUDA
@@ -94,8 +95,9 @@ BondData::BondData(boost::shared_ptr<ParticleData> pdata, unsigned int n_bond_ty
     m_exec_conf = m_pdata->getExecConf();
     m_exec_conf->msg->notice(5) << "Constructing BondData" << endl;
 
-    // attach to the signal for notifications of particle sorts
-    m_sort_connection = m_pdata->connectParticleSort(bind(&BondData::setDirty, this));
+    // attach to the signals for notifications of particle sorts
+    m_sort_connection = m_pdata->connectParticleSort(bind(&BondData::slotParticleSort, this));
+    m_permutation_connection = m_pdata->connectParticlePermutation(bind(&BondData::slotParticlePermutation, this, _1));
 
     // attach to max particle num change connection
     m_max_particle_num_change_connection = m_pdata->connectMaxParticleNumberChange(bind(&BondData::reallocate, this));
@@ -129,7 +131,7 @@ BondData::BondData(boost::shared_ptr<ParticleData> pdata, unsigned int n_bond_ty
  * \param snapshot SnapshotBondData that contains the bond information
 */
 BondData::BondData(boost::shared_ptr<ParticleData> pdata, const SnapshotBondData& snapshot) 
-    : m_bonds_dirty(false),
+    : m_bonds_dirty(false), m_table_permuted(false), m_validate_permutation(false),
       m_pdata(pdata), exec_conf(m_pdata->getExecConf()),
       m_bonds(exec_conf), m_bond_type(exec_conf), m_tags(exec_conf), m_bond_rtag(exec_conf),
 #ifdef ENABLE_CUDA
@@ -142,8 +144,9 @@ BondData::BondData(boost::shared_ptr<ParticleData> pdata, const SnapshotBondData
     m_exec_conf = m_pdata->getExecConf();
     m_exec_conf->msg->notice(5) << "Constructing BondData" << endl;
 
-    // attach to the signal for notifications of particle sorts
-    m_sort_connection = m_pdata->connectParticleSort(bind(&BondData::setDirty, this));
+    // attach to the signals for notifications of particle sorts
+    m_sort_connection = m_pdata->connectParticleSort(bind(&BondData::slotParticleSort, this));
+    m_permutation_connection = m_pdata->connectParticlePermutation(bind(&BondData::slotParticlePermutation, this, _1));
 
     // attach to max particle num change connection
     m_max_particle_num_change_connection = m_pdata->connectMaxParticleNumberChange(bind(&BondData::reallocate, this));
@@ -168,6 +171,7 @@ BondData::~BondData()
     {
     m_exec_conf->msg->notice(5) << "Destroying BondData" << endl;
     m_sort_connection.disconnect();
+    m_permutation_connection.disconnect();
     m_max_particle_num_change_connection.disconnect();
     m_ghost_particle_num_change_connection.disconnect();
     }
@@ -584,6 +588,97 @@ void BondData::updateBondTable()
         }
     }
 
+/*! \param order The particle now at index i was previously at index order[i]
+
+    An up to date bond table on the host is reordered along with the particles, which avoids the two passes over all
+    bonds with random reverse-tag lookups that updateBondTable() needs. The result is identical to a full rebuild.
+    If the table needs a rebuild anyway, or lives on the GPU, nothing is done here and the table is rebuilt on the
+    next access.
+*/
+void BondData::slotParticlePermutation(const std::vector<unsigned int>& order)
+    {
+    if (m_bonds_dirty || m_bonds.size() == 0)
+        return;
+
+#ifdef ENABLE_CUDA
+    if (exec_conf->isCUDAEnabled())
+        return;
+#endif
+
+    if (m_prof)
+        m_prof->push("permute btable");
+
+    unsigned int N = m_pdata->getN();
+        {
+        ArrayHandle<unsigned int> h_n_bonds(m_n_bonds, access_location::host, access_mode::readwrite);
+        ArrayHandle<uint2> h_gpu_bondlist(m_gpu_bondlist, access_location::host, access_mode::readwrite);
+
+        invert_sort_order(m_inverse_order, order, N);
+        permute_particle_counts(h_n_bonds.data, m_old_n_bonds, order, N);
+        permute_particle_table(h_gpu_bondlist.data,
+                               m_gpu_bondlist.getPitch(),
+                               m_old_n_bonds,
+                               order,
+                               N,
+                               remap_bond_entry(sort_index_map(N > 0 ? &m_inverse_order[0] : NULL, N)),
+                               m_bondlist_scratch);
+        }
+
+    if (m_validate_permutation)
+        validatePermutedTable();
+
+    m_table_permuted = true;
+
+    if (m_prof)
+        m_prof->pop();
+    }
+
+/*! The reordered table is copied and compared with the table that updateBondTable() builds from the list of bonds.
+    This costs as much as the rebuild that the reordering saves and is only meant for debugging, see
+    setPermutationValidation().
+*/
+void BondData::validatePermutedTable()
+    {
+    unsigned int N = m_pdata->getN();
+    if (N == 0)
+        return;
+
+    unsigned int pitch = m_gpu_bondlist.getPitch();
+    std::vector<unsigned int> n_bonds(N);
+    std::vector<uint2> bondlist(pitch*m_gpu_bondlist.getHeight());
+        {
+        ArrayHandle<unsigned int> h_n_bonds(m_n_bonds, access_location::host, access_mode::read);
+        ArrayHandle<uint2> h_gpu_bondlist(m_gpu_bondlist, access_location::host, access_mode::read);
+        memcpy(&n_bonds[0], h_n_bonds.data, sizeof(unsigned int)*N);
+        memcpy(&bondlist[0], h_gpu_bondlist.data, sizeof(uint2)*bondlist.size());
+        }
+
+    updateBondTable();
+
+    ArrayHandle<unsigned int> h_n_bonds(m_n_bonds, access_location::host, access_mode::read);
+    ArrayHandle<uint2> h_gpu_bondlist(m_gpu_bondlist, access_location::host, access_mode::read);
+    unsigned int n_differ = N;
+    if (m_gpu_bondlist.getPitch() == pitch)
+        n_differ = compare_particle_tables(&n_bonds[0], &bondlist[0], h_n_bonds.data, h_gpu_bondlist.data, pitch, N);
+    if (n_differ)
+        {
+        m_exec_conf->msg->error() << "The reordered bond table of " << n_differ << " particles differs from a full rebuild"
+                                  << endl << endl;
+        throw runtime_error("Error reordering bond table");
+        }
+    }
+
+/*! A sort that has already been applied to the bond table by slotParticlePermutation() leaves it valid, any other
+    reordering of the particles requires a full rebuild.
+*/
+void BondData::slotParticleSort()
+    {
+    if (m_table_permuted)
+        m_table_permuted = false;
+    else
+        m_bonds_dirty = true;
+    }
+
 //! Helper function to reallocate the GPU bond table
 void BondData::reallocate()
     {
@@ -1015,6 +1110,7 @@ void export_BondData()
     .def("takeSnapshot", &BondData::takeSnapshot)
     .def("initializeFromSnapshot", &BondData::initializeFromSnapshot)
     .def("addBondType", &BondData::addBondType)
+    .def("setPermutationValidation", &BondData::setPermutationValidation)
     ;
     
     class_<SnapshotBondData, boost::shared_ptr<SnapshotBondData> >
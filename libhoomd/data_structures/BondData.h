@@ -313,8 +313,18 @@ class BondData : boost::noncopyable
         //! Helper function to reallocate the GPU bond table
         void reallocate();
 
+        //! Set whether a bond table reordered along with a sort is checked against a full rebuild
+        /*! \param validate True to rebuild the table after every reordering and compare, for debugging
+        */
+        void setPermutationValidation(bool validate)
+            {
+            m_validate_permutation = validate;
+            }
+
     private:
         bool m_bonds_dirty;                             //!< True if the bond list has been changed
+        bool m_table_permuted;                          //!< True if the bond table has been reordered along with a sort
+        bool m_validate_permutation;                    //!< True if a reordered bond table is checked against a rebuild
         boost::shared_ptr<ParticleData> m_pdata;        //!< Particle Data these bonds belong to
         boost::shared_ptr<const ExecutionConfiguration> exec_conf;  //!< Execution configuration for CUDA context
         GPUVector<uint2> m_bonds;                       //!< List of bonds (x: tag a, y: tag b)
@@ -325,6 +335,7 @@ class BondData : boost::noncopyable
         std::vector<std::string> m_bond_type_mapping;   //!< Mapping between bond type indices and names
         
         boost::signals::connection m_sort_connection;   //!< Connection to the resort signal from ParticleData
+        boost::signals::connection m_permutation_connection; //!< Connection to the sort permutation signal from ParticleData
         boost::signals::connection m_max_particle_num_change_connection; //!< Connection to maximum particle number change signal
         boost::signals::connection m_ghost_particle_num_change_connection; //!< Connection to ghost particle number change signal
 
@@ -339,6 +350,19 @@ class BondData : boost::noncopyable
             {
             m_bonds_dirty = true;
             }
+
+        //! Helper function called when the particles are sorted
+        void slotParticleSort();
+
+        //! Helper function to reorder the bond table along with a particle sort
+        void slotParticlePermutation(const std::vector<unsigned int>& order);
+
+        //! Helper function to compare a reordered bond table with a full rebuild
+        void validatePermutedTable();
+
+        std::vector<unsigned int> m_inverse_order;      //!< Scratch space for the inverse sort order
+        std::vector<unsigned int> m_old_n_bonds;        //!< Scratch space for the bond counts before a sort
+        std::vector<uint2> m_bondlist_scratch;          //!< Scratch space for the bond table before a sort
             
         GPUArray<uint2> m_gpu_bondlist;         //!< List of bonds on the GPU
         GPUArray<unsigned int> m_n_bonds;       //!< Array of the number of bonds
@@ -57,6 +57,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "DihedralData.h"
 #include "ParticleData.h"
+#include "PermuteParticleTable.h"
 
 #include <boost/python.hpp>
 using namespace boost::python;
@@ -66,6 +67,7 @@ using namespace boost;
 
 #include <iostream>
 #include <stdexcept>
+#include <algorithm>
 using namespace std;
 
 /*! \file DihedralData.cc
@@ -77,6 +79,8 @@ using namespace std;
 */
 DihedralData::DihedralData(boost::shared_ptr<ParticleData> pdata, unsigned int n_dihedral_types) 
     :  m_dihedrals_dirty(false),
+          m_table_permuted(false),
+          m_validate_permutation(false),
        m_pdata(pdata),
        exec_conf(m_pdata->getExecConf()),
        m_dihedrals(exec_conf),
@@ -88,8 +92,9 @@ DihedralData::DihedralData(boost::shared_ptr<ParticleData> pdata, unsigned int n
     m_exec_conf = m_pdata->getExecConf();
     m_exec_conf->msg->notice(5) << "Constructing DihedralData" << endl;
 
-    // attach to the signal for notifications of particle sorts
-    m_sort_connection = m_pdata->connectParticleSort(bind(&DihedralData::setDirty, this));
+    // attach to the signals for notifications of particle sorts
+    m_sort_connection = m_pdata->connectParticleSort(bind(&DihedralData::slotParticleSort, this));
+    m_permutation_connection = m_pdata->connectParticlePermutation(bind(&DihedralData::slotParticlePermutation, this, _1));
     
     // offer a default type mapping
     for (unsigned int i = 0; i < n_dihedral_types; i++)
@@ -111,6 +116,8 @@ DihedralData::DihedralData(boost::shared_ptr<ParticleData> pdata, unsigned int n
 */
 DihedralData::DihedralData(boost::shared_ptr<ParticleData> pdata, const SnapshotDihedralData& snapshot) 
     :  m_dihedrals_dirty(false),
+          m_table_permuted(false),
+          m_validate_permutation(false),
        m_pdata(pdata),
        exec_conf(m_pdata->getExecConf()),
        m_dihedrals(exec_conf),
@@ -122,8 +129,9 @@ DihedralData::DihedralData(boost::shared_ptr<ParticleData> pdata, const Snapshot
     m_exec_conf = m_pdata->getExecConf();
     m_exec_conf->msg->notice(5) << "Constructing DihedralData" << endl;
 
-    // attach to the signal for notifications of particle sorts
-    m_sort_connection = m_pdata->connectParticleSort(bind(&DihedralData::setDirty, this));
+    // attach to the signals for notifications of particle sorts
+    m_sort_connection = m_pdata->connectParticleSort(bind(&DihedralData::slotParticleSort, this));
+    m_permutation_connection = m_pdata->connectParticlePermutation(bind(&DihedralData::slotParticlePermutation, this, _1));
     
     // allocate memory for the GPU dihedral table
     allocateDihedralTable(1);
@@ -137,6 +145,7 @@ DihedralData::~DihedralData()
     {
     m_exec_conf->msg->notice(5) << "Destroying DihedralData" << endl;
     m_sort_connection.disconnect();
+    m_permutation_connection.disconnect();
     }
 
 /*! \post A dihedral between particles specified in \a dihedral is created.
@@ -319,7 +328,7 @@ const GPUArray<uint4>& DihedralData::getGPUDihedralList()
     if (m_dihedrals_dirty)
         {
 #ifdef ENABLE_CUDA
-        if (exec_conf->isCUDAEnabled())
+        if (m_exec_conf->isCUDAEnabled())
             updateDihedralTableGPU();
         else
             updateDihedralTable();
@@ -337,7 +346,7 @@ const GPUArray<uint1>& DihedralData::getDihedralABCD()
     if (m_dihedrals_dirty)
         {
 #ifdef ENABLE_CUDA
-        if (exec_conf->isCUDAEnabled())
+        if (m_exec_conf->isCUDAEnabled())
             updateDihedralTableGPU();
         else
             updateDihedralTable();
@@ -511,6 +520,102 @@ void DihedralData::updateDihedralTable()
     }
 
 
+/*! \param order The particle now at index i was previously at index order[i]
+
+    An up to date dihedral table on the host is reordered along with the particles instead of being rebuilt, see
+    BondData::slotParticlePermutation().
+*/
+void DihedralData::slotParticlePermutation(const std::vector<unsigned int>& order)
+    {
+    if (m_dihedrals_dirty || m_dihedrals.size() == 0)
+        return;
+
+#ifdef ENABLE_CUDA
+    if (m_exec_conf->isCUDAEnabled())
+        return;
+#endif
+
+    unsigned int N = m_pdata->getN();
+        {
+        ArrayHandle<unsigned int> h_n_dihedrals(m_n_dihedrals, access_location::host, access_mode::readwrite);
+        ArrayHandle<uint4> h_gpu_dihedral_list(m_gpu_dihedral_list, access_location::host, access_mode::readwrite);
+        ArrayHandle<uint1> h_dihedrals_ABCD(m_dihedrals_ABCD, access_location::host, access_mode::readwrite);
+
+        // both tables are indexed with the pitch of the dihedral list, see updateDihedralTable()
+        unsigned int pitch = m_gpu_dihedral_list.getPitch();
+
+        invert_sort_order(m_inverse_order, order, N);
+        permute_particle_counts(h_n_dihedrals.data, m_old_n_dihedrals, order, N);
+        permute_particle_table(h_gpu_dihedral_list.data,
+                               pitch,
+                               m_old_n_dihedrals,
+                               order,
+                               N,
+                               remap_dihedral_entry(sort_index_map(N > 0 ? &m_inverse_order[0] : NULL, N)),
+                               m_dihedral_list_scratch);
+        permute_particle_table(h_dihedrals_ABCD.data, pitch, m_old_n_dihedrals, order, N, remap_none(),
+                               m_dihedrals_ABCD_scratch);
+        }
+
+    if (m_validate_permutation)
+        validatePermutedTable();
+
+    m_table_permuted = true;
+    }
+
+/*! Both reordered tables are copied and compared with the tables that updateDihedralTable() builds from the list of
+    dihedrals. This costs as much as the rebuild that the reordering saves and is only meant for debugging, see
+    setPermutationValidation().
+*/
+void DihedralData::validatePermutedTable()
+    {
+    unsigned int N = m_pdata->getN();
+    if (N == 0)
+        return;
+
+    unsigned int pitch = m_gpu_dihedral_list.getPitch();
+    std::vector<unsigned int> n_dihedrals(N);
+    std::vector<uint4> dihedral_list(pitch*m_gpu_dihedral_list.getHeight());
+    std::vector<uint1> dihedrals_ABCD(pitch*m_gpu_dihedral_list.getHeight());
+        {
+        ArrayHandle<unsigned int> h_n_dihedrals(m_n_dihedrals, access_location::host, access_mode::read);
+        ArrayHandle<uint4> h_gpu_dihedral_list(m_gpu_dihedral_list, access_location::host, access_mode::read);
+        ArrayHandle<uint1> h_dihedrals_ABCD(m_dihedrals_ABCD, access_location::host, access_mode::read);
+        memcpy(&n_dihedrals[0], h_n_dihedrals.data, sizeof(unsigned int)*N);
+        memcpy(&dihedral_list[0], h_gpu_dihedral_list.data, sizeof(uint4)*dihedral_list.size());
+        memcpy(&dihedrals_ABCD[0], h_dihedrals_ABCD.data, sizeof(uint1)*dihedrals_ABCD.size());
+        }
+
+    updateDihedralTable();
+
+    ArrayHandle<unsigned int> h_n_dihedrals(m_n_dihedrals, access_location::host, access_mode::read);
+    ArrayHandle<uint4> h_gpu_dihedral_list(m_gpu_dihedral_list, access_location::host, access_mode::read);
+    ArrayHandle<uint1> h_dihedrals_ABCD(m_dihedrals_ABCD, access_location::host, access_mode::read);
+    unsigned int n_differ = N;
+    if (m_gpu_dihedral_list.getPitch() == pitch)
+        n_differ = std::max(compare_particle_tables(&n_dihedrals[0], &dihedral_list[0], h_n_dihedrals.data,
+                                                    h_gpu_dihedral_list.data, pitch, N),
+                            compare_particle_tables(&n_dihedrals[0], &dihedrals_ABCD[0], h_n_dihedrals.data,
+                                                    h_dihedrals_ABCD.data, pitch, N));
+    if (n_differ)
+        {
+        m_exec_conf->msg->error() << "The reordered dihedral table of " << n_differ
+                                  << " particles differs from a full rebuild" << endl << endl;
+        throw runtime_error("Error reordering dihedral table");
+        }
+    }
+
+/*! A sort that has already been applied to the dihedral table by slotParticlePermutation() leaves it valid, any other
+    reordering of the particles requires a full rebuild.
+*/
+void DihedralData::slotParticleSort()
+    {
+    if (m_table_permuted)
+        m_table_permuted = false;
+    else
+        m_dihedrals_dirty = true;
+    }
+
 /*! \param height Height for the dihedral table
 */
 void DihedralData::allocateDihedralTable(int height)
@@ -607,6 +712,7 @@ void export_DihedralData()
     .def("takeSnapshot", &DihedralData::takeSnapshot)
     .def("initializeFromSnapshot", &DihedralData::initializeFromSnapshot)
     .def("addDihedralType", &DihedralData::addDihedralType)
+    .def("setPermutationValidation", &DihedralData::setPermutationValidation)
     ;
     
     class_<Dihedral>("Dihedral", init<unsigned int, unsigned int, unsigned int, unsigned int, unsigned int>())
@@ -273,9 +273,19 @@ class DihedralData : boost::noncopyable
 
         //! Initialize the angle data from a snapshot
         void initializeFromSnapshot(const SnapshotDihedralData& snapshot);
+
+        //! Set whether a dihedral table reordered along with a sort is checked against a full rebuild
+        /*! \param validate True to rebuild the table after every reordering and compare, for debugging
+        */
+        void setPermutationValidation(bool validate)
+            {
+            m_validate_permutation = validate;
+            }
         
     private:
         bool m_dihedrals_dirty;                             //!< True if the dihedral list has been changed
+        bool m_table_permuted;                              //!< True if the dihedral table has been reordered along with a sort
+        bool m_validate_permutation;                        //!< True if a reordered dihedral table is checked against a rebuild
         boost::shared_ptr<ParticleData> m_pdata;            //!< Particle Data these dihedrals belong to
         boost::shared_ptr<const ExecutionConfiguration> exec_conf;  //!< Execution configuration for CUDA context
         GPUVector<uint4> m_dihedrals;                       //!< List of dihedrals
@@ -286,6 +296,7 @@ class DihedralData : boost::noncopyable
         std::vector<std::string> m_dihedral_type_mapping;   //!< Mapping between dihedral type indices and names
         
         boost::signals::connection m_sort_connection;       //!< Connection to the resort signal from ParticleData
+        boost::signals::connection m_permutation_connection; //!< Connection to the sort permutation signal from ParticleData
 
         boost::shared_ptr<const ExecutionConfiguration> m_exec_conf;    //!< execution configuration for working with CUDA
 
@@ -297,6 +308,20 @@ class DihedralData : boost::noncopyable
             {
             m_dihedrals_dirty = true;
             }
+
+        //! Helper function called when the particles are sorted
+        void slotParticleSort();
+
+        //! Helper function to reorder the dihedral table along with a particle sort
+        void slotParticlePermutation(const std::vector<unsigned int>& order);
+
+        //! Helper function to compare a reordered dihedral table with a full rebuild
+        void validatePermutedTable();
+
+        std::vector<unsigned int> m_inverse_order;      //!< Scratch space for the inverse sort order
+        std::vector<unsigned int> m_old_n_dihedrals;    //!< Scratch space for the dihedral counts before a sort
+        std::vector<uint4> m_dihedral_list_scratch;     //!< Scratch space for the dihedral table before a sort
+        std::vector<uint1> m_dihedrals_ABCD_scratch;    //!< Scratch space for the atom positions before a sort
             
         GPUArray<uint4> m_gpu_dihedral_list;                    //!< List of dihedrals on the GPU (3atoms of a,b,c, or d, plus the type)
         GPUArray<uint1> m_dihedrals_ABCD;                        //!< List of atom positions in the dihedral
@@ -0,0 +1,293 @@
+/*
+Highly Optimized Object-oriented Many-particle Dynamics -- Blue Edition
+(HOOMD-blue) Open Source Software License Copyright 2008-2011 Ames Laboratory
+Iowa State University and The Regents of the University of Michigan All rights
+reserved.
+
+HOOMD-blue may contain modifications ("Contributions") provided, and to which
+copyright is held, by various Contributors who have granted The Regents of the
+University of Michigan the right to modify and/or distribute such Contributions.
+
+You may redistribute, use, and create derivate works of HOOMD-blue, in source
+and binary forms, provided you abide by the following conditions:
+
+* Redistributions of source code must retain the above copyright notice, this
+list of conditions, and the following disclaimer both in the code and
+prominently in any materials provided with the distribution.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions, and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+* All publications and presentations based on HOOMD-blue, including any reports
+or published results obtained, in whole or in part, with HOOMD-blue, will
+acknowledge its use according to the terms posted at the time of submission on:
+http://codeblue.umich.edu/hoomd-blue/citations.html
+
+* Any electronic documents citing HOOMD-Blue will link to the HOOMD-Blue website:
+http://codeblue.umich.edu/hoomd-blue/
+
+* Apart from the above required attributions, neither the name of the copyright
+holder nor the names of HOOMD-blue's contributors may be used to endorse or
+promote products derived from this software without specific prior written
+permission.
+
+Disclaimer
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, AND/OR ANY
+WARRANTIES THAT THIS SOFTWARE IS FREE OF INFRINGEMENT ARE DISCLAIMED.
+
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Maintainer: joaander
+
+/*! \file HOOMDBinaryFormat.cc
+    \brief Defines helpers for the chunked hoomd_bin file format
+*/
+
+#ifdef WIN32
+#pragma warning( push )
+#pragma warning( disable : 4244 4267 )
+#endif
+
+#include "HOOMDBinaryFormat.h"
+
+#include <string.h>
+
+#ifdef ENABLE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+using boost::uint64_t;
+
+//! Size of the file header (magic number and version)
+static const uint64_t file_header_size = 2*sizeof(unsigned int);
+
+//! Size of the frame magic number and frame size that precede every frame
+static const uint64_t frame_header_size = sizeof(unsigned int) + sizeof(uint64_t);
+
+//! Size of the trailer after the frame index
+static const uint64_t trailer_size = sizeof(uint64_t) + sizeof(unsigned int);
+
+/*! \param column Column to fill out, \a name, \a element_size and \a raw_size must be set
+    \param raw Data to encode (\a raw_size bytes)
+    \param compress True if the data should be shuffled and deflated
+
+    If compression is not available or does not make the data smaller, the data is stored as is.
+*/
+void encode_binary_column(BinaryColumn& column, const char *raw, bool compress)
+    {
+    unsigned int es = column.element_size;
+    uint64_t n = es ? column.raw_size / es : 0;
+
+#ifdef ENABLE_ZLIB
+    if (compress && column.raw_size > 0)
+        {
+        // group the bytes of all elements by their significance
+        vector<char> shuffled(column.raw_size);
+        for (unsigned int b = 0; b < es; b++)
+            for (uint64_t i = 0; i < n; i++)
+                shuffled[b*n + i] = raw[i*es + b];
+
+        uLongf stored_size = compressBound(column.raw_size);
+        column.data.resize(stored_size);
+        int retval = compress2((Bytef *)&column.data[0], &stored_size,
+                               (const Bytef *)&shuffled[0], column.raw_size, Z_DEFAULT_COMPRESSION);
+        if (retval == Z_OK && stored_size < column.raw_size)
+            {
+            column.data.resize(stored_size);
+            column.encoding = binary_encoding::shuffle_deflate;
+            return;
+            }
+        }
+#endif
+
+    column.encoding = binary_encoding::raw;
+    column.data.assign(raw, raw + column.raw_size);
+    }
+
+/*! \param column Column to decode
+    \param raw Output buffer of at least \a column.raw_size bytes
+    \returns false if the data could not be decoded
+*/
+bool decode_binary_column(const BinaryColumn& column, char *raw)
+    {
+    if (column.encoding == binary_encoding::raw)
+        {
+        if (column.data.size() != column.raw_size)
+            return false;
+        if (column.raw_size)
+            memcpy(raw, &column.data[0], column.raw_size);
+        return true;
+        }
+
+#ifdef ENABLE_ZLIB
+    if (column.encoding == binary_encoding::shuffle_deflate)
+        {
+        unsigned int es = column.element_size;
+        if (es == 0 || column.raw_size % es != 0)
+            return false;
+        uint64_t n = column.raw_size / es;
+
+        vector<char> shuffled(column.raw_size);
+        uLongf raw_size = column.raw_size;
+        int retval = uncompress((Bytef *)&shuffled[0], &raw_size, (const Bytef *)&column.data[0], column.data.size());
+        if (retval != Z_OK || raw_size != column.raw_size)
+            return false;
+
+        for (unsigned int b = 0; b < es; b++)
+            for (uint64_t i = 0; i < n; i++)
+                raw[i*es + b] = shuffled[b*n + i];
+        return true;
+        }
+#endif
+
+    return false;
+    }
+
+/*! \param f Stream to write to
+    \param column Column to write
+*/
+void write_binary_column(std::ostream& f, const BinaryColumn& column)
+    {
+    unsigned int len = (unsigned int)column.name.size();
+    uint64_t stored_size = column.data.size();
+    f.write((char*)&len, sizeof(unsigned int));
+    f.write(column.name.c_str(), len);
+    f.write((char*)&column.encoding, sizeof(unsigned int));
+    f.write((char*)&column.element_size, sizeof(unsigned int));
+    f.write((char*)&column.raw_size, sizeof(uint64_t));
+    f.write((char*)&stored_size, sizeof(uint64_t));
+    if (stored_size)
+        f.write(&column.data[0], stored_size);
+    }
+
+/*! \param f Stream to read from
+    \param column Column to fill out
+    \returns false if the column could not be read
+*/
+bool read_binary_column(std::istream& f, BinaryColumn& column)
+    {
+    // sizes are checked against the rest of the stream so that a damaged column cannot trigger huge allocations
+    std::streampos start = f.tellg();
+    f.seekg(0, std::ios::end);
+    uint64_t remaining = uint64_t(f.tellg() - start);
+    f.seekg(start);
+
+    unsigned int len = 0;
+    uint64_t stored_size = 0;
+    f.read((char*)&len, sizeof(unsigned int));
+    if (!f.good() || len > remaining)
+        return false;
+    column.name.resize(len);
+    if (len)
+        f.read(&column.name[0], len);
+    f.read((char*)&column.encoding, sizeof(unsigned int));
+    f.read((char*)&column.element_size, sizeof(unsigned int));
+    f.read((char*)&column.raw_size, sizeof(uint64_t));
+    f.read((char*)&stored_size, sizeof(uint64_t));
+    if (!f.good() || stored_size > remaining || stored_size > column.raw_size)
+        return false;
+    column.data.resize(stored_size);
+    if (stored_size)
+        f.read(&column.data[0], stored_size);
+    return f.good();
+    }
+
+/*! \param f Stream to read from
+    \param file_size Size of the file in bytes
+    \param frames Filled out with the time step and offset of every frame
+    \returns The offset just past the last complete frame
+
+    The index at the end of the file is used if it is intact. Otherwise, the frames are found by skipping from one
+    frame header to the next, so that all frames written before an interrupted write can still be read.
+*/
+uint64_t read_binary_frame_index(std::istream& f, uint64_t file_size, std::vector<BinaryFrameEntry>& frames)
+    {
+    frames.clear();
+
+    if (file_size >= file_header_size + trailer_size)
+        {
+        uint64_t index_offset = 0;
+        unsigned int magic = 0;
+        f.clear();
+        f.seekg(file_size - trailer_size, ios_base::beg);
+        f.read((char*)&index_offset, sizeof(uint64_t));
+        f.read((char*)&magic, sizeof(unsigned int));
+
+        if (f.good() && magic == hoomd_bin_index_magic && index_offset >= file_header_size
+            && index_offset + sizeof(unsigned int) <= file_size - trailer_size)
+            {
+            unsigned int n_frames = 0;
+            f.seekg(index_offset, ios_base::beg);
+            f.read((char*)&n_frames, sizeof(unsigned int));
+
+            uint64_t entry_size = sizeof(unsigned int) + sizeof(uint64_t);
+            if (f.good() && index_offset + sizeof(unsigned int) + n_frames*entry_size == file_size - trailer_size)
+                {
+                frames.resize(n_frames);
+                for (unsigned int i = 0; i < n_frames; i++)
+                    {
+                    f.read((char*)&frames[i].timestep, sizeof(unsigned int));
+                    f.read((char*)&frames[i].offset, sizeof(uint64_t));
+                    }
+                if (f.good())
+                    return index_offset;
+                }
+            }
+        }
+
+    // the index is missing or damaged, skip through the frames
+    frames.clear();
+    f.clear();
+    uint64_t offset = file_header_size;
+    while (offset + frame_header_size + sizeof(unsigned int) <= file_size)
+        {
+        unsigned int magic = 0;
+        uint64_t frame_size = 0;
+        BinaryFrameEntry entry;
+        f.seekg(offset, ios_base::beg);
+        f.read((char*)&magic, sizeof(unsigned int));
+        f.read((char*)&frame_size, sizeof(uint64_t));
+        f.read((char*)&entry.timestep, sizeof(unsigned int));
+        if (!f.good() || magic != hoomd_bin_frame_magic || offset + frame_header_size + frame_size > file_size)
+            break;
+
+        entry.offset = offset;
+        frames.push_back(entry);
+        offset += frame_header_size + frame_size;
+        }
+    f.clear();
+    return offset;
+    }
+
+/*! \param f Stream to write to, positioned just past the last frame
+    \param frames Time step and offset of every frame
+*/
+void write_binary_frame_index(std::ostream& f, const std::vector<BinaryFrameEntry>& frames)
+    {
+    uint64_t index_offset = f.tellp();
+    unsigned int n_frames = (unsigned int)frames.size();
+    f.write((char*)&n_frames, sizeof(unsigned int));
+    for (unsigned int i = 0; i < n_frames; i++)
+        {
+        f.write((char*)&frames[i].timestep, sizeof(unsigned int));
+        f.write((char*)&frames[i].offset, sizeof(uint64_t));
+        }
+    f.write((char*)&index_offset, sizeof(uint64_t));
+    f.write((char*)&hoomd_bin_index_magic, sizeof(unsigned int));
+    }
+
+#ifdef WIN32
+#pragma warning( pop )
+#endif
@@ -0,0 +1,154 @@
+/*
+Highly Optimized Object-oriented Many-particle Dynamics -- Blue Edition
+(HOOMD-blue) Open Source Software License Copyright 2008-2011 Ames Laboratory
+Iowa State University and The Regents of the University of Michigan All rights
+reserved.
+
+HOOMD-blue may contain modifications ("Contributions") provided, and to which
+copyright is held, by various Contributors who have granted The Regents of the
+University of Michigan the right to modify and/or distribute such Contributions.
+
+You may redistribute, use, and create derivate works of HOOMD-blue, in source
+and binary forms, provided you abide by the following conditions:
+
+* Redistributions of source code must retain the above copyright notice, this
+list of conditions, and the following disclaimer both in the code and
+prominently in any materials provided with the distribution.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions, and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+* All publications and presentations based on HOOMD-blue, including any reports
+or published results obtained, in whole or in part, with HOOMD-blue, will
+acknowledge its use according to the terms posted at the time of submission on:
+http://codeblue.umich.edu/hoomd-blue/citations.html
+
+* Any electronic documents citing HOOMD-Blue will link to the HOOMD-Blue website:
+http://codeblue.umich.edu/hoomd-blue/
+
+* Apart from the above required attributions, neither the name of the copyright
+holder nor the names of HOOMD-blue's contributors may be used to endorse or
+promote products derived from this software without specific prior written
+permission.
+
+Disclaimer
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, AND/OR ANY
+WARRANTIES THAT THIS SOFTWARE IS FREE OF INFRINGEMENT ARE DISCLAIMED.
+
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Maintainer: joaander
+
+/*! \file HOOMDBinaryFormat.h
+    \brief Declares helpers for the chunked hoomd_bin file format
+*/
+
+#ifdef NVCC
+#error This header cannot be compiled by nvcc
+#endif
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <boost/cstdint.hpp>
+
+#ifndef __HOOMD_BINARY_FORMAT_H__
+#define __HOOMD_BINARY_FORMAT_H__
+
+/*! \page page_chunked_bin Chunked hoomd_bin format
+
+    Version 4 of the hoomd_bin format stores any number of frames in a single file. The file starts with the same
+    magic number as earlier versions, followed by the version (4). Each frame consists of
+
+    - the frame magic number and the size of the rest of the frame in bytes (uint64)
+    - the time step, the number of dimensions, the box lengths (3 doubles), the number of particles and the number
+      of columns
+    - the columns: a name, the encoding, the element size, the raw size (uint64), the stored size (uint64) and the
+      stored data
+
+    Per-particle columns are stored in tag order. Columns are either stored as is, or shuffled (the bytes of all
+    elements are grouped by their significance) and then deflated, which compresses floating point data much
+    better than deflating it directly. All data that is not per-particle is serialized into the \c topology column.
+
+    The frames are followed by an index that lists the time step and file offset of every frame, and a trailer that
+    holds the offset of the index. Readers seek to any frame through the index. A new frame overwrites the old index
+    and is followed by a new one. If the index is damaged, e.g. because a write was interrupted, the frames are found
+    by skipping from one frame to the next.
+*/
+
+//! Version of the chunked hoomd_bin format
+const int hoomd_bin_chunked_version = 4;
+
+//! Magic number at the beginning of every frame
+const unsigned int hoomd_bin_frame_magic = 0x4d524648;
+
+//! Magic number at the end of the frame index
+const unsigned int hoomd_bin_index_magic = 0x58444948;
+
+//! Encodings of a column in a chunked hoomd_bin file
+struct binary_encoding
+    {
+    //! The enum
+    enum Enum
+        {
+        raw = 0,        //!< Data is stored as is
+        shuffle_deflate //!< Bytes are shuffled by significance and then deflated
+        };
+    };
+
+//! A column of data in a frame of a chunked hoomd_bin file
+struct BinaryColumn
+    {
+    std::string name;               //!< Name of the column
+    unsigned int encoding;          //!< How the data is stored (see binary_encoding)
+    unsigned int element_size;      //!< Size of a single element in bytes
+    boost::uint64_t raw_size;       //!< Size of the data in bytes before encoding
+    std::vector<char> data;         //!< The stored data
+
+    //! Returns the number of bytes the column takes up in the file
+    boost::uint64_t getFileSize() const
+        {
+        return sizeof(unsigned int) + name.size() + 2*sizeof(unsigned int) + 2*sizeof(boost::uint64_t) + data.size();
+        }
+    };
+
+//! Entry of the frame index of a chunked hoomd_bin file
+struct BinaryFrameEntry
+    {
+    unsigned int timestep;          //!< Time step of the frame
+    boost::uint64_t offset;         //!< Offset of the frame from the beginning of the file
+    };
+
+//! Encode raw data into a column
+void encode_binary_column(BinaryColumn& column, const char *raw, bool compress);
+
+//! Decode the data of a column
+bool decode_binary_column(const BinaryColumn& column, char *raw);
+
+//! Write a column to a file
+void write_binary_column(std::ostream& f, const BinaryColumn& column);
+
+//! Read a column from a file
+bool read_binary_column(std::istream& f, BinaryColumn& column);
+
+//! Read the frame index of a chunked hoomd_bin file
+boost::uint64_t read_binary_frame_index(std::istream& f,
+                                        boost::uint64_t file_size,
+                                        std::vector<BinaryFrameEntry>& frames);
+
+//! Write the frame index of a chunked hoomd_bin file
+void write_binary_frame_index(std::ostream& f, const std::vector<BinaryFrameEntry>& frames);
+
+#endif
@@ -60,6 +60,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 #include "HOOMDBinaryInitializer.h"
+#include "HOOMDBinaryFormat.h"
 #include "SnapshotSystemData.h"
 
 #include <iostream>
@@ -71,6 +72,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 using namespace std;
 
 #include <boost/python.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/iostreams/device/file.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #ifdef ENABLE_ZLIB
@@ -81,22 +83,55 @@ using namespace boost::python;
 using namespace boost;
 using namespace boost::iostreams;
 
+//! Helper function to check if a file is in the chunked format
+static bool is_chunked_file(const string &fname)
+    {
+    ifstream f(fname.c_str(), ios::in | ios::binary);
+    unsigned int file_magic = 0;
+    int file_version = 0;
+    f.read((char*)&file_magic, sizeof(unsigned int));
+    f.read((char*)&file_version, sizeof(int));
+    return f.good() && file_magic == 0x444d4f48 && file_version == hoomd_bin_chunked_version;
+    }
+
 /*! \param ExecutionConfiguration
     \param fname File name with the data to load
+    \param frame Frame to read from a file in the chunked format (negative values count from the end)
+    \param distributed If true, every rank reads its own stripe of the particles
     The file will be read and parsed fully during the constructor call.
 */
 HOOMDBinaryInitializer::HOOMDBinaryInitializer(boost::shared_ptr<const ExecutionConfiguration> exec_conf,
-                                               const std::string &fname)
+                                               const std::string &fname,
+                                               int frame,
+                                               bool distributed)
     : m_exec_conf(exec_conf),
-      m_timestep(0)
+      m_timestep(0),
+      m_num_frames(1),
+      m_distributed(distributed && exec_conf->getNRanks() > 1),
+      m_nglobal(0),
+      m_first(0),
+      m_last(0)
     {
-    // execute only on rank zero
-    if (m_exec_conf->getRank()) return;
+    // unless the particles are read in stripes, execute only on rank zero
+    if (m_exec_conf->getRank() && !m_distributed) return;
 
     // initialize member variables
     m_num_dimensions = 3;
     // read in the file
-    readFile(fname);
+    if (is_chunked_file(fname))
+        readChunkedFile(fname, frame);
+    else
+        {
+        if (frame != 0 && frame != -1)
+            {
+            m_exec_conf->msg->error() << endl << fname << " holds a single frame, cannot read frame " << frame
+                                      << endl << endl;
+            throw runtime_error("Error reading binary file");
+            }
+        readFile(fname);
+        }
+
+    printSummary();
     }
 
 /* XXX: shouldn't the following methods be put into
@@ -120,8 +155,8 @@ boost::shared_ptr<SnapshotSystemData> HOOMDBinaryInitializer::getSnapshot() cons
     {
     boost::shared_ptr<SnapshotSystemData> snapshot(new SnapshotSystemData());
     
-    // execute only on rank zero
-    if (m_exec_conf->getRank()) return snapshot;
+    // unless the particles are read in stripes, execute only on rank zero
+    if (m_exec_conf->getRank() && !m_distributed) return snapshot;
 
     // init dimensions
     snapshot->dimensions = m_num_dimensions;
@@ -135,10 +170,17 @@ boost::shared_ptr<SnapshotSystemData> HOOMDBinaryInitializer::getSnapshot() cons
     // resize snapshot
     pdata.resize(m_x_array.size());
 
+    // a distributed read holds a stripe of the particles in file order, along with their tags
+    if (m_distributed)
+        {
+        pdata.global_size = m_nglobal;
+        pdata.tag = m_tag_array;
+        }
+
     // loop through all the particles and set them up
     for (unsigned int i = 0; i < pdata.size; i++)
         {
-        unsigned int rtag = m_rtag_array[i];
+        unsigned int rtag = m_distributed ? i : m_rtag_array[i];
 
         pdata.pos[i] = make_scalar3(m_x_array[rtag], m_y_array[rtag], m_z_array[rtag]);
         pdata.image[i] = make_int3(m_ix_array[rtag], m_iy_array[rtag], m_iz_array[rtag]);
@@ -250,6 +292,20 @@ boost::shared_ptr<SnapshotSystemData> HOOMDBinaryInitializer::getSnapshot() cons
     return snapshot;
     }
 
+//! Helper function to read the stripe [first, last) of an array of np values
+template<class T> static void read_stripe(istream &f,
+                                          std::vector<T>& values,
+                                          unsigned int np,
+                                          unsigned int first,
+                                          unsigned int last)
+    {
+    values.resize(last - first);
+    f.ignore(std::streamsize(first) * sizeof(T));
+    if (last > first)
+        f.read((char*)&values[0], std::streamsize(last - first) * sizeof(T));
+    f.ignore(std::streamsize(np - last) * sizeof(T));
+    }
+
 //! Helper function to read a string from the file
 static string read_string(istream &f)
     {
@@ -354,39 +410,30 @@ void HOOMDBinaryInitializer::readFile(const string &fname)
     f.read((char*)&Lz, sizeof(Scalar));
     m_box = BoxDim(Lx,Ly,Lz);
     
-    //allocate memory for particle arrays
+    //parse particle arrays, the stripe of this rank is read and the rest is skipped
     unsigned int np = 0;
     f.read((char*)&np, sizeof(unsigned int));
-    m_tag_array.resize(np); m_rtag_array.resize(np);
-    m_x_array.resize(np); m_y_array.resize(np); m_z_array.resize(np);
-    m_ix_array.resize(np); m_iy_array.resize(np); m_iz_array.resize(np);
-    m_vx_array.resize(np); m_vy_array.resize(np); m_vz_array.resize(np);
-    m_ax_array.resize(np); m_ay_array.resize(np); m_az_array.resize(np);
-    m_mass_array.resize(np); 
-    m_diameter_array.resize(np); 
-    m_type_array.resize(np);
-    m_charge_array.resize(np);
-    m_body_array.resize(np);
-    
-    //parse particle arrays
-    f.read((char*)&(m_tag_array[0]), np*sizeof(unsigned int));
-    f.read((char*)&(m_rtag_array[0]), np*sizeof(unsigned int));
-    f.read((char*)&(m_x_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_y_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_z_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_ix_array[0]), np*sizeof(int));
-    f.read((char*)&(m_iy_array[0]), np*sizeof(int));
-    f.read((char*)&(m_iz_array[0]), np*sizeof(int));
-    f.read((char*)&(m_vx_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_vy_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_vz_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_ax_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_ay_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_az_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_mass_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_diameter_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_charge_array[0]), np*sizeof(Scalar));
-    f.read((char*)&(m_body_array[0]), np*sizeof(unsigned int));
+    setStripe(np);
+
+    read_stripe(f, m_tag_array, np, m_first, m_last);
+    // the reverse tags are only needed if all particles are read
+    read_stripe(f, m_rtag_array, np, 0, m_distributed ? 0 : np);
+    read_stripe(f, m_x_array, np, m_first, m_last);
+    read_stripe(f, m_y_array, np, m_first, m_last);
+    read_stripe(f, m_z_array, np, m_first, m_last);
+    read_stripe(f, m_ix_array, np, m_first, m_last);
+    read_stripe(f, m_iy_array, np, m_first, m_last);
+    read_stripe(f, m_iz_array, np, m_first, m_last);
+    read_stripe(f, m_vx_array, np, m_first, m_last);
+    read_stripe(f, m_vy_array, np, m_first, m_last);
+    read_stripe(f, m_vz_array, np, m_first, m_last);
+    read_stripe(f, m_ax_array, np, m_first, m_last);
+    read_stripe(f, m_ay_array, np, m_first, m_last);
+    read_stripe(f, m_az_array, np, m_first, m_last);
+    read_stripe(f, m_mass_array, np, m_first, m_last);
+    read_stripe(f, m_diameter_array, np, m_first, m_last);
+    read_stripe(f, m_charge_array, np, m_first, m_last);
+    read_stripe(f, m_body_array, np, m_first, m_last);
 
     //parse types
     unsigned int ntypes = 0;
@@ -394,7 +441,19 @@ void HOOMDBinaryInitializer::readFile(const string &fname)
     m_type_mapping.resize(ntypes);
     for (unsigned int i = 0; i < ntypes; i++)
         m_type_mapping[i] = read_string(f);
-    f.read((char*)&(m_type_array[0]), np*sizeof(unsigned int));
+    read_stripe(f, m_type_array, np, m_first, m_last);
+
+    // the rest of the file is only read on rank 0
+    if (m_exec_conf->getRank() == 0)
+        readSystemData(f);
+    }
+
+/*! \param f Stream to read from, positioned after the particle types
+    Reads the integrator states, bonds, angles, dihedrals, impropers, walls and rigid bodies.
+*/
+void HOOMDBinaryInitializer::readSystemData(std::istream &f)
+    {
+    unsigned int ntypes = 0;
 
     //parse integrator states
     {
@@ -560,27 +619,180 @@ void HOOMDBinaryInitializer::readFile(const string &fname)
         }
     
     }
-    
+    }
+
+//! Helper function to decode the stripe [first, last) of a column of per-particle data
+/*! Columns are compressed as a whole, so a stripe is cut out of the decoded column.
+*/
+template<class T> static bool decode_column(const BinaryColumn& column,
+                                            std::vector<T>& values,
+                                            unsigned int np,
+                                            unsigned int first,
+                                            unsigned int last)
+    {
+    if (column.element_size != sizeof(T) || column.raw_size != np*sizeof(T))
+        return false;
+
+    if (first == 0 && last == np)
+        {
+        values.resize(np);
+        return decode_binary_column(column, np ? (char *)&values[0] : NULL);
+        }
+
+    std::vector<T> all(np);
+    if (!decode_binary_column(column, np ? (char *)&all[0] : NULL))
+        return false;
+    values.assign(all.begin() + first, all.begin() + last);
+    return true;
+    }
+
+/*! \param fname File name of the chunked hoomd_binary file to read in
+    \param frame Index of the frame to read, negative values count from the last frame backwards
+    \post Internal data arrays and members are filled out from which future calls
+    like getSnapshot() will use to initialize the ParticleData
+*/
+void HOOMDBinaryInitializer::readChunkedFile(const string &fname, int frame)
+    {
+    m_exec_conf->msg->notice(2) << "Reading " << fname << "..." << endl;
+
+    ifstream f(fname.c_str(), ios::in | ios::binary);
+    if (!f.good())
+        {
+        m_exec_conf->msg->error() << endl << "Error opening " << fname << endl << endl;
+        throw runtime_error("Error reading binary file");
+        }
+
+    std::vector<BinaryFrameEntry> frames;
+    read_binary_frame_index(f, filesystem::file_size(fname), frames);
+    m_num_frames = frames.size();
+
+    int n_frames = frames.size();
+    int idx = (frame < 0) ? n_frames + frame : frame;
+    if (idx < 0 || idx >= n_frames)
+        {
+        m_exec_conf->msg->error() << endl << "Frame " << frame << " not found, " << fname << " holds "
+                                  << n_frames << " frames" << endl << endl;
+        throw runtime_error("Error reading binary file");
+        }
+
+    // read the frame header
+    f.clear();
+    f.seekg(frames[idx].offset, ios::beg);
+    unsigned int frame_magic = 0;
+    boost::uint64_t frame_size = 0;
+    f.read((char*)&frame_magic, sizeof(unsigned int));
+    f.read((char*)&frame_size, sizeof(boost::uint64_t));
+    if (frame_magic != hoomd_bin_frame_magic)
+        {
+        m_exec_conf->msg->error() << endl << "Frame " << frame << " in " << fname << " is corrupt" << endl << endl;
+        throw runtime_error("Error reading binary file");
+        }
+
+    unsigned int np = 0, n_columns = 0;
+    double box[3];
+    f.read((char*)&m_timestep, sizeof(unsigned int));
+    f.read((char*)&m_num_dimensions, sizeof(unsigned int));
+    f.read((char*)box, 3*sizeof(double));
+    f.read((char*)&np, sizeof(unsigned int));
+    f.read((char*)&n_columns, sizeof(unsigned int));
+    m_box = BoxDim(Scalar(box[0]), Scalar(box[1]), Scalar(box[2]));
+
+    // the columns are stored in tag order
+    setStripe(np);
+    m_tag_array.resize(m_last - m_first);
+    for (unsigned int i = m_first; i < m_last; i++)
+        m_tag_array[i - m_first] = i;
+    m_rtag_array.resize(m_distributed ? 0 : np);
+    for (unsigned int i = 0; i < m_rtag_array.size(); i++)
+        m_rtag_array[i] = i;
+
+    string topology;
+    bool ok = f.good();
+    for (unsigned int i = 0; i < n_columns && ok; i++)
+        {
+        BinaryColumn column;
+        ok = read_binary_column(f, column);
+        if (!ok)
+            break;
+
+        if (column.name == "position_x") ok = decode_column(column, m_x_array, np, m_first, m_last);
+        else if (column.name == "position_y") ok = decode_column(column, m_y_array, np, m_first, m_last);
+        else if (column.name == "position_z") ok = decode_column(column, m_z_array, np, m_first, m_last);
+        else if (column.name == "image_x") ok = decode_column(column, m_ix_array, np, m_first, m_last);
+        else if (column.name == "image_y") ok = decode_column(column, m_iy_array, np, m_first, m_last);
+        else if (column.name == "image_z") ok = decode_column(column, m_iz_array, np, m_first, m_last);
+        else if (column.name == "velocity_x") ok = decode_column(column, m_vx_array, np, m_first, m_last);
+        else if (column.name == "velocity_y") ok = decode_column(column, m_vy_array, np, m_first, m_last);
+        else if (column.name == "velocity_z") ok = decode_column(column, m_vz_array, np, m_first, m_last);
+        else if (column.name == "acceleration_x") ok = decode_column(column, m_ax_array, np, m_first, m_last);
+        else if (column.name == "acceleration_y") ok = decode_column(column, m_ay_array, np, m_first, m_last);
+        else if (column.name == "acceleration_z") ok = decode_column(column, m_az_array, np, m_first, m_last);
+        else if (column.name == "mass") ok = decode_column(column, m_mass_array, np, m_first, m_last);
+        else if (column.name == "diameter") ok = decode_column(column, m_diameter_array, np, m_first, m_last);
+        else if (column.name == "charge") ok = decode_column(column, m_charge_array, np, m_first, m_last);
+        else if (column.name == "body") ok = decode_column(column, m_body_array, np, m_first, m_last);
+        else if (column.name == "type") ok = decode_column(column, m_type_array, np, m_first, m_last);
+        else if (column.name == "topology")
+            {
+            topology.resize(column.raw_size);
+            ok = decode_binary_column(column, column.raw_size ? &topology[0] : NULL);
+            }
+        else
+            m_exec_conf->msg->warning() << "Ignoring unknown column " << column.name << " in " << fname << endl;
+        }
+
+    if (!ok)
+        {
+        m_exec_conf->msg->error() << endl << "Error reading frame " << frame << " of " << fname << endl << endl;
+        throw runtime_error("Error reading binary file");
+        }
+
+    // every per-particle column is required
+    unsigned int n = m_last - m_first;
+    if (m_x_array.size() != n || m_y_array.size() != n || m_z_array.size() != n ||
+        m_ix_array.size() != n || m_iy_array.size() != n || m_iz_array.size() != n ||
+        m_vx_array.size() != n || m_vy_array.size() != n || m_vz_array.size() != n ||
+        m_ax_array.size() != n || m_ay_array.size() != n || m_az_array.size() != n ||
+        m_mass_array.size() != n || m_diameter_array.size() != n || m_charge_array.size() != n ||
+        m_body_array.size() != n || m_type_array.size() != n || topology.size() == 0)
+        {
+        m_exec_conf->msg->error() << endl << "Frame " << frame << " of " << fname << " is missing columns"
+                                  << endl << endl;
+        throw runtime_error("Error reading binary file");
+        }
+
+    // parse types and everything that is not stored per particle
+    istringstream t(topology, ios::in | ios::binary);
+    unsigned int ntypes = 0;
+    t.read((char*)&ntypes, sizeof(unsigned int));
+    m_type_mapping.resize(ntypes);
+    for (unsigned int i = 0; i < ntypes; i++)
+        m_type_mapping[i] = read_string(t);
+
+    // the rest of the topology is only read on rank 0
+    if (m_exec_conf->getRank() == 0)
+        readSystemData(t);
+    }
+
+/*! Checks that the file contained particles and notifies the user of what has been read
+*/
+void HOOMDBinaryInitializer::printSummary()
+    {
     // check for required items in the file
-    if (m_x_array.size() == 0)
+    if (m_nglobal == 0)
         {
         m_exec_conf->msg->error() << endl << "No particles found in binary file" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_binary file");
         }
         
-    // notify the user of what we have accomplished
+    // notify the user of what we have accomplished, every per-particle array holds all particles
     m_exec_conf->msg->notice(2) << "--- hoomd_binary file read summary" << endl;
-    m_exec_conf->msg->notice(2) << m_x_array.size() << " positions at timestep " << m_timestep << endl;
-    if (m_ix_array.size() > 0)
-        m_exec_conf->msg->notice(2) << m_ix_array.size() << " images" << endl;
-    if (m_vx_array.size() > 0)
-        m_exec_conf->msg->notice(2) << m_vx_array.size() << " velocities" << endl;
-    if (m_mass_array.size() > 0)
-        m_exec_conf->msg->notice(2) << m_mass_array.size() << " masses" << endl;
-    if (m_diameter_array.size() > 0)
-        m_exec_conf->msg->notice(2) << m_diameter_array.size() << " diameters" << endl;
-    if (m_charge_array.size() > 0)
-        m_exec_conf->msg->notice(2) << m_charge_array.size() << " charges" << endl;
+    m_exec_conf->msg->notice(2) << m_nglobal << " positions at timestep " << m_timestep << endl;
+    m_exec_conf->msg->notice(2) << m_nglobal << " images" << endl;
+    m_exec_conf->msg->notice(2) << m_nglobal << " velocities" << endl;
+    m_exec_conf->msg->notice(2) << m_nglobal << " masses" << endl;
+    m_exec_conf->msg->notice(2) << m_nglobal << " diameters" << endl;
+    m_exec_conf->msg->notice(2) << m_nglobal << " charges" << endl;
     m_exec_conf->msg->notice(2) << m_type_mapping.size() <<  " particle types" << endl;
     if (m_integrator_variables.size() > 0)
         m_exec_conf->msg->notice(2) << m_integrator_variables.size() << " integrator states" << endl;
@@ -596,13 +808,37 @@ void HOOMDBinaryInitializer::readFile(const string &fname)
         m_exec_conf->msg->notice(2) << m_walls.size() << " walls" << endl;
     }
 
+/*! \param np Number of particles in the file
+    Every rank of a distributed read keeps an equal, contiguous stripe of the particles, otherwise all are kept.
+*/
+void HOOMDBinaryInitializer::setStripe(unsigned int np)
+    {
+    m_nglobal = np;
+    if (m_distributed)
+        {
+        unsigned int rank = m_exec_conf->getRank();
+        unsigned int size = m_exec_conf->getNRanks();
+        m_first = (unsigned int)((unsigned long long)np * rank / size);
+        m_last = (unsigned int)((unsigned long long)np * (rank + 1) / size);
+        }
+    else
+        {
+        m_first = 0;
+        m_last = np;
+        }
+    }
+
 void export_HOOMDBinaryInitializer()
     {
     class_< HOOMDBinaryInitializer >("HOOMDBinaryInitializer",
         init<boost::shared_ptr<const ExecutionConfiguration>, const string&>())
+        .def(init<boost::shared_ptr<const ExecutionConfiguration>, const string&, int>())
+        .def(init<boost::shared_ptr<const ExecutionConfiguration>, const string&, int, bool>())
         // virtual methods from ParticleDataInitializer are inherited
         .def("getTimeStep", &HOOMDBinaryInitializer::getTimeStep)
         .def("setTimeStep", &HOOMDBinaryInitializer::setTimeStep)
+        .def("getSnapshot", &HOOMDBinaryInitializer::getSnapshot)
+        .def("getNumFrames", &HOOMDBinaryInitializer::getNumFrames)
         ;
     }
 
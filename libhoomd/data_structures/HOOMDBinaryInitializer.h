@@ -89,6 +89,13 @@ class SnapshotSystemData;
     and parses it into internal data structures. The initializer is then ready to be passed
     to ParticleData which will then make the needed calls to copy the data into its representation.
 
+    Files in the chunked format (see \ref page_chunked_bin) hold several frames. Any of them can be selected with
+    the \a frame argument of the constructor, negative values count from the last frame backwards.
+
+    In parallel simulations, the file is normally read on rank 0 only. If \a distributed is set, every rank reads
+    the file, but keeps only its own contiguous stripe of the per-particle arrays, and getSnapshot() returns a
+    partial snapshot that ParticleData distributes to the domains. Everything else is still read on rank 0 only.
+
     HOOMD's XML file format and this class are designed to be very extensible. Parsers for inidividual
     XML nodes are written in separate functions and stored by name in the map \c m_parser_map. As the
     main parser loops through, it reads in xml nodes and fires of parsers from this map to parse each
@@ -102,7 +109,9 @@ class HOOMDBinaryInitializer
     public:
         //! Loads in the file and parses the data
         HOOMDBinaryInitializer(boost::shared_ptr<const ExecutionConfiguration> exec_conf,
-                               const std::string &fname);
+                               const std::string &fname,
+                               int frame=-1,
+                               bool distributed=false);
 
         //! Returns the timestep of the simulation
         virtual unsigned int getTimeStep() const;
@@ -113,10 +122,27 @@ class HOOMDBinaryInitializer
         //! initializes a snapshot with the particle data
         virtual boost::shared_ptr<SnapshotSystemData> getSnapshot() const;
 
+        //! Returns the number of frames in the file
+        unsigned int getNumFrames() const
+            {
+            return m_num_frames;
+            }
+
     private:
         //! Helper function to read the input file
         void readFile(const std::string &fname);        
 
+        //! Helper function to read a frame from a file in the chunked format
+        void readChunkedFile(const std::string &fname, int frame);
+
+        //! Helper function to read the data that is not stored per particle
+        void readSystemData(std::istream &f);
+
+        //! Helper function to print what has been read
+        void printSummary();
+        //! Helper function to set the stripe of particles this rank keeps
+        void setStripe(unsigned int np);
+
         boost::shared_ptr<const ExecutionConfiguration> m_exec_conf; //!< Execution configuration
 
         BoxDim m_box;   //!< Simulation box read from the file
@@ -150,6 +176,7 @@ class HOOMDBinaryInitializer
         std::vector< unsigned int > m_body_array;   //!< Body flag of the particles loaded
         
         unsigned int m_timestep;                    //!< The time stamp
+        unsigned int m_num_frames;                  //!< Number of frames in the file
         unsigned int m_num_dimensions;              //!< Number of dimensions
         std::vector<IntegratorVariables> m_integrator_variables; //!< Integrator variables read in from file
         
@@ -163,6 +190,11 @@ class HOOMDBinaryInitializer
         std::vector< Scalar4 > m_vel;                    //!< n_bodies length 1D array of body velocities
         std::vector< Scalar4 > m_angmom;                 //!< n_bodies length 1D array of angular momenta in the space frame
         std::vector< int3 > m_body_image;                //!< n_bodies length 1D array of the body image
+
+        bool m_distributed;                         //!< True if every rank reads its own stripe of the particles
+        unsigned int m_nglobal;                     //!< Number of particles in the file
+        unsigned int m_first;                       //!< Index of the first particle stored on this rank
+        unsigned int m_last;                        //!< Index past the last particle stored on this rank
     };
 
 //! Exports HOOMDBinaryInitializer to python
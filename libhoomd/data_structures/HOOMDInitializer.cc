@@ -68,25 +68,38 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdexcept>
 #include <sstream>
 #include <algorithm>
+#include <cstdlib>
+#include <cctype>
+#include <climits>
 
 using namespace std;
 
 #include <boost/python.hpp>
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace boost::python;
 
 using namespace boost;
 
 /*! \param fname File name with the data to load
+    \param distributed If true, every rank reads its own stripe of the particles
     The file will be read and parsed fully during the constructor call.
 */
 HOOMDInitializer::HOOMDInitializer(boost::shared_ptr<const ExecutionConfiguration> exec_conf,
-    const std::string &fname)
+    const std::string &fname,
+    bool distributed)
     : m_timestep(0),
-      m_exec_conf(exec_conf)
+      m_exec_conf(exec_conf),
+      m_distributed(distributed && exec_conf->getNRanks() > 1),
+      m_nglobal(0),
+      m_first(0),
+      m_last(UINT_MAX)
     {
-    // we only execute on rank 0
-    if (m_exec_conf->getRank()) return;
+    // unless the particles are read in stripes, we only execute on rank 0
+    if (m_exec_conf->getRank() && !m_distributed) return;
 
     // initialize member variables
     m_box_read = false;
@@ -109,7 +122,27 @@ HOOMDInitializer::HOOMDInitializer(boost::shared_ptr<const ExecutionConfiguratio
     m_parser_map["wall"] = bind(&HOOMDInitializer::parseWallNode, this, _1);
     m_parser_map["orientation"] = bind(&HOOMDInitializer::parseOrientationNode, this, _1);
     m_parser_map["moment_inertia"] = bind(&HOOMDInitializer::parseMomentInertiaNode, this, _1);
-    
+
+    if (m_distributed)
+        {
+        // the topology and the walls are only read on rank 0
+        if (m_exec_conf->getRank())
+            {
+            m_parser_map["bond"] = bind(&XMLStreamReader::skipElement, _1);
+            m_parser_map["angle"] = bind(&XMLStreamReader::skipElement, _1);
+            m_parser_map["dihedral"] = bind(&XMLStreamReader::skipElement, _1);
+            m_parser_map["improper"] = bind(&XMLStreamReader::skipElement, _1);
+            m_parser_map["wall"] = bind(&XMLStreamReader::skipElement, _1);
+            }
+
+        // determine the stripe of particles this rank keeps
+        unsigned int rank = m_exec_conf->getRank();
+        unsigned int size = m_exec_conf->getNRanks();
+        m_nglobal = countParticles(fname);
+        m_first = (unsigned int)((unsigned long long)m_nglobal * rank / size);
+        m_last = (unsigned int)((unsigned long long)m_nglobal * (rank + 1) / size);
+        }
+
     // read in the file
     readFile(fname);
     }
@@ -135,8 +168,8 @@ boost::shared_ptr<SnapshotSystemData> HOOMDInitializer::getSnapshot() const
     {
     boost::shared_ptr<SnapshotSystemData> snapshot(new SnapshotSystemData());
 
-    // we only execute on rank 0
-    if (m_exec_conf->getRank()) return snapshot;
+    // unless the particles are read in stripes, we only execute on rank 0
+    if (m_exec_conf->getRank() && !m_distributed) return snapshot;
 
     // initialize dimensions
     snapshot->dimensions = m_num_dimensions;
@@ -147,12 +180,21 @@ boost::shared_ptr<SnapshotSystemData> HOOMDInitializer::getSnapshot() const
     /*
      * Initialize particle data
      */
-    assert(m_pos_array.size() > 0);
+    assert(m_distributed || m_pos_array.size() > 0);
 
     SnapshotParticleData& pdata = snapshot->particle_data; 
 
     // allocate memory in snapshot
     pdata.resize(m_pos_array.size());
+
+    // a distributed read holds a stripe of the particles
+    if (m_distributed)
+        {
+        pdata.global_size = m_nglobal;
+        pdata.tag.resize(m_pos_array.size());
+        for (unsigned int i = 0; i < m_pos_array.size(); i++)
+            pdata.tag[i] = m_first + i;
+        }
     
     // loop through all the particles and set them up
     for (unsigned int i = 0; i < m_pos_array.size(); i++)
@@ -300,45 +342,271 @@ boost::shared_ptr<SnapshotSystemData> HOOMDInitializer::getSnapshot() const
     return snapshot;
     }
 
+//! Helper function to find the next whitespace separated token
+/*! \param p Position to start at, set to the end of the token
+    \param end End of the text
+    \returns The beginning of the token, or \a end if there are no tokens left
+*/
+static inline const char *next_token(const char *&p, const char *end)
+    {
+    while (p < end && isspace(*p))
+        p++;
+    const char *token = p;
+    while (p < end && !isspace(*p))
+        p++;
+    return token;
+    }
+
+//! Helper function to parse all tokens in a range into consecutive values
+/*! \returns false if a token is not a number, which is then stored in \a bad_token
+*/
+template<class T> static bool parse_range(const char *begin, const char *end, T *values, string& bad_token)
+    {
+    const char *p = begin;
+    for (;;)
+        {
+        const char *token = next_token(p, end);
+        if (token == end)
+            return true;
+        if (!XMLStreamReader::parseNumber(token, p, *values++))
+            {
+            bad_token = string(token, p);
+            return false;
+            }
+        }
+    }
+
+//! Helper function to count the tokens in a range
+static unsigned int count_tokens(const char *begin, const char *end)
+    {
+    unsigned int n = 0;
+    const char *p = begin;
+    while (next_token(p, end) != end)
+        n++;
+    return n;
+    }
+
+//! Helper function to parse all numbers in a block of text
+/*! \param begin Beginning of the block
+    \param end End of the block
+    \param values The numbers are appended to this vector
+    \param bad_token Set to the first token that is not a number
+    \returns false if a token is not a number
+
+    Large blocks are split into one piece per thread at whitespace boundaries. Every thread counts the tokens in its
+    piece, and after the offsets of the pieces are known, parses them directly into their place in \a values.
+*/
+template<class T> static bool parse_numbers(const char *begin, const char *end, std::vector<T>& values,
+                                            string& bad_token)
+    {
+    #ifdef ENABLE_OPENMP
+    int n_threads = omp_get_max_threads();
+    if (n_threads > 1 && end - begin > (1 << 20))
+        {
+        std::vector<const char *> split(n_threads+1);
+        split[0] = begin;
+        split[n_threads] = end;
+        for (int i = 1; i < n_threads; i++)
+            {
+            const char *p = std::max(begin + (end - begin) / n_threads * i, split[i-1]);
+            while (p < end && !isspace(*p))
+                p++;
+            split[i] = p;
+            }
+
+        std::vector<unsigned int> offset(n_threads+1, 0);
+        #pragma omp parallel for schedule(static, 1) num_threads(n_threads)
+        for (int i = 0; i < n_threads; i++)
+            offset[i+1] = count_tokens(split[i], split[i+1]);
+        for (int i = 0; i < n_threads; i++)
+            offset[i+1] += offset[i];
+
+        if (offset[n_threads] == 0)
+            return true;
+
+        size_t first = values.size();
+        values.resize(first + offset[n_threads]);
+
+        std::vector<int> ok(n_threads, 1);
+        std::vector<string> bad_tokens(n_threads);
+        #pragma omp parallel for schedule(static, 1) num_threads(n_threads)
+        for (int i = 0; i < n_threads; i++)
+            ok[i] = parse_range(split[i], split[i+1], &values[first + offset[i]], bad_tokens[i]);
+
+        for (int i = 0; i < n_threads; i++)
+            {
+            if (!ok[i])
+                {
+                bad_token = bad_tokens[i];
+                return false;
+                }
+            }
+        return true;
+        }
+    #endif
+
+    const char *p = begin;
+    for (;;)
+        {
+        const char *token = next_token(p, end);
+        if (token == end)
+            return true;
+
+        T value;
+        if (!XMLStreamReader::parseNumber(token, p, value))
+            {
+            bad_token = string(token, p);
+            return false;
+            }
+        values.push_back(value);
+        }
+    }
+
+//! Helper functions to assemble a record from consecutive values
+static inline void make_record(const Scalar *v, HOOMDInitializer::vec& r)
+    {
+    r = HOOMDInitializer::vec(v[0], v[1], v[2]);
+    }
+
+static inline void make_record(const int *v, HOOMDInitializer::vec_int& r)
+    {
+    r = HOOMDInitializer::vec_int(v[0], v[1], v[2]);
+    }
+
+static inline void make_record(const Scalar *v, Scalar& r)
+    {
+    r = v[0];
+    }
+
+static inline void make_record(const int *v, unsigned int& r)
+    {
+    // handle -1 as NO_BODY
+    r = (v[0] == -1) ? NO_BODY : (unsigned int)v[0];
+    }
+
+static inline void make_record(const Scalar *v, Scalar4& r)
+    {
+    r = make_scalar4(v[0], v[1], v[2], v[3]);
+    }
+
+static inline void make_record(const Scalar *v, InertiaTensor& r)
+    {
+    for (unsigned int i = 0; i < 6; i++)
+        r.components[i] = v[i];
+    }
+
+//! Helper function to get the number of records announced by the \b num attribute of a node
+/*! \param reader Reader positioned at the start of the node
+    \param record_size Number of values per record
+    \returns The value of the attribute, but no more than the rest of the file can hold, or 0 if the attribute is not
+    set or not a number
+
+    Every value takes at least two bytes (one character and a separator), so a bogus or huge \b num cannot make the
+    caller allocate more than the file could possibly fill.
+*/
+static size_t announced_records(const XMLStreamReader& reader, unsigned int record_size)
+    {
+    if (!reader.isAttributeSet("num"))
+        return 0;
+
+    string num = reader.getAttribute("num");
+    unsigned int n = 0;
+    if (!XMLStreamReader::parseNumber(num.data(), num.data() + num.size(), n))
+        return 0;
+    return std::min(size_t(n), (reader.getBytesLeft() + 1) / (2*record_size));
+    }
+
+//! Helper function to read the numbers in the text of a node into an array of records
+/*! \param exec_conf The execution configuration, for error messages
+    \param reader Reader positioned at the start of the node
+    \param record_size Number of values per record
+    \param records The records are appended to this vector
+    \param first Index of the first record to store
+    \param last Index past the last record to store, or UINT_MAX to store all records
+    \param n_read Number of records read so far, incremented by the number of records in the node
+
+    The text is parsed block by block, so at most one block of values is held in memory at any time. If the node
+    has a valid \b num attribute, the records are allocated in one go. An incomplete record at the end is ignored.
+    Records outside of [\a first, \a last) are counted, but not stored, and blocks that hold none of the stored
+    records are not parsed at all.
+*/
+template<class T, class Record> static void read_records(boost::shared_ptr<const ExecutionConfiguration> exec_conf,
+                                                         XMLStreamReader& reader,
+                                                         unsigned int record_size,
+                                                         std::vector<Record>& records,
+                                                         size_t first,
+                                                         size_t last,
+                                                         size_t& n_read)
+    {
+    string name = reader.getName();
+    records.reserve(records.size() + std::min(announced_records(reader, record_size), last - first));
+
+    bool striped = first > 0 || last < UINT_MAX;
+
+    std::vector<T> values;
+    string bad_token;
+    const char *begin, *end;
+    while (reader.readText(begin, end))
+        {
+        if (striped)
+            {
+            size_t n_values = values.size() + count_tokens(begin, end);
+            size_t n_touched = (n_values + record_size - 1) / record_size;
+            if (n_read + n_touched <= first || n_read >= last)
+                {
+                // values of an incomplete record only need to be counted
+                n_read += n_values / record_size;
+                values.assign(n_values % record_size, T());
+                continue;
+                }
+            }
+
+        if (!parse_numbers(begin, end, values, bad_token))
+            {
+            exec_conf->msg->error() << endl << "Invalid value " << bad_token << " in <" << name << "> node near line "
+                                    << reader.getLine() << endl << endl;
+            throw runtime_error("Error extracting data from hoomd_xml file");
+            }
+
+        // values of an incomplete record are kept for the next block
+        size_t n_records = values.size() / record_size;
+        for (size_t i = 0; i < n_records; i++, n_read++)
+            {
+            if (n_read < first || n_read >= last)
+                continue;
+
+            Record r;
+            make_record(&values[i*record_size], r);
+            records.push_back(r);
+            }
+        values.erase(values.begin(), values.begin() + n_records*record_size);
+        }
+    }
+
 /*! \param fname File name of the hoomd_xml file to read in
     \post Internal data arrays and members are filled out from which futre calls
     like getSnapshot() will use to intialize the ParticleData
 
-    This function implements the main parser loop. It reads in XML nodes from the
-    file one by one and passes them of to parsers registered in \c m_parser_map.
+    This function implements the main parser loop. It streams through the file with an XMLStreamReader and passes
+    the child nodes of the configuration to the parsers registered in \c m_parser_map. Each parser reads its node,
+    including the end tag, so the file never needs to be held in memory as a whole.
 */
 void HOOMDInitializer::readFile(const string &fname)
     {
-    // Create a Root Node and a child node
-    XMLNode root_node;
-    
     // Open the file and read the root element "hoomd_xml"
     m_exec_conf->msg->notice(2) << "Reading " << fname << "..." << endl;
-    XMLResults results;
-    root_node = XMLNode::parseFile(fname.c_str(),"hoomd_xml", &results);
-    
-    // handle errors
-    if (results.error != eXMLErrorNone)
+    XMLStreamReader reader(m_exec_conf, fname);
+
+    if (reader.next() != XMLStreamReader::start_element || reader.getName() != string("hoomd_xml"))
         {
-        // create message
-        if (results.error==eXMLErrorFirstTagNotFound)
-            {
-            m_exec_conf->msg->error() << endl << "Root node of " << fname << " is not <hoomd_xml>" << endl << endl;
-            throw runtime_error("Error reading xml file");
-            }
-            
-        ostringstream error_message;
-        error_message << XMLNode::getError(results.error) << " in file "
-        << fname << " at line " << results.nLine << " col "
-        << results.nColumn;
-        m_exec_conf->msg->error() << endl << error_message.str() << endl << endl;
+        m_exec_conf->msg->error() << endl << "Root node of " << fname << " is not <hoomd_xml>" << endl << endl;
         throw runtime_error("Error reading xml file");
         }
-        
+
     string xml_version;
-    if (root_node.isAttributeSet("version"))
+    if (reader.isAttributeSet("version"))
         {
-        xml_version = root_node.getAttribute("version");
+        xml_version = reader.getAttribute("version");
         }
     else
         {
@@ -369,52 +637,74 @@ void HOOMDInitializer::readFile(const string &fname)
              << "hoomd_xml file with version not in the range 1.0-1.5  specified,"
              << " I don't know how to read this. Continuing anyways." << endl << endl;
              
-    // the file was parsed successfully by the XML reader. Extract the information now
-    // start by checking the number of configurations in the file
-    int num_configurations = root_node.nChildNode("configuration");
-    if (num_configurations == 0)
+    // loop through the child nodes of the root node and extract the configuration
+    int num_configurations = 0;
+    while (reader.next() == XMLStreamReader::start_element)
         {
-        m_exec_conf->msg->error() << endl << "No <configuration> specified in the XML file" << endl << endl;
-        throw runtime_error("Error reading xml file");
+        if (reader.getName() != string("configuration"))
+            {
+            reader.skipElement();
+            continue;
+            }
+
+        num_configurations++;
+        if (num_configurations > 1)
+            {
+            m_exec_conf->msg->error() << endl << "Sorry, the input XML file must have only one configuration" << endl << endl;
+            throw runtime_error("Error reading xml file");
+            }
+
+        // extract the time step
+        if (reader.isAttributeSet("time_step"))
+            {
+            m_timestep = atoi(reader.getAttribute("time_step").c_str());
+            }
+
+        // extract the number of dimensions, or default to 3
+        if (reader.isAttributeSet("dimensions"))
+            {
+            m_num_dimensions = atoi(reader.getAttribute("dimensions").c_str());
+            }
+        else
+            m_num_dimensions = 3;
+
+        // loop through all child nodes of the configuration
+        while (reader.next() == XMLStreamReader::start_element)
+            {
+            // extract the name and call the appropriate node parser, if it exists
+            string name = reader.getName();
+            transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+            std::map< std::string, boost::function< void (XMLStreamReader&) > >::iterator parser;
+            parser = m_parser_map.find(name);
+            if (parser != m_parser_map.end())
+                parser->second(reader);
+            else
+                {
+                m_exec_conf->msg->notice(2) << "Parser for node <" << name << "> not defined, ignoring" << endl;
+                reader.skipElement();
+                }
+            }
         }
-    if (num_configurations > 1)
+
+    if (num_configurations == 0)
         {
-        m_exec_conf->msg->error() << endl << "Sorry, the input XML file must have only one configuration" << endl << endl;
+        m_exec_conf->msg->error() << endl << "No <configuration> specified in the XML file" << endl << endl;
         throw runtime_error("Error reading xml file");
         }
-        
-    // extract the only configuration node
-    XMLNode configuration_node = root_node.getChildNode("configuration");
-    // extract the time step
-    if (configuration_node.isAttributeSet("time_step"))
-        {
-        m_timestep = atoi(configuration_node.getAttribute("time_step"));
-        }
-    
-    // extract the number of dimensions, or default to 3
-    if (configuration_node.isAttributeSet("dimensions"))
-        {
-        m_num_dimensions = atoi(configuration_node.getAttribute("dimensions"));
-        }
-    else
-        m_num_dimensions = 3;
-        
-    // loop through all child nodes of the configuration
-    for (int cur_node=0; cur_node < configuration_node.nChildNode(); cur_node++)
-        {
-        // extract the name and call the appropriate node parser, if it exists
-        XMLNode node = configuration_node.getChildNode(cur_node);
-        string name = node.getName();
-        transform(name.begin(), name.end(), name.begin(), ::tolower);
-        
-        std::map< std::string, boost::function< void (const XMLNode&) > >::iterator parser;
-        parser = m_parser_map.find(name);
-        if (parser != m_parser_map.end())
-            parser->second(node);
-        else
-            m_exec_conf->msg->notice(2) << "Parser for node <" << name << "> not defined, ignoring" << endl;
-        }
-        
+
+    // the number of records in every particle node, which is the same on all ranks of a distributed read
+    size_t n_pos = getNumRecords("position");
+    size_t n_image = getNumRecords("image");
+    size_t n_vel = getNumRecords("velocity");
+    size_t n_mass = getNumRecords("mass");
+    size_t n_diameter = getNumRecords("diameter");
+    size_t n_type = getNumRecords("type");
+    size_t n_body = getNumRecords("body");
+    size_t n_charge = getNumRecords("charge");
+    size_t n_orientation = getNumRecords("orientation");
+    size_t n_moment_inertia = getNumRecords("moment_inertia");
+
     // check for required items in the file
     if (!m_box_read)
         {
@@ -423,87 +713,87 @@ void HOOMDInitializer::readFile(const string &fname)
              << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    if (m_pos_array.size() == 0)
+    if (n_pos == 0)
         {
         m_exec_conf->msg->error() << endl << "No particles defined in <position> node" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    if (m_type_array.size() == 0)
+    if (n_type == 0)
         {
         m_exec_conf->msg->error() << endl << "No particles defined in <type> node" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
         
     // check for potential user errors
-    if (m_vel_array.size() != 0 && m_vel_array.size() != m_pos_array.size())
+    if (n_vel != 0 && n_vel != n_pos)
         {
-        m_exec_conf->msg->error() << endl << m_vel_array.size() << " velocities != " << m_pos_array.size()
+        m_exec_conf->msg->error() << endl << n_vel << " velocities != " << n_pos
              << " positions" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    if (m_mass_array.size() != 0 && m_mass_array.size() != m_pos_array.size())
+    if (n_mass != 0 && n_mass != n_pos)
         {
-        m_exec_conf->msg->error() << endl << m_mass_array.size() << " masses != " << m_pos_array.size()
+        m_exec_conf->msg->error() << endl << n_mass << " masses != " << n_pos
              << " positions" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    if (m_diameter_array.size() != 0 && m_diameter_array.size() != m_pos_array.size())
+    if (n_diameter != 0 && n_diameter != n_pos)
         {
-        m_exec_conf->msg->error() << endl << m_diameter_array.size() << " diameters != " << m_pos_array.size()
+        m_exec_conf->msg->error() << endl << n_diameter << " diameters != " << n_pos
              << " positions" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    if (m_image_array.size() != 0 && m_image_array.size() != m_pos_array.size())
+    if (n_image != 0 && n_image != n_pos)
         {
-        m_exec_conf->msg->error() << endl << m_image_array.size() << " images != " << m_pos_array.size()
+        m_exec_conf->msg->error() << endl << n_image << " images != " << n_pos
              << " positions" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    if (m_type_array.size() != m_pos_array.size())
+    if (n_type != n_pos)
         {
-        m_exec_conf->msg->error() << endl << m_type_array.size() << " type values != " << m_pos_array.size()
+        m_exec_conf->msg->error() << endl << n_type << " type values != " << n_pos
              << " positions" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    if (m_charge_array.size() != 0 && m_charge_array.size() != m_pos_array.size())
+    if (n_charge != 0 && n_charge != n_pos)
         {
-        m_exec_conf->msg->error() << endl << m_charge_array.size() << " charge values != " << m_pos_array.size()
+        m_exec_conf->msg->error() << endl << n_charge << " charge values != " << n_pos
              << " positions" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    if (m_body_array.size() != 0 && m_body_array.size() != m_pos_array.size())
+    if (n_body != 0 && n_body != n_pos)
         {
-        m_exec_conf->msg->error() << endl << m_body_array.size() << " body values != " << m_pos_array.size()
+        m_exec_conf->msg->error() << endl << n_body << " body values != " << n_pos
              << " positions" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    if (m_orientation.size() != 0 && m_orientation.size() != m_pos_array.size())
+    if (n_orientation != 0 && n_orientation != n_pos)
         {
-        m_exec_conf->msg->error() << endl << m_orientation.size() << " orientation values != " << m_pos_array.size()
+        m_exec_conf->msg->error() << endl << n_orientation << " orientation values != " << n_pos
              << " positions" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    if (m_moment_inertia.size() != 0 && m_moment_inertia.size() != m_pos_array.size())
+    if (n_moment_inertia != 0 && n_moment_inertia != n_pos)
         {
-        m_exec_conf->msg->error() << endl << m_moment_inertia.size() << " moment_inertia values != " << m_pos_array.size()
+        m_exec_conf->msg->error() << endl << n_moment_inertia << " moment_inertia values != " << n_pos
              << " positions" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
 
     // notify the user of what we have accomplished
     m_exec_conf->msg->notice(2) << "--- hoomd_xml file read summary" << endl;
-    m_exec_conf->msg->notice(2) << m_pos_array.size() << " positions at timestep " << m_timestep << endl;
-    if (m_image_array.size() > 0)
-        m_exec_conf->msg->notice(2) << m_image_array.size() << " images" << endl;
-    if (m_vel_array.size() > 0)
-        m_exec_conf->msg->notice(2) << m_vel_array.size() << " velocities" << endl;
-    if (m_mass_array.size() > 0)
-        m_exec_conf->msg->notice(2) << m_mass_array.size() << " masses" << endl;
-    if (m_diameter_array.size() > 0)
-        m_exec_conf->msg->notice(2) << m_diameter_array.size() << " diameters" << endl;
+    m_exec_conf->msg->notice(2) << n_pos << " positions at timestep " << m_timestep << endl;
+    if (n_image > 0)
+        m_exec_conf->msg->notice(2) << n_image << " images" << endl;
+    if (n_vel > 0)
+        m_exec_conf->msg->notice(2) << n_vel << " velocities" << endl;
+    if (n_mass > 0)
+        m_exec_conf->msg->notice(2) << n_mass << " masses" << endl;
+    if (n_diameter > 0)
+        m_exec_conf->msg->notice(2) << n_diameter << " diameters" << endl;
     m_exec_conf->msg->notice(2) << m_type_mapping.size() <<  " particle types" << endl;
-    if (m_body_array.size() > 0)
-        m_exec_conf->msg->notice(2) << m_body_array.size() << " particle body values" << endl;        
+    if (n_body > 0)
+        m_exec_conf->msg->notice(2) << n_body << " particle body values" << endl;        
     if (m_bonds.size() > 0)
         m_exec_conf->msg->notice(2) << m_bonds.size() << " bonds" << endl;
     if (m_angles.size() > 0)
@@ -512,26 +802,74 @@ void HOOMDInitializer::readFile(const string &fname)
         m_exec_conf->msg->notice(2) << m_dihedrals.size() << " dihedrals" << endl;
     if (m_impropers.size() > 0)
         m_exec_conf->msg->notice(2) << m_impropers.size() << " impropers" << endl;
-    if (m_charge_array.size() > 0)
-        m_exec_conf->msg->notice(2) << m_charge_array.size() << " charges" << endl;
+    if (n_charge > 0)
+        m_exec_conf->msg->notice(2) << n_charge << " charges" << endl;
     if (m_walls.size() > 0)
         m_exec_conf->msg->notice(2) << m_walls.size() << " walls" << endl;
-    if (m_orientation.size() > 0)
-        m_exec_conf->msg->notice(2) << m_orientation.size() << " orientations" << endl;
-    if (m_moment_inertia.size() > 0)
-        m_exec_conf->msg->notice(2) << m_moment_inertia.size() << " moments of inertia" << endl;
+    if (n_orientation > 0)
+        m_exec_conf->msg->notice(2) << n_orientation << " orientations" << endl;
+    if (n_moment_inertia > 0)
+        m_exec_conf->msg->notice(2) << n_moment_inertia << " moments of inertia" << endl;
+    }
+
+/*! \param name Name of the particle node
+    \returns Number of records in all nodes of that name in the file, including those not stored on this rank
+*/
+size_t HOOMDInitializer::getNumRecords(const std::string& name) const
+    {
+    std::map<std::string, size_t>::const_iterator it = m_num_records.find(name);
+    if (it == m_num_records.end())
+        return 0;
+    return it->second;
+    }
+
+/*! \param fname File name of the hoomd_xml file
+    \returns Number of particles in the \b position nodes of the file
+
+    The tokens are only counted and not parsed, so this pass is much cheaper than reading the file.
+*/
+unsigned int HOOMDInitializer::countParticles(const std::string &fname)
+    {
+    XMLStreamReader reader(m_exec_conf, fname);
+
+    unsigned int n_particles = 0;
+    if (reader.next() != XMLStreamReader::start_element)
+        return 0;
+
+    while (reader.next() == XMLStreamReader::start_element)
+        {
+        if (reader.getName() != string("configuration"))
+            {
+            reader.skipElement();
+            continue;
+            }
+
+        while (reader.next() == XMLStreamReader::start_element)
+            {
+            string name = reader.getName();
+            transform(name.begin(), name.end(), name.begin(), ::tolower);
+            if (name != string("position"))
+                {
+                reader.skipElement();
+                continue;
+                }
+
+            unsigned int n_values = 0;
+            const char *begin, *end;
+            while (reader.readText(begin, end))
+                n_values += count_tokens(begin, end);
+            n_particles += n_values / 3;
+            }
+        }
+
+    return n_particles;
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the information in the attributes of the \b box node
 */
-void HOOMDInitializer::parseBoxNode(const XMLNode &node)
+void HOOMDInitializer::parseBoxNode(XMLStreamReader& reader)
     {
-    // first, verify that this is the box node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("box"));
-    
     // temporary values for extracting attributes as Scalars
     Scalar Lx,Ly,Lz;
     Scalar xy(0.0), xz(0.0), yz(0.0);
@@ -539,51 +877,51 @@ void HOOMDInitializer::parseBoxNode(const XMLNode &node)
     
     // use string streams to extract Lx, Ly, Lz
     // throw exceptions if these attributes are not set
-    if (!node.isAttributeSet("lx"))
+    if (!reader.isAttributeSet("lx"))
         {
         m_exec_conf->msg->error() << endl << "lx not set in <box> node" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    temp.str(node.getAttribute("lx"));
+    temp.str(reader.getAttribute("lx"));
     temp >> Lx;
     temp.clear();
     
-    if (!node.isAttributeSet("ly"))
+    if (!reader.isAttributeSet("ly"))
         {
         m_exec_conf->msg->error() << endl << "ly not set in <box> node" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    temp.str(node.getAttribute("ly"));
+    temp.str(reader.getAttribute("ly"));
     temp >> Ly;
     temp.clear();
     
-    if (!node.isAttributeSet("lz"))
+    if (!reader.isAttributeSet("lz"))
         {
         m_exec_conf->msg->error() << endl << "lz not set in <box> node" << endl << endl;
         throw runtime_error("Error extracting data from hoomd_xml file");
         }
-    temp.str(node.getAttribute("lz"));
+    temp.str(reader.getAttribute("lz"));
     temp >> Lz;
     temp.clear();
  
     // If no tilt factors are provided, they default to zero
-    if (node.isAttributeSet("xy"))
+    if (reader.isAttributeSet("xy"))
         {
-        temp.str(node.getAttribute("xy"));
+        temp.str(reader.getAttribute("xy"));
         temp >> xy;
         temp.clear();
         }
 
-    if (node.isAttributeSet("xz"))
+    if (reader.isAttributeSet("xz"))
         {
-        temp.str(node.getAttribute("xz"));
+        temp.str(reader.getAttribute("xz"));
         temp >> xz;
         temp.clear();
         }
 
-    if (node.isAttributeSet("yz"))
+    if (reader.isAttributeSet("yz"))
         {
-        temp.str(node.getAttribute("yz"));
+        temp.str(reader.getAttribute("yz"));
         temp >> yz;
         temp.clear();
         }
@@ -592,463 +930,306 @@ void HOOMDInitializer::parseBoxNode(const XMLNode &node)
     m_box = BoxDim(Lx,Ly,Lz);
     m_box.setTiltFactors(xy,xz,yz);
     m_box_read = true;
+
+    reader.skipElement();
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b position node and fills out m_pos_array. The number
     of particles in the array is determined dynamically.
 */
-void HOOMDInitializer::parsePositionNode(const XMLNode &node)
+void HOOMDInitializer::parsePositionNode(XMLStreamReader& reader)
     {
-    // check that this is actually a position node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("position"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
-        {
-        Scalar x,y,z;
-        parser >> x >> y >> z;
-        if (parser.good())
-            m_pos_array.push_back(vec(x,y,z));
-        }
+    read_records<Scalar>(m_exec_conf, reader, 3, m_pos_array, m_first, m_last, m_num_records["position"]);
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
-    This function extracts all of the data in a \b image node and fills out m_pos_array. The number
+/*! \param reader Reader positioned at the start of the node
+    This function extracts all of the data in a \b image node and fills out m_image_array. The number
     of particles in the array is determined dynamically.
 */
-void HOOMDInitializer::parseImageNode(const XMLNode& node)
+void HOOMDInitializer::parseImageNode(XMLStreamReader& reader)
     {
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("image"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
-        {
-        int x,y,z;
-        parser >> x >> y >> z;
-        if (parser.good())
-            m_image_array.push_back(vec_int(x,y,z));
-        }
+    read_records<int>(m_exec_conf, reader, 3, m_image_array, m_first, m_last, m_num_records["image"]);
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b velocity node and fills out m_vel_array. The number
     of particles in the array is determined dynamically.
 */
-void HOOMDInitializer::parseVelocityNode(const XMLNode &node)
+void HOOMDInitializer::parseVelocityNode(XMLStreamReader& reader)
     {
-    // check that this is actually a velocity node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("velocity"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
-        {
-        Scalar x,y,z;
-        parser >> x >> y >> z;
-        if (parser.good())
-            m_vel_array.push_back(vec(x,y,z));
-        }
+    read_records<Scalar>(m_exec_conf, reader, 3, m_vel_array, m_first, m_last, m_num_records["velocity"]);
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b mass node and fills out m_mass_array. The number
     of particles in the array is determined dynamically.
 */
-void HOOMDInitializer::parseMassNode(const XMLNode &node)
+void HOOMDInitializer::parseMassNode(XMLStreamReader& reader)
     {
-    // check that this is actually a velocity node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("mass"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
-        {
-        Scalar mass;
-        parser >> mass;
-        if (parser.good())
-            m_mass_array.push_back(mass);
-        }
+    read_records<Scalar>(m_exec_conf, reader, 1, m_mass_array, m_first, m_last, m_num_records["mass"]);
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b diameter node and fills out m_diameter_array. The number
     of particles in the array is determined dynamically.
 */
-void HOOMDInitializer::parseDiameterNode(const XMLNode &node)
+void HOOMDInitializer::parseDiameterNode(XMLStreamReader& reader)
     {
-    // check that this is actually a velocity node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("diameter"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
-        {
-        Scalar diameter;
-        parser >> diameter;
-        if (parser.good())
-            m_diameter_array.push_back(diameter);
-        }
+    read_records<Scalar>(m_exec_conf, reader, 1, m_diameter_array, m_first, m_last, m_num_records["diameter"]);
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b type node and fills out m_type_array. The number
     of particles in the array is determined dynamically.
 */
-void HOOMDInitializer::parseTypeNode(const XMLNode &node)
+void HOOMDInitializer::parseTypeNode(XMLStreamReader& reader)
     {
-    // check that this is actually a type node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("type"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
+    m_type_array.reserve(m_type_array.size() + std::min(announced_records(reader, 1), size_t(m_last - m_first)));
+
+    // every type name is looked up, so that all ranks of a distributed read agree on the type ids
+    size_t& n_read = m_num_records["type"];
+
+    // consecutive particles usually have the same type, so remember the last one
+    string last_name;
+    unsigned int last_id = 0;
+    bool have_last = false;
+
+    const char *begin, *end;
+    while (reader.readText(begin, end))
         {
-        // dynamically determine the particle types
-        string type;
-        parser >> type;
-        if (parser.good())
-            m_type_array.push_back(getTypeId(type));
+        const char *p = begin;
+        for (;;)
+            {
+            // dynamically determine the particle types
+            const char *token = next_token(p, end);
+            if (token == end)
+                break;
+
+            if (!have_last || last_name.compare(0, string::npos, token, p - token) != 0)
+                {
+                last_name.assign(token, p);
+                last_id = getTypeId(last_name);
+                have_last = true;
+                }
+            if (n_read >= m_first && n_read < m_last)
+                m_type_array.push_back(last_id);
+            n_read++;
+            }
         }
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b body node and fills out m_body_array. The number
     of particles in the array is determined dynamically.
 */
-void HOOMDInitializer::parseBodyNode(const XMLNode &node)
+void HOOMDInitializer::parseBodyNode(XMLStreamReader& reader)
     {
-    // check that this is actually a type node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("body"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
+    read_records<int>(m_exec_conf, reader, 1, m_body_array, m_first, m_last, m_num_records["body"]);
+    }
+
+/*! \param reader Reader positioned at the start of the node
+    \param record_size Number of tokens per record
+    \param records Set to the type names and particle indices of the records in the next block
+    \returns false when the end of the node has been reached
+
+    Each record is a type name followed by record_size-1 particle indices. Tokens of an incomplete record at the
+    end of a block are kept in \a tokens for the next call.
+*/
+bool HOOMDInitializer::readTopologyBlock(XMLStreamReader& reader,
+                                         unsigned int record_size,
+                                         std::vector<std::string>& tokens,
+                                         std::vector<unsigned int>& indices)
+    {
+    const char *begin, *end;
+    if (!reader.readText(begin, end))
+        return false;
+
+    // drop the records that were returned by the previous call
+    size_t n_used = (tokens.size() / record_size) * record_size;
+    tokens.erase(tokens.begin(), tokens.begin() + n_used);
+
+    const char *p = begin;
+    for (;;)
         {
-        // handle -1 as NO_BODY
-        int body;
-        parser >> body;
-        
-        if (parser.good())
+        const char *token = next_token(p, end);
+        if (token == end)
+            break;
+        tokens.push_back(string(token, p));
+        }
+
+    size_t n_records = tokens.size() / record_size;
+    indices.resize(n_records*record_size);
+    for (size_t i = 0; i < n_records*record_size; i++)
+        {
+        // the first token of every record is the type name
+        if (i % record_size == 0)
+            continue;
+
+        if (!XMLStreamReader::parseNumber(tokens[i].data(), tokens[i].data() + tokens[i].size(), indices[i]))
             {
-            if (body == -1)
-                m_body_array.push_back(NO_BODY);
-            else
-                m_body_array.push_back(body);
+            m_exec_conf->msg->error() << endl << "Invalid particle index " << tokens[i] << " in <" << reader.getName()
+                                      << "> node near line " << reader.getLine() << endl << endl;
+            throw runtime_error("Error extracting data from hoomd_xml file");
             }
         }
+    return true;
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b bond node and fills out m_bonds. The number
     of bonds in the array is determined dynamically.
 */
-void HOOMDInitializer::parseBondNode(const XMLNode &node)
+void HOOMDInitializer::parseBondNode(XMLStreamReader& reader)
     {
-    // check that this is actually a bond node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("bond"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
+    std::vector<std::string> tokens;
+    std::vector<unsigned int> indices;
+    while (readTopologyBlock(reader, 3, tokens, indices))
         {
-        string type_name;
-        unsigned int a, b;
-        parser >> type_name >> a >> b;
-        if (parser.good())
-            m_bonds.push_back(Bond(getBondTypeId(type_name), a, b));
+        for (size_t i = 0; i < indices.size(); i += 3)
+            m_bonds.push_back(Bond(getBondTypeId(tokens[i]), indices[i+1], indices[i+2]));
         }
     }
 
-void HOOMDInitializer::parseAngleNode(const XMLNode &node)
+/*! \param reader Reader positioned at the start of the node
+    This function extracts all of the data in a \b angle node and fills out m_angles. The number
+    of angles in the array is determined dynamically.
+*/
+void HOOMDInitializer::parseAngleNode(XMLStreamReader& reader)
     {
-    // check that this is actually a angle node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("angle"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
+    std::vector<std::string> tokens;
+    std::vector<unsigned int> indices;
+    while (readTopologyBlock(reader, 4, tokens, indices))
         {
-        string type_name;
-        unsigned int a, b, c;
-        parser >> type_name >> a >> b >> c;
-        if (parser.good())
-            m_angles.push_back(Angle(getAngleTypeId(type_name), a, b, c));
+        for (size_t i = 0; i < indices.size(); i += 4)
+            m_angles.push_back(Angle(getAngleTypeId(tokens[i]), indices[i+1], indices[i+2], indices[i+3]));
         }
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b dihedral node and fills out m_dihedrals. The number
     of dihedrals in the array is determined dynamically.
 */
-void HOOMDInitializer::parseDihedralNode(const XMLNode &node)
+void HOOMDInitializer::parseDihedralNode(XMLStreamReader& reader)
     {
-    // check that this is actually a dihedral node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("dihedral"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
+    std::vector<std::string> tokens;
+    std::vector<unsigned int> indices;
+    while (readTopologyBlock(reader, 5, tokens, indices))
         {
-        string type_name;
-        unsigned int a, b, c, d;
-        parser >> type_name >> a >> b >> c >> d;
-        if (parser.good())
-            m_dihedrals.push_back(Dihedral(getDihedralTypeId(type_name), a, b, c, d));
+        for (size_t i = 0; i < indices.size(); i += 5)
+            m_dihedrals.push_back(Dihedral(getDihedralTypeId(tokens[i]),
+                                           indices[i+1], indices[i+2], indices[i+3], indices[i+4]));
         }
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
-    This function extracts all of the data in a \b dihedral node and fills out m_dihedrals. The number
-    of dihedrals in the array is determined dynamically.
+/*! \param reader Reader positioned at the start of the node
+    This function extracts all of the data in a \b improper node and fills out m_impropers. The number
+    of impropers in the array is determined dynamically.
 */
-void HOOMDInitializer::parseImproperNode(const XMLNode &node)
+void HOOMDInitializer::parseImproperNode(XMLStreamReader& reader)
     {
-    // check that this is actually a improper node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("improper"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
+    std::vector<std::string> tokens;
+    std::vector<unsigned int> indices;
+    while (readTopologyBlock(reader, 5, tokens, indices))
         {
-        string type_name;
-        unsigned int a, b, c, d;
-        parser >> type_name >> a >> b >> c >> d;
-        if (parser.good())
-            m_impropers.push_back(Dihedral(getImproperTypeId(type_name), a, b, c, d));
+        for (size_t i = 0; i < indices.size(); i += 5)
+            m_impropers.push_back(Dihedral(getImproperTypeId(tokens[i]),
+                                           indices[i+1], indices[i+2], indices[i+3], indices[i+4]));
         }
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b charge node and fills out m_charge_array. The number
     of particles in the array is determined dynamically.
 */
-void HOOMDInitializer::parseChargeNode(const XMLNode &node)
+void HOOMDInitializer::parseChargeNode(XMLStreamReader& reader)
     {
-    // check that this is actually a charge node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("charge"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
-        {
-        Scalar charge;
-        parser >> charge;
-        if (parser.good())
-            m_charge_array.push_back(charge);
-        }
+    read_records<Scalar>(m_exec_conf, reader, 1, m_charge_array, m_first, m_last, m_num_records["charge"]);
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b wall node and fills out m_walls. The number
     of walls is dtermined dynamically.
 */
-void HOOMDInitializer::parseWallNode(const XMLNode& node)
+void HOOMDInitializer::parseWallNode(XMLStreamReader& reader)
     {
-    // check that this is actually a wall node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("wall"));
-    
-    for (int cur_node=0; cur_node < node.nChildNode(); cur_node++)
+    while (reader.next() == XMLStreamReader::start_element)
         {
         // check to make sure this is a node type we understand
-        XMLNode child_node = node.getChildNode(cur_node);
-        if (string(child_node.getName()) != string("coord"))
+        if (reader.getName() != string("coord"))
             {
-            m_exec_conf->msg->notice(2) << "Ignoring <" << child_node.getName() << "> node in <wall> node";
+            m_exec_conf->msg->notice(2) << "Ignoring <" << reader.getName() << "> node in <wall> node";
             }
         else
             {
             // extract x,y,z, nx, ny, nz
             Scalar ox,oy,oz,nx,ny,nz;
-            if (!child_node.isAttributeSet("ox"))
+            if (!reader.isAttributeSet("ox"))
                 {
                 m_exec_conf->msg->error() << endl << "ox not set in <coord> node" << endl << endl;
                 throw runtime_error("Error extracting data from hoomd_xml file");
                 }
-            ox = (Scalar)atof(child_node.getAttribute("ox"));
+            ox = (Scalar)atof(reader.getAttribute("ox").c_str());
             
-            if (!child_node.isAttributeSet("oy"))
+            if (!reader.isAttributeSet("oy"))
                 {
                 m_exec_conf->msg->error() << endl << "oy not set in <coord> node" << endl << endl;
                 throw runtime_error("Error extracting data from hoomd_xml file");
                 }
-            oy = (Scalar)atof(child_node.getAttribute("oy"));
+            oy = (Scalar)atof(reader.getAttribute("oy").c_str());
             
-            if (!child_node.isAttributeSet("oz"))
+            if (!reader.isAttributeSet("oz"))
                 {
                 m_exec_conf->msg->error() << endl << "oz not set in <coord> node" << endl << endl;
                 throw runtime_error("Error extracting data from hoomd_xml file");
                 }
-            oz = (Scalar)atof(child_node.getAttribute("oz"));
+            oz = (Scalar)atof(reader.getAttribute("oz").c_str());
             
-            if (!child_node.isAttributeSet("nx"))
+            if (!reader.isAttributeSet("nx"))
                 {
                 m_exec_conf->msg->error() << endl << "nx not set in <coord> node" << endl << endl;
                 throw runtime_error("Error extracting data from hoomd_xml file");
                 }
-            nx = (Scalar)atof(child_node.getAttribute("nx"));
+            nx = (Scalar)atof(reader.getAttribute("nx").c_str());
             
-            if (!child_node.isAttributeSet("ny"))
+            if (!reader.isAttributeSet("ny"))
                 {
                 m_exec_conf->msg->error() << endl << "ny not set in <coord> node" << endl << endl;
                 throw runtime_error("Error extracting data from hoomd_xml file");
                 }
-            ny = (Scalar)atof(child_node.getAttribute("ny"));
+            ny = (Scalar)atof(reader.getAttribute("ny").c_str());
             
-            if (!child_node.isAttributeSet("nz"))
+            if (!reader.isAttributeSet("nz"))
                 {
                 m_exec_conf->msg->error() << endl << "nz not set in <coord> node" << endl << endl;
                 throw runtime_error("Error extracting data from hoomd_xml file");
                 }
-            nz = (Scalar)atof(child_node.getAttribute("nz"));
+            nz = (Scalar)atof(reader.getAttribute("nz").c_str());
             
             m_walls.push_back(Wall(ox,oy,oz,nx,ny,nz));
             }
+
+        reader.skipElement();
         }
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b orientation node and fills out m_orientation. The number
     of particles in the array is determined dynamically.
 */
-void HOOMDInitializer::parseOrientationNode(const XMLNode &node)
+void HOOMDInitializer::parseOrientationNode(XMLStreamReader& reader)
     {
-    // check that this is actually a charge node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("orientation"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
-        {
-        Scalar ox, oy, oz, ow;
-        parser >> ox >> oy >> oz >> ow;
-        if (parser.good())
-            m_orientation.push_back(make_scalar4(ox, oy, oz, ow));
-        }
+    read_records<Scalar>(m_exec_conf, reader, 4, m_orientation, m_first, m_last, m_num_records["orientation"]);
     }
 
-/*! \param node XMLNode passed from the top level parser in readFile
+/*! \param reader Reader positioned at the start of the node
     This function extracts all of the data in a \b moment_inertia node and fills out m_moment_inertia. The number
     of particles in the array is determined dynamically.
 */
-void HOOMDInitializer::parseMomentInertiaNode(const XMLNode &node)
+void HOOMDInitializer::parseMomentInertiaNode(XMLStreamReader& reader)
     {
-    // check that this is actually a charge node
-    string name = node.getName();
-    transform(name.begin(), name.end(), name.begin(), ::tolower);
-    assert(name == string("moment_inertia"));
-    
-    // extract the data from the node
-    string all_text;
-    for (int i = 0; i < node.nText(); i++)
-        all_text += string(node.getText(i)) + string("\n");
-    
-    istringstream parser;
-    parser.str(all_text);
-    while (parser.good())
-        {
-        InertiaTensor I;
-        for (unsigned int i = 0; i < 6; i++)
-            parser >> I.components[i];
-        
-        if (parser.good())
-            m_moment_inertia.push_back(I);
-        }
+    read_records<Scalar>(m_exec_conf, reader, 6, m_moment_inertia,
+                         m_first, m_last, m_num_records["moment_inertia"]);
     }
 
 /*! \param name Name to get type id of
@@ -1139,7 +1320,7 @@ unsigned int HOOMDInitializer::getImproperTypeId(const std::string& name)
 
 void export_HOOMDInitializer()
     {
-    class_< HOOMDInitializer >("HOOMDInitializer", init<boost::shared_ptr<const ExecutionConfiguration>, const string&>())
+    class_< HOOMDInitializer >("HOOMDInitializer", init<boost::shared_ptr<const ExecutionConfiguration>, const string&, bool>())
     .def("getTimeStep", &HOOMDInitializer::getTimeStep)
     .def("setTimeStep", &HOOMDInitializer::setTimeStep)
     .def("getSnapshot", &HOOMDInitializer::getSnapshot)
@@ -63,7 +63,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "BondData.h"
 #include "AngleData.h"
 #include "DihedralData.h"
-#include "xmlParser.h"
+#include "XMLStreamReader.h"
 
 #include <string>
 #include <vector>
@@ -88,11 +88,21 @@ class SnapshotSystemData;
     and parses it into internal data structures. The initializer is then ready to be passed
     to ParticleData which will then make the needed calls to copy the data into its representation.
 
+    The file is read with an XMLStreamReader, which never holds more than a small block of the file in memory.
+    Numbers are parsed straight from these blocks into the internal arrays, in parallel when OpenMP is enabled.
+    The memory needed to read a file is therefore dominated by the arrays themselves.
+
     HOOMD's XML file format and this class are designed to be very extensible. Parsers for inidividual
     XML nodes are written in separate functions and stored by name in the map \c m_parser_map. As the
     main parser loops through, it reads in xml nodes and fires of parsers from this map to parse each
-    of them. Adding a new node to the file format parser is as simple as adding a new node parser function
-    (like parsePositionNode()) and adding it to the map in the constructor.
+    of them. Every parser reads its node up to and including the end tag. Adding a new node to the file format
+    parser is as simple as adding a new node parser function (like parsePositionNode()) and adding it to the map in
+    the constructor.
+
+    In parallel simulations, the file is normally read on rank 0 only. If \a distributed is set, every rank reads
+    the file instead, but keeps only its own contiguous stripe of the particles, and getSnapshot() returns a partial
+    snapshot that ParticleData distributes to the domains. The bonds, angles, dihedrals, impropers and walls are
+    still read on rank 0 only.
 
     \ingroup data_structs
 */
@@ -101,7 +111,8 @@ class HOOMDInitializer
     public:
         //! Loads in the file and parses the data
         HOOMDInitializer(boost::shared_ptr<const ExecutionConfiguration> exec_conf,
-                         const std::string &fname);
+                         const std::string &fname,
+                         bool distributed=false);
 
         //! Returns the timestep of the simulation
         virtual unsigned int getTimeStep() const;
@@ -161,38 +172,50 @@ class HOOMDInitializer
     private:
         //! Helper function to read the input file
         void readFile(const std::string &fname);
+
+        //! Helper function to count the particles in the input file
+        unsigned int countParticles(const std::string &fname);
+
+        //! Helper function to get the number of records read from a particle node
+        size_t getNumRecords(const std::string& name) const;
         //! Helper function to parse the box node
-        void parseBoxNode(const XMLNode& node);
+        void parseBoxNode(XMLStreamReader& reader);
         //! Helper function to parse the position node
-        void parsePositionNode(const XMLNode& node);
+        void parsePositionNode(XMLStreamReader& reader);
         //! Helper function to parse the image node
-        void parseImageNode(const XMLNode& node);
+        void parseImageNode(XMLStreamReader& reader);
         //! Helper function to parse the velocity node
-        void parseVelocityNode(const XMLNode& node);
+        void parseVelocityNode(XMLStreamReader& reader);
         //! Helper function to parse the mass node
-        void parseMassNode(const XMLNode& node);
+        void parseMassNode(XMLStreamReader& reader);
         //! Helper function to parse diameter node
-        void parseDiameterNode(const XMLNode& node);
+        void parseDiameterNode(XMLStreamReader& reader);
         //! Helper function to parse the type node
-        void parseTypeNode(const XMLNode& node);
+        void parseTypeNode(XMLStreamReader& reader);
         //! Helper function to parse the body node
-        void parseBodyNode(const XMLNode& node);
+        void parseBodyNode(XMLStreamReader& reader);
         //! Helper function to parse the bonds node
-        void parseBondNode(const XMLNode& node);
+        void parseBondNode(XMLStreamReader& reader);
         //! Helper function to parse the angle node
-        void parseAngleNode(const XMLNode& node);
+        void parseAngleNode(XMLStreamReader& reader);
         //! Helper function to parse the dihedral node
-        void parseDihedralNode(const XMLNode& node);
+        void parseDihedralNode(XMLStreamReader& reader);
         //! Helper function to parse the improper node
-        void parseImproperNode(const XMLNode& node);
+        void parseImproperNode(XMLStreamReader& reader);
         //! Parse charge node
-        void parseChargeNode(const XMLNode& node);
+        void parseChargeNode(XMLStreamReader& reader);
         //! Parse wall node
-        void parseWallNode(const XMLNode& node);
+        void parseWallNode(XMLStreamReader& reader);
         //! Parse orientation node
-        void parseOrientationNode(const XMLNode& node);
+        void parseOrientationNode(XMLStreamReader& reader);
         //! Parse moment inertia node
-        void parseMomentInertiaNode(const XMLNode& node);
+        void parseMomentInertiaNode(XMLStreamReader& reader);
+        
+        //! Helper function to read a block of bond, angle, dihedral or improper records
+        bool readTopologyBlock(XMLStreamReader& reader,
+                               unsigned int record_size,
+                               std::vector<std::string>& tokens,
+                               std::vector<unsigned int>& indices);
         
         //! Helper function for identifying the particle type id
         unsigned int getTypeId(const std::string& name);
@@ -205,7 +228,7 @@ class HOOMDInitializer
         //! Helper function for identifying the improper type id
         unsigned int getImproperTypeId(const std::string& name);
         
-        std::map< std::string, boost::function< void (const XMLNode&) > > m_parser_map; //!< Map for dispatching parsers based on node type
+        std::map< std::string, boost::function< void (XMLStreamReader&) > > m_parser_map; //!< Map for dispatching parsers based on node type
         
         BoxDim m_box;   //!< Simulation box read from the file
         bool m_box_read;    //!< Stores the box we read in
@@ -236,6 +259,12 @@ class HOOMDInitializer
         std::vector<InertiaTensor> m_moment_inertia;    //!< Inertia tensor for each particle
 
         boost::shared_ptr<const ExecutionConfiguration> m_exec_conf; //!< The execution configuration
+
+        bool m_distributed;                         //!< True if every rank reads its own stripe of the particles
+        unsigned int m_nglobal;                     //!< Number of particles in the file (distributed reads only)
+        unsigned int m_first;                       //!< Index of the first particle stored on this rank
+        unsigned int m_last;                        //!< Index past the last particle stored on this rank
+        std::map<std::string, size_t> m_num_records; //!< Number of records in every particle node of the file
     };
 
 //! Exports HOOMDInitializer to python
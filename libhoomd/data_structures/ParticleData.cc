@@ -65,6 +65,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdexcept>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 using namespace std;
 
@@ -78,6 +79,7 @@ using namespace boost::python;
 
 #ifdef ENABLE_MPI
 #include "HOOMDMPI.h"
+#include "Communicator.h"
 #endif
 
 #include <boost/bind.hpp>
@@ -182,7 +184,7 @@ ParticleData::ParticleData(const SnapshotParticleData& snapshot,
     m_exec_conf->msg->notice(5) << "Constructing ParticleData" << endl;
 
     // initialize number of particles
-    setNGlobal(snapshot.size);
+    setNGlobal(snapshot.global_size ? snapshot.global_size : snapshot.size);
 
     #ifdef ENABLE_MPI
     // Set up domain decomposition information
@@ -280,6 +282,35 @@ void ParticleData::notifyParticleSort()
     m_sort_signal();
     }
 
+/*! \param func Function to call with the permutation when the particles are reordered
+    \return Connection to manage the signal/slot connection
+
+    The function passed in \a func is called every time the ParticleData is notified of a particle sort via
+    notifyParticleSort(const std::vector<unsigned int>&), before the functions connected with connectParticleSort().
+    Its argument is the permutation: the particle now at index i was previously at index order[i]. Classes that
+    cache per-particle data can use it to reorder their data instead of rebuilding it.
+    \note If the caller class is destroyed, it needs to disconnect the signal connection
+    via \b con.disconnect where \b con is the return value of this function.
+*/
+boost::signals::connection ParticleData::connectParticlePermutation(
+    const boost::function<void (const std::vector<unsigned int>&)> &func)
+    {
+    return m_permutation_signal.connect(func);
+    }
+
+/*! \param order The particle now at index i was previously at index order[i], for all i < getN()
+
+    Notifies the listeners connected with connectParticlePermutation() first and then all listeners connected with
+    connectParticleSort(). Use this version when the local particles have only been reordered, and call
+    notifyParticleSort() when particles have been added or removed.
+    \note The call must be made after calling release()
+*/
+void ParticleData::notifyParticleSort(const std::vector<unsigned int>& order)
+    {
+    m_permutation_signal(order);
+    m_sort_signal();
+    }
+
 /*! \param func Function to call when the box size changes
     \return Connection to manage the signal/slot connection
     Calls are performed by using boost::signals. The function passed in
@@ -533,6 +564,14 @@ bool ParticleData::inBox()
     \post the particle data arrays are initialized from the snapshot, in index order
 
     \pre In parallel simulations, the local box size must be set before a call to initializeFromSnapshot().
+
+    In parallel simulations, the snapshot may be
+     - a partial snapshot on every rank (e.g. a stripe of an input file), of which every rank distributes its own part,
+     - marked as replicated and identical on every rank, in which case every rank distributes an equal share of the
+       particles, or
+     - present on rank 0 only (any other snapshot), in which case rank 0 scatters contiguous stripes of it to all ranks first.
+
+    In all cases, the particles are then delivered to their owning domains by initializeFromSnapshotDistributed().
  */
 void ParticleData::initializeFromSnapshot(const SnapshotParticleData& snapshot)
     {
@@ -547,190 +586,53 @@ void ParticleData::initializeFromSnapshot(const SnapshotParticleData& snapshot)
 #ifdef ENABLE_MPI
     if (m_decomposition)
         {
-        // gather box information from all processors
-        unsigned int root = 0;
-
-        // Define per-processor particle data
-        std::vector< std::vector<Scalar3> > pos_proc;              // Position array of every processor
-        std::vector< std::vector<Scalar3> > vel_proc;              // Velocities array of every processor
-        std::vector< std::vector<Scalar3> > accel_proc;            // Accelerations array of every processor
-        std::vector< std::vector<unsigned int> > type_proc;        // Particle types array of every processor
-        std::vector< std::vector<Scalar > > mass_proc;             // Particle masses array of every processor
-        std::vector< std::vector<Scalar > > charge_proc;           // Particle charges array of every processor
-        std::vector< std::vector<Scalar > > diameter_proc;         // Particle diameters array of every processor
-        std::vector< std::vector<int3 > > image_proc;              // Particle images array of every processor
-        std::vector< std::vector<unsigned int > > body_proc;       // Body ids of every processor
-        std::vector< std::vector<Scalar4> > orientation_proc;      // Orientations of every processor
-        std::vector< std::vector<unsigned int > > tag_proc;         // Global tags of every processor
-        //std::vector< std::vector<InertiaTensor> > inertia_proc;  
-        std::vector< unsigned int > N_proc;                        // Number of particles on every processor
-
- 
-        // resize to number of ranks in communicator
         const MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
         unsigned int size = m_exec_conf->getNRanks();
         unsigned int my_rank = m_exec_conf->getRank();
 
-        pos_proc.resize(size);
-        vel_proc.resize(size);
-        accel_proc.resize(size);
-        type_proc.resize(size);
-        mass_proc.resize(size);
-        charge_proc.resize(size);
-        diameter_proc.resize(size);
-        image_proc.resize(size);
-        body_proc.resize(size);
-        orientation_proc.resize(size);
-        tag_proc.resize(size);
-        N_proc.resize(size,0);
+        // find out how the snapshot is distributed over the ranks
+        unsigned int snapshot_info[4] = { snapshot.size, snapshot.validate(), snapshot.global_size,
+                                          snapshot.replicated };
+        unsigned int min_info[4];
+        unsigned int max_info[4];
+        MPI_Allreduce(snapshot_info, min_info, 4, MPI_UNSIGNED, MPI_MIN, mpi_comm);
+        MPI_Allreduce(snapshot_info, max_info, 4, MPI_UNSIGNED, MPI_MAX, mpi_comm);
 
-        if (my_rank == 0)
+        if (max_info[2])
             {
-            // check the input for errors
-            if (snapshot.type_mapping.size() == 0)
+            // every rank holds a part of the system
+            unsigned int n_total;
+            MPI_Allreduce(&snapshot.size, &n_total, 1, MPI_UNSIGNED, MPI_SUM, mpi_comm);
+            if (! min_info[1] || min_info[2] != max_info[2] || n_total != max_info[2])
                 {
-                m_exec_conf->msg->error() << "Number of particle types must be greater than 0." << endl;
-                throw std::runtime_error("Error initializing ParticleData");
+                m_exec_conf->msg->error() << "init.*: invalid distributed particle data snapshot."
+                                        << std::endl << std::endl;
+                throw std::runtime_error("Error initializing particle data.");
                 }
-        
-            Scalar3 scale = m_global_box.getL() / m_box.getL();
-            const Index3D& di = m_decomposition->getDomainIndexer();
 
-            // loop over particles in snapshot, place them into domains
-            for (std::vector<Scalar3>::const_iterator it=snapshot.pos.begin(); it != snapshot.pos.end(); it++)
+            initializeFromSnapshotDistributed(snapshot, 0, snapshot.size, snapshot.global_size);
+            }
+        else if (max_info[3])
+            {
+            // every rank holds the same snapshot and handles an equal share of it
+            if (! min_info[1] || ! min_info[3] || min_info[0] != max_info[0])
                 {
-                // first move possible outliers into the box
-                Scalar3 pos = *it;
-                int3 image = snapshot.image[it-snapshot.pos.begin()];
-
-                m_global_box.wrap(pos,image);
-
-                // determine domain the particle is placed into
-                Scalar3 f = m_global_box.makeFraction(pos,make_scalar3(0.0,0.0,0.0));
-                int i= (unsigned int) (f.x * scale.x);
-                int j= (unsigned int) (f.y * scale.y);
-                int k= (unsigned int) (f.z * scale.z);
-
-                // treat particles lying exactly on the boundary
-                if (i == (int) di.getW()) 
-                    i--;
-                   
-                if (j == (int) di.getH())
-                    j--;
-
-                if (k == (int) di.getD())
-                    k--;
-            
-                unsigned int rank = di(i,j,k);
-
-                assert(rank <= m_exec_conf->getNRanks());
-
-                unsigned int tag = it - snapshot.pos.begin() ;
-                // fill up per-processor data structures
-                pos_proc[rank].push_back(pos);
-                image_proc[rank].push_back(image);
-                vel_proc[rank].push_back(snapshot.vel[tag]);
-                accel_proc[rank].push_back(snapshot.accel[tag]);
-                type_proc[rank].push_back(snapshot.type[tag]);
-                mass_proc[rank].push_back(snapshot.mass[tag]);
-                charge_proc[rank].push_back(snapshot.charge[tag]);
-                diameter_proc[rank].push_back(snapshot.diameter[tag]);
-                body_proc[rank].push_back(snapshot.body[tag]);
-                orientation_proc[rank].push_back(snapshot.orientation[tag]);
-                tag_proc[rank].push_back(tag);
-                N_proc[rank]++;
+                m_exec_conf->msg->error() << "init.*: invalid replicated particle data snapshot."
+                                        << std::endl << std::endl;
+                throw std::runtime_error("Error initializing particle data.");
                 }
 
+            unsigned int first = (unsigned int)((unsigned long long)snapshot.size * my_rank / size);
+            unsigned int last = (unsigned int)((unsigned long long)snapshot.size * (my_rank + 1) / size);
+            initializeFromSnapshotDistributed(snapshot, first, last, snapshot.size);
             }
-
-        // get type mapping
-        m_type_mapping = snapshot.type_mapping;
-
-        // broadcast type mapping
-        bcast(m_type_mapping, root, mpi_comm);
-
-        // broadcast global number of particles
-        unsigned int nglobal = snapshot.size;
-        bcast(nglobal, root, mpi_comm);
-
-        setNGlobal(nglobal);
-
-        // Local particle data 
-        std::vector<Scalar3> pos;
-        std::vector<Scalar3> vel;
-        std::vector<Scalar3> accel;
-        std::vector<unsigned int> type;
-        std::vector<Scalar> mass;
-        std::vector<Scalar> charge;
-        std::vector<Scalar> diameter;
-        std::vector<int3> image;
-        std::vector<unsigned int> body;
-        std::vector<Scalar4> orientation;
-        std::vector<unsigned int> tag;
- 
-        // distribute particle data
-        scatter_v(pos_proc,pos,root, mpi_comm);
-        scatter_v(vel_proc,vel,root, mpi_comm);
-        scatter_v(accel_proc, accel, root, mpi_comm);
-        scatter_v(type_proc, type, root, mpi_comm);
-        scatter_v(mass_proc, mass, root, mpi_comm);
-        scatter_v(charge_proc, charge, root, mpi_comm);
-        scatter_v(diameter_proc, diameter, root, mpi_comm);
-        scatter_v(image_proc, image, root, mpi_comm);
-        scatter_v(body_proc, body, root, mpi_comm);
-        scatter_v(orientation_proc, orientation, root, mpi_comm);
-        scatter_v(tag_proc, tag, root, mpi_comm);
-
-        // distribute number of particles
-        scatter_v(N_proc, m_nparticles, root, mpi_comm);
-
-        // reset all reverse lookup tags to NOT_LOCAL flag
+        else
             {
-            ArrayHandle<unsigned int> h_rtag(getRTags(), access_location::host, access_mode::overwrite);
-            for (unsigned int tag = 0; tag < m_nglobal; tag++)
-                h_rtag.data[tag] = NOT_LOCAL;
+            // only the root holds the snapshot, scatter it in stripes
+            SnapshotParticleData stripe;
+            scatterSnapshot(snapshot, stripe);
+            initializeFromSnapshotDistributed(stripe, 0, stripe.size, stripe.global_size);
             }
-
-        // allocate particle data such that we can accomodate the particles (only if necessary)
-        if (m_max_nparticles < m_nparticles)
-            allocate(m_nparticles);
-
-        // we have to allocate even if the number of particles on a processor
-        // is zero, so that the arrays can be resized later
-        if (m_nparticles == 0 && m_max_nparticles == 0)
-            allocate(1);
-
-        // Load particle data
-        ArrayHandle< Scalar4 > h_pos(m_pos, access_location::host, access_mode::overwrite);
-        ArrayHandle< Scalar4 > h_vel(m_vel, access_location::host, access_mode::overwrite);
-        ArrayHandle< Scalar3 > h_accel(m_accel, access_location::host, access_mode::overwrite);
-        ArrayHandle< int3 > h_image(m_image, access_location::host, access_mode::overwrite);
-        ArrayHandle< Scalar > h_charge(m_charge, access_location::host, access_mode::overwrite);
-        ArrayHandle< Scalar > h_diameter(m_diameter, access_location::host, access_mode::overwrite);
-        ArrayHandle< unsigned int > h_body(m_body, access_location::host, access_mode::overwrite);
-        ArrayHandle< Scalar4 > h_orientation(m_orientation, access_location::host, access_mode::overwrite);
-        ArrayHandle< unsigned int > h_tag(m_tag, access_location::host, access_mode::overwrite);
-        ArrayHandle< unsigned int > h_rtag(m_rtag, access_location::host, access_mode::readwrite);
-
-        for (unsigned int idx = 0; idx < m_nparticles; idx++)
-            {
-            h_pos.data[idx] = make_scalar4(pos[idx].x,pos[idx].y, pos[idx].z, __int_as_scalar(type[idx]));
-            h_vel.data[idx] = make_scalar4(vel[idx].x, vel[idx].y, vel[idx].z, mass[idx]);
-            h_accel.data[idx] = accel[idx];
-            h_charge.data[idx] = charge[idx];
-            h_diameter.data[idx] = diameter[idx];
-            h_image.data[idx] = image[idx];
-            h_tag.data[idx] = tag[idx];
-            h_rtag.data[tag[idx]] = idx;
-            h_body.data[idx] = body[idx];
-            h_orientation.data[idx] = orientation[idx];
-            }
-
-        // reset ghost particle number
-        m_nghosts = 0;
-
-        // notify about change in ghost particle number
-        notifyGhostParticleNumberChange();
         }
     else
 #endif
@@ -742,6 +644,13 @@ void ParticleData::initializeFromSnapshot(const SnapshotParticleData& snapshot)
             throw std::runtime_error("Error initializing ParticleData");
             }
 
+        if (snapshot.global_size)
+            {
+            m_exec_conf->msg->error() << "init.*: a partial particle data snapshot requires a domain decomposition."
+                                    << std::endl << std::endl;
+            throw std::runtime_error("Error initializing particle data.");
+            }
+
         // Initialize number of particles
         setNGlobal(snapshot.size);
         m_nparticles = snapshot.size;
@@ -792,6 +701,261 @@ void ParticleData::initializeFromSnapshot(const SnapshotParticleData& snapshot)
     m_o_image = make_int3(0,0,0);
     }
 
+#ifdef ENABLE_MPI
+/*! \param pos Position of the particle, wrapped back into the global box on return
+    \param image Image flags of the particle, updated on return
+    \returns Rank of the domain the particle is placed into
+*/
+unsigned int ParticleData::getDomainRank(Scalar3& pos, int3& image) const
+    {
+    // first move possible outliers into the box
+    m_global_box.wrap(pos,image);
+
+    // determine domain the particle is placed into
+    unsigned int rank = m_decomposition->placeParticle(m_global_box, pos);
+
+    assert(rank <= m_exec_conf->getNRanks());
+    return rank;
+    }
+
+//! Helper function to scatter contiguous stripes of a vector from the root
+/*! \param in Vector to scatter (root only)
+    \param out Stripe of this rank, pre-allocated
+    \param count Number of elements per rank
+    \param displ Offset of the stripe of every rank
+    \param mpi_comm MPI communicator
+*/
+template<class T>
+static void scatter_stripes(const std::vector<T>& in,
+                            std::vector<T>& out,
+                            const std::vector<int>& count,
+                            const std::vector<int>& displ,
+                            const MPI_Comm mpi_comm)
+    {
+    MPI_Datatype mpi_type;
+    MPI_Type_contiguous(sizeof(T), MPI_BYTE, &mpi_type);
+    MPI_Type_commit(&mpi_type);
+
+    MPI_Scatterv(in.size() ? (void *)&in.front() : NULL, (int *)&count.front(), (int *)&displ.front(), mpi_type,
+                 out.size() ? &out.front() : NULL, out.size(), mpi_type, 0, mpi_comm);
+
+    MPI_Type_free(&mpi_type);
+    }
+
+//! Scatter a snapshot held by the root in contiguous stripes
+/*! \param snapshot The snapshot (significant on rank 0 only)
+    \param stripe The partial snapshot of this rank on return
+
+    Every field is scattered directly from the snapshot vectors, so the root never holds more than one copy of the
+    particle data.
+*/
+void ParticleData::scatterSnapshot(const SnapshotParticleData& snapshot, SnapshotParticleData& stripe)
+    {
+    const MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
+    unsigned int size = m_exec_conf->getNRanks();
+    unsigned int my_rank = m_exec_conf->getRank();
+    unsigned int root = 0;
+
+    unsigned int nglobal = snapshot.size;
+    bcast(nglobal, root, mpi_comm);
+
+    stripe.type_mapping = snapshot.type_mapping;
+    bcast(stripe.type_mapping, root, mpi_comm);
+
+    std::vector<int> count(size);
+    std::vector<int> displ(size);
+    for (unsigned int r = 0; r < size; r++)
+        {
+        displ[r] = (unsigned int)((unsigned long long)nglobal * r / size);
+        count[r] = (unsigned int)((unsigned long long)nglobal * (r + 1) / size) - displ[r];
+        }
+
+    stripe.resize(count[my_rank]);
+    stripe.global_size = nglobal;
+    stripe.tag.resize(stripe.size);
+    for (unsigned int i = 0; i < stripe.size; i++)
+        stripe.tag[i] = displ[my_rank] + i;
+
+    scatter_stripes(snapshot.pos, stripe.pos, count, displ, mpi_comm);
+    scatter_stripes(snapshot.vel, stripe.vel, count, displ, mpi_comm);
+    scatter_stripes(snapshot.accel, stripe.accel, count, displ, mpi_comm);
+    scatter_stripes(snapshot.type, stripe.type, count, displ, mpi_comm);
+    scatter_stripes(snapshot.mass, stripe.mass, count, displ, mpi_comm);
+    scatter_stripes(snapshot.charge, stripe.charge, count, displ, mpi_comm);
+    scatter_stripes(snapshot.diameter, stripe.diameter, count, displ, mpi_comm);
+    scatter_stripes(snapshot.image, stripe.image, count, displ, mpi_comm);
+    scatter_stripes(snapshot.body, stripe.body, count, displ, mpi_comm);
+    scatter_stripes(snapshot.orientation, stripe.orientation, count, displ, mpi_comm);
+    }
+
+//! Comparator to sort particles by tag
+struct pdata_element_tag_less
+    {
+    bool operator()(const pdata_element& a, const pdata_element& b) const
+        {
+        return a.tag < b.tag;
+        }
+    };
+
+//! Initialize from a range of particles in a snapshot held by this rank
+/*! \param snapshot the initial particle data
+    \param first index of the first particle this rank distributes
+    \param last index past the last particle this rank distributes
+    \param nglobal total number of particles in the system
+
+    Every rank places its range of particles into domains and packs them into pdata_elements, the same
+    structure the Communicator uses for migrating particles. A single MPI_Alltoallv then delivers every particle to
+    its owner, which stores its particles in tag order. The tag of a particle is taken from snapshot.tag for a partial
+    snapshot, and is its index otherwise.
+*/
+void ParticleData::initializeFromSnapshotDistributed(const SnapshotParticleData& snapshot,
+                                                     unsigned int first,
+                                                     unsigned int last,
+                                                     unsigned int nglobal)
+    {
+    // check the input for errors
+    if (snapshot.type_mapping.size() == 0)
+        {
+        m_exec_conf->msg->error() << "Number of particle types must be greater than 0." << endl;
+        throw std::runtime_error("Error initializing ParticleData");
+        }
+
+    const MPI_Comm mpi_comm = m_exec_conf->getMPICommunicator();
+    unsigned int size = m_exec_conf->getNRanks();
+
+    m_type_mapping = snapshot.type_mapping;
+    setNGlobal(nglobal);
+
+    unsigned int n_stripe = last - first;
+
+    // place the particles into domains and count how many go to every rank
+    std::vector<Scalar3> pos(n_stripe);
+    std::vector<int3> image(n_stripe);
+    std::vector<unsigned int> dest(n_stripe);
+    std::vector<int> send_count(size, 0);
+    for (unsigned int i = 0; i < n_stripe; i++)
+        {
+        pos[i] = snapshot.pos[first + i];
+        image[i] = snapshot.image[first + i];
+        dest[i] = getDomainRank(pos[i], image[i]);
+        send_count[dest[i]]++;
+        }
+
+    std::vector<int> send_displ(size, 0);
+    for (unsigned int r = 1; r < size; r++)
+        send_displ[r] = send_displ[r-1] + send_count[r-1];
+
+    // pack the particles in order of destination rank
+    std::vector<pdata_element> send_buf(n_stripe);
+    std::vector<int> offset(send_displ);
+    for (unsigned int i = 0; i < n_stripe; i++)
+        {
+        unsigned int idx = first + i;
+        pdata_element& p = send_buf[offset[dest[i]]++];
+        p.pos = make_scalar4(pos[i].x, pos[i].y, pos[i].z, __int_as_scalar(snapshot.type[idx]));
+        p.vel = make_scalar4(snapshot.vel[idx].x, snapshot.vel[idx].y, snapshot.vel[idx].z, snapshot.mass[idx]);
+        p.accel = snapshot.accel[idx];
+        p.charge = snapshot.charge[idx];
+        p.diameter = snapshot.diameter[idx];
+        p.image = image[i];
+        p.body = snapshot.body[idx];
+        p.orientation = snapshot.orientation[idx];
+        p.tag = snapshot.global_size ? snapshot.tag[idx] : idx;
+        }
+
+    // free the temporary arrays before receiving
+    std::vector<Scalar3>().swap(pos);
+    std::vector<int3>().swap(image);
+    std::vector<unsigned int>().swap(dest);
+
+    // exchange the particles
+    std::vector<int> recv_count(size);
+    MPI_Alltoall(&send_count.front(), 1, MPI_INT, &recv_count.front(), 1, MPI_INT, mpi_comm);
+
+    std::vector<int> recv_displ(size, 0);
+    for (unsigned int r = 1; r < size; r++)
+        recv_displ[r] = recv_displ[r-1] + recv_count[r-1];
+    m_nparticles = recv_displ[size-1] + recv_count[size-1];
+
+    MPI_Datatype mpi_pdata_element;
+    MPI_Type_contiguous(sizeof(pdata_element), MPI_BYTE, &mpi_pdata_element);
+    MPI_Type_commit(&mpi_pdata_element);
+
+    std::vector<pdata_element> recv_buf(m_nparticles);
+    MPI_Alltoallv(n_stripe ? &send_buf.front() : NULL, &send_count.front(), &send_displ.front(), mpi_pdata_element,
+                  m_nparticles ? &recv_buf.front() : NULL, &recv_count.front(), &recv_displ.front(), mpi_pdata_element,
+                  mpi_comm);
+
+    MPI_Type_free(&mpi_pdata_element);
+    std::vector<pdata_element>().swap(send_buf);
+
+    // store the local particles in tag order
+    std::sort(recv_buf.begin(), recv_buf.end(), pdata_element_tag_less());
+
+    // every tag must be present exactly once
+    unsigned int n_duplicate = 0;
+    for (unsigned int idx = 1; idx < m_nparticles; idx++)
+        if (recv_buf[idx].tag == recv_buf[idx-1].tag)
+            n_duplicate++;
+    MPI_Allreduce(MPI_IN_PLACE, &n_duplicate, 1, MPI_UNSIGNED, MPI_SUM, mpi_comm);
+    if (n_duplicate)
+        {
+        m_exec_conf->msg->error() << "init.*: " << n_duplicate << " duplicate particle tags in snapshot."
+                                << std::endl << std::endl;
+        throw std::runtime_error("Error initializing particle data.");
+        }
+
+    // reset all reverse lookup tags to NOT_LOCAL flag
+        {
+        ArrayHandle<unsigned int> h_rtag(getRTags(), access_location::host, access_mode::overwrite);
+        for (unsigned int tag = 0; tag < m_nglobal; tag++)
+            h_rtag.data[tag] = NOT_LOCAL;
+        }
+
+    // allocate particle data such that we can accomodate the particles (only if necessary)
+    if (m_max_nparticles < m_nparticles)
+        allocate(m_nparticles);
+
+    // we have to allocate even if the number of particles on a processor
+    // is zero, so that the arrays can be resized later
+    if (m_nparticles == 0 && m_max_nparticles == 0)
+        allocate(1);
+
+    // Load particle data
+    ArrayHandle< Scalar4 > h_pos(m_pos, access_location::host, access_mode::overwrite);
+    ArrayHandle< Scalar4 > h_vel(m_vel, access_location::host, access_mode::overwrite);
+    ArrayHandle< Scalar3 > h_accel(m_accel, access_location::host, access_mode::overwrite);
+    ArrayHandle< int3 > h_image(m_image, access_location::host, access_mode::overwrite);
+    ArrayHandle< Scalar > h_charge(m_charge, access_location::host, access_mode::overwrite);
+    ArrayHandle< Scalar > h_diameter(m_diameter, access_location::host, access_mode::overwrite);
+    ArrayHandle< unsigned int > h_body(m_body, access_location::host, access_mode::overwrite);
+    ArrayHandle< Scalar4 > h_orientation(m_orientation, access_location::host, access_mode::overwrite);
+    ArrayHandle< unsigned int > h_tag(m_tag, access_location::host, access_mode::overwrite);
+    ArrayHandle< unsigned int > h_rtag(m_rtag, access_location::host, access_mode::readwrite);
+
+    for (unsigned int idx = 0; idx < m_nparticles; idx++)
+        {
+        const pdata_element& p = recv_buf[idx];
+        h_pos.data[idx] = p.pos;
+        h_vel.data[idx] = p.vel;
+        h_accel.data[idx] = p.accel;
+        h_charge.data[idx] = p.charge;
+        h_diameter.data[idx] = p.diameter;
+        h_image.data[idx] = p.image;
+        h_tag.data[idx] = p.tag;
+        h_rtag.data[p.tag] = idx;
+        h_body.data[idx] = p.body;
+        h_orientation.data[idx] = p.orientation;
+        }
+
+    // reset ghost particle number
+    m_nghosts = 0;
+
+    // notify about change in ghost particle number
+    notifyGhostParticleNumberChange();
+    }
+#endif
+
 //! take a particle data snapshot
 /* \param snapshot The snapshot to write to
 
@@ -802,6 +966,11 @@ void ParticleData::takeSnapshot(SnapshotParticleData &snapshot)
     // allocate memory in snapshot
     snapshot.resize(getNGlobal());
 
+    // the result is a complete snapshot that only rank 0 holds when the system is decomposed
+    snapshot.global_size = 0;
+    snapshot.tag.clear();
+    snapshot.replicated = false;
+
     ArrayHandle< Scalar4 > h_pos(m_pos, access_location::host, access_mode::read);
     ArrayHandle< Scalar4 > h_vel(m_vel, access_location::host, access_mode::read);
     ArrayHandle< Scalar3 > h_accel(m_accel, access_location::host, access_mode::read);
@@ -1600,7 +1769,7 @@ void export_ParticleData()
 
 //! Constructor for SnapshotParticleData
 SnapshotParticleData::SnapshotParticleData(unsigned int N)
-       : size(N)
+       : size(N), global_size(0), replicated(false)
     {
     resize(N);
     }
@@ -1633,6 +1802,16 @@ bool SnapshotParticleData::validate() const
         inertia_tensor.size() != size)
         return false;
 
+    // Check the tags of a partial snapshot
+    if (global_size)
+        {
+        if (tag.size() != size)
+            return false;
+        for (unsigned int i = 0; i < size; i++)
+            if (tag[i] >= global_size)
+                return false;
+        }
+
     return true;
     }
 
@@ -1650,6 +1829,7 @@ void export_SnapshotParticleData()
     .def_readwrite("body", &SnapshotParticleData::body)
     .def_readwrite("type_mapping", &SnapshotParticleData::type_mapping)
     .def_readwrite("size", &SnapshotParticleData::size)
+    .def_readwrite("replicated", &SnapshotParticleData::replicated)
     ;
     }
 
@@ -209,12 +209,17 @@ const unsigned int NOT_LOCAL = 0xffffffff;
  *
  * To support the second scenerio it is necessary that particles can be accessed in global tag order. Therefore,
  * the data in a snapshot is stored in global tag order.
+ *
+ * In parallel simulations, a snapshot may also hold only a part of the system. In such a partial snapshot,
+ * \c global_size is the total number of particles on all ranks and \c tag lists the global tag of every particle.
+ * A complete snapshot that every rank holds an identical copy of is marked as \c replicated. Any other complete
+ * snapshot is only read on rank 0.
  * \ingroup data_structs
  */
 struct SnapshotParticleData {
     //! Empty snapshot
     SnapshotParticleData()
-        : size(0)
+        : size(0), global_size(0), replicated(false)
         {
         }
 
@@ -247,6 +252,10 @@ struct SnapshotParticleData {
 
     unsigned int size;              //!< number of particles in this snapshot
     std::vector<std::string> type_mapping; //!< Mapping between particle type ids and names
+
+    std::vector<unsigned int> tag;  //!< global tags (partial snapshots only)
+    unsigned int global_size;       //!< total number of particles of a partial snapshot, 0 if the snapshot is complete
+    bool replicated;                //!< true if every rank holds an identical copy of this complete snapshot
     };
 
 //! Manages all of the data arrays for the particles
@@ -534,6 +543,13 @@ class ParticleData : boost::noncopyable
         
         //! Notify listeners that the particles have been rearranged in memory
         void notifyParticleSort();
+
+        //! Connects a function to be called with the permutation when the particles are reordered by a known permutation
+        boost::signals::connection connectParticlePermutation(
+            const boost::function<void (const std::vector<unsigned int>&)> &func);
+
+        //! Notify listeners that the particles have been reordered by the given permutation
+        void notifyParticleSort(const std::vector<unsigned int>& order);
         
         //! Connects a function to be called every time the box size is changed
         boost::signals::connection connectBoxChange(const boost::function<void ()> &func);
@@ -761,6 +777,7 @@ class ParticleData : boost::noncopyable
         std::vector<std::string> m_type_mapping;    //!< Mapping between particle type indices and names
         
         boost::signal<void ()> m_sort_signal;       //!< Signal that is triggered when particles are sorted in memory
+        boost::signal<void (const std::vector<unsigned int>&)> m_permutation_signal; //!< Signal that passes the permutation of a sort
         boost::signal<void ()> m_boxchange_signal;  //!< Signal that is triggered when the box size changes
         boost::signal<void ()> m_max_particle_num_signal; //!< Signal that is triggered when the maximum particle number changes
         boost::signal<void ()> m_ghost_particle_num_signal; //!< Signal that is triggered when ghost particles are added to or deleted
@@ -804,6 +821,20 @@ class ParticleData : boost::noncopyable
 
         //! Helper function to check that particles are in the box
         bool inBox();
+
+#ifdef ENABLE_MPI
+        //! Helper function to find the domain a particle is placed into
+        unsigned int getDomainRank(Scalar3& pos, int3& image) const;
+
+        //! Helper function to scatter a snapshot held by the root in contiguous stripes
+        void scatterSnapshot(const SnapshotParticleData& snapshot, SnapshotParticleData& stripe);
+
+        //! Helper function to initialize from a range of particles in a snapshot held by this rank
+        void initializeFromSnapshotDistributed(const SnapshotParticleData& snapshot,
+                                               unsigned int first,
+                                               unsigned int last,
+                                               unsigned int nglobal);
+#endif
     };
 
 
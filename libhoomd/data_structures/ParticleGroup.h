@@ -280,6 +280,15 @@ class ParticleGroup
             return m_member_idx;
             }
 
+        //! Direct access to the list of member tags
+        /*! \returns A GPUArray listing the tags of all members in sorted order, the same list read by getMemberTag()
+            \note The caller \b must \b not write to or change the array.
+        */
+        const GPUArray<unsigned int>& getMemberTagArray() const
+            {
+            return m_member_tags;
+            }
+
         // @}
         //! \name Analysis methods
         // @{
@@ -0,0 +1,262 @@
+/*
+Highly Optimized Object-oriented Many-particle Dynamics -- Blue Edition
+(HOOMD-blue) Open Source Software License Copyright 2008-2011 Ames Laboratory
+Iowa State University and The Regents of the University of Michigan All rights
+reserved.
+
+HOOMD-blue may contain modifications ("Contributions") provided, and to which
+copyright is held, by various Contributors who have granted The Regents of the
+University of Michigan the right to modify and/or distribute such Contributions.
+
+You may redistribute, use, and create derivate works of HOOMD-blue, in source
+and binary forms, provided you abide by the following conditions:
+
+* Redistributions of source code must retain the above copyright notice, this
+list of conditions, and the following disclaimer both in the code and
+prominently in any materials provided with the distribution.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions, and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+* All publications and presentations based on HOOMD-blue, including any reports
+or published results obtained, in whole or in part, with HOOMD-blue, will
+acknowledge its use according to the terms posted at the time of submission on:
+http://codeblue.umich.edu/hoomd-blue/citations.html
+
+* Any electronic documents citing HOOMD-Blue will link to the HOOMD-Blue website:
+http://codeblue.umich.edu/hoomd-blue/
+
+* Apart from the above required attributions, neither the name of the copyright
+holder nor the names of HOOMD-blue's contributors may be used to endorse or
+promote products derived from this software without specific prior written
+permission.
+
+Disclaimer
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, AND/OR ANY
+WARRANTIES THAT THIS SOFTWARE IS FREE OF INFRINGEMENT ARE DISCLAIMED.
+
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Maintainer: joaander
+
+/*! \file PermuteParticleTable.h
+    \brief Defines helpers to reorder per-particle tables along with a particle sort
+ */
+
+#ifndef __PERMUTE_PARTICLE_TABLE_H__
+#define __PERMUTE_PARTICLE_TABLE_H__
+
+#include "HOOMDMath.h"
+
+#include <vector>
+#include <string.h>
+
+//! Maps particle indices from the order before a sort to the order after it
+/*! Indices of ghost particles (\a idx >= N) are not affected by a sort and are left unchanged.
+*/
+struct sort_index_map
+    {
+    //! Constructor
+    /*! \param _inverse Maps old to new indices for the first \a _N particles
+        \param _N Number of local particles
+    */
+    sort_index_map(const unsigned int *_inverse, unsigned int _N)
+        : inverse(_inverse), N(_N)
+        {
+        }
+
+    //! Map a single index
+    unsigned int operator()(unsigned int idx) const
+        {
+        return (idx < N) ? inverse[idx] : idx;
+        }
+
+    const unsigned int *inverse;    //!< Old index -> new index
+    unsigned int N;                 //!< Number of local particles
+    };
+
+//! Remaps the partner index (.x) of a bond table entry
+struct remap_bond_entry
+    {
+    //! Constructor
+    remap_bond_entry(const sort_index_map& _map) : map(_map) { }
+
+    //! Remap an entry
+    uint2 operator()(uint2 entry) const
+        {
+        entry.x = map(entry.x);
+        return entry;
+        }
+
+    sort_index_map map;     //!< The index map to apply
+    };
+
+//! Remaps the two partner indices (.x, .y) of an angle table entry
+struct remap_angle_entry
+    {
+    //! Constructor
+    remap_angle_entry(const sort_index_map& _map) : map(_map) { }
+
+    //! Remap an entry
+    uint4 operator()(uint4 entry) const
+        {
+        entry.x = map(entry.x);
+        entry.y = map(entry.y);
+        return entry;
+        }
+
+    sort_index_map map;     //!< The index map to apply
+    };
+
+//! Remaps the three partner indices (.x, .y, .z) of a dihedral table entry
+struct remap_dihedral_entry
+    {
+    //! Constructor
+    remap_dihedral_entry(const sort_index_map& _map) : map(_map) { }
+
+    //! Remap an entry
+    uint4 operator()(uint4 entry) const
+        {
+        entry.x = map(entry.x);
+        entry.y = map(entry.y);
+        entry.z = map(entry.z);
+        return entry;
+        }
+
+    sort_index_map map;     //!< The index map to apply
+    };
+
+//! Leaves table entries that hold no particle indices unchanged
+struct remap_none
+    {
+    //! Return the entry as is
+    template<class T>
+    T operator()(const T& entry) const
+        {
+        return entry;
+        }
+    };
+
+//! Computes the inverse of a particle sort order
+/*! \param inverse Set to map old to new indices
+    \param order The particle at new index i was previously at index order[i]
+    \param N Number of local particles
+*/
+inline void invert_sort_order(std::vector<unsigned int>& inverse, const std::vector<unsigned int>& order, unsigned int N)
+    {
+    if (inverse.size() < N)
+        inverse.resize(N);
+
+    for (unsigned int i = 0; i < N; i++)
+        inverse[order[i]] = i;
+    }
+
+//! Reorders the per-particle entry counts of a table along with a particle sort
+/*! \param n_entries Number of table entries per particle, reordered in place
+    \param old_n_entries Set to the counts in the order before the sort, as needed by permute_particle_table()
+    \param order The particle at new index i was previously at index order[i]
+    \param N Number of local particles
+*/
+inline void permute_particle_counts(unsigned int *n_entries,
+                                    std::vector<unsigned int>& old_n_entries,
+                                    const std::vector<unsigned int>& order,
+                                    unsigned int N)
+    {
+    old_n_entries.assign(n_entries, n_entries + N);
+
+    for (unsigned int i = 0; i < N; i++)
+        n_entries[i] = old_n_entries[order[i]];
+    }
+
+//! Reorders the columns of a per-particle table along with a particle sort
+/*! \param table Table with one column per particle, entry k of particle i is at table[k*pitch + i]
+    \param pitch Pitch of \a table
+    \param old_n_entries Number of entries of every particle, in the order before the sort
+    \param order The particle at new index i was previously at index order[i]
+    \param N Number of local particles
+    \param remap Functor that maps the particle indices stored in an entry to the new order
+    \param scratch Scratch buffer, grown as needed
+
+    The entries of every particle keep their relative order, so the result is identical to the table that a full
+    rebuild from the same list of bonds (angles, dihedrals) produces after the sort.
+*/
+template<class T, class Remap>
+void permute_particle_table(T *table,
+                            unsigned int pitch,
+                            const std::vector<unsigned int>& old_n_entries,
+                            const std::vector<unsigned int>& order,
+                            unsigned int N,
+                            const Remap& remap,
+                            std::vector<T>& scratch)
+    {
+    // only the rows that are in use need to be copied
+    unsigned int height = 0;
+    for (unsigned int i = 0; i < N; i++)
+        if (old_n_entries[i] > height)
+            height = old_n_entries[i];
+
+    if (height == 0)
+        return;
+
+    if (scratch.size() < height*pitch)
+        scratch.resize(height*pitch);
+    memcpy(&scratch[0], table, sizeof(T)*height*pitch);
+
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < (int)N; i++)
+        {
+        unsigned int src = order[i];
+        unsigned int n = old_n_entries[src];
+        for (unsigned int k = 0; k < n; k++)
+            table[k*pitch + i] = remap(scratch[k*pitch + src]);
+        }
+    }
+
+//! Compares a reordered per-particle table with the table that a full rebuild produces
+/*! \param n_entries Number of entries of every particle in the reordered table
+    \param table Reordered table
+    \param rebuilt_n_entries Number of entries of every particle in the rebuilt table
+    \param rebuilt_table Rebuilt table
+    \param pitch Pitch of both tables
+    \param N Number of local particles
+    \returns The number of particles whose entries differ
+*/
+template<class T>
+unsigned int compare_particle_tables(const unsigned int *n_entries,
+                                     const T *table,
+                                     const unsigned int *rebuilt_n_entries,
+                                     const T *rebuilt_table,
+                                     unsigned int pitch,
+                                     unsigned int N)
+    {
+    unsigned int n_differ = 0;
+    for (unsigned int i = 0; i < N; i++)
+        {
+        if (n_entries[i] != rebuilt_n_entries[i])
+            {
+            n_differ++;
+            continue;
+            }
+
+        for (unsigned int k = 0; k < n_entries[i]; k++)
+            if (memcmp(&table[k*pitch + i], &rebuilt_table[k*pitch + i], sizeof(T)) != 0)
+                {
+                n_differ++;
+                break;
+                }
+        }
+    return n_differ;
+    }
+
+#endif
@@ -0,0 +1,648 @@
+/*
+Highly Optimized Object-oriented Many-particle Dynamics -- Blue Edition
+(HOOMD-blue) Open Source Software License Copyright 2008-2011 Ames Laboratory
+Iowa State University and The Regents of the University of Michigan All rights
+reserved.
+
+HOOMD-blue may contain modifications ("Contributions") provided, and to which
+copyright is held, by various Contributors who have granted The Regents of the
+University of Michigan the right to modify and/or distribute such Contributions.
+
+You may redistribute, use, and create derivate works of HOOMD-blue, in source
+and binary forms, provided you abide by the following conditions:
+
+* Redistributions of source code must retain the above copyright notice, this
+list of conditions, and the following disclaimer both in the code and
+prominently in any materials provided with the distribution.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions, and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+* All publications and presentations based on HOOMD-blue, including any reports
+or published results obtained, in whole or in part, with HOOMD-blue, will
+acknowledge its use according to the terms posted at the time of submission on:
+http://codeblue.umich.edu/hoomd-blue/citations.html
+
+* Any electronic documents citing HOOMD-Blue will link to the HOOMD-Blue website:
+http://codeblue.umich.edu/hoomd-blue/
+
+* Apart from the above required attributions, neither the name of the copyright
+holder nor the names of HOOMD-blue's contributors may be used to endorse or
+promote products derived from this software without specific prior written
+permission.
+
+Disclaimer
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, AND/OR ANY
+WARRANTIES THAT THIS SOFTWARE IS FREE OF INFRINGEMENT ARE DISCLAIMED.
+
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Maintainer: joaander
+
+/*! \file XMLStreamReader.cc
+    \brief Defines the XMLStreamReader class
+*/
+
+#include "XMLStreamReader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <climits>
+
+#include <boost/cstdint.hpp>
+
+using namespace std;
+
+//! Helper function to replace the predefined entities in an attribute value
+static string decode_entities(const string& value)
+    {
+    if (value.find('&') == string::npos)
+        return value;
+
+    static const char *entities[5][2] = { {"&lt;", "<"}, {"&gt;", ">"}, {"&amp;", "&"},
+                                          {"&quot;", "\""}, {"&apos;", "'"} };
+    string result;
+    size_t i = 0;
+    while (i < value.size())
+        {
+        bool found = false;
+        if (value[i] == '&')
+            {
+            for (unsigned int j = 0; j < 5 && !found; j++)
+                {
+                if (value.compare(i, strlen(entities[j][0]), entities[j][0]) == 0)
+                    {
+                    result += entities[j][1];
+                    i += strlen(entities[j][0]);
+                    found = true;
+                    }
+                }
+            }
+        if (!found)
+            result += value[i++];
+        }
+    return result;
+    }
+
+//! Powers of ten that are exactly representable as a double
+static const double exact_powers_of_ten[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+                                              1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+//! Powers of ten that are exactly representable as a float
+static const float exact_float_powers_of_ten[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+//! Helper function to split a decimal number into its significant digits and a decimal exponent
+/*! \param begin Beginning of the token
+    \param end End of the token
+    \param negative Set to true if the number has a minus sign
+    \param mantissa Set to the first 19 significant digits
+    \param n_digits Set to the number of significant digits
+    \param exponent Set to the decimal exponent of the last digit in \a mantissa
+    \returns false if the token is not a plain decimal number
+
+    Leading zeros are not significant, so <tt>0.000123</tt> has the mantissa 123 and the exponent -6.
+*/
+static inline bool scan_decimal(const char *begin,
+                                const char *end,
+                                bool& negative,
+                                boost::uint64_t& mantissa,
+                                unsigned int& n_digits,
+                                int& exponent)
+    {
+    const char *p = begin;
+    negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        {
+        negative = (*p == '-');
+        p++;
+        }
+
+    mantissa = 0;
+    n_digits = 0;
+    exponent = 0;
+    bool have_digits = false;
+    for (; p < end && isdigit(*p); p++)
+        {
+        have_digits = true;
+        if (mantissa == 0 && *p == '0')
+            continue;
+        if (n_digits < 19)
+            mantissa = mantissa*10 + (*p - '0');
+        else
+            exponent++;
+        n_digits++;
+        }
+
+    if (p < end && *p == '.')
+        {
+        for (p++; p < end && isdigit(*p); p++)
+            {
+            have_digits = true;
+            if (mantissa == 0 && *p == '0')
+                {
+                exponent--;
+                continue;
+                }
+            if (n_digits < 19)
+                {
+                mantissa = mantissa*10 + (*p - '0');
+                exponent--;
+                }
+            n_digits++;
+            }
+        }
+
+    if (have_digits && p < end && (*p == 'e' || *p == 'E'))
+        {
+        p++;
+        bool negative_exponent = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            {
+            negative_exponent = (*p == '-');
+            p++;
+            }
+        if (p == end || !isdigit(*p))
+            have_digits = false;
+
+        int e = 0;
+        for (; p < end && isdigit(*p); p++)
+            if (e < 100000)
+                e = e*10 + (*p - '0');
+        exponent += negative_exponent ? -e : e;
+        }
+
+    return have_digits && p == end;
+    }
+
+/*! \param begin Beginning of the token
+    \param end End of the token
+    \param value Set to the parsed number
+    \returns false if the token is not a number
+
+    Numbers with at most 53 bits of mantissa and a decimal exponent of at most 22 are converted with a single
+    multiplication or division of two exactly representable doubles, which is correctly rounded. Everything else is
+    passed on to strtod, so the result is always the same as that of strtod.
+*/
+bool XMLStreamReader::parseNumber(const char *begin, const char *end, double& value)
+    {
+    bool negative;
+    boost::uint64_t mantissa;
+    unsigned int n_digits;
+    int exponent;
+    if (scan_decimal(begin, end, negative, mantissa, n_digits, exponent) && n_digits <= 19
+        && mantissa <= (boost::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+        {
+        double m = double(mantissa);
+        value = (exponent < 0) ? m / exact_powers_of_ten[-exponent] : m * exact_powers_of_ten[exponent];
+        if (negative)
+            value = -value;
+        return true;
+        }
+
+    // handle all other cases (long mantissas, large exponents, inf, nan) with strtod
+    string token(begin, end);
+    char *token_end;
+    value = strtod(token.c_str(), &token_end);
+    return token_end == token.c_str() + token.size() && token.size() > 0;
+    }
+
+/*! \param begin Beginning of the token
+    \param end End of the token
+    \param value Set to the parsed number
+    \returns false if the token is not a number
+
+    The number is not converted through a double, which would round twice. The fast path uses the limits of single
+    precision instead (24 bits of mantissa and a decimal exponent of at most 10), so the result is always the same as
+    that of strtof.
+*/
+bool XMLStreamReader::parseNumber(const char *begin, const char *end, float& value)
+    {
+    bool negative;
+    boost::uint64_t mantissa;
+    unsigned int n_digits;
+    int exponent;
+    if (scan_decimal(begin, end, negative, mantissa, n_digits, exponent) && n_digits <= 19
+        && mantissa <= (boost::uint64_t(1) << 24) && exponent >= -10 && exponent <= 10)
+        {
+        float m = float(mantissa);
+        value = (exponent < 0) ? m / exact_float_powers_of_ten[-exponent] : m * exact_float_powers_of_ten[exponent];
+        if (negative)
+            value = -value;
+        return true;
+        }
+
+    string token(begin, end);
+    char *token_end;
+    value = strtof(token.c_str(), &token_end);
+    return token_end == token.c_str() + token.size() && token.size() > 0;
+    }
+
+/*! \param begin Beginning of the token
+    \param end End of the token
+    \param value Set to the parsed number
+    \returns false if the token is not an integer or does not fit into an int
+*/
+bool XMLStreamReader::parseNumber(const char *begin, const char *end, int& value)
+    {
+    const char *p = begin;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        {
+        negative = (*p == '-');
+        p++;
+        }
+    if (p == end)
+        return false;
+
+    long long v = 0;
+    for (; p < end; p++)
+        {
+        if (!isdigit(*p))
+            return false;
+        v = v*10 + (*p - '0');
+        if (v > (long long)INT_MAX + 1)
+            return false;
+        }
+
+    if (negative)
+        v = -v;
+    if (v > INT_MAX)
+        return false;
+    value = int(v);
+    return true;
+    }
+
+/*! \param begin Beginning of the token
+    \param end End of the token
+    \param value Set to the parsed number
+    \returns false if the token is not an unsigned integer or does not fit into an unsigned int
+*/
+bool XMLStreamReader::parseNumber(const char *begin, const char *end, unsigned int& value)
+    {
+    const char *p = begin;
+    if (p < end && *p == '+')
+        p++;
+    if (p == end)
+        return false;
+
+    boost::uint64_t v = 0;
+    for (; p < end; p++)
+        {
+        if (!isdigit(*p))
+            return false;
+        v = v*10 + (*p - '0');
+        if (v > UINT_MAX)
+            return false;
+        }
+    value = (unsigned int)v;
+    return true;
+    }
+
+/*! \param exec_conf The execution configuration
+    \param fname File to read
+    \param buffer_size Initial size of the read buffer in bytes
+*/
+XMLStreamReader::XMLStreamReader(boost::shared_ptr<const ExecutionConfiguration> exec_conf,
+                                 const std::string& fname,
+                                 unsigned int buffer_size)
+    : m_exec_conf(exec_conf), m_fname(fname), m_file_size(0), m_bytes_read(0), m_buffer(max(buffer_size, 16u)),
+      m_pos(0), m_end(0), m_line(1), m_pending_end(false)
+    {
+    m_file.open(fname.c_str(), ios::in | ios::binary);
+    if (!m_file.good())
+        {
+        m_exec_conf->msg->error() << endl << "Error opening " << fname << endl << endl;
+        throw runtime_error("Error reading xml file");
+        }
+
+    m_file.seekg(0, ios::end);
+    m_file_size = m_file.tellg();
+    m_file.seekg(0, ios::beg);
+    }
+
+/*! \returns The kind of tag that was read
+    Any text before the tag is skipped. If the tag is an empty element tag (e.g. <tt>\<box .../\></tt>), the next
+    call returns the matching end_element.
+*/
+XMLStreamReader::Event XMLStreamReader::next()
+    {
+    if (m_pending_end)
+        {
+        m_pending_end = false;
+        return end_element;
+        }
+
+    for (;;)
+        {
+        const char *b = &m_buffer[0];
+        const char *lt = (const char *)memchr(b + m_pos, '<', m_end - m_pos);
+        if (!lt)
+            {
+            advance(m_end);
+            if (!fill())
+                return end_of_file;
+            continue;
+            }
+
+        advance(lt - b);
+        if (!skipMarkup())
+            return parseTag();
+        }
+    }
+
+/*! \param begin Set to the beginning of the block
+    \param end Set to the end of the block
+    \returns false when the end tag of the current element has been read
+
+    The block is valid until the next call to any method of the reader. It never ends in the middle of a token.
+    Child elements of the current element are skipped.
+*/
+bool XMLStreamReader::readText(const char *&begin, const char *&end)
+    {
+    if (m_pending_end)
+        {
+        m_pending_end = false;
+        return false;
+        }
+
+    for (;;)
+        {
+        if (m_pos == m_end && !fill())
+            error("Unexpected end of file in <" + m_name + ">");
+
+        const char *b = &m_buffer[0];
+        const char *lt = (const char *)memchr(b + m_pos, '<', m_end - m_pos);
+        if (lt == b + m_pos)
+            {
+            if (skipMarkup())
+                continue;
+
+            string name = m_name;
+            if (parseTag() == end_element)
+                {
+                if (m_name != name)
+                    error("Expected </" + name + "> but found </" + m_name + ">");
+                return false;
+                }
+
+            skipElement();
+            m_name = name;
+            continue;
+            }
+
+        size_t stop;
+        if (lt)
+            stop = lt - b;
+        else
+            {
+            // only return complete tokens, the rest is returned with the next block
+            stop = m_end;
+            while (stop > m_pos && !isspace(b[stop-1]))
+                stop--;
+
+            if (stop == m_pos)
+                {
+                if (fill())
+                    continue;
+                stop = m_end;
+                }
+            }
+
+        begin = &m_buffer[m_pos];
+        end = &m_buffer[stop];
+        advance(stop);
+        return true;
+        }
+    }
+
+/*! Consumes events up to and including the end tag of the current element
+*/
+void XMLStreamReader::skipElement()
+    {
+    if (m_pending_end)
+        {
+        m_pending_end = false;
+        return;
+        }
+
+    unsigned int depth = 1;
+    while (depth > 0)
+        {
+        Event event = next();
+        if (event == end_of_file)
+            error("Unexpected end of file");
+        else if (event == start_element)
+            {
+            if (m_pending_end)
+                m_pending_end = false;
+            else
+                depth++;
+            }
+        else
+            depth--;
+        }
+    }
+
+/*! \returns false if no more data could be read
+    The unprocessed data is moved to the front of the buffer, which invalidates all pointers into it. The buffer is
+    grown if it is completely filled with unprocessed data.
+*/
+bool XMLStreamReader::fill()
+    {
+    if (m_pos > 0)
+        {
+        memmove(&m_buffer[0], &m_buffer[m_pos], m_end - m_pos);
+        m_end -= m_pos;
+        m_pos = 0;
+        }
+
+    if (m_end == m_buffer.size())
+        m_buffer.resize(2*m_buffer.size());
+
+    if (!m_file.good())
+        return false;
+
+    m_file.read(&m_buffer[m_end], m_buffer.size() - m_end);
+    size_t n = m_file.gcount();
+    m_end += n;
+    m_bytes_read += n;
+    return n > 0;
+    }
+
+/*! \param pos New position of the first unprocessed byte
+*/
+void XMLStreamReader::advance(size_t pos)
+    {
+    m_line += count(m_buffer.begin() + m_pos, m_buffer.begin() + pos, '\n');
+    m_pos = pos;
+    }
+
+/*! \param str String to find
+    \param from Offset from the current position to start the search at
+    \returns Position of \a str in the buffer, or string::npos if it is not in the rest of the file
+*/
+size_t XMLStreamReader::find(const char *str, size_t from)
+    {
+    size_t len = strlen(str);
+    for (;;)
+        {
+        size_t available = m_end - m_pos;
+        if (available >= from + len)
+            {
+            const char *b = &m_buffer[0];
+            const char *match = search(b + m_pos + from, b + m_end, str, str + len);
+            if (match != b + m_end)
+                return match - b;
+
+            // a match may start in the last len-1 bytes
+            from = available - len + 1;
+            }
+
+        if (!fill())
+            return string::npos;
+        }
+    }
+
+/*! \returns true if a comment, processing instruction or declaration was skipped, false if the current position is
+    at a start or end tag
+*/
+bool XMLStreamReader::skipMarkup()
+    {
+    // make sure enough of the tag is in the buffer to identify it
+    while (m_end - m_pos < 9 && fill())
+        ;
+
+    const char *p = &m_buffer[m_pos];
+    size_t available = m_end - m_pos;
+    const char *terminator = NULL;
+    size_t start = 0;
+    if (available >= 4 && strncmp(p, "<!--", 4) == 0)
+        {
+        terminator = "-->";
+        start = 4;
+        }
+    else if (available >= 9 && strncmp(p, "<![CDATA[", 9) == 0)
+        {
+        terminator = "]]>";
+        start = 9;
+        }
+    else if (available >= 2 && strncmp(p, "<?", 2) == 0)
+        {
+        terminator = "?>";
+        start = 2;
+        }
+    else if (available >= 2 && strncmp(p, "<!", 2) == 0)
+        {
+        terminator = ">";
+        start = 2;
+        }
+    else
+        return false;
+
+    size_t pos = find(terminator, start);
+    if (pos == string::npos)
+        error("Unterminated markup");
+    advance(pos + strlen(terminator));
+    return true;
+    }
+
+/*! \returns start_element or end_element
+    On return, the name and attributes of the element are set and the tag has been consumed.
+*/
+XMLStreamReader::Event XMLStreamReader::parseTag()
+    {
+    size_t gt = find(">", 1);
+    if (gt == string::npos)
+        error("Unterminated tag");
+
+    const char *p = &m_buffer[m_pos+1];
+    const char *e = &m_buffer[gt];
+
+    bool is_end_tag = (*p == '/');
+    if (is_end_tag)
+        p++;
+
+    const char *name_begin = p;
+    while (p < e && !isspace(*p) && *p != '/')
+        p++;
+    if (p == name_begin)
+        error("Invalid tag");
+    m_name.assign(name_begin, p);
+
+    if (is_end_tag)
+        {
+        advance(gt + 1);
+        return end_element;
+        }
+
+    m_attributes.clear();
+    bool is_empty = false;
+    for (;;)
+        {
+        while (p < e && isspace(*p))
+            p++;
+        if (p == e)
+            break;
+
+        if (*p == '/')
+            {
+            is_empty = true;
+            p++;
+            while (p < e && isspace(*p))
+                p++;
+            if (p != e)
+                error("Invalid tag <" + m_name + ">");
+            break;
+            }
+
+        const char *attr_begin = p;
+        while (p < e && !isspace(*p) && *p != '=')
+            p++;
+        string attr(attr_begin, p);
+
+        while (p < e && isspace(*p))
+            p++;
+        if (p == e || *p != '=')
+            error("Expected = after attribute " + attr + " of <" + m_name + ">");
+        p++;
+        while (p < e && isspace(*p))
+            p++;
+        if (p == e || (*p != '"' && *p != '\''))
+            error("Expected quoted value for attribute " + attr + " of <" + m_name + ">");
+
+        char quote = *p++;
+        const char *value_begin = p;
+        while (p < e && *p != quote)
+            p++;
+        if (p == e)
+            error("Unterminated value of attribute " + attr + " of <" + m_name + ">");
+        m_attributes[attr] = decode_entities(string(value_begin, p));
+        p++;
+        }
+
+    m_pending_end = is_empty;
+    advance(gt + 1);
+    return start_element;
+    }
+
+/*! \param message Description of the error
+*/
+void XMLStreamReader::error(const std::string& message)
+    {
+    m_exec_conf->msg->error() << endl << message << " in file " << m_fname << " at line " << m_line << endl << endl;
+    throw runtime_error("Error reading xml file");
+    }
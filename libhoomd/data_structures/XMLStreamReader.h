@@ -0,0 +1,192 @@
+/*
+Highly Optimized Object-oriented Many-particle Dynamics -- Blue Edition
+(HOOMD-blue) Open Source Software License Copyright 2008-2011 Ames Laboratory
+Iowa State University and The Regents of the University of Michigan All rights
+reserved.
+
+HOOMD-blue may contain modifications ("Contributions") provided, and to which
+copyright is held, by various Contributors who have granted The Regents of the
+University of Michigan the right to modify and/or distribute such Contributions.
+
+You may redistribute, use, and create derivate works of HOOMD-blue, in source
+and binary forms, provided you abide by the following conditions:
+
+* Redistributions of source code must retain the above copyright notice, this
+list of conditions, and the following disclaimer both in the code and
+prominently in any materials provided with the distribution.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions, and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+* All publications and presentations based on HOOMD-blue, including any reports
+or published results obtained, in whole or in part, with HOOMD-blue, will
+acknowledge its use according to the terms posted at the time of submission on:
+http://codeblue.umich.edu/hoomd-blue/citations.html
+
+* Any electronic documents citing HOOMD-Blue will link to the HOOMD-Blue website:
+http://codeblue.umich.edu/hoomd-blue/
+
+* Apart from the above required attributions, neither the name of the copyright
+holder nor the names of HOOMD-blue's contributors may be used to endorse or
+promote products derived from this software without specific prior written
+permission.
+
+Disclaimer
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, AND/OR ANY
+WARRANTIES THAT THIS SOFTWARE IS FREE OF INFRINGEMENT ARE DISCLAIMED.
+
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Maintainer: joaander
+
+/*! \file XMLStreamReader.h
+    \brief Declares the XMLStreamReader class
+*/
+
+#ifdef NVCC
+#error This header cannot be compiled by nvcc
+#endif
+
+#include "ExecutionConfiguration.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+
+#include <boost/shared_ptr.hpp>
+
+#ifndef __XML_STREAM_READER_H__
+#define __XML_STREAM_READER_H__
+
+//! Reads an XML file element by element without building a document tree
+/*! XMLStreamReader reads the file through a fixed size buffer, so the memory needed to read a file does not depend
+    on the size of the file. It is a pull parser: next() advances to the next start or end tag and makes the name and
+    the attributes of the element available. The text of the current element is read with readText(), which returns
+    it in blocks that always end on a whitespace boundary, so that the caller can parse the tokens of each block
+    independently of the others.
+
+    Comments, processing instructions and declarations are skipped. Entities are only decoded in attribute values,
+    the text of the elements in hoomd_xml files is plain numbers and names.
+
+    All errors are reported through the messenger, followed by a runtime_error.
+
+    The static parseNumber() functions convert the tokens in the text to numbers. They give the same result as
+    strtod (or strtof for single precision), but take a fast path for the short numbers that make up most files.
+
+    \ingroup data_structs
+*/
+class XMLStreamReader
+    {
+    public:
+        //! Events returned by next()
+        enum Event
+            {
+            start_element = 0,  //!< A start tag was read
+            end_element,        //!< An end tag was read
+            end_of_file         //!< There is nothing left to read
+            };
+
+        //! Opens the file
+        XMLStreamReader(boost::shared_ptr<const ExecutionConfiguration> exec_conf,
+                        const std::string& fname,
+                        unsigned int buffer_size=1<<22);
+
+        //! Advances to the next start or end tag
+        Event next();
+
+        //! Reads the next block of text of the current element
+        bool readText(const char *&begin, const char *&end);
+
+        //! Skips the rest of the current element, including all of its children
+        void skipElement();
+
+        //! Get the name of the current element
+        const std::string& getName() const
+            {
+            return m_name;
+            }
+
+        //! Test if an attribute of the current element is set
+        bool isAttributeSet(const std::string& name) const
+            {
+            return m_attributes.find(name) != m_attributes.end();
+            }
+
+        //! Get an attribute of the current element
+        std::string getAttribute(const std::string& name) const
+            {
+            std::map<std::string, std::string>::const_iterator attr = m_attributes.find(name);
+            return (attr != m_attributes.end()) ? attr->second : std::string();
+            }
+
+        //! Get the line the reader is currently at
+        unsigned int getLine() const
+            {
+            return m_line;
+            }
+
+        //! Get the number of bytes of the file that have not been processed yet
+        size_t getBytesLeft() const
+            {
+            return m_file_size - m_bytes_read + (m_end - m_pos);
+            }
+
+        //! Parses a token as a double precision number
+        static bool parseNumber(const char *begin, const char *end, double& value);
+
+        //! Parses a token as a single precision number
+        static bool parseNumber(const char *begin, const char *end, float& value);
+
+        //! Parses a token as an integer
+        static bool parseNumber(const char *begin, const char *end, int& value);
+
+        //! Parses a token as an unsigned integer
+        static bool parseNumber(const char *begin, const char *end, unsigned int& value);
+
+    private:
+        boost::shared_ptr<const ExecutionConfiguration> m_exec_conf; //!< The execution configuration
+        std::string m_fname;                //!< Name of the file that is read
+        std::ifstream m_file;               //!< The file that is read
+        size_t m_file_size;                 //!< Size of the file in bytes
+        size_t m_bytes_read;                //!< Number of bytes read from the file so far
+        std::vector<char> m_buffer;         //!< Data read from the file but not processed yet
+        size_t m_pos;                       //!< Position of the first unprocessed byte in m_buffer
+        size_t m_end;                       //!< End of the valid data in m_buffer
+        unsigned int m_line;                //!< Current line number
+
+        std::string m_name;                 //!< Name of the current element
+        std::map<std::string, std::string> m_attributes;  //!< Attributes of the current element
+        bool m_pending_end;                 //!< True if the current element was an empty element tag
+
+        //! Read more data from the file into the buffer
+        bool fill();
+
+        //! Mark bytes in the buffer as processed
+        void advance(size_t pos);
+
+        //! Find a string in the buffer, reading more data as needed
+        size_t find(const char *str, size_t from);
+
+        //! Skip a comment, processing instruction or declaration
+        bool skipMarkup();
+
+        //! Parse the start or end tag at the current position
+        Event parseTag();
+
+        //! Report a parse error
+        void error(const std::string& message);
+    };
+
+#endif
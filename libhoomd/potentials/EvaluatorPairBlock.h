@@ -0,0 +1,123 @@
+/*
+Highly Optimized Object-oriented Many-particle Dynamics -- Blue Edition
+(HOOMD-blue) Open Source Software License Copyright 2008-2011 Ames Laboratory
+Iowa State University and The Regents of the University of Michigan All rights
+reserved.
+
+HOOMD-blue may contain modifications ("Contributions") provided, and to which
+copyright is held, by various Contributors who have granted The Regents of the
+University of Michigan the right to modify and/or distribute such Contributions.
+
+You may redistribute, use, and create derivate works of HOOMD-blue, in source
+and binary forms, provided you abide by the following conditions:
+
+* Redistributions of source code must retain the above copyright notice, this
+list of conditions, and the following disclaimer both in the code and
+prominently in any materials provided with the distribution.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions, and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+* All publications and presentations based on HOOMD-blue, including any reports
+or published results obtained, in whole or in part, with HOOMD-blue, will
+acknowledge its use according to the terms posted at the time of submission on:
+http://codeblue.umich.edu/hoomd-blue/citations.html
+
+* Any electronic documents citing HOOMD-Blue will link to the HOOMD-Blue website:
+http://codeblue.umich.edu/hoomd-blue/
+
+* Apart from the above required attributions, neither the name of the copyright
+holder nor the names of HOOMD-blue's contributors may be used to endorse or
+promote products derived from this software without specific prior written
+permission.
+
+Disclaimer
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, AND/OR ANY
+WARRANTIES THAT THIS SOFTWARE IS FREE OF INFRINGEMENT ARE DISCLAIMED.
+
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Maintainer: joaander
+
+#ifndef __EVALUATOR_PAIR_BLOCK_H__
+#define __EVALUATOR_PAIR_BLOCK_H__
+
+#include "HOOMDMath.h"
+
+/*! \file EvaluatorPairBlock.h
+    \brief Defines the interface for lane-wise evaluation of blocks of pairs used by the vectorized PotentialPair path
+    \note This header cannot be compiled by nvcc
+*/
+
+#ifdef NVCC
+#error This header cannot be compiled by nvcc
+#endif
+
+//! Width of the host vector registers in bytes, as selected by the compiler target flags
+#if defined(__AVX512F__)
+#define PAIR_BLOCK_BYTES 64
+#elif defined(__AVX__)
+#define PAIR_BLOCK_BYTES 32
+#else
+#define PAIR_BLOCK_BYTES 16
+#endif
+
+//! Number of neighbors evaluated together in one block (4, 8 or 16 in single precision)
+#define PAIR_BLOCK_WIDTH (PAIR_BLOCK_BYTES / sizeof(Scalar))
+
+//! Lane-wise evaluation of a block of pairs
+/*! PotentialPair gathers exactly PAIR_BLOCK_WIDTH neighbors of a particle into structure of arrays form (rsq, rcutsq
+    and the per type pair parameters of each lane) and hands the whole block to evalForceAndEnergy(). Only full blocks
+    are passed, so every lane holds a real neighbor; the remaining fewer than PAIR_BLOCK_WIDTH neighbors of a particle go
+    through the per pair evaluator in the scalar loop. An implementation evaluates every lane with the same straight
+    line code so that the compiler can map the loop over the lanes onto vector instructions. Lanes beyond the cutoff
+    (rsq >= rcutsq) or with parameters that switch the potential off must produce a zero force and energy, exactly as
+    the per pair evaluator returning false would.
+
+    This default template marks an evaluator as not having a block form, and PotentialPair then falls back to the per
+    neighbor loop over evaluator::evalForceAndEnergy(). Evaluators that provide a block form specialize the template
+    next to their class definition (see EvaluatorPairLJ.h).
+
+    The block form is only used when the energy shift is the same for all pairs (no_shift and shift modes) and the
+    evaluator needs neither diameter nor charge.
+*/
+template< class evaluator >
+struct EvaluatorPairBlock
+    {
+    //! Param type from evaluator
+    typedef typename evaluator::param_type param_type;
+
+    //! Returns true when a block form is available for this evaluator
+    static bool isAvailable() { return false; }
+
+    //! Evaluate the force and energy for a block of PAIR_BLOCK_WIDTH pairs
+    /*! \param rsq Squared distance of each lane
+        \param rcutsq Squared cutoff of each lane
+        \param params Pair parameters of each lane
+        \param force_divr Output force divided by r of each lane
+        \param pair_eng Output pair energy of each lane
+        \param energy_shift If true, the potential must be shifted so that V(r) is continuous at the cutoff
+    */
+    static void evalForceAndEnergy(const Scalar *rsq,
+                                   const Scalar *rcutsq,
+                                   const param_type *params,
+                                   Scalar *force_divr,
+                                   Scalar *pair_eng,
+                                   bool energy_shift)
+        {
+        }
+    };
+
+#endif // __EVALUATOR_PAIR_BLOCK_H__
+
@@ -55,6 +55,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #ifndef NVCC
 #include <string>
+#include "EvaluatorPairBlock.h"
 #endif
 
 #include "HOOMDMath.h"
@@ -178,6 +179,41 @@ class EvaluatorPairGauss
         Scalar sigma;   //!< sigma parameter extracted from the params passed to the constructor
     };
 
+#ifndef NVCC
+//! Block form of the Gaussian evaluator for the vectorized PotentialPair path
+template<>
+struct EvaluatorPairBlock<EvaluatorPairGauss>
+    {
+    typedef EvaluatorPairGauss::param_type param_type;
+
+    static bool isAvailable() { return true; }
+
+    static void evalForceAndEnergy(const Scalar *rsq,
+                                   const Scalar *rcutsq,
+                                   const param_type *params,
+                                   Scalar *force_divr,
+                                   Scalar *pair_eng,
+                                   bool energy_shift)
+        {
+        for (unsigned int l = 0; l < PAIR_BLOCK_WIDTH; l++)
+            {
+            Scalar epsilon = params[l].x;
+            Scalar sigma = params[l].y;
+            Scalar sigma_sq = sigma*sigma;
+            Scalar exp_val = EXP(-Scalar(1.0)/Scalar(2.0) * rsq[l] / sigma_sq);
+            Scalar f = epsilon / sigma_sq * exp_val;
+            Scalar e = epsilon * exp_val;
+
+            if (energy_shift)
+                e -= epsilon * EXP(-Scalar(1.0)/Scalar(2.0) * rcutsq[l] / sigma_sq);
+
+            bool inside = rsq[l] < rcutsq[l];
+            force_divr[l] = inside ? f : Scalar(0.0);
+            pair_eng[l] = inside ? e : Scalar(0.0);
+            }
+        }
+    };
+#endif
 
 #endif // __PAIR_EVALUATOR_GAUSS_H__
 
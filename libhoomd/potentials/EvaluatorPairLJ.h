@@ -55,6 +55,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #ifndef NVCC
 #include <string>
+#include "EvaluatorPairBlock.h"
 #endif
 
 #include "HOOMDMath.h"
@@ -221,6 +222,48 @@ class EvaluatorPairLJ
         Scalar lj2;     //!< lj2 parameter extracted from the params passed to the constructor
     };
 
+#ifndef NVCC
+//! Block form of the LJ evaluator for the vectorized PotentialPair path
+/*! Evaluates the same expressions as EvaluatorPairLJ::evalForceAndEnergy() for every lane and selects the result with
+    the cutoff test, so that the loop over the lanes has no branches.
+*/
+template<>
+struct EvaluatorPairBlock<EvaluatorPairLJ>
+    {
+    typedef EvaluatorPairLJ::param_type param_type;
+
+    static bool isAvailable() { return true; }
+
+    static void evalForceAndEnergy(const Scalar *rsq,
+                                   const Scalar *rcutsq,
+                                   const param_type *params,
+                                   Scalar *force_divr,
+                                   Scalar *pair_eng,
+                                   bool energy_shift)
+        {
+        for (unsigned int l = 0; l < PAIR_BLOCK_WIDTH; l++)
+            {
+            Scalar lj1 = params[l].x;
+            Scalar lj2 = params[l].y;
+            Scalar r2inv = Scalar(1.0)/rsq[l];
+            Scalar r6inv = r2inv * r2inv * r2inv;
+            Scalar f = r2inv * r6inv * (Scalar(12.0)*lj1*r6inv - Scalar(6.0)*lj2);
+            Scalar e = r6inv * (lj1*r6inv - lj2);
+
+            if (energy_shift)
+                {
+                Scalar rcut2inv = Scalar(1.0)/rcutsq[l];
+                Scalar rcut6inv = rcut2inv * rcut2inv * rcut2inv;
+                e -= rcut6inv * (lj1*rcut6inv - lj2);
+                }
+
+            bool inside = rsq[l] < rcutsq[l] && lj1 != 0;
+            force_divr[l] = inside ? f : Scalar(0.0);
+            pair_eng[l] = inside ? e : Scalar(0.0);
+            }
+        }
+    };
+#endif
 
 #endif // __PAIR_EVALUATOR_LJ_H__
 
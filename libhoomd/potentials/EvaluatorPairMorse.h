@@ -55,6 +55,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #ifndef NVCC
 #include <string>
+#include "EvaluatorPairBlock.h"
 #endif
 
 #include "HOOMDMath.h"
@@ -188,6 +189,46 @@ class EvaluatorPairMorse
         Scalar r0;      //!< Offset, i.e., position of the potential minimum
     };
 
+#ifndef NVCC
+//! Block form of the Morse evaluator for the vectorized PotentialPair path
+template<>
+struct EvaluatorPairBlock<EvaluatorPairMorse>
+    {
+    typedef EvaluatorPairMorse::param_type param_type;
+
+    static bool isAvailable() { return true; }
+
+    static void evalForceAndEnergy(const Scalar *rsq,
+                                   const Scalar *rcutsq,
+                                   const param_type *params,
+                                   Scalar *force_divr,
+                                   Scalar *pair_eng,
+                                   bool energy_shift)
+        {
+        for (unsigned int l = 0; l < PAIR_BLOCK_WIDTH; l++)
+            {
+            Scalar D0 = params[l].x;
+            Scalar alpha = params[l].y;
+            Scalar r0 = params[l].z;
+            Scalar r = SQRT(rsq[l]);
+            Scalar Exp_factor = EXP(-alpha*(r-r0));
+            Scalar e = D0 * Exp_factor * (Exp_factor - Scalar(2.0));
+            Scalar f = Scalar(2.0) * D0 * alpha * Exp_factor * (Exp_factor - Scalar(1.0)) / r;
+
+            if (energy_shift)
+                {
+                Scalar rcut = SQRT(rcutsq[l]);
+                Scalar Exp_factor_cut = EXP(-alpha*(rcut-r0));
+                e -= D0 * Exp_factor_cut * (Exp_factor_cut - Scalar(2.0));
+                }
+
+            bool inside = rsq[l] < rcutsq[l];
+            force_divr[l] = inside ? f : Scalar(0.0);
+            pair_eng[l] = inside ? e : Scalar(0.0);
+            }
+        }
+    };
+#endif
 
 #endif // __PAIR_EVALUATOR_MORSE_H__
 
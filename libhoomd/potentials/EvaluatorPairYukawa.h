@@ -55,6 +55,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #ifndef NVCC
 #include <string>
+#include "EvaluatorPairBlock.h"
 #endif
 
 #include "HOOMDMath.h"
@@ -190,6 +191,47 @@ class EvaluatorPairYukawa
         Scalar kappa;   //!< kappa parameter extracted from the params passed to the constructor
     };
 
+#ifndef NVCC
+//! Block form of the Yukawa evaluator for the vectorized PotentialPair path
+template<>
+struct EvaluatorPairBlock<EvaluatorPairYukawa>
+    {
+    typedef EvaluatorPairYukawa::param_type param_type;
+
+    static bool isAvailable() { return true; }
+
+    static void evalForceAndEnergy(const Scalar *rsq,
+                                   const Scalar *rcutsq,
+                                   const param_type *params,
+                                   Scalar *force_divr,
+                                   Scalar *pair_eng,
+                                   bool energy_shift)
+        {
+        for (unsigned int l = 0; l < PAIR_BLOCK_WIDTH; l++)
+            {
+            Scalar epsilon = params[l].x;
+            Scalar kappa = params[l].y;
+            Scalar rinv = RSQRT(rsq[l]);
+            Scalar r = Scalar(1.0) / rinv;
+            Scalar r2inv = Scalar(1.0) / rsq[l];
+            Scalar exp_val = EXP(-kappa * r);
+            Scalar f = epsilon * exp_val * r2inv * (rinv + kappa);
+            Scalar e = epsilon * exp_val * rinv;
+
+            if (energy_shift)
+                {
+                Scalar rcutinv = RSQRT(rcutsq[l]);
+                Scalar rcut = Scalar(1.0) / rcutinv;
+                e -= epsilon * EXP(-kappa * rcut) * rcutinv;
+                }
+
+            bool inside = rsq[l] < rcutsq[l] && epsilon != 0;
+            force_divr[l] = inside ? f : Scalar(0.0);
+            pair_eng[l] = inside ? e : Scalar(0.0);
+            }
+        }
+    };
+#endif
 
 #endif // __PAIR_EVALUATOR_YUKAWA_H__
 
@@ -101,6 +101,21 @@ class PotentialBond : public ForceCompute
         //! Calculates the requested log value and returns it
         virtual Scalar getLogValue(const std::string& quantity, unsigned int timestep);
 
+#ifdef ENABLE_MPI
+        //! Request the ghost fields the evaluator needs
+        /*! \param timestep Current time step
+        */
+        virtual CommFlags getRequestedCommFlags(unsigned int timestep)
+            {
+            CommFlags flags(0);
+            if (evaluator::needsCharge())
+                flags[comm_flag::charge] = 1;
+            if (evaluator::needsDiameter())
+                flags[comm_flag::diameter] = 1;
+            return flags;
+            }
+#endif
+
     protected:
         GPUArray<param_type> m_params;              //!< Bond parameters per type
         boost::shared_ptr<BondData> m_bond_data;    //!< Bond data to use in computing bonds
@@ -63,6 +63,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "GPUArray.h"
 #include "ForceCompute.h"
 #include "NeighborList.h"
+#include "EvaluatorPairBlock.h"
 
 #ifdef ENABLE_OPENMP
 #include <omp.h>
@@ -122,6 +123,23 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     potential evaluator class passed in. See the appropriate documentation for the evaluator for the definition of each
     element of the parameters.
     
+    <b>Vectorized path</b>
+    
+    When the evaluator provides a block form (see EvaluatorPairBlock), the neighbors of each particle are processed in
+    blocks of PAIR_BLOCK_WIDTH. The positions of the neighbors in a block are gathered, the minimum image separations,
+    squared distances, cutoffs and parameters are stored in structure of arrays form, and the whole block is evaluated
+    lane-wise. The remaining neighbors that do not fill a whole block go through the per neighbor loop. The
+    accumulation of forces, energies and virials is identical to the per neighbor loop. XPLOR smoothing,
+    and evaluators that need diameter or charge, always use the per neighbor loop. The vectorized path is enabled by
+    default and can be turned off with setVectorized() (e.g. for benchmarking).
+    
+    <b>Thread accumulation</b>
+    
+    With the default thread_partial accumulation (see ForceCompute::threadAccumulationMode), each thread sums into
+    its own partial arrays and the results are reduced at the end. In the owner_computes mode, which needs a full
+    neighbor list, each thread writes the results of the particles it loops over directly to the force and virial
+    arrays and the partial arrays are neither allocated, zeroed nor reduced.
+    
     For profiling and logging, PotentialPair needs to know the name of the potential. For now, that will be queried from
     the evaluator. Perhaps in the future we could allow users to change that so multiple pair potentials could be logged
     independantly.
@@ -167,9 +185,46 @@ class PotentialPair : public ForceCompute
             {
             m_shift_mode = mode;
             }
+        
+        //! Enable or disable the vectorized path
+        /*! \param vectorized Set to false to always use the per neighbor loop
+        */
+        void setVectorized(bool vectorized)
+            {
+            m_vectorized = vectorized;
+            }
+
+        //! The CPU compute implements both thread accumulation modes
+        virtual bool supportsThreadAccumulation()
+            {
+            return true;
+            }
+
+#ifdef ENABLE_MPI
+        //! Request the ghost fields the evaluator needs
+        /*! \param timestep Current time step
+        */
+        virtual CommFlags getRequestedCommFlags(unsigned int timestep)
+            {
+            CommFlags flags(0);
+            if (evaluator::needsCharge())
+                flags[comm_flag::charge] = 1;
+            if (evaluator::needsDiameter())
+                flags[comm_flag::diameter] = 1;
+            return flags;
+            }
+
+        //! The interior forces are computed while the ghost update is in flight
+        virtual bool overlapsGhostUpdate()
+            {
+            return true;
+            }
+#endif
+
     protected:
         boost::shared_ptr<NeighborList> m_nlist;    //!< The neighborlist to use for the computation
         energyShiftMode m_shift_mode;               //!< Store the mode with which to handle the energy shift at r_cut
+        bool m_vectorized;                          //!< True if the vectorized path should be used when possible
         Index2D m_typpair_idx;                      //!< Helper class for indexing per type pair arrays
         GPUArray<Scalar> m_rcutsq;                  //!< Cuttoff radius squared per type pair
         GPUArray<Scalar> m_ronsq;                   //!< ron squared per type pair
@@ -179,6 +234,13 @@ class PotentialPair : public ForceCompute
         
         //! Actually compute the forces
         virtual void computeForces(unsigned int timestep);
+
+        //! Compute the forces on a range of the local particles
+        void computeForceRange(unsigned int first,
+                               unsigned int last,
+                               bool interior_boundary,
+                               bool first_range,
+                               bool last_range);
     };
 
 /*! \param sysdef System to compute forces on
@@ -189,7 +251,8 @@ template < class evaluator >
 PotentialPair< evaluator >::PotentialPair(boost::shared_ptr<SystemDefinition> sysdef,
                                                 boost::shared_ptr<NeighborList> nlist,
                                                 const std::string& log_suffix)
-    : ForceCompute(sysdef), m_nlist(nlist), m_shift_mode(no_shift), m_typpair_idx(m_pdata->getNTypes())
+    : ForceCompute(sysdef), m_nlist(nlist), m_shift_mode(no_shift), m_vectorized(true),
+      m_typpair_idx(m_pdata->getNTypes())
     {
     m_exec_conf->msg->notice(5) << "Constructing PotentialPair<" << evaluator::getName() << ">" << endl;
 
@@ -325,14 +388,68 @@ void PotentialPair< evaluator >::computeForces(unsigned int timestep)
     // start the profile for this compute
     if (m_prof) m_prof->push(m_prof_name);
     
+    // the owner computes mode writes the results of each particle directly and cannot use newton's third law
+    if (m_thread_accumulation == owner_computes && m_nlist->getStorageMode() == NeighborList::half)
+        {
+        m_exec_conf->msg->error() << "pair." << evaluator::getName()
+                                  << ": owner computes accumulation requires a full neighbor list" << std::endl;
+        throw std::runtime_error("Error computing pair forces");
+        }
+    
+    bool overlap = false;
+#ifdef ENABLE_MPI
+    overlap = m_comm && m_comm->isGhostUpdatePending();
+#endif
+
+    if (!overlap)
+        computeForceRange(0, m_pdata->getN(), false, true, true);
+#ifdef ENABLE_MPI
+    else
+        {
+        // with a ghost update in flight, the forces on the interior particles are computed first, and the forces on
+        // the boundary particles once the ghost positions have arrived
+        unsigned int n_interior = m_nlist->getNInterior();
+        computeForceRange(0, n_interior, true, true, false);
+        m_comm->finishUpdateGhosts(timestep);
+        computeForceRange(n_interior, m_pdata->getN(), true, false, true);
+        }
+#endif
+
+    if (m_prof) m_prof->pop();
+    }
+
+/*! \param first First entry of the range of particles to compute
+    \param last One past the last entry of the range
+    \param interior_boundary If true, \a first and \a last index into NeighborList::getInteriorBoundaryList(),
+           otherwise they are particle indices
+    \param first_range Set to true for the first range computed in a step, the partial sums are zeroed
+    \param last_range Set to true for the last range computed in a step, the partial sums are reduced into the force
+           and virial arrays
+*/
+template< class evaluator >
+void PotentialPair< evaluator >::computeForceRange(unsigned int first,
+                                                   unsigned int last,
+                                                   bool interior_boundary,
+                                                   bool first_range,
+                                                   bool last_range)
+    {
     // depending on the neighborlist settings, we can take advantage of newton's third law
     // to reduce computations at the cost of memory access complexity: set that flag now
     bool third_law = m_nlist->getStorageMode() == NeighborList::half;
     
+    // in the owner computes mode, each thread writes the results for its own particles directly to the output arrays
+    bool owner = m_thread_accumulation == owner_computes;
+    
     // access the neighbor list, particle data, and system box
     ArrayHandle<unsigned int> h_n_neigh(m_nlist->getNNeighArray(), access_location::host, access_mode::read);
     ArrayHandle<unsigned int> h_nlist(m_nlist->getNListArray(), access_location::host, access_mode::read);
     Index2D nli = m_nlist->getNListIndexer();
+#ifdef ENABLE_MPI
+    ArrayHandle<unsigned int> h_interior_boundary(m_nlist->getInteriorBoundaryList(), access_location::host, access_mode::read);
+    const unsigned int *order = interior_boundary ? h_interior_boundary.data : NULL;
+#else
+    const unsigned int *order = NULL;
+#endif
 
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
     ArrayHandle<Scalar> h_diameter(m_pdata->getDiameters(), access_location::host, access_mode::read);
@@ -352,6 +469,11 @@ void PotentialPair< evaluator >::computeForces(unsigned int timestep)
     PDataFlags flags = this->m_pdata->getFlags();
     bool compute_virial = flags[pdata_flag::pressure_tensor] || flags[pdata_flag::isotropic_virial];
 
+    // the vectorized path needs a block form of the evaluator and the same energy shift for every pair
+    bool use_block = m_vectorized && EvaluatorPairBlock<evaluator>::isAvailable() && m_shift_mode != xplor
+                     && !evaluator::needsDiameter() && !evaluator::needsCharge();
+    bool block_energy_shift = (m_shift_mode == shift);
+
 #pragma omp parallel
     {
     #ifdef ENABLE_OPENMP
@@ -361,13 +483,18 @@ void PotentialPair< evaluator >::computeForces(unsigned int timestep)
     #endif
 
     // need to start from a zero force, energy and virial
-    memset(&m_fdata_partial[m_index_thread_partial(0,tid)] , 0, sizeof(Scalar4)*m_pdata->getN());
-    memset(&m_virial_partial[6*m_index_thread_partial(0,tid)] , 0, 6*sizeof(Scalar)*m_pdata->getN());
+    if (!owner && first_range)
+        {
+        memset(&m_fdata_partial[m_index_thread_partial(0,tid)] , 0, sizeof(Scalar4)*m_pdata->getN());
+        memset(&m_virial_partial[6*m_index_thread_partial(0,tid)] , 0, 6*sizeof(Scalar)*m_pdata->getN());
+        }
 
     // for each particle
 #pragma omp for schedule(guided)
-    for (int i = 0; i < (int)m_pdata->getN(); i++)
+    for (int n = (int)first; n < (int)last; n++)
         {
+        unsigned int i = order ? order[n] : n;
+
         // access the particle's position and type (MEM TRANSFER: 4 scalars)
         Scalar3 pi = make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z);
         unsigned int typei = __scalar_as_int(h_pos.data[i].w);
@@ -394,7 +521,96 @@ void PotentialPair< evaluator >::computeForces(unsigned int timestep)
         
         // loop over all of the neighbors of this particle
         const unsigned int size = (unsigned int)h_n_neigh.data[i];
-        for (unsigned int k = 0; k < size; k++)
+        unsigned int block_end = 0;
+        if (use_block)
+            block_end = size - size % PAIR_BLOCK_WIDTH;
+
+        // evaluate the full blocks of neighbors in block form
+        for (unsigned int k = 0; k < block_end; k += PAIR_BLOCK_WIDTH)
+            {
+            // structure of arrays for one block of neighbors
+            unsigned int blk_j[PAIR_BLOCK_WIDTH];
+            Scalar blk_dx[PAIR_BLOCK_WIDTH];
+            Scalar blk_dy[PAIR_BLOCK_WIDTH];
+            Scalar blk_dz[PAIR_BLOCK_WIDTH];
+            Scalar blk_rsq[PAIR_BLOCK_WIDTH];
+            Scalar blk_rcutsq[PAIR_BLOCK_WIDTH];
+            param_type blk_params[PAIR_BLOCK_WIDTH];
+            Scalar blk_force_divr[PAIR_BLOCK_WIDTH];
+            Scalar blk_pair_eng[PAIR_BLOCK_WIDTH];
+
+            // gather the neighbors of this block
+            for (unsigned int l = 0; l < PAIR_BLOCK_WIDTH; l++)
+                {
+                unsigned int j = h_nlist.data[nli(i, k+l)];
+                assert(j < m_pdata->getN() + m_pdata->getNGhosts());
+
+                Scalar3 pj = make_scalar3(h_pos.data[j].x, h_pos.data[j].y, h_pos.data[j].z);
+                Scalar3 dx = box.minImage(pi - pj);
+
+                unsigned int typej = __scalar_as_int(h_pos.data[j].w);
+                assert(typej < m_pdata->getNTypes());
+                unsigned int typpair_idx = m_typpair_idx(typei, typej);
+
+                blk_j[l] = j;
+                blk_dx[l] = dx.x;
+                blk_dy[l] = dx.y;
+                blk_dz[l] = dx.z;
+                blk_rsq[l] = dot(dx, dx);
+                blk_rcutsq[l] = h_rcutsq.data[typpair_idx];
+                blk_params[l] = h_params.data[typpair_idx];
+                }
+
+            EvaluatorPairBlock<evaluator>::evalForceAndEnergy(blk_rsq,
+                                                              blk_rcutsq,
+                                                              blk_params,
+                                                              blk_force_divr,
+                                                              blk_pair_eng,
+                                                              block_energy_shift);
+
+            // accumulate the results in neighbor order
+            for (unsigned int l = 0; l < PAIR_BLOCK_WIDTH; l++)
+                {
+                Scalar force_divr = blk_force_divr[l];
+                Scalar pair_eng = blk_pair_eng[l];
+                Scalar3 dx = make_scalar3(blk_dx[l], blk_dy[l], blk_dz[l]);
+                Scalar force_div2r = force_divr * Scalar(0.5);
+
+                fi += dx*force_divr;
+                pei += pair_eng * Scalar(0.5);
+                if (compute_virial)
+                    {
+                    virialxxi += force_div2r*dx.x*dx.x;
+                    virialxyi += force_div2r*dx.x*dx.y;
+                    virialxzi += force_div2r*dx.x*dx.z;
+                    virialyyi += force_div2r*dx.y*dx.y;
+                    virialyzi += force_div2r*dx.y*dx.z;
+                    virialzzi += force_div2r*dx.z*dx.z;
+                    }
+
+                unsigned int j = blk_j[l];
+                if (third_law && j < m_pdata->getN())
+                    {
+                    unsigned int mem_idx = m_index_thread_partial(j,tid);
+                    m_fdata_partial[mem_idx].x -= dx.x*force_divr;
+                    m_fdata_partial[mem_idx].y -= dx.y*force_divr;
+                    m_fdata_partial[mem_idx].z -= dx.z*force_divr;
+                    m_fdata_partial[mem_idx].w += pair_eng * Scalar(0.5);
+                    if (compute_virial)
+                        {
+                        m_virial_partial[0+6*mem_idx] += force_div2r*dx.x*dx.x;
+                        m_virial_partial[1+6*mem_idx] += force_div2r*dx.x*dx.y;
+                        m_virial_partial[2+6*mem_idx] += force_div2r*dx.x*dx.z;
+                        m_virial_partial[3+6*mem_idx] += force_div2r*dx.y*dx.y;
+                        m_virial_partial[4+6*mem_idx] += force_div2r*dx.y*dx.z;
+                        m_virial_partial[5+6*mem_idx] += force_div2r*dx.z*dx.z;
+                        }
+                    }
+                }
+            }
+
+        // the remaining neighbors (all of them when the block form is not used) go through the per neighbor loop
+        for (unsigned int k = block_end; k < size; k++)
             {
             // access the index of this neighbor (MEM TRANSFER: 1 scalar)
             unsigned int j = h_nlist.data[nli(i, k)];
@@ -519,6 +735,18 @@ void PotentialPair< evaluator >::computeForces(unsigned int timestep)
             }
             
         // finally, increment the force, potential energy and virial for particle i
+        if (owner)
+            {
+            h_force.data[i] = make_scalar4(fi.x, fi.y, fi.z, pei);
+            h_virial.data[0*m_virial_pitch+i] = virialxxi;
+            h_virial.data[1*m_virial_pitch+i] = virialxyi;
+            h_virial.data[2*m_virial_pitch+i] = virialxzi;
+            h_virial.data[3*m_virial_pitch+i] = virialyyi;
+            h_virial.data[4*m_virial_pitch+i] = virialyzi;
+            h_virial.data[5*m_virial_pitch+i] = virialzzi;
+            continue;
+            }
+
         unsigned int mem_idx = m_index_thread_partial(i,tid);
         m_fdata_partial[mem_idx].x += fi.x;
         m_fdata_partial[mem_idx].y += fi.y;
@@ -534,39 +762,42 @@ void PotentialPair< evaluator >::computeForces(unsigned int timestep)
             m_virial_partial[5+6*mem_idx] += virialzzi;
             }
         }
+
+    // the results are complete in the owner computes mode
+    if (!owner && last_range)
+        {
 #pragma omp barrier
     
-    // now that the partial sums are complete, sum up the results in parallel
+        // now that the partial sums are complete, sum up the results in parallel
 #pragma omp for
-    for (int i = 0; i < (int) m_pdata->getN(); i++)
-        {
-        // assign result from thread 0
-        h_force.data[i].x = m_fdata_partial[i].x;
-        h_force.data[i].y = m_fdata_partial[i].y;
-        h_force.data[i].z = m_fdata_partial[i].z;
-        h_force.data[i].w = m_fdata_partial[i].w;
-
-        for (int j = 0; j < 6; j++)
-            h_virial.data[j*m_virial_pitch+i] = m_virial_partial[j+6*i];
-
-        #ifdef ENABLE_OPENMP
-        // add results from other threads
-        int nthreads = omp_get_num_threads();
-        for (int thread = 1; thread < nthreads; thread++)
+        for (int i = 0; i < (int) m_pdata->getN(); i++)
             {
-            unsigned int mem_idx = m_index_thread_partial(i,thread);
-            h_force.data[i].x += m_fdata_partial[mem_idx].x;
-            h_force.data[i].y += m_fdata_partial[mem_idx].y;
-            h_force.data[i].z += m_fdata_partial[mem_idx].z;
-            h_force.data[i].w += m_fdata_partial[mem_idx].w;
+            // assign result from thread 0
+            h_force.data[i].x = m_fdata_partial[i].x;
+            h_force.data[i].y = m_fdata_partial[i].y;
+            h_force.data[i].z = m_fdata_partial[i].z;
+            h_force.data[i].w = m_fdata_partial[i].w;
+
             for (int j = 0; j < 6; j++)
-                h_virial.data[j*m_virial_pitch+i] += m_virial_partial[j+6*mem_idx];
+                h_virial.data[j*m_virial_pitch+i] = m_virial_partial[j+6*i];
+
+            #ifdef ENABLE_OPENMP
+            // add results from other threads
+            int nthreads = omp_get_num_threads();
+            for (int thread = 1; thread < nthreads; thread++)
+                {
+                unsigned int mem_idx = m_index_thread_partial(i,thread);
+                h_force.data[i].x += m_fdata_partial[mem_idx].x;
+                h_force.data[i].y += m_fdata_partial[mem_idx].y;
+                h_force.data[i].z += m_fdata_partial[mem_idx].z;
+                h_force.data[i].w += m_fdata_partial[mem_idx].w;
+                for (int j = 0; j < 6; j++)
+                    h_virial.data[j*m_virial_pitch+i] += m_virial_partial[j+6*mem_idx];
+                }
+            #endif
             }
-        #endif
         }
     } // end omp parallel
-
-    if (m_prof) m_prof->pop();
     }
 
 //! Export this pair potential to python
@@ -582,6 +813,7 @@ template < class T > void export_PotentialPair(const std::string& name)
                   .def("setRcut", &T::setRcut)
                   .def("setRon", &T::setRon)
                   .def("setShiftMode", &T::setShiftMode)
+                  .def("setVectorized", &T::setVectorized)
                   ;
                   
     boost::python::enum_<typename T::energyShiftMode>("energyShiftMode")
@@ -114,6 +114,14 @@ class PotentialPairDPDThermo : public PotentialPair<evaluator>
         //! Set the temperature
         virtual void setT(boost::shared_ptr<Variant> T);
 
+#ifdef ENABLE_MPI
+        //! The DPD forces are computed after the ghost update has completed
+        virtual bool overlapsGhostUpdate()
+            {
+            return false;
+            }
+#endif
+
     protected:
 
         unsigned int m_seed;  //!< seed for PRNG for DPD thermostat
@@ -173,6 +181,15 @@ void PotentialPairDPDThermo< evaluator >::computeForces(unsigned int timestep)
     // to reduce computations at the cost of memory access complexity: set that flag now
     bool third_law = this->m_nlist->getStorageMode() == NeighborList::half;
 
+    // in the owner computes mode, each thread writes the results for its own particles directly to the output arrays
+    bool owner = this->m_thread_accumulation == ForceCompute::owner_computes;
+    if (owner && third_law)
+        {
+        this->m_exec_conf->msg->error() << "pair." << evaluator::getName()
+                                        << ": owner computes accumulation requires a full neighbor list" << std::endl;
+        throw std::runtime_error("Error computing pair forces");
+        }
+
     // access the neighbor list, particle data, and system box
     ArrayHandle<unsigned int> h_n_neigh(this->m_nlist->getNNeighArray(), access_location::host, access_mode::read);
     ArrayHandle<unsigned int> h_nlist(this->m_nlist->getNListArray(), access_location::host, access_mode::read);
@@ -199,8 +216,11 @@ void PotentialPairDPDThermo< evaluator >::computeForces(unsigned int timestep)
     #endif
 
     // need to start from a zero force, energy and virial
-    memset(&(this->m_fdata_partial[this->m_index_thread_partial(0,tid)]) , 0, sizeof(Scalar4)*this->m_pdata->getN());
-    memset(&(this->m_virial_partial[6*this->m_index_thread_partial(0,tid)]) , 0, 6*sizeof(Scalar)*this->m_pdata->getN());
+    if (!owner)
+        {
+        memset(&(this->m_fdata_partial[this->m_index_thread_partial(0,tid)]) , 0, sizeof(Scalar4)*this->m_pdata->getN());
+        memset(&(this->m_virial_partial[6*this->m_index_thread_partial(0,tid)]) , 0, 6*sizeof(Scalar)*this->m_pdata->getN());
+        }
 
     // for each particle
 #pragma omp for schedule(guided)
@@ -312,6 +332,14 @@ void PotentialPairDPDThermo< evaluator >::computeForces(unsigned int timestep)
             }
 
         // finally, increment the force, potential energy and virial for particle i
+        if (owner)
+            {
+            h_force.data[i] = make_scalar4(fi.x, fi.y, fi.z, pei);
+            for (unsigned int l = 0; l < 6; l++)
+                h_virial.data[l*this->m_virial_pitch+i] = viriali[l];
+            continue;
+            }
+
         unsigned int mem_idx = this->m_index_thread_partial(i,tid);
         this->m_fdata_partial[mem_idx].x += fi.x;
         this->m_fdata_partial[mem_idx].y += fi.y;
@@ -320,35 +348,40 @@ void PotentialPairDPDThermo< evaluator >::computeForces(unsigned int timestep)
         for (unsigned int l = 0; l < 6; l++)
             this->m_virial_partial[l+6*mem_idx] += viriali[l];
         }
-#pragma omp barrier
 
-    // now that the partial sums are complete, sum up the results in parallel
-#pragma omp for
-    for (int i = 0; i < (int)this->m_pdata->getN(); i++)
+    // the results are complete in the owner computes mode
+    if (!owner)
         {
-        // assign result from thread 0
-        h_force.data[i].x = this->m_fdata_partial[i].x;
-        h_force.data[i].y = this->m_fdata_partial[i].y;
-        h_force.data[i].z = this->m_fdata_partial[i].z;
-        h_force.data[i].w = this->m_fdata_partial[i].w;
-        for (unsigned int l = 0; l < 6; l++)
-            h_virial.data[l*this->m_virial_pitch+i]  = this->m_virial_partial[l+6*i];
+#pragma omp barrier
 
-        #ifdef ENABLE_OPENMP
-        // add results from other threads
-        int nthreads = omp_get_num_threads();
-        for (int thread = 1; thread < nthreads; thread++)
+        // now that the partial sums are complete, sum up the results in parallel
+#pragma omp for
+        for (int i = 0; i < (int)this->m_pdata->getN(); i++)
             {
-            unsigned int mem_idx = this->m_index_thread_partial(i,thread);
-            h_force.data[i].x += this->m_fdata_partial[mem_idx].x;
-            h_force.data[i].y += this->m_fdata_partial[mem_idx].y;
-            h_force.data[i].z += this->m_fdata_partial[mem_idx].z;
-            h_force.data[i].w += this->m_fdata_partial[mem_idx].w;
-            h_virial.data[i]  += this->m_virial_partial[mem_idx];
+            // assign result from thread 0
+            h_force.data[i].x = this->m_fdata_partial[i].x;
+            h_force.data[i].y = this->m_fdata_partial[i].y;
+            h_force.data[i].z = this->m_fdata_partial[i].z;
+            h_force.data[i].w = this->m_fdata_partial[i].w;
             for (unsigned int l = 0; l < 6; l++)
-                 h_virial.data[l*this->m_virial_pitch+i]  = this->m_virial_partial[l+6*mem_idx];
+                h_virial.data[l*this->m_virial_pitch+i]  = this->m_virial_partial[l+6*i];
+
+            #ifdef ENABLE_OPENMP
+            // add results from other threads
+            int nthreads = omp_get_num_threads();
+            for (int thread = 1; thread < nthreads; thread++)
+                {
+                unsigned int mem_idx = this->m_index_thread_partial(i,thread);
+                h_force.data[i].x += this->m_fdata_partial[mem_idx].x;
+                h_force.data[i].y += this->m_fdata_partial[mem_idx].y;
+                h_force.data[i].z += this->m_fdata_partial[mem_idx].z;
+                h_force.data[i].w += this->m_fdata_partial[mem_idx].w;
+                h_virial.data[i]  += this->m_virial_partial[mem_idx];
+                for (unsigned int l = 0; l < 6; l++)
+                     h_virial.data[l*this->m_virial_pitch+i]  = this->m_virial_partial[l+6*mem_idx];
+                }
+            #endif
             }
-        #endif
         }
     } // end omp parallel
 
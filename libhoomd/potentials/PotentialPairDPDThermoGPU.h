@@ -106,6 +106,13 @@ class PotentialPairDPDThermoGPU : public PotentialPairDPDThermo<evaluator>
             {
             m_block_size = block_size;
             }
+
+        //! The GPU compute does not use the thread accumulation modes
+        virtual bool supportsThreadAccumulation()
+            {
+            return false;
+            }
+
     protected:
         unsigned int m_block_size;  //!< Block size to execute on the GPU
 
@@ -106,6 +106,20 @@ class PotentialPairGPU : public PotentialPair<evaluator>
             {
             m_block_size = block_size;
             }
+
+        //! The GPU compute does not use the thread accumulation modes
+        virtual bool supportsThreadAccumulation()
+            {
+            return false;
+            }
+
+#ifdef ENABLE_MPI
+        //! The GPU forces are computed after the ghost update has completed
+        virtual bool overlapsGhostUpdate()
+            {
+            return false;
+            }
+#endif
     protected:
         unsigned int m_block_size;  //!< Block size to execute on the GPU
         
@@ -62,8 +62,11 @@ using namespace boost::python;
 
 #ifdef ENABLE_MPI
 #include "Communicator.h"
+#include "HOOMDMPI.h"
 #endif
 
+#include <iomanip>
+
 /*! \file IntegrationMethodTwoStep.h
     \brief Contains code for the IntegrationMethodTwoStep class
 */
@@ -75,7 +78,7 @@ using namespace boost::python;
 IntegrationMethodTwoStep::IntegrationMethodTwoStep(boost::shared_ptr<SystemDefinition> sysdef,
                                                    boost::shared_ptr<ParticleGroup> group)
     : m_sysdef(sysdef), m_group(group), m_pdata(m_sysdef->getParticleData()), exec_conf(m_pdata->getExecConf()), 
-      m_deltaT(Scalar(0.0)), m_valid_restart(false)
+      m_deltaT(Scalar(0.0)), m_check_replicated_state(false), m_valid_restart(false)
     {
     // sanity check
     assert(m_sysdef);
@@ -184,12 +187,67 @@ void IntegrationMethodTwoStep::validateGroup()
         }
     }
 
+#ifdef ENABLE_MPI
+/*! \param comm MPI communication class
+
+    Integration methods with thermostat or barostat variables advance them redundantly on every rank from globally
+    reduced quantities. The variables are broadcast from the root rank here, once per run, so that all ranks start
+    out from the same state (e.g. restart data that was only read on the root rank).
+*/
+void IntegrationMethodTwoStep::setCommunicator(boost::shared_ptr<Communicator> comm)
+    {
+    assert(comm);
+    m_comm = comm;
+
+    IntegratorVariables v = getIntegratorVariables();
+    bcast(v.variable, 0, m_exec_conf->getMPICommunicator());
+    setIntegratorVariables(v);
+    }
+#endif
+
+/*! \param values State variables that every rank derives independently
+    \param timestep Current time step
+
+    When checking is enabled with setCheckReplicatedState(), all ranks must hold bitwise identical \a values,
+    otherwise an error is raised on all ranks. The check costs one MPI_Allreduce and is meant for debugging only.
+    Without MPI or with checking disabled, this method does nothing.
+*/
+void IntegrationMethodTwoStep::checkReplicatedState(const std::vector<Scalar>& values, unsigned int timestep)
+    {
+#ifdef ENABLE_MPI
+    if (!m_check_replicated_state || !m_comm || values.size() == 0)
+        return;
+
+    // a single reduction yields both the maximum and the (negated) minimum of every value
+    unsigned int n = values.size();
+    std::vector<Scalar> extrema(2*n);
+    for (unsigned int i = 0; i < n; i++)
+        {
+        extrema[i] = values[i];
+        extrema[n+i] = -values[i];
+        }
+
+    MPI_Allreduce(MPI_IN_PLACE, &extrema[0], 2*n, MPI_HOOMD_SCALAR, MPI_MAX, m_exec_conf->getMPICommunicator());
+
+    for (unsigned int i = 0; i < n; i++)
+        {
+        if (!(extrema[i] == -extrema[n+i]))
+            {
+            m_exec_conf->msg->error() << "integrate.*: State variable " << i << " differs between ranks at step "
+                                      << timestep << " (" << std::setprecision(17) << -extrema[n+i] << " to "
+                                      << extrema[i] << ")" << std::endl;
+            throw std::runtime_error("Error in integration method");
+            }
+        }
+#endif
+    }
 
 void export_IntegrationMethodTwoStep()
     {
     class_<IntegrationMethodTwoStep, boost::shared_ptr<IntegrationMethodTwoStep>, boost::noncopyable>
         ("IntegrationMethodTwoStep", init< boost::shared_ptr<SystemDefinition>, boost::shared_ptr<ParticleGroup> >())
         .def("validateGroup", &IntegrationMethodTwoStep::validateGroup)
+        .def("setCheckReplicatedState", &IntegrationMethodTwoStep::setCheckReplicatedState)
 #ifdef ENABLE_MPI
         .def("setCommunicator", &IntegrationMethodTwoStep::setCommunicator)
 #endif
@@ -64,6 +64,9 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 class Communicator;
 #endif
 
+//! Forward declaration
+class ComputeThermo;
+
 /*! \file IntegrationMethodTwoStep.h
     \brief Declares a base class for all two-step integration methods
 */
@@ -164,6 +167,23 @@ class IntegrationMethodTwoStep : boost::noncopyable
             {
             }
         
+        //! Get the parts of the second step that the integrator may fuse with the net force sum
+        /*! \param kick Set to true if integrateStepTwo() is nothing but the velocity Verlet half-kick
+                        v += F/m deltaT/2 of all group members. The integrator then applies the kick in the net force
+                        pass and does not call integrateStepTwo().
+            \param thermo Set to the compute whose properties at timestep+1 the integrator should accumulate in the
+                          net force pass, after the kick if \a kick is set and before the second step otherwise.
+                          Left NULL if there is none.
+            \returns true if any part of the second step can be fused
+
+            The integrator only asks when this method is the only one and integrates all particles. The base class
+            fuses nothing.
+        */
+        virtual bool getFusedStepTwo(bool& kick, boost::shared_ptr<ComputeThermo>& thermo)
+            {
+            return false;
+            }
+
         //! Sets the profiler for the integration method to use
         void setProfiler(boost::shared_ptr<Profiler> prof);
         
@@ -221,14 +241,16 @@ class IntegrationMethodTwoStep : boost::noncopyable
 
 #ifdef ENABLE_MPI
         //! Set the communicator to use
-        /*! \param comm MPI communication class
-         */
-        void setCommunicator(boost::shared_ptr<Communicator> comm)
+        void setCommunicator(boost::shared_ptr<Communicator> comm);
+#endif
+
+        //! Set whether the replicated integrator state is checked for consistency between ranks
+        /*! \param check True to verify after every step that all ranks agree on the thermostat and barostat state
+        */
+        void setCheckReplicatedState(bool check)
             {
-            assert(comm);
-            m_comm = comm;
+            m_check_replicated_state = check;
             }
-#endif
 
     protected:
         const boost::shared_ptr<SystemDefinition> m_sysdef; //!< The system definition this method is associated with
@@ -260,8 +282,12 @@ class IntegrationMethodTwoStep : boost::noncopyable
         //! Set whether this restart is valid
         void setValidRestart(bool b) { m_valid_restart = b; }
 
+        //! Verify that state variables advanced independently on every rank agree between the ranks
+        void checkReplicatedState(const std::vector<Scalar>& values, unsigned int timestep);
+
     protected:
         bool m_no_wrap_particles[3];                           //!< True if particles should not be wrapped across boundaries in a given direction
+        bool m_check_replicated_state;                      //!< True if replicated state is checked between ranks
 #ifdef ENABLE_MPI
         boost::shared_ptr<Communicator> m_comm;             //!< The communicator to use for MPI
 #endif
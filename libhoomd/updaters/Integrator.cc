@@ -74,8 +74,181 @@ using namespace boost;
 #include "Communicator.h"
 #endif
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
+//! Number of particles per block in sum_net_force()
+/*! The net force, torque and virial of one block (a few tens of kB) stay in cache while the contributions of all
+    force computes are added to them. The net arrays are thus written to memory once per step, instead of being
+    cleared and then read and written again for every force compute.
+*/
+const unsigned int net_force_block_size = 512;
+
+//! Host pointers to the per-particle arrays of a list of force computes
+struct net_force_list
+    {
+    std::vector<const Scalar4 *> forces;            //!< Force arrays
+    std::vector<const Scalar4 *> torques;           //!< Torque arrays (may be empty)
+    std::vector<const Scalar *> virials;            //!< Virial arrays
+    std::vector<unsigned int> virial_pitches;       //!< Pitches of the virial arrays
+    };
+
+//! Sums the forces, torques and virials of a list of force computes into the net arrays
+/*! \param net_force Net force array
+    \param net_torque Net torque array, NULL if no torques are summed
+    \param net_virial Net virial array
+    \param net_virial_pitch Pitch of \a net_virial
+    \param force_list Arrays of the individual force computes
+    \param N Number of particles to sum over
+    \param overwrite If true, the net arrays are overwritten, otherwise the contributions are added to them
+    \param fused Second half step to apply in the same pass, NULL if there is none
+    \param vel Particle velocities, only needed with \a fused
+    \param accel Particle accelerations, only needed with \a fused
+    \param deltaT Time step, only needed with \a fused
+    \param flags Particle data flags that select the thermodynamic sums, only needed with \a fused
+
+    The particles are processed in blocks of net_force_block_size, and the blocks are distributed over the OpenMP
+    threads. The half-kick and the thermodynamic sums of \a fused are done on each block while it is still in cache.
+    The per-thread thermodynamic sums are combined in thread order, with a single thread they are accumulated in the
+    same order as in ComputeThermo::computeProperties().
+*/
+static void sum_net_force(Scalar4 *net_force,
+                          Scalar4 *net_torque,
+                          Scalar *net_virial,
+                          unsigned int net_virial_pitch,
+                          const net_force_list& force_list,
+                          unsigned int N,
+                          bool overwrite,
+                          FusedStepTwo *fused=NULL,
+                          Scalar4 *vel=NULL,
+                          Scalar3 *accel=NULL,
+                          Scalar deltaT=Scalar(0.0),
+                          PDataFlags flags=PDataFlags())
+    {
+    unsigned int nforces = force_list.forces.size();
+    bool sum_torque = net_torque != NULL && force_list.torques.size() == nforces;
+    int nblocks = (N + net_force_block_size - 1) / net_force_block_size;
+
+    bool kick = fused != NULL && fused->kick;
+    bool sum_thermo = fused != NULL && fused->sum_thermo;
+    bool compute_pressure_tensor = flags[pdata_flag::pressure_tensor];
+    bool compute_pe = flags[pdata_flag::potential_energy];
+    bool compute_virial = compute_pressure_tensor || flags[pdata_flag::isotropic_virial];
+
+    // one set of thermodynamic sums per thread
+    unsigned int n_threads = 1;
+#ifdef ENABLE_OPENMP
+    n_threads = omp_get_max_threads();
+#endif
+    std::vector<double> partial_sums;
+    if (sum_thermo)
+        partial_sums.resize(n_threads*thermo_sum::num_sums, 0.0);
+
+#pragma omp parallel
+    {
+    int tid = 0;
+#ifdef ENABLE_OPENMP
+    tid = omp_get_thread_num();
+#endif
+    double sum[thermo_sum::num_sums];
+    double c[thermo_sum::num_sums];
+    memset(sum, 0, sizeof(double)*thermo_sum::num_sums);
+    memset(c, 0, sizeof(double)*thermo_sum::num_sums);
+
+#pragma omp for schedule(static)
+    for (int block = 0; block < nblocks; block++)
+        {
+        unsigned int start = block*net_force_block_size;
+        unsigned int end = start + net_force_block_size;
+        if (end > N)
+            end = N;
+
+        if (overwrite)
+            {
+            for (unsigned int j = start; j < end; j++)
+                net_force[j] = make_scalar4(0.0, 0.0, 0.0, 0.0);
+            if (net_torque != NULL)
+                for (unsigned int j = start; j < end; j++)
+                    net_torque[j] = make_scalar4(0.0, 0.0, 0.0, 0.0);
+            for (unsigned int k = 0; k < 6; k++)
+                for (unsigned int j = start; j < end; j++)
+                    net_virial[k*net_virial_pitch+j] = Scalar(0.0);
+            }
+
+        for (unsigned int cur_force = 0; cur_force < nforces; cur_force++)
+            {
+            const Scalar4 *force = force_list.forces[cur_force];
+            for (unsigned int j = start; j < end; j++)
+                {
+                net_force[j].x += force[j].x;
+                net_force[j].y += force[j].y;
+                net_force[j].z += force[j].z;
+                net_force[j].w += force[j].w;
+                }
+
+            if (sum_torque)
+                {
+                const Scalar4 *torque = force_list.torques[cur_force];
+                for (unsigned int j = start; j < end; j++)
+                    {
+                    net_torque[j].x += torque[j].x;
+                    net_torque[j].y += torque[j].y;
+                    net_torque[j].z += torque[j].z;
+                    net_torque[j].w += torque[j].w;
+                    }
+                }
+
+            const Scalar *virial = force_list.virials[cur_force];
+            unsigned int virial_pitch = force_list.virial_pitches[cur_force];
+            for (unsigned int k = 0; k < 6; k++)
+                for (unsigned int j = start; j < end; j++)
+                    net_virial[k*net_virial_pitch+j] += virial[k*virial_pitch+j];
+            }
+
+        // v(t+deltaT) = v(t+deltaT/2) + 1/2 * a(t+deltaT)*deltaT, as in TwoStepNVE::integrateStepTwo()
+        if (kick)
+            {
+            for (unsigned int j = start; j < end; j++)
+                {
+                Scalar minv = Scalar(1.0) / vel[j].w;
+                accel[j].x = net_force[j].x*minv;
+                accel[j].y = net_force[j].y*minv;
+                accel[j].z = net_force[j].z*minv;
+
+                vel[j].x += Scalar(1.0/2.0)*accel[j].x*deltaT;
+                vel[j].y += Scalar(1.0/2.0)*accel[j].y*deltaT;
+                vel[j].z += Scalar(1.0/2.0)*accel[j].z*deltaT;
+                }
+            }
+
+        if (sum_thermo)
+            {
+            for (unsigned int j = start; j < end; j++)
+                thermo_add_particle(sum, c, vel[j], net_force[j].w, net_virial + j, net_virial_pitch,
+                                    compute_pe, compute_virial, compute_pressure_tensor);
+            }
+        }
+
+    if (sum_thermo)
+        for (unsigned int k = 0; k < thermo_sum::num_sums; k++)
+            partial_sums[tid*thermo_sum::num_sums + k] = sum[k];
+    }
+
+    if (sum_thermo)
+        {
+        // combine the partial sums in thread order
+        double c[thermo_sum::num_sums];
+        memset(c, 0, sizeof(double)*thermo_sum::num_sums);
+        memset(fused->sums, 0, sizeof(double)*thermo_sum::num_sums);
+        for (unsigned int tid = 0; tid < n_threads; tid++)
+            for (unsigned int k = 0; k < thermo_sum::num_sums; k++)
+                kahan_add(fused->sums[k], c[k], partial_sums[tid*thermo_sum::num_sums + k]);
+        }
+    }
+
 /*! \param sysdef System to update
     \param deltaT Time step to use
 */
@@ -329,15 +502,38 @@ Scalar Integrator::computeTotalMomentum(unsigned int timestep)
     }
 
 /*! \param timestep Current time step of the simulation
+    \param fused Second half step to apply while the net force is summed, NULL if there is none
     \post All added force computes in \a m_forces are computed and totaled up in \a m_net_force and \a m_net_virial
     \note The summation step is performed <b>on the CPU</b> and will result in a lot of data traffic back and forth
           if the forces and/or integrater are on the GPU. Call computeNetForcesGPU() to sum the forces on the GPU
+    \note \a fused acts on all particles and is only applied to the sum of \a m_forces. The caller must make sure that
+          there are no constraint forces when it passes \a fused.
 */
-void Integrator::computeNetForce(unsigned int timestep)
+void Integrator::computeNetForce(unsigned int timestep, FusedStepTwo *fused)
     {
+    assert(fused == NULL || m_constraint_forces.size() == 0);
+
     std::vector< boost::shared_ptr<ForceCompute> >::iterator force_compute;
-    for (force_compute = m_forces.begin(); force_compute != m_forces.end(); ++force_compute)
-        (*force_compute)->compute(timestep);
+#ifdef ENABLE_MPI
+    // with a ghost update in flight, the force computes that overlap it go first, the others wait for the ghosts
+    if (m_comm && m_comm->isGhostUpdatePending())
+        {
+        for (force_compute = m_forces.begin(); force_compute != m_forces.end(); ++force_compute)
+            if ((*force_compute)->overlapsGhostUpdate())
+                (*force_compute)->compute(timestep);
+
+        m_comm->finishUpdateGhosts(timestep);
+
+        for (force_compute = m_forces.begin(); force_compute != m_forces.end(); ++force_compute)
+            if (!(*force_compute)->overlapsGhostUpdate())
+                (*force_compute)->compute(timestep);
+        }
+    else
+#endif
+        {
+        for (force_compute = m_forces.begin(); force_compute != m_forces.end(); ++force_compute)
+            (*force_compute)->compute(timestep);
+        }
 
     if (m_prof)
         {
@@ -354,56 +550,65 @@ void Integrator::computeNetForce(unsigned int timestep)
         ArrayHandle<Scalar4> h_net_force(net_force, access_location::host, access_mode::overwrite);
         ArrayHandle<Scalar> h_net_virial(net_virial, access_location::host, access_mode::overwrite);
         ArrayHandle<Scalar4> h_net_torque(net_torque, access_location::host, access_mode::overwrite);
-        
-        // start by zeroing the net force and virial arrays
-        memset((void *)h_net_force.data, 0, sizeof(Scalar4)*net_force.getNumElements());
-        memset((void *)h_net_virial.data, 0, sizeof(Scalar)*net_virial.getNumElements());
-        memset((void *)h_net_torque.data, 0, sizeof(Scalar4)*net_torque.getNumElements());
 
         for (unsigned int i = 0; i < 6; ++i)
            external_virial[i] = Scalar(0.0);
         
-        // now, add up the net forces
         unsigned int nparticles = m_pdata->getN();
         unsigned int net_virial_pitch = net_virial.getPitch();
         assert(nparticles <= net_force.getNumElements());
         assert(6*nparticles <= net_virial.getNumElements());
         assert(nparticles <= net_torque.getNumElements());
 
+        // acquire the arrays of all force computes, the handles are held until the sum is done
+        std::vector< boost::shared_ptr< ArrayHandle<Scalar4> > > force_handles;
+        std::vector< boost::shared_ptr< ArrayHandle<Scalar4> > > torque_handles;
+        std::vector< boost::shared_ptr< ArrayHandle<Scalar> > > virial_handles;
+        net_force_list force_list;
+
         for (force_compute = m_forces.begin(); force_compute != m_forces.end(); ++force_compute)
             {
-            //phasing out ForceDataArrays
-            //ForceDataArrays force_arrays = (*force_compute)->acquire();
             GPUArray<Scalar4>& h_force_array = (*force_compute)->getForceArray();
             GPUArray<Scalar>& h_virial_array = (*force_compute)->getVirialArray();
             GPUArray<Scalar4>& h_torque_array = (*force_compute)->getTorqueArray();
 
-            ArrayHandle<Scalar4> h_force(h_force_array,access_location::host,access_mode::read);
-            ArrayHandle<Scalar> h_virial(h_virial_array,access_location::host,access_mode::read);
-            ArrayHandle<Scalar4> h_torque(h_torque_array,access_location::host,access_mode::read);
+            force_handles.push_back(boost::shared_ptr< ArrayHandle<Scalar4> >(
+                new ArrayHandle<Scalar4>(h_force_array, access_location::host, access_mode::read)));
+            virial_handles.push_back(boost::shared_ptr< ArrayHandle<Scalar> >(
+                new ArrayHandle<Scalar>(h_virial_array, access_location::host, access_mode::read)));
+            torque_handles.push_back(boost::shared_ptr< ArrayHandle<Scalar4> >(
+                new ArrayHandle<Scalar4>(h_torque_array, access_location::host, access_mode::read)));
 
-            unsigned int virial_pitch = h_virial_array.getPitch();
-            for (unsigned int j = 0; j < nparticles; j++)
-                {
-                h_net_force.data[j].x += h_force.data[j].x;
-                h_net_force.data[j].y += h_force.data[j].y;
-                h_net_force.data[j].z += h_force.data[j].z;
-                h_net_force.data[j].w += h_force.data[j].w;
-                
-                h_net_torque.data[j].x += h_torque.data[j].x;
-                h_net_torque.data[j].y += h_torque.data[j].y;
-                h_net_torque.data[j].z += h_torque.data[j].z;
-                h_net_torque.data[j].w += h_torque.data[j].w;
-
-                for (unsigned int k = 0; k < 6; k++)
-                    {
-                    h_net_virial.data[k*net_virial_pitch+j] += h_virial.data[k*virial_pitch+j];
-                    }
-                }
+            force_list.forces.push_back(force_handles.back()->data);
+            force_list.virials.push_back(virial_handles.back()->data);
+            force_list.virial_pitches.push_back(h_virial_array.getPitch());
+            force_list.torques.push_back(torque_handles.back()->data);
 
             for (unsigned int k = 0; k < 6; k++)
                 external_virial[k] += (*force_compute)->getExternalVirial(k);
             }
+
+        // now, add up the net forces, overwriting the previous contents
+        if (fused)
+            {
+            ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
+            ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::readwrite);
+            sum_net_force(h_net_force.data, h_net_torque.data, h_net_virial.data, net_virial_pitch, force_list,
+                          nparticles, true, fused, h_vel.data, h_accel.data, m_deltaT, m_pdata->getFlags());
+            }
+        else
+            sum_net_force(h_net_force.data, h_net_torque.data, h_net_virial.data, net_virial_pitch, force_list,
+                          nparticles, true);
+
+        // zero the remainder of the arrays (ghost particles and padding) that is not covered by the sum
+        if (net_force.getNumElements() > nparticles)
+            memset((void *)(h_net_force.data + nparticles), 0, sizeof(Scalar4)*(net_force.getNumElements()-nparticles));
+        if (net_torque.getNumElements() > nparticles)
+            memset((void *)(h_net_torque.data + nparticles), 0, sizeof(Scalar4)*(net_torque.getNumElements()-nparticles));
+        if (net_virial_pitch > nparticles)
+            for (unsigned int k = 0; k < 6; k++)
+                memset((void *)(h_net_virial.data + k*net_virial_pitch + nparticles), 0,
+                       sizeof(Scalar)*(net_virial_pitch-nparticles));
         }
    
     for (unsigned int k = 0; k < 6; k++)
@@ -441,31 +646,33 @@ void Integrator::computeNetForce(unsigned int timestep)
 
         // now, add up the net forces
         unsigned int nparticles = m_pdata->getN();
-        assert(nparticles == net_force.getNumElements());
+        assert(nparticles <= net_force.getNumElements());
         assert(6*nparticles <= net_virial.getNumElements());
+
+        std::vector< boost::shared_ptr< ArrayHandle<Scalar4> > > force_handles;
+        std::vector< boost::shared_ptr< ArrayHandle<Scalar> > > virial_handles;
+        net_force_list force_list;
+
         for (force_constraint = m_constraint_forces.begin(); force_constraint != m_constraint_forces.end(); ++force_constraint)
             {
-            //phasing out ForceDataArrays
-            //ForceDataArrays force_arrays = (*force_compute)->acquire();
             GPUArray<Scalar4>& h_force_array =(*force_constraint)->getForceArray();
             GPUArray<Scalar>& h_virial_array =(*force_constraint)->getVirialArray();
-            ArrayHandle<Scalar4> h_force(h_force_array,access_location::host,access_mode::read);
-            ArrayHandle<Scalar> h_virial(h_virial_array,access_location::host,access_mode::read);
-            unsigned int virial_pitch = h_virial_array.getPitch();
 
-       
-            for (unsigned int j = 0; j < nparticles; j++)
-                {
-                h_net_force.data[j].x += h_force.data[j].x;
-                h_net_force.data[j].y += h_force.data[j].y;
-                h_net_force.data[j].z += h_force.data[j].z;
-                h_net_force.data[j].w += h_force.data[j].w;
-                for (unsigned int k = 0; k < 6; k++)
-                    h_net_virial.data[k*net_virial_pitch+j] += h_virial.data[k*virial_pitch+j];
-                }
+            force_handles.push_back(boost::shared_ptr< ArrayHandle<Scalar4> >(
+                new ArrayHandle<Scalar4>(h_force_array, access_location::host, access_mode::read)));
+            virial_handles.push_back(boost::shared_ptr< ArrayHandle<Scalar> >(
+                new ArrayHandle<Scalar>(h_virial_array, access_location::host, access_mode::read)));
+
+            force_list.forces.push_back(force_handles.back()->data);
+            force_list.virials.push_back(virial_handles.back()->data);
+            force_list.virial_pitches.push_back(h_virial_array.getPitch());
+
             for (unsigned int k = 0; k < 6; k++)
                 external_virial[k] += (*force_constraint)->getExternalVirial(k);
             }
+
+        // constraint forces only apply a force, not a torque, and are added on top of the other forces
+        sum_net_force(h_net_force.data, NULL, h_net_virial.data, net_virial_pitch, force_list, nparticles, false);
         }
     
     for (unsigned int k = 0; k < 6; k++)
@@ -65,6 +65,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ForceCompute.h"
 #include "ForceConstraint.h"
 #include "ParticleGroup.h"
+#include "ComputeThermo.h"
 #include <string>
 #include <vector>
 
@@ -72,6 +73,18 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cuda_runtime.h>
 #endif
 
+//! Second half step that Integrator::computeNetForce() can apply while it sums the net force
+/*! When \a kick is set, every particle gets the velocity Verlet half-kick v += a deltaT/2 with a = F/m right after its
+    net force is summed, and its acceleration is set to a. When \a sum_thermo is set, the partial sums of ComputeThermo
+    are accumulated over all particles (after the kick, if there is one) and can be handed to ComputeThermo::setSums().
+*/
+struct FusedStepTwo
+    {
+    bool kick;                              //!< True if the half-kick is applied
+    bool sum_thermo;                        //!< True if the thermodynamic sums are accumulated
+    double sums[thermo_sum::num_sums];      //!< The accumulated sums, indexed by thermo_sum
+    };
+
 //! Base class that defines an integrator
 /*! An Integrator steps the entire simulation forward one time step in time.
     Prior to calling update(timestep), the system is at time step \a timestep.
@@ -168,7 +181,7 @@ class Integrator : public Updater
         void computeAccelerations(unsigned int timestep);
         
         //! helper function to compute net force/virial
-        void computeNetForce(unsigned int timestep);
+        void computeNetForce(unsigned int timestep, FusedStepTwo *fused=NULL);
         
 #ifdef ENABLE_CUDA
         //! helper function to compute net force/virial on the GPU
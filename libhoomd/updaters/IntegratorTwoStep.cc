@@ -72,7 +72,8 @@ using namespace boost;
 #endif
 
 IntegratorTwoStep::IntegratorTwoStep(boost::shared_ptr<SystemDefinition> sysdef, Scalar deltaT)
-    : Integrator(sysdef, deltaT), m_first_step(true), m_prepared(false), m_gave_warning(false)
+    : Integrator(sysdef, deltaT), m_first_step(true), m_prepared(false), m_gave_warning(false),
+      m_fuse_step_two(true)
     {
     m_exec_conf->msg->notice(5) << "Constructing IntegratorTwoStep" << endl;
     }
@@ -175,12 +176,22 @@ void IntegratorTwoStep::update(unsigned int timestep)
 #endif
 
     // compute the net force on all particles
+    FusedStepTwo fused;
+    bool fuse = false;
 #ifdef ENABLE_CUDA
     if (exec_conf->exec_mode == ExecutionConfiguration::GPU)
         computeNetForceGPU(timestep+1);
     else
 #endif
-        computeNetForce(timestep+1);
+        {
+        // apply as much of the second step as possible while the net force is summed
+        boost::shared_ptr<ComputeThermo> fused_thermo;
+        fuse = getFusedStepTwo(fused, fused_thermo);
+        computeNetForce(timestep+1, fuse ? &fused : NULL);
+
+        if (fuse && fused.sum_thermo)
+            fused_thermo->setSums(timestep+1, fused.sums);
+        }
 
     if (m_prof)
         m_prof->push("Integrate");
@@ -190,9 +201,12 @@ void IntegratorTwoStep::update(unsigned int timestep)
     if (flags[pdata_flag::isotropic_virial] && m_sysdef->getRigidData()->getNumBodies() > 0)
         m_sysdef->getRigidData()->computeVirialCorrectionStart();
 
-    // perform the second step of the integration on all groups
-    for (method = m_methods.begin(); method != m_methods.end(); ++method)
-        (*method)->integrateStepTwo(timestep);
+    // perform the second step of the integration on all groups, unless the kick was already applied
+    if (!(fuse && fused.kick))
+        {
+        for (method = m_methods.begin(); method != m_methods.end(); ++method)
+            (*method)->integrateStepTwo(timestep);
+        }
 
     // Update the rigid body particle velocities if they are present
     if (m_sysdef->getRigidData()->getNumBodies() > 0)
@@ -206,6 +220,33 @@ void IntegratorTwoStep::update(unsigned int timestep)
         m_prof->pop();
     }
 
+/*! \param fused Set to the parts of the second step that are applied in the net force pass
+    \param thermo Set to the thermo compute that receives the sums accumulated in the net force pass
+    \returns true if any part of the second step can be fused with the net force sum
+
+    Fusing is possible in the common case of a single integration method that acts on all particles, without rigid
+    bodies and constraint forces. The method itself decides which parts of its second step can be fused.
+*/
+bool IntegratorTwoStep::getFusedStepTwo(FusedStepTwo& fused, boost::shared_ptr<ComputeThermo>& thermo)
+    {
+    if (!m_fuse_step_two || m_methods.size() != 1 || m_constraint_forces.size() > 0)
+        return false;
+
+    if (m_sysdef->getRigidData()->getNumBodies() > 0)
+        return false;
+
+    if (m_methods[0]->getGroup()->getNumMembersGlobal() != m_pdata->getNGlobal())
+        return false;
+
+    bool kick = false;
+    if (!m_methods[0]->getFusedStepTwo(kick, thermo))
+        return false;
+
+    fused.kick = kick;
+    fused.sum_thermo = bool(thermo);
+    return true;
+    }
+
 /*! \param deltaT new deltaT to set
     \post \a deltaT is also set on all contained integration methods
 */
@@ -364,6 +405,7 @@ void export_IntegratorTwoStep()
         ("IntegratorTwoStep", init< boost::shared_ptr<SystemDefinition>, Scalar >())
         .def("addIntegrationMethod", &IntegratorTwoStep::addIntegrationMethod)
         .def("removeAllIntegrationMethods", &IntegratorTwoStep::removeAllIntegrationMethods)
+        .def("setFuseStepTwo", &IntegratorTwoStep::setFuseStepTwo)
         ;
     }
 
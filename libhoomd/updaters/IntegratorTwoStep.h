@@ -118,6 +118,14 @@ class IntegratorTwoStep : public Integrator
         //! Get needed pdata flags
         virtual PDataFlags getRequestedPDataFlags();
 
+        //! Set whether the second step may be fused with the net force sum
+        /*! \param fuse False to always sum the net force and run the second step of the methods separately
+        */
+        void setFuseStepTwo(bool fuse)
+            {
+            m_fuse_step_two = fuse;
+            }
+
 #ifdef ENABLE_MPI
         //! Set the communicator to use
         /*! \param comm The Communicator
@@ -128,11 +136,15 @@ class IntegratorTwoStep : public Integrator
         //! Helper method to test if all added methods have valid restart information
         bool isValidRestart();
 
+        //! Helper method to find the parts of the second step that can be fused with the net force sum
+        bool getFusedStepTwo(FusedStepTwo& fused, boost::shared_ptr<ComputeThermo>& thermo);
+
         std::vector< boost::shared_ptr<IntegrationMethodTwoStep> > m_methods;   //!< List of all the integration methods
         
         bool m_first_step;      //!< True before the first call to update()
         bool m_prepared;        //!< True if preprun has been called
         bool m_gave_warning;    //!< True if a warning has been given about no methods added
+        bool m_fuse_step_two;   //!< True if the second step may be fused with the net force sum
     
     };
 
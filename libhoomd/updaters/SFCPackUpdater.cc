@@ -71,6 +71,10 @@ using namespace boost;
 
 #include "SFCPackUpdater.h"
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 /*! \param sysdef System to perform sorts on
@@ -85,6 +89,7 @@ SFCPackUpdater::SFCPackUpdater(boost::shared_ptr<SystemDefinition> sysdef)
     
     m_sort_order.resize(m_pdata->getMaxN());
     m_particle_bins.resize(m_pdata->getMaxN());
+    m_particle_bins_alt.resize(m_pdata->getMaxN());
     
     // set the default grid
     // Grid dimension must always be a power of 2 and determines the memory usage for m_traversal_order
@@ -104,6 +109,7 @@ void SFCPackUpdater::reallocate()
     {
     m_sort_order.resize(m_pdata->getMaxN());
     m_particle_bins.resize(m_pdata->getMaxN());
+    m_particle_bins_alt.resize(m_pdata->getMaxN());
     }
 
 /*! Destructor
@@ -133,15 +139,22 @@ void SFCPackUpdater::update(unsigned int timestep)
     // apply that sort order to the particles
     applySortOrder();
 
-    m_pdata->notifyParticleSort();
+    // pass the permutation along, so that per-particle tables can be reordered instead of rebuilt
+    m_pdata->notifyParticleSort(m_sort_order);
     
     if (m_prof) m_prof->pop();
     }
 
+/*! All per-particle arrays are gathered into m_records in a single pass, which is then copied back in a second pass.
+    Both passes are split over the OpenMP threads. The reverse tags are rebuilt during the copy back.
+*/
 void SFCPackUpdater::applySortOrder()
     {
     assert(m_pdata);
     assert(m_sort_order.size() >= m_pdata->getN());
+
+    if (m_prof) m_prof->push("gather");
+
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::readwrite);
@@ -152,115 +165,145 @@ void SFCPackUpdater::applySortOrder()
     ArrayHandle<unsigned int> h_tag(m_pdata->getTags(), access_location::host, access_mode::readwrite);
     ArrayHandle<unsigned int> h_rtag(m_pdata->getRTags(), access_location::host, access_mode::readwrite);
 
-    // construct a temporary holding array for the sorted data
-    Scalar4 *scal4_tmp = new Scalar4[m_pdata->getN()];
-    
-    // sort positions and types
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        scal4_tmp[i] = h_pos.data[m_sort_order[i]];
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        h_pos.data[i] = scal4_tmp[i];
-        
-    // sort velocities and mass
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        scal4_tmp[i] = h_vel.data[m_sort_order[i]];
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        h_vel.data[i] = scal4_tmp[i];
-        
-    Scalar3 *scal3_tmp = new Scalar3[m_pdata->getN()];
-    // sort accelerations
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        scal3_tmp[i] = h_accel.data[m_sort_order[i]];
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        h_accel.data[i] = scal3_tmp[i];
-
-    Scalar *scal_tmp  = new Scalar[m_pdata->getN()];
-    // sort charge
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        scal_tmp[i] = h_charge.data[m_sort_order[i]];
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        h_charge.data[i] = scal_tmp[i];
-        
-    // sort diameter
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        scal_tmp[i] = h_diameter.data[m_sort_order[i]];
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        h_diameter.data[i] = scal_tmp[i];
-    
-    // in case anyone access it from frame to frame, sort the net virial
-        {
-        ArrayHandle<Scalar> h_net_virial(m_pdata->getNetVirial(), access_location::host, access_mode::readwrite);
-        unsigned int virial_pitch = m_pdata->getNetVirial().getPitch();
+    // in case anyone access them from frame to frame, also sort the net force, net torque, net virial
+    // and orientation
+    ArrayHandle<Scalar4> h_net_force(m_pdata->getNetForce(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar4> h_net_torque(m_pdata->getNetTorqueArray(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar4> h_orientation(m_pdata->getOrientationArray(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar> h_net_virial(m_pdata->getNetVirial(), access_location::host, access_mode::readwrite);
+    unsigned int virial_pitch = m_pdata->getNetVirial().getPitch();
 
+    unsigned int N = m_pdata->getN();
+    if (m_records.size() < N)
+        m_records.resize(N);
+
+#pragma omp parallel
+    {
+    // gather the data of every particle in the sorted order
+#pragma omp for
+    for (int i = 0; i < (int)N; i++)
+        {
+        unsigned int src = m_sort_order[i];
+        ParticleRecord& rec = m_records[i];
+        rec.pos = h_pos.data[src];
+        rec.vel = h_vel.data[src];
+        rec.net_force = h_net_force.data[src];
+        rec.net_torque = h_net_torque.data[src];
+        rec.orientation = h_orientation.data[src];
+        rec.accel = h_accel.data[src];
+        rec.charge = h_charge.data[src];
+        rec.diameter = h_diameter.data[src];
         for (unsigned int j = 0; j < 6; j++)
-            {
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
-                scal_tmp[i] = h_net_virial.data[j*virial_pitch+m_sort_order[i]];
-            for (unsigned int i = 0; i < m_pdata->getN(); i++)
-                h_net_virial.data[j*virial_pitch+i] = scal_tmp[i];
-            }
+            rec.net_virial[j] = h_net_virial.data[j*virial_pitch+src];
+        rec.image = h_image.data[src];
+        rec.body = h_body.data[src];
+        rec.tag = h_tag.data[src];
         }
 
-    // sort net force, net torque, and orientation
+    // copy it back and rebuild the global rtag
+#pragma omp for
+    for (int i = 0; i < (int)N; i++)
         {
-        ArrayHandle<Scalar4> h_net_force(m_pdata->getNetForce(), access_location::host, access_mode::readwrite);
-        
-        for (unsigned int i = 0; i < m_pdata->getN(); i++)
-            scal4_tmp[i] = h_net_force.data[m_sort_order[i]];
-        for (unsigned int i = 0; i < m_pdata->getN(); i++)
-            h_net_force.data[i] = scal4_tmp[i];
+        const ParticleRecord& rec = m_records[i];
+        h_pos.data[i] = rec.pos;
+        h_vel.data[i] = rec.vel;
+        h_net_force.data[i] = rec.net_force;
+        h_net_torque.data[i] = rec.net_torque;
+        h_orientation.data[i] = rec.orientation;
+        h_accel.data[i] = rec.accel;
+        h_charge.data[i] = rec.charge;
+        h_diameter.data[i] = rec.diameter;
+        for (unsigned int j = 0; j < 6; j++)
+            h_net_virial.data[j*virial_pitch+i] = rec.net_virial[j];
+        h_image.data[i] = rec.image;
+        h_body.data[i] = rec.body;
+        h_tag.data[i] = rec.tag;
+        h_rtag.data[rec.tag] = i;
         }
+    }
+
+    // every particle is read and written once at random and once in order
+    if (m_prof) m_prof->pop(0, (uint64_t)N * (sizeof(unsigned int) + 4 * sizeof(ParticleRecord)));
+    }
 
+/*! \param key_bits Number of significant bits in the bin index
+    \pre The first m_pdata->getN() elements of m_particle_bins hold (bin, index) pairs in order of the index
+    \post m_sort_order holds the particle indices ordered by bin, ties are kept in order of the index
+
+    Each pass of the radix sort orders by 8 bits of the bin index. Every thread counts the digits in a contiguous
+    chunk of the input, a prefix sum over (digit, thread) gives every thread its output offsets, and the chunks are
+    scattered in order, which keeps the sort stable.
+*/
+void SFCPackUpdater::sortParticleBins(unsigned int key_bits)
+    {
+    if (m_prof) m_prof->push("sort");
+
+    unsigned int N = m_pdata->getN();
+    assert(m_particle_bins.size() >= N && m_particle_bins_alt.size() >= N);
+    if (N == 0)
         {
-        ArrayHandle<Scalar4> h_net_torque(m_pdata->getNetTorqueArray(), access_location::host, access_mode::readwrite);
-        
-        for (unsigned int i = 0; i < m_pdata->getN(); i++)
-            scal4_tmp[i] = h_net_torque.data[m_sort_order[i]];
-        for (unsigned int i = 0; i < m_pdata->getN(); i++)
-            h_net_torque.data[i] = scal4_tmp[i];
+        if (m_prof) m_prof->pop();
+        return;
         }
 
+    #ifdef ENABLE_OPENMP
+    m_radix_counts.resize(256 * omp_get_max_threads());
+    #else
+    m_radix_counts.resize(256);
+    #endif
+
+    std::pair<unsigned int, unsigned int> *in = &m_particle_bins[0];
+    std::pair<unsigned int, unsigned int> *out = &m_particle_bins_alt[0];
+    unsigned int n_passes = 0;
+
+    for (unsigned int shift = 0; shift < key_bits; shift += 8)
         {
-        ArrayHandle<Scalar4> h_orientation(m_pdata->getOrientationArray(), access_location::host, access_mode::readwrite);
-        
-        for (unsigned int i = 0; i < m_pdata->getN(); i++)
-            scal4_tmp[i] = h_orientation.data[m_sort_order[i]];
-        for (unsigned int i = 0; i < m_pdata->getN(); i++)
-            h_orientation.data[i] = scal4_tmp[i];
+#pragma omp parallel
+        {
+        #ifdef ENABLE_OPENMP
+        unsigned int tid = omp_get_thread_num();
+        unsigned int nthreads = omp_get_num_threads();
+        #else
+        unsigned int tid = 0;
+        unsigned int nthreads = 1;
+        #endif
+
+        unsigned int *counts = &m_radix_counts[256*tid];
+        memset(counts, 0, sizeof(unsigned int)*256);
+        unsigned int begin = (unsigned int)((uint64_t)N * tid / nthreads);
+        unsigned int end = (unsigned int)((uint64_t)N * (tid+1) / nthreads);
+
+        for (unsigned int i = begin; i < end; i++)
+            counts[(in[i].first >> shift) & 0xff]++;
+
+#pragma omp barrier
+#pragma omp single
+            {
+            unsigned int offset = 0;
+            for (unsigned int d = 0; d < 256; d++)
+                for (unsigned int t = 0; t < nthreads; t++)
+                    {
+                    unsigned int count = m_radix_counts[256*t + d];
+                    m_radix_counts[256*t + d] = offset;
+                    offset += count;
+                    }
+            }
+
+        for (unsigned int i = begin; i < end; i++)
+            out[counts[(in[i].first >> shift) & 0xff]++] = in[i];
         }
 
-    // sort image
-    int3 *int3_tmp = new int3[m_pdata->getN()];
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        int3_tmp[i] = h_image.data[m_sort_order[i]];
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        h_image.data[i] = int3_tmp[i];
-        
-    // sort body
-    unsigned int *uint_tmp = new unsigned int[m_pdata->getN()];
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        uint_tmp[i] = h_body.data[m_sort_order[i]];
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        h_body.data[i] = uint_tmp[i];
-    
-    // sort global tag
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        uint_tmp[i] = h_tag.data[m_sort_order[i]];
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        h_tag.data[i] = uint_tmp[i];
-
-    // rebuild global rtag
-    for (unsigned int i = 0; i < m_pdata->getN(); i++)
-        {
-        h_rtag.data[h_tag.data[i]] = i;
+        std::swap(in, out);
+        n_passes++;
         }
 
-    delete[] scal_tmp;
-    delete[] scal4_tmp;
-    delete[] scal3_tmp;
-    delete[] uint_tmp;
-    delete[] int3_tmp;
-    
+    // translate the sorted order
+#pragma omp parallel for
+    for (int j = 0; j < (int)N; j++)
+        m_sort_order[j] = in[j].second;
+
+    if (m_prof) m_prof->pop(0, (uint64_t)N * (4 * n_passes * sizeof(std::pair<unsigned int, unsigned int>)
+                                              + sizeof(unsigned int)));
     }
 
 //! x walking table for the hilbert curve
@@ -465,12 +508,15 @@ void SFCPackUpdater::getSortedOrder2D()
     // make even bin dimensions
     const BoxDim& box = m_pdata->getBox();
     
+    if (m_prof) m_prof->push("bin");
+
     // put the particles in the bins
     {
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
 
     // for each particle
-    for (unsigned int n = 0; n < m_pdata->getN(); n++)
+#pragma omp parallel for
+    for (int n = 0; n < (int)m_pdata->getN(); n++)
         {
         // find the bin each particle belongs in
         Scalar3 p = make_scalar3(h_pos.data[n].x, h_pos.data[n].y, h_pos.data[n].z);
@@ -485,14 +531,13 @@ void SFCPackUpdater::getSortedOrder2D()
         }
     }
 
-    // sort the tuples
-    sort(m_particle_bins.begin(), m_particle_bins.begin() + m_pdata->getN());
-    
-    // translate the sorted order
-    for (unsigned int j = 0; j < m_pdata->getN(); j++)
-        {
-        m_sort_order[j] = m_particle_bins[j].second;
-        }
+    if (m_prof) m_prof->pop(0, m_pdata->getN() * (sizeof(Scalar4) + sizeof(std::pair<unsigned int, unsigned int>)));
+
+    // sort the tuples, the bin index has 2*log2(m_grid) significant bits
+    unsigned int key_bits = 0;
+    while ((1u << key_bits) < m_grid)
+        key_bits++;
+    sortParticleBins(2*key_bits);
     }
 
 void SFCPackUpdater::getSortedOrder3D()
@@ -544,11 +589,15 @@ void SFCPackUpdater::getSortedOrder3D()
     assert(m_particle_bins.size() >= m_pdata->getN());
     assert(m_traversal_order.size() == m_grid*m_grid*m_grid);
     
+    if (m_prof) m_prof->push("bin");
+
     // put the particles in the bins
+    {
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::read);
 
     // for each particle
-    for (unsigned int n = 0; n < m_pdata->getN(); n++)
+#pragma omp parallel for
+    for (int n = 0; n < (int)m_pdata->getN(); n++)
         {
         Scalar3 p = make_scalar3(h_pos.data[n].x, h_pos.data[n].y, h_pos.data[n].z);
         Scalar3 f = box.makeFraction(p,make_scalar3(0.0,0.0,0.0));
@@ -561,15 +610,16 @@ void SFCPackUpdater::getSortedOrder3D()
 
         m_particle_bins[n] = std::pair<unsigned int, unsigned int>(m_traversal_order[bin], n);
         }
-    
-    // sort the tuples
-    sort(m_particle_bins.begin(), m_particle_bins.begin() + m_pdata->getN());
-    
-    // translate the sorted order
-    for (unsigned int j = 0; j < m_pdata->getN(); j++)
-        {
-        m_sort_order[j] = m_particle_bins[j].second;
-        }
+    }
+
+    if (m_prof) m_prof->pop(0, m_pdata->getN() * (sizeof(Scalar4) + 2 * sizeof(unsigned int)
+                                                 + sizeof(std::pair<unsigned int, unsigned int>)));
+
+    // sort the tuples, the position along the curve has 3*log2(m_grid) significant bits
+    unsigned int key_bits = 0;
+    while ((1u << key_bits) < m_grid)
+        key_bits++;
+    sortParticleBins(3*key_bits);
     }
         
 void SFCPackUpdater::writeTraversalOrder(const std::string& fname, const vector< unsigned int >& reverse_order)
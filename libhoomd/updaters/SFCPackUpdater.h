@@ -95,6 +95,13 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     which those bins appear along a hilbert curve. It is very efficient, even when the box size changes often as the
     grid dimension is kept constant.
 
+    Each of the three steps is split over the OpenMP threads. The bin of every particle is computed in parallel, the
+    (bin, index) pairs are ordered with a parallel least significant digit radix sort over the bits of the bin index
+    (8 bits per pass), and the sort order is applied with a single gather of all per-particle arrays into a packed
+    staging record, followed by one copy back. The radix sort is stable, so the resulting order is the same as that
+    of a comparison sort on (bin, index) and does not depend on the number of threads. The steps are timed in the
+    profiler as "bin", "sort" and "gather".
+
     \ingroup updaters
 */
 class SFCPackUpdater : public Updater
@@ -124,16 +131,39 @@ class SFCPackUpdater : public Updater
         unsigned int m_last_dim;    //!< Check the last dimension we ran at
         
         std::vector< std::pair<unsigned int, unsigned int> > m_particle_bins;    //!< Binned particles
+        std::vector< std::pair<unsigned int, unsigned int> > m_particle_bins_alt; //!< Scratch space for the radix sort
+        std::vector<unsigned int> m_radix_counts;           //!< Per thread digit counts of the radix sort
         
         std::vector< unsigned int > m_traversal_order;      //!< Generated traversal order of bins
         std::vector<unsigned int> m_sort_order;             //!< Generated sort order of the particles
 
+        //! All per-particle data of one particle, staged while applying the sort order
+        struct ParticleRecord
+            {
+            Scalar4 pos;            //!< Position and type
+            Scalar4 vel;            //!< Velocity and mass
+            Scalar4 net_force;      //!< Net force
+            Scalar4 net_torque;     //!< Net torque
+            Scalar4 orientation;    //!< Orientation quaternion
+            Scalar3 accel;          //!< Acceleration
+            Scalar charge;          //!< Charge
+            Scalar diameter;        //!< Diameter
+            Scalar net_virial[6];   //!< Net virial
+            int3 image;             //!< Image flags
+            unsigned int body;      //!< Body id
+            unsigned int tag;       //!< Global tag
+            };
+        std::vector<ParticleRecord> m_records;              //!< Staging buffer for applySortOrder()
+
         boost::signals::connection m_max_particle_num_change_connection; //!< Connection to the maximum particle number change signal of particle data
         //! Helper function that actually performs the sort
         void getSortedOrder2D();
         //! Helper function that actually performs the sort
         void getSortedOrder3D();
         
+        //! Sort m_particle_bins by bin and fill out m_sort_order
+        void sortParticleBins(unsigned int key_bits);
+
         //! Apply the sorted order to the particle data
         void applySortOrder();
 
@@ -185,6 +185,7 @@ void TwoStepBDNVT::integrateStepTwo(unsigned int timestep)
     if (m_prof)
         m_prof->push("NVE step 2");
     
+    ArrayHandle<unsigned int> h_index_array(m_group->getIndexArray(), access_location::host, access_mode::read);
     ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::readwrite);
 
@@ -193,25 +194,26 @@ void TwoStepBDNVT::integrateStepTwo(unsigned int timestep)
 
     ArrayHandle<Scalar4> h_net_force(net_force, access_location::host, access_mode::read);
     ArrayHandle<Scalar> h_gamma(m_gamma, access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag(m_pdata->getTags(), access_location::host, access_mode::read);
     
     // grab some initial variables
     const Scalar currentTemp = m_T->getValue(timestep);
     const Scalar D = Scalar(m_sysdef->getNDimensions());
     
-    // initialize the RNG
-    Saru saru(m_seed, timestep);
-    
     // energy transferred over this time step
     Scalar bd_energy_transfer = 0;
     
     // a(t+deltaT) gets modified with the bd forces
     // v(t+deltaT) = v(t+deltaT/2) + 1/2 * a(t+deltaT)*deltaT
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static) reduction(+:bd_energy_transfer)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
         
         // first, calculate the BD forces
-        // Generate three random numbers
+        // Generate three random numbers from a stream seeded by the particle tag, so that the
+        // result does not depend on the particle order or the number of threads
+        Saru saru(h_tag.data[j], timestep, m_seed);
         Scalar rx = saru.d(-1,1);
         Scalar ry = saru.d(-1,1);
         Scalar rz =  saru.d(-1,1);
@@ -113,6 +113,12 @@ class TwoStepBDNVT : public TwoStepNVE
         
         //! Performs the second step of the integration
         virtual void integrateStepTwo(unsigned int timestep);
+
+        //! The second step adds the bd forces and cannot be fused with the net force sum
+        virtual bool getFusedStepTwo(bool& kick, boost::shared_ptr<ComputeThermo>& thermo)
+            {
+            return false;
+            }
     
     protected:
         boost::shared_ptr<Variant> m_T;   //!< The Temperature of the Stochastic Bath
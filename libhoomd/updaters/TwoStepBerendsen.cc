@@ -111,14 +111,16 @@ void TwoStepBerendsen::integrateStepOne(unsigned int timestep)
 
     // access the particle data for writing on the CPU
     assert(m_pdata);
+    ArrayHandle<unsigned int> h_index_array(m_group->getIndexArray(), access_location::host, access_mode::read);
     ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
 
 
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
 
         // advance velocity forward by half a timestep and position forward by a full timestep
         h_vel.data[j].x = lambda * (h_vel.data[j].x + h_accel.data[j].x * m_deltaT * Scalar(1.0 / 2.0));
@@ -137,9 +139,10 @@ void TwoStepBerendsen::integrateStepOne(unsigned int timestep)
 
     ArrayHandle<int3> h_image(m_pdata->getImages(), access_location::host, access_mode::readwrite);
 
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
         box.wrap(h_pos.data[j], h_image.data[j]);
         }
 
@@ -158,6 +161,7 @@ void TwoStepBerendsen::integrateStepTwo(unsigned int timestep)
 
     // access the particle data for writing on the CPU
     assert(m_pdata);
+    ArrayHandle<unsigned int> h_index_array(m_group->getIndexArray(), access_location::host, access_mode::read);
     ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::readwrite);
 
@@ -170,9 +174,10 @@ void TwoStepBerendsen::integrateStepTwo(unsigned int timestep)
         m_prof->push("Berendsen step 2");
 
     // integrate the particle velocities to timestep+1
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
 
         // calculate the acceleration from the net force
         Scalar minv = Scalar(1.0) / h_vel.data[j].w;
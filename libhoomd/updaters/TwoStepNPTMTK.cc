@@ -204,13 +204,15 @@ void TwoStepNPTMTK::integrateStepOne(unsigned int timestep)
     updatePropagator(nuxx, nuxy, nuxz, nuyy, nuyz, nuzz);
 
        {
+        ArrayHandle<unsigned int> h_index_array(m_group->getIndexArray(), access_location::host, access_mode::read);
         ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
         ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::read);
         ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
 
-        for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static)
+        for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
             {
-            unsigned int j = m_group->getMemberIndex(group_idx);
+            unsigned int j = h_index_array.data[group_idx];
 
             Scalar3 v = make_scalar3(h_vel.data[j].x, h_vel.data[j].y, h_vel.data[j].z);
             Scalar3 accel = h_accel.data[j];
@@ -263,24 +265,15 @@ void TwoStepNPTMTK::integrateStepOne(unsigned int timestep)
     c.y = m_mat_exp_r[3] * c.y + m_mat_exp_r[4] * c.z;
     c.z = m_mat_exp_r[5] * c.z;
 
-#ifdef ENABLE_MPI
-    if (m_comm)
+    // the barostat and thermostat variables, and thus the new box, are advanced identically on every rank from
+    // globally reduced thermodynamic quantities, no broadcast is needed
+    if (m_check_replicated_state)
         {
-        // broadcast integrator variables from rank 0 to other processors
-        MPI_Bcast(&eta, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&xi, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuxx, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuxy, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyy, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuzz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-
-        MPI_Bcast(&a,sizeof(Scalar3), MPI_BYTE, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&b,sizeof(Scalar3), MPI_BYTE, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&c,sizeof(Scalar3), MPI_BYTE, 0, m_exec_conf->getMPICommunicator());
+        std::vector<Scalar> state(v.variable);
+        Scalar lattice[9] = {a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z};
+        state.insert(state.end(), lattice, lattice + 9);
+        checkReplicatedState(state, timestep);
         }
-#endif
 
     // update box dimensions
     bool twod = m_sysdef->getNDimensions()==2;
@@ -312,7 +305,8 @@ void TwoStepNPTMTK::integrateStepOne(unsigned int timestep)
         ArrayHandle<int3> h_image(m_pdata->getImages(), access_location::host, access_mode::readwrite);
 
         // Wrap particles
-        for (unsigned int j = 0; j < m_pdata->getN(); j++)
+#pragma omp parallel for schedule(static)
+        for (int j = 0; j < (int)m_pdata->getN(); j++)
             box.wrap(h_pos.data[j], h_image.data[j]);
         }
 
@@ -351,6 +345,7 @@ void TwoStepNPTMTK::integrateStepTwo(unsigned int timestep)
 
     // precalculate loop-invariant quantities
     {
+    ArrayHandle<unsigned int> h_index_array(m_group->getIndexArray(), access_location::host, access_mode::read);
     ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::readwrite);
 
@@ -360,9 +355,10 @@ void TwoStepNPTMTK::integrateStepTwo(unsigned int timestep)
     Scalar m_v2_sum(0.0);
 
     // perform second half step of NPT integration
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static) reduction(+:m_v2_sum)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
 
         // first, calculate acceleration from the net force
         Scalar m = h_vel.data[j].w;
@@ -410,9 +406,10 @@ void TwoStepNPTMTK::integrateStepTwo(unsigned int timestep)
         }
 
     // rescale velocities
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
 
         Scalar3 vel = make_scalar3(h_vel.data[j].x, h_vel.data[j].y, h_vel.data[j].z);
         vel = vel*exp_v_fac_thermo;
@@ -446,20 +443,8 @@ void TwoStepNPTMTK::integrateStepTwo(unsigned int timestep)
     // advance barostat (nuxx, nuyy, nuzz) half a time step
     advanceBarostat(nuxx, nuxy, nuxz, nuyy, nuyz, nuzz, P, timestep);
 
-#ifdef ENABLE_MPI
-    if (m_comm)
-        {
-        // broadcast integrator variables from rank 0 to other processors
-        MPI_Bcast(&eta, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&xi, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuxx, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuxy, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyy, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuzz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        }
-#endif
+    // every rank advances the thermostat and barostat from the same globally reduced quantities
+    checkReplicatedState(v.variable, timestep);
 
     setIntegratorVariables(v);
 
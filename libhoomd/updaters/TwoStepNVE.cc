@@ -130,6 +130,7 @@ void TwoStepNVE::integrateStepOne(unsigned int timestep)
     if (m_prof)
         m_prof->push("NVE step 1");
     
+    ArrayHandle<unsigned int> h_index_array(m_group->getIndexArray(), access_location::host, access_mode::read);
     ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
@@ -137,9 +138,10 @@ void TwoStepNVE::integrateStepOne(unsigned int timestep)
     // perform the first half step of velocity verlet
     // r(t+deltaT) = r(t) + v(t)*deltaT + (1/2)a(t)*deltaT^2
     // v(t+deltaT/2) = v(t) + (1/2)a*deltaT
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
         if (m_zero_force)
             h_accel.data[j].x = h_accel.data[j].y = h_accel.data[j].z = 0.0;
         
@@ -173,9 +175,10 @@ void TwoStepNVE::integrateStepOne(unsigned int timestep)
 
     ArrayHandle<int3> h_image(m_pdata->getImages(), access_location::host, access_mode::readwrite);
 
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
         box.wrap(h_pos.data[j], h_image.data[j]);
         }
 
@@ -199,15 +202,17 @@ void TwoStepNVE::integrateStepTwo(unsigned int timestep)
     if (m_prof)
         m_prof->push("NVE step 2");
 
+    ArrayHandle<unsigned int> h_index_array(m_group->getIndexArray(), access_location::host, access_mode::read);
     ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::readwrite);
 
     ArrayHandle<Scalar4> h_net_force(net_force, access_location::host, access_mode::read);
     
     // v(t+deltaT) = v(t+deltaT/2) + 1/2 * a(t+deltaT)*deltaT
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
         
         if (m_zero_force)
             {
@@ -245,6 +250,23 @@ void TwoStepNVE::integrateStepTwo(unsigned int timestep)
         m_prof->pop();
     }
 
+/*! \param kick Set to true if the second step is a plain half-kick
+    \param thermo Set to the thermo compute of the group
+    \returns true if the second step can be fused with the net force sum
+
+    Without a limit and with forces, the second step is a plain half-kick. The properties of the group at timestep+1
+    are then those after the kick, and they are accumulated in the same pass if a thermo compute has been set.
+*/
+bool TwoStepNVE::getFusedStepTwo(bool& kick, boost::shared_ptr<ComputeThermo>& thermo)
+    {
+    if (m_limit || m_zero_force)
+        return false;
+
+    kick = true;
+    thermo = m_thermo;
+    return true;
+    }
+
 void export_TwoStepNVE()
     {
     class_<TwoStepNVE, boost::shared_ptr<TwoStepNVE>, bases<IntegrationMethodTwoStep>, boost::noncopyable>
@@ -252,6 +274,7 @@ void export_TwoStepNVE()
         .def("setLimit", &TwoStepNVE::setLimit)
         .def("removeLimit", &TwoStepNVE::removeLimit)
         .def("setZeroForce", &TwoStepNVE::setZeroForce)
+        .def("setThermo", &TwoStepNVE::setThermo)
         ;
     }
 
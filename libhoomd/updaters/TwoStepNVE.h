@@ -51,6 +51,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Maintainer: joaander
 
 #include "IntegrationMethodTwoStep.h"
+#include "ComputeThermo.h"
 
 #ifndef __TWO_STEP_NVE_H__
 #define __TWO_STEP_NVE_H__
@@ -92,16 +93,28 @@ class TwoStepNVE : public IntegrationMethodTwoStep
             m_zero_force = zero_force;
             }
         
+        //! Sets the thermo compute of the group
+        /*! \param thermo Compute whose properties are accumulated along with the fused second step
+        */
+        void setThermo(boost::shared_ptr<ComputeThermo> thermo)
+            {
+            m_thermo = thermo;
+            }
+
         //! Performs the first step of the integration
         virtual void integrateStepOne(unsigned int timestep);
         
         //! Performs the second step of the integration
         virtual void integrateStepTwo(unsigned int timestep);
+
+        //! Get the parts of the second step that the integrator may fuse with the net force sum
+        virtual bool getFusedStepTwo(bool& kick, boost::shared_ptr<ComputeThermo>& thermo);
     
     protected:
         bool m_limit;       //!< True if we should limit the distance a particle moves in one step
         Scalar m_limit_val; //!< The maximum distance a particle is to move in one step
         bool m_zero_force;  //!< True if the integration step should ignore computed forces
+        boost::shared_ptr<ComputeThermo> m_thermo;  //!< Thermo compute of the group, may be NULL
     };
 
 //! Exports the TwoStepNVE class to python
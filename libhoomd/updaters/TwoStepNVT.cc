@@ -158,6 +158,7 @@ void TwoStepNVT::integrateStepOne(unsigned int timestep)
     IntegratorVariables v = getIntegratorVariables();
     Scalar& xi = v.variable[0];
 
+    ArrayHandle<unsigned int> h_index_array(m_group->getIndexArray(), access_location::host, access_mode::read);
     ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar4> h_pos(m_pdata->getPositions(), access_location::host, access_mode::readwrite);
@@ -165,9 +166,10 @@ void TwoStepNVT::integrateStepOne(unsigned int timestep)
     // precompute loop invariant quantities
     Scalar denominv = Scalar(1.0) / (Scalar(1.0) + m_deltaT/Scalar(2.0) * xi);
     
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
         
         h_vel.data[j].x = (h_vel.data[j].x + Scalar(1.0/2.0)*h_accel.data[j].x*m_deltaT) * denominv;
         h_pos.data[j].x += m_deltaT * h_vel.data[j].x;
@@ -184,9 +186,10 @@ void TwoStepNVT::integrateStepOne(unsigned int timestep)
 
     ArrayHandle<int3> h_image(m_pdata->getImages(), access_location::host, access_mode::readwrite);
 
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
         // wrap the particles around the box
         box.wrap(h_pos.data[j], h_image.data[j]);
         }
@@ -218,14 +221,8 @@ void TwoStepNVT::integrateStepTwo(unsigned int timestep)
     xi += m_deltaT / (m_tau*m_tau) * (curr_T/m_T->getValue(timestep) - Scalar(1.0));
     eta += m_deltaT / Scalar(2.0) * (xi + xi_prev);
 
-#ifdef ENABLE_MPI
-    if (m_comm)
-        {
-        // broadcast integrator variables from rank 0 to other processors
-        MPI_Bcast(&eta, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&xi, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        }
-#endif
+    // every rank advances xi and eta from the same globally reduced temperature, no broadcast is needed
+    checkReplicatedState(v.variable, timestep);
 
     
     const GPUArray< Scalar4 >& net_force = m_pdata->getNetForce();
@@ -234,15 +231,17 @@ void TwoStepNVT::integrateStepTwo(unsigned int timestep)
     if (m_prof)
         m_prof->push("NVT step 2");
 
+    ArrayHandle<unsigned int> h_index_array(m_group->getIndexArray(), access_location::host, access_mode::read);
     ArrayHandle<Scalar4> h_vel(m_pdata->getVelocities(), access_location::host, access_mode::readwrite);
     ArrayHandle<Scalar3> h_accel(m_pdata->getAccelerations(), access_location::host, access_mode::readwrite);
 
     ArrayHandle<Scalar4> h_net_force(net_force, access_location::host, access_mode::read);
     
     // perform second half step of Nose-Hoover integration
-    for (unsigned int group_idx = 0; group_idx < group_size; group_idx++)
+#pragma omp parallel for schedule(static)
+    for (int group_idx = 0; group_idx < (int)group_size; group_idx++)
         {
-        unsigned int j = m_group->getMemberIndex(group_idx);
+        unsigned int j = h_index_array.data[group_idx];
         
         // first, calculate acceleration from the net force
         Scalar minv = Scalar(1.0) / h_vel.data[j].w;
@@ -264,6 +263,19 @@ void TwoStepNVT::integrateStepTwo(unsigned int timestep)
         m_prof->pop();
     }
 
+/*! \param kick Left unchanged, the thermostat needs the temperature of all ranks before the kick
+    \param thermo Set to the thermo compute that integrateStepTwo() evaluates at timestep+1
+    \returns true
+
+    integrateStepTwo() derives xi from the temperature before the kick, so only the thermodynamic sums can be
+    accumulated in the net force pass. The call to m_thermo->compute() in integrateStepTwo() then reuses them.
+*/
+bool TwoStepNVT::getFusedStepTwo(bool& kick, boost::shared_ptr<ComputeThermo>& thermo)
+    {
+    thermo = m_thermo;
+    return true;
+    }
+
 void export_TwoStepNVT()
     {
     class_<TwoStepNVT, boost::shared_ptr<TwoStepNVT>, bases<IntegrationMethodTwoStep>, boost::noncopyable>
@@ -126,6 +126,9 @@ class TwoStepNVT : public IntegrationMethodTwoStep
         
         //! Performs the second step of the integration
         virtual void integrateStepTwo(unsigned int timestep);
+
+        //! Get the parts of the second step that the integrator may fuse with the net force sum
+        virtual bool getFusedStepTwo(bool& kick, boost::shared_ptr<ComputeThermo>& thermo);
     
     protected:
         boost::shared_ptr<ComputeThermo> m_thermo;    //!< compute for thermodynamic quantities
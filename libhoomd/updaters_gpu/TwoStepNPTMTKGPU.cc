@@ -220,24 +220,15 @@ void TwoStepNPTMTKGPU::integrateStepOne(unsigned int timestep)
     c.y = m_mat_exp_r[3] * c.y + m_mat_exp_r[4] * c.z;
     c.z = m_mat_exp_r[5] * c.z;
 
-#ifdef ENABLE_MPI
-    if (m_comm)
+    // the barostat and thermostat variables, and thus the new box, are advanced identically on every rank from
+    // globally reduced thermodynamic quantities, no broadcast is needed
+    if (m_check_replicated_state)
         {
-        // broadcast integrator variables from rank 0 to other processors
-        MPI_Bcast(&eta, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&xi, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuxx, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuxy, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyy, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuzz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-
-        MPI_Bcast(&a,sizeof(Scalar3), MPI_BYTE, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&b,sizeof(Scalar3), MPI_BYTE, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&c,sizeof(Scalar3), MPI_BYTE, 0, m_exec_conf->getMPICommunicator());
+        std::vector<Scalar> state(v.variable);
+        Scalar lattice[9] = {a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z};
+        state.insert(state.end(), lattice, lattice + 9);
+        checkReplicatedState(state, timestep);
         }
-#endif
 
     // update box dimensions
     bool twod = m_sysdef->getNDimensions()==2;
@@ -400,20 +391,8 @@ void TwoStepNPTMTKGPU::integrateStepTwo(unsigned int timestep)
     // advance barostat (nux, nuy, nuz) half a time step
     advanceBarostat(nuxx, nuxy, nuxz, nuyy, nuyz, nuzz, P, timestep);
 
-#ifdef ENABLE_MPI
-    if (m_comm)
-        {
-        // broadcast integrator variables from rank 0 to other processors
-        MPI_Bcast(&eta, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&xi, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuxx, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuxy, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyy, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuyz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&nuzz, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        }
-#endif
+    // every rank advances the thermostat and barostat from the same globally reduced quantities
+    checkReplicatedState(v.variable, timestep);
 
     setIntegratorVariables(v);
 
@@ -166,14 +166,8 @@ void TwoStepNVTGPU::integrateStepTwo(unsigned int timestep)
     xi += m_deltaT / (m_tau*m_tau) * (curr_T/m_T->getValue(timestep) - Scalar(1.0));
     eta += m_deltaT / Scalar(2.0) * (xi + xi_prev);
 
-#ifdef ENABLE_MPI
-    if (m_comm)
-        {
-        // broadcast integrator variables from rank 0 to other processors
-        MPI_Bcast(&eta, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        MPI_Bcast(&xi, 1, MPI_HOOMD_SCALAR, 0, m_exec_conf->getMPICommunicator());
-        }
-#endif
+    // every rank advances xi and eta from the same globally reduced temperature, no broadcast is needed
+    checkReplicatedState(v.variable, timestep);
   
     // profile this step
     if (m_prof)
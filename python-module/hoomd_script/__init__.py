@@ -216,7 +216,16 @@ def run(tsteps, profile=False, limit_hours=None, limit_multiple=1, callback_peri
 
     if not quiet:
         globals.msg.notice(1, "** starting run **\n");
-    globals.system.run(int(tsteps), callback_period, callback, limit_hours, int(limit_multiple));
+    try:
+        globals.system.run(int(tsteps), callback_period, callback, limit_hours, int(limit_multiple));
+    finally:
+        # write out the rows the loggers still keep in memory and the frames still queued in the dcd writers,
+        # also when the run is interrupted
+        for logger in globals.loggers:
+            logger.cpp_analyzer.flush();
+        for dcd in globals.dcd_writers:
+            dcd.cpp_analyzer.flush();
+
     if not quiet:
         globals.msg.notice(1, "** run complete **\n");
 
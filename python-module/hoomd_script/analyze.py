@@ -427,6 +427,8 @@ class log(_analyzer):
     # \param header_prefix (optional) Specify a string to print before the header
     # \param overwrite When False (the default) an existing log will be appended to. 
     #                  If True, an existing log file will be overwritten instead.
+    # \param binary When True, the log is written in a binary format (see read_binary_log())
+    # \param batch_size Number of rows that are kept in memory before they are written to the file
     #
     # \b Examples:
     # \code
@@ -443,6 +445,8 @@ class log(_analyzer):
     #             period=10, header_prefix='Log of harmonic energy, run 5\n')
     # logger = analyze.log(filename='mylog.log', period=100,
     #                      quantities=['pair_lj_energy'], overwrite=True)
+    # logger = analyze.log(filename='mylog.bin', period=10,
+    #                      quantities=['pair_lj_energy'], binary=True, batch_size=1000)
     # \endcode
     #
     # By default, columns in the log file are separated by tabs, suitable for importing as a 
@@ -458,8 +462,15 @@ class log(_analyzer):
     # remain consistent with the header already in the file, you must specify the same quantities
     # to log and in the same order for all runs of hoomd that append to the same log.
     #
+    # When logging often, the rows can be collected in memory and written to the file \a batch_size rows
+    # at a time. Rows that are still in memory are written at the end of every run() and by flush().
+    # With \a binary=True, the values are written as float64 without any text formatting. The binary log
+    # starts with a header that lists the column names, so it can be read back with read_binary_log().
+    # \a header_prefix and the delimiter are ignored for binary logs, and the logged quantities of a
+    # binary log cannot be changed once it is written.
+    #
     # \a period can be a function: see \ref variable_period_docs for details
-    def __init__(self, filename, quantities, period, header_prefix='', overwrite=False):
+    def __init__(self, filename, quantities, period, header_prefix='', overwrite=False, binary=False, batch_size=1):
         util.print_status_line();
         
         # initialize base class
@@ -467,6 +478,8 @@ class log(_analyzer):
         
         # create the c++ mirror class
         self.cpp_analyzer = hoomd.Logger(globals.system_definition, filename, header_prefix, overwrite);
+        self.cpp_analyzer.setBinary(binary);
+        self.cpp_analyzer.setBatchSize(int(batch_size));
         self.setupAnalyzer(period);
         
         # set the logged quantities
@@ -482,6 +495,7 @@ class log(_analyzer):
     #
     # \param quantities New list of quantities to log (if specified)
     # \param delimiter New delimiter between columns in the output file (if specified)
+    # \param batch_size New number of rows that are kept in memory before they are written (if specified)
     #
     # Using set_params() requires that the specified logger was saved in a variable when created.
     # i.e. 
@@ -496,8 +510,9 @@ class log(_analyzer):
     # logger.set_params(quantities=['bond_harmonic_energy'])
     # logger.set_params(delimiter=',');
     # logger.set_params(quantities=['bond_harmonic_energy'], delimiter=',');
+    # logger.set_params(batch_size=100);
     # \endcode
-    def set_params(self, quantities=None, delimiter=None):
+    def set_params(self, quantities=None, delimiter=None, batch_size=None):
         util.print_status_line();
         
         if quantities is not None:
@@ -509,6 +524,22 @@ class log(_analyzer):
             
         if delimiter:
             self.cpp_analyzer.setDelimiter(delimiter);
+
+        if batch_size is not None:
+            self.cpp_analyzer.setBatchSize(int(batch_size));
+
+    ## Write all rows that are kept in memory to the file
+    #
+    # run() writes out the pending rows at its end, so flush() is only needed to look at a
+    # log with \a batch_size larger than 1 from within a run, e.g. in a callback.
+    #
+    # \b Examples:
+    # \code
+    # logger.flush()
+    # \endcode
+    def flush(self):
+        self.check_initialization();
+        self.cpp_analyzer.flush();
         
     ## Retrieve a cached value of a monitored quantity from the last update of the logger.
     # \param quantity Name of the quantity to return.
@@ -539,6 +570,59 @@ class log(_analyzer):
         globals.system.registerLogger(self.cpp_analyzer);
 
 
+## Reads a binary log written by analyze.log
+#
+# \param filename Name of the binary log file
+# \returns A dictionary that maps every column name (\c timestep and the logged quantities) to the list of its values
+#
+# Values are returned in the order they were logged. A row that was only partially written, e.g. because the
+# simulation was killed, is ignored.
+#
+# \b Examples:
+# \code
+# data = analyze.read_binary_log('mylog.bin')
+# print data['timestep'][-1], data['pair_lj_energy'][-1]
+# \endcode
+def read_binary_log(filename):
+    import struct;
+
+    f = open(filename, 'rb');
+    try:
+        data = f.read();
+    finally:
+        f.close();
+
+    if data[0:8] != b'HOOMDLOG':
+        globals.msg.error("analyze.read_binary_log: " + filename + " is not a binary log\n");
+        raise RuntimeError('Error reading log');
+
+    # the file is in the byte order of the machine that wrote it, the version tells which one it is
+    order = '<';
+    if struct.unpack(order + 'I', data[8:12])[0] != 1:
+        order = '>';
+    if struct.unpack(order + 'I', data[8:12])[0] != 1:
+        globals.msg.error("analyze.read_binary_log: unsupported version of " + filename + "\n");
+        raise RuntimeError('Error reading log');
+
+    # read the column names
+    n_columns = struct.unpack(order + 'I', data[12:16])[0];
+    offset = 16;
+    columns = [];
+    for i in range(n_columns):
+        length = struct.unpack(order + 'I', data[offset:offset+4])[0];
+        offset += 4;
+        columns.append(data[offset:offset+length].decode('ascii'));
+        offset += length;
+
+    # read all complete rows
+    n_rows = (len(data) - offset) // (8 * n_columns);
+    values = struct.unpack(order + str(n_rows * n_columns) + 'd', data[offset:offset + 8 * n_rows * n_columns]);
+
+    result = {};
+    for i in range(n_columns):
+        result[columns[i]] = list(values[i::n_columns]);
+    return result;
+
 ## Calculates the mean-squared displacement of groups of particles and logs the values to a file
 #
 # analyze.msd can be given any number of groups of particles. Every \a period time steps, it calculates the mean squared 
@@ -104,7 +104,12 @@ from math import sqrt
 #       (group.charged). However, note that this group is static and determined at the time charge.pppm() is specified.
 #       If you are going to add charged particles at a later point in the simulation with the data access API,
 #       ensure that this group includes those particles as well.
-# \MPI_NOT_SUPPORTED
+#
+# In MPI simulations, the mesh is distributed over the domain decomposition (CPU only). Nx and Ny must be multiples
+# of the number of ranks, and Nx, Ny and Nz must be multiples of the number of domains along the same direction.
+# The distributed mesh requires equally sized domains, so set_params() raises an error if update.balance is in use
+# or has already moved the domain boundaries.
+# \MPI_SUPPORTED
 class pppm(force._force):
     ## Specify long-ranged electrostatic interactions between particles
     #
@@ -119,10 +124,10 @@ class pppm(force._force):
     def __init__(self, group):
         util.print_status_line();
 
-        # Error out in MPI simulations
+        # the distributed mesh is only implemented on the CPU
         if (hoomd.is_MPI_available()):
-            if globals.system_definition.getParticleData().getDomainDecomposition():
-                globals.msg.error("charge.pppm is not supported in multi-processor simulations.\n\n")
+            if globals.system_definition.getParticleData().getDomainDecomposition() and globals.exec_conf.isCUDAEnabled():
+                globals.msg.error("charge.pppm is not supported in multi-GPU simulations.\n\n")
                 raise RuntimeError("Error initializing PPPM.")
        
         # initialize the base class
@@ -192,11 +197,9 @@ class pppm(force._force):
             raise RuntimeError("Cannot compute PPPM");
 
         self.params_set = True;
-        q2 = 0
-        N = globals.system_definition.getParticleData().getN()
-        for i in range(0,N):
-            q = globals.system_definition.getParticleData().getCharge(i)
-            q2 += q*q
+        # sum the local charges and reduce them once, instead of one collective per particle
+        q2 = self.cpp_force.getQ2Sum()
+        N = globals.system_definition.getParticleData().getNGlobal()
         box = globals.system_definition.getParticleData().getBox()
         Lx = box.getL().x
         Ly = box.getL().y
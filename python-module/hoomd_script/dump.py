@@ -281,12 +281,14 @@ class bin(analyze._analyzer):
     # \param file1 (optional) First alternating file name to write
     # \param file2 (optional) Second alternating file name to write
     # \param compress Set to False to disable gzip compression
+    # \param chunked Set to True to append all frames to the single file \a filename
     # 
     # \b Examples:
     # \code
     # dump.bin(file1="restart.1.bin.gz", file2="restart.2.bin.gz", period=1e5)
     # dump.bin(filename="particles", period=1000)
     # bin = dump.bin(filename="particles", period=1e5, compress=False)
+    # dump.bin(filename="trajectory.bin", period=1e5, chunked=True)
     # bin = dump.bin()
     # \endcode
     #
@@ -304,6 +306,11 @@ class bin(analyze._analyzer):
     # of the files, the other is still available for use. Make sure to include a .gz file extension if compression
     # is enabled.
     #
+    # If \a chunked is True, every write appends a frame to the file \a filename (no time step or extension is added to
+    # the name). Each column of per-particle %data is compressed separately, which makes the files smaller than gzip
+    # compressed files, and an index at the end of the file allows init.read_bin to load any frame without reading the
+    # ones before it. Compression of chunked files is controlled by \a compress, a .gz extension is not needed.
+    #
     # Binary files include the \b entire state of the system, including the time step, particle positions,
     # velocities, et cetera, and the internal state variables of any relevant integration methods. All %data is saved
     # exactly as it appears in memory so that loading the %data with init.read_bin is as close as possible as one
@@ -325,7 +332,7 @@ class bin(analyze._analyzer):
     # limit. If you need to store data in a system and version independent manner, use dump.xml().
     #
     # \a period can be a function: see \ref variable_period_docs for details
-    def __init__(self, filename="dump", period=None, file1=None, file2=None, compress=True):
+    def __init__(self, filename="dump", period=None, file1=None, file2=None, compress=True, chunked=False):
         util.print_status_line();
   
         # Error out in MPI simulations
@@ -340,12 +347,16 @@ class bin(analyze._analyzer):
         # create the c++ mirror class
         self.cpp_analyzer = hoomd.HOOMDBinaryDumpWriter(globals.system_definition, filename);
         self.cpp_analyzer.enableCompression(compress)
+        self.cpp_analyzer.setChunked(chunked)
         
         # handle the alternation setting
         # first, check that they are both set
         if (file1 is not None and file2 is None) or (file2 is not None and file1 is None):
             globals.msg.error("file1 and file2 must either both be set or both left as None.\n");
             raise RuntimeError('Error initializing dump.bin');
+        if chunked and file1 is not None:
+            globals.msg.error("Chunked files cannot be written alternating between file1 and file2.\n");
+            raise RuntimeError('Error initializing dump.bin');
         if file1 is not None:
             self.cpp_analyzer.setAlternatingWrites(file1, file2)
             if period is None:
@@ -503,11 +514,16 @@ class dcd(analyze._analyzer):
     #        unwrapped so that the body is continuous. The center of mass of the body remains in the simulation box, but
     #        some particles may be written just outside it. \a unwrap_rigid is ignored if \a unwrap_full is True.
     # \param angle_z When True, the particle orientation angle is written to the z component (only useful for 2D simulations)
+    # \param queue_depth When 0 (the default), each frame is written to the file before the simulation continues. When
+    #        larger than 0, frames are written by a background thread and up to \a queue_depth frames may be waiting
+    #        to be written while the simulation continues. In multi-processor simulations, all ranks write their own
+    #        particles to the file together with MPI-IO and \a queue_depth has no effect.
     # 
     # \b Examples:
     # \code
     # dump.dcd(filename="trajectory.dcd", period=1000)
     # dcd = dump.dcd(filename"data/dump.dcd", period=1000)
+    # dcd = dump.dcd(filename="trajectory.dcd", period=100, queue_depth=2)
     # \endcode
     #
     # \warning 
@@ -517,7 +533,7 @@ class dcd(analyze._analyzer):
     #   consistent timeline
     #
     # \a period can be a function: see \ref variable_period_docs for details
-    def __init__(self, filename, period, group=None, overwrite=False, unwrap_full=False, unwrap_rigid=False, angle_z=False):
+    def __init__(self, filename, period, group=None, overwrite=False, unwrap_full=False, unwrap_rigid=False, angle_z=False, queue_depth=0):
         util.print_status_line();
         
         # initialize base class
@@ -539,7 +555,31 @@ class dcd(analyze._analyzer):
         self.cpp_analyzer.setUnwrapFull(unwrap_full);
         self.cpp_analyzer.setUnwrapRigid(unwrap_rigid);
         self.cpp_analyzer.setAngleZ(angle_z);
+        self.cpp_analyzer.setAsync(int(queue_depth));
         self.setupAnalyzer(period);
+
+        # add the writer to the list of dcd writers, run() waits for their queued frames
+        globals.dcd_writers.append(self);
+
+    ## Wait until all frames are written to the file
+    #
+    # When dump.dcd is created with \a queue_depth larger than 0, frames may still be waiting to be written
+    # while the simulation runs. flush() blocks until they are all in the file. run() already does this before it
+    # returns, so flush() is only needed when the file is read from within a callback.
+    #
+    # \b Examples:
+    # \code
+    # dcd.flush()
+    # \endcode
+    def flush(self):
+        util.print_status_line();
+
+        # check that we have been initialized properly
+        if self.cpp_analyzer is None:
+            globals.msg.error('Bug in hoomd_script: cpp_analyzer not set, please report\n');
+            raise RuntimeError('Error flushing DCD file');
+
+        self.cpp_analyzer.flush();
     
     def enable(self):
         util.print_status_line();
@@ -91,6 +91,9 @@ neighbor_list = None;
 ## Global variable tracking all the loggers that have been created
 loggers = [];
 
+## Global variable tracking all the dcd writers that have been created
+dcd_writers = [];
+
 ## Global variable tracking all the compute thermos that have been created
 thermos = [];
 
@@ -109,7 +112,7 @@ msg = hoomd.Messenger();
 # \brief Clears all global variables to default values
 # \details called by hoomd_script.reset()
 def clear():
-    global system_definition, system, forces, constraint_forces, external_forces, integration_methods, integrator, neighbor_list, loggers, thermos;
+    global system_definition, system, forces, constraint_forces, external_forces, integration_methods, integrator, neighbor_list, loggers, dcd_writers, thermos;
     global group_all, exec_conf;
     
     # do NOT reset exec_conf, this variable is cached
@@ -124,6 +127,7 @@ def clear():
     integrator = None;
     neighbor_list = None;
     loggers = [];
+    dcd_writers = [];
     thermos = [];
     group_all = None;
     
@@ -240,6 +240,9 @@ def create_empty(N, box, n_particle_types=1, n_bond_types=0, n_angle_types=0, n_
 # If \a time_step is specified, its value will be used as the initial time 
 # step of the simulation instead of the one read from the XML file.
 #
+# In MPI simulations, every rank reads the file and keeps only its own share of the particles, which are then sent to
+# the ranks that own them. Bonds, angles, dihedrals, impropers and walls are read on rank 0.
+#
 # The result of init.read_xml can be saved in a variable and later used to read and/or change particle properties
 # later in the script. See hoomd_script.data for more information.
 #
@@ -255,8 +258,9 @@ def read_xml(filename, time_step = None):
         globals.msg.error("Cannot initialize more than once\n");
         raise RuntimeError("Error creating random polymers");
 
-    # read in the data
-    initializer = hoomd.HOOMDInitializer(my_exec_conf,filename);
+    # read in the data, with a domain decomposition every rank reads its own stripe of the particles
+    distributed = hoomd.is_MPI_available() and my_exec_conf.getNRanks() > 1;
+    initializer = hoomd.HOOMDInitializer(my_exec_conf,filename,distributed);
     snapshot = initializer.getSnapshot()
 
     my_domain_decomposition = _create_domain_decomposition(snapshot.global_box);
@@ -277,11 +281,14 @@ def read_xml(filename, time_step = None):
 ## Reads initial system state from a binary file
 #
 # \param filename File to read
+# \param frame Frame to read from a chunked file, negative values count from the last frame backwards
+# \param time_step (if specified) Time step number to use instead of the one stored in the file
 #
 # \b Examples:
 # \code
 # init.read_bin(filename="data.bin.gz")
 # init.read_bin(filename="directory/data.bin")
+# init.read_bin(filename="trajectory.bin", frame=0)
 # system = init.read_bin(filename="data.bin.gz")
 # \endcode
 #
@@ -292,13 +299,17 @@ def read_xml(filename, time_step = None):
 # After this command completes, the system is initialized allowing other commands in hoomd_script to be run.
 #
 # The presence or lack of a .gz extension determines whether init.read_bin will attempt to decompress the %data
-# before reading it.
+# before reading it. Files written by dump.bin with \a chunked=True are recognized by their contents, by default the
+# last frame in them is read.
+#
+# In MPI simulations, every rank reads its own share of the particles from the file, which are then sent to the ranks
+# that own them. Everything that is not stored per particle is read on rank 0.
 #
 # The result of init.read_bin can be saved in a variable and later used to read and/or change particle properties
 # later in the script. See hoomd_script.data for more information.
 #
 # \sa dump.bin
-def read_bin(filename):
+def read_bin(filename, frame=-1, time_step=None):
     util.print_status_line();
     
     # initialize GPU/CPU execution configuration and MPI early
@@ -309,8 +320,9 @@ def read_bin(filename):
         globals.msg.error("Cannot initialize more than once\n");
         raise RuntimeError('Error initializing');
 
-    # read in the data
-    initializer = hoomd.HOOMDBinaryInitializer(my_exec_conf,filename);
+    # read in the data, with a domain decomposition every rank reads its own stripe of the particles
+    distributed = hoomd.is_MPI_available() and my_exec_conf.getNRanks() > 1;
+    initializer = hoomd.HOOMDBinaryInitializer(my_exec_conf,filename,frame,distributed);
     snapshot = initializer.getSnapshot()
 
     my_domain_decomposition = _create_domain_decomposition(snapshot.global_box);
@@ -705,6 +717,8 @@ def _perform_common_init_tasks():
             # create the c++ Communicator
             if not globals.exec_conf.isCUDAEnabled():
                 cpp_communicator = hoomd.Communicator(globals.system_definition, cpp_decomposition)
+                if globals.options.comm_overlap:
+                    cpp_communicator.setOverlap(True)
             else:
                 cpp_communicator = hoomd.CommunicatorGPU(globals.system_definition, cpp_decomposition)
 
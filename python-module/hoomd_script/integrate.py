@@ -297,6 +297,26 @@ class _integration_method:
         self.enabled = True;
         globals.integration_methods.append(self);
 
+    ## Checks that the thermostat and barostat state agrees on all MPI ranks
+    #
+    # \param enable Set to True to enable the check, False to disable it
+    #
+    # \b Examples:
+    # \code
+    # method.check_replicated_state()
+    # method.check_replicated_state(enable=False)
+    # \endcode
+    #
+    # In MPI simulations, integrate.nvt and integrate.npt advance their thermostat and barostat variables
+    # independently on every rank instead of broadcasting them. When the check is enabled, these variables are compared
+    # across all ranks after every step and the run stops with an error if they differ. The check costs one collective
+    # operation per step and is meant for debugging. It has no effect in single-rank simulations.
+    def check_replicated_state(self, enable=True):
+        util.print_status_line();
+        self.check_initialization();
+
+        self.cpp_method.setCheckReplicatedState(enable);
+
 ## Enables a variety of standard integration methods
 #
 # integrate.mode_standard performs a standard time step integration technique to move the system forward. At each time
@@ -749,11 +769,13 @@ class nve(_integration_method):
         _integration_method.__init__(self);
         
         # create the compute thermo
-        compute._get_unique_thermo(group=group);
+        thermo = compute._get_unique_thermo(group=group);
         
         # initialize the reflected c++ class
         if not globals.exec_conf.isCUDAEnabled():
             self.cpp_method = hoomd.TwoStepNVE(globals.system_definition, group.cpp_group, False);
+            # the properties of the group are accumulated along with the net force when possible
+            self.cpp_method.setThermo(thermo.cpp_compute);
         else:
             self.cpp_method = hoomd.TwoStepNVEGPU(globals.system_definition, group.cpp_group);
         
@@ -308,6 +308,48 @@ class coeff:
         return self.values[cur_pair][coeff_name];
         
         
+## \internal
+# \brief Returns True if any %pair %force uses the owner computes thread accumulation mode
+def _owner_computes_in_use():
+    for f in globals.forces:
+        if f.cpp_force is not None and f.cpp_force.supportsThreadAccumulation() and \
+           f.cpp_force.getThreadAccumulation() == hoomd.ForceCompute.threadAccumulationMode.owner_computes:
+            return True;
+    return False;
+
+## \internal
+# \brief Sets the CPU thread accumulation mode of a %pair %force
+# \param cpp_force C++ force compute to change
+# \param mode "partial" or "owner"
+#
+# The owner computes mode needs a full neighbor list, so the global neighbor list is switched to full storage. It is
+# switched back to half storage once no %pair %force uses the owner computes mode any more. On the CPU, no other
+# %pair %force needs full storage.
+def _set_thread_accumulation(cpp_force, mode):
+    if mode not in ["partial", "owner"]:
+        globals.msg.error("Invalid thread accumulation mode " + str(mode) + "\n");
+        raise RuntimeError("Error changing parameters in pair force");
+
+    if not cpp_force.supportsThreadAccumulation():
+        globals.msg.notice(2, "thread_accumulation has no effect on the GPU\n");
+        return;
+
+    nlist = globals.neighbor_list;
+    if mode == "partial":
+        cpp_force.setThreadAccumulation(hoomd.ForceCompute.threadAccumulationMode.thread_partial);
+        if nlist.full_for_owner and not _owner_computes_in_use():
+            globals.msg.notice(2, "No pair force uses thread_accumulation=\"owner\" any more, switching the neighbor list back to half storage\n");
+            nlist.cpp_nlist.setStorageMode(hoomd.NeighborList.storageMode.half);
+            nlist.full_for_owner = False;
+    else:
+        if not nlist.full_for_owner:
+            globals.msg.notice(2, "thread_accumulation=\"owner\" switches the neighbor list to full storage, all pair forces evaluate every pair twice\n");
+            nlist.cpp_nlist.setStorageMode(hoomd.NeighborList.storageMode.full);
+            nlist.full_for_owner = True;
+        cpp_force.setThreadAccumulation(hoomd.ForceCompute.threadAccumulationMode.owner_computes);
+
+    globals.msg.notice(2, "Per thread partial force arrays use %.1f MB\n" % (cpp_force.getThreadPartialBytes() / 1024.0**2));
+
 ## Interface for controlling neighbor list parameters
 #
 # A neighbor list should not be directly created by the user. One will be automatically
@@ -380,6 +422,9 @@ class nlist:
             
         self.cpp_nlist.setEvery(1, True);
         self.is_exclusion_overridden = False;
+
+        # true if the storage was switched to full for a pair force in the owner computes thread accumulation mode
+        self.full_for_owner = False;
         
         globals.system.addCompute(self.cpp_nlist, "auto_nlist");
         
@@ -392,7 +437,8 @@ class nlist:
     
     ## \internal
     # \brief Adds a subscriber to the neighbor list
-    # \param callable is a 0 argument callable object that returns the minimum r_cut needed by the subscriber
+    # \param callable is a 0 argument callable object that returns the minimum r_cut needed by the subscriber, either as
+    #        a single value or as a dictionary of r_cut values keyed by pairs of type indices (see update_rcut())
     # All \a callables will be called at the beginning of each run() to determine the maximum r_cut needed for that run.
     #
     def subscribe(self, callable):
@@ -400,14 +446,35 @@ class nlist:
         
     ## \internal
     # \brief Updates r_cut based on the subscriber's requests
+    # \details
+    # A subscriber either returns a single r_cut that applies to every type pair, or a dictionary mapping pairs of
+    # type indices (i,j) with i <= j to the r_cut needed for that pair. The r_cut of each type pair is the maximum
+    # over all subscribers. The global r_cut is the maximum over all type pairs, and per type pair filtering is only
+    # enabled in the neighbor list when the type pairs need different cutoffs.
     #
     def update_rcut(self):
-        r_cut_max = 0.0;
+        ntypes = globals.system_definition.getParticleData().getNTypes();
+        r_cut_pairs = {};
+        for i in range(0,ntypes):
+            for j in range(i,ntypes):
+                r_cut_pairs[(i,j)] = 0.0;
+        
         for c in self.subscriber_callbacks:
-            r_cut_max = max(r_cut_max, c());
+            r_cut = c();
+            if isinstance(r_cut, dict):
+                for (i,j), r_cut_pair in r_cut.items():
+                    r_cut_pairs[(i,j)] = max(r_cut_pairs[(i,j)], r_cut_pair);
+            else:
+                for key in r_cut_pairs:
+                    r_cut_pairs[key] = max(r_cut_pairs[key], r_cut);
         
+        r_cut_max = max(r_cut_pairs.values());
         self.r_cut = r_cut_max;
         self.cpp_nlist.setRCut(self.r_cut, self.r_buff);
+        
+        for (i,j), r_cut_pair in r_cut_pairs.items():
+            self.cpp_nlist.setRCutPair(i, j, r_cut_pair);
+        self.cpp_nlist.setFilterRcutType(min(r_cut_pairs.values()) < r_cut_max);
     
     ## \internal
     # \brief Sets the default bond exclusions, but only if the defaults have not been overridden
@@ -426,6 +493,7 @@ class nlist:
     #        run() commands. (in distance units)
     # \param dist_check When set to False, disable the distance checking logic and always regenerate the nlist every
     #        \a check_period steps
+    # \param cell_subdivision (if set) changes the number of cells per r_cut+r_buff in the binned neighbor list
     # 
     # set_params() changes one or more parameters of the neighbor list. \a r_buff and \a check_period 
     # can have a significant effect on performance. As \a r_buff is made larger, the neighbor list needs
@@ -457,6 +525,10 @@ class nlist:
     # than necessary if 
     # d_max is greater than 1.0.   
     #
+    # \a cell_subdivision (CPU only) makes the cells of the binned neighbor list 1/\a cell_subdivision of
+    # r_cut+r_buff wide. Smaller cells check fewer particles outside of the cutoff, but more cells must be walked. Use
+    # the candidate and accepted counts printed in the neighbor list statistics to pick the best value.
+    #
     # A single global neighbor list is created for the entire simulation. Change parameters by using
     # the built-in variable \b %nlist.
     #
@@ -466,8 +538,9 @@ class nlist:
     # nlist.set_params(check_period = 11)
     # nlist.set_params(r_buff = 0.7, check_period = 4)
     # nlist.set_params(d_max = 3.0)
+    # nlist.set_params(cell_subdivision = 2)
     # \endcode
-    def set_params(self, r_buff=None, check_period=None, d_max=None, dist_check=True):
+    def set_params(self, r_buff=None, check_period=None, d_max=None, dist_check=True, cell_subdivision=None):
         util.print_status_line();
         
         if self.cpp_nlist is None:
@@ -485,6 +558,12 @@ class nlist:
         if d_max is not None:
             self.cpp_nlist.setMaximumDiameter(d_max);
 
+        if cell_subdivision is not None:
+            if not isinstance(self.cpp_nlist, hoomd.NeighborListBinned):
+                globals.msg.error("cell_subdivision is only supported by the CPU binned neighbor list\n");
+                raise RuntimeError('Error setting neighbor list parameters');
+            self.cpp_nlist.setCellSubdivision(int(cell_subdivision));
+
     ## Resets all exclusions in the neighborlist
     #
     # \param exclusions Select which interactions should be excluded from the %pair interaction calculation.
@@ -733,6 +812,8 @@ class pair(force._force):
     ## Set parameters controlling the way forces are computed
     #
     # \param mode (if set) Set the mode with which potentials are handled at the cutoff
+    # \param vectorize (if set) Set to False to disable the vectorized CPU evaluation of lj, gauss, yukawa and morse
+    # \param thread_accumulation (if set) Set how forces computed by several CPU threads are combined
     #
     # valid values for \a mode are: "none" (the default), "shift", and "xplor"
     #  - \b none - No shifting is performed and potentials are abruptly cut off
@@ -746,11 +827,29 @@ class pair(force._force):
     # mypair.set_params(mode="shift")
     # mypair.set_params(mode="no_shift")
     # mypair.set_params(mode="xplor")
+    # mypair.set_params(vectorize=False)
+    # mypair.set_params(thread_accumulation="owner")
     # \endcode
     # 
-    def set_params(self, mode=None):
+    # valid values for \a thread_accumulation are "partial" (the default) and "owner"
+    #  - \b partial - Each CPU thread sums forces into its own partial arrays of length N, which are added up at the
+    #                 end of every step. The memory and bandwidth needed grow with N times the number of threads.
+    #  - \b owner - Each CPU thread writes the forces of the particles it owns directly. No partial arrays are needed,
+    #               but the neighbor list is switched to full storage and every pair is evaluated twice. This is
+    #               usually faster with many threads and large N. The neighbor list is shared, so all other %pair
+    #               forces also see full storage until every force is set back to "partial".
+    #
+    # \a thread_accumulation has no effect on the GPU.
+    #
+    def set_params(self, mode=None, vectorize=None, thread_accumulation=None):
         util.print_status_line();
         
+        if vectorize is not None:
+            self.cpp_force.setVectorized(bool(vectorize));
+        
+        if thread_accumulation is not None:
+            _set_thread_accumulation(self.cpp_force, thread_accumulation);
+        
         if mode is not None:
             if mode == "no_shift":
                 self.cpp_force.setShiftMode(self.cpp_class.energyShiftMode.no_shift)
@@ -812,6 +911,25 @@ class pair(force._force):
         
         return max_rcut;
 
+    ## \internal
+    # \brief Get the r_cut value set for each type pair
+    # \returns A dictionary mapping each pair of type indices (i,j) with i <= j to its r_cut (0 when the force is
+    #          disabled)
+    # \pre update_coeffs must be called before get_rcut_pairs to verify that the coeffs are set
+    def get_rcut_pairs(self):
+        # go through the list of only the active particle types in the sim
+        ntypes = globals.system_definition.getParticleData().getNTypes();
+        type_list = [];
+        for i in range(0,ntypes):
+            type_list.append(globals.system_definition.getParticleData().getNameByType(i));
+        
+        r_cut_pairs = {};
+        for i in range(0,ntypes):
+            for j in range(i,ntypes):
+                r_cut_pairs[(i,j)] = self.log*self.pair_coeff.get(type_list[i], type_list[j], 'r_cut');
+        
+        return r_cut_pairs;
+
 ## Lennard-Jones %pair %force
 #
 # The command pair.lj specifies that a Lennard-Jones type %pair %force should be added to every
@@ -882,7 +1000,7 @@ class lj(pair):
         
         # update the neighbor list
         neighbor_list = _update_global_nlist(r_cut);
-        neighbor_list.subscribe(lambda: self.log*self.get_max_rcut())
+        neighbor_list.subscribe(self.get_rcut_pairs)
         
         # create the c++ mirror class
         if not globals.exec_conf.isCUDAEnabled():
@@ -975,7 +1093,7 @@ class gauss(pair):
         
         # update the neighbor list
         neighbor_list = _update_global_nlist(r_cut);
-        neighbor_list.subscribe(lambda: self.log*self.get_max_rcut())
+        neighbor_list.subscribe(self.get_rcut_pairs)
         
         # create the c++ mirror class
         if not globals.exec_conf.isCUDAEnabled():
@@ -1091,7 +1209,7 @@ class slj(pair):
             globals.msg.notice(2, "Notice: slj set d_max=" + str(d_max) + "\n");
                         
         neighbor_list = _update_global_nlist(r_cut);
-        neighbor_list.subscribe(lambda: self.log*self.get_max_rcut());
+        neighbor_list.subscribe(self.get_rcut_pairs);
         neighbor_list.cpp_nlist.setMaximumDiameter(d_max);
         
         # create the c++ mirror class
@@ -1209,7 +1327,7 @@ class yukawa(pair):
         
         # update the neighbor list
         neighbor_list = _update_global_nlist(r_cut);
-        neighbor_list.subscribe(lambda: self.log*self.get_max_rcut())
+        neighbor_list.subscribe(self.get_rcut_pairs)
         
         # create the c++ mirror class
         if not globals.exec_conf.isCUDAEnabled():
@@ -1294,7 +1412,7 @@ class ewald(pair):
         
         # update the neighbor list
         neighbor_list = _update_global_nlist(r_cut);
-        neighbor_list.subscribe(lambda: self.log*self.get_max_rcut())
+        neighbor_list.subscribe(self.get_rcut_pairs)
         
         # create the c++ mirror class
         if not globals.exec_conf.isCUDAEnabled():
@@ -1593,6 +1711,23 @@ class table(force._force):
                 maxrmax = max(maxrmax, rmax);
 
         return maxrmax;
+    
+    ## Set parameters controlling the way forces are computed
+    #
+    # \param thread_accumulation (if set) Set how forces computed by several CPU threads are combined
+    #
+    # See pair.set_params() for the valid values of \a thread_accumulation.
+    #
+    # \b Examples:
+    # \code
+    # table.set_params(thread_accumulation="owner")
+    # \endcode
+    #
+    def set_params(self, thread_accumulation=None):
+        util.print_status_line();
+        
+        if thread_accumulation is not None:
+            _set_thread_accumulation(self.cpp_force, thread_accumulation);
                             
     def update_coeffs(self):
         # check that the pair coefficents are valid
@@ -1756,7 +1891,7 @@ class morse(pair):
         
         # update the neighbor list
         neighbor_list = _update_global_nlist(r_cut);
-        neighbor_list.subscribe(lambda: self.log*self.get_max_rcut())
+        neighbor_list.subscribe(self.get_rcut_pairs)
         
         # create the c++ mirror class
         if not globals.exec_conf.isCUDAEnabled():
@@ -1876,7 +2011,7 @@ class dpd(pair):
         
         # update the neighbor list
         neighbor_list = _update_global_nlist(r_cut);
-        neighbor_list.subscribe(lambda: self.log*self.get_max_rcut())
+        neighbor_list.subscribe(self.get_rcut_pairs)
         
         # create the c++ mirror class
         if not globals.exec_conf.isCUDAEnabled():
@@ -1997,7 +2132,7 @@ class dpd_conservative(pair):
         
         # update the neighbor list
         neighbor_list = _update_global_nlist(r_cut);
-        neighbor_list.subscribe(lambda: self.log*self.get_max_rcut())
+        neighbor_list.subscribe(self.get_rcut_pairs)
         
         # create the c++ mirror class
         if not globals.exec_conf.isCUDAEnabled():
@@ -2207,7 +2342,7 @@ class dpdlj(pair):
         
         # update the neighbor list
         neighbor_list = _update_global_nlist(r_cut);
-        neighbor_list.subscribe(lambda: self.log*self.get_max_rcut())
+        neighbor_list.subscribe(self.get_rcut_pairs)
         
         # create the c++ mirror class
         if not globals.exec_conf.isCUDAEnabled():
@@ -2350,7 +2485,7 @@ class force_shifted_lj(pair):
 
         # update the neighbor list
         neighbor_list = _update_global_nlist(r_cut);
-        neighbor_list.subscribe(lambda: self.log*self.get_max_rcut())
+        neighbor_list.subscribe(self.get_rcut_pairs)
 
         # create the c++ mirror class
         if not globals.exec_conf.isCUDAEnabled():
@@ -548,6 +548,97 @@ class box_resize(_updater):
         if scale_particles is not None:
             self.cpp_updater.setParams(scale_particles);
 
+## Balances the number of particles between the MPI ranks
+#
+# Every \a period time steps, update.balance measures the load imbalance, which is the largest number of particles
+# on a rank divided by the mean number of particles per rank. If it exceeds \a tolerance, the boundaries between the
+# domains of the decomposition are moved so that every slab of domains along an axis holds the same number of
+# particles. The grid of ranks stays the same, only the domain sizes change. A boundary moves by at most half the
+# width of its neighboring domains per update, so a strongly inhomogeneous system is balanced over several updates.
+#
+# The current load imbalance can be logged with analyze.log as \b load_imbalance.
+#
+# \param x If True, move the domain boundaries along the x direction
+# \param y If True, move the domain boundaries along the y direction
+# \param z If True, move the domain boundaries along the z direction
+# \param tolerance Load imbalance above which the boundaries are moved
+# \param period The boundaries are checked every \a period time steps
+#
+# \b Examples:
+# \code
+# update.balance()
+# update.balance(tolerance=1.1, period=5000)
+# update.balance(x=True, y=False, z=False)
+# \endcode
+#
+# \note update.balance does nothing in simulations that run on a single rank.
+# \note charge.pppm requires equally sized domains and cannot be combined with update.balance. Whichever of the two
+# is specified second raises an error.
+#
+# \a period can be a function: see \ref variable_period_docs for details
+#
+# \MPI_SUPPORTED
+class balance(_updater):
+    ## Initialize the load balancer
+    #
+    # \param x If True, move the domain boundaries along the x direction
+    # \param y If True, move the domain boundaries along the y direction
+    # \param z If True, move the domain boundaries along the z direction
+    # \param tolerance Load imbalance above which the boundaries are moved
+    # \param period The boundaries are checked every \a period time steps
+    def __init__(self, x=True, y=True, z=True, tolerance=1.05, period=1000):
+        util.print_status_line();
+
+        # initialize base class
+        _updater.__init__(self);
+
+        cpp_decomposition = None;
+        if hoomd.is_MPI_available():
+            cpp_decomposition = globals.system_definition.getParticleData().getDomainDecomposition();
+
+        if cpp_decomposition is None:
+            globals.msg.warning("update.balance: No domain decomposition, ignoring request to balance the load\n")
+            return
+
+        # create the c++ mirror class
+        self.cpp_updater = hoomd.LoadBalancer(globals.system_definition, cpp_decomposition);
+        self.cpp_updater.setTolerance(tolerance);
+        self.cpp_updater.enableDimension(0, x);
+        self.cpp_updater.enableDimension(1, y);
+        self.cpp_updater.enableDimension(2, z);
+
+        self.setupUpdater(period);
+
+    ## Change load balancing parameters
+    #
+    # \param x (if set) If True, move the domain boundaries along the x direction
+    # \param y (if set) If True, move the domain boundaries along the y direction
+    # \param z (if set) If True, move the domain boundaries along the z direction
+    # \param tolerance (if set) Load imbalance above which the boundaries are moved
+    # \param max_shift (if set) Largest move of a boundary per update, as a fraction of the adjacent domain width
+    #        (at most 0.5)
+    #
+    # \b Examples:
+    # \code
+    # balancer = update.balance()
+    # balancer.set_params(tolerance=1.02)
+    # balancer.set_params(z=False, max_shift=0.25)
+    # \endcode
+    def set_params(self, x=None, y=None, z=None, tolerance=None, max_shift=None):
+        util.print_status_line();
+        self.check_initialization();
+
+        if x is not None:
+            self.cpp_updater.enableDimension(0, x);
+        if y is not None:
+            self.cpp_updater.enableDimension(1, y);
+        if z is not None:
+            self.cpp_updater.enableDimension(2, z);
+        if tolerance is not None:
+            self.cpp_updater.setTolerance(tolerance);
+        if max_shift is not None:
+            self.cpp_updater.setMaxShift(max_shift);
+
 # Global current id counter to assign updaters unique names
 _updater.cur_id = 0;
 
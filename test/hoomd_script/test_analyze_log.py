@@ -33,6 +33,25 @@ class analyze_log_tests (unittest.TestCase):
         ana = analyze.log(quantities = ['test1', 'test2', 'test3'], period = lambda n: n*10, filename="test.log");
         run(100);        
     
+    # test batched writing
+    def test_batch_size(self):
+        ana = analyze.log(quantities = ['test1', 'test2', 'test3'], period = 10, filename="test.log", batch_size=4);
+        run(100);
+        self.assertEqual(len(open("test.log").readlines()), 11);
+        ana.set_params(batch_size = 2);
+        run(100);
+        self.assertEqual(len(open("test.log").readlines()), 21);
+
+    # test the binary format
+    def test_binary(self):
+        ana = analyze.log(quantities = ['test1', 'test2'], period = 10, filename="test.log", binary=True,
+                          batch_size=3);
+        run(100);
+        data = analyze.read_binary_log("test.log");
+        self.assertEqual(sorted(data.keys()), ['test1', 'test2', 'timestep']);
+        self.assertEqual(data['timestep'], [float(10*i) for i in range(10)]);
+        self.assertEqual(data['test1'], [0.0]*10);
+
     # test the initialization checks
     def test_init_checks(self):
         ana = analyze.log(quantities = ['test1', 'test2', 'test3'], period = 10, filename="test.log");
@@ -43,7 +43,26 @@ class dmp_dcd_tests (unittest.TestCase):
         dump.dcd(filename="dump_dcd", period=lambda n: n*100);
         run(100)
         os.remove('dump_dcd')
-            
+
+    # tests writing in a background thread
+    def test_queue_depth(self):
+        dump.dcd(filename="dump_dcd", period=10);
+        dcd = dump.dcd(filename="dump_dcd_async", period=10, queue_depth=2);
+        run(100)
+        # run() waits for the queued frames, so the files are complete here without calling dcd.flush()
+        f = open('dump_dcd', 'rb');
+        data = f.read();
+        f.close();
+        f = open('dump_dcd_async', 'rb');
+        data_async = f.read();
+        f.close();
+        # bytes 180 to 260 of the header hold the creation time, which may differ by a minute
+        self.assertEqual(len(data), len(data_async))
+        self.assertEqual(data[:180], data_async[:180])
+        self.assertEqual(data[260:], data_async[260:])
+        os.remove('dump_dcd')
+        os.remove('dump_dcd_async')
+
     # test disable/enable
     def test_enable_disable(self):
         dcd = dump.dcd(filename="dump_dcd", period=100);
@@ -0,0 +1,74 @@
+# -*- coding: iso-8859-1 -*-
+# Maintainer: joaander
+
+from hoomd_script import *
+import unittest
+import os
+import random
+
+# unit tests for init.read_xml on several ranks, where every rank reads its own stripe of the particles
+class init_read_xml_mpi_tests (unittest.TestCase):
+    def setUp(self):
+        print
+        # enough particles that the <position> node spans several blocks of the reader
+        self.N = 150001;
+        random.seed(12345);
+        self.pos = [(random.uniform(-9.9, 9.9), random.uniform(-9.9, 9.9), random.uniform(-9.9, 9.9))
+                    for i in range(self.N)];
+
+        # type B appears first in the file, but not in the stripes of the later ranks
+        self.type = ['B' if i < self.N // 8 else 'A' for i in range(self.N)];
+
+        lines = ['<?xml version="1.0" encoding="UTF-8"?>\n',
+                 '<hoomd_xml version="1.4">\n',
+                 '<configuration time_step="0">\n',
+                 '<box lx="20" ly="20" lz="20"/>\n',
+                 '<position num="%d">\n' % self.N];
+        lines += ['%.6f %.6f %.6f\n' % p for p in self.pos];
+        lines += ['</position>\n', '<image>\n'];
+        lines += ['%d 0 %d\n' % (i % 3 - 1, i % 2) for i in range(self.N)];
+        lines += ['</image>\n', '<mass>\n'];
+        lines += ['%d\n' % (1 + i % 5) for i in range(self.N)];
+        lines += ['</mass>\n', '<type>\n'];
+        lines += ['%s\n' % t for t in self.type];
+        lines += ['</type>\n',
+                  '<bond>\n',
+                  'polymer 0 1\n',
+                  'polymer %d %d\n' % (self.N - 2, self.N - 1),
+                  '</bond>\n',
+                  '</configuration>\n',
+                  '</hoomd_xml>\n'];
+
+        # every rank writes the same file, the rename makes sure that no rank reads a partially written one
+        self.fname = 'test_mpi.xml';
+        tmp_name = '%s.%d' % (self.fname, comm.get_rank());
+        f = open(tmp_name, 'w');
+        f.write(''.join(lines));
+        f.close();
+        os.rename(tmp_name, self.fname);
+
+    # tests that every particle ends up on exactly one rank with the values from the file
+    def test(self):
+        system = init.read_xml(self.fname);
+        self.assertEqual(len(system.particles), self.N);
+        self.assertEqual(len(system.bonds), 2);
+
+        for tag in list(range(0, self.N, 997)) + [self.N - 1]:
+            p = system.particles[tag];
+            for j in range(3):
+                self.assertAlmostEqual(p.position[j], self.pos[tag][j], 4);
+            self.assertEqual(p.image, (tag % 3 - 1, 0, tag % 2));
+            self.assertAlmostEqual(p.mass, 1 + tag % 5, 5);
+            self.assertEqual(p.type, self.type[tag]);
+
+        b = system.bonds[1];
+        self.assertEqual((b.a, b.b), (self.N - 2, self.N - 1));
+
+    def tearDown(self):
+        init.reset();
+        # all ranks have read the file once init.read_xml returns
+        if comm.get_rank() == 0:
+            os.remove(self.fname);
+
+if __name__ == '__main__':
+    unittest.main(argv = ['test.py', '-v'])
@@ -28,6 +28,15 @@ class integrate_nvt_tests (unittest.TestCase):
         nvt.set_params(T=1.3);
         nvt.set_params(tau=0.6);
 
+    # test the replicated state check
+    def test_check_replicated_state(self):
+        all = group.all();
+        integrate.mode_standard(dt=0.005);
+        nvt = integrate.nvt(all, T=1.2, tau=0.5);
+        nvt.check_replicated_state();
+        run(10);
+        nvt.check_replicated_state(enable=False);
+
     # test w/ empty group
     def test_empty(self):
         empty = group.cuboid(name="empty", xmin=-100, xmax=-100, ymin=-100, ymax=-100, zmin=-100, zmax=-100)
@@ -37,6 +37,24 @@ class pair_lj_tests (unittest.TestCase):
         lj.set_params(mode="shift");
         lj.set_params(mode="xplor");
         self.assertRaises(RuntimeError, lj.set_params, mode="blah");
+
+    # test that the owner computes mode switches the shared neighbor list to full storage and back
+    def test_set_params_thread_accumulation(self):
+        lj = pair.lj(r_cut=3.0);
+        gauss = pair.gauss(r_cut=3.0);
+        self.assertRaises(RuntimeError, lj.set_params, thread_accumulation="blah");
+        if globals.exec_conf.isCUDAEnabled():
+            return;
+
+        half = hoomd.NeighborList.storageMode.half;
+        full = hoomd.NeighborList.storageMode.full;
+        lj.set_params(thread_accumulation="owner");
+        gauss.set_params(thread_accumulation="owner");
+        self.assertEqual(globals.neighbor_list.cpp_nlist.getStorageMode(), full);
+        lj.set_params(thread_accumulation="partial");
+        self.assertEqual(globals.neighbor_list.cpp_nlist.getStorageMode(), full);
+        gauss.set_params(thread_accumulation="partial");
+        self.assertEqual(globals.neighbor_list.cpp_nlist.getStorageMode(), half);
     
     # test default coefficients
     def test_default_coeff(self):
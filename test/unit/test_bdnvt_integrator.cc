@@ -69,9 +69,16 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "NeighborListBinned.h"
 #include "Initializers.h"
 #include "AllPairPotentials.h"
+#include "ConstForceCompute.h"
+#include "SFCPackUpdater.h"
+#include "SnapshotSystemData.h"
 
 #include <math.h>
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 using namespace boost;
 
@@ -602,6 +609,100 @@ void bd_updater_lj_tests(twostepbdnvt_creator bdnvt_creator, boost::shared_ptr<E
     }
 
 
+//! Runs TwoStepBDNVT on a copy of \a snap and returns the final velocities indexed by tag
+/*! \param exec_conf Execution configuration to run on
+    \param snap Initial configuration
+    \param n_threads Number of OpenMP threads to run with
+    \param sort_step Step before which the particles are sorted with SFCPackUpdater, or -1 for no sort
+    \param vel Filled with the velocities after the run, indexed by tag
+*/
+void bd_updater_run(boost::shared_ptr<ExecutionConfiguration> exec_conf,
+                    boost::shared_ptr<SnapshotSystemData> snap,
+                    int n_threads,
+                    int sort_step,
+                    std::vector<Scalar3>& vel)
+    {
+#ifdef ENABLE_OPENMP
+    int max_threads = omp_get_max_threads();
+    unsigned int n_cpu = exec_conf->n_cpu;
+    exec_conf->n_cpu = std::max(n_cpu, (unsigned int)n_threads);
+    omp_set_num_threads(n_threads);
+#endif
+
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(snap, exec_conf));
+    shared_ptr<ParticleData> pdata = sysdef->getParticleData();
+    shared_ptr<ParticleSelector> selector_all(new ParticleSelectorTag(sysdef, 0, pdata->getN()-1));
+    shared_ptr<ParticleGroup> group_all(new ParticleGroup(sysdef, selector_all));
+
+    // a constant force keeps the net force independent of the particle order and the number of threads
+    shared_ptr<ConstForceCompute> fc(new ConstForceCompute(sysdef, 0.5, -0.25, 0.125));
+    shared_ptr<SFCPackUpdater> sorter(new SFCPackUpdater(sysdef));
+
+    shared_ptr<VariantConst> T_variant(new VariantConst(Scalar(1.5)));
+    shared_ptr<TwoStepBDNVT> two_step_bdnvt(new TwoStepBDNVT(sysdef, group_all, T_variant, 271, false));
+    two_step_bdnvt->setGamma(0, Scalar(2.0));
+    shared_ptr<IntegratorTwoStep> bdnvt_up(new IntegratorTwoStep(sysdef, Scalar(0.005)));
+    bdnvt_up->addIntegrationMethod(two_step_bdnvt);
+    bdnvt_up->addForceCompute(fc);
+    bdnvt_up->prepRun(0);
+
+    for (int i = 0; i < 20; i++)
+        {
+        if (i == sort_step)
+            sorter->update(i);
+        bdnvt_up->update(i);
+        }
+
+    ArrayHandle<Scalar4> h_vel(pdata->getVelocities(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_rtag(pdata->getRTags(), access_location::host, access_mode::read);
+    vel.resize(pdata->getN());
+    for (unsigned int tag = 0; tag < pdata->getN(); tag++)
+        {
+        unsigned int j = h_rtag.data[tag];
+        vel[tag] = make_scalar3(h_vel.data[j].x, h_vel.data[j].y, h_vel.data[j].z);
+        }
+
+#ifdef ENABLE_OPENMP
+    exec_conf->n_cpu = n_cpu;
+    omp_set_num_threads(max_threads);
+#endif
+    }
+
+//! Checks that the random forces of TwoStepBDNVT follow the particles
+/*! The random numbers are drawn from a stream seeded by the particle tag. The velocities must therefore be
+    bit-identical with 1 and 4 threads and with and without sorting the particles in the middle of the run.
+*/
+void bd_updater_order_tests(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    const unsigned int N = 2000;
+
+    // the random initializer places the particles in no particular spatial order, so the sort reorders them
+    RandomInitializer rand_init(N, Scalar(0.2), Scalar(0.9), "A");
+    rand_init.setSeed(12345);
+    boost::shared_ptr<SnapshotSystemData> snap = rand_init.getSnapshot();
+    for (unsigned int j = 0; j < N; j++)
+        snap->particle_data.vel[j] = make_scalar3(sin(Scalar(j)), cos(Scalar(3*j)), sin(Scalar(7*j+1)));
+
+    std::vector<Scalar3> vel_ref, vel_threads, vel_sort, vel_sort_threads;
+    bd_updater_run(exec_conf, snap, 1, -1, vel_ref);
+    bd_updater_run(exec_conf, snap, 4, -1, vel_threads);
+    bd_updater_run(exec_conf, snap, 1, 10, vel_sort);
+    bd_updater_run(exec_conf, snap, 4, 10, vel_sort_threads);
+
+    for (unsigned int tag = 0; tag < N; tag++)
+        {
+        BOOST_CHECK_EQUAL(vel_threads[tag].x, vel_ref[tag].x);
+        BOOST_CHECK_EQUAL(vel_threads[tag].y, vel_ref[tag].y);
+        BOOST_CHECK_EQUAL(vel_threads[tag].z, vel_ref[tag].z);
+        BOOST_CHECK_EQUAL(vel_sort[tag].x, vel_ref[tag].x);
+        BOOST_CHECK_EQUAL(vel_sort[tag].y, vel_ref[tag].y);
+        BOOST_CHECK_EQUAL(vel_sort[tag].z, vel_ref[tag].z);
+        BOOST_CHECK_EQUAL(vel_sort_threads[tag].x, vel_ref[tag].x);
+        BOOST_CHECK_EQUAL(vel_sort_threads[tag].y, vel_ref[tag].y);
+        BOOST_CHECK_EQUAL(vel_sort_threads[tag].z, vel_ref[tag].z);
+        }
+    }
+
 //! BD_NVTUpdater factory for the unit tests
 shared_ptr<TwoStepBDNVT> base_class_bdnvt_creator(shared_ptr<SystemDefinition> sysdef,
                                                   shared_ptr<ParticleGroup> group,
@@ -654,6 +755,12 @@ BOOST_AUTO_TEST_CASE( BDUpdater_LJ_tests )
     bd_updater_lj_tests(bdnvt_creator, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
     }
 
+//! particle order and thread count test for the base class
+BOOST_AUTO_TEST_CASE( BDUpdater_order_tests )
+    {
+    bd_updater_order_tests(boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
+
 #ifdef ENABLE_CUDA
 //! Basic test for the GPU class
 BOOST_AUTO_TEST_CASE( BDUpdaterGPU_tests )
@@ -278,6 +278,79 @@ BOOST_AUTO_TEST_CASE( HOOMDBinaryReaderWriterBasicTests )
     remove_all("test.0000000000.bin");
     remove_all("test.0000000010.bin");
     }
+
+
+//! Checks that frames can be appended to and read back from a chunked file
+BOOST_AUTO_TEST_CASE( HOOMDBinaryReaderWriterChunkedTests )
+    {
+    BoxDim box(Scalar(5.0), Scalar(6.0), Scalar(7.0));
+    int n_atom = 3;
+
+    boost::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    shared_ptr<SystemDefinition> sysdef1(new SystemDefinition(n_atom, box, 2, 1, 0, 0, 0, exec_conf));
+    shared_ptr<ParticleData> pdata1 = sysdef1->getParticleData();
+    sysdef1->getBondData()->addBond(Bond(0, 0, 2));
+
+    Scalar x0(1.25), vy1(-0.5), mass2(2.5);
+    {
+    ArrayHandle<Scalar4> h_pos(pdata1->getPositions(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar4> h_vel(pdata1->getVelocities(), access_location::host, access_mode::readwrite);
+    h_pos.data[0].x = x0;
+    h_pos.data[2].w = __int_as_scalar(1);
+    h_vel.data[1].y = vy1;
+    h_vel.data[2].w = mass2;
+    }
+
+    shared_ptr<HOOMDBinaryDumpWriter> writer(new HOOMDBinaryDumpWriter(sysdef1, "test.chunked.bin"));
+    writer->setChunked(true);
+    writer->enableCompression(true);
+
+    remove_all("test.chunked.bin");
+    BOOST_REQUIRE(!exists("test.chunked.bin"));
+
+    // write two frames, changing a position in between
+    writer->analyze(0);
+    {
+    ArrayHandle<Scalar4> h_pos(pdata1->getPositions(), access_location::host, access_mode::readwrite);
+    h_pos.data[0].x = -x0;
+    }
+    writer->analyze(10);
+    BOOST_REQUIRE(exists("test.chunked.bin"));
+
+    // read the first frame
+    HOOMDBinaryInitializer init(exec_conf, "test.chunked.bin", 0);
+    BOOST_CHECK_EQUAL(init.getNumFrames(), (unsigned int)2);
+    BOOST_CHECK_EQUAL(init.getTimeStep(), (unsigned int)0);
+    shared_ptr<SystemDefinition> sysdef2(new SystemDefinition(init.getSnapshot(), exec_conf));
+    shared_ptr<ParticleData> pdata2 = sysdef2->getParticleData();
+
+    BOOST_CHECK_EQUAL(pdata2->getN(), (unsigned int)n_atom);
+    BOOST_CHECK_EQUAL(pdata2->getNTypes(), (unsigned int)2);
+    BOOST_CHECK_EQUAL(sysdef2->getBondData()->getNumBonds(), (unsigned int)1);
+    MY_BOOST_CHECK_CLOSE(pdata2->getBox().getL().z, Scalar(7.0), tol);
+    {
+    ArrayHandle<Scalar4> h_pos(pdata2->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_vel(pdata2->getVelocities(), access_location::host, access_mode::read);
+    BOOST_CHECK_EQUAL(h_pos.data[0].x, x0);
+    BOOST_CHECK_EQUAL((unsigned int)__scalar_as_int(h_pos.data[2].w), (unsigned int)1);
+    BOOST_CHECK_EQUAL(h_vel.data[1].y, vy1);
+    BOOST_CHECK_EQUAL(h_vel.data[2].w, mass2);
+    }
+
+    // the last frame is read by default
+    HOOMDBinaryInitializer init2(exec_conf, "test.chunked.bin");
+    BOOST_CHECK_EQUAL(init2.getTimeStep(), (unsigned int)10);
+    shared_ptr<SystemDefinition> sysdef3(new SystemDefinition(init2.getSnapshot(), exec_conf));
+    {
+    ArrayHandle<Scalar4> h_pos(sysdef3->getParticleData()->getPositions(), access_location::host, access_mode::read);
+    BOOST_CHECK_EQUAL(h_pos.data[0].x, -x0);
+    }
+
+    // frames that do not exist are an error
+    BOOST_CHECK_THROW(HOOMDBinaryInitializer(exec_conf, "test.chunked.bin", 2), runtime_error);
+
+    remove_all("test.chunked.bin");
+    }
     
 #ifdef WIN32
 #pragma warning( pop )
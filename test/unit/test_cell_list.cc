@@ -56,6 +56,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
@@ -70,6 +71,10 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <math.h>
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 using namespace boost;
 
@@ -636,3 +641,76 @@ BOOST_AUTO_TEST_CASE( CellListGPU_large )
     }
 #endif
 
+
+//! Validate that the multithreaded cell list build produces the same layout as the serial build
+void celllist_threaded_test(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    unsigned int N = 10000;
+    RandomInitializer rand_init(N, Scalar(0.2), Scalar(0.9), "A");
+    boost::shared_ptr<SnapshotSystemData> snap;
+    snap = rand_init.getSnapshot();
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(snap, exec_conf));
+
+#ifdef ENABLE_OPENMP
+    // make sure the counting sort really runs on several threads, even on a machine with a single core
+    int n_threads = omp_get_max_threads();
+    unsigned int n_cpu = exec_conf->n_cpu;
+    omp_set_num_threads(std::max(n_threads, 4));
+    exec_conf->n_cpu = std::max(n_threads, 4);
+#endif
+
+    // ********* initialize a serial and a multithreaded cell list *********
+    shared_ptr<CellList> cl_serial(new CellList(sysdef));
+    cl_serial->setNominalWidth(Scalar(3.0));
+    cl_serial->setFlagIndex();
+    cl_serial->setComputeTDB(true);
+    cl_serial->setMultithreaded(false);
+    cl_serial->compute(0);
+
+    shared_ptr<CellList> cl_threaded(new CellList(sysdef));
+    cl_threaded->setNominalWidth(Scalar(3.0));
+    cl_threaded->setFlagIndex();
+    cl_threaded->setComputeTDB(true);
+    cl_threaded->setMultithreaded(true);
+    cl_threaded->compute(0);
+
+#ifdef ENABLE_OPENMP
+    omp_set_num_threads(n_threads);
+    exec_conf->n_cpu = n_cpu;
+#endif
+
+    BOOST_REQUIRE_EQUAL_UINT(cl_serial->getNmax(), cl_threaded->getNmax());
+    BOOST_REQUIRE_EQUAL_UINT(cl_serial->getCellIndexer().getNumElements(),
+                             cl_threaded->getCellIndexer().getNumElements());
+
+    // verify that both cell lists hold the same particles in the same order
+    ArrayHandle<unsigned int> h_cell_size_serial(cl_serial->getCellSizeArray(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_xyzf_serial(cl_serial->getXYZFArray(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_tdb_serial(cl_serial->getTDBArray(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_cell_size_threaded(cl_threaded->getCellSizeArray(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_xyzf_threaded(cl_threaded->getXYZFArray(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_tdb_threaded(cl_threaded->getTDBArray(), access_location::host, access_mode::read);
+
+    Index2D cli = cl_serial->getCellListIndexer();
+    unsigned int ncell = cl_serial->getCellIndexer().getNumElements();
+    for (unsigned int cell = 0; cell < ncell; cell++)
+        {
+        BOOST_REQUIRE_EQUAL_UINT(h_cell_size_serial.data[cell], h_cell_size_threaded.data[cell]);
+        for (unsigned int offset = 0; offset < h_cell_size_serial.data[cell]; offset++)
+            {
+            Scalar4 a = h_xyzf_serial.data[cli(offset, cell)];
+            Scalar4 b = h_xyzf_threaded.data[cli(offset, cell)];
+            BOOST_CHECK_EQUAL(__scalar_as_int(a.w), __scalar_as_int(b.w));
+            BOOST_CHECK_EQUAL(a.x, b.x);
+            BOOST_CHECK_EQUAL(a.y, b.y);
+            BOOST_CHECK_EQUAL(a.z, b.z);
+            BOOST_CHECK_EQUAL(h_tdb_serial.data[cli(offset, cell)].y, h_tdb_threaded.data[cli(offset, cell)].y);
+            }
+        }
+    }
+
+//! boost test case for celllist_threaded_test
+BOOST_AUTO_TEST_CASE( CellList_threaded )
+    {
+    celllist_threaded_test(boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
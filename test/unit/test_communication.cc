@@ -66,6 +66,9 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "DomainDecomposition.h"
 
 #include "ConstForceCompute.h"
+#include "SnapshotSystemData.h"
+#include "AllPairPotentials.h"
+#include "NeighborListBinned.h"
 #include "TwoStepNVE.h"
 #include "IntegratorTwoStep.h"
 
@@ -216,6 +219,189 @@ void test_domain_decomposition(boost::shared_ptr<ExecutionConfiguration> exec_co
     BOOST_CHECK_CLOSE(pos.z,  0.5, tol_small);
     }
 
+//! Test that replicated, root-only and partial snapshots distribute the particles in the same way
+void test_domain_decomposition_distributed(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // this test needs to be run on eight processors
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    BOOST_REQUIRE_EQUAL(size,8);
+
+    // random system, identical on every rank
+    unsigned int n = 1000;
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(n, BoxDim(10.0), 1, 0, 0, 0, 0, exec_conf));
+    boost::shared_ptr<ParticleData> pdata(sysdef->getParticleData());
+        {
+        ArrayHandle<Scalar4> h_pos(pdata->getPositions(), access_location::host, access_mode::readwrite);
+        ArrayHandle<Scalar4> h_vel(pdata->getVelocities(), access_location::host, access_mode::readwrite);
+        ArrayHandle<int3> h_image(pdata->getImages(), access_location::host, access_mode::readwrite);
+        srand(12345);
+        for (unsigned int i = 0; i < n; i++)
+            {
+            h_pos.data[i].x = Scalar(10.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+            h_pos.data[i].y = Scalar(10.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+            h_pos.data[i].z = Scalar(10.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+            h_vel.data[i].x = Scalar(i);
+            h_vel.data[i].w = Scalar(1.0) + Scalar(i % 7);
+            h_image.data[i] = make_int3(i % 3, 0, -1);
+            }
+        }
+
+    SnapshotParticleData snap(n);
+    pdata->takeSnapshot(snap);
+
+    // the first particle data is initialized from the snapshot on every rank, the second from rank 0 only and the
+    // third from a partial snapshot on every rank, which holds every size-th particle in reverse order
+    shared_ptr<SystemDefinition> sysdef_1(new SystemDefinition(1, BoxDim(10.0), 1, 0, 0, 0, 0, exec_conf));
+    shared_ptr<SystemDefinition> sysdef_2(new SystemDefinition(1, BoxDim(10.0), 1, 0, 0, 0, 0, exec_conf));
+    shared_ptr<SystemDefinition> sysdef_3(new SystemDefinition(1, BoxDim(10.0), 1, 0, 0, 0, 0, exec_conf));
+    boost::shared_ptr<ParticleData> pdata_1(sysdef_1->getParticleData());
+    boost::shared_ptr<ParticleData> pdata_2(sysdef_2->getParticleData());
+    boost::shared_ptr<ParticleData> pdata_3(sysdef_3->getParticleData());
+
+    boost::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, pdata->getBox().getL()));
+    pdata_1->setDomainDecomposition(decomposition);
+    pdata_2->setDomainDecomposition(decomposition);
+    pdata_3->setDomainDecomposition(decomposition);
+
+    snap.replicated = true;
+    pdata_1->initializeFromSnapshot(snap);
+    snap.replicated = false;
+    if (exec_conf->getRank() == 0)
+        pdata_2->initializeFromSnapshot(snap);
+    else
+        pdata_2->initializeFromSnapshot(SnapshotParticleData(0));
+
+    SnapshotParticleData part;
+    part.type_mapping = snap.type_mapping;
+    part.global_size = n;
+    for (int tag = n - 1; tag >= 0; tag--)
+        {
+        if (tag % size != (int)exec_conf->getRank())
+            continue;
+
+        part.resize(part.size + 1);
+        part.tag.push_back(tag);
+        part.pos[part.size-1] = snap.pos[tag];
+        part.vel[part.size-1] = snap.vel[tag];
+        part.mass[part.size-1] = snap.mass[tag];
+        part.image[part.size-1] = snap.image[tag];
+        }
+    pdata_3->initializeFromSnapshot(part);
+
+    BOOST_CHECK_EQUAL(pdata_1->getNGlobal(), n);
+    BOOST_CHECK_EQUAL(pdata_3->getNGlobal(), n);
+    BOOST_REQUIRE_EQUAL(pdata_1->getN(), pdata_2->getN());
+    BOOST_REQUIRE_EQUAL(pdata_1->getN(), pdata_3->getN());
+
+    unsigned int n_local = pdata_1->getN();
+    unsigned int n_total;
+    MPI_Allreduce(&n_local, &n_total, 1, MPI_UNSIGNED, MPI_SUM, MPI_COMM_WORLD);
+    BOOST_CHECK_EQUAL(n_total, n);
+
+    ArrayHandle<Scalar4> h_pos_1(pdata_1->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_pos_2(pdata_2->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_vel_1(pdata_1->getVelocities(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_vel_2(pdata_2->getVelocities(), access_location::host, access_mode::read);
+    ArrayHandle<int3> h_image_1(pdata_1->getImages(), access_location::host, access_mode::read);
+    ArrayHandle<int3> h_image_2(pdata_2->getImages(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag_1(pdata_1->getTags(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag_2(pdata_2->getTags(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_rtag_1(pdata_1->getRTags(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_pos_3(pdata_3->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_vel_3(pdata_3->getVelocities(), access_location::host, access_mode::read);
+    ArrayHandle<int3> h_image_3(pdata_3->getImages(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag_3(pdata_3->getTags(), access_location::host, access_mode::read);
+
+    for (unsigned int i = 0; i < n_local; i++)
+        {
+        BOOST_CHECK_EQUAL(h_tag_1.data[i], h_tag_2.data[i]);
+        BOOST_CHECK_EQUAL(h_tag_1.data[i], h_tag_3.data[i]);
+        BOOST_CHECK_EQUAL(h_pos_1.data[i].x, h_pos_3.data[i].x);
+        BOOST_CHECK_EQUAL(h_pos_1.data[i].y, h_pos_3.data[i].y);
+        BOOST_CHECK_EQUAL(h_pos_1.data[i].z, h_pos_3.data[i].z);
+        BOOST_CHECK_EQUAL(h_vel_1.data[i].x, h_vel_3.data[i].x);
+        BOOST_CHECK_EQUAL(h_vel_1.data[i].w, h_vel_3.data[i].w);
+        BOOST_CHECK_EQUAL(h_image_1.data[i].x, h_image_3.data[i].x);
+        BOOST_CHECK_EQUAL(h_image_1.data[i].z, h_image_3.data[i].z);
+        BOOST_CHECK_EQUAL(h_rtag_1.data[h_tag_1.data[i]], i);
+        BOOST_CHECK_EQUAL(h_pos_1.data[i].x, h_pos_2.data[i].x);
+        BOOST_CHECK_EQUAL(h_pos_1.data[i].y, h_pos_2.data[i].y);
+        BOOST_CHECK_EQUAL(h_pos_1.data[i].z, h_pos_2.data[i].z);
+        BOOST_CHECK_EQUAL(h_vel_1.data[i].x, h_vel_2.data[i].x);
+        BOOST_CHECK_EQUAL(h_vel_1.data[i].w, h_vel_2.data[i].w);
+        BOOST_CHECK_EQUAL(h_image_1.data[i].x, h_image_2.data[i].x);
+        BOOST_CHECK_EQUAL(h_image_1.data[i].z, h_image_2.data[i].z);
+        }
+    }
+
+//! Test that a snapshot taken from a decomposed system restores the same system
+void test_snapshot_round_trip(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // this test needs to be run on eight processors
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    BOOST_REQUIRE_EQUAL(size,8);
+
+    // random system, distributed from rank 0
+    unsigned int n = 1000;
+    SnapshotParticleData snap(n);
+    snap.type_mapping.push_back("A");
+    srand(54321);
+    for (unsigned int i = 0; i < n; i++)
+        {
+        snap.pos[i] = make_scalar3(Scalar(10.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5)),
+                                   Scalar(10.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5)),
+                                   Scalar(10.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5)));
+        snap.vel[i] = make_scalar3(Scalar(i), Scalar(0.0), Scalar(-1.0));
+        snap.mass[i] = Scalar(1.0) + Scalar(i % 7);
+        snap.image[i] = make_int3(i % 3, 0, -1);
+        }
+
+    shared_ptr<SystemDefinition> sysdef_1(new SystemDefinition(1, BoxDim(10.0), 1, 0, 0, 0, 0, exec_conf));
+    shared_ptr<SystemDefinition> sysdef_2(new SystemDefinition(1, BoxDim(10.0), 1, 0, 0, 0, 0, exec_conf));
+    boost::shared_ptr<ParticleData> pdata_1(sysdef_1->getParticleData());
+    boost::shared_ptr<ParticleData> pdata_2(sysdef_2->getParticleData());
+
+    boost::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, BoxDim(10.0).getL()));
+    pdata_1->setDomainDecomposition(decomposition);
+    pdata_2->setDomainDecomposition(decomposition);
+
+    pdata_1->initializeFromSnapshot(snap);
+
+    // every rank receives a full size snapshot from takeSnapshot, but only the one on rank 0 holds the particles
+    SnapshotParticleData taken;
+    pdata_1->takeSnapshot(taken);
+    BOOST_CHECK_EQUAL(taken.size, n);
+    pdata_2->initializeFromSnapshot(taken);
+
+    BOOST_CHECK_EQUAL(pdata_2->getNGlobal(), n);
+    BOOST_REQUIRE_EQUAL(pdata_2->getN(), pdata_1->getN());
+
+    ArrayHandle<Scalar4> h_pos_1(pdata_1->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_pos_2(pdata_2->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_vel_1(pdata_1->getVelocities(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_vel_2(pdata_2->getVelocities(), access_location::host, access_mode::read);
+    ArrayHandle<int3> h_image_1(pdata_1->getImages(), access_location::host, access_mode::read);
+    ArrayHandle<int3> h_image_2(pdata_2->getImages(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag_1(pdata_1->getTags(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_rtag_2(pdata_2->getRTags(), access_location::host, access_mode::read);
+
+    for (unsigned int i = 0; i < pdata_1->getN(); i++)
+        {
+        // the restored particle has to be local on the same rank
+        unsigned int j = h_rtag_2.data[h_tag_1.data[i]];
+        BOOST_REQUIRE(j < pdata_2->getN());
+        BOOST_CHECK_EQUAL(h_pos_1.data[i].x, h_pos_2.data[j].x);
+        BOOST_CHECK_EQUAL(h_pos_1.data[i].y, h_pos_2.data[j].y);
+        BOOST_CHECK_EQUAL(h_pos_1.data[i].z, h_pos_2.data[j].z);
+        BOOST_CHECK_EQUAL(h_vel_1.data[i].x, h_vel_2.data[j].x);
+        BOOST_CHECK_EQUAL(h_vel_1.data[i].w, h_vel_2.data[j].w);
+        BOOST_CHECK_EQUAL(h_image_1.data[i].x, h_image_2.data[j].x);
+        BOOST_CHECK_EQUAL(h_image_1.data[i].z, h_image_2.data[j].z);
+        }
+    }
+
 //! Test particle migration of Communicator
 void test_communicator_migrate(communicator_creator comm_creator, shared_ptr<ExecutionConfiguration> exec_conf)
     {
@@ -2108,6 +2294,217 @@ void test_communicator_bonded_ghosts(communicator_creator comm_creator, shared_p
         }
     }
 
+//! Requests the ghost charges only
+CommFlags request_charge(unsigned int timestep)
+    {
+    CommFlags flags(0);
+    flags[comm_flag::charge] = 1;
+    return flags;
+    }
+
+//! Requests the ghost diameters only
+CommFlags request_diameter(unsigned int timestep)
+    {
+    CommFlags flags(0);
+    flags[comm_flag::diameter] = 1;
+    return flags;
+    }
+
+//! Test that the optional ghost fields are sent when they are requested
+void test_communicator_ghost_fields(communicator_creator comm_creator, shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // this test needs to be run on eight processors
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    BOOST_REQUIRE_EQUAL(size,8);
+
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(9,           // number of particles
+                                                             BoxDim(2.0), // box dimensions
+                                                             1,           // number of particle types
+                                                             0,           // number of bond types
+                                                             0,           // number of angle types
+                                                             0,           // number of dihedral types
+                                                             0,           // number of dihedral types
+                                                             exec_conf));
+
+    boost::shared_ptr<ParticleData> pdata(sysdef->getParticleData());
+
+    // place one particle in the middle of every box
+    pdata->setPosition(0, make_scalar3(-0.5,-0.5,-0.5));
+    pdata->setPosition(1, make_scalar3( 0.5,-0.5,-0.5));
+    pdata->setPosition(2, make_scalar3(-0.5, 0.5,-0.5));
+    pdata->setPosition(3, make_scalar3( 0.5, 0.5,-0.5));
+    pdata->setPosition(4, make_scalar3(-0.5,-0.5, 0.5));
+    pdata->setPosition(5, make_scalar3( 0.5,-0.5, 0.5));
+    pdata->setPosition(6, make_scalar3(-0.5, 0.5, 0.5));
+    pdata->setPosition(7, make_scalar3( 0.5, 0.5, 0.5));
+
+    // place particle 8 in the box of rank 0 and in the ghost layer of its +x neighbor
+    pdata->setPosition(8, make_scalar3(-0.02,-0.5,-0.5));
+    pdata->setCharge(8, 2.0);
+    pdata->setDiameter(8, 3.0);
+
+    SnapshotParticleData snap(9);
+    pdata->takeSnapshot(snap);
+
+    boost::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf,  pdata->getBox().getL()));
+    boost::shared_ptr<Communicator> comm = comm_creator(sysdef, decomposition);
+
+    pdata->setDomainDecomposition(decomposition);
+    pdata->initializeFromSnapshot(snap);
+
+    comm->setGhostLayerWidth(Scalar(0.1));
+
+    // only the charge is requested
+    boost::signals::connection charge_connection = comm->addCommFlagsRequest(bind(request_charge, _1));
+    comm->communicate(0);
+
+    BOOST_CHECK(comm->getFlags()[comm_flag::charge]);
+    BOOST_CHECK(!comm->getFlags()[comm_flag::diameter]);
+
+    if (exec_conf->getRank() == 1)
+        {
+        BOOST_REQUIRE_EQUAL(pdata->getNGhosts(), 1);
+        ArrayHandle<Scalar> h_charge(pdata->getCharges(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_pos(pdata->getPositions(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_rtag(pdata->getRTags(), access_location::host, access_mode::read);
+        unsigned int rtag = h_rtag.data[8];
+        BOOST_REQUIRE_EQUAL(rtag, pdata->getN());
+        BOOST_CHECK_CLOSE(h_pos.data[rtag].x, -0.02, tol_small);
+        BOOST_CHECK_CLOSE(h_charge.data[rtag], 2.0, tol_small);
+        }
+
+    // the requests are combined on the next exchange
+    boost::signals::connection diameter_connection = comm->addCommFlagsRequest(bind(request_diameter, _1));
+    comm->forceMigrate();
+    comm->communicate(1);
+
+    BOOST_CHECK(comm->getFlags()[comm_flag::charge]);
+    BOOST_CHECK(comm->getFlags()[comm_flag::diameter]);
+
+    if (exec_conf->getRank() == 1)
+        {
+        BOOST_REQUIRE_EQUAL(pdata->getNGhosts(), 1);
+        ArrayHandle<Scalar> h_charge(pdata->getCharges(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_diameter(pdata->getDiameters(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_rtag(pdata->getRTags(), access_location::host, access_mode::read);
+        unsigned int rtag = h_rtag.data[8];
+        BOOST_REQUIRE_EQUAL(rtag, pdata->getN());
+        BOOST_CHECK_CLOSE(h_charge.data[rtag], 2.0, tol_small);
+        BOOST_CHECK_CLOSE(h_diameter.data[rtag], 3.0, tol_small);
+        }
+
+    charge_connection.disconnect();
+    diameter_connection.disconnect();
+    }
+
+//! Test that the pair forces computed during an overlapped ghost update match the serial forces
+void test_communicator_overlap(communicator_creator comm_creator, shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // perturbed cubic lattice, identical on every rank
+    unsigned int n = 10;
+    unsigned int N = n*n*n;
+    Scalar L = Scalar(20.0);
+    Scalar a = L / Scalar(n);
+    shared_ptr<SystemDefinition> sysdef_2(new SystemDefinition(N, BoxDim(L), 1, 0, 0, 0, 0, exec_conf));
+    shared_ptr<ParticleData> pdata_2 = sysdef_2->getParticleData();
+
+    {
+    ArrayHandle<Scalar4> h_pos(pdata_2->getPositions(), access_location::host, access_mode::readwrite);
+    srand(12345);
+    for (unsigned int i = 0; i < N; i++)
+        {
+        h_pos.data[i].x = -L/Scalar(2.0) + a*(Scalar(i % n) + Scalar(0.25) + Scalar(0.5)*Scalar(rand())/Scalar(RAND_MAX));
+        h_pos.data[i].y = -L/Scalar(2.0) + a*(Scalar((i/n) % n) + Scalar(0.25) + Scalar(0.5)*Scalar(rand())/Scalar(RAND_MAX));
+        h_pos.data[i].z = -L/Scalar(2.0) + a*(Scalar(i/(n*n)) + Scalar(0.25) + Scalar(0.5)*Scalar(rand())/Scalar(RAND_MAX));
+        }
+    }
+
+    boost::shared_ptr<SnapshotSystemData> snap;
+    snap = sysdef_2->takeSnapshot(true, false, false, false, false, false, false, false);
+
+    boost::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, snap->global_box.getL(), 0));
+    shared_ptr<SystemDefinition> sysdef_1(new SystemDefinition(snap, exec_conf, decomposition));
+    shared_ptr<ParticleData> pdata_1 = sysdef_1->getParticleData();
+
+    shared_ptr<Communicator> comm = comm_creator(sysdef_1, decomposition);
+    comm->setOverlap(true);
+
+    shared_ptr<NeighborList> nlist_1(new NeighborListBinned(sysdef_1, Scalar(2.5), Scalar(0.4)));
+    shared_ptr<NeighborList> nlist_2(new NeighborListBinned(sysdef_2, Scalar(2.5), Scalar(0.4)));
+    nlist_1->setStorageMode(NeighborList::full);
+    nlist_2->setStorageMode(NeighborList::full);
+    nlist_1->setCommunicator(comm);
+
+    shared_ptr<PotentialPairLJ> fc_1(new PotentialPairLJ(sysdef_1, nlist_1));
+    shared_ptr<PotentialPairLJ> fc_2(new PotentialPairLJ(sysdef_2, nlist_2));
+    fc_1->setCommunicator(comm);
+    Scalar lj1 = Scalar(4.0);
+    Scalar lj2 = Scalar(4.0);
+    fc_1->setParams(0, 0, make_scalar2(lj1, lj2));
+    fc_2->setParams(0, 0, make_scalar2(lj1, lj2));
+    fc_1->setRcut(0, 0, Scalar(2.5));
+    fc_2->setRcut(0, 0, Scalar(2.5));
+
+    for (unsigned int timestep = 0; timestep < 3; timestep++)
+        {
+        comm->communicate(timestep);
+
+        // the first step exchanges the ghosts, after that the update is left in flight
+        BOOST_CHECK_EQUAL(comm->isGhostUpdatePending(), timestep > 0);
+
+        fc_1->compute(timestep);
+        fc_2->compute(timestep);
+
+        BOOST_CHECK(!comm->isGhostUpdatePending());
+        if (timestep > 0)
+            BOOST_CHECK(nlist_1->getNInterior() < pdata_1->getN());
+
+            {
+            ArrayHandle<Scalar4> h_force_1(fc_1->getForceArray(), access_location::host, access_mode::read);
+            ArrayHandle<Scalar4> h_force_2(fc_2->getForceArray(), access_location::host, access_mode::read);
+            ArrayHandle<unsigned int> h_tag_1(pdata_1->getTags(), access_location::host, access_mode::read);
+            ArrayHandle<unsigned int> h_rtag_2(pdata_2->getRTags(), access_location::host, access_mode::read);
+
+            for (unsigned int i = 0; i < pdata_1->getN(); i++)
+                {
+                unsigned int j = h_rtag_2.data[h_tag_1.data[i]];
+                BOOST_CHECK_SMALL(h_force_1.data[i].x - h_force_2.data[j].x, tol_small);
+                BOOST_CHECK_SMALL(h_force_1.data[i].y - h_force_2.data[j].y, tol_small);
+                BOOST_CHECK_SMALL(h_force_1.data[i].z - h_force_2.data[j].z, tol_small);
+                BOOST_CHECK_SMALL(h_force_1.data[i].w - h_force_2.data[j].w, tol_small);
+                }
+            }
+
+        // displace the particles by less than half the buffer, so that the ghost list stays valid
+        Scalar3 shift = make_scalar3(Scalar(0.05), Scalar(-0.03), Scalar(0.02));
+            {
+            ArrayHandle<Scalar4> h_pos(pdata_1->getPositions(), access_location::host, access_mode::readwrite);
+            ArrayHandle<int3> h_image(pdata_1->getImages(), access_location::host, access_mode::readwrite);
+            const BoxDim& global_box = pdata_1->getGlobalBox();
+            for (unsigned int i = 0; i < pdata_1->getN(); i++)
+                {
+                h_pos.data[i].x += shift.x;
+                h_pos.data[i].y += shift.y;
+                h_pos.data[i].z += shift.z;
+                global_box.wrap(h_pos.data[i], h_image.data[i]);
+                }
+            }
+            {
+            ArrayHandle<Scalar4> h_pos(pdata_2->getPositions(), access_location::host, access_mode::readwrite);
+            ArrayHandle<int3> h_image(pdata_2->getImages(), access_location::host, access_mode::readwrite);
+            const BoxDim& box = pdata_2->getBox();
+            for (unsigned int i = 0; i < N; i++)
+                {
+                h_pos.data[i].x += shift.x;
+                h_pos.data[i].y += shift.y;
+                h_pos.data[i].z += shift.z;
+                box.wrap(h_pos.data[i], h_image.data[i]);
+                }
+            }
+        }
+    }
+
 bool migrate_request(unsigned int timestep)
     {
     // every third step migrate particles etc. (we do not have a neighbor list in place,
@@ -2287,6 +2684,18 @@ BOOST_AUTO_TEST_CASE( DomainDecomposition_test )
     test_domain_decomposition(exec_conf_cpu);
     }
 
+//! Tests distributed initialization from a snapshot
+BOOST_AUTO_TEST_CASE( DomainDecomposition_distributed_test )
+    {
+    test_domain_decomposition_distributed(exec_conf_cpu);
+    }
+
+//! Tests restoring a snapshot taken from a decomposed system
+BOOST_AUTO_TEST_CASE( DomainDecomposition_snapshot_round_trip_test )
+    {
+    test_snapshot_round_trip(exec_conf_cpu);
+    }
+
 BOOST_AUTO_TEST_CASE( communicator_migrate_test )
     {
     communicator_creator communicator_creator_base = bind(base_class_communicator_creator, _1, _2);
@@ -2311,6 +2720,20 @@ BOOST_AUTO_TEST_CASE( communicator_bond_exchange_test )
     test_communicator_bond_exchange(communicator_creator_base, exec_conf_cpu);
     }
 
+//! Tests the pair forces with the ghost update overlapped
+BOOST_AUTO_TEST_CASE( communicator_overlap_test )
+    {
+    communicator_creator communicator_creator_base = bind(base_class_communicator_creator, _1, _2);
+    test_communicator_overlap(communicator_creator_base, exec_conf_cpu);
+    }
+
+//! Tests that the requested optional ghost fields are communicated
+BOOST_AUTO_TEST_CASE( communicator_ghost_fields_test )
+    {
+    communicator_creator communicator_creator_base = bind(base_class_communicator_creator, _1, _2);
+    test_communicator_ghost_fields(communicator_creator_base, exec_conf_cpu);
+    }
+
 #ifdef ENABLE_CUDA
 
 //! Tests particle distribution on GPU
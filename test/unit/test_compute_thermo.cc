@@ -0,0 +1,209 @@
+/*
+Highly Optimized Object-oriented Many-particle Dynamics -- Blue Edition
+(HOOMD-blue) Open Source Software License Copyright 2008-2011 Ames Laboratory
+Iowa State University and The Regents of the University of Michigan All rights
+reserved.
+
+HOOMD-blue may contain modifications ("Contributions") provided, and to which
+copyright is held, by various Contributors who have granted The Regents of the
+University of Michigan the right to modify and/or distribute such Contributions.
+
+You may redistribute, use, and create derivate works of HOOMD-blue, in source
+and binary forms, provided you abide by the following conditions:
+
+* Redistributions of source code must retain the above copyright notice, this
+list of conditions, and the following disclaimer both in the code and
+prominently in any materials provided with the distribution.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions, and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+* All publications and presentations based on HOOMD-blue, including any reports
+or published results obtained, in whole or in part, with HOOMD-blue, will
+acknowledge its use according to the terms posted at the time of submission on:
+http://codeblue.umich.edu/hoomd-blue/citations.html
+
+* Any electronic documents citing HOOMD-Blue will link to the HOOMD-Blue website:
+http://codeblue.umich.edu/hoomd-blue/
+
+* Apart from the above required attributions, neither the name of the copyright
+holder nor the names of HOOMD-blue's contributors may be used to endorse or
+promote products derived from this software without specific prior written
+permission.
+
+Disclaimer
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, AND/OR ANY
+WARRANTIES THAT THIS SOFTWARE IS FREE OF INFRINGEMENT ARE DISCLAIMED.
+
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Maintainer: joaander
+
+#ifdef WIN32
+#pragma warning( push )
+#pragma warning( disable : 4103 4244 )
+#endif
+
+#include <iostream>
+
+#include "ComputeThermo.h"
+
+#include <math.h>
+
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace boost;
+
+//! Name the unit test module
+#define BOOST_TEST_MODULE ComputeThermoTests
+#include "boost_utf_configure.h"
+
+/*! \file test_compute_thermo.cc
+    \brief Implements unit tests for ComputeThermo
+    \ingroup unit_tests
+*/
+
+//! Compares the properties of ComputeThermo to a serial double precision sum
+/*! \param exec_conf Execution configuration
+    \param n_threads Number of OpenMP threads to compute the properties with
+    \param pressure_tensor True if the pressure tensor is requested in the particle data flags
+
+    The velocities, masses, potential energies and virials span several orders of magnitude, so that a plain sum in
+    the order of the threads would lose digits.
+*/
+void compute_thermo_reference_test(boost::shared_ptr<ExecutionConfiguration> exec_conf,
+                                   int n_threads,
+                                   bool pressure_tensor)
+    {
+    const unsigned int N = 10000;
+    Scalar L = Scalar(30.0);
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(N, BoxDim(L), 1, 0, 0, 0, 0, exec_conf));
+    shared_ptr<ParticleData> pdata = sysdef->getParticleData();
+
+    PDataFlags flags;
+    flags[pdata_flag::potential_energy] = 1;
+    flags[pdata_flag::isotropic_virial] = 1;
+    flags[pdata_flag::pressure_tensor] = pressure_tensor;
+    pdata->setFlags(flags);
+
+    // fill in the velocities, the net force and the net virial, and sum them up in double precision
+    double mv2 = 0.0;
+    double pe = 0.0;
+    double kinetic[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    double virial[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+        {
+        ArrayHandle<Scalar4> h_vel(pdata->getVelocities(), access_location::host, access_mode::readwrite);
+        ArrayHandle<Scalar4> h_net_force(pdata->getNetForce(), access_location::host, access_mode::readwrite);
+        ArrayHandle<Scalar> h_net_virial(pdata->getNetVirial(), access_location::host, access_mode::readwrite);
+        unsigned int virial_pitch = pdata->getNetVirial().getPitch();
+
+        for (unsigned int j = 0; j < N; j++)
+            {
+            Scalar scale = pow(Scalar(10.0), Scalar(j % 5) - Scalar(2.0));
+            h_vel.data[j] = make_scalar4(scale*sin(Scalar(j)), scale*cos(Scalar(3*j)), scale*sin(Scalar(7*j+1)),
+                                         Scalar(1.0) + Scalar(j % 3));
+            h_net_force.data[j] = make_scalar4(0.0, 0.0, 0.0, scale*cos(Scalar(5*j)));
+            for (unsigned int k = 0; k < 6; k++)
+                h_net_virial.data[k*virial_pitch+j] = scale*sin(Scalar(11*j+k));
+
+            double m = h_vel.data[j].w;
+            double v[3] = { h_vel.data[j].x, h_vel.data[j].y, h_vel.data[j].z };
+            mv2 += m*(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+            pe += h_net_force.data[j].w;
+
+            // xx, xy, xz, yy, yz, zz
+            kinetic[0] += m*v[0]*v[0];
+            kinetic[1] += m*v[0]*v[1];
+            kinetic[2] += m*v[0]*v[2];
+            kinetic[3] += m*v[1]*v[1];
+            kinetic[4] += m*v[1]*v[2];
+            kinetic[5] += m*v[2]*v[2];
+            for (unsigned int k = 0; k < 6; k++)
+                virial[k] += h_net_virial.data[k*virial_pitch+j];
+            }
+        }
+
+    // the external virial is added on top of the particle virials
+    for (unsigned int k = 0; k < 6; k++)
+        {
+        pdata->setExternalVirial(k, Scalar(0.5) + Scalar(k));
+        virial[k] += Scalar(0.5) + Scalar(k);
+        }
+
+    unsigned int ndof = 3*N-3;
+    double volume = double(L)*double(L)*double(L);
+    double ke = 0.5*mv2;
+    double W = (virial[0] + virial[3] + virial[5])/3.0;
+
+#ifdef ENABLE_OPENMP
+    int max_threads = omp_get_max_threads();
+    omp_set_num_threads(n_threads);
+#endif
+
+    shared_ptr<ParticleSelector> selector_all(new ParticleSelectorTag(sysdef, 0, N-1));
+    shared_ptr<ParticleGroup> group_all(new ParticleGroup(sysdef, selector_all));
+    shared_ptr<ComputeThermo> thermo(new ComputeThermo(sysdef, group_all));
+    thermo->setNDOF(ndof);
+    thermo->compute(0);
+
+#ifdef ENABLE_OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+
+    MY_BOOST_CHECK_CLOSE(thermo->getKineticEnergy(), ke, tol_small);
+    MY_BOOST_CHECK_CLOSE(thermo->getTemperature(), 2.0*ke/double(ndof), tol_small);
+    MY_BOOST_CHECK_CLOSE(thermo->getPotentialEnergy(), pe, tol_small);
+    MY_BOOST_CHECK_CLOSE(thermo->getPressure(), (2.0*ke/3.0 + W)/volume, tol_small);
+
+    PressureTensor P = thermo->getPressureTensor();
+    if (pressure_tensor)
+        {
+        MY_BOOST_CHECK_CLOSE(P.xx, (kinetic[0] + virial[0])/volume, tol_small);
+        MY_BOOST_CHECK_CLOSE(P.xy, (kinetic[1] + virial[1])/volume, tol_small);
+        MY_BOOST_CHECK_CLOSE(P.xz, (kinetic[2] + virial[2])/volume, tol_small);
+        MY_BOOST_CHECK_CLOSE(P.yy, (kinetic[3] + virial[3])/volume, tol_small);
+        MY_BOOST_CHECK_CLOSE(P.yz, (kinetic[4] + virial[4])/volume, tol_small);
+        MY_BOOST_CHECK_CLOSE(P.zz, (kinetic[5] + virial[5])/volume, tol_small);
+        }
+    else
+        {
+        // the pressure tensor is not available without the flag
+        BOOST_CHECK(isnan(P.xx));
+        BOOST_CHECK(isnan(P.xy));
+        BOOST_CHECK(isnan(P.zz));
+        }
+    }
+
+//! boost test case for ComputeThermo on a single thread
+BOOST_AUTO_TEST_CASE( ComputeThermo_reference )
+    {
+    boost::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    compute_thermo_reference_test(exec_conf, 1, false);
+    compute_thermo_reference_test(exec_conf, 1, true);
+    }
+
+//! boost test case for ComputeThermo with several threads
+BOOST_AUTO_TEST_CASE( ComputeThermo_reference_threaded )
+    {
+    boost::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    compute_thermo_reference_test(exec_conf, 4, false);
+    compute_thermo_reference_test(exec_conf, 4, true);
+    }
+
+#ifdef WIN32
+#pragma warning( pop )
+#endif
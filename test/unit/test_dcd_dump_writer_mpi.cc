@@ -0,0 +1,137 @@
+//! name the boost unit test module
+#define BOOST_TEST_MODULE DCDDumpWriterTestsMPI
+#include "MPITestSetup.h"
+
+#include "HOOMDMath.h"
+#include "ExecutionConfiguration.h"
+#include "SystemDefinition.h"
+#include "SnapshotSystemData.h"
+#include "DCDDumpWriter.h"
+
+#include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HOOMDMPI.h"
+#include "Communicator.h"
+#include "DomainDecomposition.h"
+
+using namespace boost;
+using namespace std;
+
+//! Reads a whole file into memory
+static vector<char> read_file(const string& fname)
+    {
+    ifstream f(fname.c_str(), ios::in | ios::binary);
+    return vector<char>((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+    }
+
+//! Moves every even tag along x, the same way on the serial and the distributed system
+static void move_particles(boost::shared_ptr<ParticleData> pdata)
+    {
+    ArrayHandle<Scalar4> h_pos(pdata->getPositions(), access_location::host, access_mode::readwrite);
+    ArrayHandle<unsigned int> h_tag(pdata->getTags(), access_location::host, access_mode::read);
+    for (unsigned int i = 0; i < pdata->getN(); i++)
+        if (h_tag.data[i] % 2 == 0)
+            h_pos.data[i].x += Scalar(0.1);
+    }
+
+//! Compares a DCD file written collectively with MPI-IO against a file written by a single rank
+void test_dcd_dump_writer_mpi(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // random system with non-zero image flags, identical on every rank
+    unsigned int N = 1000;
+    Scalar L = Scalar(20.0);
+    shared_ptr<SystemDefinition> sysdef_2(new SystemDefinition(N, BoxDim(L), 1, 0, 0, 0, 0, exec_conf));
+    shared_ptr<ParticleData> pdata_2 = sysdef_2->getParticleData();
+
+    {
+    ArrayHandle<Scalar4> h_pos(pdata_2->getPositions(), access_location::host, access_mode::readwrite);
+    ArrayHandle<int3> h_image(pdata_2->getImages(), access_location::host, access_mode::readwrite);
+    srand(12345);
+    for (unsigned int i = 0; i < N; i++)
+        {
+        h_pos.data[i].x = Scalar(18.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_pos.data[i].y = Scalar(18.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_pos.data[i].z = Scalar(18.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_image.data[i] = make_int3(int(i % 3) - 1, int(i % 5) - 2, 0);
+        }
+    }
+
+    boost::shared_ptr<SnapshotSystemData> snap;
+    snap = sysdef_2->takeSnapshot(true, false, false, false, false, false, false, false);
+
+    boost::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, snap->global_box.getL(), 0));
+    shared_ptr<SystemDefinition> sysdef_1(new SystemDefinition(snap, exec_conf, decomposition));
+    shared_ptr<ParticleData> pdata_1 = sysdef_1->getParticleData();
+
+    boost::shared_ptr<Communicator> comm(new Communicator(sysdef_1, decomposition));
+
+    // write a subset of the particles to check the group offsets
+    shared_ptr<ParticleSelector> selector_1(new ParticleSelectorTag(sysdef_1, 100, 899));
+    shared_ptr<ParticleGroup> group_1(new ParticleGroup(sysdef_1, selector_1));
+    shared_ptr<ParticleSelector> selector_2(new ParticleSelectorTag(sysdef_2, 100, 899));
+    shared_ptr<ParticleGroup> group_2(new ParticleGroup(sysdef_2, selector_2));
+
+    bool root = exec_conf->isRoot();
+    string fname_1("test_dcd_mpi.dcd");
+    string fname_2("test_dcd_serial.dcd");
+
+    shared_ptr<DCDDumpWriter> writer_1(new DCDDumpWriter(sysdef_1, fname_1, 10, group_1, true));
+    writer_1->setCommunicator(comm);
+    writer_1->setUnwrapFull(true);
+    shared_ptr<DCDDumpWriter> writer_2(new DCDDumpWriter(sysdef_2, fname_2, 10, group_2, true));
+    writer_2->setUnwrapFull(true);
+
+    for (unsigned int timestep = 0; timestep <= 20; timestep += 10)
+        {
+        writer_1->analyze(timestep);
+        if (root)
+            writer_2->analyze(timestep);
+
+        move_particles(pdata_1);
+        move_particles(pdata_2);
+        }
+
+    // append a frame to the existing files
+    writer_1 = shared_ptr<DCDDumpWriter>(new DCDDumpWriter(sysdef_1, fname_1, 10, group_1, false));
+    writer_1->setCommunicator(comm);
+    writer_1->setUnwrapFull(true);
+    writer_2 = shared_ptr<DCDDumpWriter>(new DCDDumpWriter(sysdef_2, fname_2, 10, group_2, false));
+    writer_2->setUnwrapFull(true);
+
+    writer_1->analyze(30);
+    if (root)
+        writer_2->analyze(30);
+
+    MPI_Barrier(exec_conf->getMPICommunicator());
+
+    if (root)
+        {
+        vector<char> file_1 = read_file(fname_1);
+        vector<char> file_2 = read_file(fname_2);
+        BOOST_REQUIRE_EQUAL(file_1.size(), file_2.size());
+
+        // the time stamp in the header (bytes 180 to 259) may differ
+        for (unsigned int i = 0; i < file_1.size(); i++)
+            {
+            if (i >= 180 && i < 260)
+                continue;
+            BOOST_REQUIRE_EQUAL(int(file_1[i]), int(file_2[i]));
+            }
+
+        remove(fname_1.c_str());
+        remove(fname_2.c_str());
+        }
+    }
+
+//! Tests the collective DCD output against output written by a single rank
+BOOST_AUTO_TEST_CASE( DCDDumpWriter_mpi )
+    {
+    test_dcd_dump_writer_mpi(exec_conf_cpu);
+    }
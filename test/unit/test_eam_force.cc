@@ -0,0 +1,243 @@
+/*
+Highly Optimized Object-oriented Many-particle Dynamics -- Blue Edition
+(HOOMD-blue) Open Source Software License Copyright 2008-2011 Ames Laboratory
+Iowa State University and The Regents of the University of Michigan All rights
+reserved.
+
+HOOMD-blue may contain modifications ("Contributions") provided, and to which
+copyright is held, by various Contributors who have granted The Regents of the
+University of Michigan the right to modify and/or distribute such Contributions.
+
+You may redistribute, use, and create derivate works of HOOMD-blue, in source
+and binary forms, provided you abide by the following conditions:
+
+* Redistributions of source code must retain the above copyright notice, this
+list of conditions, and the following disclaimer both in the code and
+prominently in any materials provided with the distribution.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions, and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+* All publications and presentations based on HOOMD-blue, including any reports
+or published results obtained, in whole or in part, with HOOMD-blue, will
+acknowledge its use according to the terms posted at the time of submission on:
+http://codeblue.umich.edu/hoomd-blue/citations.html
+
+* Any electronic documents citing HOOMD-Blue will link to the HOOMD-Blue website:
+http://codeblue.umich.edu/hoomd-blue/
+
+* Apart from the above required attributions, neither the name of the copyright
+holder nor the names of HOOMD-blue's contributors may be used to endorse or
+promote products derived from this software without specific prior written
+permission.
+
+Disclaimer
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, AND/OR ANY
+WARRANTIES THAT THIS SOFTWARE IS FREE OF INFRINGEMENT ARE DISCLAIMED.
+
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Maintainer: joaander
+
+#ifdef WIN32
+#pragma warning( push )
+#pragma warning( disable : 4103 4244 )
+#endif
+
+#include <fstream>
+#include <algorithm>
+
+#include "EAMForceCompute.h"
+#include "NeighborList.h"
+#include "Initializers.h"
+
+#include <math.h>
+
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace boost;
+
+//! Name the unit test module
+#define BOOST_TEST_MODULE EAMForceTests
+#include "boost_utf_configure.h"
+
+/*! \file test_eam_force.cc
+    \brief Implements unit tests for EAMForceCompute
+    \ingroup unit_tests
+*/
+
+//! Name of the potential file written by the tests
+const char *eam_test_file = "test_eam_force.setfl";
+
+//! Writes a smooth single type EAM/alloy potential file
+void write_eam_file()
+    {
+    unsigned int nrho = 2000;
+    double drho = 0.05;
+    unsigned int nr = 1000;
+    double dr = 0.005;
+
+    ofstream f(eam_test_file);
+    f.precision(12);
+    f << "test potential" << endl << "F = -sqrt(rho), rho = exp(-2(r-1)), phi = exp(-3(r-1))" << endl << "" << endl;
+    f << "1 A" << endl;
+    f << nrho << " " << drho << " " << nr << " " << dr << " " << 3.0 << endl;
+    f << "1 1.0 1.0 fcc" << endl;
+    for (unsigned int i = 0; i < nrho; i++)
+        f << -sqrt(i*drho) << endl;
+    for (unsigned int i = 0; i < nr; i++)
+        f << exp(-2.0*(i*dr - 1.0)) << endl;
+    // the file holds r*phi(r)
+    for (unsigned int i = 0; i < nr; i++)
+        f << i*dr*exp(-3.0*(i*dr - 1.0)) << endl;
+    }
+
+//! Computes the EAM forces of the system in \a snap with the given neighbor list storage mode and number of threads
+void compute_eam_forces(boost::shared_ptr<SnapshotSystemData> snap,
+                        boost::shared_ptr<ExecutionConfiguration> exec_conf,
+                        NeighborList::storageMode mode,
+                        int n_threads,
+                        vector<Scalar4>& force,
+                        vector<Scalar>& virial)
+    {
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(snap, exec_conf));
+    shared_ptr<ParticleData> pdata = sysdef->getParticleData();
+
+#ifdef ENABLE_OPENMP
+    // the per thread partial arrays are sized when the compute is constructed
+    int max_threads = omp_get_max_threads();
+    unsigned int n_cpu = exec_conf->n_cpu;
+    exec_conf->n_cpu = std::max(n_cpu, (unsigned int)n_threads);
+    omp_set_num_threads(n_threads);
+#endif
+
+    char filename[64];
+    strcpy(filename, eam_test_file);
+    shared_ptr<EAMForceCompute> fc(new EAMForceCompute(sysdef, filename, 0));
+    shared_ptr<NeighborList> nlist(new NeighborList(sysdef, fc->get_r_cut(), Scalar(0.4)));
+    nlist->setStorageMode(mode);
+    fc->set_neighbor_list(nlist);
+    fc->compute(0);
+
+#ifdef ENABLE_OPENMP
+    omp_set_num_threads(max_threads);
+    exec_conf->n_cpu = n_cpu;
+#endif
+
+    unsigned int N = pdata->getN();
+    force.resize(N);
+    virial.resize(6*N);
+
+    ArrayHandle<Scalar4> h_force(fc->getForceArray(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar> h_virial(fc->getVirialArray(), access_location::host, access_mode::read);
+    unsigned int pitch = fc->getVirialArray().getPitch();
+    for (unsigned int i = 0; i < N; i++)
+        {
+        force[i] = h_force.data[i];
+        for (unsigned int k = 0; k < 6; k++)
+            virial[6*i+k] = h_virial.data[k*pitch+i];
+        }
+    }
+
+//! Checks that two sets of forces (and optionally energies) agree to within a small fraction of the largest value
+void check_forces_close(const vector<Scalar4>& force_1, const vector<Scalar4>& force_2, bool check_energy)
+    {
+    BOOST_REQUIRE_EQUAL_UINT(force_1.size(), force_2.size());
+
+    Scalar max_force = Scalar(0.0);
+    Scalar max_force_diff = Scalar(0.0);
+    Scalar max_energy = Scalar(0.0);
+    Scalar max_energy_diff = Scalar(0.0);
+    for (unsigned int i = 0; i < force_1.size(); i++)
+        {
+        max_force = std::max(max_force, Scalar(fabs(force_1[i].x)));
+        max_force_diff = std::max(max_force_diff, Scalar(fabs(force_1[i].x - force_2[i].x)));
+        max_force_diff = std::max(max_force_diff, Scalar(fabs(force_1[i].y - force_2[i].y)));
+        max_force_diff = std::max(max_force_diff, Scalar(fabs(force_1[i].z - force_2[i].z)));
+        max_energy = std::max(max_energy, Scalar(fabs(force_1[i].w)));
+        max_energy_diff = std::max(max_energy_diff, Scalar(fabs(force_1[i].w - force_2[i].w)));
+        }
+    BOOST_CHECK(max_force > Scalar(0.0));
+    BOOST_CHECK_SMALL(max_force_diff, max_force * Scalar(1e-4));
+    if (check_energy)
+        BOOST_CHECK_SMALL(max_energy_diff, max_energy * Scalar(1e-4));
+    }
+
+//! Checks that two sets of virials agree to within a small fraction of the largest value
+void check_virials_close(const vector<Scalar>& virial_1, const vector<Scalar>& virial_2)
+    {
+    BOOST_REQUIRE_EQUAL_UINT(virial_1.size(), virial_2.size());
+
+    Scalar max_virial = Scalar(0.0);
+    Scalar max_virial_diff = Scalar(0.0);
+    for (unsigned int i = 0; i < virial_1.size(); i++)
+        {
+        max_virial = std::max(max_virial, Scalar(fabs(virial_1[i])));
+        max_virial_diff = std::max(max_virial_diff, Scalar(fabs(virial_1[i] - virial_2[i])));
+        }
+    BOOST_CHECK_SMALL(max_virial_diff, max_virial * Scalar(1e-4));
+    }
+
+//! Verifies that the threaded CPU EAM compute gives the same forces as a single thread
+void eam_force_threaded_test(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    write_eam_file();
+
+    unsigned int N = 4000;
+    RandomInitializer rand_init(N, Scalar(0.2), Scalar(0.9), "A");
+    rand_init.setSeed(12345);
+    boost::shared_ptr<SnapshotSystemData> snap = rand_init.getSnapshot();
+
+    int n_threads = 4;
+    vector<Scalar4> force_full_1, force_full_n, force_half_1, force_half_n;
+    vector<Scalar> virial_full_1, virial_full_n, virial_half_1, virial_half_n;
+    compute_eam_forces(snap, exec_conf, NeighborList::full, 1, force_full_1, virial_full_1);
+    compute_eam_forces(snap, exec_conf, NeighborList::full, n_threads, force_full_n, virial_full_n);
+    compute_eam_forces(snap, exec_conf, NeighborList::half, 1, force_half_1, virial_half_1);
+    compute_eam_forces(snap, exec_conf, NeighborList::half, n_threads, force_half_n, virial_half_n);
+
+    // with a full neighbor list every particle is computed by a single thread in the same order
+    BOOST_REQUIRE_EQUAL_UINT(force_full_1.size(), force_full_n.size());
+    for (unsigned int i = 0; i < force_full_1.size(); i++)
+        {
+        BOOST_CHECK_EQUAL(force_full_1[i].x, force_full_n[i].x);
+        BOOST_CHECK_EQUAL(force_full_1[i].y, force_full_n[i].y);
+        BOOST_CHECK_EQUAL(force_full_1[i].z, force_full_n[i].z);
+        BOOST_CHECK_EQUAL(force_full_1[i].w, force_full_n[i].w);
+        }
+    for (unsigned int i = 0; i < virial_full_1.size(); i++)
+        BOOST_CHECK_EQUAL(virial_full_1[i], virial_full_n[i]);
+
+    // with a half neighbor list the per thread partial sums are added in a different order
+    check_forces_close(force_half_1, force_half_n, true);
+    check_virials_close(virial_half_1, virial_half_n);
+
+    // the per particle energy and virial of a pair are split differently with a full list, only the forces match
+    check_forces_close(force_full_1, force_half_n, false);
+
+    remove(eam_test_file);
+    }
+
+//! boost test case for comparing the threaded CPU EAM compute with a single thread
+BOOST_AUTO_TEST_CASE( EAMForceCompute_threaded )
+    {
+    eam_force_threaded_test(boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
+
+#ifdef WIN32
+#pragma warning( pop )
+#endif
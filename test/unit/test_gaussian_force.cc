@@ -451,6 +451,15 @@ shared_ptr<PotentialPairGauss> base_class_gauss_creator(shared_ptr<SystemDefinit
     return shared_ptr<PotentialPairGauss>(new PotentialPairGauss(sysdef, nlist));
     }
 
+//! PotentialPairGauss creator for unit tests that always uses the per neighbor loop
+shared_ptr<PotentialPairGauss> scalar_gauss_creator(shared_ptr<SystemDefinition> sysdef,
+                                                    shared_ptr<NeighborList> nlist)
+    {
+    shared_ptr<PotentialPairGauss> gauss(new PotentialPairGauss(sysdef, nlist));
+    gauss->setVectorized(false);
+    return gauss;
+    }
+
 #ifdef ENABLE_CUDA
 //! PotentialPairGaussGPU creator for unit tests
 shared_ptr<PotentialPairGaussGPU> gpu_gauss_creator(shared_ptr<SystemDefinition> sysdef,
@@ -485,6 +494,14 @@ BOOST_AUTO_TEST_CASE( GaussForce_shift )
     gauss_force_shift_test(gauss_creator_base, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
     }
 
+//! boost test case for comparing the vectorized path to the per neighbor loop on CPU
+BOOST_AUTO_TEST_CASE( GaussForce_vectorized )
+    {
+    gaussforce_creator gauss_creator_scalar = bind(scalar_gauss_creator, _1, _2);
+    gaussforce_creator gauss_creator_base = bind(base_class_gauss_creator, _1, _2);
+    gauss_force_comparison_test(gauss_creator_scalar, gauss_creator_base, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
+
 # ifdef ENABLE_CUDA
 //! boost test case for particle test on GPU
 BOOST_AUTO_TEST_CASE( GaussForceGPU_particle )
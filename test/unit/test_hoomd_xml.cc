@@ -62,6 +62,10 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/convenience.hpp>
 using namespace boost::filesystem;
@@ -71,6 +75,10 @@ using namespace boost;
 #include <fstream>
 using namespace std;
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
 //! Name the unit test module
 #define BOOST_TEST_MODULE XMLReaderWriterTest
 #include "boost_utf_configure.h"
@@ -1395,6 +1403,254 @@ im_b 5 4 3 2\n\
     remove_all("test_input.xml");
     }
 
+//! Checks that XMLStreamReader returns the same tokens no matter how small its buffer is
+BOOST_AUTO_TEST_CASE( XMLStreamReader_buffer_tests )
+    {
+    ofstream f("test_stream.xml");
+    f << "<?xml version=\"1.0\"?>\n<!-- a comment with <tags> in it -->\n<hoomd_xml version=\"1.5\">\n";
+    f << "<configuration time_step=\"10\">\n<box lx=\"1\" ly=\"2\" lz=\"3\"/>\n<position num=\"100\">\n";
+    for (unsigned int i = 0; i < 100; i++)
+        f << i << ".25 " << -int(i) << " 1e-" << i % 10 << "\n";
+    f << "</position>\n<unknown><child a='x &amp; y'/></unknown>\n</configuration>\n</hoomd_xml>\n";
+    f.close();
+
+    boost::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+
+    for (unsigned int buffer_size = 16; buffer_size < 64; buffer_size += 7)
+        {
+        XMLStreamReader reader(exec_conf, "test_stream.xml", buffer_size);
+        BOOST_REQUIRE(reader.next() == XMLStreamReader::start_element);
+        BOOST_CHECK_EQUAL(reader.getName(), string("hoomd_xml"));
+        BOOST_CHECK_EQUAL(reader.getAttribute("version"), string("1.5"));
+        BOOST_REQUIRE(reader.next() == XMLStreamReader::start_element);
+        BOOST_CHECK_EQUAL(reader.getAttribute("time_step"), string("10"));
+
+        // the box is an empty element
+        BOOST_REQUIRE(reader.next() == XMLStreamReader::start_element);
+        BOOST_CHECK_EQUAL(reader.getName(), string("box"));
+        BOOST_CHECK_EQUAL(reader.getAttribute("lz"), string("3"));
+        BOOST_REQUIRE(reader.next() == XMLStreamReader::end_element);
+
+        // blocks of text never split a token
+        BOOST_REQUIRE(reader.next() == XMLStreamReader::start_element);
+        BOOST_CHECK_EQUAL(reader.getName(), string("position"));
+        vector<string> tokens;
+        const char *begin, *end;
+        while (reader.readText(begin, end))
+            {
+            istringstream block(string(begin, end));
+            string token;
+            while (block >> token)
+                tokens.push_back(token);
+            }
+        BOOST_REQUIRE_EQUAL(tokens.size(), (unsigned int)300);
+        for (unsigned int i = 0; i < 100; i++)
+            {
+            ostringstream x, y, z;
+            x << i << ".25";
+            y << -int(i);
+            z << "1e-" << i % 10;
+            BOOST_CHECK_EQUAL(tokens[3*i], x.str());
+            BOOST_CHECK_EQUAL(tokens[3*i+1], y.str());
+            BOOST_CHECK_EQUAL(tokens[3*i+2], z.str());
+            }
+
+        // unknown elements can be skipped with all of their children
+        BOOST_REQUIRE(reader.next() == XMLStreamReader::start_element);
+        BOOST_CHECK_EQUAL(reader.getName(), string("unknown"));
+        reader.skipElement();
+        BOOST_REQUIRE(reader.next() == XMLStreamReader::end_element);
+        BOOST_CHECK_EQUAL(reader.getName(), string("configuration"));
+        BOOST_REQUIRE(reader.next() == XMLStreamReader::end_element);
+        BOOST_CHECK(reader.next() == XMLStreamReader::end_of_file);
+        }
+
+    remove_all("test_stream.xml");
+    }
+
+//! Checks that values that are not numbers are reported
+BOOST_AUTO_TEST_CASE( HOOMDInitializer_invalid_value_tests )
+    {
+    ofstream f("test_invalid.xml");
+    f << "<hoomd_xml>\n<configuration>\n<box lx=\"1\" ly=\"2\" lz=\"3\"/>\n";
+    f << "<position>\n0 0 0\n1 x 1\n</position>\n<type>\nA\nA\n</type>\n</configuration>\n</hoomd_xml>\n";
+    f.close();
+
+    boost::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    BOOST_CHECK_THROW(HOOMDInitializer(exec_conf, "test_invalid.xml"), runtime_error);
+
+    remove_all("test_invalid.xml");
+    }
+
+//! Checks that XMLStreamReader::parseNumber() gives bit for bit the same results as strtod and strtof
+BOOST_AUTO_TEST_CASE( XMLStreamReader_parse_number_tests )
+    {
+    // numbers around the limits of the fast path, and numbers that have to take the slow path
+    const char *tokens[] = { "0", "-0", "+1", "0.1", "-2.5", ".5", "5.", "1e5", "1E-5", "1.5e+3",
+                             "1234567890123456789", "9999999999999999999", "12345678901234567890",
+                             "-98765432109876543210", "1234567890.123456789", "1234567890.1234567891",
+                             "9007199254740991", "9007199254740992", "9007199254740993", "9007199254740995",
+                             "-9007199254740993", "9007199254740993e-5", "16777215", "16777216", "16777217",
+                             "16777219", "1e22", "1e23", "1e-22", "1e-23", "3e22", "3e-22", "7e23", "7e-23",
+                             "1e10", "1e11", "1e-10", "1e-11", "123e-22", "123e-23", "0.0000000000000000000001",
+                             "0.00000000000000000000001", "0.000000000000000000000012345", "000123.4500",
+                             "0.000000000000000000000000000001e8", "1e308", "1e309", "2.2250738585072014e-308",
+                             "4.9e-324", "7.038531e-26", "3.4028235e38", "1.17549435e-38", "0.30000000000000004",
+                             "8.589973e9", "inf", "-inf", "nan" };
+    for (unsigned int i = 0; i < sizeof(tokens)/sizeof(tokens[0]); i++)
+        {
+        const char *begin = tokens[i];
+        const char *end = tokens[i] + strlen(tokens[i]);
+
+        double d = 1.0;
+        double d_ref = strtod(tokens[i], NULL);
+        BOOST_CHECK(XMLStreamReader::parseNumber(begin, end, d));
+        BOOST_CHECK_MESSAGE(memcmp(&d, &d_ref, sizeof(double)) == 0, "double mismatch for " << tokens[i]);
+
+        float f = 1.0f;
+        float f_ref = strtof(tokens[i], NULL);
+        BOOST_CHECK(XMLStreamReader::parseNumber(begin, end, f));
+        BOOST_CHECK_MESSAGE(memcmp(&f, &f_ref, sizeof(float)) == 0, "float mismatch for " << tokens[i]);
+        }
+
+    // random numbers of up to 20 digits, with and without a decimal point and an exponent
+    srand(12345);
+    for (unsigned int i = 0; i < 100000; i++)
+        {
+        string token;
+        if (rand() % 2)
+            token += '-';
+        unsigned int n_digits = 1 + rand() % 20;
+        unsigned int point = rand() % (n_digits + 1);
+        for (unsigned int j = 0; j < n_digits; j++)
+            {
+            if (j == point && j > 0)
+                token += '.';
+            token += char('0' + rand() % 10);
+            }
+        if (rand() % 2)
+            {
+            ostringstream exponent;
+            exponent << "e" << rand() % 61 - 30;
+            token += exponent.str();
+            }
+
+        double d, d_ref = strtod(token.c_str(), NULL);
+        float f, f_ref = strtof(token.c_str(), NULL);
+        BOOST_REQUIRE(XMLStreamReader::parseNumber(token.data(), token.data() + token.size(), d));
+        BOOST_REQUIRE(XMLStreamReader::parseNumber(token.data(), token.data() + token.size(), f));
+        BOOST_REQUIRE_MESSAGE(memcmp(&d, &d_ref, sizeof(double)) == 0, "double mismatch for " << token);
+        BOOST_REQUIRE_MESSAGE(memcmp(&f, &f_ref, sizeof(float)) == 0, "float mismatch for " << token);
+        }
+
+    // tokens that are not numbers
+    const char *invalid[] = { "", "-", ".", "e5", "1e", "1e+", "1.2.3", "1x", "--1", "0x" };
+    for (unsigned int i = 0; i < sizeof(invalid)/sizeof(invalid[0]); i++)
+        {
+        double d;
+        float f;
+        BOOST_CHECK(!XMLStreamReader::parseNumber(invalid[i], invalid[i] + strlen(invalid[i]), d));
+        BOOST_CHECK(!XMLStreamReader::parseNumber(invalid[i], invalid[i] + strlen(invalid[i]), f));
+        }
+
+    // integers
+    int n;
+    unsigned int u;
+    string token = "-2147483648";
+    BOOST_CHECK(XMLStreamReader::parseNumber(token.data(), token.data() + token.size(), n));
+    BOOST_CHECK_EQUAL(n, INT_MIN);
+    token = "2147483648";
+    BOOST_CHECK(!XMLStreamReader::parseNumber(token.data(), token.data() + token.size(), n));
+    BOOST_CHECK(XMLStreamReader::parseNumber(token.data(), token.data() + token.size(), u));
+    BOOST_CHECK_EQUAL(u, 2147483648u);
+    token = "4294967296";
+    BOOST_CHECK(!XMLStreamReader::parseNumber(token.data(), token.data() + token.size(), u));
+    token = "-1";
+    BOOST_CHECK(!XMLStreamReader::parseNumber(token.data(), token.data() + token.size(), u));
+    }
+
+//! Checks that a position node of several MB, which is split between threads, is read like strtod would read it
+BOOST_AUTO_TEST_CASE( HOOMDInitializer_large_block_tests )
+    {
+    // values with many digits, so that the node is much larger than the 1 MB at which the parse is split
+    const unsigned int N = 50000;
+    vector<string> tokens(3*N);
+    srand(54321);
+    for (unsigned int i = 0; i < 3*N; i++)
+        {
+        ostringstream token;
+        token << (rand() % 2 ? "-" : "") << rand() % 1000 << "." << rand() << rand() % 1000;
+        if (i % 7 == 0)
+            token << "e-" << rand() % 30;
+        tokens[i] = token.str();
+        }
+
+    // the num attributes are bogus, they must not make the reader allocate a huge amount of memory
+    ofstream f("test_large.xml");
+    f << "<hoomd_xml version=\"1.5\">\n<configuration time_step=\"0\">\n<box lx=\"10\" ly=\"10\" lz=\"10\"/>\n";
+    f << "<position num=\"4000000000\">\n";
+    for (unsigned int i = 0; i < N; i++)
+        f << tokens[3*i] << " " << tokens[3*i+1] << " " << tokens[3*i+2] << "\n";
+    f << "</position>\n<type num=\"-5\">\n";
+    for (unsigned int i = 0; i < N; i++)
+        f << "A\n";
+    f << "</type>\n</configuration>\n</hoomd_xml>\n";
+    f.close();
+
+    boost::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+
+    // make sure that the threaded path is taken
+    #ifdef ENABLE_OPENMP
+    int n_threads = omp_get_max_threads();
+    omp_set_num_threads(std::max(n_threads, 4));
+    #endif
+
+    HOOMDInitializer init(exec_conf, "test_large.xml");
+
+    #ifdef ENABLE_OPENMP
+    omp_set_num_threads(n_threads);
+    #endif
+
+    const vector<HOOMDInitializer::vec>& pos = init.getPos();
+    BOOST_REQUIRE_EQUAL(pos.size(), N);
+    unsigned int n_mismatch = 0;
+    for (unsigned int i = 0; i < N; i++)
+        {
+        Scalar ref[3];
+        for (unsigned int j = 0; j < 3; j++)
+            {
+            #ifdef SINGLE_PRECISION
+            ref[j] = strtof(tokens[3*i+j].c_str(), NULL);
+            #else
+            ref[j] = strtod(tokens[3*i+j].c_str(), NULL);
+            #endif
+            }
+        if (memcmp(&pos[i].x, &ref[0], sizeof(Scalar)) || memcmp(&pos[i].y, &ref[1], sizeof(Scalar))
+            || memcmp(&pos[i].z, &ref[2], sizeof(Scalar)))
+            n_mismatch++;
+        }
+    BOOST_CHECK_EQUAL(n_mismatch, (unsigned int)0);
+
+    // an invalid value late in a large block is found by whichever thread parses it
+    f.open("test_large.xml");
+    f << "<hoomd_xml version=\"1.5\">\n<configuration time_step=\"0\">\n<box lx=\"10\" ly=\"10\" lz=\"10\"/>\n";
+    f << "<position>\n";
+    for (unsigned int i = 0; i < N; i++)
+        f << tokens[3*i] << " " << tokens[3*i+1] << " " << ((i == N - 10) ? "1.x5" : tokens[3*i+2]) << "\n";
+    f << "</position>\n</configuration>\n</hoomd_xml>\n";
+    f.close();
+
+    #ifdef ENABLE_OPENMP
+    omp_set_num_threads(std::max(n_threads, 4));
+    #endif
+    BOOST_CHECK_THROW(HOOMDInitializer(exec_conf, "test_large.xml"), runtime_error);
+    #ifdef ENABLE_OPENMP
+    omp_set_num_threads(n_threads);
+    #endif
+
+    remove_all("test_large.xml");
+    }
+
 #ifdef WIN32
 #pragma warning( pop )
 #endif
@@ -585,6 +585,26 @@ shared_ptr<PotentialPairLJ> base_class_lj_creator(shared_ptr<SystemDefinition> s
     return shared_ptr<PotentialPairLJ>(new PotentialPairLJ(sysdef, nlist));
     }
 
+//! LJForceCompute creator for unit tests that always uses the per neighbor loop
+shared_ptr<PotentialPairLJ> scalar_lj_creator(shared_ptr<SystemDefinition> sysdef,
+                                              shared_ptr<NeighborList> nlist)
+    {
+    shared_ptr<PotentialPairLJ> lj(new PotentialPairLJ(sysdef, nlist));
+    lj->setVectorized(false);
+    return lj;
+    }
+
+//! LJForceCompute creator for unit tests that writes the forces without per thread partial arrays
+shared_ptr<PotentialPairLJ> owner_lj_creator(shared_ptr<SystemDefinition> sysdef,
+                                             shared_ptr<NeighborList> nlist)
+    {
+    nlist->setStorageMode(NeighborList::full);
+    shared_ptr<PotentialPairLJ> lj(new PotentialPairLJ(sysdef, nlist));
+    lj->setThreadAccumulation(ForceCompute::owner_computes);
+    BOOST_CHECK_EQUAL(lj->getThreadPartialBytes(), (size_t)0);
+    return lj;
+    }
+
 #ifdef ENABLE_CUDA
 //! LJForceComputeGPU creator for unit tests
 shared_ptr<PotentialPairLJGPU> gpu_lj_creator(shared_ptr<SystemDefinition> sysdef,
@@ -619,6 +639,29 @@ BOOST_AUTO_TEST_CASE( PotentialPairLJ_shift )
     lj_force_shift_test(lj_creator_base, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
     }
 
+//! boost test case for comparing the vectorized path to the per neighbor loop on CPU
+BOOST_AUTO_TEST_CASE( PotentialPairLJ_vectorized )
+    {
+    ljforce_creator lj_creator_scalar = bind(scalar_lj_creator, _1, _2);
+    ljforce_creator lj_creator_base = bind(base_class_lj_creator, _1, _2);
+    lj_force_comparison_test(lj_creator_scalar, lj_creator_base, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
+
+//! boost test case for particle test on CPU with owner computes accumulation
+BOOST_AUTO_TEST_CASE( PotentialPairLJ_owner_particle )
+    {
+    ljforce_creator lj_creator_owner = bind(owner_lj_creator, _1, _2);
+    lj_force_particle_test(lj_creator_owner, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
+
+//! boost test case for comparing owner computes accumulation to the per thread partial arrays on CPU
+BOOST_AUTO_TEST_CASE( PotentialPairLJ_owner_compare )
+    {
+    ljforce_creator lj_creator_owner = bind(owner_lj_creator, _1, _2);
+    ljforce_creator lj_creator_base = bind(base_class_lj_creator, _1, _2);
+    lj_force_comparison_test(lj_creator_base, lj_creator_owner, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
+
 # ifdef ENABLE_CUDA
 //! boost test case for particle test on GPU
 BOOST_AUTO_TEST_CASE( LJForceGPU_particle )
@@ -0,0 +1,151 @@
+//! name the boost unit test module
+#define BOOST_TEST_MODULE LoadBalancerTestsMPI
+#include "MPITestSetup.h"
+
+#include "HOOMDMath.h"
+#include "ExecutionConfiguration.h"
+#include "SystemDefinition.h"
+#include "SnapshotSystemData.h"
+
+#include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+#include "HOOMDMPI.h"
+#include "Communicator.h"
+#include "DomainDecomposition.h"
+#include "LoadBalancer.h"
+
+using namespace boost;
+using namespace std;
+
+//! Checks that every local particle lies inside the local box
+static void check_local_box(boost::shared_ptr<ParticleData> pdata)
+    {
+    const BoxDim& box = pdata->getBox();
+    ArrayHandle<Scalar4> h_pos(pdata->getPositions(), access_location::host, access_mode::read);
+    for (unsigned int i = 0; i < pdata->getN(); i++)
+        {
+        Scalar3 f = box.makeFraction(make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z));
+        BOOST_CHECK(f.x >= Scalar(0.0) && f.x < Scalar(1.0));
+        BOOST_CHECK(f.y >= Scalar(0.0) && f.y < Scalar(1.0));
+        BOOST_CHECK(f.z >= Scalar(0.0) && f.z < Scalar(1.0));
+        }
+    }
+
+//! Balances a system in which all particles are in one half of the box
+void test_load_balancer(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // 20^3 lattice filling the lower half of the box along x
+    unsigned int n = 20;
+    Scalar L = Scalar(20.0);
+    shared_ptr<SystemDefinition> sysdef_2(new SystemDefinition(n*n*n, BoxDim(L), 1, 0, 0, 0, 0, exec_conf));
+    shared_ptr<ParticleData> pdata_2 = sysdef_2->getParticleData();
+
+    {
+    ArrayHandle<Scalar4> h_pos(pdata_2->getPositions(), access_location::host, access_mode::readwrite);
+    for (unsigned int i = 0; i < n; i++)
+        for (unsigned int j = 0; j < n; j++)
+            for (unsigned int k = 0; k < n; k++)
+                {
+                unsigned int idx = (i*n + j)*n + k;
+                h_pos.data[idx].x = -L/Scalar(2.0) + Scalar(0.5)*(Scalar(i) + Scalar(0.5));
+                h_pos.data[idx].y = -L/Scalar(2.0) + Scalar(j) + Scalar(0.5);
+                h_pos.data[idx].z = -L/Scalar(2.0) + Scalar(k) + Scalar(0.5);
+                }
+    }
+
+    boost::shared_ptr<SnapshotSystemData> snap;
+    snap = sysdef_2->takeSnapshot(true, false, false, false, false, false, false, false);
+
+    boost::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, snap->global_box.getL(), 0));
+    shared_ptr<SystemDefinition> sysdef_1(new SystemDefinition(snap, exec_conf, decomposition));
+    shared_ptr<ParticleData> pdata_1 = sysdef_1->getParticleData();
+
+    boost::shared_ptr<Communicator> comm(new Communicator(sysdef_1, decomposition));
+    comm->setGhostLayerWidth(Scalar(1.0));
+
+    shared_ptr<LoadBalancer> balancer(new LoadBalancer(sysdef_1, decomposition));
+    balancer->setCommunicator(comm);
+    balancer->setTolerance(Scalar(1.01));
+
+    comm->communicate(0);
+    Scalar initial_imbalance = balancer->getImbalance();
+
+    for (unsigned int timestep = 1; timestep <= 5; timestep++)
+        {
+        balancer->update(timestep);
+        comm->communicate(timestep);
+        }
+
+    // the lattice can be divided exactly
+    if (exec_conf->getNRanks() > 1)
+        BOOST_CHECK(balancer->getImbalance() < initial_imbalance);
+    MY_BOOST_CHECK_CLOSE(balancer->getImbalance(), Scalar(1.0), tol);
+
+    // no particle was lost
+    unsigned int N = pdata_1->getN();
+    unsigned int N_sum;
+    MPI_Allreduce(&N, &N_sum, 1, MPI_UNSIGNED, MPI_SUM, exec_conf->getMPICommunicator());
+    BOOST_CHECK_EQUAL(N_sum, n*n*n);
+
+    check_local_box(pdata_1);
+
+    // all ranks agree on the boundaries
+    for (unsigned int dim = 0; dim < 3; dim++)
+        {
+        vector<Scalar> cum_frac = decomposition->getCumulativeFractions(dim);
+        vector<Scalar> cum_frac_root = cum_frac;
+        bcast(cum_frac_root, 0, exec_conf->getMPICommunicator());
+        for (unsigned int i = 0; i < cum_frac.size(); i++)
+            BOOST_CHECK_EQUAL(cum_frac[i], cum_frac_root[i]);
+        }
+
+    // a new system initialized on the balanced decomposition places the particles into the moved domains
+    snap = sysdef_1->takeSnapshot(true, false, false, false, false, false, false, false);
+    shared_ptr<SystemDefinition> sysdef_3(new SystemDefinition(snap, exec_conf, decomposition));
+    shared_ptr<ParticleData> pdata_3 = sysdef_3->getParticleData();
+    BOOST_CHECK_EQUAL(pdata_3->getN(), pdata_1->getN());
+    check_local_box(pdata_3);
+    }
+
+//! Tests that the load balancer evens out the number of particles per rank
+BOOST_AUTO_TEST_CASE( LoadBalancer_mpi )
+    {
+    test_load_balancer(exec_conf_cpu);
+    }
+
+//! Checks that a load balancer and a user of equally sized domains reject each other, in either order
+void test_load_balancer_uniform(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    Scalar L = Scalar(20.0);
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(8, BoxDim(L), 1, 0, 0, 0, 0, exec_conf));
+    boost::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, make_scalar3(L, L, L), 0));
+
+    // a load balancer cannot be added while equally sized domains are required
+    decomposition->requireUniform("test");
+    BOOST_CHECK_THROW(shared_ptr<LoadBalancer>(new LoadBalancer(sysdef, decomposition)), std::runtime_error);
+    decomposition->releaseUniform();
+
+    // equally sized domains cannot be required while a load balancer is in use
+        {
+        shared_ptr<LoadBalancer> balancer(new LoadBalancer(sysdef, decomposition));
+        BOOST_CHECK_THROW(decomposition->requireUniform("test"), std::runtime_error);
+        }
+
+    // nor after the boundaries have been moved
+    vector<Scalar> cum_frac = decomposition->getCumulativeFractions(0);
+    if (cum_frac.size() > 2)
+        {
+        cum_frac[1] = Scalar(0.8)*cum_frac[1];
+        decomposition->setCumulativeFractions(0, cum_frac);
+        BOOST_CHECK_THROW(decomposition->requireUniform("test"), std::runtime_error);
+        }
+    }
+
+//! Tests that the load balancer cannot be combined with computes that require equally sized domains
+BOOST_AUTO_TEST_CASE( LoadBalancer_uniform_mpi )
+    {
+    test_load_balancer_uniform(exec_conf_cpu);
+    }
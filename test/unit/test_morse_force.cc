@@ -255,6 +255,15 @@ shared_ptr<PotentialPairMorse> base_class_morse_creator(shared_ptr<SystemDefinit
     return shared_ptr<PotentialPairMorse>(new PotentialPairMorse(sysdef, nlist));
     }
 
+//! PotentialPairMorse creator for unit tests that always uses the per neighbor loop
+shared_ptr<PotentialPairMorse> scalar_morse_creator(shared_ptr<SystemDefinition> sysdef,
+                                                    shared_ptr<NeighborList> nlist)
+    {
+    shared_ptr<PotentialPairMorse> morse(new PotentialPairMorse(sysdef, nlist));
+    morse->setVectorized(false);
+    return morse;
+    }
+
 #ifdef ENABLE_CUDA
 //! PotentialPairMorseGPU creator for unit tests
 shared_ptr<PotentialPairMorseGPU> gpu_morse_creator(shared_ptr<SystemDefinition> sysdef,
@@ -275,6 +284,14 @@ BOOST_AUTO_TEST_CASE( MorseForce_particle )
     morse_force_particle_test(morse_creator_base, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
     }
 
+//! boost test case for comparing the vectorized path to the per neighbor loop on CPU
+BOOST_AUTO_TEST_CASE( MorseForce_vectorized )
+    {
+    morseforce_creator morse_creator_scalar = bind(scalar_morse_creator, _1, _2);
+    morseforce_creator morse_creator_base = bind(base_class_morse_creator, _1, _2);
+    morse_force_comparison_test(morse_creator_scalar, morse_creator_base, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
+
 # ifdef ENABLE_CUDA
 //! boost test case for particle test on GPU
 BOOST_AUTO_TEST_CASE( MorseForceGPU_particle )
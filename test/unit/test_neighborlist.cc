@@ -56,6 +56,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <iostream>
 #include <algorithm>
+#include <stdlib.h>
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
@@ -562,6 +563,80 @@ void neighborlist_comparison_test(boost::shared_ptr<ExecutionConfiguration> exec
         }
     }
 
+//! Test that NeighborListBinned with subdivided cells matches the O(N^2) NeighborList
+/*! \param exec_conf Execution configuration
+    \param subdivision Cell subdivision to test
+    \param filter_diameter Set to true to give the particles diameters between 0.5 and 3.0 and enable the diameter filter
+*/
+void neighborlist_subdivision_test(boost::shared_ptr<ExecutionConfiguration> exec_conf,
+                                   unsigned int subdivision,
+                                   bool filter_diameter)
+    {
+    // construct the particle system
+    RandomInitializer init(1000, Scalar(0.016778), Scalar(0.9), "A");
+    boost::shared_ptr<SnapshotSystemData> snap = init.getSnapshot();
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(snap, exec_conf));
+    shared_ptr<ParticleData> pdata = sysdef->getParticleData();
+
+    if (filter_diameter)
+        {
+        ArrayHandle<Scalar> h_diameter(pdata->getDiameters(), access_location::host, access_mode::readwrite);
+        srand(12345);
+        for (unsigned int i = 0; i < pdata->getN(); i++)
+            h_diameter.data[i] = Scalar(0.5) + Scalar(2.5) * Scalar(rand()) / Scalar(RAND_MAX);
+        }
+    
+    shared_ptr<NeighborList> nlist1(new NeighborList(sysdef, Scalar(3.0), Scalar(0.4)));
+    nlist1->setStorageMode(NeighborList::full);
+    
+    shared_ptr<NeighborListBinned> nlist2(new NeighborListBinned(sysdef, Scalar(3.0), Scalar(0.4)));
+    nlist2->setStorageMode(NeighborList::full);
+    nlist2->setCellSubdivision(subdivision);
+
+    if (filter_diameter)
+        {
+        // pairs of large particles are only found through the diameter shift, out to r_list + 2.0
+        nlist1->setMaximumDiameter(Scalar(3.0));
+        nlist1->setFilterDiameter(true);
+        nlist2->setMaximumDiameter(Scalar(3.0));
+        nlist2->setFilterDiameter(true);
+        }
+    
+    nlist1->compute(0);
+    nlist2->compute(0);
+    
+    ArrayHandle<unsigned int> h_n_neigh1(nlist1->getNNeighArray(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_nlist1(nlist1->getNListArray(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_n_neigh2(nlist2->getNNeighArray(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_nlist2(nlist2->getNListArray(), access_location::host, access_mode::read);
+    Index2D nli = nlist1->getNListIndexer();
+    
+    std::vector<unsigned int> tmp_list1;
+    std::vector<unsigned int> tmp_list2;
+    
+    for (unsigned int i = 0; i < pdata->getN(); i++)
+        {
+        BOOST_REQUIRE_EQUAL(h_n_neigh1.data[i], h_n_neigh2.data[i]);
+        
+        tmp_list1.resize(h_n_neigh1.data[i]);
+        tmp_list2.resize(h_n_neigh1.data[i]);
+        
+        for (unsigned int j = 0; j < h_n_neigh1.data[i]; j++)
+            {
+            tmp_list1[j] = h_nlist1.data[nli(i,j)];
+            tmp_list2[j] = h_nlist2.data[nli(i,j)];
+            }
+        
+        sort(tmp_list1.begin(), tmp_list1.end());
+        sort(tmp_list2.begin(), tmp_list2.end());
+        
+        for (unsigned int j = 0; j < tmp_list1.size(); j++)
+            {
+            BOOST_CHECK_EQUAL(tmp_list1[j], tmp_list2[j]);
+            }
+        }
+    }
+
 //! Test that a NeighborList can successfully exclude a ridiculously large number of particles
 template <class NL>
 void neighborlist_large_ex_tests(boost::shared_ptr<ExecutionConfiguration> exec_conf)
@@ -605,6 +680,70 @@ void neighborlist_large_ex_tests(boost::shared_ptr<ExecutionConfiguration> exec_
         }
     }
 
+//! Test per type pair r_cut filtering
+template <class NL>
+void neighborlist_type_rcut_tests(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // four particles of two types in a huge box
+    shared_ptr<SystemDefinition> sysdef_4(new SystemDefinition(4, BoxDim(25.0), 2, 0, 0, 0, 0, exec_conf));
+    shared_ptr<ParticleData> pdata_4 = sysdef_4->getParticleData();
+
+    {
+    ArrayHandle<Scalar4> h_pos(pdata_4->getPositions(), access_location::host, access_mode::readwrite);
+
+    h_pos.data[0].x = 0; h_pos.data[0].y = 0; h_pos.data[0].z = 0; h_pos.data[0].w = __int_as_scalar(0);
+    h_pos.data[1].x = 2.0; h_pos.data[1].y = 0; h_pos.data[1].z = 0; h_pos.data[1].w = __int_as_scalar(0);
+    h_pos.data[2].x = 0; h_pos.data[2].y = 2.0; h_pos.data[2].z = 0; h_pos.data[2].w = __int_as_scalar(1);
+    h_pos.data[3].x = 0; h_pos.data[3].y = 0; h_pos.data[3].z = -1.0; h_pos.data[3].w = __int_as_scalar(1);
+    }
+
+    shared_ptr<NeighborList> nlist_4(new NL(sysdef_4, 3.0, 0.25));
+    nlist_4->setStorageMode(NeighborList::full);
+    nlist_4->setRCutPair(0, 0, 3.0);
+    nlist_4->setRCutPair(0, 1, 1.0);
+    nlist_4->setRCutPair(1, 1, 3.0);
+    nlist_4->compute(0);
+
+    // without filtering, every particle is within the global r_cut of every other one
+        {
+        ArrayHandle<unsigned int> h_n_neigh(nlist_4->getNNeighArray(), access_location::host, access_mode::read);
+        for (unsigned int i = 0; i < 4; i++)
+            BOOST_CHECK_EQUAL_UINT(h_n_neigh.data[i], 3);
+        }
+
+    // with filtering, only the 0-1 and 2-3 (same type) and the 0-3 (short range) pairs remain
+    nlist_4->setFilterRcutType(true);
+    nlist_4->compute(1);
+        {
+        ArrayHandle<unsigned int> h_n_neigh(nlist_4->getNNeighArray(), access_location::host, access_mode::read);
+        ArrayHandle<unsigned int> h_nlist(nlist_4->getNListArray(), access_location::host, access_mode::read);
+        Index2D nli = nlist_4->getNListIndexer();
+
+        vector<unsigned int> neigh;
+
+        BOOST_REQUIRE_EQUAL_UINT(h_n_neigh.data[0], 2);
+        neigh.push_back(h_nlist.data[nli(0,0)]);
+        neigh.push_back(h_nlist.data[nli(0,1)]);
+        sort(neigh.begin(), neigh.end());
+        BOOST_CHECK_EQUAL_UINT(neigh[0], 1);
+        BOOST_CHECK_EQUAL_UINT(neigh[1], 3);
+
+        BOOST_REQUIRE_EQUAL_UINT(h_n_neigh.data[1], 1);
+        BOOST_CHECK_EQUAL_UINT(h_nlist.data[nli(1,0)], 0);
+
+        BOOST_REQUIRE_EQUAL_UINT(h_n_neigh.data[2], 1);
+        BOOST_CHECK_EQUAL_UINT(h_nlist.data[nli(2,0)], 3);
+
+        BOOST_REQUIRE_EQUAL_UINT(h_n_neigh.data[3], 2);
+        neigh.clear();
+        neigh.push_back(h_nlist.data[nli(3,0)]);
+        neigh.push_back(h_nlist.data[nli(3,1)]);
+        sort(neigh.begin(), neigh.end());
+        BOOST_CHECK_EQUAL_UINT(neigh[0], 0);
+        BOOST_CHECK_EQUAL_UINT(neigh[1], 2);
+        }
+    }
+
 //! basic test case for base class
 BOOST_AUTO_TEST_CASE( NeighborList_basic )
     {
@@ -630,6 +769,11 @@ BOOST_AUTO_TEST_CASE( NeighborList_diameter_filter )
     {
     neighborlist_diameter_filter_tests<NeighborList>(boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
     }
+//! type pair r_cut test case for base class
+BOOST_AUTO_TEST_CASE( NeighborList_type_rcut )
+    {
+    neighborlist_type_rcut_tests<NeighborList>(boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
 
 //! basic test case for binned class
 BOOST_AUTO_TEST_CASE( NeighborListBinned_basic )
@@ -656,12 +800,33 @@ BOOST_AUTO_TEST_CASE( NeighborListBinned_diameter_filter )
     {
     neighborlist_diameter_filter_tests<NeighborListBinned>(boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
     }
+//! type pair r_cut test case for binned class
+BOOST_AUTO_TEST_CASE( NeighborListBinned_type_rcut )
+    {
+    neighborlist_type_rcut_tests<NeighborListBinned>(boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
 //! comparison test case for binned class
 BOOST_AUTO_TEST_CASE( NeighborListBinned_comparison )
     {
     neighborlist_comparison_test<NeighborList, NeighborListBinned>(boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
     }
 
+//! boost test case for subdivided cells in NeighborListBinned
+BOOST_AUTO_TEST_CASE( NeighborListBinned_subdivision )
+    {
+    boost::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    neighborlist_subdivision_test(exec_conf, 2, false);
+    neighborlist_subdivision_test(exec_conf, 3, false);
+    }
+
+//! boost test case for subdivided cells in NeighborListBinned with the diameter filter
+BOOST_AUTO_TEST_CASE( NeighborListBinned_subdivision_diameter )
+    {
+    boost::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    neighborlist_subdivision_test(exec_conf, 2, true);
+    neighborlist_subdivision_test(exec_conf, 3, true);
+    }
+
 #ifdef ENABLE_CUDA
 
 //! basic test case for GPU class
@@ -65,6 +65,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Communicator.h"
 #include "DomainDecomposition.h"
+#include "HOOMDMPI.h"
 
 #ifdef ENABLE_CUDA
 #include "TwoStepNPTMTKGPU.h"
@@ -75,6 +76,7 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "NeighborListBinned.h"
 #include "Initializers.h"
+#include "SnapshotSystemData.h"
 #include "AllPairPotentials.h"
 
 
@@ -94,6 +96,109 @@ using namespace boost;
 // this has to be included after naming the test module
 #include "MPITestSetup.h"
 
+//! Checks that the thermostat and barostat state stays identical on all ranks without being broadcast in every step
+void npt_mtk_replicated_state_test_mpi(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    const unsigned int N = 2000;
+    Scalar P = 1.0;
+    Scalar T0 = 1.0;
+
+    RandomInitializer rand_init(N, Scalar(0.2), Scalar(0.9), "A");
+    rand_init.setSeed(12345);
+    boost::shared_ptr<SnapshotSystemData> snap = rand_init.getSnapshot();
+
+    boost::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, snap->global_box.getL(), 0));
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(snap, exec_conf, decomposition));
+    shared_ptr<ParticleData> pdata = sysdef->getParticleData();
+
+    boost::shared_ptr<Communicator> comm;
+#ifdef ENABLE_CUDA
+    if (exec_conf->isCUDAEnabled())
+        comm = shared_ptr<Communicator>(new CommunicatorGPU(sysdef, decomposition));
+    else
+#endif
+        comm = boost::shared_ptr<Communicator>(new Communicator(sysdef, decomposition));
+
+    shared_ptr<ParticleSelector> selector_all(new ParticleSelectorTag(sysdef, 0, pdata->getNGlobal()-1));
+    shared_ptr<ParticleGroup> group_all(new ParticleGroup(sysdef, selector_all));
+
+    shared_ptr<NeighborListBinned> nlist(new NeighborListBinned(sysdef, Scalar(2.5), Scalar(0.8)));
+    nlist->setCommunicator(comm);
+
+    shared_ptr<PotentialPairLJ> fc(new PotentialPairLJ(sysdef, nlist));
+    fc->setRcut(0, 0, Scalar(2.5));
+    fc->setParams(0,0,make_scalar2(Scalar(4.0),Scalar(4.0)));
+
+    shared_ptr<ComputeThermo> thermo_group(new ComputeThermo(sysdef, group_all, "name"));
+    thermo_group->setCommunicator(comm);
+
+    boost::shared_ptr<Variant> P_variant(new VariantConst(P));
+    boost::shared_ptr<Variant> T_variant(new VariantConst(T0));
+    unsigned int flags = TwoStepNPTMTK::baro_x | TwoStepNPTMTK::baro_y | TwoStepNPTMTK::baro_z;
+    shared_ptr<TwoStepNPTMTK> two_step_npt_mtk;
+#ifdef ENABLE_CUDA
+    if (exec_conf->isCUDAEnabled())
+        two_step_npt_mtk = shared_ptr<TwoStepNPTMTK>(new TwoStepNPTMTKGPU(sysdef, group_all, thermo_group, Scalar(0.5),
+            Scalar(0.5), T_variant, P_variant, TwoStepNPTMTK::couple_none, flags, false));
+    else
+#endif
+        two_step_npt_mtk = shared_ptr<TwoStepNPTMTK>(new TwoStepNPTMTK(sysdef, group_all, thermo_group, Scalar(0.5),
+            Scalar(0.5), T_variant, P_variant, TwoStepNPTMTK::couple_none, flags, false));
+
+    // start out with a thermostat and barostat state that only the root rank has, as after reading restart data
+    // on the root
+    IntegratorVariables v = sysdef->getIntegratorData()->getIntegratorVariables(0);
+    v.variable[1] = (exec_conf->getRank() == 0) ? Scalar(0.25) : Scalar(-1.0);
+    v.variable[2] = (exec_conf->getRank() == 0) ? Scalar(0.125) : Scalar(-0.5);
+    sysdef->getIntegratorData()->setIntegratorVariables(0, v);
+
+    two_step_npt_mtk->setCheckReplicatedState(true);
+    shared_ptr<IntegratorTwoStep> npt_mtk(new IntegratorTwoStep(sysdef, Scalar(0.001)));
+    npt_mtk->addIntegrationMethod(two_step_npt_mtk);
+    npt_mtk->addForceCompute(fc);
+
+    // the state of the root rank is broadcast once, when the communicator is set
+    npt_mtk->setCommunicator(comm);
+    v = sysdef->getIntegratorData()->getIntegratorVariables(0);
+    BOOST_CHECK_EQUAL(v.variable[1], Scalar(0.25));
+    BOOST_CHECK_EQUAL(v.variable[2], Scalar(0.125));
+
+    thermo_group->setNDOF(npt_mtk->getNDOF(group_all));
+    npt_mtk->prepRun(0);
+
+    // every step checks that all ranks agree on the state and on the new box, and raises an error on all ranks if
+    // they don't
+    for (unsigned int i = 0; i < 200; i++)
+        BOOST_REQUIRE_NO_THROW(npt_mtk->update(i));
+
+    // the state and the box have changed, and are bitwise identical on all ranks
+    v = sysdef->getIntegratorData()->getIntegratorVariables(0);
+    Scalar3 L = pdata->getGlobalBox().getL();
+    std::vector<Scalar> state(v.variable);
+    state.push_back(L.x);
+    state.push_back(L.y);
+    state.push_back(L.z);
+    std::vector<Scalar> root_state(state);
+    bcast(root_state, 0, exec_conf->getMPICommunicator());
+    BOOST_CHECK(v.variable[2] != Scalar(0.125));
+    for (unsigned int i = 0; i < state.size(); i++)
+        BOOST_CHECK_EQUAL(state[i], root_state[i]);
+    }
+
+//! Tests that the NPT-MTK state is replicated on all ranks
+BOOST_AUTO_TEST_CASE( TwoStepNPTMTK_replicated_state_tests )
+    {
+    npt_mtk_replicated_state_test_mpi(exec_conf_cpu);
+    }
+
+#ifdef ENABLE_CUDA
+//! Tests that the NPT-MTK state is replicated on all ranks on the GPU
+BOOST_AUTO_TEST_CASE( TwoStepNPTMTKGPU_replicated_state_tests )
+    {
+    npt_mtk_replicated_state_test_mpi(exec_conf_gpu);
+    }
+#endif
+
 #if 0 // need to adapt to current version of NPT integrator
 //! Typedef'd NPTMTKUpdator class factory
 typedef boost::function<shared_ptr<TwoStepNPTMTK> (shared_ptr<SystemDefinition> sysdef,
@@ -71,9 +71,14 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "AllPairPotentials.h"
 #include "NeighborList.h"
 #include "Initializers.h"
+#include "SnapshotSystemData.h"
 
 #include <math.h>
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 using namespace boost;
 
@@ -389,6 +394,199 @@ void nve_updater_compare_test(twostepnve_creator nve_creator1,
         }
     }
 
+//! Checks that the net force, torque and virial are the plain sum over a list of force computes
+void check_net_force_sum(shared_ptr<ParticleData> pdata, const std::vector< shared_ptr<ForceCompute> >& forces)
+    {
+    unsigned int N = pdata->getN();
+    ArrayHandle<Scalar4> h_net_force(pdata->getNetForce(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_net_torque(pdata->getNetTorqueArray(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar> h_net_virial(pdata->getNetVirial(), access_location::host, access_mode::read);
+    unsigned int net_virial_pitch = pdata->getNetVirial().getPitch();
+
+    // sum up the forces particle by particle, in the order in which they were added to the integrator
+    std::vector<Scalar4> force(N, make_scalar4(0.0, 0.0, 0.0, 0.0));
+    std::vector<Scalar4> torque(N, make_scalar4(0.0, 0.0, 0.0, 0.0));
+    std::vector<Scalar> virial(6*N, Scalar(0.0));
+    for (unsigned int i = 0; i < forces.size(); i++)
+        {
+        ArrayHandle<Scalar4> h_force(forces[i]->getForceArray(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_torque(forces[i]->getTorqueArray(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar> h_virial(forces[i]->getVirialArray(), access_location::host, access_mode::read);
+        unsigned int virial_pitch = forces[i]->getVirialArray().getPitch();
+        for (unsigned int j = 0; j < N; j++)
+            {
+            force[j].x += h_force.data[j].x;
+            force[j].y += h_force.data[j].y;
+            force[j].z += h_force.data[j].z;
+            force[j].w += h_force.data[j].w;
+            torque[j].x += h_torque.data[j].x;
+            torque[j].y += h_torque.data[j].y;
+            torque[j].z += h_torque.data[j].z;
+            torque[j].w += h_torque.data[j].w;
+            for (unsigned int k = 0; k < 6; k++)
+                virial[k*N+j] += h_virial.data[k*virial_pitch+j];
+            }
+        }
+
+    // both sums add the same numbers in the same order, so they agree exactly
+    for (unsigned int j = 0; j < N; j++)
+        {
+        BOOST_CHECK_EQUAL(h_net_force.data[j].x, force[j].x);
+        BOOST_CHECK_EQUAL(h_net_force.data[j].y, force[j].y);
+        BOOST_CHECK_EQUAL(h_net_force.data[j].z, force[j].z);
+        BOOST_CHECK_EQUAL(h_net_force.data[j].w, force[j].w);
+        BOOST_CHECK_EQUAL(h_net_torque.data[j].x, torque[j].x);
+        BOOST_CHECK_EQUAL(h_net_torque.data[j].y, torque[j].y);
+        BOOST_CHECK_EQUAL(h_net_torque.data[j].z, torque[j].z);
+        BOOST_CHECK_EQUAL(h_net_torque.data[j].w, torque[j].w);
+        for (unsigned int k = 0; k < 6; k++)
+            BOOST_CHECK_EQUAL(h_net_virial.data[k*net_virial_pitch+j], virial[k*N+j]);
+        }
+    }
+
+//! Compares the second step fused with the net force sum to the separate second step
+/*! The system has more particles than fit in one block of the net force sum and several force computes. The net
+    force of the fused step is checked against the plain sum over the force computes. The velocities must be the same
+    as with the separate step, the thermodynamic properties accumulated in the net force pass must be the same with
+    a single thread and agree closely with several threads.
+*/
+void nve_updater_fused_test(boost::shared_ptr<ExecutionConfiguration> exec_conf, int n_threads)
+    {
+    const unsigned int N = 1500;
+
+    RandomInitializer rand_init(N, Scalar(0.2), Scalar(0.9), "A");
+    rand_init.setSeed(12345);
+    boost::shared_ptr<SnapshotSystemData> snap = rand_init.getSnapshot();
+
+    // give the particles some velocities, so that the kinetic energy is not zero
+    for (unsigned int j = 0; j < N; j++)
+        snap->particle_data.vel[j] = make_scalar3(sin(Scalar(j)), cos(Scalar(3*j)), sin(Scalar(7*j+1)));
+
+#ifdef ENABLE_OPENMP
+    // the per thread partial arrays are sized when the force computes are constructed
+    int max_threads = omp_get_max_threads();
+    unsigned int n_cpu = exec_conf->n_cpu;
+    exec_conf->n_cpu = std::max(n_cpu, (unsigned int)n_threads);
+    omp_set_num_threads(n_threads);
+#endif
+
+    shared_ptr<SystemDefinition> sysdef[2];
+    shared_ptr<IntegratorTwoStep> nve[2];
+    shared_ptr<ComputeThermo> thermo[2];
+    std::vector< shared_ptr<ForceCompute> > forces[2];
+
+    PDataFlags flags;
+    flags[pdata_flag::potential_energy] = 1;
+    flags[pdata_flag::isotropic_virial] = 1;
+    flags[pdata_flag::pressure_tensor] = 1;
+
+    for (unsigned int i = 0; i < 2; i++)
+        {
+        sysdef[i] = shared_ptr<SystemDefinition>(new SystemDefinition(snap, exec_conf));
+        shared_ptr<ParticleData> pdata = sysdef[i]->getParticleData();
+        pdata->setFlags(flags);
+        shared_ptr<ParticleSelector> selector_all(new ParticleSelectorTag(sysdef[i], 0, pdata->getN()-1));
+        shared_ptr<ParticleGroup> group_all(new ParticleGroup(sysdef[i], selector_all));
+
+        shared_ptr<NeighborList> nlist(new NeighborList(sysdef[i], Scalar(3.0), Scalar(0.8)));
+
+        shared_ptr<PotentialPairLJ> lj(new PotentialPairLJ(sysdef[i], nlist));
+        lj->setRcut(0, 0, Scalar(3.0));
+        Scalar epsilon = Scalar(1.0);
+        Scalar sigma = Scalar(1.2);
+        Scalar alpha = Scalar(0.45);
+        Scalar lj1 = Scalar(4.0) * epsilon * pow(sigma,Scalar(12.0));
+        Scalar lj2 = alpha * Scalar(4.0) * epsilon * pow(sigma,Scalar(6.0));
+        lj->setParams(0,0,make_scalar2(lj1,lj2));
+
+        shared_ptr<PotentialPairGauss> gauss(new PotentialPairGauss(sysdef[i], nlist));
+        gauss->setRcut(0, 0, Scalar(2.0));
+        gauss->setParams(0,0,make_scalar2(Scalar(0.5),Scalar(0.8)));
+
+        shared_ptr<ConstForceCompute> cf(new ConstForceCompute(sysdef[i], 0.1, -0.2, 0.3));
+
+        forces[i].push_back(lj);
+        forces[i].push_back(gauss);
+        forces[i].push_back(cf);
+
+        thermo[i] = shared_ptr<ComputeThermo>(new ComputeThermo(sysdef[i], group_all));
+        thermo[i]->setNDOF(3*N-3);
+
+        shared_ptr<TwoStepNVE> two_step_nve(new TwoStepNVE(sysdef[i], group_all));
+        two_step_nve->setThermo(thermo[i]);
+        nve[i] = shared_ptr<IntegratorTwoStep>(new IntegratorTwoStep(sysdef[i], Scalar(0.005)));
+        nve[i]->addIntegrationMethod(two_step_nve);
+        for (unsigned int k = 0; k < forces[i].size(); k++)
+            nve[i]->addForceCompute(forces[i][k]);
+        }
+
+    // the first integrator fuses the second step, the second one runs it separately
+    nve[1]->setFuseStepTwo(false);
+
+    nve[0]->prepRun(0);
+    nve[1]->prepRun(0);
+
+    for (int step = 0; step < 10; step++)
+        {
+        nve[0]->update(step);
+        nve[1]->update(step);
+
+        check_net_force_sum(sysdef[0]->getParticleData(), forces[0]);
+
+        // thermo[0] already holds the sums of the fused step, thermo[1] computes them in a separate pass
+        thermo[0]->compute(step+1);
+        thermo[1]->compute(step+1);
+
+        {
+        ArrayHandle<Scalar4> h_vel0(sysdef[0]->getParticleData()->getVelocities(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar4> h_vel1(sysdef[1]->getParticleData()->getVelocities(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar3> h_accel0(sysdef[0]->getParticleData()->getAccelerations(), access_location::host, access_mode::read);
+        ArrayHandle<Scalar3> h_accel1(sysdef[1]->getParticleData()->getAccelerations(), access_location::host, access_mode::read);
+        for (unsigned int j = 0; j < N; j++)
+            {
+            BOOST_CHECK_EQUAL(h_vel0.data[j].x, h_vel1.data[j].x);
+            BOOST_CHECK_EQUAL(h_vel0.data[j].y, h_vel1.data[j].y);
+            BOOST_CHECK_EQUAL(h_vel0.data[j].z, h_vel1.data[j].z);
+            BOOST_CHECK_EQUAL(h_accel0.data[j].x, h_accel1.data[j].x);
+            BOOST_CHECK_EQUAL(h_accel0.data[j].y, h_accel1.data[j].y);
+            BOOST_CHECK_EQUAL(h_accel0.data[j].z, h_accel1.data[j].z);
+            }
+        }
+
+        PressureTensor P0 = thermo[0]->getPressureTensor();
+        PressureTensor P1 = thermo[1]->getPressureTensor();
+        if (n_threads == 1)
+            {
+            BOOST_CHECK_EQUAL(thermo[0]->getKineticEnergy(), thermo[1]->getKineticEnergy());
+            BOOST_CHECK_EQUAL(thermo[0]->getPotentialEnergy(), thermo[1]->getPotentialEnergy());
+            BOOST_CHECK_EQUAL(thermo[0]->getPressure(), thermo[1]->getPressure());
+            BOOST_CHECK_EQUAL(P0.xx, P1.xx);
+            BOOST_CHECK_EQUAL(P0.xy, P1.xy);
+            BOOST_CHECK_EQUAL(P0.xz, P1.xz);
+            BOOST_CHECK_EQUAL(P0.yy, P1.yy);
+            BOOST_CHECK_EQUAL(P0.yz, P1.yz);
+            BOOST_CHECK_EQUAL(P0.zz, P1.zz);
+            }
+        else
+            {
+            MY_BOOST_CHECK_CLOSE(thermo[0]->getKineticEnergy(), thermo[1]->getKineticEnergy(), tol_small);
+            MY_BOOST_CHECK_CLOSE(thermo[0]->getPotentialEnergy(), thermo[1]->getPotentialEnergy(), tol_small);
+            MY_BOOST_CHECK_CLOSE(thermo[0]->getPressure(), thermo[1]->getPressure(), tol_small);
+            MY_BOOST_CHECK_CLOSE(P0.xx, P1.xx, tol_small);
+            MY_BOOST_CHECK_CLOSE(P0.yy, P1.yy, tol_small);
+            MY_BOOST_CHECK_CLOSE(P0.zz, P1.zz, tol_small);
+            MY_BOOST_CHECK_SMALL(P0.xy - P1.xy, tol_small);
+            MY_BOOST_CHECK_SMALL(P0.xz - P1.xz, tol_small);
+            MY_BOOST_CHECK_SMALL(P0.yz - P1.yz, tol_small);
+            }
+        }
+
+#ifdef ENABLE_OPENMP
+    omp_set_num_threads(max_threads);
+    exec_conf->n_cpu = n_cpu;
+#endif
+    }
+
 //! TwoStepNVE factory for the unit tests
 shared_ptr<TwoStepNVE> base_class_nve_creator(shared_ptr<SystemDefinition> sysdef, shared_ptr<ParticleGroup> group)
     {
@@ -424,6 +622,15 @@ BOOST_AUTO_TEST_CASE( TwoStepNVE_boundary_tests )
     twostepnve_creator nve_creator = bind(base_class_nve_creator, _1, _2);
     nve_updater_boundary_tests(nve_creator, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
     }
+
+//! boost test case for the second step fused with the net force sum
+BOOST_AUTO_TEST_CASE( TwoStepNVE_fused_tests )
+    {
+    boost::shared_ptr<ExecutionConfiguration> exec_conf(new ExecutionConfiguration(ExecutionConfiguration::CPU));
+    nve_updater_fused_test(exec_conf, 1);
+    nve_updater_fused_test(exec_conf, 4);
+    }
+
 //! Need work on NVEUpdaterGPU with rigid bodies to test these cases
 #ifdef ENABLE_CUDA
 //! boost test case for base class integration tests
@@ -19,6 +19,7 @@
 
 #include "Communicator.h"
 #include "DomainDecomposition.h"
+#include "HOOMDMPI.h"
 
 #ifdef ENABLE_CUDA
 #include "CellListGPU.h"
@@ -42,7 +43,7 @@ void test_nvt_integrator_mpi(boost::shared_ptr<ExecutionConfiguration> exec_conf
     types.push_back("A");
     std::vector<uint> bonds;
     std::vector<string> bond_types;
-    rand_init.addGenerator((int)N, boost::shared_ptr<PolymerParticleGenerator>(new PolymerParticleGenerator(1.0, types, bonds, bonds, bond_types, 100)));
+    rand_init.addGenerator((int)N, boost::shared_ptr<PolymerParticleGenerator>(new PolymerParticleGenerator(exec_conf, 1.0, types, bonds, bonds, bond_types, 100)));
     rand_init.setSeparationRadius("A", .4);
 
     rand_init.generate();
@@ -184,16 +185,118 @@ void test_nvt_integrator_mpi(boost::shared_ptr<ExecutionConfiguration> exec_conf
 
 }
 
+//! Checks that the thermostat state stays identical on all ranks without being broadcast in every step
+void test_nvt_replicated_state_mpi(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+{
+    Scalar phi_p = 0.2;
+    unsigned int N = 2000;
+    Scalar L = pow(M_PI/6.0/phi_p*Scalar(N),1.0/3.0);
+    BoxDim box_g(L);
+    RandomGenerator rand_init(exec_conf, box_g, 12345);
+    std::vector<string> types;
+    types.push_back("A");
+    std::vector<uint> bonds;
+    std::vector<string> bond_types;
+    rand_init.addGenerator((int)N, boost::shared_ptr<PolymerParticleGenerator>(new PolymerParticleGenerator(exec_conf, 1.0, types, bonds, bonds, bond_types, 100)));
+    rand_init.setSeparationRadius("A", .4);
+
+    rand_init.generate();
+
+    boost::shared_ptr<SnapshotSystemData> snap;
+    snap = rand_init.getSnapshot();
+
+    boost::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf,snap->global_box.getL(), 0));
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(snap, exec_conf, decomposition));
+    shared_ptr<ParticleData> pdata = sysdef->getParticleData();
+
+    boost::shared_ptr<Communicator> comm;
+#ifdef ENABLE_CUDA
+    if (exec_conf->isCUDAEnabled())
+        comm = shared_ptr<Communicator>(new CommunicatorGPU(sysdef, decomposition));
+    else
+#endif
+        comm = boost::shared_ptr<Communicator>(new Communicator(sysdef, decomposition));
+
+    shared_ptr<ParticleSelector> selector_all(new ParticleSelectorTag(sysdef, 0, pdata->getNGlobal()-1));
+    shared_ptr<ParticleGroup> group_all(new ParticleGroup(sysdef, selector_all));
+
+    Scalar r_cut = Scalar(3.0);
+    shared_ptr<NeighborList> nlist(new NeighborListBinned(sysdef, r_cut, Scalar(0.8)));
+    nlist->setStorageMode(NeighborList::full);
+    nlist->setCommunicator(comm);
+
+    shared_ptr<PotentialPairLJ> fc(new PotentialPairLJ(sysdef, nlist));
+    fc->setRcut(0, 0, r_cut);
+    fc->setParams(0,0,make_scalar2(Scalar(4.0),Scalar(4.0)));
+
+    Scalar T = Scalar(1.5/3.0);
+    shared_ptr<VariantConst> T_variant(new VariantConst(T));
+    shared_ptr<IntegratorTwoStep> nvt(new IntegratorTwoStep(sysdef, Scalar(0.005)));
+    shared_ptr<ComputeThermo> thermo(new ComputeThermo(sysdef, group_all));
+    thermo->setCommunicator(comm);
+
+    shared_ptr<TwoStepNVT> two_step_nvt;
+#ifdef ENABLE_CUDA
+    if (exec_conf->isCUDAEnabled())
+        two_step_nvt = boost::shared_ptr<TwoStepNVT>(new TwoStepNVTGPU(sysdef, group_all, thermo, Scalar(0.5), T_variant));
+    else
+#endif
+    two_step_nvt = boost::shared_ptr<TwoStepNVT>(new TwoStepNVT(sysdef, group_all, thermo, Scalar(0.5), T_variant));
+
+    // start out with a thermostat state that only the root rank has, as after reading restart data on the root
+    IntegratorVariables v = sysdef->getIntegratorData()->getIntegratorVariables(0);
+    v.variable[0] = (exec_conf->getRank() == 0) ? Scalar(0.25) : Scalar(-1.0);
+    v.variable[1] = (exec_conf->getRank() == 0) ? Scalar(0.5) : Scalar(-2.0);
+    sysdef->getIntegratorData()->setIntegratorVariables(0, v);
+
+    two_step_nvt->setCheckReplicatedState(true);
+    nvt->addIntegrationMethod(two_step_nvt);
+    nvt->addForceCompute(fc);
+
+    // the state of the root rank is broadcast once, when the communicator is set
+    nvt->setCommunicator(comm);
+    v = sysdef->getIntegratorData()->getIntegratorVariables(0);
+    BOOST_CHECK_EQUAL(v.variable[0], Scalar(0.25));
+    BOOST_CHECK_EQUAL(v.variable[1], Scalar(0.5));
+
+    thermo->setNDOF(nvt->getNDOF(group_all));
+    nvt->prepRun(0);
+
+    // every step checks that all ranks agree on the state, and raises an error on all ranks if they don't
+    for (unsigned int i = 0; i < 200; i++)
+        BOOST_REQUIRE_NO_THROW(nvt->update(i));
+
+    // the state has moved away from its initial value, and is bitwise identical on all ranks
+    v = sysdef->getIntegratorData()->getIntegratorVariables(0);
+    std::vector<Scalar> root_state = v.variable;
+    bcast(root_state, 0, exec_conf->getMPICommunicator());
+    BOOST_CHECK(v.variable[0] != Scalar(0.25));
+    for (unsigned int i = 0; i < v.variable.size(); i++)
+        BOOST_CHECK_EQUAL(v.variable[i], root_state[i]);
+}
+
 //! Tests MPI domain decomposition with NVT integrator
 BOOST_AUTO_TEST_CASE( DomainDecomposition_NVT_test )
     {
     test_nvt_integrator_mpi(exec_conf_cpu);
     }
 
+//! Tests that the NVT thermostat state is replicated on all ranks
+BOOST_AUTO_TEST_CASE( DomainDecomposition_NVT_replicated_state_test )
+    {
+    test_nvt_replicated_state_mpi(exec_conf_cpu);
+    }
+
 #ifdef ENABLE_CUDA
 //! Tests MPI domain decomposition with NVT integrator on the GPU
 BOOST_AUTO_TEST_CASE( DomainDecomposition_NVT_test_GPU )
     {
     test_nvt_integrator_mpi(exec_conf_gpu);
     }
+
+//! Tests that the NVT thermostat state is replicated on all ranks on the GPU
+BOOST_AUTO_TEST_CASE( DomainDecomposition_NVT_replicated_state_test_GPU )
+    {
+    test_nvt_replicated_state_mpi(exec_conf_gpu);
+    }
 #endif
@@ -74,6 +74,10 @@ ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <math.h>
 
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 using namespace boost;
 using namespace boost::python;
@@ -236,6 +240,61 @@ void pppm_force_particle_test_triclinic(pppmforce_creator pppm_creator, boost::s
     }
 
 
+#ifdef ENABLE_OPENMP
+//! Test that the threaded PPPM gives the same forces as a single thread
+void pppm_force_thread_test(pppmforce_creator pppm_creator, boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // a neutral random system on a mesh large enough to be split into several slabs in each direction
+    unsigned int N = 500;
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(N, BoxDim(20.0, 22.0, 24.0), 1, 0, 0, 0, 0, exec_conf));
+    shared_ptr<ParticleData> pdata = sysdef->getParticleData();
+    pdata->setFlags(~PDataFlags(0));
+
+    shared_ptr<NeighborList> nlist(new NeighborList(sysdef, Scalar(1.0), Scalar(1.0)));
+    shared_ptr<ParticleSelector> selector_all(new ParticleSelectorTag(sysdef, 0, N-1));
+    shared_ptr<ParticleGroup> group_all(new ParticleGroup(sysdef, selector_all));
+
+    {
+    ArrayHandle<Scalar4> h_pos(pdata->getPositions(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar> h_charge(pdata->getCharges(), access_location::host, access_mode::readwrite);
+    srand(12345);
+    for (unsigned int i = 0; i < N; i++)
+        {
+        h_pos.data[i].x = Scalar(20.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_pos.data[i].y = Scalar(22.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_pos.data[i].z = Scalar(24.0) * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_charge.data[i] = (i % 2) ? Scalar(1.0) : Scalar(-1.0);
+        }
+    }
+
+    shared_ptr<PPPMForceCompute> fc_serial = pppm_creator(sysdef, nlist, group_all);
+    shared_ptr<PPPMForceCompute> fc_threaded = pppm_creator(sysdef, nlist, group_all);
+    fc_serial->setParams(32, 32, 32, 5, 1.0, 2.0);
+    fc_threaded->setParams(32, 32, 32, 5, 1.0, 2.0);
+
+    int n_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    fc_serial->compute(0);
+    omp_set_num_threads(MAX(n_threads, 4));
+    fc_threaded->compute(0);
+    omp_set_num_threads(n_threads);
+
+    ArrayHandle<Scalar4> h_force_serial(fc_serial->getForceArray(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_force_threaded(fc_threaded->getForceArray(), access_location::host, access_mode::read);
+
+    Scalar energy_serial = 0.0, energy_threaded = 0.0;
+    for (unsigned int i = 0; i < N; i++)
+        {
+        MY_BOOST_CHECK_CLOSE(h_force_serial.data[i].x, h_force_threaded.data[i].x, tol);
+        MY_BOOST_CHECK_CLOSE(h_force_serial.data[i].y, h_force_threaded.data[i].y, tol);
+        MY_BOOST_CHECK_CLOSE(h_force_serial.data[i].z, h_force_threaded.data[i].z, tol);
+        energy_serial += h_force_serial.data[i].w;
+        energy_threaded += h_force_threaded.data[i].w;
+        }
+    MY_BOOST_CHECK_CLOSE(energy_serial, energy_threaded, tol);
+    }
+#endif
+
 //! PPPMForceCompute creator for unit tests
 shared_ptr<PPPMForceCompute> base_class_pppm_creator(shared_ptr<SystemDefinition> sysdef,
                                                      shared_ptr<NeighborList> nlist,
@@ -270,6 +329,15 @@ BOOST_AUTO_TEST_CASE( PPPMForceCompute_triclinic )
     pppm_force_particle_test_triclinic(pppm_creator, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
     }
 
+#ifdef ENABLE_OPENMP
+//! boost test case for comparing the threaded and serial PPPM on the CPU
+BOOST_AUTO_TEST_CASE( PPPMForceCompute_threads )
+    {
+    pppmforce_creator pppm_creator = bind(base_class_pppm_creator, _1, _2, _3);
+    pppm_force_thread_test(pppm_creator, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
+#endif
+
 
 #ifdef ENABLE_CUDA
 //! boost test case for bond forces on the GPU
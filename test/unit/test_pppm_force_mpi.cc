@@ -0,0 +1,139 @@
+//! name the boost unit test module
+#define BOOST_TEST_MODULE PPPMForceComputeTestsMPI
+#include "MPITestSetup.h"
+
+#include "HOOMDMath.h"
+#include "ExecutionConfiguration.h"
+#include "SystemDefinition.h"
+#include "SnapshotSystemData.h"
+#include "PPPMForceCompute.h"
+#include "NeighborListBinned.h"
+
+#include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "HOOMDMPI.h"
+#include "Communicator.h"
+#include "DomainDecomposition.h"
+
+using namespace boost;
+
+//! Compares a force component, near-zero components are compared with an absolute tolerance
+void check_force_component(Scalar a, Scalar b)
+    {
+    if (fabs(b) < Scalar(0.01))
+        MY_BOOST_CHECK_SMALL(a - b, tol_small);
+    else
+        MY_BOOST_CHECK_CLOSE(a, b, tol);
+    }
+
+//! Compares the PPPM forces and energy on a distributed mesh against a serial calculation
+void test_pppm_force_mpi(boost::shared_ptr<ExecutionConfiguration> exec_conf)
+    {
+    // random system of +/- charges, identical on every rank
+    unsigned int N = 1000;
+    Scalar L = Scalar(20.0);
+    shared_ptr<SystemDefinition> sysdef_2(new SystemDefinition(N, BoxDim(L), 1, 0, 0, 0, 0, exec_conf));
+    shared_ptr<ParticleData> pdata_2 = sysdef_2->getParticleData();
+
+    {
+    ArrayHandle<Scalar4> h_pos(pdata_2->getPositions(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar> h_charge(pdata_2->getCharges(), access_location::host, access_mode::readwrite);
+    srand(12345);
+    for (unsigned int i = 0; i < N; i++)
+        {
+        h_pos.data[i].x = L * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_pos.data[i].y = L * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_pos.data[i].z = L * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_charge.data[i] = (i % 2) ? Scalar(1.0) : Scalar(-1.0);
+        }
+    }
+
+    boost::shared_ptr<SnapshotSystemData> snap;
+    snap = sysdef_2->takeSnapshot(true, false, false, false, false, false, false, false);
+
+    boost::shared_ptr<DomainDecomposition> decomposition(new DomainDecomposition(exec_conf, snap->global_box.getL(), 0));
+    shared_ptr<SystemDefinition> sysdef_1(new SystemDefinition(snap, exec_conf, decomposition));
+    shared_ptr<ParticleData> pdata_1 = sysdef_1->getParticleData();
+
+    boost::shared_ptr<Communicator> comm(new Communicator(sysdef_1, decomposition));
+
+    shared_ptr<ParticleSelector> selector_all_1(new ParticleSelectorTag(sysdef_1, 0, pdata_1->getNGlobal()-1));
+    shared_ptr<ParticleGroup> group_all_1(new ParticleGroup(sysdef_1, selector_all_1));
+    shared_ptr<ParticleSelector> selector_all_2(new ParticleSelectorTag(sysdef_2, 0, pdata_2->getNGlobal()-1));
+    shared_ptr<ParticleGroup> group_all_2(new ParticleGroup(sysdef_2, selector_all_2));
+
+    Scalar r_cut = Scalar(2.0);
+    Scalar r_buff = Scalar(0.4);
+    shared_ptr<NeighborList> nlist_1(new NeighborListBinned(sysdef_1, r_cut, r_buff));
+    shared_ptr<NeighborList> nlist_2(new NeighborListBinned(sysdef_2, r_cut, r_buff));
+    nlist_1->setCommunicator(comm);
+
+    shared_ptr<PPPMForceCompute> fc_1(new PPPMForceCompute(sysdef_1, nlist_1, group_all_1));
+    shared_ptr<PPPMForceCompute> fc_2(new PPPMForceCompute(sysdef_2, nlist_2, group_all_2));
+    fc_1->setParams(32, 32, 32, 5, 1.0, r_cut);
+    fc_2->setParams(32, 32, 32, 5, 1.0, r_cut);
+
+    fc_1->compute(0);
+    fc_2->compute(0);
+
+    // every rank checks the particles it owns against the serial result
+    double energy_1 = 0.0;
+    {
+    ArrayHandle<Scalar4> h_force_1(fc_1->getForceArray(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar4> h_force_2(fc_2->getForceArray(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag_1(pdata_1->getTags(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_rtag_2(pdata_2->getRTags(), access_location::host, access_mode::read);
+
+    for (unsigned int i = 0; i < pdata_1->getN(); i++)
+        {
+        unsigned int j = h_rtag_2.data[h_tag_1.data[i]];
+        check_force_component(h_force_1.data[i].x, h_force_2.data[j].x);
+        check_force_component(h_force_1.data[i].y, h_force_2.data[j].y);
+        check_force_component(h_force_1.data[i].z, h_force_2.data[j].z);
+        energy_1 += h_force_1.data[i].w;
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &energy_1, 1, MPI_DOUBLE, MPI_SUM, exec_conf->getMPICommunicator());
+
+    double energy_2 = 0.0;
+    {
+    ArrayHandle<Scalar4> h_force_2(fc_2->getForceArray(), access_location::host, access_mode::read);
+    for (unsigned int i = 0; i < N; i++)
+        energy_2 += h_force_2.data[i].w;
+    }
+    MY_BOOST_CHECK_CLOSE(energy_1, energy_2, tol);
+
+    // the thermodynamic corrections are applied exactly once across the ranks
+    PDataFlags flags;
+    flags[pdata_flag::pressure_tensor] = 1;
+    pdata_1->setFlags(flags);
+    pdata_2->setFlags(flags);
+    fc_1->compute(1);
+    fc_2->compute(1);
+
+    energy_1 = 0.0;
+    {
+    ArrayHandle<Scalar4> h_force_1(fc_1->getForceArray(), access_location::host, access_mode::read);
+    for (unsigned int i = 0; i < pdata_1->getN(); i++)
+        energy_1 += h_force_1.data[i].w;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &energy_1, 1, MPI_DOUBLE, MPI_SUM, exec_conf->getMPICommunicator());
+
+    energy_2 = 0.0;
+    {
+    ArrayHandle<Scalar4> h_force_2(fc_2->getForceArray(), access_location::host, access_mode::read);
+    for (unsigned int i = 0; i < N; i++)
+        energy_2 += h_force_2.data[i].w;
+    }
+    MY_BOOST_CHECK_CLOSE(energy_1, energy_2, tol);
+    }
+
+//! Tests the distributed PPPM mesh against a serial calculation
+BOOST_AUTO_TEST_CASE( PPPMForceCompute_mpi )
+    {
+    test_pppm_force_mpi(exec_conf_cpu);
+    }
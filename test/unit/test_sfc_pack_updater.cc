@@ -0,0 +1,293 @@
+/*
+Highly Optimized Object-oriented Many-particle Dynamics -- Blue Edition
+(HOOMD-blue) Open Source Software License Copyright 2008-2011 Ames Laboratory
+Iowa State University and The Regents of the University of Michigan All rights
+reserved.
+
+HOOMD-blue may contain modifications ("Contributions") provided, and to which
+copyright is held, by various Contributors who have granted The Regents of the
+University of Michigan the right to modify and/or distribute such Contributions.
+
+You may redistribute, use, and create derivate works of HOOMD-blue, in source
+and binary forms, provided you abide by the following conditions:
+
+* Redistributions of source code must retain the above copyright notice, this
+list of conditions, and the following disclaimer both in the code and
+prominently in any materials provided with the distribution.
+
+* Redistributions in binary form must reproduce the above copyright notice, this
+list of conditions, and the following disclaimer in the documentation and/or
+other materials provided with the distribution.
+
+* All publications and presentations based on HOOMD-blue, including any reports
+or published results obtained, in whole or in part, with HOOMD-blue, will
+acknowledge its use according to the terms posted at the time of submission on:
+http://codeblue.umich.edu/hoomd-blue/citations.html
+
+* Any electronic documents citing HOOMD-Blue will link to the HOOMD-Blue website:
+http://codeblue.umich.edu/hoomd-blue/
+
+* Apart from the above required attributions, neither the name of the copyright
+holder nor the names of HOOMD-blue's contributors may be used to endorse or
+promote products derived from this software without specific prior written
+permission.
+
+Disclaimer
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS ``AS IS'' AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, AND/OR ANY
+WARRANTIES THAT THIS SOFTWARE IS FREE OF INFRINGEMENT ARE DISCLAIMED.
+
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef WIN32
+#pragma warning( push )
+#pragma warning( disable : 4103 4244 )
+#endif
+
+#include <iostream>
+
+#include <boost/shared_ptr.hpp>
+
+#include "SFCPackUpdater.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#ifdef ENABLE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace boost;
+
+//! label the boost test module
+#define BOOST_TEST_MODULE SFCPackUpdaterTests
+#include "boost_utf_configure.h"
+
+/*! \file test_sfc_pack_updater.cc
+    \brief Unit tests for the SFCPackUpdater class
+    \ingroup unit_tests
+*/
+
+//! Places N particles randomly in the box and labels every per-particle quantity with the tag
+void init_random_particles(shared_ptr<ParticleData> pdata, Scalar L, bool two_d)
+    {
+    ArrayHandle<Scalar4> h_pos(pdata->getPositions(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar4> h_vel(pdata->getVelocities(), access_location::host, access_mode::readwrite);
+    ArrayHandle<Scalar> h_charge(pdata->getCharges(), access_location::host, access_mode::readwrite);
+    ArrayHandle<int3> h_image(pdata->getImages(), access_location::host, access_mode::readwrite);
+
+    srand(12345);
+    for (unsigned int i = 0; i < pdata->getN(); i++)
+        {
+        h_pos.data[i].x = L * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_pos.data[i].y = L * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_pos.data[i].z = two_d ? Scalar(0.0) : L * (Scalar(rand()) / Scalar(RAND_MAX) - Scalar(0.5));
+        h_vel.data[i].x = Scalar(i);
+        h_charge.data[i] = Scalar(2*i);
+        h_image.data[i] = make_int3(i, -int(i), 1);
+        }
+    }
+
+//! Checks that the per-particle data moved together with the tags
+void check_particles_by_tag(shared_ptr<ParticleData> pdata)
+    {
+    ArrayHandle<Scalar4> h_vel(pdata->getVelocities(), access_location::host, access_mode::read);
+    ArrayHandle<Scalar> h_charge(pdata->getCharges(), access_location::host, access_mode::read);
+    ArrayHandle<int3> h_image(pdata->getImages(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag(pdata->getTags(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_rtag(pdata->getRTags(), access_location::host, access_mode::read);
+
+    for (unsigned int i = 0; i < pdata->getN(); i++)
+        {
+        unsigned int tag = h_tag.data[i];
+        BOOST_REQUIRE_EQUAL_UINT(h_rtag.data[tag], i);
+        MY_BOOST_CHECK_CLOSE(h_vel.data[i].x, Scalar(tag), tol);
+        MY_BOOST_CHECK_CLOSE(h_charge.data[i], Scalar(2*tag), tol);
+        BOOST_CHECK_EQUAL(h_image.data[i].x, int(tag));
+        BOOST_CHECK_EQUAL(h_image.data[i].y, -int(tag));
+        }
+    }
+
+//! boost test case to verify that SFCPackUpdater orders particles by bin in 2D
+BOOST_AUTO_TEST_CASE( SFCPackUpdater_2d )
+    {
+    unsigned int N = 5000;
+    Scalar L = Scalar(10.0);
+    unsigned int grid = 16;
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(N, BoxDim(L), 1));
+    sysdef->setNDimensions(2);
+    shared_ptr<ParticleData> pdata = sysdef->getParticleData();
+    init_random_particles(pdata, L, true);
+
+    shared_ptr<SFCPackUpdater> sorter(new SFCPackUpdater(sysdef));
+    sorter->setGrid(grid);
+    sorter->update(0);
+
+    check_particles_by_tag(pdata);
+
+    // in 2D, the bins are traversed in row major order and particles in the same bin keep their relative order
+    ArrayHandle<Scalar4> h_pos(pdata->getPositions(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag(pdata->getTags(), access_location::host, access_mode::read);
+    const BoxDim& box = pdata->getBox();
+    unsigned int last_bin = 0;
+    for (unsigned int i = 0; i < N; i++)
+        {
+        Scalar3 f = box.makeFraction(make_scalar3(h_pos.data[i].x, h_pos.data[i].y, h_pos.data[i].z));
+        unsigned int bin = ((unsigned int)(f.x * grid) % grid) * grid + (unsigned int)(f.y * grid) % grid;
+        BOOST_REQUIRE(bin >= last_bin);
+        if (i > 0 && bin == last_bin)
+            BOOST_REQUIRE(h_tag.data[i] > h_tag.data[i-1]);
+        last_bin = bin;
+        }
+    }
+
+//! boost test case to verify that SFCPackUpdater keeps the per-particle data together in 3D
+BOOST_AUTO_TEST_CASE( SFCPackUpdater_3d )
+    {
+    unsigned int N = 5000;
+    Scalar L = Scalar(10.0);
+    shared_ptr<SystemDefinition> sysdef(new SystemDefinition(N, BoxDim(L), 1));
+    shared_ptr<ParticleData> pdata = sysdef->getParticleData();
+    init_random_particles(pdata, L, false);
+
+    shared_ptr<SFCPackUpdater> sorter(new SFCPackUpdater(sysdef));
+    sorter->setGrid(32);
+    sorter->update(0);
+    check_particles_by_tag(pdata);
+
+    // sorting an already sorted system does not change the order
+    vector<unsigned int> tags(N);
+    {
+    ArrayHandle<unsigned int> h_tag(pdata->getTags(), access_location::host, access_mode::read);
+    for (unsigned int i = 0; i < N; i++)
+        tags[i] = h_tag.data[i];
+    }
+    sorter->update(1);
+    ArrayHandle<unsigned int> h_tag(pdata->getTags(), access_location::host, access_mode::read);
+    for (unsigned int i = 0; i < N; i++)
+        BOOST_REQUIRE_EQUAL_UINT(h_tag.data[i], tags[i]);
+    }
+
+//! Builds a ring of bonds, angles and dihedrals through all particles, in tag order
+void init_ring_topology(shared_ptr<SystemDefinition> sysdef)
+    {
+    unsigned int N = sysdef->getParticleData()->getN();
+    for (unsigned int i = 0; i < N; i++)
+        {
+        sysdef->getBondData()->addBond(Bond(0, i, (i+1) % N));
+        sysdef->getAngleData()->addAngle(Angle(0, i, (i+1) % N, (i+2) % N));
+        sysdef->getDihedralData()->addDihedral(Dihedral(0, i, (i+1) % N, (i+2) % N, (i+3) % N));
+        }
+    }
+
+//! boost test case to verify that bond, angle and dihedral tables reordered along with a sort match a full rebuild
+BOOST_AUTO_TEST_CASE( SFCPackUpdater_topology )
+    {
+    unsigned int N = 5000;
+    Scalar L = Scalar(10.0);
+    shared_ptr<SystemDefinition> sysdef_1(new SystemDefinition(N, BoxDim(L), 1, 1, 1, 1));
+    shared_ptr<SystemDefinition> sysdef_2(new SystemDefinition(N, BoxDim(L), 1, 1, 1, 1));
+    init_random_particles(sysdef_1->getParticleData(), L, false);
+    init_random_particles(sysdef_2->getParticleData(), L, false);
+    init_ring_topology(sysdef_1);
+    init_ring_topology(sysdef_2);
+
+    // build the tables of the first system before sorting, so that they are permuted instead of rebuilt, and check
+    // the reordered tables against a rebuild right away
+    sysdef_1->getBondData()->getGPUBondList();
+    sysdef_1->getAngleData()->getGPUAngleList();
+    sysdef_1->getDihedralData()->getGPUDihedralList();
+    sysdef_1->getBondData()->setPermutationValidation(true);
+    sysdef_1->getAngleData()->setPermutationValidation(true);
+    sysdef_1->getDihedralData()->setPermutationValidation(true);
+
+    shared_ptr<SFCPackUpdater> sorter_1(new SFCPackUpdater(sysdef_1));
+    shared_ptr<SFCPackUpdater> sorter_2(new SFCPackUpdater(sysdef_2));
+    sorter_1->update(0);
+    sorter_2->update(0);
+
+    const GPUArray<uint2>& bonds_1 = sysdef_1->getBondData()->getGPUBondList();
+    const GPUArray<uint2>& bonds_2 = sysdef_2->getBondData()->getGPUBondList();
+    ArrayHandle<unsigned int> h_n_bonds_1(sysdef_1->getBondData()->getNBondsArray(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_n_bonds_2(sysdef_2->getBondData()->getNBondsArray(), access_location::host, access_mode::read);
+    ArrayHandle<uint2> h_bonds_1(bonds_1, access_location::host, access_mode::read);
+    ArrayHandle<uint2> h_bonds_2(bonds_2, access_location::host, access_mode::read);
+
+    for (unsigned int i = 0; i < N; i++)
+        {
+        BOOST_REQUIRE_EQUAL_UINT(h_n_bonds_1.data[i], h_n_bonds_2.data[i]);
+        for (unsigned int j = 0; j < h_n_bonds_1.data[i]; j++)
+            {
+            uint2 b1 = h_bonds_1.data[j*bonds_1.getPitch() + i];
+            uint2 b2 = h_bonds_2.data[j*bonds_2.getPitch() + i];
+            BOOST_CHECK_EQUAL(b1.x, b2.x);
+            BOOST_CHECK_EQUAL(b1.y, b2.y);
+            }
+        }
+
+    const GPUArray<uint4>& angles_1 = sysdef_1->getAngleData()->getGPUAngleList();
+    const GPUArray<uint4>& angles_2 = sysdef_2->getAngleData()->getGPUAngleList();
+    ArrayHandle<unsigned int> h_n_angles_1(sysdef_1->getAngleData()->getNAnglesArray(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_n_angles_2(sysdef_2->getAngleData()->getNAnglesArray(), access_location::host, access_mode::read);
+    ArrayHandle<uint4> h_angles_1(angles_1, access_location::host, access_mode::read);
+    ArrayHandle<uint4> h_angles_2(angles_2, access_location::host, access_mode::read);
+
+    for (unsigned int i = 0; i < N; i++)
+        {
+        BOOST_REQUIRE_EQUAL_UINT(h_n_angles_1.data[i], h_n_angles_2.data[i]);
+        for (unsigned int j = 0; j < h_n_angles_1.data[i]; j++)
+            {
+            uint4 a1 = h_angles_1.data[j*angles_1.getPitch() + i];
+            uint4 a2 = h_angles_2.data[j*angles_2.getPitch() + i];
+            BOOST_CHECK_EQUAL(a1.x, a2.x);
+            BOOST_CHECK_EQUAL(a1.y, a2.y);
+            BOOST_CHECK_EQUAL(a1.z, a2.z);
+            BOOST_CHECK_EQUAL(a1.w, a2.w);
+            }
+        }
+    }
+
+#ifdef ENABLE_OPENMP
+//! boost test case to verify that the sort order does not depend on the number of threads
+BOOST_AUTO_TEST_CASE( SFCPackUpdater_threads )
+    {
+    unsigned int N = 20000;
+    Scalar L = Scalar(20.0);
+    shared_ptr<SystemDefinition> sysdef_1(new SystemDefinition(N, BoxDim(L), 1));
+    shared_ptr<SystemDefinition> sysdef_2(new SystemDefinition(N, BoxDim(L), 1));
+    init_random_particles(sysdef_1->getParticleData(), L, false);
+    init_random_particles(sysdef_2->getParticleData(), L, false);
+
+    shared_ptr<SFCPackUpdater> sorter_1(new SFCPackUpdater(sysdef_1));
+    shared_ptr<SFCPackUpdater> sorter_2(new SFCPackUpdater(sysdef_2));
+
+    int n_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    sorter_1->update(0);
+    omp_set_num_threads(std::max(n_threads, 4));
+    sorter_2->update(0);
+    omp_set_num_threads(n_threads);
+
+    check_particles_by_tag(sysdef_2->getParticleData());
+
+    ArrayHandle<unsigned int> h_tag_1(sysdef_1->getParticleData()->getTags(), access_location::host, access_mode::read);
+    ArrayHandle<unsigned int> h_tag_2(sysdef_2->getParticleData()->getTags(), access_location::host, access_mode::read);
+    for (unsigned int i = 0; i < N; i++)
+        BOOST_REQUIRE_EQUAL_UINT(h_tag_1.data[i], h_tag_2.data[i]);
+    }
+#endif
+
+#ifdef WIN32
+#pragma warning( pop )
+#endif
@@ -264,6 +264,15 @@ shared_ptr<PotentialPairYukawa> base_class_yukawa_creator(shared_ptr<SystemDefin
     return shared_ptr<PotentialPairYukawa>(new PotentialPairYukawa(sysdef, nlist));
     }
 
+//! PotentialPairYukawa creator for unit tests that always uses the per neighbor loop
+shared_ptr<PotentialPairYukawa> scalar_yukawa_creator(shared_ptr<SystemDefinition> sysdef,
+                                                      shared_ptr<NeighborList> nlist)
+    {
+    shared_ptr<PotentialPairYukawa> yukawa(new PotentialPairYukawa(sysdef, nlist));
+    yukawa->setVectorized(false);
+    return yukawa;
+    }
+
 #ifdef ENABLE_CUDA
 //! PotentialPairYukawaGPU creator for unit tests
 shared_ptr<PotentialPairYukawaGPU> gpu_yukawa_creator(shared_ptr<SystemDefinition> sysdef,
@@ -284,6 +293,14 @@ BOOST_AUTO_TEST_CASE( YukawaForce_particle )
     yukawa_force_particle_test(yukawa_creator_base, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
     }
 
+//! boost test case for comparing the vectorized path to the per neighbor loop on CPU
+BOOST_AUTO_TEST_CASE( YukawaForce_vectorized )
+    {
+    yukawaforce_creator yukawa_creator_scalar = bind(scalar_yukawa_creator, _1, _2);
+    yukawaforce_creator yukawa_creator_base = bind(base_class_yukawa_creator, _1, _2);
+    yukawa_force_comparison_test(yukawa_creator_scalar, yukawa_creator_base, boost::shared_ptr<ExecutionConfiguration>(new ExecutionConfiguration(ExecutionConfiguration::CPU)));
+    }
+
 # ifdef ENABLE_CUDA
 //! boost test case for particle test on GPU
 BOOST_AUTO_TEST_CASE( YukawaForceGPU_particle )